@@ -0,0 +1,106 @@
+// Tests that an aggregation beginning with a $group on indexed fields reads those fields from a
+// covered index scan, even when there is no $match to select the index.
+//
+// Relies on the $group being the first stage after the cursor, so the pipelines cannot be wrapped
+// in facet stages.
+// @tags: [do_not_wrap_aggregations_in_facets]
+(function() {
+    "use strict";
+
+    load("jstests/libs/analyze_plan.js");  // For 'aggPlanHasStage' and other explain helpers.
+
+    const coll = db.use_covered_index_scan_for_group;
+    coll.drop();
+
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < 100; ++i) {
+        bulk.insert({_id: i, a: i % 5, b: i, c: "unindexed"});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.createIndex({a: 1, b: 1}));
+
+    function assertGroupIsCovered(pipeline) {
+        const explainOutput = coll.explain().aggregate(pipeline);
+        assert(!aggPlanHasStage(explainOutput, "FETCH"),
+               "Expected pipeline " + tojsononeline(pipeline) +
+                   " *not* to include a FETCH stage in the explain output: " +
+                   tojson(explainOutput));
+        assert(aggPlanHasStage(explainOutput, "IXSCAN"),
+               "Expected pipeline " + tojsononeline(pipeline) +
+                   " to include an index scan in the explain output: " + tojson(explainOutput));
+    }
+
+    function assertGroupIsNotCovered(pipeline) {
+        const explainOutput = coll.explain().aggregate(pipeline);
+        assert(aggPlanHasStage(explainOutput, "COLLSCAN"),
+               "Expected pipeline " + tojsononeline(pipeline) +
+                   " to include a COLLSCAN stage in the explain output: " +
+                   tojson(explainOutput));
+    }
+
+    const countByA = [{$group: {_id: "$a", n: {$sum: 1}}}, {$sort: {_id: 1}}];
+    const minMaxByA =
+        [{$group: {_id: "$a", lo: {$min: "$b"}, hi: {$max: "$b"}}}, {$sort: {_id: 1}}];
+
+    assertGroupIsCovered(countByA);
+    assertGroupIsCovered(minMaxByA);
+    assertGroupIsNotCovered([{$group: {_id: "$a", c: {$first: "$c"}}}]);
+
+    // The covered plans produce the same groups as a collection scan would.
+    const expectedCounts = [];
+    const expectedMinMax = [];
+    for (let a = 0; a < 5; ++a) {
+        expectedCounts.push({_id: a, n: 20});
+        expectedMinMax.push({_id: a, lo: a, hi: 95 + a});
+    }
+    assert.eq(coll.aggregate(countByA).toArray(), expectedCounts);
+    assert.eq(coll.aggregate(minMaxByA).toArray(), expectedMinMax);
+
+    // Index keys hold null where a document lacks the field, so only a $group that cannot tell
+    // null from missing may be covered, and its results must match a collection scan.
+    assert.writeOK(coll.insert({_id: 200, c: "no a or b"}));
+    assert.writeOK(coll.insert({_id: 201, a: null, b: null}));
+    assert.writeOK(coll.insert({_id: 202, a: 1}));
+
+    function assertSameResultsAsCollectionScan(pipeline) {
+        assert.eq(coll.aggregate(pipeline).toArray(),
+                  coll.aggregate(pipeline, {hint: {$natural: 1}}).toArray(),
+                  "Pipeline " + tojsononeline(pipeline) +
+                      " gave different results than a collection scan");
+    }
+
+    const sumAvgByA = [
+        {$group: {_id: "$a", total: {$sum: "$b"}, mean: {$avg: "$b"}, n: {$sum: 1}}},
+        {$sort: {_id: 1}}
+    ];
+    for (let pipeline of[countByA, minMaxByA, sumAvgByA]) {
+        assertGroupIsCovered(pipeline);
+        assertSameResultsAsCollectionScan(pipeline);
+    }
+
+    // These distinguish a missing field from null, so they must fetch the documents.
+    const pushB = [{$group: {_id: "$a", bs: {$push: "$b"}}}, {$sort: {_id: 1}}];
+    const addToSetB = [{$group: {_id: "$a", bs: {$addToSet: "$b"}}}, {$sort: {_id: 1}}];
+    const firstB = [{$sort: {_id: 1}}, {$group: {_id: "$a", b: {$first: "$b"}}}];
+    const idDocument = [{$group: {_id: {x: "$a", y: "$b"}, n: {$sum: 1}}}, {$sort: {_id: 1}}];
+    const idExpression = [{$group: {_id: {$type: "$a"}, n: {$sum: 1}}}, {$sort: {_id: 1}}];
+    const sumOfExpression = [
+        {$group: {_id: "$a", n: {$sum: {$cond: [{$eq: [{$type: "$b"}, "missing"]}, 1, 0]}}}},
+        {$sort: {_id: 1}}
+    ];
+    for (let pipeline of[pushB, idDocument, idExpression, sumOfExpression]) {
+        assertGroupIsNotCovered(pipeline);
+        assertSameResultsAsCollectionScan(pipeline);
+    }
+    assertGroupIsNotCovered(addToSetB);
+    assertSameResultsAsCollectionScan(firstB);
+
+    // The document lacking 'a' and 'b' forms a group of its own, apart from {a: null, b: null},
+    // when grouping on an _id document.
+    assert.eq(coll.aggregate(idDocument).toArray().slice(0, 2),
+              [{_id: {}, n: 1}, {_id: {x: null, y: null}, n: 1}]);
+
+    // A multikey index cannot cover the $group.
+    assert.writeOK(coll.insert({_id: 100, a: [1, 2], b: 0}));
+    assertGroupIsNotCovered(countByA);
+}());
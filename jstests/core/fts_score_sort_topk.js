@@ -0,0 +1,53 @@
+// @tags: [assumes_unsharded_collection]
+//
+// Test that a limited sort on text score returns the same documents as an unlimited one, now that
+// the text stage may stop scoring early when only the top results are needed.
+(function() {
+    "use strict";
+
+    load("jstests/libs/analyze_plan.js");
+
+    var t = db.fts_score_sort_topk;
+    t.drop();
+
+    var words = ["alpha", "beta", "gamma", "delta"];
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < 200; i++) {
+        var text = [];
+        for (var j = 0; j < words.length; j++) {
+            for (var k = 0; k < (i * (j + 3)) % 7; k++) {
+                text.push(words[j]);
+            }
+        }
+        text.push("filler" + i);
+        bulk.insert({_id: i, a: text.join(" ")});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(t.ensureIndex({a: "text"}));
+
+    function scores(limit) {
+        var cursor = t.find({$text: {$search: "alpha gamma delta"}}, {score: {$meta: "textScore"}})
+                         .sort({score: {$meta: "textScore"}});
+        if (limit) {
+            cursor = cursor.limit(limit);
+        }
+        return cursor.toArray().map(function(doc) {
+            return doc.score;
+        });
+    }
+
+    var all = scores(0);
+    [1, 5, 20].forEach(function(limit) {
+        assert.eq(all.slice(0, limit), scores(limit), "limit " + limit);
+    });
+
+    // Only the winning documents should be fetched.
+    var explain = t.find({$text: {$search: "alpha gamma delta"}}, {score: {$meta: "textScore"}})
+                      .sort({score: {$meta: "textScore"}})
+                      .limit(5)
+                      .explain("executionStats");
+    var textOr = getPlanStage(explain.executionStats.executionStages, "TEXT_OR");
+    assert.neq(null, textOr, tojson(explain));
+    assert.eq(5, textOr.topK, tojson(textOr));
+    assert.lte(textOr.docsExamined, 5, tojson(textOr));
+})();
@@ -0,0 +1,70 @@
+// Tests that limited $near queries on a 2dsphere index search the index best-first, and return
+// the same documents as the unlimited search.
+// @tags: [assumes_unsharded_collection]
+(function() {
+    "use strict";
+
+    load("jstests/libs/analyze_plan.js");
+
+    const coll = db.geo_near_best_first;
+    coll.drop();
+
+    Random.setRandomSeed();
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < 1000; ++i) {
+        bulk.insert({
+            _id: i,
+            loc: {type: "Point", coordinates: [Random.rand() * 20 - 10, Random.rand() * 20 - 10]},
+            even: i % 2 === 0
+        });
+    }
+    // A few polygons, so that the search also meets coarser keys.
+    for (let i = 0; i < 10; ++i) {
+        const x = i * 2 - 10;
+        bulk.insert({
+            _id: 1000 + i,
+            loc: {
+                type: "Polygon",
+                coordinates: [[[x, 5], [x + 1, 5], [x + 1, 6], [x, 6], [x, 5]]]
+            },
+            even: i % 2 === 0
+        });
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.createIndex({loc: "2dsphere"}));
+
+    function runNear(query, limit) {
+        const cursor = coll.find(query, {_id: 1});
+        return (limit ? cursor.limit(limit) : cursor).toArray().map(doc => doc._id);
+    }
+
+    function checkNear(query, limit) {
+        const limited = runNear(query, limit);
+        const unlimited = runNear(query).slice(0, limit);
+        assert.eq(unlimited, limited, tojson(query));
+
+        const explain = coll.find(query).limit(limit).explain("executionStats");
+        const nearStage = getPlanStage(explain.executionStats.executionStages, "GEO_NEAR_2DSPHERE");
+        assert.neq(null, nearStage, tojson(explain));
+        assert.eq(true, nearStage.bestFirst, tojson(nearStage));
+        return nearStage;
+    }
+
+    const near = {$geometry: {type: "Point", coordinates: [0, 0]}};
+    let nearStage = checkNear({loc: {$near: near}}, 5);
+    // Only a small part of the collection should have been looked at.
+    assert.lt(nearStage.docsExamined, 200, tojson(nearStage));
+
+    checkNear({loc: {$near: near}}, 50);
+    checkNear({loc: {$nearSphere: near}}, 10);
+    checkNear({loc: {$near: near}, even: true}, 10);
+    checkNear({loc: {$near: Object.extend({$minDistance: 200 * 1000}, near)}}, 10);
+    checkNear({loc: {$near: Object.extend({$maxDistance: 300 * 1000}, near)}}, 20);
+    checkNear({loc: {$near: {$geometry: {type: "Point", coordinates: [-8.5, 5.5]}}}}, 10);
+
+    // Without a limit, the interval-based search is used.
+    const explain = coll.find({loc: {$near: near}}).explain("executionStats");
+    nearStage = getPlanStage(explain.executionStats.executionStages, "GEO_NEAR_2DSPHERE");
+    assert.neq(null, nearStage, tojson(explain));
+    assert.eq(undefined, nearStage.bestFirst, tojson(nearStage));
+}());
@@ -170,4 +170,10 @@
     // Test non-command.
     assert.commandFailed(testColl.runCommand("IHopeNobodyEverMakesThisACommand"));
     lastHistogram = assertHistogramDiffEq(testColl, lastHistogram, 0, 0, 0);
+
+    // Percentiles are reported once a type has seen operations, and are ordered.
+    var writes = testColl.latencyStats().next().latencyStats.writes;
+    assert.gt(writes.ops, 0);
+    assert.lte(writes.p50, writes.p99, tojson(writes));
+    assert.lte(writes.p99, writes.p999, tojson(writes));
 }());
@@ -0,0 +1,97 @@
+// Tests that an update keeps every index correct when it only changes the keys of some of them.
+// Updates skip key generation for an index whose key and partial filter fields are unchanged.
+(function() {
+    "use strict";
+
+    const coll = db.update_affected_indexes;
+
+    function assertFoundWithIndex(index, query, expectedIds) {
+        const ids =
+            coll.find(query, {_id: 1}).hint(index).sort({_id: 1}).toArray().map(doc => doc._id);
+        assert.eq(expectedIds, ids, tojson({index: index, query: query}));
+    }
+
+    function assertValid() {
+        const res = coll.validate({full: true});
+        assert.commandWorked(res);
+        assert(res.valid, tojson(res));
+    }
+
+    // An unchanged indexed field alongside a changed one.
+    coll.drop();
+    assert.commandWorked(coll.createIndex({a: 1}));
+    assert.commandWorked(coll.createIndex({b: 1}));
+    assert.commandWorked(coll.createIndex({a: 1, c: 1}));
+    assert.writeOK(coll.insert({_id: 0, a: 1, b: 1, c: 1}));
+    assert.writeOK(coll.update({_id: 0}, {$set: {b: 2}}));
+    assertFoundWithIndex({a: 1}, {a: 1}, [0]);
+    assertFoundWithIndex({b: 1}, {b: 1}, []);
+    assertFoundWithIndex({b: 1}, {b: 2}, [0]);
+    assertFoundWithIndex({a: 1, c: 1}, {a: 1, c: 1}, [0]);
+    assert.writeOK(coll.update({_id: 0}, {$set: {c: 2}}));
+    assertFoundWithIndex({a: 1, c: 1}, {a: 1, c: 1}, []);
+    assertFoundWithIndex({a: 1, c: 1}, {a: 1, c: 2}, [0]);
+
+    // A replacement that keeps one indexed field and changes another.
+    assert.writeOK(coll.update({_id: 0}, {a: 1, b: 3}));
+    assertFoundWithIndex({a: 1}, {a: 1}, [0]);
+    assertFoundWithIndex({b: 1}, {b: 3}, [0]);
+    assertFoundWithIndex({a: 1, c: 1}, {a: 1, c: null}, [0]);
+    assertValid();
+
+    // A partial index whose filter field changes, but not its key.
+    coll.drop();
+    assert.commandWorked(
+        coll.createIndex({a: 1}, {partialFilterExpression: {p: {$gt: 0}}, name: "a_partial"}));
+    assert.writeOK(coll.insert({_id: 0, a: 1, p: 0}));
+    assertFoundWithIndex("a_partial", {a: 1, p: {$gt: 0}}, []);
+    assert.writeOK(coll.update({_id: 0}, {$set: {p: 1}}));
+    assertFoundWithIndex("a_partial", {a: 1, p: {$gt: 0}}, [0]);
+    assert.writeOK(coll.update({_id: 0}, {$set: {p: 2}}));
+    assertFoundWithIndex("a_partial", {a: 1, p: {$gt: 0}}, [0]);
+    assert.writeOK(coll.update({_id: 0}, {$unset: {p: 1}}));
+    assertFoundWithIndex("a_partial", {a: 1, p: {$gt: 0}}, []);
+    assertValid();
+
+    // A partial index filtered on a dotted path.
+    coll.drop();
+    assert.commandWorked(coll.createIndex(
+        {a: 1}, {partialFilterExpression: {"f.on": true}, name: "a_partial_dotted"}));
+    assert.writeOK(coll.insert({_id: 0, a: 1, f: {on: false, other: 1}}));
+    assert.writeOK(coll.update({_id: 0}, {$set: {"f.on": true}}));
+    assertFoundWithIndex("a_partial_dotted", {a: 1, "f.on": true}, [0]);
+    assert.writeOK(coll.update({_id: 0}, {$set: {"f.other": 2}}));
+    assertFoundWithIndex("a_partial_dotted", {a: 1, "f.on": true}, [0]);
+    assertValid();
+
+    // Dotted key paths, including through arrays.
+    coll.drop();
+    assert.commandWorked(coll.createIndex({"x.y": 1}));
+    assert.commandWorked(coll.createIndex({"arr.v": 1}));
+    assert.writeOK(coll.insert({_id: 0, x: {y: 1, z: 1}, xy: 1, arr: [{v: 1}]}));
+    assert.writeOK(coll.update({_id: 0}, {$set: {"x.z": 2, xy: 2}}));
+    assertFoundWithIndex({"x.y": 1}, {"x.y": 1}, [0]);
+    assert.writeOK(coll.update({_id: 0}, {$set: {"x.y": 2}}));
+    assertFoundWithIndex({"x.y": 1}, {"x.y": 1}, []);
+    assertFoundWithIndex({"x.y": 1}, {"x.y": 2}, [0]);
+    assert.writeOK(coll.update({_id: 0}, {$set: {x: 5}}));
+    assertFoundWithIndex({"x.y": 1}, {"x.y": 2}, []);
+    assertFoundWithIndex({"x.y": 1}, {"x.y": null}, [0]);
+    assert.writeOK(coll.update({_id: 0}, {$push: {arr: {v: 3}}}));
+    assertFoundWithIndex({"arr.v": 1}, {"arr.v": 1}, [0]);
+    assertFoundWithIndex({"arr.v": 1}, {"arr.v": 3}, [0]);
+    assert.writeOK(coll.update({_id: 0}, {$pop: {arr: -1}}));
+    assertFoundWithIndex({"arr.v": 1}, {"arr.v": 1}, []);
+    assertFoundWithIndex({"arr.v": 1}, {"arr.v": 3}, [0]);
+    assertValid();
+
+    // Text index keys depend on the language override field as well as the indexed text.
+    coll.drop();
+    assert.commandWorked(coll.createIndex({t: "text"}));
+    assert.writeOK(coll.insert({_id: 0, t: "running dogs", language: "english"}));
+    assert.eq(1, coll.find({$text: {$search: "run"}}).itcount());
+    assert.writeOK(coll.update({_id: 0}, {$set: {language: "none"}}));
+    assert.eq(0, coll.find({$text: {$search: "run"}}).itcount());
+    assert.eq(1, coll.find({$text: {$search: "running", $language: "none"}}).itcount());
+    assertValid();
+}());
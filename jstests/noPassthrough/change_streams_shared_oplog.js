@@ -0,0 +1,95 @@
+// Tests that $changeStream cursors sharing their oplog reads through a common buffer each see
+// exactly the changes on their own collection, in order, including when the buffer is too small
+// to hold what they have not read yet and they must read the oplog themselves.
+(function() {
+    "use strict";
+
+    const rst = new ReplSetTest({
+        nodes: 1,
+        nodeOptions:
+            {setParameter: {internalDocumentSourceChangeStreamSharedOplogBytes: 1024 * 1024}}
+    });
+    rst.startSet();
+    rst.initiate();
+
+    const testDB = rst.getPrimary().getDB("test");
+    testDB.getMongo().forceReadMode("commands");
+    const collNames = ["a", "b"];
+    const kStreamsPerColl = 5;
+    const kDocsPerColl = 20;
+
+    function openStreams(pipelineSpec) {
+        let streams = [];
+        for (let collName of collNames) {
+            assert.commandWorked(testDB.createCollection(collName));
+            for (let i = 0; i < kStreamsPerColl; ++i) {
+                const res = assert.commandWorked(testDB.runCommand({
+                    aggregate: collName,
+                    pipeline: [{$changeStream: pipelineSpec || {}}],
+                    cursor: {batchSize: 0}
+                }));
+                streams.push({collName: collName, cursorId: res.cursor.id, events: []});
+            }
+        }
+        return streams;
+    }
+
+    function readAll(stream, expectedCount) {
+        assert.soon(function() {
+            const res = assert.commandWorked(testDB.runCommand(
+                {getMore: stream.cursorId, collection: stream.collName, maxTimeMS: 100}));
+            stream.events = stream.events.concat(res.cursor.nextBatch);
+            return stream.events.length >= expectedCount;
+        });
+        assert.eq(stream.events.length, expectedCount, tojson(stream.events));
+    }
+
+    function runTest(bufferBytes) {
+        assert.commandWorked(testDB.adminCommand(
+            {setParameter: 1, internalDocumentSourceChangeStreamSharedOplogBytes: bufferBytes}));
+        testDB.dropDatabase();
+
+        const streams = openStreams();
+        for (let i = 0; i < kDocsPerColl; ++i) {
+            for (let collName of collNames) {
+                assert.writeOK(testDB[collName].insert({_id: i}));
+            }
+        }
+        assert.writeOK(testDB.a.update({_id: 0}, {$set: {updated: true}}));
+
+        for (let stream of streams) {
+            const expectedCount = kDocsPerColl + (stream.collName === "a" ? 1 : 0);
+            readAll(stream, expectedCount);
+            for (let i = 0; i < kDocsPerColl; ++i) {
+                assert.eq(stream.events[i].operationType, "insert", tojson(stream.events[i]));
+                assert.eq(stream.events[i].ns.coll, stream.collName, tojson(stream.events[i]));
+                assert.eq(stream.events[i].documentKey, {_id: i}, tojson(stream.events[i]));
+            }
+            if (stream.collName === "a") {
+                assert.eq(stream.events[kDocsPerColl].operationType, "update");
+            }
+        }
+
+        // A stream resumed after an earlier change must read what followed it.
+        const resumed = assert.commandWorked(testDB.runCommand({
+            aggregate: "b",
+            pipeline: [{$changeStream: {resumeAfter: streams[kStreamsPerColl].events[9]._id}}],
+            cursor: {}
+        }));
+        assert.eq(resumed.cursor.firstBatch[0].documentKey, {_id: 10}, tojson(resumed));
+
+        // Dropping a collection invalidates the streams on it.
+        assert(testDB.a.drop());
+        const invalidated = assert.commandWorked(
+            testDB.runCommand({getMore: streams[0].cursorId, collection: "a", maxTimeMS: 5000}));
+        assert.eq(invalidated.cursor.nextBatch[0].operationType, "invalidate", tojson(invalidated));
+    }
+
+    // A buffer large enough to hold every change.
+    runTest(1024 * 1024);
+
+    // A buffer which evicts entries as soon as they are added, so every stream falls behind it.
+    runTest(1);
+
+    rst.stopSet();
+})();
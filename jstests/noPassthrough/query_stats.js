@@ -0,0 +1,59 @@
+// Tests the sampled query shape statistics reported by the $queryStats aggregation stage.
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({setParameter: {queryStatsSampleRate: 1}});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    const testDB = conn.getDB("test");
+    const coll = testDB.query_stats;
+    coll.drop();
+
+    assert.commandWorked(coll.createIndex({a: 1}));
+    for (let i = 0; i < 10; i++) {
+        assert.writeOK(coll.insert({a: i, b: i}));
+    }
+
+    function getStats() {
+        return coll.aggregate([{$queryStats: {}}, {$sort: {count: -1}}]).toArray();
+    }
+
+    // Two queries of the same shape with different values, and one of another shape.
+    assert.eq(1, coll.find({a: 1}).itcount());
+    assert.eq(1, coll.find({a: 2}).itcount());
+    assert.eq(1, coll.find({b: 3}).itcount());
+
+    let stats = getStats();
+    assert.eq(2, stats.length, tojson(stats));
+    assert.eq(coll.getFullName(), stats[0].ns, tojson(stats));
+    assert.eq(2, stats[0].count, tojson(stats));
+    assert.eq(2, stats[0].nreturned, tojson(stats));
+    assert.eq("IXSCAN { a: 1 }", stats[0].planSummary, tojson(stats));
+    assert.eq(2, stats[0].latencyMicros.reduce((sum, bucket) => sum + bucket.count, 0));
+    assert.eq(1, stats[1].count, tojson(stats));
+    assert.eq("COLLSCAN", stats[1].planSummary, tojson(stats));
+
+    // Updates are attributed to their shape as well.
+    assert.writeOK(coll.update({b: 4}, {$set: {c: 1}}));
+    stats = getStats();
+    assert.eq(2, stats[0].count, tojson(stats));
+    assert.eq(2, stats[1].count, tojson(stats));
+
+    // Only the most recently used shapes are kept.
+    assert.commandWorked(testDB.adminCommand({setParameter: 1, queryStatsMaxShapes: 1}));
+    assert.eq(0, coll.find({c: 5}).itcount());
+    stats = getStats();
+    assert.eq(1, stats.length, tojson(stats));
+    assert.eq({c: 5}, stats[0].query, tojson(stats));
+
+    // Nothing is recorded once sampling is disabled.
+    assert.commandWorked(testDB.adminCommand({setParameter: 1, queryStatsSampleRate: 0}));
+    assert.eq(0, coll.find({c: 5}).itcount());
+    assert.eq(1, getStats()[0].count);
+
+    assert.commandFailedWithCode(
+        testDB.runCommand({aggregate: coll.getName(), pipeline: [{$queryStats: 1}], cursor: {}}),
+        40653);
+
+    MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,31 @@
+// Test that time-series collections can only be created when the featureCompatibilityVersion is
+// 3.6.
+
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    const testDB = conn.getDB("timeseries_feature_compatibility_version");
+    assert.commandWorked(testDB.dropDatabase());
+    const adminDB = conn.getDB("admin");
+
+    assert.commandWorked(adminDB.runCommand({setFeatureCompatibilityVersion: "3.4"}));
+
+    const res = testDB.createCollection("weather", {timeseries: {timeField: "time"}});
+    assert.commandFailedWithCode(res, ErrorCodes.InvalidOptions);
+    assert.neq(
+        -1,
+        res.errmsg.indexOf(
+            "The featureCompatibilityVersion must be 3.6 to create a time-series collection. See http://dochub.mongodb.org/core/3.6-feature-compatibility."),
+        "create failed for a reason other than featureCompatibilityVersion");
+    assert.eq(0, testDB.getCollectionNames().filter(name => name.endsWith("weather")).length);
+
+    assert.commandWorked(adminDB.runCommand({setFeatureCompatibilityVersion: "3.6"}));
+    assert.commandWorked(testDB.createCollection("weather", {timeseries: {timeField: "time"}}));
+    assert.writeOK(testDB.weather.insert({time: ISODate("2017-01-01T00:00:00Z")}));
+    assert.eq(1, testDB.weather.find().itcount());
+
+    MongoRunner.stopMongod(conn);
+}());
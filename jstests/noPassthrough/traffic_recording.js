@@ -0,0 +1,68 @@
+/**
+ * Tests recording traffic with startRecordingTraffic and stopRecordingTraffic, and replaying the
+ * recording with replayRecordedTraffic().
+ */
+(function() {
+    'use strict';
+
+    const recordingDir = MongoRunner.toRealPath('traffic_recording');
+    mkdir(recordingDir);
+
+    // Recording is refused unless a directory has been configured at startup.
+    let conn = MongoRunner.runMongod();
+    assert.commandFailedWithCode(
+        conn.adminCommand({startRecordingTraffic: 1, filename: "recording"}),
+        ErrorCodes.IllegalOperation);
+    MongoRunner.stopMongod(conn);
+
+    conn = MongoRunner.runMongod({setParameter: {trafficRecordingDirectory: recordingDir}});
+    const admin = conn.getDB('admin');
+    const coll = conn.getDB('test').traffic_recording;
+
+    assert.commandFailedWithCode(admin.runCommand({stopRecordingTraffic: 1}),
+                                 ErrorCodes.IllegalOperation);
+    assert.commandFailedWithCode(
+        admin.runCommand({startRecordingTraffic: 1, filename: "../escape"}), ErrorCodes.BadValue);
+
+    assert.commandWorked(admin.runCommand({startRecordingTraffic: 1, filename: "recording"}));
+    assert.commandFailedWithCode(
+        admin.runCommand({startRecordingTraffic: 1, filename: "recording2"}),
+        ErrorCodes.IllegalOperation);
+
+    for (let i = 0; i < 20; ++i) {
+        assert.writeOK(coll.insert({_id: i}));
+        assert.eq(1, coll.find({_id: i}).itcount());
+    }
+
+    const stopped = assert.commandWorked(admin.runCommand({stopRecordingTraffic: 1}));
+    assert.gte(stopped.packetsRecorded, 40, tojson(stopped));
+    assert.eq(0, stopped.packetsDropped, tojson(stopped));
+    assert.gt(stopped.bytesWritten, 0, tojson(stopped));
+
+    // Replay against a fresh collection, several times faster than recorded.
+    coll.drop();
+    const replay =
+        replayRecordedTraffic(recordingDir + "/recording", {host: conn.host, speed: 10});
+    assert.eq(1, replay.sessions, tojson(replay));
+    assert.gte(replay.requests, 40, tojson(replay));
+    assert.eq(0, replay.failed, tojson(replay));
+    assert.eq([], replay.errors, tojson(replay));
+    assert.eq(20, replay.commands.insert.count, tojson(replay));
+    assert.eq(20, replay.commands.find.count, tojson(replay));
+    assert.eq(20, coll.find().itcount());
+
+    const comparison = compareTrafficReplays(replay, replay);
+    assert.eq(1, comparison.commands.insert.p50Ratio, tojson(comparison));
+
+    // A recording stops by itself when it reaches its maximum size.
+    assert.commandWorked(admin.runCommand(
+        {startRecordingTraffic: 1, filename: "small", maxFileSize: 1024, bufferSize: 1024}));
+    for (let i = 0; i < 50; ++i) {
+        assert.commandWorked(admin.runCommand({ping: 1}));
+    }
+    const small = assert.commandWorked(admin.runCommand({stopRecordingTraffic: 1}));
+    assert.lte(small.bytesWritten, 1024, tojson(small));
+    assert(small.hasOwnProperty("stoppedEarly"), tojson(small));
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,71 @@
+/**
+ * Tests that the TTL monitor deletes expired documents in batches across several indexes, honors
+ * its per-index deadline, and reports per-index backlogs in serverStatus.
+ */
+(function() {
+    'use strict';
+
+    const conn = MongoRunner.runMongod(
+        {setParameter: {ttlMonitorSleepSecs: 1, ttlMonitorBatchSize: 7, ttlMonitorEnabled: false}});
+    const db = conn.getDB('test');
+    const numDocs = 50;
+
+    function waitForTTLPass() {
+        // The 'ttl.passes' metric is incremented when a pass starts, so two increments mean that
+        // at least one pass ran from start to finish.
+        const passes = db.serverStatus().metrics.ttl.passes;
+        assert.soon(function() {
+            return db.serverStatus().metrics.ttl.passes >= passes + 2;
+        });
+    }
+
+    function getIndexStats(collName) {
+        const indexes = db.serverStatus({ttlIndexes: 1}).ttlIndexes.indexes;
+        return indexes.find(function(index) {
+            return index.ns === 'test.' + collName;
+        });
+    }
+
+    const expired = new Date(Date.now() - 3600 * 1000);
+    ['ttlA', 'ttlB'].forEach(function(collName) {
+        const coll = db[collName];
+        assert.commandWorked(coll.createIndex({date: 1}, {expireAfterSeconds: 60}));
+        const bulk = coll.initializeUnorderedBulkOp();
+        for (let i = 0; i < numDocs; ++i) {
+            bulk.insert({date: expired});
+        }
+        bulk.insert({date: new Date()});
+        assert.writeOK(bulk.execute());
+    });
+
+    // With no time to spend on each index, nothing is deleted and the backlog is reported.
+    assert.commandWorked(db.adminCommand({setParameter: 1, ttlMonitorIndexDeadlineSecs: 0}));
+    assert.commandWorked(db.adminCommand({setParameter: 1, ttlMonitorEnabled: true}));
+    waitForTTLPass();
+
+    let stats = getIndexStats('ttlA');
+    assert.neq(undefined, stats);
+    assert.eq(false, stats.lastPassComplete, tojson(stats));
+    assert.eq(numDocs, stats.backlog, tojson(stats));
+    assert.eq(false, stats.backlogIsLowerBound, tojson(stats));
+    assert.eq(numDocs + 1, db.ttlA.count());
+
+    // Given time, both indexes are drained in batches.
+    assert.commandWorked(db.adminCommand({setParameter: 1, ttlMonitorIndexDeadlineSecs: 60}));
+    waitForTTLPass();
+
+    ['ttlA', 'ttlB'].forEach(function(collName) {
+        assert.eq(1, db[collName].count(), collName);
+        stats = getIndexStats(collName);
+        assert.eq(true, stats.lastPassComplete, tojson(stats));
+        assert.eq(0, stats.backlog, tojson(stats));
+        assert.eq(numDocs, stats.totalDeleted, tojson(stats));
+    });
+
+    // Statistics are dropped along with their index.
+    assert(db.ttlB.drop());
+    waitForTTLPass();
+    assert.eq(undefined, getIndexStats('ttlB'));
+
+    MongoRunner.stopMongod(conn);
+})();
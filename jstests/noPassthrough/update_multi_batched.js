@@ -0,0 +1,36 @@
+// Tests that multi-updates grouping documents into batches update every matching document once,
+// and report what they did when they fail part way through a batch.
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({setParameter: "internalQueryExecUpdateBatchSize=7"});
+    assert.neq(null, conn, "mongod was unable to start up");
+    const coll = conn.getDB("test").update_multi_batched;
+    coll.drop();
+
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < 100; ++i) {
+        bulk.insert({_id: i, x: i, padding: "x".repeat(i)});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.createIndex({x: 1}));
+
+    // Scanning the index being updated must not update any document twice.
+    let res = coll.update({x: {$gte: 0}}, {$inc: {x: 1000}}, {multi: true});
+    assert.writeOK(res);
+    assert.eq(100, res.nMatched);
+    assert.eq(100, res.nModified);
+    assert.eq(100, coll.find({x: {$gte: 1000, $lt: 1100}}).itcount());
+
+    // Updates which grow the documents.
+    res = coll.update({}, {$set: {padding: "y".repeat(200)}}, {multi: true});
+    assert.eq(100, res.nModified);
+
+    // A failure rolls back the batch it happens in, and the counts only cover what was kept.
+    assert.writeOK(coll.update({_id: 50}, {$set: {x: "not a number"}}));
+    res = coll.update({}, {$inc: {x: 1}, $set: {touched: true}}, {multi: true});
+    assert.writeError(res);
+    assert.eq(res.nModified, coll.find({touched: true}).itcount(), tojson(res));
+
+    MongoRunner.stopMongod(conn);
+}());
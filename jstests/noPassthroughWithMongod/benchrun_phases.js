@@ -0,0 +1,50 @@
+// Tests the open-loop, phased mode of benchRun and the latency percentiles it reports.
+(function() {
+    "use strict";
+
+    const coll = db.benchrun_phases;
+    coll.drop();
+    assert.writeOK(coll.insert({_id: 1, x: 1}));
+
+    const ops = [{op: "findOne", ns: coll.getFullName(), query: {_id: 1}}];
+
+    // A run paced at a target rate should come in close to that rate, rather than as fast as the
+    // server can answer.
+    let res = benchRun({
+        ops: ops,
+        parallel: 2,
+        seconds: 4,
+        opsPerSecond: 100,
+        host: db.getMongo().host,
+    });
+    assert.lte(res.findOne, 110, tojson(res));
+    assert.gte(res.findOne, 50, tojson(res));
+    assert.eq(1, res.phases.length, tojson(res));
+
+    const latencies = res.findOneLatencyMicros;
+    assert(latencies, tojson(res));
+    assert.lte(latencies.p50, latencies.p90, tojson(res));
+    assert.lte(latencies.p90, latencies.p99, tojson(res));
+    assert.lte(latencies.p99, latencies.p999, tojson(res));
+    assert.lte(latencies.p999, latencies.max, tojson(res));
+
+    // Each phase reports its own results, and a phase that isn't recorded is left out of the
+    // overall ones.
+    res = benchRun({
+        ops: ops,
+        parallel: 1,
+        phases: [
+            {name: "warmup", seconds: 2, opsPerSecond: 50, recordStats: false},
+            {name: "steady", seconds: 2, opsPerSecond: 100},
+            {name: "spike", seconds: 2, opsPerSecond: 400},
+        ],
+        host: db.getMongo().host,
+    });
+    assert.eq(3, res.phases.length, tojson(res));
+    assert.eq(["warmup", "steady", "spike"], res.phases.map(phase => phase.name), tojson(res));
+    assert.gt(res.phases[2].totalOps, res.phases[1].totalOps, tojson(res));
+    assert.eq(res.totalOps, res.phases[1].totalOps + res.phases[2].totalOps, tojson(res));
+    res.phases.forEach(phase => assert(phase.findOneLatencyMicros, tojson(res)));
+
+    assert.throws(() => benchRun({ops: ops, phases: [{name: "empty", seconds: 0}]}));
+})();
@@ -0,0 +1,75 @@
+/**
+ * Tests that measurements inserted into a time-series collection are stored in buckets grouped by
+ * meta value and time window, and read back unchanged through the collection's view.
+ */
+(function() {
+    "use strict";
+
+    const testDB = db.getSiblingDB("timeseries_basic");
+    assert.commandWorked(testDB.dropDatabase());
+
+    const coll = testDB.weather;
+    const buckets = testDB.system.buckets.weather;
+
+    assert.commandFailedWithCode(
+        testDB.createCollection(coll.getName(), {timeseries: {metaField: "sensor"}}),
+        ErrorCodes.BadValue);
+    assert.commandFailedWithCode(
+        testDB.createCollection(coll.getName(),
+                                {timeseries: {timeField: "time"}, capped: true, size: 1024}),
+        ErrorCodes.InvalidOptions);
+    assert.commandWorked(testDB.createCollection(
+        coll.getName(), {timeseries: {timeField: "time", metaField: "sensor"}}));
+
+    const start = ISODate("2017-01-01T00:00:00Z");
+    const docs = [];
+    for (let i = 0; i < 20; i++) {
+        docs.push({
+            _id: i,
+            time: new Date(start.getTime() + i * 60 * 1000),
+            sensor: {id: i % 2},
+            temp: 20 + i
+        });
+    }
+    assert.commandWorked(coll.insert(docs.slice(0, 10), {ordered: true}));
+    assert.commandWorked(coll.insert(docs.slice(10), {ordered: false}));
+
+    // Two sensors within one hour fill two buckets.
+    assert.eq(2, buckets.find().itcount());
+    assert.eq(10, Object.keys(buckets.findOne({"meta.id": 0}).data.time).length);
+
+    assert.eq(docs, coll.find().sort({_id: 1}).toArray());
+    assert.eq(docs.filter(doc => doc.sensor.id === 1),
+              coll.find({"sensor.id": 1}).sort({_id: 1}).toArray());
+
+    // Time range predicates select buckets through their control fields.
+    const from = new Date(start.getTime() + 5 * 60 * 1000);
+    const to = new Date(start.getTime() + 8 * 60 * 1000);
+    assert.eq([5, 6, 7],
+              coll.find({time: {$gte: from, $lt: to}}, {_id: 1})
+                  .sort({_id: 1})
+                  .toArray()
+                  .map(doc => doc._id));
+    const explain = coll.explain().aggregate([{$match: {time: {$gte: from}, "sensor.id": 0}}]);
+    assert(JSON.stringify(explain).includes("control.max.time"), tojson(explain));
+
+    // Measurements must have a valid time.
+    let res = coll.insert([{_id: 100, time: start}, {_id: 101}, {_id: 102, time: start}],
+                          {ordered: true});
+    assert.eq(1, res.nInserted, tojson(res));
+    res = coll.insert([{_id: 103, time: "now"}, {_id: 104, time: start}], {ordered: false});
+    assert.eq(1, res.nInserted, tojson(res));
+    assert.eq(1, res.getWriteErrors().length, tojson(res));
+    assert.eq(22, coll.find().itcount());
+
+    // Other views still reject inserts.
+    assert.commandWorked(testDB.createView("hot", coll.getName(), [{$match: {temp: {$gt: 30}}}]));
+    assert.writeErrorWithCode(testDB.hot.insert({time: start}),
+                              ErrorCodes.CommandNotSupportedOnView);
+    assert(testDB.hot.drop());
+
+    // Dropping the collection drops its buckets.
+    assert(coll.drop());
+    assert.eq(0, testDB.getCollectionNames().filter(name => name.startsWith("system.buckets"))
+                     .length);
+})();
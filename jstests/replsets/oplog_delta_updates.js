@@ -0,0 +1,55 @@
+/**
+ * Tests that with oplogDeltaUpdateMinBytes set, updates making small changes to large arrays are
+ * logged as document diffs, and that secondaries apply them to the same result.
+ */
+(function() {
+    "use strict";
+
+    const replTest =
+        new ReplSetTest({nodes: 2, nodeOptions: {setParameter: "oplogDeltaUpdateMinBytes=1"}});
+    replTest.startSet();
+    replTest.initiate();
+
+    const primary = replTest.getPrimary();
+    const coll = primary.getDB("test").oplog_delta_updates;
+
+    function lastOplogEntry() {
+        return primary.getDB("local").oplog.rs.find().sort({$natural: -1}).limit(1).next();
+    }
+
+    const items = [];
+    for (let i = 0; i < 200; ++i) {
+        items.push({sku: i, qty: 1, name: "item " + i});
+    }
+    assert.writeOK(coll.insert({_id: 0, cart: items, total: 200}));
+
+    // Each of these changes the end of the array, but would otherwise log all of it.
+    const updates = [
+        {$push: {cart: {$each: [{sku: 200, qty: 1, name: "item 200"}], $slice: 500}}},
+        {$pull: {cart: {sku: 195}}, $inc: {total: -1}},
+        {$pop: {cart: 1}},
+    ];
+    for (let update of updates) {
+        assert.writeOK(coll.update({_id: 0}, update));
+        const entry = lastOplogEntry();
+        assert.eq(2, entry.o.$v, tojson(update));
+        assert(entry.o.hasOwnProperty("diff"), tojson(entry));
+        assert.lt(Object.bsonsize(entry.o), 2 * 1024, tojson(update));
+    }
+
+    // A small document keeps the usual oplog entry, which is smaller than its diff.
+    assert.writeOK(coll.insert({_id: 1, a: 1}));
+    assert.writeOK(coll.update({_id: 1}, {$set: {a: 2}}));
+    assert.eq({$v: 1, $set: {a: 2}}, lastOplogEntry().o);
+
+    replTest.awaitReplication();
+    const primaryDocs = coll.find().sort({_id: 1}).toArray();
+    const secondary = replTest.getSecondary();
+    secondary.setSlaveOk();
+    const secondaryDocs =
+        secondary.getDB("test").oplog_delta_updates.find().sort({_id: 1}).toArray();
+    assert.eq(primaryDocs, secondaryDocs);
+    replTest.checkReplicatedDataHashes();
+
+    replTest.stopSet();
+}());
@@ -28,6 +28,25 @@ function testSecondaryMetrics(secondary, opCount, offset) {
     assert(ss.metrics.repl.apply.batches.num > 0, "no batches");
     assert(ss.metrics.repl.apply.batches.totalMillis >= 0, "missing batch time");
     assert.eq(ss.metrics.repl.apply.ops, opCount + offset, "wrong number of applied ops");
+    assert(ss.metrics.repl.apply.parallelism.chains > 0, "no dependency chains");
+    assert(ss.metrics.repl.apply.parallelism.writersUsed >= ss.metrics.repl.apply.batches.num,
+           "missing writers used");
+    assert.lte(ss.metrics.repl.apply.parallelism.maxWriterOps,
+               ss.metrics.repl.apply.ops,
+               "max writer ops exceeds applied ops");
+    assert(ss.metrics.repl.apply.writers.steals >= 0, "missing writer steals");
+    assert(ss.metrics.repl.apply.writers.idleMicros >= 0, "missing writer idle time");
+
+    var pipeline = ss.metrics.repl.pipeline;
+    assert(pipeline.fetch.num > 0, "no fetch latencies");
+    assert(pipeline.bufferWait.num > 0, "no buffer waits");
+    assert(pipeline.batchFormation.num > 0, "no batch formation times");
+    assert(pipeline.oplogWrite.num > 0, "no oplog write times");
+    assert(pipeline.writerApply.num > 0, "no writer apply times");
+    assert(pipeline.journalWait.num >= 0, "missing journal wait times");
+    assert.eq(pipeline.oplogWrite.num, ss.metrics.repl.apply.batches.num, "oplog writes != batches");
+    assert.eq(pipeline.writerApply.buckets.length, 25, "wrong number of buckets");
+    assert.lte(pipeline.writerApply.p50Micros, pipeline.writerApply.p99Micros, "p50 > p99");
 }
 
 var rt = new ReplSetTest({name: "server_status_metrics", nodes: 2, oplogSize: 100});
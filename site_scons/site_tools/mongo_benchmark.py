@@ -0,0 +1,47 @@
+"""Pseudo-builders for building, registering and running microbenchmarks.
+"""
+import os
+
+from SCons.Script import Action
+
+def exists(env):
+    return True
+
+_benchmarks = []
+def register_benchmark(env, benchmark):
+    installed_benchmark = env.Install("#/build/benchmarks/", benchmark)
+    _benchmarks.append(installed_benchmark[0].path)
+
+    # Running the benchmark is part of building the alias, so that "scons benchmarks" leaves a
+    # JSON report per benchmark next to it, which can be compared against other builds.
+    name = os.path.splitext(installed_benchmark[0].name)[0]
+    report = env.Command("#/build/benchmarks/%s.json" % name, installed_benchmark,
+            Action("$SOURCE --out $TARGET", "Running benchmark $SOURCE"))
+    env.AlwaysBuild(report)
+    env.Alias('$BENCHMARK_ALIAS', report)
+
+def benchmark_list_builder_action(env, target, source):
+    ofile = open(str(target[0]), 'wb')
+    try:
+        for s in _benchmarks:
+            print '\t' + str(s)
+            ofile.write('%s\n' % s)
+    finally:
+        ofile.close()
+
+def build_cpp_benchmark(env, target, source, **kwargs):
+    libdeps = kwargs.get('LIBDEPS', [])
+    libdeps.append( '$BUILD_DIR/mongo/unittest/benchmark_main' )
+
+    kwargs['LIBDEPS'] = libdeps
+
+    result = env.Program(target, source, **kwargs)
+    env.RegisterBenchmark(result[0])
+    return result
+
+def generate(env):
+    env.Command('$BENCHMARK_LIST', env.Value(_benchmarks),
+            Action(benchmark_list_builder_action, "Generating $TARGET"))
+    env.AddMethod(register_benchmark, 'RegisterBenchmark')
+    env.AddMethod(build_cpp_benchmark, 'CppBenchmark')
+    env.Alias('$BENCHMARK_ALIAS', '$BENCHMARK_LIST')
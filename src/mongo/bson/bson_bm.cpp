@@ -0,0 +1,109 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/bson/bson_validate.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/benchmark.h"
+
+namespace mongo {
+namespace {
+
+std::vector<std::string> makeFieldNames(int64_t numFields) {
+    std::vector<std::string> names;
+    for (int64_t i = 0; i < numFields; ++i) {
+        names.push_back("field" + std::to_string(i));
+    }
+    return names;
+}
+
+// Builds a document with a mix of the types most common in user data: numbers, short strings and
+// small embedded objects.
+BSONObj makeDocument(const std::vector<std::string>& names) {
+    BSONObjBuilder builder;
+    for (size_t i = 0; i < names.size(); ++i) {
+        switch (i % 4) {
+            case 0:
+                builder.append(names[i], static_cast<int>(i));
+                break;
+            case 1:
+                builder.append(names[i], "a short string value");
+                break;
+            case 2:
+                builder.append(names[i], i * 1.5);
+                break;
+            case 3: {
+                BSONObjBuilder subobj(builder.subobjStart(names[i]));
+                subobj.append("x", static_cast<long long>(i));
+                subobj.append("y", true);
+                break;
+            }
+        }
+    }
+    return builder.obj();
+}
+
+void BM_buildDocument(benchmark::State& state) {
+    const auto names = makeFieldNames(state.arg());
+    for (auto _ : state) {
+        benchmark::doNotOptimizeAway(makeDocument(names));
+    }
+    state.setItemsProcessed(state.iterations() * state.arg());
+}
+BENCHMARK(BM_buildDocument)->arg(10)->arg(100);
+
+void BM_validateBSON(benchmark::State& state) {
+    const auto doc = makeDocument(makeFieldNames(state.arg()));
+    for (auto _ : state) {
+        benchmark::doNotOptimizeAway(
+            validateBSON(doc.objdata(), doc.objsize(), BSONVersion::kLatest).isOK());
+    }
+    state.setBytesProcessed(state.iterations() * doc.objsize());
+}
+BENCHMARK(BM_validateBSON)->arg(10)->arg(100)->arg(1000);
+
+void BM_iterateDocument(benchmark::State& state) {
+    const auto doc = makeDocument(makeFieldNames(state.arg()));
+    for (auto _ : state) {
+        int numFields = 0;
+        for (auto elem : doc) {
+            numFields += elem.eoo() ? 0 : 1;
+        }
+        benchmark::doNotOptimizeAway(numFields);
+    }
+    state.setItemsProcessed(state.iterations() * state.arg());
+}
+BENCHMARK(BM_iterateDocument)->arg(10)->arg(100);
+
+}  // namespace
+}  // namespace mongo
@@ -27,9 +27,10 @@
  *    then also delete it in the license file.
  */
 
+#include <array>
+#include <boost/container/small_vector.hpp>
 #include <cstring>
 #include <limits>
-#include <vector>
 
 #include "mongo/base/data_view.h"
 #include "mongo/bson/bson_depth.h"
@@ -167,6 +168,43 @@ private:
     BSONVersion _version;
 };
 
+/**
+ * Size of the value of each BSON type whose value has a fixed width and needs no further checks,
+ * indexed by the type byte. Types which need more than a bounds check map to -1.
+ */
+class FixedValueSizes {
+public:
+    FixedValueSizes() {
+        _sizes.fill(-1);
+        set(MinKey, 0);
+        set(MaxKey, 0);
+        set(jstNULL, 0);
+        set(Undefined, 0);
+        set(jstOID, OID::kOIDSize);
+        set(NumberInt, sizeof(int32_t));
+        set(NumberDouble, sizeof(int64_t));
+        set(NumberLong, sizeof(int64_t));
+        set(bsonTimestamp, sizeof(int64_t));
+        set(Date, sizeof(int64_t));
+    }
+
+    int operator[](signed char type) const {
+        return _sizes[static_cast<unsigned char>(type)];
+    }
+
+private:
+    void set(BSONType type, int size) {
+        _sizes[static_cast<unsigned char>(static_cast<signed char>(type))] = size;
+    }
+
+    std::array<int, 256> _sizes;
+};
+
+const FixedValueSizes& fixedValueSizes() {
+    static const FixedValueSizes sizes;
+    return sizes;
+}
+
 struct ValidationState {
     enum State { BeginObj = 1, WithinObj, EndObj, BeginCodeWScope, EndCodeWScope, Done };
 };
@@ -219,23 +257,16 @@ Status validateElementInfo(Buffer* buffer,
     if (!status.isOK())
         return status;
 
-    switch (type) {
-        case MinKey:
-        case MaxKey:
-        case jstNULL:
-        case Undefined:
-            return Status::OK();
-
-        case jstOID:
-            if (!buffer->skip(OID::kOIDSize))
-                return makeError("invalid bson", idElem, *elemName);
-            return Status::OK();
-
-        case NumberInt:
-            if (!buffer->skip(sizeof(int32_t)))
-                return makeError("invalid bson", idElem, *elemName);
-            return Status::OK();
+    // Most elements in real documents are numbers, dates and ObjectIds, which only need their
+    // width checked against the buffer.
+    const int fixedSize = fixedValueSizes()[type];
+    if (fixedSize >= 0) {
+        if (fixedSize > 0 && !buffer->skip(fixedSize))
+            return makeError("invalid bson", idElem, *elemName);
+        return Status::OK();
+    }
 
+    switch (type) {
         case Bool:
             uint8_t val;
             if (!buffer->readNumber(&val))
@@ -244,14 +275,6 @@ Status validateElementInfo(Buffer* buffer,
                 return makeError("invalid boolean value", idElem, *elemName);
             return Status::OK();
 
-        case NumberDouble:
-        case NumberLong:
-        case bsonTimestamp:
-        case Date:
-            if (!buffer->skip(sizeof(int64_t)))
-                return makeError("invalid bson", idElem, *elemName);
-            return Status::OK();
-
         case NumberDecimal:
             if (!buffer->skip(sizeof(Decimal128::Value)))
                 return makeError("Invalid bson", idElem, *elemName);
@@ -308,8 +331,8 @@ Status validateElementInfo(Buffer* buffer,
 }
 
 Status validateBSONIterative(Buffer* buffer) {
-    std::vector<ValidationObjectFrame> frames;
-    frames.reserve(16);
+    // Documents rarely nest deeper than this, so validating them does not touch the heap.
+    boost::container::small_vector<ValidationObjectFrame, 32> frames;
     ValidationObjectFrame* curr = NULL;
     ValidationState::State state = ValidationState::BeginObj;
 
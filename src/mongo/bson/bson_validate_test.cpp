@@ -35,6 +35,7 @@
 #include "mongo/platform/random.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace {
 
@@ -354,4 +355,65 @@ TEST(BSONValidateBool, BoolValuesAreValidated) {
     }
 }
 
+TEST(BSONValidateFixedWidth, TruncatedValuesAreRejected) {
+    const BSONObj values = BSON("oid" << OID::gen() << "int" << 1 << "double" << 1.5 << "long"
+                                      << 1LL
+                                      << "ts"
+                                      << Timestamp(1, 1)
+                                      << "date"
+                                      << Date_t::now());
+    for (auto&& elem : values) {
+        BSONObjBuilder bob;
+        bob.append(elem);
+        BSONObj obj = bob.obj();
+        ASSERT_OK(validateBSON(obj.objdata(), obj.objsize(), BSONVersion::kLatest));
+
+        // Drop the EOO and the last byte of the value, then patch the size to match.
+        BufBuilder bb;
+        bb.appendBuf(obj.objdata(), obj.objsize() - 2);
+        bb.appendChar(EOO);
+        DataView(bb.buf()).write(tagLittleEndian(bb.len()));
+        const Status status = validateBSON(bb.buf(), bb.len(), BSONVersion::kLatest);
+        ASSERT_EQ(ErrorCodes::InvalidBSON, status) << elem.fieldName();
+    }
+}
+
+TEST(BSONValidatePerf, InsertBatch) {
+    // Roughly what a driver sends for a batch of 1000 small documents.
+    BSONArrayBuilder docs;
+    for (int i = 0; i < 1000; ++i) {
+        docs.append(BSON("_id" << OID::gen() << "user" << i << "name"
+                               << "user name " + std::to_string(i)
+                               << "created"
+                               << Date_t::now()
+                               << "score"
+                               << i * 1.5
+                               << "tags"
+                               << BSON_ARRAY("a"
+                                             << "b")
+                               << "address"
+                               << BSON("city"
+                                       << "New York"
+                                       << "zip"
+                                       << 10001)));
+    }
+    const BSONObj batch = BSON("insert"
+                               << "coll"
+                               << "documents"
+                               << docs.arr());
+
+    uint64_t micros = 0;
+    uint64_t iters;
+    for (iters = 16; iters < (1 << 30) && micros < 20 * 1000; iters *= 2) {
+        Timer t;
+        for (uint64_t i = 0; i < iters; ++i) {
+            ASSERT_OK(validateBSON(batch.objdata(), batch.objsize(), BSONVersion::kLatest));
+        }
+        micros = t.micros();
+    }
+
+    log() << 1E3 * micros / static_cast<double>(iters) << " ns per validation of a "
+          << batch.objsize() << " byte insert" << (kDebugBuild ? " (DEBUG BUILD!)" : "");
+}
+
 }  // namespace
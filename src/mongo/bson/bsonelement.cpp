@@ -55,12 +55,20 @@ using std::string;
 
 string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames, int pretty) const {
     std::stringstream s;
+    jsonStringStream(format, includeFieldNames, pretty, s);
+    return s.str();
+}
+
+void BSONElement::jsonStringStream(JsonStringFormat format,
+                                   bool includeFieldNames,
+                                   int pretty,
+                                   std::stringstream& s) const {
     if (includeFieldNames)
-        s << '"' << escape(fieldName()) << "\" : ";
+        s << '"' << escape(fieldNameStringData()) << "\" : ";
     switch (type()) {
         case mongo::String:
         case Symbol:
-            s << '"' << escape(string(valuestr(), valuestrsize() - 1)) << '"';
+            s << '"' << escape(valueStringData()) << '"';
             break;
         case NumberLong:
             if (format == TenGen) {
@@ -127,7 +135,7 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
             }
             break;
         case Object:
-            s << embeddedObject().jsonString(format, pretty);
+            embeddedObject().jsonStringStream(format, pretty, false, s);
             break;
         case mongo::Array: {
             if (embeddedObject().isEmpty()) {
@@ -149,7 +157,7 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
                     if (strtol(e.fieldName(), 0, 10) > count) {
                         s << "undefined";
                     } else {
-                        s << e.jsonString(format, false, pretty ? pretty + 1 : 0);
+                        e.jsonStringStream(format, false, pretty ? pretty + 1 : 0, s);
                         e = i.next();
                     }
                     count++;
@@ -266,7 +274,9 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
             BSONObj scope = codeWScopeObject();
             if (!scope.isEmpty()) {
                 s << "{ \"$code\" : \"" << escape(_asCode()) << "\" , "
-                  << "\"$scope\" : " << scope.jsonString() << " }";
+                  << "\"$scope\" : ";
+                scope.jsonStringStream(Strict, 0, false, s);
+                s << " }";
                 break;
             }
         }
@@ -301,7 +311,6 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
             string message = ss.str();
             massert(10312, message.c_str(), false);
     }
-    return s.str();
 }
 
 namespace {
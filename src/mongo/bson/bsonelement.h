@@ -31,6 +31,7 @@
 
 #include <cmath>
 #include <cstdint>
+#include <iosfwd>
 #include <string.h>  // strlen
 #include <string>
 #include <vector>
@@ -210,6 +211,15 @@ public:
     std::string jsonString(JsonStringFormat format,
                            bool includeFieldNames = true,
                            int pretty = 0) const;
+
+    /**
+     * Appends the jsonString() of this element to 's', so that nested elements all write into the
+     * one stream instead of each building a string for its parent to copy.
+     */
+    void jsonStringStream(JsonStringFormat format,
+                          bool includeFieldNames,
+                          int pretty,
+                          std::stringstream& s) const;
     operator std::string() const {
         return toString();
     }
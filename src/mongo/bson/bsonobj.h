@@ -30,6 +30,7 @@
 #pragma once
 
 #include <bitset>
+#include <iosfwd>
 #include <list>
 #include <set>
 #include <string>
@@ -252,6 +253,12 @@ public:
                            int pretty = 0,
                            bool isArray = false) const;
 
+    /** Appends the jsonString() of this object to 's'. */
+    void jsonStringStream(JsonStringFormat format,
+                          int pretty,
+                          bool isArray,
+                          std::stringstream& s) const;
+
     /** note: addFields always adds _id even if not specified */
     int addFields(BSONObj& from, std::set<std::string>& fields); /* returns n added */
 
@@ -1184,7 +1184,14 @@ Status JParse::chars(std::string* result, const char* terminalSet, const char* a
             }
             ++q;
         } else {
-            result->push_back(*q++);
+            // Copy the whole run of plain characters up to the next escape, control character or
+            // terminator with one append.
+            const char* runStart = q;
+            do {
+                ++q;
+            } while (q < _input_end && *q != '\\' && !(0x00 <= *q && *q <= 0x1F) &&
+                     !match(*q, terminalSet) && (allowedSet == NULL || match(*q, allowedSet)));
+            result->append(runStart, q);
         }
     }
     if (q < _input_end) {
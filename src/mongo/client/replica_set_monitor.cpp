@@ -42,6 +42,8 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/bson_extract_optime.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/executor/host_load_tracker.h"
 #include "mongo/s/grid.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
@@ -65,6 +67,11 @@ using std::vector;
 // Failpoint for disabling AsyncConfigChangeHook calls on updated RS nodes.
 MONGO_FP_DECLARE(failAsyncConfigChangeHook);
 
+// When set, a host is chosen among the members within the latency window by comparing two of
+// them at random and taking the one with the lower expected cost, based on the latency and number
+// of in-flight commands this process observes for it, rather than uniformly at random.
+MONGO_EXPORT_SERVER_PARAMETER(replicaSetMonitorLoadAwareHostSelection, bool, false);
+
 namespace {
 
 // Pull nested types to top-level scope
@@ -1147,6 +1154,20 @@ HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria) con
                 if (ReplicaSetMonitor::useDeterministicHostSelection) {
                     // only in tests
                     return matchingNodes[roundRobin++ % matchingNodes.size()]->host;
+                } else if (replicaSetMonitorLoadAwareHostSelection.load() &&
+                           matchingNodes.size() > 1) {
+                    // power of two choices: the less loaded of two distinct random nodes
+                    const size_t first = rand.nextInt32(matchingNodes.size());
+                    const size_t second =
+                        (first + 1 + rand.nextInt32(matchingNodes.size() - 1)) %
+                        matchingNodes.size();
+                    const auto& loads = executor::HostLoadTracker::get();
+                    const Node* a = matchingNodes[first];
+                    const Node* b = matchingNodes[second];
+                    return loads.cost(a->host, a->latencyMicros) <=
+                            loads.cost(b->host, b->latencyMicros)
+                        ? a->host
+                        : b->host;
                 } else {
                     // normal case
                     return matchingNodes[rand.nextInt32(matchingNodes.size())]->host;
@@ -213,6 +213,7 @@ MONGO_INITIALIZER(AuthorizationBuiltinRoles)(InitializerContext* context) {
         << ActionType::setParameter
         << ActionType::shutdown
         << ActionType::touch
+        << ActionType::trafficRecord
         << ActionType::unlock
         << ActionType::flushRouterConfig  // clusterManager gets this also
         << ActionType::fsync
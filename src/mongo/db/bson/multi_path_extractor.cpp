@@ -0,0 +1,152 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/bson/multi_path_extractor.h"
+
+#include <cstdint>
+
+namespace mongo {
+
+MultiPathExtractor::MultiPathExtractor(const std::vector<StringData>& paths)
+    : _nodes(1), _numPaths(paths.size()) {
+    for (size_t i = 0; i < paths.size(); ++i) {
+        StringData path = paths[i];
+        _pathLengths.push_back(path.size());
+
+        // Split the path the same way extractElementAtPathOrArrayAlongPath() does, so that a
+        // trailing "." ends the path.
+        size_t node = 0;
+        size_t pos = 0;
+        while (true) {
+            size_t dot = path.find('.', pos);
+            StringData part =
+                path.substr(pos, dot == std::string::npos ? std::string::npos : dot - pos);
+
+            size_t next = 0;
+            for (size_t child : _nodes[node].children) {
+                if (_nodes[child].fieldName == part) {
+                    next = child;
+                    break;
+                }
+            }
+            if (next == 0) {
+                next = _nodes.size();
+                _nodes.emplace_back();
+                _nodes.back().fieldName = part.toString();
+                _nodes[node].children.push_back(next);
+            }
+            node = next;
+
+            if (dot == std::string::npos || dot + 1 == path.size()) {
+                _nodes[node].pathsEndingHere.push_back(i);
+                break;
+            }
+            _nodes[node].pathsContinuing.push_back(i);
+            _nodes[node].suffixOffset = dot + 1;
+            pos = dot + 1;
+        }
+    }
+}
+
+void MultiPathExtractor::extractElementsAtPathsOrArraysAlongPaths(
+    const BSONObj& obj,
+    std::vector<BSONElement>* elements,
+    std::vector<size_t>* suffixOffsets) const {
+    elements->assign(_numPaths, BSONElement());
+    suffixOffsets->assign(_pathLengths.begin(), _pathLengths.end());
+    _extract(0, obj, elements, suffixOffsets);
+}
+
+void MultiPathExtractor::_extract(size_t node,
+                                  const BSONObj& obj,
+                                  std::vector<BSONElement>* elements,
+                                  std::vector<size_t>* suffixOffsets) const {
+    const auto& children = _nodes[node].children;
+
+    // Like BSONObj::getField(), only the first field with a given name counts. Which children
+    // have been found is tracked in a bit mask, spilling to a vector for very wide nodes.
+    const size_t kMaskBits = 64;
+    uint64_t foundMask = 0;
+    std::vector<bool> foundOverflow(children.size() > kMaskBits ? children.size() - kMaskBits : 0);
+
+    size_t remaining = children.size();
+    BSONObjIterator it(obj);
+    while (remaining > 0 && it.more()) {
+        BSONElement elem = it.next();
+        StringData fieldName = elem.fieldNameStringData();
+        for (size_t j = 0; j < children.size(); ++j) {
+            if (_nodes[children[j]].fieldName != fieldName) {
+                continue;
+            }
+
+            if (j < kMaskBits) {
+                const uint64_t bit = uint64_t{1} << j;
+                if (foundMask & bit) {
+                    break;
+                }
+                foundMask |= bit;
+            } else {
+                if (foundOverflow[j - kMaskBits]) {
+                    break;
+                }
+                foundOverflow[j - kMaskBits] = true;
+            }
+
+            --remaining;
+            _visit(children[j], elem, elements, suffixOffsets);
+            break;
+        }
+    }
+}
+
+void MultiPathExtractor::_visit(size_t node,
+                                const BSONElement& elem,
+                                std::vector<BSONElement>* elements,
+                                std::vector<size_t>* suffixOffsets) const {
+    const Node& n = _nodes[node];
+    for (size_t path : n.pathsEndingHere) {
+        (*elements)[path] = elem;
+    }
+
+    if (n.pathsContinuing.empty()) {
+        return;
+    }
+
+    if (elem.type() == Array) {
+        for (size_t path : n.pathsContinuing) {
+            (*elements)[path] = elem;
+            (*suffixOffsets)[path] = n.suffixOffset;
+        }
+    } else if (elem.type() == Object) {
+        _extract(node, elem.embeddedObject(), elements, suffixOffsets);
+    }
+}
+
+}  // namespace mongo
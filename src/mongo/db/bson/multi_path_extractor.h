@@ -0,0 +1,103 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
+
+namespace mongo {
+
+/**
+ * Extracts the elements at a fixed set of dotted paths from documents. The paths are merged into a
+ * tree of field names when the extractor is built, so that every requested path is found during a
+ * single scan of each object along the way, instead of each path rescanning the document from its
+ * first field.
+ *
+ * A MultiPathExtractor is immutable once built and may be shared between threads.
+ */
+class MultiPathExtractor {
+public:
+    explicit MultiPathExtractor(const std::vector<StringData>& paths);
+
+    size_t numPaths() const {
+        return _numPaths;
+    }
+
+    /**
+     * Sets (*elements)[i] to what dotted_path_support::extractElementAtPathOrArrayAlongPath() would
+     * return for the i-th path: the element at the path, or the first element with an array value
+     * along it, or BSONElement() if there is neither.
+     *
+     * When an array is found before the end of the i-th path, (*suffixOffsets)[i] is set to the
+     * offset of the rest of the path past the array, which is what
+     * extractElementAtPathOrArrayAlongPath() would advance it to. It is set to the length of the
+     * path otherwise.
+     */
+    void extractElementsAtPathsOrArraysAlongPaths(const BSONObj& obj,
+                                                  std::vector<BSONElement>* elements,
+                                                  std::vector<size_t>* suffixOffsets) const;
+
+private:
+    struct Node {
+        std::string fieldName;
+
+        std::vector<size_t> children;
+
+        // The paths which end at this node.
+        std::vector<size_t> pathsEndingHere;
+
+        // The paths which go on past this node, and the offset in each of them of the rest of the
+        // path past this node.
+        std::vector<size_t> pathsContinuing;
+        size_t suffixOffset = 0;
+    };
+
+    void _extract(size_t node,
+                  const BSONObj& obj,
+                  std::vector<BSONElement>* elements,
+                  std::vector<size_t>* suffixOffsets) const;
+
+    void _visit(size_t node,
+                const BSONElement& elem,
+                std::vector<BSONElement>* elements,
+                std::vector<size_t>* suffixOffsets) const;
+
+    // Node 0 is the root and stands for the document itself.
+    std::vector<Node> _nodes;
+
+    std::vector<size_t> _pathLengths;
+
+    size_t _numPaths;
+};
+
+}  // namespace mongo
@@ -0,0 +1,120 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/json.h"
+#include "mongo/db/bson/dotted_path_support.h"
+#include "mongo/db/bson/multi_path_extractor.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+namespace dps = ::mongo::dotted_path_support;
+
+/**
+ * Checks that extracting 'paths' together from each of 'docs' gives the same elements and path
+ * suffixes as extracting them one at a time with extractElementAtPathOrArrayAlongPath().
+ */
+void assertSameAsOneAtATime(const std::vector<std::string>& paths,
+                            const std::vector<const char*>& docs) {
+    std::vector<StringData> pathData(paths.begin(), paths.end());
+    MultiPathExtractor extractor(pathData);
+    ASSERT_EQ(paths.size(), extractor.numPaths());
+
+    for (auto&& doc : docs) {
+        BSONObj obj = fromjson(doc);
+        std::vector<BSONElement> elements;
+        std::vector<size_t> suffixOffsets;
+        extractor.extractElementsAtPathsOrArraysAlongPaths(obj, &elements, &suffixOffsets);
+        ASSERT_EQ(paths.size(), elements.size());
+        ASSERT_EQ(paths.size(), suffixOffsets.size());
+
+        for (size_t i = 0; i < paths.size(); ++i) {
+            const char* path = paths[i].c_str();
+            BSONElement expected = dps::extractElementAtPathOrArrayAlongPath(obj, path);
+            ASSERT_EQ(expected.rawdata(), elements[i].rawdata()) << doc << " " << paths[i];
+            if (expected.type() == Array) {
+                ASSERT_EQ(static_cast<size_t>(path - paths[i].c_str()), suffixOffsets[i])
+                    << doc << " " << paths[i];
+            }
+        }
+    }
+}
+
+const std::vector<const char*> kDocs = {"{}",
+                                        "{a: 1}",
+                                        "{a: {b: 1, c: 2}, d: 3}",
+                                        "{d: 3, a: {c: {e: 1}, b: 2}}",
+                                        "{a: [1, 2]}",
+                                        "{a: [{b: 1}, {b: 2}]}",
+                                        "{a: {b: [1, 2], c: {e: [3]}}}",
+                                        "{a: {b: 1}, a: {b: 2}}",
+                                        "{a: 1, a: {b: 2}}",
+                                        "{a: {'': 1}, '': 2}",
+                                        "{a: {b: {}}}",
+                                        "{'a.b': 1, a: {b: 2}}"};
+
+TEST(MultiPathExtractor, SinglePath) {
+    assertSameAsOneAtATime({"a"}, kDocs);
+    assertSameAsOneAtATime({"a.b"}, kDocs);
+    assertSameAsOneAtATime({"a.c.e"}, kDocs);
+}
+
+TEST(MultiPathExtractor, PathsSharingPrefixes) {
+    assertSameAsOneAtATime({"a.b", "a.c", "d"}, kDocs);
+    assertSameAsOneAtATime({"a", "a.b", "a.c.e"}, kDocs);
+    assertSameAsOneAtATime({"d", "a.c.e", "a.b", "x.y"}, kDocs);
+}
+
+TEST(MultiPathExtractor, RepeatedPaths) {
+    assertSameAsOneAtATime({"a.b", "a.b"}, kDocs);
+}
+
+TEST(MultiPathExtractor, UnusualPaths) {
+    assertSameAsOneAtATime({"", "a.", "a..b", ".a", "a.b."}, kDocs);
+}
+
+TEST(MultiPathExtractor, ManyPathsUnderOneField) {
+    std::vector<std::string> paths;
+    std::string doc = "{a: {";
+    for (int i = 0; i < 100; ++i) {
+        paths.push_back("a.f" + std::to_string(i));
+        doc += "f" + std::to_string(99 - i) + ": " + std::to_string(i) + ", ";
+    }
+    doc += "f7: 'duplicate'}}";
+    assertSameAsOneAtATime(paths, {doc.c_str()});
+}
+
+}  // namespace
+}  // namespace mongo
@@ -54,12 +54,14 @@
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/op_observer.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/ops/update_request.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
+#include "mongo/db/query/planner_ixselect.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
@@ -133,7 +135,51 @@ std::unique_ptr<CollatorInterface> parseCollation(OperationContext* opCtx,
 
     return std::move(collator.getValue());
 }
+
+// Returns true if the top-level field 'fieldName' is the same in both documents.
+bool topLevelFieldUnchanged(StringData fieldName, const BSONObj& oldDoc, const BSONObj& newDoc) {
+    const BSONElement oldField = oldDoc[fieldName];
+    const BSONElement newField = newDoc[fieldName];
+    if (oldField.eoo() || newField.eoo()) {
+        return oldField.eoo() && newField.eoo();
+    }
+    return oldField.binaryEqual(newField);
+}
+
+StringData firstPathComponent(StringData path) {
+    return path.substr(0, path.find('.'));
+}
+
+// Returns true if the keys for the index may differ between 'oldDoc' and 'newDoc'. Keys are a
+// function of the indexed paths and, for partial indexes, of the filter paths, so the index can
+// only be affected if the top-level field containing one of those paths changed. This lets an
+// update skip key generation entirely for indexes it did not touch.
+bool indexKeysMayHaveChanged(const IndexDescriptor* descriptor,
+                             const IndexCatalogEntry* entry,
+                             const BSONObj& oldDoc,
+                             const BSONObj& newDoc) {
+    if (descriptor->getAccessMethodName() == IndexNames::TEXT) {
+        // Text indexes can depend on any field, e.g. through the language override.
+        return true;
+    }
+
+    for (auto&& elem : descriptor->keyPattern()) {
+        if (!topLevelFieldUnchanged(firstPathComponent(elem.fieldNameStringData()), oldDoc, newDoc))
+            return true;
+    }
+
+    if (const MatchExpression* filter = entry->getFilterExpression()) {
+        unordered_set<std::string> paths;
+        QueryPlannerIXSelect::getFields(filter, "", &paths);
+        for (auto&& path : paths) {
+            if (!topLevelFieldUnchanged(firstPathComponent(path), oldDoc, newDoc))
+                return true;
+        }
+    }
+
+    return false;
 }
+}  // namespace
 
 using std::unique_ptr;
 using std::endl;
@@ -622,9 +668,9 @@ RecordId CollectionImpl::updateDocument(OperationContext* opCtx,
                                 << " != "
                                 << newDoc.objsize());
 
-    // At the end of this step, we will have a map of UpdateTickets, one per index, which
-    // represent the index updates needed to be done, based on the changes between oldDoc and
-    // newDoc.
+    // At the end of this step, we will have a map of UpdateTickets, one per index whose keys may
+    // have changed, which represent the index updates needed to be done, based on the changes
+    // between oldDoc and newDoc.
     OwnedPointerMap<IndexDescriptor*, UpdateTicket> updateTickets;
     if (indexesAffected) {
         IndexCatalog::IndexIterator ii = _indexCatalog.getIndexIterator(opCtx, true);
@@ -633,6 +679,10 @@ RecordId CollectionImpl::updateDocument(OperationContext* opCtx,
             IndexCatalogEntry* entry = ii.catalogEntry(descriptor);
             IndexAccessMethod* iam = ii.accessMethod(descriptor);
 
+            if (!indexKeysMayHaveChanged(descriptor, entry, oldDoc.value(), newDoc)) {
+                continue;
+            }
+
             InsertDeleteOptions options;
             IndexCatalog::prepareInsertDeleteOptions(opCtx, descriptor, &options);
             UpdateTicket* updateTicket = new UpdateTicket();
@@ -665,10 +715,14 @@ RecordId CollectionImpl::updateDocument(OperationContext* opCtx,
             IndexDescriptor* descriptor = ii.next();
             IndexAccessMethod* iam = ii.accessMethod(descriptor);
 
+            auto ticket = updateTickets.map().find(descriptor);
+            if (ticket == updateTickets.map().end()) {
+                continue;  // The index's keys did not change.
+            }
+
             int64_t keysInserted;
             int64_t keysDeleted;
-            uassertStatusOK(iam->update(
-                opCtx, *updateTickets.mutableMap()[descriptor], &keysInserted, &keysDeleted));
+            uassertStatusOK(iam->update(opCtx, *ticket->second, &keysInserted, &keysDeleted));
             if (opDebug) {
                 opDebug->keysInserted += keysInserted;
                 opDebug->keysDeleted += keysDeleted;
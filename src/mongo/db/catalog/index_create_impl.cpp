@@ -32,8 +32,11 @@
 
 #include "mongo/db/catalog/index_create_impl.h"
 
+#include <deque>
+
 #include "mongo/base/error_codes.h"
 #include "mongo/base/init.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/audit.h"
 #include "mongo/db/background.h"
@@ -43,12 +46,17 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -99,6 +107,259 @@ public:
 
 } exportedMaxIndexBuildMemoryUsageParameter;
 
+// If true, foreground index builds generate and sort the keys of each index on its own thread
+// while the collection is scanned.
+MONGO_EXPORT_SERVER_PARAMETER(indexBuildParallelKeyGeneration, bool, true);
+
+// Covering geometries dominates the cost of building 2dsphere indexes, so with parallel key
+// generation, the keys of each 2dsphere index are generated by this many threads.
+MONGO_EXPORT_SERVER_PARAMETER(indexBuildGeoKeyGenerationThreads, int, 4);
+
+namespace {
+// Documents are handed to the key generation threads in batches of up to this many documents or
+// bytes, and each thread queues at most kMaxQueuedBulkInsertBatches of them.
+const size_t kMaxBulkInsertBatchDocuments = 256;
+const size_t kMaxBulkInsertBatchBytes = 1024 * 1024;
+const size_t kMaxQueuedBulkInsertBatches = 4;
+}  // namespace
+
+/**
+ * Generates the keys of one bulk-built index and adds them to its BulkBuilder on a dedicated
+ * thread. When there are no more documents, also completes the sort so that only loading the
+ * sorted keys is left for doneInserting(). For 2dsphere indexes, the keys of each batch are
+ * generated by a pool of threads and then added to the BulkBuilder in order.
+ *
+ * Key generation doesn't touch the storage engine, so the thread runs without a Client or an
+ * OperationContext and needs no locks.
+ */
+class MultiIndexBlockImpl::BulkInsertWorker {
+    MONGO_DISALLOW_COPYING(BulkInsertWorker);
+
+public:
+    explicit BulkInsertWorker(IndexToBuild* index)
+        : _index(index),
+          _keyGenerationPool(_makeKeyGenerationPool(*index)),
+          _thread([this] { _run(); }) {}
+
+    ~BulkInsertWorker() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _abandoned = true;
+        }
+        _queueChanged.notify_all();
+        _thread.join();
+    }
+
+    /**
+     * Queues 'batch', waiting while the queue is full. Returns the worker's error, if any, instead.
+     */
+    Status push(std::shared_ptr<const BulkInsertBatch> batch) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _queueChanged.wait(
+            lk, [&] { return !_status.isOK() || _queue.size() < kMaxQueuedBulkInsertBatches; });
+        if (!_status.isOK()) {
+            return _status;
+        }
+        _queue.push_back(std::move(batch));
+        lk.unlock();
+        _queueChanged.notify_all();
+        return Status::OK();
+    }
+
+    /**
+     * Waits until all queued documents are indexed and the keys sorted.
+     */
+    Status finish() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _finishing = true;
+        _queueChanged.notify_all();
+        _queueChanged.wait(lk, [&] { return _finished; });
+        return _status;
+    }
+
+private:
+    void _run() {
+        setThreadName("IndexBuildKeys");
+
+        while (true) {
+            std::shared_ptr<const BulkInsertBatch> batch;
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _queueChanged.wait(lk, [&] { return _abandoned || _finishing || !_queue.empty(); });
+                if (_abandoned || _queue.empty()) {
+                    break;
+                }
+                batch = std::move(_queue.front());
+                _queue.pop_front();
+            }
+            _queueChanged.notify_all();
+
+            Status status = _insertBatch(*batch);
+            if (!status.isOK()) {
+                _setFinished(status);
+                return;
+            }
+        }
+
+        Status status = Status::OK();
+        if (!_isAbandoned()) {
+            try {
+                _index->bulk->sortKeys();
+            } catch (...) {
+                status = exceptionToStatus();
+            }
+        }
+        _setFinished(status);
+    }
+
+    static std::unique_ptr<ThreadPool> _makeKeyGenerationPool(const IndexToBuild& index) {
+        const int numThreads = indexBuildGeoKeyGenerationThreads.load();
+        if (numThreads <= 1 ||
+            index.block->getEntry()->descriptor()->getAccessMethodName() !=
+                IndexNames::GEO_2DSPHERE) {
+            return nullptr;
+        }
+
+        ThreadPool::Options options;
+        options.poolName = "IndexBuildGeoKeys";
+        options.threadNamePrefix = "IndexBuildGeoKeys-";
+        options.minThreads = numThreads;
+        options.maxThreads = numThreads;
+        auto pool = stdx::make_unique<ThreadPool>(options);
+        pool->startup();
+        return pool;
+    }
+
+    Status _insertBatch(const BulkInsertBatch& batch) {
+        if (_keyGenerationPool) {
+            return _insertBatchInParallel(batch);
+        }
+
+        try {
+            for (auto&& doc : batch) {
+                if (_index->filterExpression && !_index->filterExpression->matchesBSON(doc.first)) {
+                    continue;
+                }
+
+                // BulkBuilder::insert() only generates keys and doesn't use the OperationContext,
+                // which belongs to the thread scanning the collection.
+                int64_t unused;
+                Status status =
+                    _index->bulk->insert(nullptr, doc.first, doc.second, _index->options, &unused);
+                if (!status.isOK()) {
+                    return status;
+                }
+            }
+        } catch (...) {
+            return exceptionToStatus();
+        }
+        return Status::OK();
+    }
+
+    Status _insertBatchInParallel(const BulkInsertBatch& batch) {
+        std::vector<BSONObjSet> keys(batch.size(),
+                                     SimpleBSONObjComparator::kInstance.makeBSONObjSet());
+        std::vector<MultikeyPaths> multikeyPaths(batch.size());
+        std::vector<char> filteredOut(batch.size(), false);  // Not bool, as tasks write to it.
+
+        stdx::mutex mutex;
+        stdx::condition_variable tasksDone;
+        Status status = Status::OK();
+
+        // Each task generates the keys of a contiguous range of the batch.
+        const size_t numTasks = _keyGenerationPool->getStats().options.maxThreads;
+        const size_t docsPerTask = (batch.size() + numTasks - 1) / numTasks;
+        size_t tasksLeft = 0;
+        for (size_t begin = 0; begin < batch.size(); begin += docsPerTask) {
+            const size_t end = std::min(begin + docsPerTask, batch.size());
+            auto task = [&, begin, end] {
+                Status taskStatus = Status::OK();
+                try {
+                    for (size_t i = begin; i < end; ++i) {
+                        const BSONObj& doc = batch[i].first;
+                        if (_index->filterExpression &&
+                            !_index->filterExpression->matchesBSON(doc)) {
+                            filteredOut[i] = true;
+                            continue;
+                        }
+                        _index->real->getKeys(
+                            doc, _index->options.getKeysMode, &keys[i], &multikeyPaths[i]);
+                    }
+                } catch (...) {
+                    taskStatus = exceptionToStatus();
+                }
+
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                if (status.isOK()) {
+                    status = std::move(taskStatus);
+                }
+                if (--tasksLeft == 0) {
+                    tasksDone.notify_all();
+                }
+            };
+
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                ++tasksLeft;
+            }
+            if (!_keyGenerationPool->schedule(task).isOK()) {
+                // The pool only refuses tasks once shut down, which it never is before we are
+                // destroyed. Generate the keys here regardless.
+                task();
+            }
+        }
+
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        tasksDone.wait(lk, [&] { return tasksLeft == 0; });
+        if (!status.isOK()) {
+            return status;
+        }
+        lk.unlock();
+
+        try {
+            for (size_t i = 0; i < batch.size(); ++i) {
+                if (filteredOut[i]) {
+                    continue;
+                }
+                int64_t unused;
+                _index->bulk->insertKeys(keys[i], multikeyPaths[i], batch[i].second, &unused);
+            }
+        } catch (...) {
+            return exceptionToStatus();
+        }
+        return Status::OK();
+    }
+
+    bool _isAbandoned() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _abandoned;
+    }
+
+    void _setFinished(Status status) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _status = std::move(status);
+            _finished = true;
+        }
+        _queueChanged.notify_all();
+    }
+
+    IndexToBuild* const _index;
+
+    // Generates the keys of 2dsphere indexes, null for other indexes.
+    const std::unique_ptr<ThreadPool> _keyGenerationPool;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _queueChanged;  // Signals changes to any of the fields below.
+    std::deque<std::shared_ptr<const BulkInsertBatch>> _queue;
+    bool _finishing = false;  // No more batches will be pushed.
+    bool _abandoned = false;  // The build is being torn down; drop the queued batches.
+    bool _finished = false;
+    Status _status = Status::OK();
+
+    stdx::thread _thread;  // Must be last, as it uses everything above.
+};
+
 
 /**
  * On rollback sets MultiIndexBlockImpl::_needToCleanup to true.
@@ -143,6 +404,8 @@ MultiIndexBlockImpl::MultiIndexBlockImpl(OperationContext* opCtx, Collection* co
       _needToCleanup(true) {}
 
 MultiIndexBlockImpl::~MultiIndexBlockImpl() {
+    _bulkInsertWorkers.clear();
+
     if (!_needToCleanup || _indexes.empty())
         return;
     while (true) {
@@ -315,6 +578,8 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
     auto exec =
         InternalPlanner::collectionScan(_opCtx, _collection->ns().ns(), _collection, yieldPolicy);
 
+    const bool useBulkInsertWorkers = _startBulkInsertWorkers();
+
     Snapshotted<BSONObj> objToIndex;
     RecordId loc;
     PlanExecutor::ExecState state;
@@ -337,7 +602,9 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
             progress->setTotalWhileRunning(_collection->numRecords(_opCtx));
 
             WriteUnitOfWork wunit(_opCtx);
-            Status ret = insert(objToIndex.value(), loc);
+            Status ret = useBulkInsertWorkers
+                ? _insertWithBulkInsertWorkers(objToIndex.value(), loc)
+                : insert(objToIndex.value(), loc);
             if (_buildInBackground)
                 exec->saveState();
             if (ret.isOK()) {
@@ -439,7 +706,75 @@ Status MultiIndexBlockImpl::insert(const BSONObj& doc, const RecordId& loc) {
     return Status::OK();
 }
 
+bool MultiIndexBlockImpl::_startBulkInsertWorkers() {
+    if (!indexBuildParallelKeyGeneration.load() || _indexes.empty()) {
+        return false;
+    }
+    for (auto&& index : _indexes) {
+        if (!index.bulk) {
+            return false;
+        }
+    }
+
+    for (auto&& index : _indexes) {
+        _bulkInsertWorkers.push_back(stdx::make_unique<BulkInsertWorker>(&index));
+    }
+    _pendingBulkInsertBatch = std::make_shared<BulkInsertBatch>();
+    return true;
+}
+
+Status MultiIndexBlockImpl::_insertWithBulkInsertWorkers(const BSONObj& doc,
+                                                         const RecordId& loc) {
+    _pendingBulkInsertBatch->emplace_back(doc.getOwned(), loc);
+    _pendingBulkInsertBatchBytes += doc.objsize();
+    if (_pendingBulkInsertBatch->size() < kMaxBulkInsertBatchDocuments &&
+        _pendingBulkInsertBatchBytes < kMaxBulkInsertBatchBytes) {
+        return Status::OK();
+    }
+    return _dispatchBulkInsertBatch();
+}
+
+Status MultiIndexBlockImpl::_dispatchBulkInsertBatch() {
+    // All workers share the batch, so every document is copied only once.
+    std::shared_ptr<const BulkInsertBatch> batch = std::move(_pendingBulkInsertBatch);
+    _pendingBulkInsertBatch = std::make_shared<BulkInsertBatch>();
+    _pendingBulkInsertBatchBytes = 0;
+
+    for (auto&& worker : _bulkInsertWorkers) {
+        Status status = worker->push(batch);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+    return Status::OK();
+}
+
+Status MultiIndexBlockImpl::_finishBulkInsertWorkers() {
+    Status status = Status::OK();
+    if (!_pendingBulkInsertBatch->empty()) {
+        status = _dispatchBulkInsertBatch();
+    }
+
+    // Wait for every worker, even after an error, so that none of them is still running.
+    for (auto&& worker : _bulkInsertWorkers) {
+        Status workerStatus = worker->finish();
+        if (status.isOK()) {
+            status = workerStatus;
+        }
+    }
+    _bulkInsertWorkers.clear();
+    _pendingBulkInsertBatch.reset();
+    return status;
+}
+
 Status MultiIndexBlockImpl::doneInserting(std::set<RecordId>* dupsOut) {
+    if (!_bulkInsertWorkers.empty()) {
+        Status status = _finishBulkInsertWorkers();
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
     for (size_t i = 0; i < _indexes.size(); i++) {
         if (_indexes[i].bulk == NULL)
             continue;
@@ -459,6 +794,7 @@ Status MultiIndexBlockImpl::doneInserting(std::set<RecordId>* dupsOut) {
 }
 
 void MultiIndexBlockImpl::abortWithoutCleanup() {
+    _bulkInsertWorkers.clear();
     _indexes.clear();
     _needToCleanup = false;
 }
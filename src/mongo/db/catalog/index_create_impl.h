@@ -33,10 +33,12 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status.h"
+#include "mongo/bson/bsonobj.h"
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/catalog/index_catalog_impl.h"
 #include "mongo/db/index/index_access_method.h"
@@ -191,6 +193,9 @@ public:
 private:
     class SetNeedToCleanupOnRollback;
     class CleanupIndexesVectorOnRollback;
+    class BulkInsertWorker;
+
+    using BulkInsertBatch = std::vector<std::pair<BSONObj, RecordId>>;
 
     struct IndexToBuild {
         std::unique_ptr<IndexCatalogImpl::IndexBuildBlock> block;
@@ -202,8 +207,34 @@ private:
         InsertDeleteOptions options;
     };
 
+    /**
+     * Starts one BulkInsertWorker per index if every index is built with the bulk method and
+     * parallel key generation is enabled. Returns true if the workers were started.
+     */
+    bool _startBulkInsertWorkers();
+
+    /**
+     * Queues a document for the BulkInsertWorkers. Returns the status of a failed worker, if any.
+     */
+    Status _insertWithBulkInsertWorkers(const BSONObj& doc, const RecordId& loc);
+
+    Status _dispatchBulkInsertBatch();
+
+    /**
+     * Hands the remaining documents to the BulkInsertWorkers, waits for them to generate all keys
+     * and sort them, and stops them. Returns the first worker error.
+     */
+    Status _finishBulkInsertWorkers();
+
     std::vector<IndexToBuild> _indexes;
 
+    // Used by insertAllDocumentsInCollection() to generate keys for each bulk-built index on its
+    // own thread. Declared after '_indexes' so that the workers stop before the BulkBuilders they
+    // feed go away.
+    std::vector<std::unique_ptr<BulkInsertWorker>> _bulkInsertWorkers;
+    std::shared_ptr<BulkInsertBatch> _pendingBulkInsertBatch;
+    size_t _pendingBulkInsertBatchBytes = 0;
+
     std::unique_ptr<BackgroundOperation> _backgroundOperation;
 
     // Pointers not owned here and must outlive 'this'
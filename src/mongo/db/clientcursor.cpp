@@ -104,7 +104,7 @@ ClientCursor::ClientCursor(ClientCursorParams params,
 
 ClientCursor::~ClientCursor() {
     // Cursors must be unpinned and deregistered from their cursor manager before being deleted.
-    invariant(!_isPinned);
+    invariant(!_isPinned.load());
     invariant(_disposed);
 
     cursorStatsOpen.decrement();
@@ -150,7 +150,7 @@ void ClientCursor::updateSlaveLocation(OperationContext* opCtx) {
 ClientCursorPin::ClientCursorPin(OperationContext* opCtx, ClientCursor* cursor)
     : _opCtx(opCtx), _cursor(cursor) {
     invariant(_cursor);
-    invariant(_cursor->_isPinned);
+    invariant(_cursor->_isPinned.load());
     invariant(_cursor->_cursorManager);
     invariant(!_cursor->_disposed);
 
@@ -166,7 +166,7 @@ ClientCursorPin::ClientCursorPin(ClientCursorPin&& other)
     // The pinned cursor is being transferred to us from another pin. The 'other' pin must have a
     // pinned cursor.
     invariant(other._cursor);
-    invariant(other._cursor->_isPinned);
+    invariant(other._cursor->_isPinned.load());
 
     // Be sure to set the 'other' pin's cursor to null in order to transfer ownership to ourself.
     other._cursor = nullptr;
@@ -182,7 +182,7 @@ ClientCursorPin& ClientCursorPin::operator=(ClientCursorPin&& other) {
     // pinned cursor, and we must not have a cursor.
     invariant(!_cursor);
     invariant(other._cursor);
-    invariant(other._cursor->_isPinned);
+    invariant(other._cursor->_isPinned.load());
 
     // Copy the cursor pointer to ourselves, but also be sure to set the 'other' pin's cursor to
     // null so that it no longer has the cursor pinned.
@@ -211,7 +211,7 @@ void ClientCursorPin::release() {
         _opCtx->lockState()->isCollectionLockedForMode(_cursor->_nss.ns(), MODE_IS);
     dassert(isLocked || _cursor->_cursorManager->isGlobalManager());
 
-    invariant(_cursor->_isPinned);
+    invariant(_cursor->_isPinned.load());
 
     if (_cursor->getExecutor()->isMarkedAsKilled()) {
         // The ClientCursor was killed while we had it.  Therefore, it is our responsibility to
@@ -228,7 +228,7 @@ void ClientCursorPin::release() {
 
 void ClientCursorPin::deleteUnderlying() {
     invariant(_cursor);
-    invariant(_cursor->_isPinned);
+    invariant(_cursor->_isPinned.load());
     // Note the following subtleties of this method's implementation:
     // - We must unpin the cursor before destruction, since it is an error to delete a pinned
     //   cursor.
@@ -250,7 +250,7 @@ void ClientCursorPin::deleteUnderlying() {
 
     // Make sure the cursor is disposed and unpinned before being destroyed.
     _cursor->dispose(_opCtx);
-    _cursor->_isPinned = false;
+    _cursor->_isPinned.store(false);
     delete _cursor;
 
     cursorStatsOpenPinned.decrement();
@@ -37,6 +37,7 @@
 #include "mongo/db/logical_session_id.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/record_id.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/util/net/message.h"
 
@@ -339,8 +340,10 @@ private:
     // While a cursor is being used by a client, it is marked as "pinned". See ClientCursorPin
     // below.
     //
-    // Cursors always come into existence in a pinned state.
-    bool _isPinned = true;
+    // Cursors always come into existence in a pinned state. Pinning happens under the
+    // CursorManager's partition lock, but the pin clears this without it, after its last access
+    // to the cursor; see CursorManager::unpin().
+    AtomicBool _isPinned{true};
 
     Date_t _lastUseDate;
 };
@@ -89,6 +89,7 @@
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/storage_stats.h"
+#include "mongo/db/timeseries/timeseries_write.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/grid.h"
@@ -435,13 +436,17 @@ public:
             return false;
         }
 
-        return appendCommandStatus(
-            result,
+        const auto timeseriesOptions = getTimeseriesOptions(opCtx, nsToDrop);
+        auto status =
             dropCollection(opCtx,
                            nsToDrop,
                            result,
                            {},
-                           DropCollectionSystemCollectionMode::kDisallowSystemCollectionDrops));
+                           DropCollectionSystemCollectionMode::kDisallowSystemCollectionDrops);
+        if (status.isOK() && timeseriesOptions) {
+            status = dropTimeseriesBuckets(opCtx, nsToDrop);
+        }
+        return appendCommandStatus(result, status);
     }
 
 } cmdDrop;
@@ -464,7 +469,8 @@ public:
 
     virtual void help(stringstream& help) const {
         help << "create a collection explicitly\n"
-                "{ create: <ns>[, capped: <bool>, size: <collSizeInBytes>, max: <nDocs>] }";
+                "{ create: <ns>[, capped: <bool>, size: <collSizeInBytes>, max: <nDocs>] }\n"
+                "{ create: <ns>, timeseries: {timeField: <field>[, metaField: <field>]} }";
     }
     virtual Status checkAuthForCommand(Client* client,
                                        const std::string& dbname,
@@ -486,6 +492,19 @@ public:
             result.append("note", deprecationWarning);
         }
 
+        if (cmdObj.hasField("timeseries")) {
+            for (auto&& option : {"viewOn", "pipeline", "capped", "idIndex", "autoIndexId"}) {
+                if (cmdObj.hasField(option)) {
+                    return appendCommandStatus(result,
+                                               {ErrorCodes::InvalidOptions,
+                                                str::stream() << "'" << option
+                                                              << "' is not allowed with "
+                                                                 "'timeseries'"});
+                }
+            }
+            return appendCommandStatus(result, createTimeseriesCollection(opCtx, ns, cmdObj));
+        }
+
         // Validate _id index spec and fill in missing fields.
         if (auto idIndexElem = cmdObj["idIndex"]) {
             if (cmdObj["viewOn"]) {
@@ -211,6 +211,7 @@ void recordStatsForTopCommand(OperationContext* opCtx) {
                 curOp->getLogicalOp(),
                 Top::LockType::WriteLocked,
                 durationCount<Microseconds>(curOp->elapsedTimeExcludingPauses()),
+                curOp->cpuTimeMicros(),
                 curOp->isCommand(),
                 curOp->getReadWriteType());
 }
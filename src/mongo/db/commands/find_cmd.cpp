@@ -339,6 +339,16 @@ public:
 
         // Stream query results, adding them to a BSONArray as we go.
         CursorResponseBuilder firstBatch(/*isInitialResponse*/ true, &result);
+
+        // Make room for the whole batch at once, rather than growing and copying the reply as the
+        // documents are appended.
+        const int batchBytesEstimate = FindCommon::estimateBatchBytes(
+            originalQR.getEffectiveBatchSize().value_or(QueryRequest::kDefaultBatchSize),
+            collection->averageObjectSize(opCtx),
+            collection->dataSize(opCtx));
+        if (batchBytesEstimate > FindCommon::kInitReplyBufferSize) {
+            firstBatch.reserveBatchBytes(batchBytesEstimate);
+        }
         BSONObj obj;
         PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
         long long numResults = 0;
@@ -185,6 +185,7 @@ public:
         boost::optional<AutoGetCollectionForRead> readLock;
         boost::optional<AutoStatsTracker> statsTracker;
         CursorManager* cursorManager;
+        int batchBytesEstimate = 0;
 
         if (CursorManager::isGloballyManagedCursor(request.cursorid)) {
             cursorManager = CursorManager::getGlobalCursorManager();
@@ -213,6 +214,10 @@ public:
                                                   "collection dropped between getMore calls"));
             }
             cursorManager = collection->getCursorManager();
+            batchBytesEstimate =
+                FindCommon::estimateBatchBytes(request.batchSize.value_or(0),
+                                               collection->averageObjectSize(opCtx),
+                                               collection->dataSize(opCtx));
         }
 
         auto ccPin = cursorManager->pinCursor(opCtx, request.cursorid);
@@ -317,6 +322,13 @@ public:
 
         CursorId respondWithId = 0;
         CursorResponseBuilder nextBatch(/*isInitialResponse*/ false, &result);
+
+        // Make room for the whole batch at once, rather than growing and copying the reply as the
+        // documents are appended. Tailable cursors usually return a handful of new documents, so
+        // they are left to grow the reply as needed.
+        if (!cursor->isTailable() && batchBytesEstimate > FindCommon::kInitReplyBufferSize) {
+            nextBatch.reserveBatchBytes(batchBytesEstimate);
+        }
         BSONObj obj;
         PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
         long long numResults = 0;
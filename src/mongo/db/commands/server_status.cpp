@@ -50,6 +50,7 @@
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/service_entry_point.h"
 #include "mongo/util/log.h"
+#include "mongo/util/memory_accounting.h"
 #include "mongo/util/net/hostname_canonicalization.h"
 #include "mongo/util/net/sock.h"
 #include "mongo/util/net/ssl_manager.h"
@@ -306,6 +307,21 @@ public:
 
 } network;
 
+class MemoryAccounts : public ServerStatusSection {
+public:
+    MemoryAccounts() : ServerStatusSection("memoryAccounts") {}
+    virtual bool includeByDefault() const {
+        return true;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx, const BSONElement& configElement) const {
+        BSONObjBuilder b;
+        appendMemoryAccounts(&b);
+        return b.obj();
+    }
+
+} memoryAccounts;
+
 #ifdef MONGO_CONFIG_SSL
 class Security : public ServerStatusSection {
 public:
@@ -0,0 +1,122 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/util/bson_extract.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/traffic_recorder.h"
+
+namespace mongo {
+namespace {
+
+const long long kDefaultMaxFileSize = 1024LL * 1024 * 1024;
+const long long kDefaultMaxBufferSize = 128LL * 1024 * 1024;
+
+class TrafficRecordingCommand : public BasicCommand {
+public:
+    using BasicCommand::BasicCommand;
+
+    bool slaveOk() const final {
+        return true;
+    }
+
+    bool adminOnly() const final {
+        return true;
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const final {
+        return false;
+    }
+
+    Status checkAuthForCommand(Client* client,
+                               const std::string& dbname,
+                               const BSONObj& cmdObj) final {
+        bool isAuthorized = AuthorizationSession::get(client)->isAuthorizedForActionsOnResource(
+            ResourcePattern::forClusterResource(), ActionType::trafficRecord);
+        return isAuthorized ? Status::OK() : Status(ErrorCodes::Unauthorized, "Unauthorized");
+    }
+};
+
+/**
+ * { startRecordingTraffic: 1, filename: <string>, maxFileSize: <bytes>, bufferSize: <bytes> }
+ */
+class CmdStartRecordingTraffic : public TrafficRecordingCommand {
+public:
+    CmdStartRecordingTraffic() : TrafficRecordingCommand("startRecordingTraffic") {}
+
+    void help(std::stringstream& help) const final {
+        help << "start recording inbound requests to a file in the trafficRecordingDirectory, "
+                "for replay with replayRecordedTraffic() in the shell";
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) final {
+        std::string filename;
+        uassertStatusOK(bsonExtractStringField(cmdObj, "filename", &filename));
+
+        long long maxFileSize;
+        uassertStatusOK(bsonExtractIntegerFieldWithDefault(
+            cmdObj, "maxFileSize", kDefaultMaxFileSize, &maxFileSize));
+
+        long long maxBufferSize;
+        uassertStatusOK(bsonExtractIntegerFieldWithDefault(
+            cmdObj, "bufferSize", kDefaultMaxBufferSize, &maxBufferSize));
+
+        uassertStatusOK(TrafficRecorder::get(opCtx->getServiceContext())
+                            .start(filename, maxFileSize, maxBufferSize));
+        return true;
+    }
+} cmdStartRecordingTraffic;
+
+/**
+ * { stopRecordingTraffic: 1 }
+ */
+class CmdStopRecordingTraffic : public TrafficRecordingCommand {
+public:
+    CmdStopRecordingTraffic() : TrafficRecordingCommand("stopRecordingTraffic") {}
+
+    void help(std::stringstream& help) const final {
+        help << "stop recording inbound requests and report how many were recorded";
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) final {
+        uassertStatusOK(TrafficRecorder::get(opCtx->getServiceContext()).stop(&result));
+        return true;
+    }
+} cmdStopRecordingTraffic;
+
+}  // namespace
+}  // namespace mongo
@@ -49,6 +49,7 @@
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/db/timeseries/timeseries_write.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/s/stale_exception.h"
 
@@ -252,7 +253,15 @@ public:
                  const OpMsgRequest& request,
                  BSONObjBuilder& result) final {
         const auto batch = InsertOp::parse(request);
-        const auto reply = performInserts(opCtx, batch);
+        // Time-series collections are views, which are only looked up once there turned out to be
+        // no collection to insert into.
+        bool targetIsView = false;
+        auto reply = performInserts(opCtx, batch, &targetIsView);
+        if (targetIsView) {
+            const auto timeseriesOptions = getTimeseriesOptions(opCtx, batch.getNamespace());
+            reply = timeseriesOptions ? performTimeseriesInserts(opCtx, batch, *timeseriesOptions)
+                                      : performInserts(opCtx, batch);
+        }
         serializeReply(opCtx,
                        ReplyStyle::kNotUpdate,
                        !batch.getWriteCommandBase().getOrdered(),
@@ -41,6 +41,7 @@
 #include "mongo/config.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/locker.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/stringutils.h"
@@ -410,13 +411,29 @@ void LockHead::migratePartitionedLockHeads() {
 // Have more buckets than CPUs to reduce contention on lock and caches
 const unsigned LockManager::_numLockBuckets(128);
 
+namespace {
+
 // Balance scalability of intent locks against potential added cost of conflicting locks.
-// The exact value doesn't appear very important, but should be power of two
-const unsigned LockManager::_numPartitions = 32;
+// The exact value doesn't appear very important, but should be power of two. On machines with
+// many cores the number of partitions grows so that concurrent lockers rarely share a partition
+// mutex; a conflicting request only visits the partitions that actually hold its resource.
+const unsigned kMinNumPartitions = 32;
+const unsigned kMaxNumPartitions = 1024;
+
+unsigned numPartitionsForHardware() {
+    const unsigned numCores = stdx::thread::hardware_concurrency();
+    unsigned numPartitions = kMinNumPartitions;
+    while (numPartitions < 2 * numCores && numPartitions < kMaxNumPartitions) {
+        numPartitions <<= 1;
+    }
+    return numPartitions;
+}
+
+}  // namespace
 
-LockManager::LockManager() {
+LockManager::LockManager()
+    : _numPartitions(numPartitionsForHardware()), _partitions(_numPartitions) {
     _lockBuckets = new LockBucket[_numLockBuckets];
-    _partitions = new Partition[_numPartitions];
 }
 
 LockManager::~LockManager() {
@@ -428,7 +445,6 @@ LockManager::~LockManager() {
     }
 
     delete[] _lockBuckets;
-    delete[] _partitions;
 }
 
 LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mode) {
@@ -886,6 +902,105 @@ void LockManager::getLockInfoBSON(const std::map<LockerId, BSONObj>& lockToClien
         }
     }
     result->append("lockInfo", lockInfo.arr());
+
+    BSONArrayBuilder lockWaits;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_lockWaitsMutex);
+        for (const auto& lockWait : _lockWaits) {
+            lockWaits.append(lockWait.toBSON());
+        }
+    }
+    result->append("lockWaits", lockWaits.arr());
+}
+
+std::vector<LockManager::LockHolder> LockManager::getBlockingHolders(ResourceId resId,
+                                                                     const Locker* locker) const {
+    std::vector<LockHolder> holders;
+
+    LockBucket* bucket = _getBucket(resId);
+    stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
+
+    LockBucket::Map::const_iterator iter = bucket->data.find(resId);
+    if (iter == bucket->data.end()) {
+        return holders;
+    }
+
+    const LockHead* lock = iter->second;
+    const LockRequest* request = lock->findRequest(locker->getId());
+    if (!request || request->status == LockRequest::STATUS_GRANTED) {
+        return holders;
+    }
+
+    // Same rules as the deadlock detector: a new request waits for both the granted and the
+    // conversion modes of the granted requests, while a conversion only waits for granted modes.
+    const bool converting = request->status == LockRequest::STATUS_CONVERTING;
+    const LockMode waitMode = converting ? request->convertMode : request->mode;
+
+    for (const LockRequest* it = lock->grantedList._front; it != nullptr; it = it->next) {
+        if (it == request) {
+            continue;
+        }
+
+        if (conflicts(waitMode, modeMask(it->mode)) ||
+            (!converting && conflicts(waitMode, modeMask(it->convertMode)))) {
+            holders.push_back({it->locker->getId(), it->mode, true, it->locker->getDebugInfo()});
+        }
+    }
+
+    // New requests are granted in order, so a conflicting request queued ahead of this one
+    // blocks it too. This is how, for example, a pending exclusive lock stalls intent lockers.
+    if (!converting) {
+        for (const LockRequest* it = lock->conflictList._front; it && it != request;
+             it = it->next) {
+            if (conflicts(waitMode, modeMask(it->mode))) {
+                holders.push_back(
+                    {it->locker->getId(), it->mode, false, it->locker->getDebugInfo()});
+            }
+        }
+    }
+
+    return holders;
+}
+
+void LockManager::recordLockWait(LockWait lockWait) {
+    stdx::lock_guard<stdx::mutex> lk(_lockWaitsMutex);
+    if (_lockWaits.size() >= kMaxTracedLockWaits) {
+        _lockWaits.pop_front();
+    }
+    _lockWaits.push_back(std::move(lockWait));
+}
+
+BSONObj LockManager::LockHolder::toBSON() const {
+    BSONObjBuilder builder;
+    builder.append("lockerId", static_cast<long long>(lockerId));
+    builder.append("mode", modeName(mode));
+    builder.append("granted", granted);
+    builder.appendElements(debugInfo);
+    return builder.obj();
+}
+
+BSONObj LockManager::LockWait::toBSON() const {
+    BSONObjBuilder builder;
+    builder.append("time", time);
+
+    {
+        BSONObjBuilder waiterBuilder(builder.subobjStart("waiter"));
+        waiterBuilder.append("lockerId", static_cast<long long>(waiterId));
+        waiterBuilder.appendElements(waiterDebugInfo);
+    }
+
+    builder.append("resource", resId.toString());
+    builder.append("mode", modeName(mode));
+    builder.append("durationMicros", durationCount<Microseconds>(duration));
+    builder.append("granted", granted);
+
+    BSONArrayBuilder holdersBuilder(builder.subarrayStart("holders"));
+    for (const auto& holder : holders) {
+        holdersBuilder.append(holder.toBSON());
+    }
+    holdersBuilder.doneFast();
+
+    return builder.obj();
 }
 
 void LockManager::_dumpBucket(const LockBucket* bucket) const {
@@ -33,6 +33,8 @@
 #include <map>
 #include <vector>
 
+#include <boost/align/aligned_allocator.hpp>
+
 #include "mongo/bson/bsonobj.h"
 #include "mongo/config.h"
 #include "mongo/db/concurrency/lock_manager_defs.h"
@@ -43,6 +45,8 @@
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/with_alignment.h"
 
 namespace mongo {
 
@@ -57,6 +61,41 @@ public:
     LockManager();
     ~LockManager();
 
+    /**
+     * A request which blocks a waiting request, as captured by lock wait tracing. This is either
+     * a granted request with a conflicting mode or a conflicting request queued ahead of it.
+     */
+    struct LockHolder {
+        BSONObj toBSON() const;
+
+        LockerId lockerId;
+        LockMode mode;
+        bool granted;
+
+        // Whatever the owner of the holding Locker described it with (see Locker::setDebugInfo).
+        BSONObj debugInfo;
+    };
+
+    /**
+     * A lock wait which lasted longer than lockWaitTraceThresholdMillis, along with the requests
+     * which were blocking it at the time it crossed the threshold.
+     */
+    struct LockWait {
+        BSONObj toBSON() const;
+
+        Date_t time;
+        LockerId waiterId;
+        BSONObj waiterDebugInfo;
+        ResourceId resId;
+        LockMode mode;
+        Microseconds duration;
+        bool granted;
+        std::vector<LockHolder> holders;
+    };
+
+    // Number of the most recent traced lock waits which are kept for lockInfo.
+    static const size_t kMaxTracedLockWaits = 100;
+
     /**
       * Acquires lock on the specified resource in the specified mode and returns the outcome
       * of the operation. See the details for LockResult for more information on what the
@@ -131,6 +170,18 @@ public:
     void getLockInfoBSON(const std::map<LockerId, BSONObj>& lockToClientMap,
                          BSONObjBuilder* result);
 
+    /**
+     * Returns the requests on 'resId' which the pending request of 'locker' is waiting for, or
+     * an empty list if that request is not waiting anymore.
+     */
+    std::vector<LockHolder> getBlockingHolders(ResourceId resId, const Locker* locker) const;
+
+    /**
+     * Remembers a traced lock wait, evicting the oldest one if more than kMaxTracedLockWaits are
+     * kept. They are reported by getLockInfoBSON.
+     */
+    void recordLockWait(LockWait lockWait);
+
 private:
     // The deadlock detector needs to access the buckets and locks directly
     friend class DeadlockDetector;
@@ -214,8 +265,16 @@ private:
     static const unsigned _numLockBuckets;
     LockBucket* _lockBuckets;
 
-    static const unsigned _numPartitions;
-    Partition* _partitions;
+    template <typename T>
+    using AlignedVector = std::vector<T, boost::alignment::aligned_allocator<T>>;
+
+    // Each partition is cache aligned so that lockers taking intent locks through different
+    // partitions do not share cache lines.
+    const unsigned _numPartitions;
+    mutable AlignedVector<CacheAligned<Partition>> _partitions;
+
+    stdx::mutex _lockWaitsMutex;
+    std::deque<LockWait> _lockWaits;
 };
 
 
@@ -0,0 +1,81 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/db/concurrency/lock_manager.h"
+#include "mongo/db/concurrency/lock_state.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/benchmark.h"
+
+namespace mongo {
+namespace {
+
+class NoopLockGrantNotification : public LockGrantNotification {
+public:
+    void notify(ResourceId resId, LockResult result) override {}
+};
+
+const ResourceId kResId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
+
+/**
+ * Locks and unlocks a resource in MODE_IS while state.arg() other lockers hold it in compatible
+ * modes, as on a collection with concurrent readers.
+ */
+void BM_lockUnlock(benchmark::State& state) {
+    LockManager lockMgr;
+    NoopLockGrantNotification notify;
+
+    std::vector<std::unique_ptr<MMAPV1LockerImpl>> otherLockers;
+    std::vector<std::unique_ptr<LockRequest>> otherRequests;
+    for (int64_t i = 0; i < state.arg(); ++i) {
+        otherLockers.push_back(stdx::make_unique<MMAPV1LockerImpl>());
+        otherRequests.push_back(stdx::make_unique<LockRequest>());
+        otherRequests.back()->initNew(otherLockers.back().get(), &notify);
+        invariant(lockMgr.lock(kResId, otherRequests.back().get(), i % 2 ? MODE_IS : MODE_IX) ==
+                  LOCK_OK);
+    }
+
+    MMAPV1LockerImpl locker;
+    LockRequest request;
+    request.initNew(&locker, &notify);
+    for (auto _ : state) {
+        benchmark::doNotOptimizeAway(lockMgr.lock(kResId, &request, MODE_IS));
+        lockMgr.unlock(&request);
+    }
+
+    for (auto& otherRequest : otherRequests) {
+        lockMgr.unlock(otherRequest.get());
+    }
+}
+BENCHMARK(BM_lockUnlock)->arg(0)->arg(1)->arg(16);
+
+}  // namespace
+}  // namespace mongo
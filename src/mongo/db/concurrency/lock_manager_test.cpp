@@ -26,8 +26,12 @@
  *    it in the license file.
  */
 
+#include <memory>
+#include <vector>
+
 #include "mongo/db/concurrency/lock_manager_defs.h"
 #include "mongo/db/concurrency/lock_manager_test_help.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -316,6 +320,44 @@ TEST(LockManager, Conflict) {
     ASSERT(request2.numNotifies == 1);
 }
 
+TEST(LockManager, ConflictWithIntentLocksFromManyPartitions) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_DATABASE, std::string("TestDB"));
+
+    // Use more lockers than there can be partitions, so that several lockers share a partition
+    // and the intent requests are spread over every partition.
+    const int numIntentLockers = 2048 + 3;
+    std::vector<std::unique_ptr<MMAPV1LockerImpl>> lockers;
+    std::vector<std::unique_ptr<LockRequestCombo>> requests;
+    for (int i = 0; i < numIntentLockers; i++) {
+        lockers.push_back(stdx::make_unique<MMAPV1LockerImpl>());
+        requests.push_back(stdx::make_unique<LockRequestCombo>(lockers.back().get()));
+        const LockMode mode = (i % 2) ? MODE_IX : MODE_IS;
+        ASSERT(LOCK_OK == lockMgr.lock(resId, requests.back().get(), mode));
+    }
+
+    // The exclusive request migrates every partitioned request and has to wait for all of them.
+    MMAPV1LockerImpl lockerX;
+    LockRequestCombo requestX(&lockerX);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestX, MODE_X));
+
+    for (int i = 0; i < numIntentLockers; i++) {
+        ASSERT(requestX.numNotifies == 0);
+        lockMgr.unlock(requests[i].get());
+    }
+    ASSERT(requestX.numNotifies == 1);
+    ASSERT(requestX.lastResult == LOCK_OK);
+
+    // While the exclusive lock is held, new intent requests must queue on the LockHead.
+    LockRequestCombo requestIS(lockers[0].get());
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestIS, MODE_IS));
+
+    lockMgr.unlock(&requestX);
+    ASSERT(requestIS.numNotifies == 1);
+    ASSERT(requestIS.lastResult == LOCK_OK);
+    lockMgr.unlock(&requestIS);
+}
+
 TEST(LockManager, MultipleConflict) {
     LockManager lockMgr;
     const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
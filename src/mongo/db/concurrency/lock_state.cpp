@@ -35,6 +35,7 @@
 #include <vector>
 
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/platform/compiler.h"
 #include "mongo/stdx/new.h"
@@ -43,6 +44,8 @@
 #include "mongo/util/debug_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace {
@@ -106,6 +109,10 @@ private:
 // Global lock manager instance.
 LockManager globalLockManager;
 
+// Lock waits which take longer than this are traced along with the requests blocking them and
+// reported by lockInfo. Zero disables tracing.
+MONGO_EXPORT_SERVER_PARAMETER(lockWaitTraceThresholdMillis, int, 0);
+
 // Global lock. Every server operation, which uses the Locker must acquire this lock at least
 // once. See comments in the header file (begin/endTransaction) for more information.
 const ResourceId resourceIdGlobal = ResourceId(RESOURCE_GLOBAL, ResourceId::SINGLETON_GLOBAL);
@@ -308,8 +315,10 @@ LockResult LockerImpl<IsForMMAPV1>::_lockGlobalBegin(LockMode mode, Milliseconds
     if (_modeForTicket == MODE_NONE) {
         const bool reader = isSharedLockMode(mode);
         auto holder = ticketHolders[mode];
-        if (holder) {
+        if (holder && !holder->tryAcquire()) {
             _clientState.store(reader ? kQueuedReader : kQueuedWriter);
+            Timer ticketWaitTimer;
+            ON_BLOCK_EXIT([&] { _ticketWaitMicros.fetchAndAdd(ticketWaitTimer.micros()); });
             if (timeout == Milliseconds::max()) {
                 holder->waitForTicket();
             } else if (!holder->waitForTicketUntil(Date_t::now() + timeout)) {
@@ -570,6 +579,10 @@ void LockerImpl<IsForMMAPV1>::getLockerInfo(LockerInfo* lockerInfo) const {
 
     lockerInfo->waitingResource = getWaitingResource();
     lockerInfo->stats.append(_stats);
+    lockerInfo->ticketWaitTime = Microseconds(_ticketWaitMicros.load());
+
+    scoped_spinlock scopedLock(_lock);
+    lockerInfo->blockingHolders = _blockingHolders;
 }
 
 template <bool IsForMMAPV1>
@@ -735,9 +748,18 @@ LockResult LockerImpl<IsForMMAPV1>::lockComplete(ResourceId resId,
 
     LockResult result;
 
+    // When lock wait tracing is on, also wake up when the wait crosses the threshold, so the
+    // requests blocking this one can be captured while they still hold the lock.
+    const Milliseconds traceThreshold(lockWaitTraceThresholdMillis.load());
+    const bool traceWait = traceThreshold > Milliseconds(0);
+    bool traced = false;
+
     // Don't go sleeping without bound in order to be able to report long waits or wake up for
     // deadlock detection.
     Milliseconds waitTime = std::min(timeout, DeadlockTimeout);
+    if (traceWait) {
+        waitTime = std::min(waitTime, traceThreshold);
+    }
     const uint64_t startOfTotalWaitTime = curTimeMicros64();
     uint64_t startOfCurrentWaitTime = startOfTotalWaitTime;
 
@@ -757,6 +779,23 @@ LockResult LockerImpl<IsForMMAPV1>::lockComplete(ResourceId resId,
         if (result == LOCK_OK)
             break;
 
+        const auto totalBlockTime = duration_cast<Milliseconds>(
+            Microseconds(int64_t(curTimeMicros - startOfTotalWaitTime)));
+
+        if (traceWait && !traced && totalBlockTime >= traceThreshold) {
+            auto holders = globalLockManager.getBlockingHolders(resId, this);
+
+            scoped_spinlock scopedLock(_lock);
+            _blockingHolders = std::move(holders);
+            traced = true;
+        }
+
+        // The next wake up is for deadlock detection, or for tracing if that is still pending.
+        Milliseconds nextWakeUp = DeadlockTimeout;
+        if (traceWait && !traced) {
+            nextWakeUp = std::min(nextWakeUp, traceThreshold - totalBlockTime);
+        }
+
         if (checkDeadlock) {
             DeadlockDetector wfg(globalLockManager, this);
             if (wfg.check().hasCycle()) {
@@ -772,12 +811,11 @@ LockResult LockerImpl<IsForMMAPV1>::lockComplete(ResourceId resId,
 
         // If infinite timeout was requested, just keep waiting
         if (timeout == Milliseconds::max()) {
+            waitTime = nextWakeUp;
             continue;
         }
 
-        const auto totalBlockTime = duration_cast<Milliseconds>(
-            Microseconds(int64_t(curTimeMicros - startOfTotalWaitTime)));
-        waitTime = (totalBlockTime < timeout) ? std::min(timeout - totalBlockTime, DeadlockTimeout)
+        waitTime = (totalBlockTime < timeout) ? std::min(timeout - totalBlockTime, nextWakeUp)
                                               : Milliseconds(0);
 
         if (waitTime == Milliseconds(0)) {
@@ -785,6 +823,24 @@ LockResult LockerImpl<IsForMMAPV1>::lockComplete(ResourceId resId,
         }
     }
 
+    if (traced) {
+        LockManager::LockWait lockWait;
+        lockWait.time = Date_t::now();
+        lockWait.waiterId = _id;
+        lockWait.waiterDebugInfo = _debugInfo;
+        lockWait.resId = resId;
+        lockWait.mode = mode;
+        lockWait.duration = Microseconds(int64_t(curTimeMicros64() - startOfTotalWaitTime));
+        lockWait.granted = result == LOCK_OK;
+        {
+            scoped_spinlock scopedLock(_lock);
+            lockWait.holders = std::move(_blockingHolders);
+            _blockingHolders.clear();
+        }
+
+        globalLockManager.recordLockWait(std::move(lockWait));
+    }
+
     // Cleanup the state, since this is an unused lock now
     if (result != LOCK_OK) {
         LockRequestsMap::Iterator it = _requests.find(resId);
@@ -101,6 +101,14 @@ public:
 
     stdx::thread::id getThreadId() const override;
 
+    void setDebugInfo(BSONObj info) override {
+        _debugInfo = info.getOwned();
+    }
+
+    BSONObj getDebugInfo() const override {
+        return _debugInfo;
+    }
+
     virtual LockResult lockGlobal(LockMode mode);
     virtual LockResult lockGlobalBegin(LockMode mode, Milliseconds timeout) {
         return _lockGlobalBegin(mode, timeout);
@@ -231,9 +239,18 @@ private:
     // Indicates whether the client is active reader/writer or is queued.
     AtomicWord<ClientState> _clientState{kInactive};
 
+    // Total microseconds spent queued for a storage engine ticket. Read by db.currentOp.
+    AtomicWord<long long> _ticketWaitMicros{0};
+
     // Track the thread who owns the lock for debugging purposes
     stdx::thread::id _threadId;
 
+    // Set once by the owner before any locks are taken, so it may be read by other lockers.
+    BSONObj _debugInfo;
+
+    // Requests blocking the current lock wait, once it has been traced. Protected by _lock.
+    std::vector<LockManager::LockHolder> _blockingHolders;
+
     //////////////////////////////////////////////////////////////////////////////////////////
     //
     // Methods merged from LockState, which should eventually be removed or changed to methods
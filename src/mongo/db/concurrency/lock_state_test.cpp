@@ -37,8 +37,11 @@
 #include "mongo/config.h"
 #include "mongo/db/concurrency/lock_manager_test_help.h"
 #include "mongo/db/concurrency/locker.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
@@ -387,4 +390,59 @@ TEST(LockerImpl, GetLockerInfoShouldReportPendingLocks) {
     ASSERT(conflictingLocker.unlockGlobal());
 }
 
+TEST(LockerImpl, TracedLockWaitReportsBlockingHolders) {
+    const ResourceId dbId(RESOURCE_DATABASE, "TraceDB"_sd);
+    const ResourceId collectionId(RESOURCE_COLLECTION, "TraceDB.collection"_sd);
+
+    auto traceParameter =
+        ServerParameterSet::getGlobal()->getMap().at("lockWaitTraceThresholdMillis");
+    ASSERT_OK(traceParameter->setFromString("1"));
+    ON_BLOCK_EXIT([traceParameter] { traceParameter->setFromString("0").transitional_ignore(); });
+
+    DefaultLockerImpl holder;
+    holder.setDebugInfo(BSON("desc"
+                             << "holder"));
+    ASSERT_EQ(LOCK_OK, holder.lockGlobal(MODE_IX));
+    ASSERT_EQ(LOCK_OK, holder.lock(dbId, MODE_IX));
+    ASSERT_EQ(LOCK_OK, holder.lock(collectionId, MODE_X));
+
+    DefaultLockerImpl waiter;
+    waiter.setDebugInfo(BSON("desc"
+                             << "waiter"));
+    ASSERT_EQ(LOCK_OK, waiter.lockGlobal(MODE_IS));
+    ASSERT_EQ(LOCK_OK, waiter.lock(dbId, MODE_IS));
+    ASSERT_EQ(LOCK_TIMEOUT, waiter.lock(collectionId, MODE_IS, Milliseconds(20)));
+
+    BSONObjBuilder builder;
+    getGlobalLockManager()->getLockInfoBSON({}, &builder);
+    const BSONObj lockInfo = builder.obj();
+
+    // The most recent traced wait is the one which just timed out.
+    const auto lockWaits = lockInfo["lockWaits"].Array();
+    ASSERT_FALSE(lockWaits.empty());
+    const BSONObj lockWait = lockWaits.back().Obj();
+    ASSERT_EQ("waiter", lockWait["waiter"]["desc"].str());
+    ASSERT_EQ(collectionId.toString(), lockWait["resource"].str());
+    ASSERT_FALSE(lockWait["granted"].trueValue());
+    ASSERT_GTE(lockWait["durationMicros"].numberLong(), 1000);
+
+    const auto holders = lockWait["holders"].Array();
+    ASSERT_EQ(1U, holders.size());
+    ASSERT_EQ(static_cast<long long>(holder.getId()), holders[0]["lockerId"].numberLong());
+    ASSERT_EQ("X", holders[0]["mode"].str());
+    ASSERT_TRUE(holders[0]["granted"].trueValue());
+    ASSERT_EQ("holder", holders[0]["desc"].str());
+
+    // The holders are not reported once the wait is over.
+    Locker::LockerInfo lockerInfo;
+    waiter.getLockerInfo(&lockerInfo);
+    ASSERT_TRUE(lockerInfo.blockingHolders.empty());
+
+    ASSERT(holder.unlock(collectionId));
+    ASSERT(holder.unlock(dbId));
+    ASSERT(holder.unlockGlobal());
+    ASSERT(waiter.unlock(dbId));
+    ASSERT(waiter.unlockGlobal());
+}
+
 }  // namespace mongo
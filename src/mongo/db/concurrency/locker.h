@@ -89,6 +89,13 @@ public:
      */
     virtual stdx::thread::id getThreadId() const = 0;
 
+    /**
+     * Describes the owner of this locker (for example its client and operation id) so that
+     * lock wait tracing can tell who is blocking whom. Must be called before any lock is taken.
+     */
+    virtual void setDebugInfo(BSONObj info) = 0;
+    virtual BSONObj getDebugInfo() const = 0;
+
     /**
      * This should be the first method invoked for a particular Locker object. It acquires the
      * Global lock in the specified mode and effectively indicates the mode of the operation.
@@ -253,6 +260,12 @@ public:
 
         // Lock timing statistics
         SingleThreadedLockStats stats;
+
+        // Time spent waiting for a storage engine ticket, which is not part of the lock stats
+        Microseconds ticketWaitTime{0};
+
+        // If the wait for waitingResource has been traced, the requests which are blocking it
+        std::vector<LockManager::LockHolder> blockingHolders;
     };
 
     virtual void getLockerInfo(LockerInfo* lockerInfo) const = 0;
@@ -57,6 +57,12 @@ public:
         invariant(false);
     }
 
+    void setDebugInfo(BSONObj info) override {}
+
+    BSONObj getDebugInfo() const override {
+        return BSONObj();
+    }
+
     virtual LockResult lockGlobal(LockMode mode) {
         invariant(false);
     }
@@ -262,6 +262,8 @@ void CurOp::setNS_inlock(StringData ns) {
 
 void CurOp::ensureStarted() {
     if (_start == 0) {
+        _cpuClock = ThreadCpuClock::forCurrentThread();
+        _cpuStart = _cpuClock.now();
         _start = curTimeMicros64();
     }
 }
@@ -395,6 +397,14 @@ void CurOp::reportState(BSONObjBuilder* builder, bool truncateOps) {
     }
 
     builder->append("numYields", _numYields);
+    if (_yieldTime > Microseconds{0}) {
+        builder->append("yieldMicros", durationCount<Microseconds>(_yieldTime));
+    }
+
+    const auto cpuMicros = cpuTimeMicros();
+    if (cpuMicros >= 0) {
+        builder->append("cpuMicros", cpuMicros);
+    }
 }
 
 namespace {
@@ -419,7 +429,7 @@ StringData getProtoString(int op) {
 
 string OpDebug::report(Client* client,
                        const CurOp& curop,
-                       const SingleThreadedLockStats& lockStats) const {
+                       const Locker::LockerInfo& lockerInfo) const {
     StringBuilder s;
     if (iscommand)
         s << "command ";
@@ -513,6 +523,9 @@ string OpDebug::report(Client* client,
     }
 
     s << " numYields:" << curop.numYields();
+    if (curop.yieldTime() > Microseconds{0}) {
+        s << " yieldMicros:" << durationCount<Microseconds>(curop.yieldTime());
+    }
 
     OPDEBUG_TOSTRING_HELP(nreturned);
     if (responseLength > 0) {
@@ -521,10 +534,19 @@ string OpDebug::report(Client* client,
 
     {
         BSONObjBuilder locks;
-        lockStats.report(&locks);
+        lockerInfo.stats.report(&locks);
         s << " locks:" << locks.obj().toString();
     }
 
+    if (lockerInfo.ticketWaitTime > Microseconds{0}) {
+        s << " ticketWaitMicros:" << durationCount<Microseconds>(lockerInfo.ticketWaitTime);
+    }
+
+    const auto cpuMicros = curop.cpuTimeMicros();
+    if (cpuMicros >= 0) {
+        s << " cpuMicros:" << cpuMicros;
+    }
+
     if (iscommand) {
         s << " protocol:" << getProtoString(networkOp);
     }
@@ -542,7 +564,7 @@ string OpDebug::report(Client* client,
     b.appendBool(#x, (x))
 
 void OpDebug::append(const CurOp& curop,
-                     const SingleThreadedLockStats& lockStats,
+                     const Locker::LockerInfo& lockerInfo,
                      BSONObjBuilder& b) const {
     const size_t maxElementSize = 50 * 1024;
 
@@ -598,10 +620,22 @@ void OpDebug::append(const CurOp& curop,
     }
 
     b.appendNumber("numYield", curop.numYields());
+    if (curop.yieldTime() > Microseconds{0}) {
+        b.appendNumber("yieldMicros", durationCount<Microseconds>(curop.yieldTime()));
+    }
 
     {
         BSONObjBuilder locks(b.subobjStart("locks"));
-        lockStats.report(&locks);
+        lockerInfo.stats.report(&locks);
+    }
+
+    if (lockerInfo.ticketWaitTime > Microseconds{0}) {
+        b.appendNumber("ticketWaitMicros", durationCount<Microseconds>(lockerInfo.ticketWaitTime));
+    }
+
+    const auto cpuMicros = curop.cpuTimeMicros();
+    if (cpuMicros >= 0) {
+        b.appendNumber("cpuMicros", cpuMicros);
     }
 
     if (!exceptionInfo.isOK()) {
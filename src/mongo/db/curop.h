@@ -39,6 +39,7 @@
 #include "mongo/platform/atomic_word.h"
 #include "mongo/util/net/message.h"
 #include "mongo/util/progress_meter.h"
+#include "mongo/util/thread_cpu_clock.h"
 #include "mongo/util/time_support.h"
 
 namespace mongo {
@@ -55,16 +56,16 @@ public:
 
     std::string report(Client* client,
                        const CurOp& curop,
-                       const SingleThreadedLockStats& lockStats) const;
+                       const Locker::LockerInfo& lockerInfo) const;
 
     /**
      * Appends information about the current operation to "builder"
      *
      * @param curop reference to the CurOp that owns this OpDebug
-     * @param lockStats lockStats object containing locking information about the operation
+     * @param lockerInfo locking information about the operation, including lock and ticket waits
      */
     void append(const CurOp& curop,
-                const SingleThreadedLockStats& lockStats,
+                const Locker::LockerInfo& lockerInfo,
                 BSONObjBuilder& builder) const;
 
     /**
@@ -120,6 +121,11 @@ public:
 
     BSONObj execStats;  // Owned here.
 
+    // Set when this operation was sampled for the query shape statistics, see query_stats.h.
+    bool queryStatsConsidered{false};
+    std::string queryStatsNs;
+    std::string queryStatsShape;
+
     // error handling
     Status exceptionInfo = Status::OK();
 
@@ -216,6 +222,10 @@ public:
         return _debug;
     }
 
+    const OpDebug& debug() const {
+        return _debug;
+    }
+
     /**
      * Gets the name of the namespace on which the current operation operates.
      */
@@ -285,6 +295,7 @@ public:
         return _start;
     }
     void done() {
+        _cpuEnd = _cpuClock.now();
         _end = curTimeMicros64();
     }
     bool isDone() const {
@@ -354,6 +365,23 @@ public:
         return elapsedTimeTotal() - _totalPausedDuration;
     }
 
+    /**
+     * Returns the CPU time the thread executing this operation has spent on it, in microseconds,
+     * up to done() if it has been called and up to now otherwise. This includes time spent while
+     * the timer was paused. May be called from other threads with the client locked.
+     *
+     * Returns -1 if the op has not been started, or if CPU time can't be measured on this
+     * platform.
+     */
+    long long cpuTimeMicros() const {
+        if (!isStarted() || !_cpuClock.isValid()) {
+            return -1;
+        }
+
+        const auto end = isDone() ? _cpuEnd : _cpuClock.now();
+        return durationCount<Microseconds>(end - _cpuStart);
+    }
+
     /**
      * 'opDescription' must be either an owned BSONObj or guaranteed to outlive the OperationContext
      * it is associated with.
@@ -419,6 +447,22 @@ public:
         _numYields++;
     }  // Should be _inlock()?
 
+    /**
+     * Adds to the time this operation has spent yielding, from releasing its locks to having them
+     * back.
+     */
+    void addYieldTime(Microseconds yieldTime) {
+        _yieldTime += yieldTime;
+    }
+
+    /**
+     * Returns the time accumulated by addYieldTime(). Callers on threads other than the one
+     * executing the operation must lock the client.
+     */
+    Microseconds yieldTime() const {
+        return _yieldTime;
+    }
+
     /**
      * Returns the number of times yielded() was called.  Callers on threads other
      * than the one executing the operation must lock the client.
@@ -470,6 +514,11 @@ private:
     // The cumulative duration for which the timer has been paused.
     Microseconds _totalPausedDuration{0};
 
+    // Measures the CPU time of the thread executing this operation, from ensureStarted() to done().
+    ThreadCpuClock _cpuClock;
+    Nanoseconds _cpuStart{0};
+    Nanoseconds _cpuEnd{0};
+
     // _networkOp represents the network-level op code: OP_QUERY, OP_GET_MORE, OP_COMMAND, etc.
     NetworkOp _networkOp{opInvalid};  // only set this through setNetworkOp_inlock() to keep synced
     // _logicalOp is the logical operation type, ie 'dbQuery' regardless of whether this is an
@@ -486,6 +535,7 @@ private:
     std::string _message;
     ProgressMeter _progressMeter;
     int _numYields{0};
+    Microseconds _yieldTime{0};
 
     std::string _planSummary;
 };
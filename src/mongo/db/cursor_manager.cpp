@@ -396,7 +396,7 @@ void CursorManager::invalidateAll(OperationContext* opCtx,
 
             // If pinned, there is an active user of this cursor, who is now responsible for
             // cleaning it up. Otherwise, we can immediately dispose of it.
-            if (cursor->_isPinned) {
+            if (cursor->_isPinned.load()) {
                 it = partition.erase(it);
                 continue;
             }
@@ -442,7 +442,7 @@ void CursorManager::invalidateDocument(OperationContext* opCtx,
 }
 
 bool CursorManager::cursorShouldTimeout_inlock(const ClientCursor* cursor, Date_t now) {
-    if (cursor->isNoTimeout() || cursor->_isPinned) {
+    if (cursor->isNoTimeout() || cursor->_isPinned.load()) {
         return false;
     }
     return (now - cursor->_lastUseDate) >= Milliseconds(getCursorTimeoutMillis());
@@ -488,33 +488,42 @@ void CursorManager::deregisterExecutor(PlanExecutor* exec) {
 }
 
 StatusWith<ClientCursorPin> CursorManager::pinCursor(OperationContext* opCtx, CursorId id) {
-    auto lockedPartition = _cursorMap->lockOnePartition(id);
-    auto it = lockedPartition->find(id);
-    if (it == lockedPartition->end()) {
-        return {ErrorCodes::CursorNotFound, str::stream() << "cursor id " << id << " not found"};
-    }
+    ClientCursor* cursor;
+    {
+        auto lockedPartition = _cursorMap->lockOnePartition(id);
+        auto it = lockedPartition->find(id);
+        if (it == lockedPartition->end()) {
+            return {ErrorCodes::CursorNotFound,
+                    str::stream() << "cursor id " << id << " not found"};
+        }
 
-    ClientCursor* cursor = it->second;
-    uassert(12051, str::stream() << "cursor id " << id << " is already in use", !cursor->_isPinned);
-    if (cursor->getExecutor()->isMarkedAsKilled()) {
-        // This cursor was killed while it was idle.
-        Status error{ErrorCodes::QueryPlanKilled,
-                     str::stream() << "cursor killed because: "
-                                   << cursor->getExecutor()->getKillReason()};
-        lockedPartition->erase(cursor->cursorid());
-        cursor->dispose(opCtx);
-        delete cursor;
-        return error;
+        cursor = it->second;
+        uassert(12051,
+                str::stream() << "cursor id " << id << " is already in use",
+                !cursor->_isPinned.load());
+        if (cursor->getExecutor()->isMarkedAsKilled()) {
+            // This cursor was killed while it was idle.
+            Status error{ErrorCodes::QueryPlanKilled,
+                         str::stream() << "cursor killed because: "
+                                       << cursor->getExecutor()->getKillReason()};
+            lockedPartition->erase(cursor->cursorid());
+            cursor->dispose(opCtx);
+            delete cursor;
+            return error;
+        }
+
+        // Once pinned, nothing else will dispose of or delete the cursor, so the remaining checks
+        // can run without holding up other cursors in this partition.
+        cursor->_isPinned.store(true);
     }
 
     auto cursorPrivilegeStatus = checkCursorSessionPrivilege(opCtx, cursor->getSessionId());
 
     if (!cursorPrivilegeStatus.isOK()) {
+        cursor->_isPinned.store(false);
         return cursorPrivilegeStatus;
     }
 
-    cursor->_isPinned = true;
-
     // We use pinning of a cursor as a proxy for active, user-initiated use of a cursor.  Therefor,
     // we pass down to the logical session cache and vivify the record (updating last use).
     if (cursor->getSessionId()) {
@@ -525,13 +534,12 @@ StatusWith<ClientCursorPin> CursorManager::pinCursor(OperationContext* opCtx, Cu
 }
 
 void CursorManager::unpin(OperationContext* opCtx, ClientCursor* cursor) {
-    // Avoid computing the current time within the critical section.
-    auto now = opCtx->getServiceContext()->getPreciseClockSource()->now();
-
-    auto partitionLock = _cursorMap->lockOnePartition(cursor->cursorid());
-    invariant(cursor->_isPinned);
-    cursor->_isPinned = false;
-    cursor->_lastUseDate = now;
+    // No partition lock is needed: while the cursor is pinned, only its pin may touch
+    // '_lastUseDate', and readers under the partition lock only look at it once they have seen
+    // '_isPinned' become false. From that point on, the cursor must not be touched here again.
+    invariant(cursor->_isPinned.load());
+    cursor->_lastUseDate = opCtx->getServiceContext()->getPreciseClockSource()->now();
+    cursor->_isPinned.store(false);
 }
 
 void CursorManager::getCursorIds(std::set<CursorId>* openCursors) const {
@@ -641,7 +649,7 @@ Status CursorManager::eraseCursor(OperationContext* opCtx, CursorId id, bool sho
     }
     auto cursor = it->second;
 
-    if (cursor->_isPinned) {
+    if (cursor->_isPinned.load()) {
         if (shouldAudit) {
             audit::logKillCursorsAuthzCheck(
                 opCtx->getClient(), _nss, id, ErrorCodes::OperationFailed);
@@ -226,6 +226,10 @@ private:
 
     void deregisterCursor(ClientCursor* cc);
 
+    /**
+     * Releases the pin on 'cursor' without taking its partition lock. The caller must not access
+     * 'cursor' afterwards, since it may be timed out or erased by another thread at any point.
+     */
     void unpin(OperationContext* opCtx, ClientCursor* cursor);
 
     bool cursorShouldTimeout_inlock(const ClientCursor* cursor, Date_t now);
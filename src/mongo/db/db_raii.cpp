@@ -130,6 +130,7 @@ AutoStatsTracker::~AutoStatsTracker() {
                 curOp->getLogicalOp(),
                 _lockType,
                 durationCount<Microseconds>(curOp->elapsedTimeExcludingPauses()),
+                curOp->cpuTimeMicros(),
                 curOp->isCommand(),
                 curOp->getReadWriteType());
 }
@@ -330,6 +331,7 @@ OldClientContext::~OldClientContext() {
                 _opCtx->lockState()->isWriteLocked() ? Top::LockType::WriteLocked
                                                      : Top::LockType::ReadLocked,
                 _timer.micros(),
+                currentOp->cpuTimeMicros(),
                 currentOp->isCommand(),
                 currentOp->getReadWriteType());
 }
@@ -339,7 +339,7 @@ PlanStage::StageState AndHashStage::hashOtherChildren(WorkingSetID* out) {
             // Ignore.  It's not in any previous child.
         } else {
             // We have a hit.  Copy data into the WSM we already have.
-            _seenMap.insert(member->recordId);
+            _seenIds.insert(member->recordId);
             WorkingSetID olderMemberID = _dataMap[member->recordId];
             WorkingSetMember* olderMember = _ws->get(olderMemberID);
             size_t memUsageBefore = olderMember->getMemUsage();
@@ -355,10 +355,10 @@ PlanStage::StageState AndHashStage::hashOtherChildren(WorkingSetID* out) {
         // Finished with a child.
         ++_currentChild;
 
-        // Keep elements of _dataMap that are in _seenMap.
+        // Keep elements of _dataMap that are in _seenIds.
         DataMap::iterator it = _dataMap.begin();
         while (it != _dataMap.end()) {
-            if (_seenMap.end() == _seenMap.find(it->first)) {
+            if (!_seenIds.contains(it->first)) {
                 DataMap::iterator toErase = it;
                 ++it;
 
@@ -375,7 +375,7 @@ PlanStage::StageState AndHashStage::hashOtherChildren(WorkingSetID* out) {
 
         _specificStats.mapAfterChild.push_back(_dataMap.size());
 
-        _seenMap.clear();
+        _seenIds.clear();
 
         // _dataMap is now the intersection of the first _currentChild nodes.
 
@@ -31,11 +31,11 @@
 #include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/record_id_bitmap.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
 #include "mongo/platform/unordered_map.h"
-#include "mongo/platform/unordered_set.h"
 
 namespace mongo {
 
@@ -108,10 +108,10 @@ private:
     typedef unordered_map<RecordId, WorkingSetID, RecordId::Hasher> DataMap;
     DataMap _dataMap;
 
-    // Keeps track of what elements from _dataMap subsequent children have seen.
+    // Keeps track of what elements from _dataMap subsequent children have seen. A bitmap rather
+    // than a hash set, since it can hold as many ids as _dataMap for each child we intersect.
     // Only used while _hashingChildren.
-    typedef unordered_set<RecordId, RecordId::Hasher> SeenMap;
-    SeenMap _seenMap;
+    RecordIdBitmap _seenIds;
 
     // True if we're still intersecting _children[0..._children.size()-1].
     bool _hashingChildren;
@@ -39,6 +39,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_cache_replanner.h"
 #include "mongo/db/query/plan_ranker.h"
 #include "mongo/db/query/plan_yield_policy.h"
 #include "mongo/db/query/query_knobs.h"
@@ -163,6 +164,22 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
 
     // If we're here, the trial period took more than 'maxWorksBeforeReplan' work cycles. This
     // plan is taking too long, so we replan from scratch.
+    PlanCacheReplanner::recordStalePlan();
+
+    // In background mode, this query keeps the cached plan, along with the results buffered during
+    // the trial, and the replanner picks a new plan for later queries of the same shape.
+    if (internalQueryCacheBackgroundReplanning.load()) {
+        PlanCache* cache = _collection->infoCache()->getPlanCache();
+        auto replanner = PlanCacheReplanner::get(getOpCtx()->getServiceContext());
+        if (replanner->schedule(*_canonicalQuery, cache->computeKey(*_canonicalQuery))) {
+            LOG(1) << "Execution of cached plan required " << maxWorksBeforeReplan
+                   << " works, but was originally cached with only " << _decisionWorks
+                   << " works. Scheduled background replanning of query: "
+                   << redact(_canonicalQuery->toStringShort());
+        }
+        return Status::OK();
+    }
+
     LOG(1) << "Execution of cached plan required " << maxWorksBeforeReplan
            << " works, but was originally cached with only " << _decisionWorks
            << " works. Evicting cache entry and replanning query: "
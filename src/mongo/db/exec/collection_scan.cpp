@@ -38,6 +38,8 @@
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/service_context.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -63,7 +65,15 @@ CollectionScan::CollectionScan(OperationContext* opCtx,
       _filter(filter),
       _params(params),
       _isDead(false),
+      // Storage engines without document-level locking may need to yield for a RecordFetcher
+      // before each record, and tailable scans restart their cursor at EOF, so neither reads ahead.
+      _useBatches(!params.tailable && supportsDocLocking() &&
+                  internalQueryCollectionScanMaxBatchSize.load() > 1),
+      _maxBatchSize(std::max(internalQueryCollectionScanMaxBatchSize.load(), 1)),
       _wsidForFetch(_workingSet->allocate()) {
+    if (internalQueryExecCompileFilters.load()) {
+        _compiledFilter = CompiledMatchExpression::compile(filter);
+    }
     // Explain reports the direction of the collection scan.
     _specificStats.direction = params.direction;
     invariant(!_params.shouldTrackLatestOplogTimestamp || _params.collection->ns().isOplog());
@@ -90,6 +100,7 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
     }
 
     boost::optional<Record> record;
+    SnapshotId snapshotId = getOpCtx()->recoveryUnit()->getSnapshotId();
     const bool needToMakeCursor = !_cursor;
     try {
         if (needToMakeCursor) {
@@ -110,6 +121,15 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
 
             _cursor = _params.collection->getCursor(getOpCtx(), forward);
 
+            // Full scans of large collections are the ones worth reading ahead of. We don't know
+            // whether something above us will stop the scan early, so go by collection size.
+            const int readAheadMinRecords = internalQueryCollectionScanReadAheadMinRecords.load();
+            if (_params.start.isNull() && !_params.tailable && _params.maxScan == 0 &&
+                readAheadMinRecords > 0 &&
+                _params.collection->numRecords(getOpCtx()) >= readAheadMinRecords) {
+                _cursor->enableReadAhead();
+            }
+
             if (!_lastSeenId.isNull()) {
                 invariant(_params.tailable);
                 // Seek to where we were last time. If it no longer exists, mark us as dead
@@ -135,6 +155,20 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
 
         if (_lastSeenId.isNull() && !_params.start.isNull()) {
             record = _cursor->seekExact(_params.start);
+        } else if (_useBatches) {
+            if (_batchPosition == _batch.size()) {
+                _batch.clear();
+                _batchPosition = 0;
+                _batchSnapshotId = snapshotId;
+                // On a WriteConflictException the records read so far stay in _batch and are
+                // returned after the yield.
+                _cursor->nextBatch(&_batch, _nextBatchSize);
+                _nextBatchSize = std::min(_nextBatchSize * 2, _maxBatchSize);
+            }
+            if (_batchPosition < _batch.size()) {
+                record = std::move(_batch[_batchPosition++]);
+                snapshotId = _batchSnapshotId;
+            }
         } else {
             // See if the record we're about to access is in memory. If not, pass a fetch
             // request up.
@@ -181,12 +215,17 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
     WorkingSetID id = _workingSet->allocate();
     WorkingSetMember* member = _workingSet->get(id);
     member->recordId = record->id;
-    member->obj = {getOpCtx()->recoveryUnit()->getSnapshotId(), record->data.releaseToBson()};
+    member->obj = {snapshotId, record->data.releaseToBson()};
     _workingSet->transitionToRecordIdAndObj(id);
 
     return returnIfMatches(member, id, out);
 }
 
+PlanStage::StageState CollectionScan::doWorkBatch(size_t maxWorks,
+                                                  std::vector<WorkingSetID>* out) {
+    return workRepeatedly(maxWorks, _workingSet, out);
+}
+
 Status CollectionScan::setLatestOplogEntryTimestamp(const Record& record) {
     auto tsElem = record.data.toBson()["ts"];
     if (tsElem.type() != BSONType::bsonTimestamp) {
@@ -205,9 +244,12 @@ PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
                                                       WorkingSetID* out) {
     ++_specificStats.docsTested;
 
-    if (Filter::passes(member, _filter)) {
+    const bool matches = _compiledFilter ? _compiledFilter->matchesBSON(member->obj.value())
+                                         : Filter::passes(member, _filter);
+    if (matches) {
         if (_params.stopApplyingFilterAfterFirstMatch) {
             _filter = nullptr;
+            _compiledFilter.reset();
         }
         *out = memberID;
         return PlanStage::ADVANCED;
@@ -29,15 +29,18 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/matcher/compiled_match_expression.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/db/storage/snapshot.h"
 
 namespace mongo {
 
-struct Record;
 class SeekableRecordCursor;
 class WorkingSet;
 class OperationContext;
@@ -56,6 +59,8 @@ public:
                    const MatchExpression* filter);
 
     StageState doWork(WorkingSetID* out) final;
+
+    StageState doWorkBatch(size_t maxWorks, std::vector<WorkingSetID>* out) final;
     bool isEOF() final;
 
     void doInvalidate(OperationContext* opCtx, const RecordId& dl, InvalidationType type) final;
@@ -98,6 +103,9 @@ private:
     // The filter is not owned by us.
     const MatchExpression* _filter;
 
+    // '_filter' compiled into a flat program, if it can be.
+    std::unique_ptr<CompiledMatchExpression> _compiledFilter;
+
     std::unique_ptr<SeekableRecordCursor> _cursor;
 
     CollectionScanParams _params;
@@ -106,6 +114,16 @@ private:
 
     RecordId _lastSeenId;  // Null if nothing has been returned from _cursor yet.
 
+    // When set, records are read from _cursor with nextBatch() into _batch and returned from there
+    // one per call to work(). Batches start at a single record and double in size up to
+    // _maxBatchSize, so that short scans (e.g. with a limit) don't read far past what they return.
+    const bool _useBatches;
+    const size_t _maxBatchSize;
+    size_t _nextBatchSize = 1;
+    std::vector<Record> _batch;
+    size_t _batchPosition = 0;
+    SnapshotId _batchSnapshotId;  // The snapshot the records in _batch were read from.
+
     // We allocate a working set member with this id on construction of the stage. It gets used for
     // all fetch requests. This should only be used for passing up the Fetcher for a NEED_YIELD, and
     // should remain in the INVALID state.
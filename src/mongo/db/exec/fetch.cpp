@@ -30,11 +30,14 @@
 
 #include "mongo/db/exec/fetch.h"
 
+#include <algorithm>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -58,8 +61,12 @@ FetchStage::FetchStage(OperationContext* opCtx,
       _collection(collection),
       _ws(ws),
       _filter(filter),
-      _idRetrying(WorkingSet::INVALID_ID) {
+      _idRetrying(WorkingSet::INVALID_ID),
+      _prefetchBatchSize(std::max(internalQueryExecFetchPrefetchBatchSize.load(), 0)) {
     _children.emplace_back(child);
+    if (internalQueryExecCompileFilters.load()) {
+        _compiledFilter = CompiledMatchExpression::compile(filter);
+    }
 }
 
 FetchStage::~FetchStage() {}
@@ -71,7 +78,7 @@ bool FetchStage::isEOF() {
         return false;
     }
 
-    return child()->isEOF();
+    return _lookAhead.empty() && child()->isEOF();
 }
 
 PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
@@ -82,12 +89,14 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
     // Either retry the last WSM we worked on or get a new one from our child.
     WorkingSetID id;
     StageState status;
-    if (_idRetrying == WorkingSet::INVALID_ID) {
-        status = child()->work(&id);
-    } else {
+    if (_idRetrying != WorkingSet::INVALID_ID) {
         status = ADVANCED;
         id = _idRetrying;
         _idRetrying = WorkingSet::INVALID_ID;
+    } else if (_prefetchBatchSize > 0 || !_lookAhead.empty()) {
+        status = workChildWithLookAhead(&id);
+    } else {
+        status = child()->work(&id);
     }
 
     if (PlanStage::ADVANCED == status) {
@@ -150,6 +159,59 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState FetchStage::workChildWithLookAhead(WorkingSetID* out) {
+    if (!_returningLookAhead) {
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState status = child()->work(&id);
+        if (PlanStage::ADVANCED == status) {
+            _lookAhead.push_back(id);
+            if (_lookAhead.size() < _prefetchBatchSize) {
+                return PlanStage::NEED_TIME;
+            }
+        } else if (PlanStage::IS_EOF != status || _lookAhead.empty()) {
+            *out = id;
+            return status;
+        }
+
+        // The batch is full, or the child is done.
+        prefetchLookAhead();
+        _returningLookAhead = true;
+    }
+
+    *out = _lookAhead.front();
+    _lookAhead.pop_front();
+    _returningLookAhead = !_lookAhead.empty();
+    return PlanStage::ADVANCED;
+}
+
+void FetchStage::prefetchLookAhead() {
+    std::vector<RecordId> recordIds;
+    for (WorkingSetID id : _lookAhead) {
+        WorkingSetMember* member = _ws->get(id);
+        if (!member->hasObj() && member->hasRecordId()) {
+            recordIds.push_back(member->recordId);
+        }
+    }
+    if (recordIds.empty()) {
+        return;
+    }
+
+    // Sorting lets the storage engine read the records in the order they are stored.
+    std::sort(recordIds.begin(), recordIds.end());
+    if (!_cursor) {
+        _cursor = _collection->getCursor(getOpCtx());
+    }
+    if (!_cursor->prefetch(recordIds)) {
+        _prefetchBatchSize = 0;
+    }
+    _specificStats.docsPrefetched += recordIds.size();
+}
+
+PlanStage::StageState FetchStage::doWorkBatch(size_t maxWorks,
+                                              std::vector<WorkingSetID>* out) {
+    return workRepeatedly(maxWorks, _ws, out);
+}
+
 void FetchStage::doSaveState() {
     if (_cursor)
         _cursor->saveUnpositioned();
@@ -180,6 +242,14 @@ void FetchStage::doInvalidate(OperationContext* opCtx, const RecordId& dl, Inval
             WorkingSetCommon::fetchAndInvalidateRecordId(opCtx, member, _collection);
         }
     }
+
+    // The same goes for the results we have read ahead.
+    for (WorkingSetID id : _lookAhead) {
+        WorkingSetMember* member = _ws->get(id);
+        if (member->hasRecordId() && (member->recordId == dl)) {
+            WorkingSetCommon::fetchAndInvalidateRecordId(opCtx, member, _collection);
+        }
+    }
 }
 
 PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
@@ -201,7 +271,10 @@ PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
     // predicate.
     ++_specificStats.docsExamined;
 
-    if (Filter::passes(member, _filter)) {
+    const bool matches = _compiledFilter && member->hasObj()
+        ? _compiledFilter->matchesBSON(member->obj.value())
+        : Filter::passes(member, _filter);
+    if (matches) {
         *out = memberID;
         return PlanStage::ADVANCED;
     } else {
@@ -28,10 +28,12 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/matcher/compiled_match_expression.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
 
@@ -59,6 +61,7 @@ public:
 
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks, std::vector<WorkingSetID>* out) final;
 
     void doSaveState() final;
     void doRestoreState() final;
@@ -83,6 +86,15 @@ private:
      */
     StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID, WorkingSetID* out);
 
+    /**
+     * Works the child once, collecting its results into '_lookAhead'. Once a batch is collected,
+     * asks the storage engine to prefetch the records of the batch, then returns the batch one
+     * result at a time, in the order the child produced them.
+     */
+    StageState workChildWithLookAhead(WorkingSetID* out);
+
+    void prefetchLookAhead();
+
     // Collection which is used by this stage. Used to resolve record ids retrieved by child
     // stages. The lifetime of the collection must supersede that of the stage.
     const Collection* _collection;
@@ -95,9 +107,23 @@ private:
     // The filter is not owned by us.
     const MatchExpression* _filter;
 
+    // '_filter' compiled into a flat program, if it can be.
+    std::unique_ptr<CompiledMatchExpression> _compiledFilter;
+
     // If not Null, we use this rather than asking our child what to do next.
     WorkingSetID _idRetrying;
 
+    // Results read from our child but not yet returned, in the child's order. Only used when
+    // prefetching.
+    std::deque<WorkingSetID> _lookAhead;
+
+    // True once the records of '_lookAhead' have been prefetched and it is being returned.
+    bool _returningLookAhead = false;
+
+    // How many results to collect before prefetching them. Zero if prefetching is off, or the
+    // storage engine has said it does not prefetch.
+    size_t _prefetchBatchSize;
+
     // Stats
     FetchStats _specificStats;
 };
@@ -41,7 +41,8 @@ namespace mongo {
  */
 class WorkingSetMatchableDocument : public MatchableDocument {
 public:
-    WorkingSetMatchableDocument(WorkingSetMember* wsm) : _wsm(wsm) {}
+    WorkingSetMatchableDocument(WorkingSetMember* wsm)
+        : _wsm(wsm), _fieldIndex(wsm->hasObj() ? wsm->obj.value() : BSONObj()) {}
 
     // This is only called by a $where query.  The query system must be smart enough to realize
     // that it should do a fetch beforehand.
@@ -54,7 +55,7 @@ public:
         // BSONElementIterator does some interesting things with arrays that I don't think
         // SimpleArrayElementIterator does.
         if (_wsm->hasObj()) {
-            return new BSONElementIterator(path, _wsm->obj.value());
+            return new BSONElementIterator(path, _wsm->obj.value(), _fieldIndex.forLookup());
         }
 
         // NOTE: This (kind of) duplicates code in WorkingSetMember::getFieldDotted.
@@ -94,6 +95,7 @@ public:
 
 private:
     WorkingSetMember* _wsm;
+    mutable FieldIndex _fieldIndex;
 };
 
 class IndexKeyMatchableDocument : public MatchableDocument {
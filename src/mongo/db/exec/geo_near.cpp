@@ -35,20 +35,28 @@
 #include <vector>
 
 // For s2 search
+#include "third_party/s2/s2cap.h"
+#include "third_party/s2/s2cell.h"
+#include "third_party/s2/s2edgeutil.h"
 #include "third_party/s2/s2regionintersection.h"
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/bson/dotted_path_support.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/fetch.h"
+#include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/index_scan.h"
+#include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/exec/working_set_computed_data.h"
 #include "mongo/db/geo/geoconstants.h"
 #include "mongo/db/geo/geoparser.h"
 #include "mongo/db/geo/hash.h"
+#include "mongo/db/geo/s2_covering_cache.h"
 #include "mongo/db/index/expression_params.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/query/expression_index.h"
 #include "mongo/db/query/expression_index_knobs.h"
+#include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 
@@ -1077,7 +1085,24 @@ StatusWith<NearStage::CoveredInterval*>  //
     scanParams.bounds.fields[s2FieldPosition].intervals.clear();
     std::unique_ptr<S2Region> region(buildS2Region(_currBounds));
 
-    std::vector<S2CellId> cover = ExpressionMapping::get2dsphereCovering(*region);
+    // Repeated searches around the same point walk through the same intervals, so remember their
+    // coverings.
+    BufBuilder cacheKeyBuf;
+    cacheKeyBuf.appendChar('n');
+    cacheKeyBuf.appendNum(_currBounds.center().x);
+    cacheKeyBuf.appendNum(_currBounds.center().y);
+    cacheKeyBuf.appendNum(_currBounds.getInner());
+    cacheKeyBuf.appendNum(_currBounds.getOuter());
+    cacheKeyBuf.appendNum(internalQueryS2GeoCoarsestLevel.load());
+    cacheKeyBuf.appendNum(internalQueryS2GeoFinestLevel.load());
+    cacheKeyBuf.appendNum(internalQueryS2GeoMaxCells.load());
+    const std::string cacheKey(cacheKeyBuf.buf(), cacheKeyBuf.len());
+
+    std::vector<S2CellId> cover;
+    if (!S2CoveringCache::get().lookup(cacheKey, &cover)) {
+        cover = ExpressionMapping::get2dsphereCovering(*region);
+        S2CoveringCache::get().add(cacheKey, cover);
+    }
 
     // Generate a covering that does not intersect with any previous coverings
     S2CellUnion coverUnion;
@@ -1113,4 +1138,381 @@ StatusWith<double> GeoNear2DSphereStage::computeDistance(WorkingSetMember* membe
     return computeGeoNearDistance(_nearParams, member);
 }
 
+//
+// GeoNear2DSphereBestFirstStage
+//
+
+namespace {
+
+// Taken off the distance bounds of cells, in meters, to absorb floating point error.
+const double kCellDistanceSlackInMeters = 0.01;
+
+double angleToMeters(S1Angle angle) {
+    return angle.radians() * kRadiusOfEarthInMeters;
+}
+
+}  // namespace
+
+bool GeoNear2DSphereBestFirstStage::QueueEntry::operator<(const QueueEntry& other) const {
+    // The priority queue pops its greatest entry, which must be the nearest. At equal distances,
+    // documents with an exact distance go first.
+    if (distance != other.distance) {
+        return distance > other.distance;
+    }
+    return !exact && other.exact;
+}
+
+GeoNear2DSphereBestFirstStage::GeoNear2DSphereBestFirstStage(const GeoNearParams& nearParams,
+                                                             OperationContext* opCtx,
+                                                             WorkingSet* workingSet,
+                                                             Collection* collection,
+                                                             IndexDescriptor* s2Index)
+    : PlanStage(kS2IndexNearStage.c_str(), opCtx),
+      _nearParams(nearParams),
+      _workingSet(workingSet),
+      _collection(collection),
+      _s2Index(s2Index),
+      _s2FieldPosition(getFieldPosition(s2Index, nearParams.nearQuery->field)),
+      _fullBounds(geoNearDistanceBounds(*nearParams.nearQuery)) {
+    invariant(_s2FieldPosition >= 0);
+
+    _specificStats.keyPattern = s2Index->keyPattern();
+    _specificStats.indexName = s2Index->indexName();
+    _specificStats.indexVersion = static_cast<int>(s2Index->version());
+    _specificStats.bestFirst = true;
+
+    // As for GeoNear2DSphereStage, the collator is only needed to generate keys.
+    const CollatorInterface* collator = nullptr;
+    ExpressionParams::initialize2dsphereParams(s2Index->infoObj(), collator, &_indexParams);
+    invariant(_indexParams.indexVersion >= S2_INDEX_VERSION_3);
+}
+
+GeoNear2DSphereBestFirstStage::~GeoNear2DSphereBestFirstStage() {}
+
+bool GeoNear2DSphereBestFirstStage::canSearch(const GeoNearParams& nearParams,
+                                              const IndexDescriptor* s2Index) {
+    if (SPHERE != nearParams.nearQuery->centroid->crs) {
+        return false;
+    }
+
+    S2IndexingParams indexParams;
+    const CollatorInterface* collator = nullptr;
+    ExpressionParams::initialize2dsphereParams(s2Index->infoObj(), collator, &indexParams);
+    return indexParams.indexVersion >= S2_INDEX_VERSION_3;
+}
+
+bool GeoNear2DSphereBestFirstStage::isEOF() {
+    return _done;
+}
+
+PlanStage::StageState GeoNear2DSphereBestFirstStage::doWork(WorkingSetID* out) {
+    if (_done) {
+        return PlanStage::IS_EOF;
+    }
+
+    if (!_initialized) {
+        try {
+            _recordCursor = _collection->getCursor(getOpCtx());
+        } catch (const WriteConflictException&) {
+            _recordCursor.reset();
+            *out = WorkingSet::INVALID_ID;
+            return PlanStage::NEED_YIELD;
+        }
+
+        for (int face = 0; face < S2CellId::kNumFaces; ++face) {
+            pushCell(S2CellId::FromFacePosLevel(face, 0, 0));
+        }
+        _initialized = true;
+        return PlanStage::NEED_TIME;
+    }
+
+    if (ScanKind::kNone != _scanKind) {
+        return workScan(out);
+    }
+    return popQueue(out);
+}
+
+PlanStage::StageState GeoNear2DSphereBestFirstStage::popQueue(WorkingSetID* out) {
+    if (_queue.empty()) {
+        _done = true;
+        return PlanStage::IS_EOF;
+    }
+
+    const QueueEntry entry = _queue.top();
+    if (entry.isCell) {
+        _queue.pop();
+        ++_specificStats.cellsSearched;
+
+        // Only the finest indexed level gets scanned whole. Above it, first make sure there is
+        // anything in the cell at all.
+        _scanCell = entry.cell;
+        startScan(_scanCell.level() >= _indexParams.finestIndexedLevel ? ScanKind::kRange
+                                                                        : ScanKind::kProbe);
+        return PlanStage::NEED_TIME;
+    }
+
+    if (!entry.exact) {
+        return resolveDocument(entry, out);
+    }
+
+    // Nothing left in the queue can be nearer than this document.
+    _queue.pop();
+    auto it = _pendingDocuments.find(entry.recordId);
+    invariant(it != _pendingDocuments.end());
+    *out = it->second.wsid;
+    _pendingDocuments.erase(it);
+    _finishedDocuments.insert(entry.recordId);
+    return PlanStage::ADVANCED;
+}
+
+PlanStage::StageState GeoNear2DSphereBestFirstStage::resolveDocument(const QueueEntry& entry,
+                                                                     WorkingSetID* out) {
+    auto it = _pendingDocuments.find(entry.recordId);
+    if (it == _pendingDocuments.end() || it->second.fetched) {
+        // The document was reached through another of its keys already.
+        _queue.pop();
+        return PlanStage::NEED_TIME;
+    }
+
+    const WorkingSetID wsid = it->second.wsid;
+    WorkingSetMember* member = _workingSet->get(wsid);
+    if (!member->hasObj()) {
+        try {
+            ++_specificStats.docsExamined;
+            if (!WorkingSetCommon::fetch(getOpCtx(), _workingSet, wsid, _recordCursor)) {
+                _queue.pop();
+                dropDocument(entry.recordId);
+                return PlanStage::NEED_TIME;
+            }
+        } catch (const WriteConflictException&) {
+            // Leave the entry at the front of the queue to try again after yielding.
+            *out = WorkingSet::INVALID_ID;
+            return PlanStage::NEED_YIELD;
+        }
+    }
+    _queue.pop();
+
+    if (!Filter::passes(member, _nearParams.filter)) {
+        dropDocument(entry.recordId);
+        return PlanStage::NEED_TIME;
+    }
+
+    StatusWith<double> distance = computeGeoNearDistance(_nearParams, member);
+    if (!distance.isOK()) {
+        _done = true;
+        *out = WorkingSetCommon::allocateStatusMember(_workingSet, distance.getStatus());
+        return PlanStage::FAILURE;
+    }
+
+    if (distance.getValue() < 0 || distance.getValue() < _fullBounds.getInner() ||
+        distance.getValue() > _fullBounds.getOuter()) {
+        dropDocument(entry.recordId);
+        return PlanStage::NEED_TIME;
+    }
+
+    // Ensure that the BSONObj underlying the WorkingSetMember is owned in case we yield.
+    member->makeObjOwnedIfNeeded();
+    it->second.fetched = true;
+    _queue.push({distance.getValue(), false, S2CellId(), entry.recordId, true});
+    return PlanStage::NEED_TIME;
+}
+
+PlanStage::StageState GeoNear2DSphereBestFirstStage::workScan(WorkingSetID* out) {
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    PlanStage::StageState state = child()->work(&id);
+
+    if (PlanStage::IS_EOF == state) {
+        if (ScanKind::kProbe == _scanKind) {
+            // The cell is empty.
+            _scanCell = S2CellId::None();
+        }
+        startScan(ScanKind::kNone);
+        return PlanStage::NEED_TIME;
+    } else if (PlanStage::ADVANCED != state) {
+        // Propagate NEED_TIME, NEED_YIELD and failures.
+        if (PlanStage::FAILURE == state) {
+            _done = true;
+        }
+        *out = id;
+        return state;
+    }
+
+    if (ScanKind::kProbe == _scanKind) {
+        _workingSet->free(id);
+
+        // The cell holds keys, so search its children, and read the keys of the cell itself if
+        // geometries may have been indexed with it.
+        for (S2CellId cellId = _scanCell.child_begin(); cellId != _scanCell.child_end();
+             cellId = cellId.next()) {
+            pushCell(cellId);
+        }
+        startScan(_scanCell.level() >= _indexParams.coarsestIndexedLevel ? ScanKind::kCellKeys
+                                                                         : ScanKind::kNone);
+        return PlanStage::NEED_TIME;
+    }
+
+    WorkingSetMember* member = _workingSet->get(id);
+    invariant(member->hasRecordId());
+    const RecordId recordId = member->recordId;
+    if (_finishedDocuments.count(recordId)) {
+        _workingSet->free(id);
+        return PlanStage::NEED_TIME;
+    }
+
+    // A document is at least as far as the cell of the key we found it through. Since cells are
+    // searched nearest first, any of its keys which we haven't found yet are at least as far as
+    // the cell we are scanning.
+    double distance = minDistanceToCell(_scanCell);
+    invariant(1 == member->keyData.size());
+    BSONObjIterator keyIt(member->keyData[0].keyData);
+    for (int i = 0; i < _s2FieldPosition; ++i) {
+        keyIt.next();
+    }
+    const BSONElement keyElement = keyIt.next();
+    if (NumberLong == keyElement.type()) {
+        const S2CellId keyCell(static_cast<uint64>(keyElement.numberLong()));
+        if (keyCell.is_valid()) {
+            distance = std::max(distance, minDistanceToCell(keyCell));
+        }
+    }
+
+    auto it = _pendingDocuments.find(recordId);
+    if (it == _pendingDocuments.end()) {
+        _pendingDocuments[recordId] = {id, false};
+    } else {
+        _workingSet->free(id);
+        if (it->second.fetched) {
+            return PlanStage::NEED_TIME;
+        }
+    }
+    _queue.push({distance, false, S2CellId(), recordId, false});
+    return PlanStage::NEED_TIME;
+}
+
+void GeoNear2DSphereBestFirstStage::startScan(ScanKind kind) {
+    if (!_children.empty()) {
+        const IndexScanStats* scanStats =
+            static_cast<const IndexScanStats*>(child()->getSpecificStats());
+        _specificStats.keysExamined += scanStats->keysExamined;
+        _children.clear();
+    }
+
+    _scanKind = kind;
+    if (ScanKind::kNone == kind) {
+        return;
+    }
+
+    IndexScanParams scanParams;
+    scanParams.descriptor = _s2Index;
+    scanParams.direction = 1;
+    scanParams.doNotDedup = true;
+    scanParams.bounds = _nearParams.baseBounds;
+
+    OrderedIntervalList* oil = &scanParams.bounds.fields[_s2FieldPosition];
+    oil->intervals.clear();
+    if (ScanKind::kCellKeys == kind) {
+        oil->intervals.push_back(IndexBoundsBuilder::makePointInterval(
+            BSON("" << static_cast<long long>(_scanCell.id()))));
+    } else {
+        ExpressionMapping::S2CellIdsToIntervals({_scanCell}, _indexParams.indexVersion, oil);
+    }
+
+    _children.emplace_back(new IndexScan(getOpCtx(), scanParams, _workingSet, nullptr));
+}
+
+void GeoNear2DSphereBestFirstStage::pushCell(const S2CellId& cellId) {
+    const double minDistance = minDistanceToCell(cellId);
+    if (minDistance > _fullBounds.getOuter() ||
+        maxDistanceToCell(cellId) < _fullBounds.getInner()) {
+        return;
+    }
+    _queue.push({minDistance, true, cellId, RecordId(), false});
+}
+
+void GeoNear2DSphereBestFirstStage::dropDocument(const RecordId& recordId) {
+    auto it = _pendingDocuments.find(recordId);
+    invariant(it != _pendingDocuments.end());
+    _workingSet->free(it->second.wsid);
+    _pendingDocuments.erase(it);
+    _finishedDocuments.insert(recordId);
+}
+
+double GeoNear2DSphereBestFirstStage::minDistanceToCell(const S2CellId& cellId) const {
+    const S2Point& center = _nearParams.nearQuery->centroid->point;
+    const S2Cell cell(cellId);
+    if (cell.Contains(center)) {
+        return 0;
+    }
+
+    // Cells are convex, so the nearest point of one which doesn't contain the center is on an
+    // edge.
+    S1Angle minAngle = S1Angle::Radians(M_PI);
+    for (int k = 0; k < 4; ++k) {
+        minAngle = std::min(minAngle,
+                            S2EdgeUtil::GetDistance(
+                                center, cell.GetVertex(k), cell.GetVertex((k + 1) & 3)));
+    }
+    return std::max(0.0, angleToMeters(minAngle) - kCellDistanceSlackInMeters);
+}
+
+double GeoNear2DSphereBestFirstStage::maxDistanceToCell(const S2CellId& cellId) const {
+    const S2Point& center = _nearParams.nearQuery->centroid->point;
+    const S2Cap cap = S2Cell(cellId).GetCapBound();
+    return angleToMeters(S1Angle(center, cap.axis())) + angleToMeters(cap.angle()) +
+        kCellDistanceSlackInMeters;
+}
+
+void GeoNear2DSphereBestFirstStage::doSaveState() {
+    if (_recordCursor) {
+        _recordCursor->saveUnpositioned();
+    }
+}
+
+void GeoNear2DSphereBestFirstStage::doRestoreState() {
+    if (_recordCursor) {
+        invariant(_recordCursor->restore());
+    }
+}
+
+void GeoNear2DSphereBestFirstStage::doDetachFromOperationContext() {
+    if (_recordCursor) {
+        _recordCursor->detachFromOperationContext();
+    }
+}
+
+void GeoNear2DSphereBestFirstStage::doReattachToOperationContext() {
+    if (_recordCursor) {
+        _recordCursor->reattachToOperationContext(getOpCtx());
+    }
+}
+
+void GeoNear2DSphereBestFirstStage::doInvalidate(OperationContext* opCtx,
+                                                 const RecordId& dl,
+                                                 InvalidationType type) {
+    // Keep our own copy of a document which is about to change or go away. It stays keyed by its
+    // old RecordId.
+    auto it = _pendingDocuments.find(dl);
+    if (it != _pendingDocuments.end()) {
+        WorkingSetMember* member = _workingSet->get(it->second.wsid);
+        if (member->hasRecordId()) {
+            WorkingSetCommon::fetchAndInvalidateRecordId(opCtx, member, _collection);
+        }
+    }
+}
+
+std::unique_ptr<PlanStageStats> GeoNear2DSphereBestFirstStage::getStats() {
+    _commonStats.isEOF = isEOF();
+    unique_ptr<PlanStageStats> ret =
+        stdx::make_unique<PlanStageStats>(_commonStats, STAGE_GEO_NEAR_2DSPHERE);
+    ret->specific = stdx::make_unique<NearStats>(_specificStats);
+    for (auto&& child : _children) {
+        ret->children.emplace_back(child->getStats());
+    }
+    return ret;
+}
+
+const SpecificStats* GeoNear2DSphereBestFirstStage::getSpecificStats() const {
+    return &_specificStats;
+}
+
 }  // namespace mongo
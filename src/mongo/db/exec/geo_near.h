@@ -28,6 +28,10 @@
 
 #pragma once
 
+#include <queue>
+#include <unordered_set>
+#include <vector>
+
 #include "mongo/db/exec/near.h"
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/exec/working_set.h"
@@ -38,6 +42,7 @@
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/expression_geo.h"
 #include "mongo/db/query/index_bounds.h"
+#include "third_party/s2/s2cellid.h"
 #include "third_party/s2/s2cellunion.h"
 
 namespace mongo {
@@ -156,4 +161,120 @@ private:
     std::unique_ptr<DensityEstimator> _densityEstimator;
 };
 
+/**
+ * Implementation of GeoNear on top of a 2dsphere index which searches best-first, for queries that
+ * only need the nearest few results.
+ *
+ * A priority queue holds S2 cells and documents ordered by a lower bound on their distance. Popping
+ * a cell scans the index keys which may lie in it: keys for the cell itself while above the finest
+ * indexed level, or its whole range at that level. The cell's children are queued in turn, skipping
+ * the ones an index probe finds empty. Documents are queued unfetched with the distance of their
+ * key's cell, and only fetched once they reach the front, to be queued again with their exact
+ * distance. A document with an exact distance at the front of the queue is the next result.
+ *
+ * Requires a 2dsphere index of version 3 or later, as the cell of each key is read from the key.
+ */
+class GeoNear2DSphereBestFirstStage final : public PlanStage {
+public:
+    GeoNear2DSphereBestFirstStage(const GeoNearParams& nearParams,
+                                  OperationContext* opCtx,
+                                  WorkingSet* workingSet,
+                                  Collection* collection,
+                                  IndexDescriptor* s2Index);
+
+    ~GeoNear2DSphereBestFirstStage();
+
+    /**
+     * Returns true if a best-first search can answer 'nearParams' with 's2Index'.
+     */
+    static bool canSearch(const GeoNearParams& nearParams, const IndexDescriptor* s2Index);
+
+    bool isEOF() final;
+    StageState doWork(WorkingSetID* out) final;
+
+    void doSaveState() final;
+    void doRestoreState() final;
+    void doDetachFromOperationContext() final;
+    void doReattachToOperationContext() final;
+    void doInvalidate(OperationContext* opCtx, const RecordId& dl, InvalidationType type) final;
+
+    StageType stageType() const final {
+        return STAGE_GEO_NEAR_2DSPHERE;
+    }
+
+    std::unique_ptr<PlanStageStats> getStats() final;
+    const SpecificStats* getSpecificStats() const final;
+
+private:
+    // An entry of the search queue: a cell, or a document identified by its RecordId.
+    struct QueueEntry {
+        // Lower bound of the distance to the cell or document, exact for fetched documents.
+        double distance;
+        bool isCell;
+        S2CellId cell;
+        RecordId recordId;
+        bool exact;
+
+        bool operator<(const QueueEntry& other) const;
+    };
+
+    // A document which has been seen in the index but not returned or dropped yet.
+    struct PendingDocument {
+        WorkingSetID wsid;
+        bool fetched;
+    };
+
+    enum class ScanKind {
+        kNone,
+        // Tells whether the current cell's range holds any keys.
+        kProbe,
+        // Reads the keys of the current cell itself.
+        kCellKeys,
+        // Reads all the keys in the current cell's range.
+        kRange,
+    };
+
+    StageState popQueue(WorkingSetID* out);
+    StageState workScan(WorkingSetID* out);
+    StageState resolveDocument(const QueueEntry& entry, WorkingSetID* out);
+
+    /**
+     * Replaces the current index scan with one of 'kind' over _scanCell, or none.
+     */
+    void startScan(ScanKind kind);
+    void pushCell(const S2CellId& cellId);
+    void dropDocument(const RecordId& recordId);
+
+    double minDistanceToCell(const S2CellId& cellId) const;
+    double maxDistanceToCell(const S2CellId& cellId) const;
+
+    const GeoNearParams _nearParams;
+
+    // Not owned here.
+    WorkingSet* const _workingSet;
+    Collection* const _collection;
+    IndexDescriptor* const _s2Index;
+
+    S2IndexingParams _indexParams;
+    int _s2FieldPosition;
+
+    // The total search annulus, in meters.
+    const R2Annulus _fullBounds;
+
+    bool _initialized = false;
+    bool _done = false;
+
+    std::priority_queue<QueueEntry> _queue;
+    unordered_map<RecordId, PendingDocument, RecordId::Hasher> _pendingDocuments;
+    std::unordered_set<RecordId, RecordId::Hasher> _finishedDocuments;
+
+    // The cell being scanned, and the index scan over it. The scan is the only child.
+    S2CellId _scanCell;
+    ScanKind _scanKind = ScanKind::kNone;
+
+    std::unique_ptr<SeekableRecordCursor> _recordCursor;
+
+    NearStats _specificStats;
+};
+
 }  // namespace mongo
@@ -237,6 +237,11 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
     return PlanStage::ADVANCED;
 }
 
+PlanStage::StageState IndexScan::doWorkBatch(size_t maxWorks,
+                                             std::vector<WorkingSetID>* out) {
+    return workRepeatedly(maxWorks, _workingSet, out);
+}
+
 bool IndexScan::isEOF() {
     return _commonStats.isEOF;
 }
@@ -96,6 +96,8 @@ public:
               const MatchExpression* filter);
 
     StageState doWork(WorkingSetID* out) final;
+
+    StageState doWorkBatch(size_t maxWorks, std::vector<WorkingSetID>* out) final;
     bool isEOF() final;
     void doSaveState() final;
     void doRestoreState() final;
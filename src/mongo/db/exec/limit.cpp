@@ -86,6 +86,28 @@ PlanStage::StageState LimitStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState LimitStage::doWorkBatch(size_t maxWorks, std::vector<WorkingSetID>* out) {
+    if (0 == _numToReturn) {
+        recordBatch(PlanStage::IS_EOF, 0);
+        return PlanStage::IS_EOF;
+    }
+
+    ScopedTimer timer(getClock(), &_commonStats.executionTimeMillis);
+    StageState status =
+        child()->workBatch(std::min(maxWorks, static_cast<size_t>(_numToReturn)), out);
+    recordBatch(status, out->size());
+
+    if (PlanStage::ADVANCED == status) {
+        _numToReturn -= out->size();
+    } else if ((PlanStage::FAILURE == status || PlanStage::DEAD == status) && out->empty()) {
+        Status errorStatus(ErrorCodes::InternalError,
+                           "limit stage failed to read in results from child");
+        out->push_back(WorkingSetCommon::allocateStatusMember(_ws, errorStatus));
+    }
+
+    return status;
+}
+
 unique_ptr<PlanStageStats> LimitStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_LIMIT);
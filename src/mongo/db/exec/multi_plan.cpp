@@ -463,6 +463,11 @@ QuerySolution* MultiPlanStage::bestSolution() {
     return _candidates[_bestPlanIdx].solution.get();
 }
 
+const QuerySolution* MultiPlanStage::getCandidateSolution(size_t candidateIdx) const {
+    invariant(candidateIdx < _candidates.size());
+    return _candidates[candidateIdx].solution.get();
+}
+
 unique_ptr<PlanStageStats> MultiPlanStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_MULTI_PLAN);
@@ -140,6 +140,12 @@ public:
      */
     QuerySolution* bestSolution();
 
+    /**
+     * Returns the QuerySolution of the candidate at 'candidateIdx', which is also the index of its
+     * stats among the children of this stage's stats. The MultiPlanStage retains ownership.
+     */
+    const QuerySolution* getCandidateSolution(size_t candidateIdx) const;
+
     /**
      * Returns true if a backup plan was picked.
      * This is the case when the best plan has a blocking stage.
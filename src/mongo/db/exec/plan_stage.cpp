@@ -41,6 +41,17 @@ namespace mongo {
 PlanStage::StageState PlanStage::work(WorkingSetID* out) {
     invariant(_opCtx);
     ScopedTimer timer(getClock(), &_commonStats.executionTimeMillis);
+    return _workUntimed(out);
+}
+
+PlanStage::StageState PlanStage::_workUntimed(WorkingSetID* out) {
+    if (_hasStashedState) {
+        // Already counted when it came up.
+        _hasStashedState = false;
+        *out = _stashedId;
+        return _stashedState;
+    }
+
     ++_commonStats.works;
 
     StageState workResult = doWork(out);
@@ -56,6 +67,103 @@ PlanStage::StageState PlanStage::work(WorkingSetID* out) {
     return workResult;
 }
 
+PlanStage::StageState PlanStage::workBatch(size_t maxWorks, std::vector<WorkingSetID>* out) {
+    invariant(_opCtx);
+    invariant(maxWorks > 0);
+    invariant(out->empty());
+
+    if (_hasStashedState) {
+        _hasStashedState = false;
+        if (_stashedId != WorkingSet::INVALID_ID) {
+            out->push_back(_stashedId);
+        }
+        return _stashedState;
+    }
+
+    return doWorkBatch(maxWorks, out);
+}
+
+PlanStage::StageState PlanStage::doWorkBatch(size_t maxWorks, std::vector<WorkingSetID>* out) {
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    StageState state = work(&id);
+    if (id != WorkingSet::INVALID_ID && state != NEED_TIME) {
+        out->push_back(id);
+    }
+    return state;
+}
+
+PlanStage::StageState PlanStage::workRepeatedly(size_t maxWorks,
+                                                WorkingSet* ws,
+                                                std::vector<WorkingSetID>* out) {
+    ScopedTimer timer(getClock(), &_commonStats.executionTimeMillis);
+
+    for (size_t i = 0; i < maxWorks; ++i) {
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState state = _workUntimed(&id);
+
+        if (ADVANCED == state) {
+            WorkingSetMember* member = ws->get(id);
+            member->makeObjOwnedIfNeeded();
+            for (auto&& keyDatum : member->keyData) {
+                keyDatum.keyData = keyDatum.keyData.getOwned();
+            }
+            out->push_back(id);
+            continue;
+        }
+
+        if (NEED_TIME == state) {
+            continue;
+        }
+
+        if (!out->empty()) {
+            if (IS_EOF == state) {
+                // The next call will come up with IS_EOF again.
+                break;
+            }
+            if (NEED_YIELD == state) {
+                stashState(state, id);
+                break;
+            }
+
+            // The plan failed, so drop the results that came before.
+            for (auto&& idToFree : *out) {
+                ws->free(idToFree);
+            }
+            out->clear();
+        }
+
+        if (id != WorkingSet::INVALID_ID) {
+            out->push_back(id);
+        }
+        return state;
+    }
+
+    return out->empty() ? NEED_TIME : ADVANCED;
+}
+
+void PlanStage::recordBatch(StageState state, size_t numResults) {
+    if (ADVANCED == state) {
+        _commonStats.works += numResults;
+        _commonStats.advanced += numResults;
+        return;
+    }
+
+    ++_commonStats.works;
+    if (NEED_TIME == state) {
+        ++_commonStats.needTime;
+    } else if (NEED_YIELD == state) {
+        ++_commonStats.needYield;
+    }
+}
+
+void PlanStage::stashState(StageState state, WorkingSetID id) {
+    invariant(NEED_YIELD == state);
+    invariant(!_hasStashedState);
+    _hasStashedState = true;
+    _stashedState = state;
+    _stashedId = id;
+}
+
 void PlanStage::saveState() {
     ++_commonStats.yields;
     for (auto&& child : _children) {
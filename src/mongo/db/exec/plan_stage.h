@@ -188,6 +188,23 @@ public:
      */
     StageState work(WorkingSetID* out);
 
+    /**
+     * Batch variant of work(). Performs up to 'maxWorks' units of work, appending the id of every
+     * result to 'out', which must be empty. Returns ADVANCED if at least one result was appended,
+     * and NEED_TIME if the work produced no result yet.
+     *
+     * Any other state is returned just like work() would, with the id work() would have set, if
+     * valid, as the only entry of 'out'. If NEED_YIELD comes up after some results were already
+     * appended, it is held back and returned by the next call to work() or workBatch(); IS_EOF is
+     * left for the next call to come up with again. FAILURE and DEAD discard the results before
+     * them.
+     *
+     * When a batch holds several results, each holds owned data, as the work that produced the
+     * later ones may have invalidated storage engine buffers. Stages opt in by overriding
+     * doWorkBatch(); the others fall back to a single call to work().
+     */
+    StageState workBatch(size_t maxWorks, std::vector<WorkingSetID>* out);
+
     /**
      * Returns true if no more work can be done on the query / out of results.
      */
@@ -347,6 +364,32 @@ protected:
      */
     virtual StageState doWork(WorkingSetID* out) = 0;
 
+    /**
+     * Performs up to 'maxWorks' units of work. See comment at workBatch() above.
+     *
+     * Overrides are responsible for their stage's common stats and timing.
+     */
+    virtual StageState doWorkBatch(size_t maxWorks, std::vector<WorkingSetID>* out);
+
+    /**
+     * doWorkBatch() implementation for stages that produce results in a loop of their own: calls
+     * doWork() up to 'maxWorks' times, counting each call in the common stats, and makes each
+     * result in 'ws' owned.
+     */
+    StageState workRepeatedly(size_t maxWorks, WorkingSet* ws, std::vector<WorkingSetID>* out);
+
+    /**
+     * Records a batch returned by a child's workBatch() in this stage's common stats, as if
+     * work() had been called once per result.
+     */
+    void recordBatch(StageState state, size_t numResults);
+
+    /**
+     * Holds back a NEED_YIELD that came up during a batch after some results had been produced, so
+     * the next call to work() or workBatch() returns it.
+     */
+    void stashState(StageState state, WorkingSetID id);
+
     /**
      * Saves any stage-specific state required to resume where it was if the underlying data
      * changes.
@@ -396,7 +439,15 @@ protected:
     CommonStats _commonStats;
 
 private:
+    // Performs one unit of work, updating the common stats but not the execution time.
+    StageState _workUntimed(WorkingSetID* out);
+
     OperationContext* _opCtx;
+
+    // Set by stashState().
+    bool _hasStashedState = false;
+    StageState _stashedState = NEED_TIME;
+    WorkingSetID _stashedId = WorkingSet::INVALID_ID;
 };
 
 }  // namespace mongo
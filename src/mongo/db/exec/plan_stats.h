@@ -340,7 +340,7 @@ struct EnsureSortedStats : public SpecificStats {
 };
 
 struct FetchStats : public SpecificStats {
-    FetchStats() : alreadyHasObj(0), forcedFetches(0), docsExamined(0) {}
+    FetchStats() : alreadyHasObj(0), forcedFetches(0), docsExamined(0), docsPrefetched(0) {}
 
     SpecificStats* clone() const final {
         FetchStats* specific = new FetchStats(*this);
@@ -355,6 +355,9 @@ struct FetchStats : public SpecificStats {
 
     // The total number of full documents touched by the fetch stage.
     size_t docsExamined;
+
+    // How many records were we able to ask the storage engine to prefetch?
+    size_t docsPrefetched;
 };
 
 struct GroupStats : public SpecificStats {
@@ -524,6 +527,9 @@ struct SortStats : public SpecificStats {
     // What's our memory limit?
     size_t memLimit;
 
+    // Did we spill buffered results to disk?
+    bool usedDisk = false;
+
     // The number of results to return from the sort.
     size_t limit;
 
@@ -597,6 +603,13 @@ struct NearStats : public SpecificStats {
     // btree index version, not geo index version
     int indexVersion;
     BSONObj keyPattern;
+
+    // Set for a best-first search, which doesn't use intervals. Its index scans, one per cell it
+    // searches, are not kept around, so it counts the keys they examined.
+    bool bestFirst = false;
+    size_t cellsSearched = 0;
+    size_t keysExamined = 0;
+    size_t docsExamined = 0;
 };
 
 struct UpdateStats : public SpecificStats {
@@ -677,6 +690,9 @@ struct TextOrStats : public SpecificStats {
     }
 
     size_t fetches;
+
+    // Number of best scoring documents the stage was asked for, or zero for all of them.
+    size_t topK = 0;
 };
 
 }  // namespace mongo
@@ -226,6 +226,35 @@ PlanStage::StageState ProjectionStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState ProjectionStage::doWorkBatch(size_t maxWorks,
+                                                   std::vector<WorkingSetID>* out) {
+    ScopedTimer timer(getClock(), &_commonStats.executionTimeMillis);
+    StageState status = child()->workBatch(maxWorks, out);
+
+    if (PlanStage::ADVANCED == status) {
+        for (auto&& id : *out) {
+            Status projStatus = transform(_ws->get(id));
+            if (!projStatus.isOK()) {
+                warning() << "Couldn't execute projection, status = " << redact(projStatus);
+                for (auto&& idToFree : *out) {
+                    _ws->free(idToFree);
+                }
+                out->clear();
+                out->push_back(WorkingSetCommon::allocateStatusMember(_ws, projStatus));
+                recordBatch(PlanStage::FAILURE, 0);
+                return PlanStage::FAILURE;
+            }
+        }
+    } else if ((PlanStage::FAILURE == status || PlanStage::DEAD == status) && out->empty()) {
+        Status errorStatus(ErrorCodes::InternalError,
+                      "projection stage failed to read in results from child");
+        out->push_back(WorkingSetCommon::allocateStatusMember(_ws, errorStatus));
+    }
+
+    recordBatch(status, out->size());
+    return status;
+}
+
 unique_ptr<PlanStageStats> ProjectionStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_PROJECTION);
@@ -59,6 +59,11 @@ PlanStage::StageState QueuedDataStage::doWork(WorkingSetID* out) {
     return state;
 }
 
+PlanStage::StageState QueuedDataStage::doWorkBatch(size_t maxWorks,
+                                                   std::vector<WorkingSetID>* out) {
+    return workRepeatedly(maxWorks, _ws, out);
+}
+
 bool QueuedDataStage::isEOF() {
     return _results.empty();
 }
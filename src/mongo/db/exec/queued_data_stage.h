@@ -50,6 +50,7 @@ public:
     QueuedDataStage(OperationContext* opCtx, WorkingSet* ws);
 
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks, std::vector<WorkingSetID>* out) final;
 
     bool isEOF() final;
 
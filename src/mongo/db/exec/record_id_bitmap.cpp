@@ -0,0 +1,112 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/record_id_bitmap.h"
+
+#include <algorithm>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+bool RecordIdBitmap::Container::insert(uint16_t low) {
+    if (isBitmap()) {
+        uint64_t& word = _bitmap[low / 64];
+        const uint64_t bit = uint64_t(1) << (low % 64);
+        if (word & bit) {
+            return false;
+        }
+        word |= bit;
+        ++_cardinality;
+        return true;
+    }
+
+    auto it = std::lower_bound(_array.begin(), _array.end(), low);
+    if (it != _array.end() && *it == low) {
+        return false;
+    }
+    _array.insert(it, low);
+    ++_cardinality;
+
+    if (_cardinality > kMaxArrayCardinality) {
+        convertToBitmap();
+    }
+    return true;
+}
+
+bool RecordIdBitmap::Container::contains(uint16_t low) const {
+    if (isBitmap()) {
+        return _bitmap[low / 64] & (uint64_t(1) << (low % 64));
+    }
+    return std::binary_search(_array.begin(), _array.end(), low);
+}
+
+size_t RecordIdBitmap::Container::getMemUsage() const {
+    return sizeof(Container) + _array.capacity() * sizeof(uint16_t) +
+        _bitmap.capacity() * sizeof(uint64_t);
+}
+
+void RecordIdBitmap::Container::convertToBitmap() {
+    invariant(!isBitmap());
+    _bitmap.assign(kBitmapWords, 0);
+    for (uint16_t low : _array) {
+        _bitmap[low / 64] |= uint64_t(1) << (low % 64);
+    }
+    _array.clear();
+    _array.shrink_to_fit();
+}
+
+bool RecordIdBitmap::insert(const RecordId& id) {
+    if (!_chunks[chunkOf(id)].insert(lowBitsOf(id))) {
+        return false;
+    }
+    ++_size;
+    return true;
+}
+
+bool RecordIdBitmap::contains(const RecordId& id) const {
+    auto it = _chunks.find(chunkOf(id));
+    return it != _chunks.end() && it->second.contains(lowBitsOf(id));
+}
+
+void RecordIdBitmap::clear() {
+    _chunks.clear();
+    _size = 0;
+}
+
+size_t RecordIdBitmap::getMemUsage() const {
+    size_t memUsage = 0;
+    for (auto&& chunk : _chunks) {
+        memUsage += chunk.second.getMemUsage();
+    }
+    return memUsage;
+}
+
+}  // namespace mongo
@@ -0,0 +1,118 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mongo/db/record_id.h"
+#include "mongo/platform/unordered_map.h"
+
+namespace mongo {
+
+/**
+ * A compressed set of RecordIds, laid out like a Roaring bitmap. Ids are grouped into chunks of
+ * 2^16 by their high bits. A sparse chunk keeps a sorted array of the low 16 bits of its ids, and
+ * switches to a fixed 8KB bitmap once it holds more than kMaxArrayCardinality of them.
+ *
+ * Ids from an index scan tend to cluster, so this is far smaller than a hash set of RecordIds,
+ * and membership tests touch at most one small array or one word of a bitmap.
+ */
+class RecordIdBitmap {
+public:
+    // A chunk stores its ids as an array up to this many, which is the size at which the array
+    // takes as much memory as the bitmap.
+    static const size_t kMaxArrayCardinality = 4096;
+
+    /**
+     * Adds 'id' to the set. Returns false if it was already present.
+     */
+    bool insert(const RecordId& id);
+
+    bool contains(const RecordId& id) const;
+
+    size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return 0 == _size;
+    }
+
+    void clear();
+
+    /**
+     * Returns an estimate of the bytes used by the set, excluding the chunk table itself.
+     */
+    size_t getMemUsage() const;
+
+private:
+    static const size_t kBitmapWords = (1 << 16) / 64;
+
+    /**
+     * The ids within one chunk, held either as a sorted array or as a bitmap.
+     */
+    class Container {
+    public:
+        bool insert(uint16_t low);
+        bool contains(uint16_t low) const;
+
+        size_t cardinality() const {
+            return _cardinality;
+        }
+
+        size_t getMemUsage() const;
+
+    private:
+        bool isBitmap() const {
+            return !_bitmap.empty();
+        }
+
+        void convertToBitmap();
+
+        // Exactly one of these is in use; the bitmap once it is non-empty.
+        std::vector<uint16_t> _array;
+        std::vector<uint64_t> _bitmap;
+
+        size_t _cardinality = 0;
+    };
+
+    static uint64_t chunkOf(const RecordId& id) {
+        return static_cast<uint64_t>(id.repr()) >> 16;
+    }
+
+    static uint16_t lowBitsOf(const RecordId& id) {
+        return static_cast<uint16_t>(id.repr());
+    }
+
+    unordered_map<uint64_t, Container> _chunks;
+    size_t _size = 0;
+};
+
+}  // namespace mongo
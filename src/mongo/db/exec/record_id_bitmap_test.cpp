@@ -0,0 +1,109 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/record_id_bitmap.h"
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(RecordIdBitmapTest, EmptyBitmapContainsNothing) {
+    RecordIdBitmap bitmap;
+    ASSERT_TRUE(bitmap.empty());
+    ASSERT_EQ(bitmap.size(), 0U);
+    ASSERT_FALSE(bitmap.contains(RecordId(1)));
+}
+
+TEST(RecordIdBitmapTest, InsertReportsDuplicates) {
+    RecordIdBitmap bitmap;
+    ASSERT_TRUE(bitmap.insert(RecordId(5)));
+    ASSERT_FALSE(bitmap.insert(RecordId(5)));
+    ASSERT_TRUE(bitmap.insert(RecordId(6)));
+    ASSERT_EQ(bitmap.size(), 2U);
+    ASSERT_TRUE(bitmap.contains(RecordId(5)));
+    ASSERT_TRUE(bitmap.contains(RecordId(6)));
+    ASSERT_FALSE(bitmap.contains(RecordId(7)));
+}
+
+TEST(RecordIdBitmapTest, IdsInDifferentChunksDoNotCollide) {
+    RecordIdBitmap bitmap;
+    const long long chunkSize = 1 << 16;
+    ASSERT_TRUE(bitmap.insert(RecordId(3)));
+    ASSERT_TRUE(bitmap.insert(RecordId(chunkSize + 3)));
+    ASSERT_FALSE(bitmap.contains(RecordId(2 * chunkSize + 3)));
+    ASSERT_TRUE(bitmap.contains(RecordId(chunkSize + 3)));
+    ASSERT_TRUE(bitmap.insert(RecordId::max()));
+    ASSERT_TRUE(bitmap.insert(RecordId::min()));
+    ASSERT_TRUE(bitmap.contains(RecordId::max()));
+    ASSERT_TRUE(bitmap.contains(RecordId::min()));
+    ASSERT_EQ(bitmap.size(), 4U);
+}
+
+TEST(RecordIdBitmapTest, DenseChunkSwitchesToBitmap) {
+    RecordIdBitmap bitmap;
+    const size_t numIds = RecordIdBitmap::kMaxArrayCardinality * 2;
+
+    // Insert every other id, in descending order, so that each insert goes to the front.
+    for (size_t i = 0; i < numIds; ++i) {
+        ASSERT_TRUE(bitmap.insert(RecordId(2 * (numIds - i))));
+    }
+    ASSERT_EQ(bitmap.size(), numIds);
+    for (size_t i = 1; i <= numIds; ++i) {
+        ASSERT_TRUE(bitmap.contains(RecordId(2 * i)));
+        ASSERT_FALSE(bitmap.contains(RecordId(2 * i + 1)));
+    }
+    ASSERT_FALSE(bitmap.insert(RecordId(2)));
+
+    // One chunk with a full bitmap.
+    ASSERT_LT(bitmap.getMemUsage(), 2 * (1 << 16) / 8U);
+}
+
+TEST(RecordIdBitmapTest, SparseIdsUseLittleMemory) {
+    RecordIdBitmap bitmap;
+    for (int i = 1; i <= 100; ++i) {
+        bitmap.insert(RecordId(i));
+    }
+    ASSERT_LT(bitmap.getMemUsage(), 1024U);
+}
+
+TEST(RecordIdBitmapTest, ClearRemovesEverything) {
+    RecordIdBitmap bitmap;
+    for (int i = 1; i <= 10000; ++i) {
+        bitmap.insert(RecordId(i));
+    }
+    bitmap.clear();
+    ASSERT_TRUE(bitmap.empty());
+    ASSERT_FALSE(bitmap.contains(RecordId(1)));
+    ASSERT_EQ(bitmap.getMemUsage(), 0U);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -87,6 +87,36 @@ PlanStage::StageState SkipStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState SkipStage::doWorkBatch(size_t maxWorks, std::vector<WorkingSetID>* out) {
+    ScopedTimer timer(getClock(), &_commonStats.executionTimeMillis);
+    StageState status = child()->workBatch(maxWorks, out);
+
+    if (PlanStage::ADVANCED == status && _toSkip > 0) {
+        // Drop the results we're still skipping, counting each as work() would have.
+        const size_t numToDrop = std::min(out->size(), static_cast<size_t>(_toSkip));
+        for (size_t i = 0; i < numToDrop; ++i) {
+            _ws->free((*out)[i]);
+        }
+        out->erase(out->begin(), out->begin() + numToDrop);
+        _toSkip -= numToDrop;
+        _commonStats.works += numToDrop;
+        _commonStats.needTime += numToDrop;
+
+        if (out->empty()) {
+            return PlanStage::NEED_TIME;
+        }
+    }
+
+    recordBatch(status, out->size());
+    if ((PlanStage::FAILURE == status || PlanStage::DEAD == status) && out->empty()) {
+        Status errorStatus(ErrorCodes::InternalError,
+                           "skip stage failed to read in results from child");
+        out->push_back(WorkingSetCommon::allocateStatusMember(_ws, errorStatus));
+    }
+
+    return status;
+}
+
 unique_ptr<PlanStageStats> SkipStage::getStats() {
     _commonStats.isEOF = isEOF();
     _specificStats.skip = _toSkip;
@@ -48,6 +48,7 @@ public:
 
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks, std::vector<WorkingSetID>* out) final;
 
     StageType stageType() const final {
         return STAGE_SKIP;
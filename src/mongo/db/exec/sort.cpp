@@ -31,6 +31,7 @@
 #include "mongo/db/exec/sort.h"
 
 #include <algorithm>
+#include <limits>
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/exec/scoped_timer.h"
@@ -41,6 +42,7 @@
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 
@@ -51,22 +53,231 @@ using std::unique_ptr;
 using std::vector;
 using stdx::make_unique;
 
-// static
-const char* SortStage::kStageType = "SORT";
+namespace {
+
+// Items are compared on (sortKey, RecordId). This is also how the items are ordered in the
+// indices. Keys are compared using BSONObj::woCompare() with RecordId as a tie-breaker.
+class SortStageComparator {
+public:
+    explicit SortStageComparator(BSONObj pattern) : _pattern(std::move(pattern)) {}
+
+    int operator()(const std::pair<BSONObj, SortStage::BufferedMember>& lhs,
+                   const std::pair<BSONObj, SortStage::BufferedMember>& rhs) const {
+        // False means ignore field names.
+        int result = lhs.first.woCompare(rhs.first, _pattern, false);
+        if (0 != result) {
+            return result;
+        }
+        // Indices use RecordId as an additional sort key so we must as well.
+        // See sorta.js.
+        return lhs.second.recordId().compare(rhs.second.recordId());
+    }
+
+private:
+    BSONObj _pattern;
+};
+
+// Flags recording which optional parts of a BufferedMember were serialized.
+enum BufferedMemberFlags : char {
+    kHasTextScore = 1 << 0,
+    kHasGeoDistance = 1 << 1,
+    kHasGeoNearPoint = 1 << 2,
+    kHasIndexKey = 1 << 3,
+    kHasKeyData = 1 << 4,
+};
+
+}  // namespace
+
+SortStage::BufferedMember::BufferedMember(const WorkingSetMember& member, long long readOrder)
+    : _obj(member.obj.value()),
+      _snapshotId(member.obj.snapshotId().toNumber()),
+      _readOrder(readOrder) {
+    if (member.hasRecordId()) {
+        // The RecordId breaks ties when sorting two WSMs with the same sort key.
+        _recordId = member.recordId;
+    }
+    if (member.hasComputed(WSM_COMPUTED_TEXT_SCORE)) {
+        _textScore = static_cast<const TextScoreComputedData*>(
+                         member.getComputed(WSM_COMPUTED_TEXT_SCORE))
+                         ->getScore();
+    }
+    if (member.hasComputed(WSM_COMPUTED_GEO_DISTANCE)) {
+        _geoDistance = static_cast<const GeoDistanceComputedData*>(
+                           member.getComputed(WSM_COMPUTED_GEO_DISTANCE))
+                           ->getDist();
+    }
+    if (member.hasComputed(WSM_GEO_NEAR_POINT)) {
+        _geoNearPoint =
+            static_cast<const GeoNearPointComputedData*>(member.getComputed(WSM_GEO_NEAR_POINT))
+                ->getPoint();
+    }
+    if (member.hasComputed(WSM_INDEX_KEY)) {
+        _indexKey = static_cast<const IndexKeyComputedData*>(member.getComputed(WSM_INDEX_KEY))
+                        ->getKey();
+    }
+    if (member.getState() == WorkingSetMember::RID_AND_IDX) {
+        _keyData = member.keyData;
+    }
+}
+
+void SortStage::BufferedMember::setObj(BSONObj obj) {
+    _obj = std::move(obj);
+    _snapshotId = 0;
+    _keyData.clear();
+}
+
+void SortStage::BufferedMember::restoreTo(WorkingSet* ws,
+                                          WorkingSetID id,
+                                          const BSONObj& sortKey,
+                                          bool dropRecordId) {
+    WorkingSetMember* member = ws->get(id);
 
-SortStage::WorkingSetComparator::WorkingSetComparator(BSONObj p) : pattern(p) {}
+    if (_textScore) {
+        member->addComputed(new TextScoreComputedData(*_textScore));
+    }
+    if (_geoDistance) {
+        member->addComputed(new GeoDistanceComputedData(*_geoDistance));
+    }
+    if (!_geoNearPoint.isEmpty()) {
+        member->addComputed(new GeoNearPointComputedData(_geoNearPoint));
+    }
+    if (!_indexKey.isEmpty()) {
+        member->addComputed(new IndexKeyComputedData(_indexKey));
+    }
+    member->addComputed(new SortKeyComputedData(sortKey));
+
+    if (!hasObj()) {
+        invariant(!dropRecordId);
+        member->recordId = _recordId;
+        member->keyData = _keyData;
+        // The index keys may have been read before a yield, so the fetch has to check that the
+        // document still has them.
+        member->isSuspicious = true;
+        ws->transitionToRecordIdAndIdx(id);
+        return;
+    }
+
+    const SnapshotId snapshotId = _snapshotId ? SnapshotId(_snapshotId) : SnapshotId();
+    member->obj = Snapshotted<BSONObj>(snapshotId, _obj.getOwned());
+    if (_recordId.isNormal() && !dropRecordId) {
+        member->recordId = _recordId;
+        ws->transitionToRecordIdAndObj(id);
+    } else {
+        member->transitionToOwnedObj();
+    }
+}
+
+void SortStage::BufferedMember::serializeForSorter(BufBuilder& buf) const {
+    char flags = 0;
+    if (_textScore) {
+        flags |= kHasTextScore;
+    }
+    if (_geoDistance) {
+        flags |= kHasGeoDistance;
+    }
+    if (!_geoNearPoint.isEmpty()) {
+        flags |= kHasGeoNearPoint;
+    }
+    if (!_indexKey.isEmpty()) {
+        flags |= kHasIndexKey;
+    }
+    if (!_keyData.empty()) {
+        flags |= kHasKeyData;
+    }
+
+    buf.appendChar(flags);
+    _obj.serializeForSorter(buf);
+    buf.appendNum(static_cast<long long>(_snapshotId));
+    _recordId.serializeForSorter(buf);
+    buf.appendNum(_readOrder);
+    if (_textScore) {
+        buf.appendNum(*_textScore);
+    }
+    if (_geoDistance) {
+        buf.appendNum(*_geoDistance);
+    }
+    if (!_geoNearPoint.isEmpty()) {
+        _geoNearPoint.serializeForSorter(buf);
+    }
+    if (!_indexKey.isEmpty()) {
+        _indexKey.serializeForSorter(buf);
+    }
+    if (!_keyData.empty()) {
+        // Spilled runs are only read back by this process, while the indexes are still in use by
+        // the query, so the access method is written as a plain pointer.
+        buf.appendNum(static_cast<int>(_keyData.size()));
+        for (auto&& datum : _keyData) {
+            datum.indexKeyPattern.serializeForSorter(buf);
+            datum.keyData.serializeForSorter(buf);
+            buf.appendNum(static_cast<long long>(reinterpret_cast<intptr_t>(datum.index)));
+        }
+    }
+}
+
+SortStage::BufferedMember SortStage::BufferedMember::deserializeForSorter(
+    BufReader& buf, const SorterDeserializeSettings&) {
+    const BSONObj::SorterDeserializeSettings bsonSettings;
+    const RecordId::SorterDeserializeSettings recordIdSettings;
+
+    BufferedMember result;
+    const char flags = buf.read<char>();
+    result._obj = BSONObj::deserializeForSorter(buf, bsonSettings);
+    result._snapshotId = static_cast<uint64_t>(buf.read<LittleEndian<long long>>());
+    result._recordId = RecordId::deserializeForSorter(buf, recordIdSettings);
+    result._readOrder = buf.read<LittleEndian<long long>>();
+    if (flags & kHasTextScore) {
+        result._textScore = buf.read<LittleEndian<double>>();
+    }
+    if (flags & kHasGeoDistance) {
+        result._geoDistance = buf.read<LittleEndian<double>>();
+    }
+    if (flags & kHasGeoNearPoint) {
+        result._geoNearPoint = BSONObj::deserializeForSorter(buf, bsonSettings);
+    }
+    if (flags & kHasIndexKey) {
+        result._indexKey = BSONObj::deserializeForSorter(buf, bsonSettings);
+    }
+    if (flags & kHasKeyData) {
+        const int numKeys = buf.read<LittleEndian<int>>();
+        for (int i = 0; i < numKeys; ++i) {
+            BSONObj keyPattern = BSONObj::deserializeForSorter(buf, bsonSettings);
+            BSONObj keyData = BSONObj::deserializeForSorter(buf, bsonSettings);
+            auto index = reinterpret_cast<const IndexAccessMethod*>(
+                static_cast<intptr_t>(buf.read<LittleEndian<long long>>()));
+            result._keyData.emplace_back(keyPattern, keyData, index);
+        }
+    }
+    return result;
+}
+
+int SortStage::BufferedMember::memUsageForSorter() const {
+    int usage = sizeof(BufferedMember) + _obj.objsize();
+    if (!_geoNearPoint.isEmpty()) {
+        usage += _geoNearPoint.objsize();
+    }
+    if (!_indexKey.isEmpty()) {
+        usage += _indexKey.objsize();
+    }
+    for (auto&& datum : _keyData) {
+        usage += sizeof(IndexKeyDatum) + datum.keyData.objsize();
+    }
+    return usage;
+}
 
-bool SortStage::WorkingSetComparator::operator()(const SortableDataItem& lhs,
-                                                 const SortableDataItem& rhs) const {
-    // False means ignore field names.
-    int result = lhs.sortKey.woCompare(rhs.sortKey, pattern, false);
-    if (0 != result) {
-        return result < 0;
+SortStage::BufferedMember SortStage::BufferedMember::getOwned() const {
+    BufferedMember result(*this);
+    result._obj = _obj.getOwned();
+    result._geoNearPoint = _geoNearPoint.getOwned();
+    result._indexKey = _indexKey.getOwned();
+    for (auto&& datum : result._keyData) {
+        datum.keyData = datum.keyData.getOwned();
     }
-    // Indices use RecordId as an additional sort key so we must as well.
-    return lhs.recordId < rhs.recordId;
+    return result;
 }
 
+// static
+const char* SortStage::kStageType = "SORT";
+
 SortStage::SortStage(OperationContext* opCtx,
                      const SortStageParams& params,
                      WorkingSet* ws,
@@ -76,33 +287,43 @@ SortStage::SortStage(OperationContext* opCtx,
       _ws(ws),
       _pattern(params.pattern),
       _limit(params.limit),
+      _allowDiskUse(params.allowDiskUse ||
+                    internalQueryExecAllowDiskUseForBlockingSort.load()),
       _sorted(false),
-      _resultIterator(_data.end()),
-      _memUsage(0) {
+      _numRead(0) {
     _children.emplace_back(child);
 
     BSONObj sortComparator = FindCommon::transformSortSpec(_pattern);
-    _sortKeyComparator = stdx::make_unique<WorkingSetComparator>(sortComparator);
-
-    // If limit > 1, we need to initialize _dataSet here to maintain ordered set of data items while
-    // fetching from the child stage.
-    if (_limit > 1) {
-        const WorkingSetComparator& cmp = *_sortKeyComparator;
-        _dataSet.reset(new SortableDataItemSet(cmp));
-    }
+    _sorter.reset(BufferSorter::make(makeSortOptions(), SortStageComparator(sortComparator)));
 }
 
 SortStage::~SortStage() {}
 
+SortOptions SortStage::makeSortOptions() const {
+    SortOptions opts;
+    opts.Limit(_limit);
+    if (_allowDiskUse) {
+        opts.MaxMemoryUsageBytes(
+                static_cast<size_t>(internalQueryExecMaxBlockingSortBytes.load()))
+            .ExtSortAllowed()
+            .TempDir(storageGlobalParams.dbpath + "/_tmp");
+    } else {
+        // Without disk use, doWork() enforces the memory limit itself so that the query fails
+        // with the usual error rather than an exception from the Sorter.
+        opts.MaxMemoryUsageBytes(std::numeric_limits<size_t>::max());
+    }
+    return opts;
+}
+
 bool SortStage::isEOF() {
     // We're done when our child has no more results, we've sorted the child's results, and
     // we've returned all sorted results.
-    return child()->isEOF() && _sorted && (_data.end() == _resultIterator);
+    return child()->isEOF() && _sorted && !_resultIterator->more();
 }
 
 PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
     const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes.load());
-    if (_memUsage > maxBytes) {
+    if (!_sorted && !_allowDiskUse && _sorter->memUsed() > maxBytes) {
         mongoutils::str::stream ss;
         ss << "Sort operation used more than the maximum " << maxBytes
            << " bytes of RAM. Add an index, or specify a smaller limit.";
@@ -121,41 +342,34 @@ PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
         StageState code = child()->work(&id);
 
         if (PlanStage::ADVANCED == code) {
-            // Add it into the map for quick invalidation if it has a valid RecordId.
-            // A RecordId may be invalidated at any time (during a yield).  We need to get into
-            // the WorkingSet as quickly as possible to handle it.
             WorkingSetMember* member = _ws->get(id);
 
-            // Planner must put a fetch before we get here.
-            verify(member->hasObj());
-
-            // We might be sorting something that was invalidated at some point.
-            if (member->hasRecordId()) {
-                _wsidByRecordId[member->recordId] = id;
+            // The planner puts a fetch before us unless the index keys hold the sort key.
+            if (!member->hasObj()) {
+                invariant(member->getState() == WorkingSetMember::RID_AND_IDX);
+                _bufferedUnfetched = true;
             }
 
-            SortableDataItem item;
-            item.wsid = id;
-
             // We extract the sort key from the WSM's computed data. This must have been generated
             // by a SortKeyGeneratorStage descendent in the execution tree.
             auto sortKeyComputedData =
                 static_cast<const SortKeyComputedData*>(member->getComputed(WSM_SORT_KEY));
-            item.sortKey = sortKeyComputedData->getSortKey();
-
-            if (member->hasRecordId()) {
-                // The RecordId breaks ties when sorting two WSMs with the same sort key.
-                item.recordId = member->recordId;
-            }
 
-            addToBuffer(item);
+            // The Sorter keeps copies of what it is given, so the WSM can be freed right away.
+            member->makeObjOwnedIfNeeded();
+            _sorter->add(sortKeyComputedData->getSortKey(), BufferedMember(*member, _numRead++));
+            _ws->free(id);
 
+            _specificStats.memUsage = _sorter->memUsed();
+            if (_sorter->numFiles() > 0) {
+                _specificStats.usedDisk = true;
+            }
             return PlanStage::NEED_TIME;
         } else if (PlanStage::IS_EOF == code) {
             // TODO: We don't need the lock for this.  We could ask for a yield and do this work
             // unlocked.  Also, this is performing a lot of work for one call to work(...)
-            sortBuffer();
-            _resultIterator = _data.begin();
+            _specificStats.usedDisk = _sorter->numFiles() > 0;
+            _resultIterator.reset(_sorter->done());
             _sorted = true;
             return PlanStage::NEED_TIME;
         } else if (PlanStage::FAILURE == code || PlanStage::DEAD == code) {
@@ -178,42 +392,51 @@ PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
     }
 
     // Returning results.
-    verify(_resultIterator != _data.end());
     verify(_sorted);
-    *out = _resultIterator->wsid;
-    _resultIterator++;
+    verify(_resultIterator->more());
+    auto next = _resultIterator->next();
+
+    // A result whose RecordId was invalidated after we read it is returned as an owned object, as
+    // though it had been fetched when the invalidation happened.
+    bool invalidated = false;
+    if (next.second.recordId().isNormal()) {
+        auto it = _invalidations.find(next.second.recordId());
+        invalidated = _invalidations.end() != it && next.second.readOrder() < it->second;
+        if (invalidated) {
+            ++_specificStats.forcedFetches;
+        }
+    }
 
-    // If we're returning something, take it out of our DL -> WSID map so that future
-    // calls to invalidate don't cause us to take action for a DL we're done with.
-    WorkingSetMember* member = _ws->get(*out);
-    if (member->hasRecordId()) {
-        _wsidByRecordId.erase(member->recordId);
+    if (invalidated && !next.second.hasObj()) {
+        auto doc = _invalidatedDocs.find(next.second.recordId());
+        if (_invalidatedDocs.end() == doc) {
+            // There was no collection to read the document from, so the result is dropped as
+            // though it had been deleted.
+            return PlanStage::NEED_TIME;
+        }
+        next.second.setObj(doc->second);
     }
 
+    *out = _ws->allocate();
+    next.second.restoreTo(_ws, *out, next.first, invalidated);
     return PlanStage::ADVANCED;
 }
 
 void SortStage::doInvalidate(OperationContext* opCtx, const RecordId& dl, InvalidationType type) {
     // If we have a deletion, we can fetch and carry on.
     // If we have a mutation, it's easier to fetch and use the previous document.
-    // So, no matter what, fetch and keep the doc in play.
-
-    // _data contains indices into the WorkingSet, not actual data.  If a WorkingSetMember in
-    // the WorkingSet needs to change state as a result of a RecordId invalidation, it will still
-    // be at the same spot in the WorkingSet.  As such, we don't need to modify _data.
-    DataMap::iterator it = _wsidByRecordId.find(dl);
-
-    // If we're holding on to data that's got the RecordId we're invalidating...
-    if (_wsidByRecordId.end() != it) {
-        // Grab the WSM that we're nuking.
-        WorkingSetMember* member = _ws->get(it->second);
-        verify(member->recordId == dl);
-
-        WorkingSetCommon::fetchAndInvalidateRecordId(opCtx, member, _collection);
+    // So, no matter what, keep the buffered copy of the doc in play. The buffered results hold
+    // their own copies of each document, so all that is left to do is to stop handing out the
+    // RecordId with results read so far.
+    if (_sorted && !_resultIterator->more()) {
+        return;
+    }
+    _invalidations[dl] = _numRead;
 
-        // Remove the RecordId from our set of active DLs.
-        _wsidByRecordId.erase(it);
-        ++_specificStats.forcedFetches;
+    // Results buffered as index keys have no document to fall back on, so read it now, before it
+    // is deleted or changed.
+    if (_bufferedUnfetched && _collection) {
+        _invalidatedDocs[dl] = _collection->docFor(opCtx, dl).value().getOwned();
     }
 }
 
@@ -221,7 +444,6 @@ unique_ptr<PlanStageStats> SortStage::getStats() {
     _commonStats.isEOF = isEOF();
     const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes.load());
     _specificStats.memLimit = maxBytes;
-    _specificStats.memUsage = _memUsage;
     _specificStats.limit = _limit;
     _specificStats.sortPattern = _pattern.getOwned();
 
@@ -235,109 +457,7 @@ const SpecificStats* SortStage::getSpecificStats() const {
     return &_specificStats;
 }
 
-/**
- * addToBuffer() and sortBuffer() work differently based on the
- * configured limit. addToBuffer() is also responsible for
- * performing some accounting on the overall memory usage to
- * make sure we're not using too much memory.
- *
- * limit == 0:
- *     addToBuffer() - Adds item to vector.
- *     sortBuffer() - Sorts vector.
- * limit == 1:
- *     addToBuffer() - Replaces first item in vector with max of
- *                     current and new item.
- *                     Updates memory usage if item was replaced.
- *     sortBuffer() - Does nothing.
- * limit > 1:
- *     addToBuffer() - Does not update vector. Adds item to set.
- *                     If size of set exceeds limit, remove item from set
- *                     with lowest key. Updates memory usage accordingly.
- *     sortBuffer() - Copies items from set to vectors.
- */
-void SortStage::addToBuffer(const SortableDataItem& item) {
-    // Holds ID of working set member to be freed at end of this function.
-    WorkingSetID wsidToFree = WorkingSet::INVALID_ID;
-
-    WorkingSetMember* member = _ws->get(item.wsid);
-    if (_limit == 0) {
-        // Ensure that the BSONObj underlying the WorkingSetMember is owned in case we yield.
-        member->makeObjOwnedIfNeeded();
-        _data.push_back(item);
-        _memUsage += member->getMemUsage();
-    } else if (_limit == 1) {
-        if (_data.empty()) {
-            member->makeObjOwnedIfNeeded();
-            _data.push_back(item);
-            _memUsage = member->getMemUsage();
-            return;
-        }
-        wsidToFree = item.wsid;
-        const WorkingSetComparator& cmp = *_sortKeyComparator;
-        // Compare new item with existing item in vector.
-        if (cmp(item, _data[0])) {
-            wsidToFree = _data[0].wsid;
-            member->makeObjOwnedIfNeeded();
-            _data[0] = item;
-            _memUsage = member->getMemUsage();
-        }
-    } else {
-        // Update data item set instead of vector
-        // Limit not reached - insert and return
-        vector<SortableDataItem>::size_type limit(_limit);
-        if (_dataSet->size() < limit) {
-            member->makeObjOwnedIfNeeded();
-            _dataSet->insert(item);
-            _memUsage += member->getMemUsage();
-            return;
-        }
-        // Limit will be exceeded - compare with item with lowest key
-        // If new item does not have a lower key value than last item,
-        // do nothing.
-        wsidToFree = item.wsid;
-        SortableDataItemSet::const_iterator lastItemIt = --(_dataSet->end());
-        const SortableDataItem& lastItem = *lastItemIt;
-        const WorkingSetComparator& cmp = *_sortKeyComparator;
-        if (cmp(item, lastItem)) {
-            _memUsage -= _ws->get(lastItem.wsid)->getMemUsage();
-            _memUsage += member->getMemUsage();
-            wsidToFree = lastItem.wsid;
-            // According to std::set iterator validity rules,
-            // it does not matter which of erase()/insert() happens first.
-            // Here, we choose to erase first to release potential resources
-            // used by the last item and to keep the scope of the iterator to a minimum.
-            _dataSet->erase(lastItemIt);
-            member->makeObjOwnedIfNeeded();
-            _dataSet->insert(item);
-        }
-    }
-
-    // If the working set ID is valid, remove from
-    // RecordId invalidation map and free from working set.
-    if (wsidToFree != WorkingSet::INVALID_ID) {
-        WorkingSetMember* member = _ws->get(wsidToFree);
-        if (member->hasRecordId()) {
-            _wsidByRecordId.erase(member->recordId);
-        }
-        _ws->free(wsidToFree);
-    }
-}
-
-void SortStage::sortBuffer() {
-    if (_limit == 0) {
-        const WorkingSetComparator& cmp = *_sortKeyComparator;
-        std::sort(_data.begin(), _data.end(), cmp);
-    } else if (_limit == 1) {
-        // Buffer contains either 0 or 1 item so it is already in a sorted state.
-        return;
-    } else {
-        // Set already contains items in sorted order, so we simply copy the items
-        // from the set to the vector.
-        // Release the memory for the set after the copy.
-        vector<SortableDataItem> newData(_dataSet->begin(), _dataSet->end());
-        _data.swap(newData);
-        _dataSet.reset();
-    }
-}
-
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
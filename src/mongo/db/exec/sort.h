@@ -28,7 +28,7 @@
 
 #pragma once
 
-#include <set>
+#include <memory>
 #include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
@@ -37,6 +37,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/index_bounds.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/platform/unordered_map.h"
 
 namespace mongo {
@@ -56,11 +57,21 @@ public:
 
     // Equal to 0 for no limit.
     size_t limit;
+
+    // Whether results may be spilled to disk once they no longer fit in memory, rather than failing
+    // the query.
+    bool allowDiskUse = false;
 };
 
 /**
  * Sorts the input received from the child according to the sort pattern provided.
  *
+ * Results are buffered in a Sorter, which keeps only the best 'limit' results when there is a
+ * limit. If more than internalQueryExecMaxBlockingSortBytes are buffered, the stage fails, unless
+ * disk use is allowed, in which case the Sorter spills sorted runs to files and merges them.
+ * Results that have not been fetched are buffered as their index keys and returned unfetched, so
+ * that a FETCH above the sort only reads the documents that survive it.
+ *
  * Preconditions:
  *   -- For each field in 'pattern', all inputs in the child must handle a getFieldDotted for that
  *   field.
@@ -89,7 +100,78 @@ public:
 
     static const char* kStageType;
 
+    /**
+     * Everything from a buffered WorkingSetMember that has to survive the sort, held in a form the
+     * Sorter can spill to disk.
+     */
+    class BufferedMember {
+    public:
+        BufferedMember() = default;
+
+        /**
+         * Copies the document from 'member' along with its RecordId and any computed data other
+         * than the sort key. A member that has not been fetched has its index key data copied
+         * instead of a document.
+         */
+        BufferedMember(const WorkingSetMember& member, long long readOrder);
+
+        /**
+         * Fills the freshly allocated 'member' in 'ws' from this buffered result, attaching
+         * 'sortKey' as its sort key. The RecordId is left out if 'dropRecordId' is true, which
+         * requires a document.
+         */
+        void restoreTo(WorkingSet* ws, WorkingSetID id, const BSONObj& sortKey, bool dropRecordId);
+
+        const RecordId& recordId() const {
+            return _recordId;
+        }
+
+        /**
+         * False if this result was buffered as index key data.
+         */
+        bool hasObj() const {
+            return _keyData.empty();
+        }
+
+        /**
+         * Replaces the index key data of a result that was not fetched with the document 'obj'.
+         */
+        void setObj(BSONObj obj);
+
+        long long readOrder() const {
+            return _readOrder;
+        }
+
+        // Members for Sorter.
+        struct SorterDeserializeSettings {};
+        void serializeForSorter(BufBuilder& buf) const;
+        static BufferedMember deserializeForSorter(BufReader& buf,
+                                                   const SorterDeserializeSettings&);
+        int memUsageForSorter() const;
+        BufferedMember getOwned() const;
+
+    private:
+        BSONObj _obj;
+        uint64_t _snapshotId = 0;
+        RecordId _recordId;
+
+        // The number of results read from the child before this one.
+        long long _readOrder = 0;
+
+        boost::optional<double> _textScore;
+        boost::optional<double> _geoDistance;
+        BSONObj _geoNearPoint;
+        BSONObj _indexKey;
+
+        // The index keys of a result that was not fetched, in which case '_obj' is empty.
+        IndexKeyDatumVector _keyData;
+    };
+
 private:
+    using BufferSorter = Sorter<BSONObj, BufferedMember>;
+
+    SortOptions makeSortOptions() const;
+
     //
     // Query Stage
     //
@@ -106,78 +188,41 @@ private:
     // Equal to 0 for no limit.
     size_t _limit;
 
+    bool _allowDiskUse;
+
     //
     // Data storage
     //
 
     // Have we sorted our data? If so, we can access _resultIterator. If not,
-    // we're still populating _data.
+    // we're still populating _sorter.
     bool _sorted;
 
-    // Collection of working set members to sort with their respective sort key.
-    struct SortableDataItem {
-        WorkingSetID wsid;
-        BSONObj sortKey;
-        // Since we must replicate the behavior of a covered sort as much as possible we use the
-        // RecordId to break sortKey ties.
-        // See sorta.js.
-        RecordId recordId;
-    };
-
-    // Comparison object for data buffers (vector and set). Items are compared on (sortKey, loc).
-    // This is also how the items are ordered in the indices. Keys are compared using
-    // BSONObj::woCompare() with RecordId as a tie-breaker.
+    // Buffers results read from the child and keeps them ordered by (sort key, RecordId).
     //
     // We are comparing keys generated by the SortKeyGenerator, which are already ordered with
     // respect the collation. Therefore, we explicitly avoid comparing using a collator here.
-    struct WorkingSetComparator {
-        explicit WorkingSetComparator(BSONObj p);
+    std::unique_ptr<BufferSorter> _sorter;
 
-        bool operator()(const SortableDataItem& lhs, const SortableDataItem& rhs) const;
+    // Iterates through the sorted results once all of them have been read from the child.
+    std::unique_ptr<BufferSorter::Iterator> _resultIterator;
 
-        BSONObj pattern;
-    };
+    // The number of results read from the child so far.
+    long long _numRead;
 
-    /**
-     * Inserts one item into data buffer (vector or set).
-     * If limit is exceeded, remove item with lowest key.
-     */
-    void addToBuffer(const SortableDataItem& item);
+    // Buffered results don't keep a WorkingSetMember, so for every invalidated RecordId this holds
+    // the number of results that had been read when it was invalidated. Results with that RecordId
+    // read before then are returned as owned objects without their RecordId, just as though they
+    // had been fetched at the time of the invalidation.
+    typedef unordered_map<RecordId, long long, RecordId::Hasher> InvalidationMap;
+    InvalidationMap _invalidations;
 
-    /**
-     * Sorts data buffer.
-     * Assumes no more items will be added to buffer.
-     * If data is stored in set, copy set
-     * contents to vector and clear set.
-     */
-    void sortBuffer();
-
-    // Comparator for data buffer
-    // Initialization follows sort key generator
-    std::unique_ptr<WorkingSetComparator> _sortKeyComparator;
-
-    // The data we buffer and sort.
-    // _data will contain sorted data when all data is gathered
-    // and sorted.
-    // When _limit is greater than 1 and not all data has been gathered from child stage,
-    // _dataSet is used instead to maintain an ordered set of the incomplete data set.
-    // When the data set is complete, we copy the items from _dataSet to _data which will
-    // be used to provide the results of this stage through _resultIterator.
-    std::vector<SortableDataItem> _data;
-    typedef std::set<SortableDataItem, WorkingSetComparator> SortableDataItemSet;
-    std::unique_ptr<SortableDataItemSet> _dataSet;
-
-    // Iterates through _data post-sort returning it.
-    std::vector<SortableDataItem>::iterator _resultIterator;
-
-    // We buffer a lot of data and we want to look it up by RecordId quickly upon invalidation.
-    typedef unordered_map<RecordId, WorkingSetID, RecordId::Hasher> DataMap;
-    DataMap _wsidByRecordId;
+    // True once a result that has not been fetched has been buffered. Such results have no copy of
+    // their document, so the document of every invalidated RecordId is kept here instead.
+    bool _bufferedUnfetched = false;
+    unordered_map<RecordId, BSONObj, RecordId::Hasher> _invalidatedDocs;
 
     SortStats _specificStats;
-
-    // The usage in bytes of all buffered data that we're sorting.
-    size_t _memUsage;
 };
 
 }  // namespace mongo
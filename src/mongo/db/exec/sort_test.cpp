@@ -39,11 +39,15 @@
 #include "mongo/db/operation_context_noop.h"
 #include "mongo/db/query/collation/collator_factory_mock.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_noop.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/clock_source_mock.h"
+#include "mongo/util/scopeguard.h"
 
 using namespace mongo;
 
@@ -154,6 +158,54 @@ public:
         }
     }
 
+    /**
+     * Sorts 'count' documents of the form {a: <n>}, with the values of 'a' shuffled, and checks
+     * that they come out in ascending order. Returns the final state of the sort stage.
+     */
+    PlanStage::StageState sortShuffledDocs(int count,
+                                           size_t limit,
+                                           bool allowDiskUse,
+                                           SortStats* statsOut) {
+        WorkingSet ws;
+        auto queuedDataStage = stdx::make_unique<QueuedDataStage>(getOpCtx(), &ws);
+        for (int i = 0; i < count; ++i) {
+            WorkingSetID id = ws.allocate();
+            WorkingSetMember* wsm = ws.get(id);
+            // 7919 is prime, so this visits every value in [0, count) for the counts used here.
+            wsm->obj = Snapshotted<BSONObj>(
+                SnapshotId(), BSON("a" << (i * 7919) % count << "pad" << std::string(100, 'x')));
+            wsm->transitionToOwnedObj();
+            queuedDataStage->pushBack(id);
+        }
+
+        SortStageParams params;
+        params.pattern = BSON("a" << 1);
+        params.limit = limit;
+        params.allowDiskUse = allowDiskUse;
+
+        auto sortKeyGen = stdx::make_unique<SortKeyGeneratorStage>(
+            getOpCtx(), queuedDataStage.release(), &ws, params.pattern, nullptr);
+        SortStage sort(getOpCtx(), params, &ws, sortKeyGen.release());
+
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        PlanStage::StageState state = PlanStage::NEED_TIME;
+        int expected = 0;
+        while (state == PlanStage::NEED_TIME || state == PlanStage::ADVANCED) {
+            state = sort.work(&id);
+            if (state == PlanStage::ADVANCED) {
+                ASSERT_EQ(expected, ws.get(id)->obj.value()["a"].numberInt());
+                ++expected;
+                ws.free(id);
+            }
+        }
+
+        if (state == PlanStage::IS_EOF) {
+            ASSERT_EQ(limit ? std::min(static_cast<int>(limit), count) : count, expected);
+        }
+        *statsOut = *static_cast<const SortStats*>(sort.getSpecificStats());
+        return state;
+    }
+
 private:
     OperationContext* _opCtx;
 
@@ -300,4 +352,62 @@ TEST_F(SortStageTest, SortDescendingWithCollation) {
              "{input: [{a: 'ba'}, {a: 'aa'}, {a: 'ab'}]}",
              "{output: [{a: 'ab'}, {a: 'ba'}, {a: 'aa'}]}");
 }
+
+//
+// Sorting more data than fits in memory
+//
+
+class SortStageSpillTest : public SortStageTest {
+public:
+    SortStageSpillTest()
+        : _tempDir("sort_stage_test"),
+          _originalDbPath(storageGlobalParams.dbpath),
+          _originalMaxBytes(internalQueryExecMaxBlockingSortBytes.load()) {
+        storageGlobalParams.dbpath = _tempDir.path();
+        internalQueryExecMaxBlockingSortBytes.store(16 * 1024);
+    }
+
+    ~SortStageSpillTest() {
+        storageGlobalParams.dbpath = _originalDbPath;
+        internalQueryExecMaxBlockingSortBytes.store(_originalMaxBytes);
+    }
+
+private:
+    unittest::TempDir _tempDir;
+    const std::string _originalDbPath;
+    const int _originalMaxBytes;
+};
+
+TEST_F(SortStageSpillTest, FailsWhenOverMemoryLimitWithoutDiskUse) {
+    SortStats stats;
+    ASSERT_EQ(PlanStage::FAILURE, sortShuffledDocs(1000, 0, false, &stats));
+    ASSERT_FALSE(stats.usedDisk);
+}
+
+TEST_F(SortStageSpillTest, SpillsWhenOverMemoryLimitWithDiskUse) {
+    SortStats stats;
+    ASSERT_EQ(PlanStage::IS_EOF, sortShuffledDocs(1000, 0, true, &stats));
+    ASSERT_TRUE(stats.usedDisk);
+}
+
+TEST_F(SortStageSpillTest, SpillsWhenAllowedByServerParameter) {
+    internalQueryExecAllowDiskUseForBlockingSort.store(true);
+    ON_BLOCK_EXIT([] { internalQueryExecAllowDiskUseForBlockingSort.store(false); });
+
+    SortStats stats;
+    ASSERT_EQ(PlanStage::IS_EOF, sortShuffledDocs(1000, 0, false, &stats));
+    ASSERT_TRUE(stats.usedDisk);
+}
+
+TEST_F(SortStageSpillTest, SmallLimitStaysInMemory) {
+    SortStats stats;
+    ASSERT_EQ(PlanStage::IS_EOF, sortShuffledDocs(1000, 10, false, &stats));
+    ASSERT_FALSE(stats.usedDisk);
+}
+
+TEST_F(SortStageSpillTest, LargeLimitSpillsWithDiskUse) {
+    SortStats stats;
+    ASSERT_EQ(PlanStage::IS_EOF, sortShuffledDocs(1000, 500, true, &stats));
+    ASSERT_TRUE(stats.usedDisk);
+}
 }  // namespace
@@ -113,6 +113,17 @@ unique_ptr<PlanStage> TextStage::buildTextTree(OperationContext* opCtx,
         textScorer->addChild(make_unique<IndexScan>(opCtx, ixparams, ws, nullptr));
     }
 
+    // The text match stage drops documents for their phrases, negated terms and case or diacritic
+    // mismatches after they have been scored, so the scorer may only stop early without them.
+    const auto& query = _params.query;
+    if (_params.topK && query.getNegatedTerms().empty() && query.getPositivePhr().empty() &&
+        query.getNegatedPhr().empty() && !query.getCaseSensitive() &&
+        !query.getDiacriticSensitive() &&
+        query.getTermsForBounds().size() <= TextOrStage::kMaxTopKTerms) {
+        textScorer->setTopK(_params.topK,
+                            {query.getTermsForBounds().begin(), query.getTermsForBounds().end()});
+    }
+
     auto matcher =
         make_unique<TextMatchStage>(opCtx, std::move(textScorer), _params.query, _params.spec, ws);
 
@@ -63,6 +63,9 @@ struct TextStageParams {
 
     // The text query.
     FTSQueryImpl query;
+
+    // If non-zero, only the 'topK' best scoring documents are needed.
+    size_t topK = 0;
 };
 
 /**
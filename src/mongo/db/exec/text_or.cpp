@@ -28,6 +28,8 @@
 
 #include "mongo/db/exec/text_or.h"
 
+#include <algorithm>
+#include <limits>
 #include <map>
 #include <vector>
 
@@ -73,6 +75,16 @@ void TextOrStage::addChild(unique_ptr<PlanStage> child) {
     _children.push_back(std::move(child));
 }
 
+void TextOrStage::setTopK(size_t topK, std::vector<std::string> terms) {
+    invariant(terms.size() == _children.size());
+    invariant(terms.size() <= kMaxTopKTerms);
+    _topK = topK;
+    _terms = std::move(terms);
+    _termScoreBounds.assign(_children.size(), std::numeric_limits<double>::infinity());
+    _childDone.assign(_children.size(), false);
+    _specificStats.topK = topK;
+}
+
 bool TextOrStage::isEOF() {
     return _internalState == State::kDone;
 }
@@ -106,6 +118,7 @@ void TextOrStage::doInvalidate(OperationContext* opCtx, const RecordId& dl, Inva
         if (scoreIt == _scoreIterator) {
             _scoreIterator++;
         }
+        _topScores.erase({scoreIt->second.score, dl});
         _scores.erase(scoreIt);
     }
 }
@@ -192,7 +205,27 @@ PlanStage::StageState TextOrStage::readFromChildren(WorkingSetID* out) {
     }
 
     if (PlanStage::ADVANCED == childState) {
-        return addTerm(id, out);
+        auto state = addTerm(id, out);
+        if (_topK && _idRetrying == WorkingSet::INVALID_ID) {
+            if (canStopReading()) {
+                _scoreIterator = _scores.begin();
+                _internalState = State::kReturningResults;
+            } else {
+                advanceToNextChild();
+            }
+        }
+        return state;
+    } else if (PlanStage::IS_EOF == childState && _topK) {
+        _childDone[_currentChild] = true;
+        _termScoreBounds[_currentChild] = 0;
+        if (std::find(_childDone.begin(), _childDone.end(), false) != _childDone.end()) {
+            advanceToNextChild();
+            return PlanStage::NEED_TIME;
+        }
+
+        _scoreIterator = _scores.begin();
+        _internalState = State::kReturningResults;
+        return PlanStage::NEED_TIME;
     } else if (PlanStage::IS_EOF == childState) {
         // Done with this child.
         ++_currentChild;
@@ -227,6 +260,82 @@ PlanStage::StageState TextOrStage::readFromChildren(WorkingSetID* out) {
     }
 }
 
+void TextOrStage::advanceToNextChild() {
+    do {
+        _currentChild = (_currentChild + 1) % _children.size();
+    } while (_childDone[_currentChild]);
+}
+
+bool TextOrStage::canStopReading() {
+    if (_topScores.size() < _topK) {
+        return false;
+    }
+    const double lowestTopScore = _topScores.begin()->first;
+
+    if (!_rejectUnseen) {
+        double unseenScoreBound = 0;
+        for (double bound : _termScoreBounds) {
+            unseenScoreBound += bound;
+        }
+        if (lowestTopScore < unseenScoreBound) {
+            return false;
+        }
+        // The bounds only decrease and the lowest best score only increases, so this holds from
+        // now on.
+        _rejectUnseen = true;
+    }
+
+    // Looking through the documents seen so far is linear, so only do it once per round of reads.
+    if (_readsUntilSweep > 0) {
+        --_readsUntilSweep;
+        return false;
+    }
+    _readsUntilSweep = _children.size();
+
+    bool canStop = true;
+    for (auto&& scoreEntry : _scores) {
+        TextRecordData& textRecordData = scoreEntry.second;
+        if (textRecordData.score < 0 ||
+            _topScores.count({textRecordData.score, scoreEntry.first})) {
+            continue;
+        }
+
+        double scoreBound = textRecordData.score;
+        for (size_t i = 0; i < _children.size(); ++i) {
+            if (!(textRecordData.termsSeen & (uint64_t{1} << i))) {
+                scoreBound += _termScoreBounds[i];
+            }
+        }
+
+        if (scoreBound > lowestTopScore) {
+            canStop = false;
+        } else {
+            _ws->free(textRecordData.wsid);
+            textRecordData.wsid = WorkingSet::INVALID_ID;
+            textRecordData.score = -1;
+        }
+    }
+    return canStop;
+}
+
+void TextOrStage::addTopKTerm(const RecordId& recordId, double termScore) {
+    TextRecordData& textRecordData = _scores[recordId];
+    const uint64_t termBit = uint64_t{1} << _currentChild;
+    if (textRecordData.termsSeen & termBit) {
+        return;
+    }
+    textRecordData.termsSeen |= termBit;
+
+    _topScores.erase({textRecordData.score, recordId});
+    textRecordData.score += termScore;
+    _topScores.emplace(textRecordData.score, recordId);
+
+    // A document dropping out of the best ones may still make it back in with its other terms.
+    if (_topScores.size() > _topK) {
+        _topScores.erase(_topScores.begin());
+    }
+}
+
 PlanStage::StageState TextOrStage::returnResults(WorkingSetID* out) {
     if (_scoreIterator == _scores.end()) {
         _internalState = State::kDone;
@@ -234,23 +343,69 @@ PlanStage::StageState TextOrStage::returnResults(WorkingSetID* out) {
     }
 
     // Retrieve the record that contains the text score.
-    TextRecordData textRecordData = _scoreIterator->second;
-    ++_scoreIterator;
+    const RecordId recordId = _scoreIterator->first;
+    TextRecordData& textRecordData = _scoreIterator->second;
 
     // Ignore non-matched documents.
     if (textRecordData.score < 0) {
         invariant(textRecordData.wsid == WorkingSet::INVALID_ID);
+        ++_scoreIterator;
         return PlanStage::NEED_TIME;
     }
 
+    double score = textRecordData.score;
     WorkingSetMember* wsm = _ws->get(textRecordData.wsid);
 
+    if (_topK) {
+        // Drop the documents which did not make it into the best ones, and fetch those which did.
+        bool shouldKeep = _topScores.count({score, recordId});
+        if (shouldKeep && !wsm->hasObj()) {
+            try {
+                shouldKeep = WorkingSetCommon::fetch(
+                    getOpCtx(), _ws, textRecordData.wsid, _recordCursor);
+                ++_specificStats.fetches;
+            } catch (const WriteConflictException&) {
+                *out = WorkingSet::INVALID_ID;
+                return PlanStage::NEED_YIELD;
+            }
+        }
+
+        if (!shouldKeep) {
+            _ws->free(textRecordData.wsid);
+            textRecordData.wsid = WorkingSet::INVALID_ID;
+            textRecordData.score = -1;
+            ++_scoreIterator;
+            return PlanStage::NEED_TIME;
+        }
+
+        // We may have stopped reading before seeing all of this document's terms.
+        const uint64_t allTerms = (uint64_t{1} << (_children.size() - 1) << 1) - 1;
+        if (textRecordData.termsSeen != allTerms) {
+            score = scoreFetchedDocument(wsm->obj.value());
+        }
+    }
+    ++_scoreIterator;
+
     // Populate the working set member with the text score and return it.
-    wsm->addComputed(new TextScoreComputedData(textRecordData.score));
+    wsm->addComputed(new TextScoreComputedData(score));
     *out = textRecordData.wsid;
     return PlanStage::ADVANCED;
 }
 
+double TextOrStage::scoreFetchedDocument(const BSONObj& obj) const {
+    fts::TermFrequencyMap termFrequencies;
+    _ftsSpec.scoreDocument(obj, &termFrequencies);
+
+    double score = 0;
+    for (auto&& term : _terms) {
+        auto it = termFrequencies.find(term);
+        if (it != termFrequencies.end()) {
+            score += it->second;
+        }
+    }
+    return score;
+}
+
 /**
  * Provides support for covered matching on non-text fields of a compound text index.
  */
@@ -331,7 +486,23 @@ PlanStage::StageState TextOrStage::addTerm(WorkingSetID wsid, WorkingSetID* out)
     invariant(wsm->getState() == WorkingSetMember::RID_AND_IDX);
     invariant(1 == wsm->keyData.size());
     const IndexKeyDatum newKeyData = wsm->keyData.back();  // copy to keep it around.
-    TextRecordData* textRecordData = &_scores[wsm->recordId];
+    const RecordId recordId = wsm->recordId;
+    TextRecordData* textRecordData = &_scores[recordId];
+
+    // Locate score within possibly compound key: {prefix,term,score,suffix}.
+    BSONObjIterator keyIt(newKeyData.keyData);
+    for (unsigned i = 0; i < _ftsSpec.numExtraBefore(); i++) {
+        keyIt.next();
+    }
+
+    keyIt.next();  // Skip past 'term'.
+
+    BSONElement scoreElement = keyIt.next();
+    double documentTermScore = scoreElement.number();
+
+    if (_topK) {
+        _termScoreBounds[_currentChild] = documentTermScore;
+    }
 
     if (textRecordData->score < 0) {
         // We have already rejected this document for not matching the filter.
@@ -343,6 +514,13 @@ PlanStage::StageState TextOrStage::addTerm(WorkingSetID wsid, WorkingSetID* out)
     if (WorkingSet::INVALID_ID == textRecordData->wsid) {
         // We haven't seen this RecordId before.
         invariant(textRecordData->score == 0);
+        if (_topK && _rejectUnseen) {
+            // It cannot rank among the best documents anymore.
+            _ws->free(wsid);
+            textRecordData->score = -1;
+            return NEED_TIME;
+        }
+
         bool shouldKeep = true;
         if (_filter) {
             // We have not seen this document before and need to apply a filter.
@@ -374,9 +552,9 @@ PlanStage::StageState TextOrStage::addTerm(WorkingSetID wsid, WorkingSetID* out)
             }
         }
 
-        if (shouldKeep && !wsm->hasObj()) {
+        if (shouldKeep && !_topK && !wsm->hasObj()) {
             // Our parent expects RID_AND_OBJ members, so we fetch the document here if we haven't
-            // already.
+            // already. When reading only the best documents, that waits until we know them.
             try {
                 shouldKeep = WorkingSetCommon::fetch(getOpCtx(), _ws, wsid, _recordCursor);
                 ++_specificStats.fetches;
@@ -408,18 +586,11 @@ PlanStage::StageState TextOrStage::addTerm(WorkingSetID wsid, WorkingSetID* out)
         wsm = _ws->get(textRecordData->wsid);
     }
 
-    // Locate score within possibly compound key: {prefix,term,score,suffix}.
-    BSONObjIterator keyIt(newKeyData.keyData);
-    for (unsigned i = 0; i < _ftsSpec.numExtraBefore(); i++) {
-        keyIt.next();
-    }
-
-    keyIt.next();  // Skip past 'term'.
-
-    BSONElement scoreElement = keyIt.next();
-    double documentTermScore = scoreElement.number();
-
     // Aggregate relevance score, term keys.
+    if (_topK) {
+        addTopKTerm(recordId, documentTermScore);
+        return NEED_TIME;
+    }
     textRecordData->score += documentTermScore;
     return NEED_TIME;
 }
@@ -28,7 +28,10 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <set>
+#include <string>
 #include <vector>
 
 #include "mongo/db/catalog/collection.h"
@@ -51,6 +54,12 @@ class OperationContext;
  * A blocking stage that returns the set of WSMs with RecordIDs of all of the documents that contain
  * the positive terms in the search query, as well as their scores.
  *
+ * When only the best scoring documents are needed (see setTopK()), the stage reads its children
+ * round-robin and keeps a partial score per document from the keys seen so far. Since each child
+ * returns the keys of its term in decreasing score order, the score of the last key a child
+ * returned bounds what any document can still get for that term. The stage stops reading once no
+ * document outside the best ones can overtake them, and only then fetches the winners.
+ *
  * The WorkingSetMembers returned are fetched and in the LOC_AND_OBJ state.
  */
 class TextOrStage final : public PlanStage {
@@ -81,6 +90,16 @@ public:
 
     void addChild(unique_ptr<PlanStage> child);
 
+    // The most children setTopK() supports, as each document tracks the terms it was seen for in a
+    // bitmask.
+    static const size_t kMaxTopKTerms = 64;
+
+    /**
+     * Only returns the 'topK' best scoring documents. 'terms' are the terms of the children, in the
+     * order they were added.
+     */
+    void setTopK(size_t topK, std::vector<std::string> terms);
+
     bool isEOF() final;
 
     StageState doWork(WorkingSetID* out) final;
@@ -125,6 +144,22 @@ private:
      */
     StageState returnResults(WorkingSetID* out);
 
+    /**
+     * Helpers for reading only the best scoring documents. advanceToNextChild() moves on to the
+     * next child which has keys left, round-robin. addTopKTerm() adds the score of the current
+     * child's term to a document and updates the best documents. canStopReading() tells whether no
+     * other document can rank among them anymore, dropping the documents which cannot on the way.
+     */
+    void advanceToNextChild();
+    void addTopKTerm(const RecordId& recordId, double termScore);
+    bool canStopReading();
+
+    /**
+     * Returns the score of the fetched document 'obj' for the query terms, when reading only the
+     * best scoring documents stopped before seeing all of its keys.
+     */
+    double scoreFetchedDocument(const BSONObj& obj) const;
+
     // The index spec used to determine where to find the score.
     FTSSpec _ftsSpec;
 
@@ -146,11 +181,32 @@ private:
         TextRecordData() : wsid(WorkingSet::INVALID_ID), score(0.0) {}
         WorkingSetID wsid;
         double score;
+
+        // When reading only the best scoring documents, the children this document was seen by.
+        uint64_t termsSeen = 0;
     };
 
     typedef unordered_map<RecordId, TextRecordData, RecordId::Hasher> ScoreMap;
     ScoreMap _scores;
-    ScoreMap::const_iterator _scoreIterator;
+    ScoreMap::iterator _scoreIterator;
+
+    // If non-zero, only this many best scoring documents are returned. _topScores holds the partial
+    // scores of the best documents so far. Documents which can no longer rank among them stay in
+    // _scores with a negative score so that they are ignored if seen again.
+    size_t _topK = 0;
+    std::vector<std::string> _terms;
+    std::set<std::pair<double, RecordId>> _topScores;
+
+    // For each child, the score of the last key it returned, which bounds the scores of the keys it
+    // has left.
+    std::vector<double> _termScoreBounds;
+    std::vector<bool> _childDone;
+
+    // Set once no document we have not seen yet can rank among the best ones.
+    bool _rejectUnseen = false;
+
+    // Keys left to read before canStopReading() looks through the documents seen so far again.
+    size_t _readsUntilSweep = 0;
 
     TextOrStats _specificStats;
 
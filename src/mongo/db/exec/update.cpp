@@ -43,11 +43,16 @@
 #include "mongo/db/op_observer.h"
 #include "mongo/db/ops/update_lifecycle.h"
 #include "mongo/db/query/explain.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/s/collection_metadata.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/metadata_manager.h"
+#include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/update/document_diff.h"
+#include "mongo/db/update/log_builder.h"
 #include "mongo/db/update/storage_validation.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
@@ -63,6 +68,11 @@ using stdx::make_unique;
 
 namespace mb = mutablebson;
 
+// Modifier-style updates whose oplog entry is at least this many bytes are logged as a document
+// diff instead, when the diff is smaller. Every member of the replica set must be able to apply
+// "$v: 2" oplog entries before this is enabled. 0 disables diffs.
+MONGO_EXPORT_SERVER_PARAMETER(oplogDeltaUpdateMinBytes, int, 0);
+
 namespace {
 
 const char idFieldName[] = "_id";
@@ -96,6 +106,33 @@ void addObjectIDIdField(mb::Document* doc) {
     uassertStatusOK(doc->root().pushFront(idElem));
 }
 
+/**
+ * Returns a "$v: 2" oplog update entry turning 'oldObj' into 'newObj', if it is smaller than
+ * 'logObj', or else 'logObj'.
+ */
+BSONObj makeDeltaLogObjIfSmaller(const BSONObj& oldObj,
+                                 const BSONObj& newObj,
+                                 const BSONObj& logObj) {
+    // Leave room for the "$v" and "diff" fields around the diff.
+    const int kOverhead = 32;
+    const int minBytes = oplogDeltaUpdateMinBytes.load();
+    if (minBytes <= 0 || logObj.objsize() < std::max(minBytes, kOverhead) ||
+        *logObj.firstElementFieldName() != '$' ||
+        serverGlobalParams.featureCompatibility.version.load() ==
+            ServerGlobalParams::FeatureCompatibility::Version::k34) {
+        return logObj;
+    }
+
+    auto diff = doc_diff::computeDiff(oldObj, newObj, logObj.objsize() - kOverhead);
+    if (!diff) {
+        return logObj;
+    }
+    return BSON(LogBuilder::kUpdateSemanticsFieldName
+                << static_cast<int>(UpdateSemantics::kDelta)
+                << doc_diff::kOplogDiffFieldName
+                << *diff);
+}
+
 /**
  * Uasserts if any of the paths in 'immutablePaths' are not present in 'document', or if they are
  * arrays or array descendants.
@@ -172,6 +209,10 @@ UpdateStage::UpdateStage(OperationContext* opCtx,
       _collection(collection),
       _idRetrying(WorkingSet::INVALID_ID),
       _idReturning(WorkingSet::INVALID_ID),
+      _batchSize(params.request->isMulti() && !params.request->shouldReturnAnyDocs() &&
+                         !params.request->isExplain() && supportsDocLocking()
+                     ? std::max(1, internalQueryExecUpdateBatchSize.load())
+                     : 1),
       _updatedRecordIds(params.request->isMulti() ? new RecordIdSet() : NULL),
       _doc(params.driver->getDocument()) {
     _children.emplace_back(child);
@@ -332,6 +373,9 @@ BSONObj UpdateStage::transformAndUpdate(const Snapshotted<BSONObj>& oldObj, Reco
                     newObj.objsize() <= BSONObjMaxUserSize);
 
             if (!request->isExplain()) {
+                if (driver->logOp()) {
+                    args.update = makeDeltaLogObjIfSmaller(oldObj.value(), newObj, logObj);
+                }
                 newRecordId = _collection->updateDocument(getOpCtx(),
                                                           recordId,
                                                           oldObj,
@@ -490,8 +534,10 @@ void UpdateStage::doInsert() {
 
 bool UpdateStage::doneUpdating() {
     // We're done updating if either the child has no more results to give us, or we've
-    // already gotten a result back and we're not a multi-update.
+    // already gotten a result back and we're not a multi-update. Staged documents of a batched
+    // multi-update still have to be updated.
     return _idRetrying == WorkingSet::INVALID_ID && _idReturning == WorkingSet::INVALID_ID &&
+        _stagedIds.empty() &&
         (child()->isEOF() || (_specificStats.nMatched > 0 && !_params.request->isMulti()));
 }
 
@@ -561,6 +607,11 @@ PlanStage::StageState UpdateStage::doWork(WorkingSetID* out) {
         return PlanStage::ADVANCED;
     }
 
+    // Update the staged documents once there are enough of them or no more to come.
+    if (!_stagedIds.empty() && (_stagedIds.size() >= _batchSize || child()->isEOF())) {
+        return updateStagedDocuments(out);
+    }
+
     // Either retry the last WSM we worked on or get a new one from our child.
     WorkingSetID id;
     StageState status;
@@ -601,6 +652,14 @@ PlanStage::StageState UpdateStage::doWork(WorkingSetID* out) {
             return PlanStage::NEED_TIME;
         }
 
+        if (_batchSize > 1) {
+            // The document gets checked against the query again when its batch is updated.
+            member->makeObjOwnedIfNeeded();
+            memberFreer.Dismiss();
+            _stagedIds.push_back(id);
+            return PlanStage::NEED_TIME;
+        }
+
         bool docStillMatches;
         try {
             docStillMatches = write_stage_common::ensureStillMatches(
@@ -778,6 +837,63 @@ UpdateResult UpdateStage::makeUpdateResult(const UpdateStats* updateStats) {
                         updateStats->objInserted);
 };
 
+PlanStage::StageState UpdateStage::updateStagedDocuments(WorkingSetID* out) {
+    invariant(_updatedRecordIds);
+
+    // Save state before making changes
+    WorkingSetCommon::prepareForSnapshotChange(_ws);
+    try {
+        child()->saveState();
+    } catch (const WriteConflictException&) {
+        std::terminate();
+    }
+
+    // Nothing of the batch is committed if it fails part way, so its bookkeeping has to be undone.
+    const UpdateStats statsBeforeBatch = _specificStats;
+    auto undoBatch = MakeGuard([&] {
+        _specificStats = statsBeforeBatch;
+        for (auto id : _stagedIds) {
+            _updatedRecordIds->erase(_ws->get(id)->recordId);
+        }
+    });
+
+    try {
+        WriteUnitOfWork wunit(getOpCtx());
+        for (auto id : _stagedIds) {
+            if (!write_stage_common::ensureStillMatches(
+                    _collection, getOpCtx(), _ws, id, _params.canonicalQuery)) {
+                continue;
+            }
+
+            WorkingSetMember* member = _ws->get(id);
+            RecordId recordId = member->recordId;
+            transformAndUpdate(member->obj, recordId);
+            ++_specificStats.nMatched;
+        }
+        wunit.commit();
+    } catch (const WriteConflictException&) {
+        // Keep the staged documents to retry them all after yielding.
+        *out = WorkingSet::INVALID_ID;
+        return NEED_YIELD;
+    }
+    undoBatch.Dismiss();
+
+    for (auto id : _stagedIds) {
+        _ws->free(id);
+    }
+    _stagedIds.clear();
+
+    // As restoreState may restore (recreate) cursors, make sure to restore the
+    // state outside of the WritUnitOfWork.
+    try {
+        child()->restoreState();
+    } catch (const WriteConflictException&) {
+        *out = WorkingSet::INVALID_ID;
+        return NEED_YIELD;
+    }
+    return PlanStage::NEED_TIME;
+}
+
 PlanStage::StageState UpdateStage::prepareToRetryWSM(WorkingSetID idToRetry, WorkingSetID* out) {
     _idRetrying = idToRetry;
     *out = WorkingSet::INVALID_ID;
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <vector>
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/exec/plan_stage.h"
@@ -175,6 +176,12 @@ private:
      */
     StageState prepareToRetryWSM(WorkingSetID idToRetry, WorkingSetID* out);
 
+    /**
+     * Updates the documents in '_stagedIds' in a single WriteUnitOfWork. If it throws a
+     * WriteConflictException, rolls the whole batch back and returns NEED_YIELD to try it again.
+     */
+    StageState updateStagedDocuments(WorkingSetID* out);
+
     UpdateStageParams _params;
 
     // Not owned by us.
@@ -189,6 +196,11 @@ private:
     // If not WorkingSet::INVALID_ID, we return this member to our caller.
     WorkingSetID _idReturning;
 
+    // The most documents a multi-update updates in one WriteUnitOfWork, and the documents it has
+    // read from its child but not updated yet when batching.
+    const size_t _batchSize;
+    std::vector<WorkingSetID> _stagedIds;
+
     // Stats
     UpdateStats _specificStats;
 
@@ -44,10 +44,15 @@ WorkingSet::MemberHolder::~MemberHolder() {}
 
 WorkingSet::WorkingSet() : _freeList(INVALID_ID) {}
 
-WorkingSet::~WorkingSet() {
-    for (size_t i = 0; i < _data.size(); i++) {
-        delete _data[i].member;
+WorkingSet::~WorkingSet() {}
+
+WorkingSetMember* WorkingSet::_newMember() {
+    if (_lastSlabUsed == _lastSlabSize) {
+        _lastSlabSize = _slabs.empty() ? 16 : 2 * _lastSlabSize;
+        _slabs.emplace_back(new WorkingSetMember[_lastSlabSize]);
+        _lastSlabUsed = 0;
     }
+    return &_slabs.back()[_lastSlabUsed++];
 }
 
 WorkingSetID WorkingSet::allocate() {
@@ -58,7 +63,7 @@ WorkingSetID WorkingSet::allocate() {
         WorkingSetID id = _data.size();
         _data.resize(_data.size() + 1);
         _data.back().nextFreeOrSelf = id;
-        _data.back().member = new WorkingSetMember();
+        _data.back().member = _newMember();
         return id;
     }
 
@@ -96,14 +101,19 @@ bool WorkingSet::isFlagged(WorkingSetID id) const {
 }
 
 void WorkingSet::clear() {
-    for (size_t i = 0; i < _data.size(); i++) {
-        delete _data[i].member;
-    }
-    _data.clear();
-
-    // Since working set is now empty, the free list pointer should
-    // point to nothing.
+    // Return every member to the state of a newly constructed one, and rebuild the free list so
+    // that it hands out ids in increasing order.
     _freeList = INVALID_ID;
+    for (size_t i = _data.size(); i-- > 0;) {
+        WorkingSetMember* member = _data[i].member;
+        member->clear();
+        member->recordId = RecordId();
+        member->isSuspicious = false;
+        member->_fetcher.reset();
+
+        _data[i].nextFreeOrSelf = _freeList;
+        _freeList = i;
+    }
 
     _flagged.clear();
     _yieldSensitiveIds.clear();
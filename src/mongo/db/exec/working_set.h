@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <boost/container/small_vector.hpp>
+#include <memory>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
@@ -113,7 +115,8 @@ public:
     const unordered_set<WorkingSetID>& getFlagged() const;
 
     /**
-     * Removes and deallocates all members of this working set.
+     * Removes all members of this working set. Their storage is kept for reuse, and ids are handed
+     * out again starting from the lowest.
      */
     void clear();
 
@@ -147,14 +150,25 @@ private:
         // Free list link if freed. Points to self if in use.
         WorkingSetID nextFreeOrSelf;
 
-        // Owning pointer
+        // Points into one of _slabs.
         WorkingSetMember* member;
     };
 
+    /**
+     * Returns an unused member from the last slab, adding a slab if that one is full.
+     */
+    WorkingSetMember* _newMember();
+
     // All WorkingSetIDs are indexes into this, except for INVALID_ID.
     // Elements are added to _freeList rather than removed when freed.
     std::vector<MemberHolder> _data;
 
+    // Members are constructed in slabs of doubling size rather than one at a time. They live
+    // until the WorkingSet is destroyed, being recycled by free() and clear().
+    std::vector<std::unique_ptr<WorkingSetMember[]>> _slabs;
+    size_t _lastSlabSize = 0;
+    size_t _lastSlabUsed = 0;
+
     // Index into _data, forming a linked-list using MemberHolder::nextFreeOrSelf as the next
     // link. INVALID_ID is the list terminator since 0 is a valid index.
     // If _freeList == INVALID_ID, the free list is empty and all elements in _data are in use.
@@ -185,6 +199,11 @@ struct IndexKeyDatum {
     const IndexAccessMethod* index;
 };
 
+/**
+ * Members that carry index keys almost always carry exactly one, so that one is kept inline.
+ */
+using IndexKeyDatumVector = boost::container::small_vector<IndexKeyDatum, 1>;
+
 /**
  * What types of computed data can we have?
  */
@@ -280,7 +299,7 @@ public:
 
     RecordId recordId;
     Snapshotted<BSONObj> obj;
-    std::vector<IndexKeyDatum> keyData;
+    IndexKeyDatumVector keyData;
 
     // True if this WSM has survived a yield in RID_AND_IDX state.
     // TODO consider replacing by tracking SnapshotIds for IndexKeyDatums.
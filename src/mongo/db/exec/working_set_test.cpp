@@ -154,4 +154,35 @@ TEST_F(WorkingSetFixture, getDottedFieldFromIndex) {
     ASSERT_FALSE(member->getFieldDotted("y", &elt));
 }
 
+TEST_F(WorkingSetFixture, clearRecyclesMembers) {
+    // Allocate across several slabs, then check that clear() hands the same ids back out in
+    // increasing order, each in the state of a new member.
+    std::vector<WorkingSetMember*> members{member};
+    member->recordId = RecordId(1);
+    member->isSuspicious = true;
+    member->keyData.push_back(IndexKeyDatum(BSON("a" << 1), BSON("" << 1), nullptr));
+    for (int i = 1; i < 100; i++) {
+        WorkingSetID next = ws->allocate();
+        ASSERT_EQUALS(WorkingSetID(i), next);
+        members.push_back(ws->get(next));
+        ws->transitionToRecordIdAndObj(next);
+        members.back()->obj = {SnapshotId(), BSON("x" << i)};
+    }
+    ws->free(50);
+
+    ws->clear();
+    for (int i = 0; i < 100; i++) {
+        WorkingSetID next = ws->allocate();
+        ASSERT_EQUALS(WorkingSetID(i), next);
+        WorkingSetMember* recycled = ws->get(next);
+        ASSERT_EQUALS(members[i], recycled);
+        ASSERT_EQUALS(WorkingSetMember::INVALID, recycled->getState());
+        ASSERT_FALSE(recycled->hasObj());
+        ASSERT_FALSE(recycled->isSuspicious);
+        ASSERT_TRUE(recycled->keyData.empty());
+        ASSERT_EQUALS(RecordId(), recycled->recordId);
+    }
+    ASSERT_EQUALS(WorkingSetID(100), ws->allocate());
+}
+
 }  // namespace
@@ -107,6 +107,10 @@ public:
      */
     std::tuple<BSONObj, Date_t> collect(Client* client);
 
+    bool empty() const {
+        return _collectors.empty();
+    }
+
 private:
     // collection of collectors
     std::vector<std::unique_ptr<FTDCCollectorInterface>> _collectors;
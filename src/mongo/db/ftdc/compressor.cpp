@@ -117,8 +117,11 @@ StatusWith<std::tuple<ConstDataRange, Date_t>> FTDCCompressor::getCompressedSamp
     // Append reference document - BSON Object
     _uncompressedChunkBuffer.appendBuf(_referenceDoc.objdata(), _referenceDoc.objsize());
 
-    // Append count of metrics - uint32 little endian
-    _uncompressedChunkBuffer.appendNum(static_cast<std::uint32_t>(_metricsCount));
+    const bool deltaOfDelta = _config->deltaOfDelta;
+
+    // Append count of metrics - uint32 little endian, flagged if the deltas are delta encoded
+    _uncompressedChunkBuffer.appendNum(static_cast<std::uint32_t>(_metricsCount) |
+                                       (deltaOfDelta ? kDeltaOfDeltaFlag : 0));
 
     // Append count of samples - uint32 little endian
     _uncompressedChunkBuffer.appendNum(static_cast<std::uint32_t>(_deltaCount));
@@ -143,9 +146,16 @@ StatusWith<std::tuple<ConstDataRange, Date_t>> FTDCCompressor::getCompressedSamp
         // These byte arrays are added to a buffer which is then concatenated with other chunks and
         // compressed with ZLIB.
         for (std::uint32_t i = 0; i < _metricsCount; i++) {
+            std::uint64_t prevDelta = 0;
             for (std::uint32_t j = 0; j < _deltaCount; j++) {
                 std::uint64_t delta = _deltas[getArrayOffset(_maxDeltas, j, i)];
 
+                if (deltaOfDelta) {
+                    const std::uint64_t current = delta;
+                    delta = zigZagEncode(delta - prevDelta);
+                    prevDelta = current;
+                }
+
                 if (delta == 0) {
                     ++zeroesCount;
                     continue;
@@ -56,6 +56,12 @@ namespace mongo {
  * 4. Encodes zeros in Run Length Encoded pairs of <Count, Zero>
  * 5. ZLIB compresses the final processed array
  *
+ * If FTDCConfig::deltaOfDelta is set, step 3 instead stores, for each metric, the zigzag encoded
+ * difference between consecutive deltas. Counters that move at a steady rate then compress to runs
+ * of zeros, which matters at high sampling rates. Such chunks are flagged by setting
+ * kDeltaOfDeltaFlag in the metric count, which readers that do not know the encoding reject as an
+ * implausibly large chunk rather than misinterpret.
+ *
  * NOTE: This compression ignores non-number data, and assumes the non-number data is constant
  * across all documents in the series of documents.
  */
@@ -79,6 +85,11 @@ public:
         kCompressorFull,
     };
 
+    /**
+     * Set in the metrics count of a metric chunk that stores deltas of deltas.
+     */
+    static const std::uint32_t kDeltaOfDeltaFlag = 1U << 31;
+
     explicit FTDCCompressor(const FTDCConfig* config) : _config(config) {}
 
     /**
@@ -143,6 +154,18 @@ public:
         return metric * sampleCount + sample;
     }
 
+    /**
+     * Maps signed values to unsigned ones so that values of small magnitude have small encodings:
+     * 0, -1, 1, -2, ... become 0, 1, 2, 3, ...
+     */
+    static std::uint64_t zigZagEncode(std::uint64_t value) {
+        return (value << 1) ^ static_cast<std::uint64_t>(static_cast<std::int64_t>(value) >> 63);
+    }
+
+    static std::uint64_t zigZagDecode(std::uint64_t value) {
+        return (value >> 1) ^ (~(value & 1) + 1);
+    }
+
 private:
     /**
      * Reset the state
@@ -125,7 +125,9 @@ TEST(FTDCCompressor, TestStrings) {
  */
 class TestTie {
 public:
-    TestTie() : _compressor(&_config) {}
+    explicit TestTie(bool deltaOfDelta = false) : _compressor(&_config) {
+        _config.deltaOfDelta = deltaOfDelta;
+    }
 
     ~TestTie() {
         validate(boost::none);
@@ -497,6 +499,42 @@ TEST(FTDCCompressor, TestFull) {
     }
 }
 
+// Test that chunks storing deltas of deltas round trip, including for decreasing and wrapping
+// values, and that steady counters compress better than with plain deltas.
+TEST(FTDCCompressor, TestDeltaOfDelta) {
+    for (bool deltaOfDelta : {false, true}) {
+        TestTie c(deltaOfDelta);
+
+        const long long samples = FTDCConfig::kMaxSamplesPerArchiveMetricChunkDefault - 1;
+        for (long long i = 0; i != samples; i++) {
+            auto st = c.addSample(BSON("steady" << i * 1000 << "jitter" << i * 1000 + (i % 3)
+                                                << "falling"
+                                                << -i * i
+                                                << "wrapping"
+                                                << (i % 2 ? std::numeric_limits<long long>::max()
+                                                          : std::numeric_limits<long long>::min())
+                                                << "flat"
+                                                << 7));
+            ASSERT_HAS_SPACE(st);
+        }
+    }
+
+    auto compressedSize = [](bool deltaOfDelta) {
+        FTDCConfig config;
+        config.deltaOfDelta = deltaOfDelta;
+        FTDCCompressor c(&config);
+        for (long long i = 0; i != 100; i++) {
+            ASSERT_OK(c.addSample(BSON("a" << i * 123457 << "b" << i * 7654321), Date_t())
+                          .getStatus());
+        }
+        auto swBuf = c.getCompressedSamples();
+        ASSERT_OK(swBuf.getStatus());
+        return std::get<0>(swBuf.getValue()).length();
+    };
+
+    ASSERT_LT(compressedSize(true), compressedSize(false));
+}
+
 template <typename T>
 BSONObj generateSample(std::random_device& rd, T generator, size_t count) {
     BSONObjBuilder builder;
@@ -46,7 +46,9 @@ struct FTDCConfig {
           maxFileSizeBytes(kMaxFileSizeBytesDefault),
           period(kPeriodMillisDefault),
           maxSamplesPerArchiveMetricChunk(kMaxSamplesPerArchiveMetricChunkDefault),
-          maxSamplesPerInterimMetricChunk(kMaxSamplesPerInterimMetricChunkDefault) {}
+          maxSamplesPerInterimMetricChunk(kMaxSamplesPerInterimMetricChunkDefault),
+          burstPeriod(kBurstPeriodMillisDefault),
+          deltaOfDelta(kDeltaOfDeltaDefault) {}
 
     /**
      * True if FTDC is collecting data. False otherwise
@@ -83,6 +85,17 @@ struct FTDCConfig {
      */
     std::uint32_t maxSamplesPerInterimMetricChunk;
 
+    /**
+     * Period at which to run FTDC while a burst of high frequency collection is in progress. See
+     * FTDCController::startBurst.
+     */
+    Milliseconds burstPeriod;
+
+    /**
+     * True if metric chunks store deltas of deltas instead of deltas. See FTDCCompressor.
+     */
+    bool deltaOfDelta;
+
     static const bool kEnabledDefault = true;
 
     static const std::int64_t kPeriodMillisDefault;
@@ -93,6 +106,9 @@ struct FTDCConfig {
 
     static const std::uint32_t kMaxSamplesPerArchiveMetricChunkDefault = 300;
     static const std::uint32_t kMaxSamplesPerInterimMetricChunkDefault = 10;
+
+    static const std::int64_t kBurstPeriodMillisDefault = 100;
+    static const bool kDeltaOfDeltaDefault = false;
 };
 
 }  // namespace mongo
@@ -92,6 +92,31 @@ void FTDCController::setMaxSamplesPerInterimMetricChunk(size_t size) {
     _condvar.notify_one();
 }
 
+void FTDCController::setBurstPeriod(Milliseconds millis) {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    _configTemp.burstPeriod = millis;
+    _condvar.notify_one();
+}
+
+void FTDCController::setDeltaOfDelta(bool deltaOfDelta) {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    _configTemp.deltaOfDelta = deltaOfDelta;
+    _condvar.notify_one();
+}
+
+void FTDCController::startBurst(Milliseconds duration) {
+    const auto end = getGlobalServiceContext()->getPreciseClockSource()->now() + duration;
+
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    if (end > _burstEnd) {
+        if (_burstEnd < end - duration) {
+            log() << "Starting a burst of full-time diagnostic data capture for " << duration;
+        }
+        _burstEnd = end;
+        _condvar.notify_one();
+    }
+}
+
 Status FTDCController::setDirectory(const boost::filesystem::path& path) {
     stdx::lock_guard<stdx::mutex> lock(_mutex);
 
@@ -127,6 +152,15 @@ void FTDCController::addOnRotateCollector(std::unique_ptr<FTDCCollectorInterface
     }
 }
 
+void FTDCController::addBurstCollector(std::unique_ptr<FTDCCollectorInterface> collector) {
+    {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        invariant(_state == State::kNotStarted);
+
+        _burstCollectors.add(std::move(collector));
+    }
+}
+
 BSONObj FTDCController::getMostRecentPeriodicDocument() {
     {
         stdx::lock_guard<stdx::mutex> lock(_mutex);
@@ -194,13 +228,16 @@ void FTDCController::doLoop() {
         Client::initThread("ftdc");
         Client* client = &cc();
 
+        bool inBurst = false;
+
         while (true) {
             // Compute the next interval to run regardless of how we were woken up
             // Skipping an interval due to a race condition with a config signal is harmless.
             auto now = getGlobalServiceContext()->getPreciseClockSource()->now();
 
             // Get next time to run at
-            auto next_time = FTDCUtil::roundTime(now, _config.period);
+            auto next_time =
+                FTDCUtil::roundTime(now, inBurst ? _config.burstPeriod : _config.period);
 
             // Wait for the next run or signal to shutdown
             {
@@ -225,8 +262,12 @@ void FTDCController::doLoop() {
                 // if we hit a timeout on the condvar, we need to do another collection
                 // if we were signalled, then we have a config update only or were asked to stop
                 if (status == stdx::cv_status::no_timeout) {
+                    // A burst may have been requested, so recompute the next time to run at.
+                    inBurst = _burstEnd > now;
                     continue;
                 }
+
+                inBurst = _burstEnd > next_time;
             }
 
             // TODO: consider only running this thread if we are enabled
@@ -241,7 +282,9 @@ void FTDCController::doLoop() {
                     _mgr = uassertStatusOK(std::move(swMgr));
                 }
 
-                auto collectSample = _periodicCollectors.collect(client);
+                const bool useBurstCollectors = inBurst && !_burstCollectors.empty();
+                auto collectSample = useBurstCollectors ? _burstCollectors.collect(client)
+                                                        : _periodicCollectors.collect(client);
 
                 Status s = _mgr->writeSampleAndRotateIfNeeded(
                     client, std::get<0>(collectSample), std::get<1>(collectSample));
@@ -249,7 +292,7 @@ void FTDCController::doLoop() {
                 uassertStatusOK(s);
 
                 // Store a reference to the most recent document from the periodic collectors
-                {
+                if (!useBurstCollectors) {
                     stdx::lock_guard<stdx::mutex> lock(_mutex);
                     _mostRecentPeriodicDocument = std::get<0>(collectSample);
                 }
@@ -98,6 +98,26 @@ public:
      */
     void setMaxSamplesPerInterimMetricChunk(size_t size);
 
+    /**
+     * Set the period for data collection during bursts.
+     */
+    void setBurstPeriod(Milliseconds millis);
+
+    /**
+     * Set whether metric chunks store deltas of deltas.
+     */
+    void setDeltaOfDelta(bool deltaOfDelta);
+
+    /**
+     * Collect from the burst collectors, or the periodic collectors if there are none, at the
+     * burst period for the next 'duration'. Extends a burst already in progress if that would end
+     * sooner.
+     *
+     * Samples taken during a burst are written to the same files as the periodic ones. Switching
+     * between the two sets of collectors starts a new metric chunk.
+     */
+    void startBurst(Milliseconds duration);
+
     /*
      * Set the path to store FTDC files if not already set.
      *
@@ -117,6 +137,12 @@ public:
      */
     void addOnRotateCollector(std::unique_ptr<FTDCCollectorInterface> collector);
 
+    /**
+     * Add a collector to collect during bursts instead of the periodic collectors. These should
+     * be cheap enough to run every few milliseconds.
+     */
+    void addBurstCollector(std::unique_ptr<FTDCCollectorInterface> collector);
+
     /**
      * Start the controller.
      *
@@ -206,6 +232,12 @@ private:
     // Set of file rotation collectors
     FTDCCollectorCollection _rotateCollectors;
 
+    // Set of collectors used during bursts
+    FTDCCollectorCollection _burstCollectors;
+
+    // End of the current burst, in the past if there is none. Protected by _mutex.
+    Date_t _burstEnd;
+
     // File manager that manages file rotation, and logging
     std::unique_ptr<FTDCFileManager> _mgr;
 
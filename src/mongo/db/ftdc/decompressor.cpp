@@ -81,6 +81,8 @@ StatusWith<std::vector<BSONObj>> FTDCDecompressor::uncompress(ConstDataRange buf
     }
 
     std::uint32_t metricsCount = swMetricsCount.getValue();
+    const bool deltaOfDelta = metricsCount & FTDCCompressor::kDeltaOfDeltaFlag;
+    metricsCount &= ~FTDCCompressor::kDeltaOfDeltaFlag;
 
     // Read count of samples
     auto swSampleCount = cdc.readAndAdvance<LittleEndian<std::uint32_t>>();
@@ -157,6 +159,18 @@ StatusWith<std::vector<BSONObj>> FTDCDecompressor::uncompress(ConstDataRange buf
         }
     }
 
+    // Undo the second level of delta encoding, if any
+    if (deltaOfDelta) {
+        for (std::uint32_t i = 0; i < metricsCount; i++) {
+            std::uint64_t prevDelta = 0;
+            for (std::uint32_t j = 0; j < sampleCount; j++) {
+                auto& delta = deltas[FTDCCompressor::getArrayOffset(sampleCount, j, i)];
+                delta = prevDelta + FTDCCompressor::zigZagDecode(delta);
+                prevDelta = delta;
+            }
+        }
+    }
+
     // Inflate the deltas
     for (std::uint32_t i = 0; i < metricsCount; i++) {
         deltas[FTDCCompressor::getArrayOffset(sampleCount, 0, i)] += metrics[i];
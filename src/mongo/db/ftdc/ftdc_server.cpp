@@ -45,6 +45,7 @@
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/stack_sampler.h"
 
 namespace mongo {
 
@@ -241,6 +242,145 @@ public:
     }
 
 } exportedFTDCInterimChunkSizeParameter;
+
+AtomicInt32 localBurstPeriodMillis(FTDCConfig::kBurstPeriodMillisDefault);
+
+class ExportedFTDCBurstPeriodParameter
+    : public ExportedServerParameter<std::int32_t, ServerParameterType::kStartupAndRuntime> {
+public:
+    ExportedFTDCBurstPeriodParameter()
+        : ExportedServerParameter<std::int32_t, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(),
+              "diagnosticDataCollectionBurstPeriodMillis",
+              &localBurstPeriodMillis) {}
+
+    virtual Status validate(const std::int32_t& potentialNewValue) {
+        if (potentialNewValue < 10 || potentialNewValue > 1000) {
+            return Status(ErrorCodes::BadValue,
+                          "diagnosticDataCollectionBurstPeriodMillis must be between 10ms and "
+                          "1000ms");
+        }
+
+        auto controller = getGlobalFTDCController();
+        if (controller) {
+            controller->setBurstPeriod(Milliseconds(potentialNewValue));
+        }
+
+        return Status::OK();
+    }
+
+} exportedFTDCBurstPeriodParameter;
+
+AtomicInt32 localBurstSeconds(10);
+
+class ExportedFTDCBurstSecondsParameter
+    : public ExportedServerParameter<std::int32_t, ServerParameterType::kStartupAndRuntime> {
+public:
+    ExportedFTDCBurstSecondsParameter()
+        : ExportedServerParameter<std::int32_t, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(),
+              "diagnosticDataCollectionBurstSeconds",
+              &localBurstSeconds) {}
+
+    virtual Status validate(const std::int32_t& potentialNewValue) {
+        if (potentialNewValue < 1 || potentialNewValue > 600) {
+            return Status(ErrorCodes::BadValue,
+                          "diagnosticDataCollectionBurstSeconds must be between 1 and 600");
+        }
+
+        return Status::OK();
+    }
+
+} exportedFTDCBurstSecondsParameter;
+
+// Operations slower than this start a burst. Zero disables latency triggered bursts.
+AtomicInt32 localBurstTriggerMillis(0);
+
+class ExportedFTDCBurstTriggerParameter
+    : public ExportedServerParameter<std::int32_t, ServerParameterType::kStartupAndRuntime> {
+public:
+    ExportedFTDCBurstTriggerParameter()
+        : ExportedServerParameter<std::int32_t, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(),
+              "diagnosticDataCollectionBurstTriggerMillis",
+              &localBurstTriggerMillis) {}
+
+    virtual Status validate(const std::int32_t& potentialNewValue) {
+        if (potentialNewValue < 0) {
+            return Status(ErrorCodes::BadValue,
+                          "diagnosticDataCollectionBurstTriggerMillis must be greater than or "
+                          "equal to 0");
+        }
+
+        return Status::OK();
+    }
+
+} exportedFTDCBurstTriggerParameter;
+
+// Setting this to true starts a burst of diagnosticDataCollectionBurstSeconds right away.
+AtomicBool localStartBurst(false);
+
+class ExportedFTDCStartBurstParameter
+    : public ExportedServerParameter<bool, ServerParameterType::kRuntimeOnly> {
+public:
+    ExportedFTDCStartBurstParameter()
+        : ExportedServerParameter<bool, ServerParameterType::kRuntimeOnly>(
+              ServerParameterSet::getGlobal(),
+              "diagnosticDataCollectionStartBurst",
+              &localStartBurst) {}
+
+    virtual Status validate(const bool& potentialNewValue) {
+        auto controller = getGlobalFTDCController();
+        if (potentialNewValue && controller) {
+            controller->startBurst(Seconds(localBurstSeconds.load()));
+        }
+
+        return Status::OK();
+    }
+
+} exportedFTDCStartBurstParameter;
+
+AtomicBool localDeltaOfDelta(FTDCConfig::kDeltaOfDeltaDefault);
+
+class ExportedFTDCDeltaOfDeltaParameter
+    : public ExportedServerParameter<bool, ServerParameterType::kStartupAndRuntime> {
+public:
+    ExportedFTDCDeltaOfDeltaParameter()
+        : ExportedServerParameter<bool, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(),
+              "diagnosticDataCollectionDeltaOfDelta",
+              &localDeltaOfDelta) {}
+
+    virtual Status validate(const bool& potentialNewValue) {
+        auto controller = getGlobalFTDCController();
+        if (controller) {
+            controller->setDeltaOfDelta(potentialNewValue);
+        }
+
+        return Status::OK();
+    }
+
+} exportedFTDCDeltaOfDeltaParameter;
+
+// How often every thread's stack is sampled. Zero disables the stack sampler.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(diagnosticDataCollectionStackSamplesPerSecond, int, 0);
+
+// Distinct folded stacks kept by the stack sampler. Each one is a metric in the FTDC schema.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(diagnosticDataCollectionStackSamplerMaxStacks, int, 200);
+
+/**
+ * Reports the cumulative folded stack counts of the stack sampler.
+ */
+class FTDCStackSamplerCollector final : public FTDCCollectorInterface {
+public:
+    void collect(OperationContext* opCtx, BSONObjBuilder& builder) override {
+        StackSampler::get().report(&builder);
+    }
+
+    std::string name() const override {
+        return "stackSampler";
+    }
+};
 }  // namespace
 
 FTDCSimpleInternalCommandCollector::FTDCSimpleInternalCommandCollector(StringData command,
@@ -278,6 +418,8 @@ void startFTDC(boost::filesystem::path& path,
     config.maxDirectorySizeBytes = localMaxDirectorySizeMB.load() * 1024 * 1024;
     config.maxSamplesPerArchiveMetricChunk = localMaxSamplesPerArchiveMetricChunk.load();
     config.maxSamplesPerInterimMetricChunk = localMaxSamplesPerInterimMetricChunk.load();
+    config.burstPeriod = Milliseconds(localBurstPeriodMillis.load());
+    config.deltaOfDelta = localDeltaOfDelta.load();
 
     auto controller = stdx::make_unique<FTDCController>(path, config);
 
@@ -298,8 +440,31 @@ void startFTDC(boost::filesystem::path& path,
         "",
         BSON("serverStatus" << 1 << "tcMalloc" << true << "sharding" << false)));
 
+    // Burst collectors
+    // These replace the periodic collectors while a burst is in progress, so they only include
+    // the serverStatus sections that help diagnose stalls and are cheap to produce.
+    controller->addBurstCollector(stdx::make_unique<FTDCSimpleInternalCommandCollector>(
+        "serverStatus",
+        "serverStatus",
+        "",
+        BSON("serverStatus" << 1 << "sharding" << false << "metrics" << false << "repl" << false
+                            << "storageEngine"
+                            << false
+                            << "logicalSessionRecordCache"
+                            << false)));
+
     registerCollectors(controller.get());
 
+    // Stack sampler
+    // Every distinct folded stack is a counter, so the schema only changes when a new stack is
+    // first seen and settles once the common stacks of each thread group have been recorded.
+    const int stackSamplesPerSecond = std::min(diagnosticDataCollectionStackSamplesPerSecond, 100);
+    if (stackSamplesPerSecond > 0) {
+        StackSampler::get().start(stackSamplesPerSecond,
+                                  std::max(diagnosticDataCollectionStackSamplerMaxStacks, 1));
+        controller->addPeriodicCollector(stdx::make_unique<FTDCStackSamplerCollector>());
+    }
+
     // Install System Metric Collector as a periodic collector
     installSystemMetricsCollector(controller.get());
 
@@ -326,12 +491,26 @@ void startFTDC(boost::filesystem::path& path,
     staticFTDC->start();
 }
 
+void startFTDCBurstIfSlow(ServiceContext* serviceContext, Milliseconds operationLatency) {
+    const auto trigger = localBurstTriggerMillis.load();
+    if (trigger == 0 || operationLatency < Milliseconds(trigger)) {
+        return;
+    }
+
+    auto controller = getFTDCController(serviceContext).get();
+    if (controller) {
+        controller->startBurst(Seconds(localBurstSeconds.load()));
+    }
+}
+
 void stopFTDC() {
     auto controller = getGlobalFTDCController();
 
     if (controller) {
         controller->stop();
     }
+
+    StackSampler::get().stop();
 }
 
 FTDCController* FTDCController::get(ServiceContext* serviceContext) {
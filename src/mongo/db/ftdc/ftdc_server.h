@@ -71,6 +71,12 @@ void startFTDC(boost::filesystem::path& path,
                FTDCStartMode startupMode,
                RegisterCollectorsFunction registerCollectors);
 
+/**
+ * Start a burst of high frequency data capture if 'operationLatency' exceeds the
+ * diagnosticDataCollectionBurstTriggerMillis setting. Cheap when it does not.
+ */
+void startFTDCBurstIfSlow(ServiceContext* serviceContext, Milliseconds operationLatency);
+
 /**
  * Stop Full Time Data Capture
  *
@@ -0,0 +1,95 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/geo/s2_covering_cache.h"
+
+#include <algorithm>
+
+#include "mongo/db/server_parameters.h"
+
+namespace mongo {
+
+namespace {
+
+// Number of coverings the process-wide cache holds. Zero disables it.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(s2CoveringCacheSize, int, 1000);
+
+}  // namespace
+
+S2CoveringCache::S2CoveringCache(size_t maxEntries) : _maxEntries(maxEntries) {}
+
+S2CoveringCache& S2CoveringCache::get() {
+    static S2CoveringCache cache(std::max(0, s2CoveringCacheSize));
+    return cache;
+}
+
+bool S2CoveringCache::lookup(const std::string& key, std::vector<S2CellId>* covering) {
+    if (_maxEntries == 0) {
+        return false;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        return false;
+    }
+
+    _entries.splice(_entries.begin(), _entries, it->second);
+    *covering = it->second->second;
+    return true;
+}
+
+void S2CoveringCache::add(const std::string& key, const std::vector<S2CellId>& covering) {
+    if (_maxEntries == 0) {
+        return;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _index.find(key);
+    if (it != _index.end()) {
+        it->second->second = covering;
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return;
+    }
+
+    if (_entries.size() >= _maxEntries) {
+        _index.erase(_entries.back().first);
+        _entries.pop_back();
+    }
+    _entries.emplace_front(key, covering);
+    _index.emplace(key, _entries.begin());
+}
+
+size_t S2CoveringCache::size() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _entries.size();
+}
+
+}  // namespace mongo
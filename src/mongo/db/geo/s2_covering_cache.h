@@ -0,0 +1,90 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/stdx/mutex.h"
+#include "third_party/s2/s2cellid.h"
+
+namespace mongo {
+
+/**
+ * A bounded cache of S2 coverings, which are expensive to compute for large regions such as
+ * polygons. Entries are keyed by a string built by the caller, which must capture everything the
+ * covering depends on: the region itself as well as the coverer settings. The least recently used
+ * entry is evicted once the cache is full.
+ *
+ * This class is thread-safe.
+ */
+class S2CoveringCache {
+    MONGO_DISALLOW_COPYING(S2CoveringCache);
+
+public:
+    explicit S2CoveringCache(size_t maxEntries);
+
+    /**
+     * Returns the process-wide cache, sized by the s2CoveringCacheSize startup parameter.
+     */
+    static S2CoveringCache& get();
+
+    /**
+     * Fills 'covering' and returns true if there is an entry for 'key'.
+     */
+    bool lookup(const std::string& key, std::vector<S2CellId>* covering);
+
+    /**
+     * Remembers 'covering' for 'key', replacing any existing entry.
+     */
+    void add(const std::string& key, const std::vector<S2CellId>& covering);
+
+    size_t size() const;
+
+    size_t maxEntries() const {
+        return _maxEntries;
+    }
+
+private:
+    using Entry = std::pair<std::string, std::vector<S2CellId>>;
+
+    const size_t _maxEntries;
+
+    mutable stdx::mutex _mutex;
+
+    // Most recently used first.
+    std::list<Entry> _entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> _index;
+};
+
+}  // namespace mongo
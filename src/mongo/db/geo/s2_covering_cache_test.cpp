@@ -0,0 +1,90 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/geo/s2_covering_cache.h"
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+std::vector<S2CellId> makeCovering(uint64_t id) {
+    return {S2CellId(id), S2CellId(id + 2)};
+}
+
+TEST(S2CoveringCache, MissThenHit) {
+    S2CoveringCache cache(2);
+    std::vector<S2CellId> covering;
+    ASSERT_FALSE(cache.lookup("a", &covering));
+
+    cache.add("a", makeCovering(1));
+    ASSERT_TRUE(cache.lookup("a", &covering));
+    ASSERT(covering == makeCovering(1));
+    ASSERT_EQ(1U, cache.size());
+}
+
+TEST(S2CoveringCache, AddReplacesExistingEntry) {
+    S2CoveringCache cache(2);
+    cache.add("a", makeCovering(1));
+    cache.add("a", makeCovering(5));
+
+    std::vector<S2CellId> covering;
+    ASSERT_TRUE(cache.lookup("a", &covering));
+    ASSERT(covering == makeCovering(5));
+    ASSERT_EQ(1U, cache.size());
+}
+
+TEST(S2CoveringCache, EvictsLeastRecentlyUsed) {
+    S2CoveringCache cache(2);
+    cache.add("a", makeCovering(1));
+    cache.add("b", makeCovering(3));
+
+    // Using "a" makes "b" the least recently used entry.
+    std::vector<S2CellId> covering;
+    ASSERT_TRUE(cache.lookup("a", &covering));
+    cache.add("c", makeCovering(5));
+
+    ASSERT_EQ(2U, cache.size());
+    ASSERT_TRUE(cache.lookup("a", &covering));
+    ASSERT_FALSE(cache.lookup("b", &covering));
+    ASSERT_TRUE(cache.lookup("c", &covering));
+}
+
+TEST(S2CoveringCache, ZeroSizeDisablesCache) {
+    S2CoveringCache cache(0);
+    cache.add("a", makeCovering(1));
+
+    std::vector<S2CellId> covering;
+    ASSERT_FALSE(cache.lookup("a", &covering));
+    ASSERT_EQ(0U, cache.size());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -240,7 +240,8 @@ BtreeKeyGeneratorV1::BtreeKeyGeneratorV1(std::vector<const char*> fieldNames,
                                          const CollatorInterface* collator)
     : BtreeKeyGenerator(fieldNames, fixed, isSparse),
       _emptyPositionalInfo(fieldNames.size()),
-      _collator(collator) {
+      _collator(collator),
+      _extractor(std::vector<StringData>(fieldNames.begin(), fieldNames.end())) {
     for (const char* fieldName : fieldNames) {
         size_t pathLength = FieldRef{fieldName}.numParts();
         invariant(pathLength > 0);
@@ -343,8 +344,20 @@ void BtreeKeyGeneratorV1::getKeysImpl(std::vector<const char*> fieldNames,
         invariant(multikeyPaths->empty());
         multikeyPaths->resize(fieldNames.size());
     }
-    getKeysImplWithArray(
-        std::move(fieldNames), std::move(fixed), obj, keys, 0, _emptyPositionalInfo, multikeyPaths);
+
+    std::vector<BSONElement> extractedElements;
+    std::vector<size_t> extractedSuffixOffsets;
+    _extractor.extractElementsAtPathsOrArraysAlongPaths(
+        obj, &extractedElements, &extractedSuffixOffsets);
+    getKeysImplWithArray(std::move(fieldNames),
+                         std::move(fixed),
+                         obj,
+                         keys,
+                         0,
+                         _emptyPositionalInfo,
+                         multikeyPaths,
+                         &extractedElements,
+                         &extractedSuffixOffsets);
 }
 
 void BtreeKeyGeneratorV1::getKeysImplWithArray(
@@ -354,7 +367,9 @@ void BtreeKeyGeneratorV1::getKeysImplWithArray(
     BSONObjSet* keys,
     unsigned numNotFound,
     const std::vector<PositionalPathInfo>& positionalInfo,
-    MultikeyPaths* multikeyPaths) const {
+    MultikeyPaths* multikeyPaths,
+    const std::vector<BSONElement>* extractedElements,
+    const std::vector<size_t>* extractedSuffixOffsets) const {
     BSONElement arrElt;
 
     // A set containing the position of any indexed fields in the key pattern that traverse through
@@ -389,10 +404,17 @@ void BtreeKeyGeneratorV1::getKeysImplWithArray(
             continue;
         }
 
-        bool arrayNestedArray;
-        // Extract element matching fieldName[ i ] from object xor array.
-        BSONElement e =
-            extractNextElement(obj, positionalInfo[i], &fieldNames[i], &arrayNestedArray);
+        bool arrayNestedArray = false;
+        BSONElement e;
+        if (extractedElements) {
+            // There is no positional info at the top level, so the field was extracted just as
+            // extractNextElement() would have.
+            e = (*extractedElements)[i];
+            fieldNames[i] += (*extractedSuffixOffsets)[i];
+        } else {
+            // Extract element matching fieldName[ i ] from object xor array.
+            e = extractNextElement(obj, positionalInfo[i], &fieldNames[i], &arrayNestedArray);
+        }
 
         if (e.eoo()) {
             // if field not present, set to null
@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "mongo/bson/bsonobj_comparator_interface.h"
+#include "mongo/db/bson/multi_path_extractor.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/index/multikey_paths.h"
 #include "mongo/db/jsobj.h"
@@ -187,6 +188,10 @@ private:
 
     /**
      * This recursive method does the heavy-lifting for getKeysImpl().
+     *
+     * The top-level call passes the elements '_extractor' found for each field in 'obj', along
+     * with the suffix of each field past any array found, in place of calling
+     * extractNextElement() for each field.
      */
     void getKeysImplWithArray(std::vector<const char*> fieldNames,
                               std::vector<BSONElement> fixed,
@@ -194,7 +199,9 @@ private:
                               BSONObjSet* keys,
                               unsigned numNotFound,
                               const std::vector<PositionalPathInfo>& positionalInfo,
-                              MultikeyPaths* multikeyPaths) const;
+                              MultikeyPaths* multikeyPaths,
+                              const std::vector<BSONElement>* extractedElements = nullptr,
+                              const std::vector<size_t>* extractedSuffixOffsets = nullptr) const;
     /**
      * A call to getKeysImplWithArray() begins by calling this for each field in the key pattern. It
      * traverses the path '*field' in 'obj' until either reaching the end of the path or an array
@@ -258,6 +265,9 @@ private:
     // Null if this key generator orders strings according to the simple binary compare. If
     // non-null, represents the collator used to generate index keys for indexed strings.
     const CollatorInterface* _collator;
+
+    // Extracts every indexed field from a document in a single pass over it.
+    const MultiPathExtractor _extractor;
 };
 
 }  // namespace mongo
@@ -40,6 +40,7 @@
 #include "mongo/db/geo/geoconstants.h"
 #include "mongo/db/geo/geometry_container.h"
 #include "mongo/db/geo/geoparser.h"
+#include "mongo/db/geo/s2_covering_cache.h"
 #include "mongo/db/geo/s2.h"
 #include "mongo/db/index/2d_common.h"
 #include "mongo/db/index/s2_common.h"
@@ -82,9 +83,40 @@ void addKey(const string& root, const BSONElement& e, BSONObjSet* keys) {
 // Helper functions for getS2Keys
 //
 
+// Geometries whose BSON value takes this many bytes get their covering cached, as repeated shapes
+// such as zone polygons are common and expensive to cover. Points are smaller than the minimum and
+// cheap to cover, while the maximum bounds the memory held by the cache.
+const int kMinCachedGeometryBytes = 128;
+const int kMaxCachedGeometryBytes = 64 * 1024;
+
+/**
+ * Returns the covering cache key for 'element' under 'params': the settings which the covering and
+ * the validity checks depend on, followed by the geometry's BSON value.
+ */
+std::string S2CoveringCacheKey(const BSONElement& element, const S2IndexingParams& params) {
+    BufBuilder buf;
+    buf.appendChar('k');
+    buf.appendNum(static_cast<int>(params.indexVersion));
+    buf.appendNum(params.coarsestIndexedLevel);
+    buf.appendNum(params.finestIndexedLevel);
+    buf.appendNum(params.maxCellsInCovering);
+    buf.appendChar(static_cast<char>(element.type()));
+    buf.appendBuf(element.value(), element.valuesize());
+    return std::string(buf.buf(), buf.len());
+}
+
 Status S2GetKeysForElement(const BSONElement& element,
                            const S2IndexingParams& params,
                            vector<S2CellId>* out) {
+    std::string cacheKey;
+    if (element.valuesize() >= kMinCachedGeometryBytes &&
+        element.valuesize() <= kMaxCachedGeometryBytes) {
+        cacheKey = S2CoveringCacheKey(element, params);
+        if (S2CoveringCache::get().lookup(cacheKey, out)) {
+            return Status::OK();
+        }
+    }
+
     GeometryContainer geoContainer;
     Status status = geoContainer.parseFromStorage(element);
     if (!status.isOK())
@@ -116,6 +148,9 @@ Status S2GetKeysForElement(const BSONElement& element,
     invariant(geoContainer.hasS2Region());
 
     coverer.GetCovering(geoContainer.getS2Region(), out);
+    if (!cacheKey.empty()) {
+        S2CoveringCache::get().add(cacheKey, *out);
+    }
     return Status::OK();
 }
 
@@ -447,7 +447,8 @@ IndexAccessMethod::BulkBuilder::BulkBuilder(const IndexAccessMethod* index,
           SortOptions()
               .TempDir(storageGlobalParams.dbpath + "/_tmp")
               .ExtSortAllowed()
-              .MaxMemoryUsageBytes(maxMemoryUsageBytes),
+              .MaxMemoryUsageBytes(maxMemoryUsageBytes)
+              .PrefixCompressKeys(),
           BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version()))),
       _real(index) {}
 
@@ -460,7 +461,14 @@ Status IndexAccessMethod::BulkBuilder::insert(OperationContext* opCtx,
     MultikeyPaths multikeyPaths;
 
     _real->getKeys(obj, options.getKeysMode, &keys, &multikeyPaths);
+    insertKeys(keys, multikeyPaths, loc, numInserted);
+    return Status::OK();
+}
 
+void IndexAccessMethod::BulkBuilder::insertKeys(const BSONObjSet& keys,
+                                                const MultikeyPaths& multikeyPaths,
+                                                const RecordId& loc,
+                                                int64_t* numInserted) {
     _everGeneratedMultipleKeys = _everGeneratedMultipleKeys || (keys.size() > 1);
 
     if (!multikeyPaths.empty()) {
@@ -482,10 +490,12 @@ Status IndexAccessMethod::BulkBuilder::insert(OperationContext* opCtx,
     if (NULL != numInserted) {
         *numInserted += keys.size();
     }
-
-    return Status::OK();
 }
 
+void IndexAccessMethod::BulkBuilder::sortKeys() {
+    invariant(!_sortedKeys);
+    _sortedKeys.reset(_sorter->done());
+}
 
 Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
                                      std::unique_ptr<BulkBuilder> bulk,
@@ -494,7 +504,10 @@ Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
                                      set<RecordId>* dupsToDrop) {
     Timer timer;
 
-    std::unique_ptr<BulkBuilder::Sorter::Iterator> i(bulk->_sorter->done());
+    if (!bulk->_sortedKeys) {
+        bulk->sortKeys();
+    }
+    std::unique_ptr<BulkBuilder::Sorter::Iterator> i(std::move(bulk->_sortedKeys));
 
     stdx::unique_lock<Client> lk(*opCtx->getClient());
     ProgressMeterHolder pm(
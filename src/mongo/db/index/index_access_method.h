@@ -205,6 +205,23 @@ public:
                       const InsertDeleteOptions& options,
                       int64_t* numInserted);
 
+        /**
+         * Adds the 'keys' and 'multikeyPaths' which IndexAccessMethod::getKeys() generated for the
+         * document at 'loc'. This lets callers generate the keys of many documents in parallel,
+         * as only adding them must be serialized.
+         */
+        void insertKeys(const BSONObjSet& keys,
+                        const MultikeyPaths& multikeyPaths,
+                        const RecordId& loc,
+                        int64_t* numInserted);
+
+        /**
+         * Finishes sorting the inserted keys so that commitBulk() only has to load them. No more
+         * keys may be inserted afterwards. Calling this is optional, and it may be done from a
+         * thread other than the one that calls commitBulk().
+         */
+        void sortKeys();
+
     private:
         friend class IndexAccessMethod;
 
@@ -215,6 +232,7 @@ public:
                     size_t maxMemoryUsageBytes);
 
         std::unique_ptr<Sorter> _sorter;
+        std::unique_ptr<Sorter::Iterator> _sortedKeys;  // Set by sortKeys().
         const IndexAccessMethod* _real;
         int64_t _keysInserted = 0;
 
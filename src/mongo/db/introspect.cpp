@@ -91,7 +91,7 @@ void profile(OperationContext* opCtx, NetworkOp op) {
     {
         Locker::LockerInfo lockerInfo;
         opCtx->lockState()->getLockerInfo(&lockerInfo);
-        CurOp::get(opCtx)->debug().append(*CurOp::get(opCtx), lockerInfo.stats, b);
+        CurOp::get(opCtx)->debug().append(*CurOp::get(opCtx), lockerInfo, b);
     }
 
     b.appendDate("ts", jsTime());
@@ -0,0 +1,275 @@
+/**
+ * Copyright (C) 2017 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/compiled_match_expression.h"
+
+#include <cmath>
+
+#include "mongo/db/field_ref.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+std::unique_ptr<CompiledMatchExpression> CompiledMatchExpression::compile(
+    const MatchExpression* expr) {
+    if (!expr) {
+        return nullptr;
+    }
+
+    std::unique_ptr<CompiledMatchExpression> compiled(new CompiledMatchExpression(expr));
+    if (!compiled->_add(expr)) {
+        return nullptr;
+    }
+
+    compiled->_slots.resize(compiled->_nodes.size());
+    return compiled;
+}
+
+CompiledMatchExpression::CompiledMatchExpression(const MatchExpression* expr)
+    : _expr(expr), _nodes(1) {}
+
+bool CompiledMatchExpression::_add(const MatchExpression* expr) {
+    if (expr->matchType() != MatchExpression::AND) {
+        return _addLeaf(expr);
+    }
+
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        if (!_add(expr->getChild(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CompiledMatchExpression::_addLeaf(const MatchExpression* leaf) {
+    Instruction instruction;
+    instruction.expr = leaf;
+
+    switch (leaf->matchType()) {
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE: {
+            auto comparison = static_cast<const ComparisonMatchExpression*>(leaf);
+            if (comparison->getCollator()) {
+                return false;
+            }
+            instruction.op = _comparisonOp(leaf->matchType());
+            instruction.rhs = comparison->getData();
+            break;
+        }
+        case MatchExpression::MATCH_IN: {
+            auto in = static_cast<const InMatchExpression*>(leaf);
+            if (in->getCollator() || !in->getRegexes().empty()) {
+                return false;
+            }
+            instruction.op = Op::kIn;
+            break;
+        }
+        case MatchExpression::EXISTS:
+            instruction.op = Op::kExists;
+            break;
+        case MatchExpression::NOT: {
+            // {$exists: false} is parsed as the negation of {$exists: true}.
+            const MatchExpression* child = leaf->getChild(0);
+            if (child->matchType() != MatchExpression::EXISTS) {
+                return false;
+            }
+            instruction.op = Op::kNotExists;
+            leaf = child;
+            break;
+        }
+        default:
+            return false;
+    }
+
+    if (!_slotForPath(leaf->path(), &instruction.slot)) {
+        return false;
+    }
+    _program.push_back(instruction);
+    return true;
+}
+
+bool CompiledMatchExpression::_slotForPath(StringData path, size_t* slot) {
+    FieldRef fieldRef(path);
+    if (fieldRef.empty()) {
+        return false;
+    }
+
+    size_t node = 0;
+    for (size_t i = 0; i < fieldRef.numParts(); ++i) {
+        StringData part = fieldRef.getPart(i);
+        if (part.empty()) {
+            return false;
+        }
+
+        size_t next = 0;
+        for (size_t child : _nodes[node].children) {
+            if (_nodes[child].fieldName == part) {
+                next = child;
+                break;
+            }
+        }
+        if (next == 0) {
+            next = _nodes.size();
+            _nodes.emplace_back();
+            _nodes.back().fieldName = part.toString();
+            _nodes[node].children.push_back(next);
+        }
+        node = next;
+    }
+
+    *slot = node;
+    return true;
+}
+
+bool CompiledMatchExpression::_resolve(size_t node, const BSONObj& obj) {
+    const auto& children = _nodes[node].children;
+    size_t remaining = children.size();
+
+    BSONObjIterator it(obj);
+    while (remaining > 0 && it.more()) {
+        BSONElement elem = it.next();
+        StringData fieldName = elem.fieldNameStringData();
+        for (size_t child : children) {
+            // Like BSONObj::getField(), only the first field with a given name counts.
+            if (!_slots[child].eoo() || _nodes[child].fieldName != fieldName) {
+                continue;
+            }
+
+            if (elem.type() == BSONType::Array) {
+                return false;
+            }
+            _slots[child] = elem;
+            --remaining;
+
+            if (elem.type() == BSONType::Object && !_nodes[child].children.empty() &&
+                !_resolve(child, elem.Obj())) {
+                return false;
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+bool CompiledMatchExpression::matchesBSON(const BSONObj& doc) {
+    std::fill(_slots.begin(), _slots.end(), BSONElement());
+    if (!_resolve(0, doc)) {
+        return _expr->matchesBSON(doc);
+    }
+
+    for (const auto& instruction : _program) {
+        const BSONElement& elem = _slots[instruction.slot];
+        bool matched;
+        switch (instruction.op) {
+            case Op::kIn: {
+                auto in = static_cast<const InMatchExpression*>(instruction.expr);
+                matched = (in->hasNull() && elem.eoo()) ||
+                    in->getEqualities().find(elem) != in->getEqualities().end();
+                break;
+            }
+            case Op::kExists:
+                matched = !elem.eoo();
+                break;
+            case Op::kNotExists:
+                matched = elem.eoo();
+                break;
+            default:
+                matched = _compare(instruction.op, elem, instruction.rhs);
+                break;
+        }
+        if (!matched) {
+            return false;
+        }
+    }
+    return true;
+}
+
+CompiledMatchExpression::Op CompiledMatchExpression::_comparisonOp(
+    MatchExpression::MatchType matchType) {
+    switch (matchType) {
+        case MatchExpression::EQ:
+            return Op::kEq;
+        case MatchExpression::LT:
+            return Op::kLt;
+        case MatchExpression::LTE:
+            return Op::kLte;
+        case MatchExpression::GT:
+            return Op::kGt;
+        case MatchExpression::GTE:
+            return Op::kGte;
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+bool CompiledMatchExpression::_compare(Op op, const BSONElement& elem, const BSONElement& rhs) {
+    // This follows ComparisonMatchExpression::matchesSingleElement() without a collator.
+    if (elem.canonicalType() != rhs.canonicalType()) {
+        // jstNULL and undefined are treated the same.
+        if (elem.canonicalType() + rhs.canonicalType() == 5) {
+            return op == Op::kEq || op == Op::kLte || op == Op::kGte;
+        }
+
+        if (rhs.type() == MaxKey || rhs.type() == MinKey) {
+            return op != Op::kEq;
+        }
+        return false;
+    }
+
+    // NaN is equal to NaN but otherwise always compares to false.
+    if (std::isnan(elem.numberDouble()) || std::isnan(rhs.numberDouble())) {
+        bool bothNaN = std::isnan(elem.numberDouble()) && std::isnan(rhs.numberDouble());
+        return bothNaN && (op == Op::kEq || op == Op::kLte || op == Op::kGte);
+    }
+
+    int x = BSONElement::compareElements(
+        elem, rhs, BSONElement::ComparisonRules::kConsiderFieldName, nullptr);
+
+    switch (op) {
+        case Op::kLt:
+            return x < 0;
+        case Op::kLte:
+            return x <= 0;
+        case Op::kEq:
+            return x == 0;
+        case Op::kGt:
+            return x > 0;
+        case Op::kGte:
+            return x >= 0;
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+}  // namespace mongo
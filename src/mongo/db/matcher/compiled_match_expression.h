@@ -0,0 +1,132 @@
+/**
+ * Copyright (C) 2017 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/matcher/expression.h"
+
+namespace mongo {
+
+/**
+ * A flat program equivalent to a conjunction of equality, comparison ($lt, $lte, $gt, $gte), $in
+ * and $exists leaves. All of the paths the leaves refer to are resolved together in a single
+ * pass over the document, rather than once per leaf through an ElementIterator, and each leaf
+ * then becomes a single instruction against the resolved element.
+ *
+ * Arrays are where the interpreter's path semantics get involved (implicit traversal, numeric
+ * path components, matching the array as a whole), so a document with an array anywhere along
+ * one of the paths is handed back to the MatchExpression it was compiled from. Results are
+ * therefore always identical to MatchExpression::matchesBSON().
+ *
+ * A CompiledMatchExpression keeps pointers into the expression it was compiled from, which must
+ * outlive it. It is not safe to use from more than one thread at a time.
+ */
+class CompiledMatchExpression {
+    MONGO_DISALLOW_COPYING(CompiledMatchExpression);
+
+public:
+    /**
+     * Returns a compiled version of 'expr', or nullptr if 'expr' is not a conjunction of leaves
+     * that can be compiled. Leaves with a collator are not compiled.
+     */
+    static std::unique_ptr<CompiledMatchExpression> compile(const MatchExpression* expr);
+
+    /**
+     * Returns whether 'doc' matches the expression this program was compiled from.
+     */
+    bool matchesBSON(const BSONObj& doc);
+
+private:
+    enum class Op { kEq, kLt, kLte, kGt, kGte, kIn, kExists, kNotExists };
+
+    struct Instruction {
+        Op op;
+
+        // The slot holding the element this instruction tests.
+        size_t slot;
+
+        // The right-hand side of comparisons.
+        BSONElement rhs;
+
+        // The $in leaf, whose equality set is used by kIn.
+        const MatchExpression* expr;
+    };
+
+    /**
+     * A node in the tree of field names the program's paths are made of. Every node owns a slot
+     * which is filled with the first element found at that node's path.
+     */
+    struct PathNode {
+        std::string fieldName;
+        std::vector<size_t> children;
+    };
+
+    explicit CompiledMatchExpression(const MatchExpression* expr);
+
+    /**
+     * Appends the instructions for 'expr', flattening nested conjunctions. Returns false if
+     * 'expr' contains anything that can't be compiled.
+     */
+    bool _add(const MatchExpression* expr);
+
+    bool _addLeaf(const MatchExpression* leaf);
+
+    /**
+     * Returns the slot for 'path', adding nodes to the tree as needed. Returns false if 'path'
+     * can't be resolved by the program.
+     */
+    bool _slotForPath(StringData path, size_t* slot);
+
+    /**
+     * Fills the slots below 'node' from 'obj'. Returns false if an array was found on one of the
+     * program's paths.
+     */
+    bool _resolve(size_t node, const BSONObj& obj);
+
+    static Op _comparisonOp(MatchExpression::MatchType matchType);
+
+    static bool _compare(Op op, const BSONElement& elem, const BSONElement& rhs);
+
+    const MatchExpression* const _expr;
+
+    std::vector<Instruction> _program;
+
+    // Node 0 is the root and stands for the document itself.
+    std::vector<PathNode> _nodes;
+
+    // The element resolved for each node by the current call to matchesBSON().
+    std::vector<BSONElement> _slots;
+};
+
+}  // namespace mongo
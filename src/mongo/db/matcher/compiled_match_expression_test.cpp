@@ -0,0 +1,153 @@
+/**
+ * Copyright (C) 2017 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/compiled_match_expression.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+std::unique_ptr<MatchExpression> parse(const BSONObj& query,
+                                       const CollatorInterface* collator = nullptr) {
+    StatusWithMatchExpression result = MatchExpressionParser::parse(query, collator);
+    ASSERT_OK(result.getStatus());
+    return std::move(result.getValue());
+}
+
+/**
+ * Checks that 'query' compiles and that the program agrees with the tree interpreter about every
+ * document in 'docs'.
+ */
+void assertSameResults(const char* query, const std::vector<const char*>& docs) {
+    BSONObj queryObj = fromjson(query);
+    auto expr = parse(queryObj);
+    auto compiled = CompiledMatchExpression::compile(expr.get());
+    ASSERT(compiled) << query;
+
+    for (auto&& doc : docs) {
+        BSONObj docObj = fromjson(doc);
+        ASSERT_EQ(expr->matchesBSON(docObj), compiled->matchesBSON(docObj)) << query << " "
+                                                                             << doc;
+    }
+}
+
+const std::vector<const char*> kDocs = {"{}",
+                                        "{a: 1}",
+                                        "{a: 5, b: 'x'}",
+                                        "{a: null}",
+                                        "{a: undefined}",
+                                        "{a: NaN}",
+                                        "{a: 'abc'}",
+                                        "{a: {b: 1}}",
+                                        "{a: {b: 5, c: 2}}",
+                                        "{a: {b: null}}",
+                                        "{a: {c: 1}, b: 1}",
+                                        "{a: {'0': 3}}",
+                                        "{a: [1, 5]}",
+                                        "{a: [{b: 1}, {b: 5}]}",
+                                        "{a: {b: [1, 5]}}",
+                                        "{a: 3, a: 7}",
+                                        "{a: {b: 1}, a: {b: 5}}",
+                                        "{a: 2, b: {c: {d: 4}}}",
+                                        "{b: {c: {d: 'x'}}, a: {b: 1}}",
+                                        "{a: MinKey}",
+                                        "{a: MaxKey}"};
+
+TEST(CompiledMatchExpressionTest, Equality) {
+    assertSameResults("{a: 1}", kDocs);
+    assertSameResults("{a: null}", kDocs);
+    assertSameResults("{'a.b': 1}", kDocs);
+    assertSameResults("{'a.b': null}", kDocs);
+    assertSameResults("{'a.0': 3}", kDocs);
+    assertSameResults("{a: {b: 1}}", kDocs);
+    assertSameResults("{a: NaN}", kDocs);
+}
+
+TEST(CompiledMatchExpressionTest, Comparisons) {
+    assertSameResults("{a: {$lt: 5}}", kDocs);
+    assertSameResults("{a: {$lte: 5}}", kDocs);
+    assertSameResults("{a: {$gt: 1}}", kDocs);
+    assertSameResults("{a: {$gte: null}}", kDocs);
+    assertSameResults("{a: {$gt: MinKey}}", kDocs);
+    assertSameResults("{a: {$lt: MaxKey}}", kDocs);
+    assertSameResults("{a: {$lte: NaN}}", kDocs);
+    assertSameResults("{'a.b': {$gt: 0, $lt: 5}}", kDocs);
+    assertSameResults("{a: {$gte: 'a'}}", kDocs);
+}
+
+TEST(CompiledMatchExpressionTest, InAndExists) {
+    assertSameResults("{a: {$in: [1, 5]}}", kDocs);
+    assertSameResults("{a: {$in: [null, 'abc']}}", kDocs);
+    assertSameResults("{'a.b': {$in: [1, null]}}", kDocs);
+    assertSameResults("{a: {$exists: true}}", kDocs);
+    assertSameResults("{a: {$exists: false}}", kDocs);
+    assertSameResults("{'a.c': {$exists: true}}", kDocs);
+    assertSameResults("{'a.c': {$exists: false}}", kDocs);
+}
+
+TEST(CompiledMatchExpressionTest, Conjunctions) {
+    assertSameResults("{a: {$gte: 1}, b: 'x'}", kDocs);
+    assertSameResults("{'a.b': 1, b: 1}", kDocs);
+    assertSameResults("{a: 2, 'b.c.d': {$in: [4, 'x']}}", kDocs);
+    assertSameResults("{'a.b': {$exists: true}, 'a.c': {$exists: false}}", kDocs);
+    assertSameResults("{a: {$exists: true}, 'a.b': {$lte: 5}}", kDocs);
+    assertSameResults("{$and: [{a: {$gt: 0}}, {a: {$lt: 10}}]}", kDocs);
+}
+
+TEST(CompiledMatchExpressionTest, DoesNotCompileOtherExpressions) {
+    const char* queries[] = {"{a: /abc/}",
+                             "{a: {$in: [1, /abc/]}}",
+                             "{a: {$mod: [2, 0]}}",
+                             "{a: {$ne: 1}}",
+                             "{$or: [{a: 1}, {b: 1}]}",
+                             "{a: {$elemMatch: {$gt: 1}}}",
+                             "{a: {$size: 2}}",
+                             "{a: 1, b: {$type: 'string'}}"};
+    for (auto&& query : queries) {
+        BSONObj queryObj = fromjson(query);
+        auto expr = parse(queryObj);
+        ASSERT_FALSE(CompiledMatchExpression::compile(expr.get())) << query;
+    }
+}
+
+TEST(CompiledMatchExpressionTest, DoesNotCompileWithCollator) {
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kReverseString);
+    BSONObj queryObj = fromjson("{a: 'abc'}");
+    auto expr = parse(queryObj, &collator);
+    ASSERT_FALSE(CompiledMatchExpression::compile(expr.get()));
+}
+
+}  // namespace
+}  // namespace mongo
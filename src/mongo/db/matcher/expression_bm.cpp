@@ -0,0 +1,76 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/unittest/benchmark.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+const BSONObj kFilter =
+    fromjson("{a: {$gt: 5}, 'b.c': {$in: ['x', 'y', 'z']}, d: {$exists: true}, e: 'text'}");
+
+const BSONObj kMatchingDoc =
+    fromjson("{_id: 1, a: 10, b: {c: 'y', d: 2}, d: null, e: 'text', f: [1, 2, 3]}");
+
+const BSONObj kNonMatchingDoc =
+    fromjson("{_id: 1, a: 10, b: {c: 'w', d: 2}, d: null, e: 'text', f: [1, 2, 3]}");
+
+void runMatches(benchmark::State& state, const BSONObj& doc) {
+    const CollatorInterface* collator = nullptr;
+    auto expr = uassertStatusOK(MatchExpressionParser::parse(kFilter, collator));
+    for (auto _ : state) {
+        benchmark::doNotOptimizeAway(expr->matchesBSON(doc));
+    }
+}
+
+void BM_matchesBSONMatching(benchmark::State& state) {
+    runMatches(state, kMatchingDoc);
+}
+BENCHMARK(BM_matchesBSONMatching);
+
+void BM_matchesBSONNonMatching(benchmark::State& state) {
+    runMatches(state, kNonMatchingDoc);
+}
+BENCHMARK(BM_matchesBSONNonMatching);
+
+void BM_parseMatchExpression(benchmark::State& state) {
+    const CollatorInterface* collator = nullptr;
+    for (auto _ : state) {
+        benchmark::doNotOptimizeAway(MatchExpressionParser::parse(kFilter, collator).isOK());
+    }
+}
+BENCHMARK(BM_parseMatchExpression);
+
+}  // namespace
+}  // namespace mongo
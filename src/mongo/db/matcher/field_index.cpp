@@ -0,0 +1,118 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/field_index.h"
+
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+const FieldIndex* FieldIndex::forLookup() {
+    if (_built) {
+        return _slots.empty() ? nullptr : this;
+    }
+    if (++_lookups < 2) {
+        return nullptr;
+    }
+    _build();
+    return _slots.empty() ? nullptr : this;
+}
+
+BSONElement FieldIndex::getField(StringData name) const {
+    invariant(!_slots.empty());
+    const uint32_t hash = _hash(name);
+    const size_t mask = _slots.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Slot& slot = _slots[i];
+        if (slot.offset == 0) {
+            return BSONElement();
+        }
+        if (slot.hash == hash) {
+            BSONElement elem(_obj.objdata() + slot.offset);
+            if (elem.fieldNameStringData() == name) {
+                return elem;
+            }
+        }
+    }
+}
+
+uint32_t FieldIndex::_hash(StringData name) {
+    // FNV-1a, which is cheap for the short names fields usually have.
+    uint32_t hash = 2166136261U;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+void FieldIndex::_build() {
+    _built = true;
+    const int minFields = internalQueryMatcherFieldIndexMinFields.load();
+    if (minFields <= 0) {
+        return;
+    }
+
+    std::vector<BSONElement> elems;
+    for (auto&& elem : _obj) {
+        elems.push_back(elem);
+    }
+    if (elems.size() < static_cast<size_t>(minFields)) {
+        return;
+    }
+
+    // Keep the table at most half full so probe sequences stay short.
+    size_t capacity = 1;
+    while (capacity < elems.size() * 2) {
+        capacity <<= 1;
+    }
+    _slots.assign(capacity, Slot{0, 0});
+
+    const size_t mask = capacity - 1;
+    for (auto&& elem : elems) {
+        const StringData name = elem.fieldNameStringData();
+        const uint32_t hash = _hash(name);
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            Slot& slot = _slots[i];
+            if (slot.offset == 0) {
+                slot = Slot{hash, static_cast<uint32_t>(elem.rawdata() - _obj.objdata())};
+                break;
+            }
+            // A duplicate field name keeps its first occurrence, as BSONObj::getField does.
+            if (slot.hash == hash &&
+                BSONElement(_obj.objdata() + slot.offset).fieldNameStringData() == name) {
+                break;
+            }
+        }
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,83 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
+
+namespace mongo {
+
+/**
+ * A hash from top-level field name to element for a single document, so that matching several
+ * predicates against a document with hundreds of fields does not scan it once per predicate.
+ *
+ * The hash is built lazily on the second lookup, since a single lookup is cheaper as a scan, and
+ * only if the document has at least internalQueryMatcherFieldIndexMinFields fields. The indexed
+ * document must outlive the FieldIndex.
+ */
+class FieldIndex {
+public:
+    FieldIndex() = default;
+    explicit FieldIndex(const BSONObj& obj) : _obj(obj.objdata()) {}
+
+    /**
+     * Records a lookup about to be made against the document and returns this index if it should
+     * serve it, or nullptr if the caller should scan the document itself.
+     */
+    const FieldIndex* forLookup();
+
+    /**
+     * Returns the first top-level element named 'name' in the document, or EOO if there is none.
+     * Only valid once forLookup() has returned this index.
+     */
+    BSONElement getField(StringData name) const;
+
+private:
+    struct Slot {
+        uint32_t hash;
+        // Offset of the element from the start of the document; zero marks an empty slot.
+        uint32_t offset;
+    };
+
+    static uint32_t _hash(StringData name);
+
+    void _build();
+
+    // An unowned view, so that setting up an index for every matched document costs no refcount.
+    BSONObj _obj;
+    int _lookups = 0;
+    bool _built = false;
+    std::vector<Slot> _slots;
+};
+
+}  // namespace mongo
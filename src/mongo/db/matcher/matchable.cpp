@@ -34,7 +34,7 @@
 
 namespace mongo {
 
-BSONMatchableDocument::BSONMatchableDocument(const BSONObj& obj) : _obj(obj) {
+BSONMatchableDocument::BSONMatchableDocument(const BSONObj& obj) : _obj(obj), _fieldIndex(_obj) {
     _iteratorUsed = false;
 }
 
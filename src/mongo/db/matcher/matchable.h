@@ -85,10 +85,11 @@ public:
     }
 
     virtual ElementIterator* allocateIterator(const ElementPath* path) const {
+        const FieldIndex* fieldIndex = _fieldIndex.forLookup();
         if (_iteratorUsed)
-            return new BSONElementIterator(path, _obj);
+            return new BSONElementIterator(path, _obj, fieldIndex);
         _iteratorUsed = true;
-        _iterator.reset(path, _obj);
+        _iterator.reset(path, _obj, fieldIndex);
         return &_iterator;
     }
 
@@ -102,6 +103,7 @@ public:
 
 private:
     BSONObj _obj;
+    mutable FieldIndex _fieldIndex;
     mutable BSONElementIterator _iterator;
     mutable bool _iteratorUsed;
 };
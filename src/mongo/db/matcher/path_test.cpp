@@ -34,6 +34,8 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/path.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -464,4 +466,42 @@ TEST(SingleElementElementIterator, Simple1) {
 
     ASSERT(!i.more());
 }
+
+TEST(FieldIndex, BuiltOnSecondLookupAboveThreshold) {
+    const int oldMinFields = internalQueryMatcherFieldIndexMinFields.load();
+    internalQueryMatcherFieldIndexMinFields.store(3);
+    ON_BLOCK_EXIT([&] { internalQueryMatcherFieldIndexMinFields.store(oldMinFields); });
+
+    BSONObj obj = BSON("a" << 1 << "b" << BSON("c" << 2) << "a" << 3 << "d" << 4);
+    FieldIndex index(obj);
+
+    // A single lookup is cheaper as a scan, so the first one does not build the index.
+    ASSERT(!index.forLookup());
+    ASSERT_EQUALS(&index, index.forLookup());
+
+    // Duplicate names resolve to the first occurrence, like BSONObj::getField.
+    ASSERT_EQUALS(1, index.getField("a").numberInt());
+    ASSERT_EQUALS(4, index.getField("d").numberInt());
+    ASSERT(index.getField("c").eoo());
+    ASSERT(index.getField("").eoo());
+
+    ElementPath p;
+    ASSERT(p.init("b.c").isOK());
+    BSONElementIterator i(&p, obj, &index);
+    ASSERT(i.more());
+    ASSERT_EQUALS(2, i.next().element().numberInt());
+    ASSERT(!i.more());
+}
+
+TEST(FieldIndex, NotBuiltBelowThreshold) {
+    const int oldMinFields = internalQueryMatcherFieldIndexMinFields.load();
+    internalQueryMatcherFieldIndexMinFields.store(3);
+    ON_BLOCK_EXIT([&] { internalQueryMatcherFieldIndexMinFields.store(oldMinFields); });
+
+    BSONObj obj = BSON("a" << 1 << "b" << 2);
+    FieldIndex index(obj);
+    ASSERT(!index.forLookup());
+    ASSERT(!index.forLookup());
+    ASSERT(!index.forLookup());
+}
 }
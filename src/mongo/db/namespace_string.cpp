@@ -83,6 +83,7 @@ constexpr StringData NamespaceString::kAdminDb;
 constexpr StringData NamespaceString::kLocalDb;
 constexpr StringData NamespaceString::kConfigDb;
 constexpr StringData NamespaceString::kSystemDotViewsCollectionName;
+constexpr StringData NamespaceString::kTimeseriesBucketsCollectionPrefix;
 constexpr StringData NamespaceString::kShardConfigCollectionsCollectionName;
 
 const NamespaceString NamespaceString::kServerConfigurationNamespace(kServerConfiguration);
@@ -129,6 +130,8 @@ bool NamespaceString::isLegalClientSystemNS() const {
 
     if (coll() == kSystemDotViewsCollectionName)
         return true;
+    if (isTimeseriesBucketsCollection())
+        return true;
 
     return false;
 }
@@ -140,6 +143,10 @@ NamespaceString NamespaceString::makeListCollectionsNSS(StringData dbName) {
     return nss;
 }
 
+NamespaceString NamespaceString::makeTimeseriesBucketsNamespace() const {
+    return {db(), kTimeseriesBucketsCollectionPrefix.toString() + coll()};
+}
+
 NamespaceString NamespaceString::makeListIndexesNSS(StringData dbName, StringData collectionName) {
     NamespaceString nss(dbName, str::stream() << listIndexesCursorNSPrefix << collectionName);
     dassert(nss.isValid());
@@ -63,6 +63,9 @@ public:
     // Name for the system views collection
     static constexpr StringData kSystemDotViewsCollectionName = "system.views"_sd;
 
+    // Prefix of the collections holding the buckets of time-series collections.
+    static constexpr StringData kTimeseriesBucketsCollectionPrefix = "system.buckets."_sd;
+
     // Name for a shard's collections metadata collection, each document of which indicates the
     // state of a specific collection.
     static constexpr StringData kShardConfigCollectionsCollectionName = "config.collections"_sd;
@@ -108,6 +111,12 @@ public:
      */
     static NamespaceString makeListCollectionsNSS(StringData dbName);
 
+    /**
+     * Returns the namespace of the collection holding the buckets of this time-series collection.
+     * The format for this namespace is "<dbName>.system.buckets.<collectionName>".
+     */
+    NamespaceString makeTimeseriesBucketsNamespace() const;
+
     /**
      * Constructs a NamespaceString representing a listIndexes namespace. The format for this
      * namespace is "<dbName>.$cmd.listIndexes.<collectionName>".
@@ -188,6 +197,9 @@ public:
     bool isSystemDotViews() const {
         return coll() == kSystemDotViewsCollectionName;
     }
+    bool isTimeseriesBucketsCollection() const {
+        return coll().startsWith(kTimeseriesBucketsCollectionPrefix);
+    }
     bool isConfigDB() const {
         return db() == "config";
     }
@@ -232,6 +232,9 @@ Status userAllowedCreateNS(StringData db, StringData coll) {
             return Status::OK();
         if (coll == DurableViewCatalog::viewsCollectionName())
             return Status::OK();
+        if (coll.startsWith(NamespaceString::kTimeseriesBucketsCollectionPrefix) &&
+            coll.size() > NamespaceString::kTimeseriesBucketsCollectionPrefix.size())
+            return Status::OK();
         if (db == "admin") {
             if (coll == "system.version")
                 return Status::OK();
@@ -58,6 +58,7 @@
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_summary_stats.h"
 #include "mongo/db/query/query_knobs.h"
+#include "mongo/db/query/query_stats.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/s/collection_sharding_state.h"
@@ -96,8 +97,10 @@ void finishCurOp(OperationContext* opCtx, CurOp* curOp) {
                     curOp->getLogicalOp(),
                     Top::LockType::WriteLocked,
                     durationCount<Microseconds>(curOp->elapsedTimeExcludingPauses()),
+                    curOp->cpuTimeMicros(),
                     curOp->isCommand(),
                     curOp->getReadWriteType());
+        QueryStatsStore::get(opCtx->getServiceContext()).recordOp(*curOp);
 
         if (!curOp->debug().exceptionInfo.isOK()) {
             LOG(3) << "Caught Assertion in " << redact(logicalOpToString(curOp->getLogicalOp()))
@@ -115,7 +118,7 @@ void finishCurOp(OperationContext* opCtx, CurOp* curOp) {
         if (logAll || (shouldSample && logSlow)) {
             Locker::LockerInfo lockerInfo;
             opCtx->lockState()->getLockerInfo(&lockerInfo);
-            log() << curOp->debug().report(opCtx->getClient(), *curOp, lockerInfo.stats);
+            log() << curOp->debug().report(opCtx->getClient(), *curOp, lockerInfo);
         }
 
         if (curOp->shouldDBProfile(shouldSample)) {
@@ -329,12 +332,16 @@ void insertDocuments(OperationContext* opCtx,
 
 /**
  * Returns true if caller should try to insert more documents. Does nothing else if batch is empty.
+ *
+ * If 'targetIsView' is not null and the namespace turns out to be a view, sets it to true and
+ * returns false without reporting any results.
  */
 bool insertBatchAndHandleErrors(OperationContext* opCtx,
                                 const write_ops::Insert& wholeOp,
                                 std::vector<InsertStatement>& batch,
                                 LastOpFixer* lastOpFixer,
-                                WriteResult* out) {
+                                WriteResult* out,
+                                bool* targetIsView) {
     if (batch.empty())
         return true;
 
@@ -349,7 +356,13 @@ bool insertBatchAndHandleErrors(OperationContext* opCtx,
                 uasserted(ErrorCodes::InternalError, "failAllInserts failpoint active!");
             }
 
-            collection.emplace(opCtx, wholeOp.getNamespace(), MODE_IX);
+            try {
+                collection.emplace(opCtx, wholeOp.getNamespace(), MODE_IX);
+            } catch (const DBException& ex) {
+                if (targetIsView && ex.code() == ErrorCodes::CommandNotSupportedOnView)
+                    *targetIsView = true;
+                throw;
+            }
             if (collection->getCollection())
                 break;
 
@@ -379,6 +392,8 @@ bool insertBatchAndHandleErrors(OperationContext* opCtx,
         }
     } catch (const DBException&) {
         collection.reset();
+        if (targetIsView && *targetIsView)
+            return false;
 
         // Ignore this failure and behave as-if we never tried to do the combined batch insert.
         // The loop below will handle reporting any non-transient errors.
@@ -426,7 +441,9 @@ StmtId getStmtIdForWriteOp(OperationContext* opCtx, const T& wholeOp, size_t opI
 
 }  // namespace
 
-WriteResult performInserts(OperationContext* opCtx, const write_ops::Insert& wholeOp) {
+WriteResult performInserts(OperationContext* opCtx,
+                           const write_ops::Insert& wholeOp,
+                           bool* targetIsView) {
     invariant(!opCtx->lockState()->inAWriteUnitOfWork());  // Does own retries.
     auto& curOp = *CurOp::get(opCtx);
     ON_BLOCK_EXIT([&] {
@@ -439,6 +456,7 @@ WriteResult performInserts(OperationContext* opCtx, const write_ops::Insert& who
                     LogicalOp::opInsert,
                     Top::LockType::WriteLocked,
                     durationCount<Microseconds>(curOp.elapsedTimeExcludingPauses()),
+                    curOp.cpuTimeMicros(),
                     curOp.isCommand(),
                     curOp.getReadWriteType());
 
@@ -496,7 +514,16 @@ WriteResult performInserts(OperationContext* opCtx, const write_ops::Insert& who
                 continue;  // Add more to batch before inserting.
         }
 
-        bool canContinue = insertBatchAndHandleErrors(opCtx, wholeOp, batch, &lastOpFixer, &out);
+        // Only give up on a view while nothing has been written, so the caller can start over.
+        bool canContinue = insertBatchAndHandleErrors(
+            opCtx,
+            wholeOp,
+            batch,
+            &lastOpFixer,
+            &out,
+            curOp.debug().ninserted == 0 && out.results.empty() ? targetIsView : nullptr);
+        if (targetIsView && *targetIsView)
+            return out;
         batch.clear();  // We won't need the current batch any more.
         bytesInBatch = 0;
 
@@ -70,8 +70,13 @@ struct WriteResult {
  * LastError is updated for failures of individual writes, but not for batch errors reported by an
  * exception being thrown from these functions. Callers are responsible for managing LastError in
  * that case. This should generally be combined with LastError handling from parse failures.
+ *
+ * If 'targetIsView' is not null and the insert namespace is a view, performInserts() sets it to true
+ * and returns before writing anything, leaving the caller to decide how to insert into the view.
  */
-WriteResult performInserts(OperationContext* opCtx, const write_ops::Insert& op);
+WriteResult performInserts(OperationContext* opCtx,
+                           const write_ops::Insert& op,
+                           bool* targetIsView = nullptr);
 WriteResult performUpdates(OperationContext* opCtx, const write_ops::Update& op);
 WriteResult performDeletes(OperationContext* opCtx, const write_ops::Delete& op);
 
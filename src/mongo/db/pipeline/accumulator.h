@@ -60,6 +60,16 @@ public:
         processInternal(input, merging);
     }
 
+    /**
+     * Processes each of 'inputs' in turn, as process(input, false) would. Accumulators that can
+     * fold a run of numbers at once override this.
+     */
+    virtual void processAll(const std::vector<Value>& inputs) {
+        for (auto&& input : inputs) {
+            processInternal(input, false);
+        }
+    }
+
     /** Marks the end of the evaluate() phase and return accumulated result.
      *  toBeMerged should be true when the outputs will be merged by process().
      */
@@ -165,6 +175,7 @@ class AccumulatorSum final : public Accumulator {
 public:
     explicit AccumulatorSum(const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
+    void processAll(const std::vector<Value>& inputs) final;
     void processInternal(const Value& input, bool merging) final;
     Value getValue(bool toBeMerged) final;
     const char* getOpName() const final;
@@ -184,7 +195,7 @@ public:
 private:
     BSONType totalType = NumberInt;
     DoubleDoubleSummation nonDecimalTotal;
-    Decimal128 decimalTotal;
+    DecimalSummation decimalTotal;
 };
 
 
@@ -253,6 +264,7 @@ class AccumulatorAvg final : public Accumulator {
 public:
     explicit AccumulatorAvg(const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
+    void processAll(const std::vector<Value>& inputs) final;
     void processInternal(const Value& input, bool merging) final;
     Value getValue(bool toBeMerged) final;
     const char* getOpName() const final;
@@ -270,7 +282,7 @@ private:
 
     bool _isDecimal;
     DoubleDoubleSummation _nonDecimalTotal;
-    Decimal128 _decimalTotal;
+    DecimalSummation _decimalTotal;
     long long _count;
 };
 
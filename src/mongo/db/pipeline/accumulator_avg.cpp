@@ -74,7 +74,7 @@ void AccumulatorAvg::processInternal(const Value& input, bool merging) {
 
     switch (input.getType()) {
         case NumberDecimal:
-            _decimalTotal = _decimalTotal.add(input.getDecimal());
+            _decimalTotal.add(input.getDecimal());
             _isDecimal = true;
             break;
         case NumberLong:
@@ -92,13 +92,47 @@ void AccumulatorAvg::processInternal(const Value& input, bool merging) {
     _count++;
 }
 
+void AccumulatorAvg::processAll(const std::vector<Value>& inputs) {
+    // Runs of doubles and integers are gathered and added in bulk, as in AccumulatorSum.
+    const size_t kBatchSize = 64;
+    double doubles[kBatchSize];
+    long long longs[kBatchSize];
+    size_t numDoubles = 0;
+    size_t numLongs = 0;
+    for (auto&& input : inputs) {
+        switch (input.getType()) {
+            case NumberLong:
+                longs[numLongs++] = input.getLong();
+                if (numLongs == kBatchSize) {
+                    _nonDecimalTotal.addLongs(longs, numLongs);
+                    numLongs = 0;
+                }
+                break;
+            case NumberInt:
+            case NumberDouble:
+                doubles[numDoubles++] = input.getDouble();
+                if (numDoubles == kBatchSize) {
+                    _nonDecimalTotal.addDoubles(doubles, numDoubles);
+                    numDoubles = 0;
+                }
+                break;
+            default:
+                processInternal(input, false);
+                continue;
+        }
+        _count++;
+    }
+    _nonDecimalTotal.addLongs(longs, numLongs);
+    _nonDecimalTotal.addDoubles(doubles, numDoubles);
+}
+
 intrusive_ptr<Accumulator> AccumulatorAvg::create(
     const boost::intrusive_ptr<ExpressionContext>& expCtx) {
     return new AccumulatorAvg(expCtx);
 }
 
 Decimal128 AccumulatorAvg::_getDecimalTotal() const {
-    return _decimalTotal.add(_nonDecimalTotal.getDecimal());
+    return _decimalTotal.getDecimal().add(_nonDecimalTotal.getDecimal());
 }
 
 Value AccumulatorAvg::getValue(bool toBeMerged) {
@@ -77,13 +77,48 @@ void AccumulatorSum::processInternal(const Value& input, bool merging) {
             nonDecimalTotal.addDouble(input.getDouble());
             break;
         case NumberDecimal:
-            decimalTotal = decimalTotal.add(input.coerceToDecimal());
+            decimalTotal.add(input.getDecimal());
             break;
         default:
             MONGO_UNREACHABLE;
     }
 }
 
+void AccumulatorSum::processAll(const std::vector<Value>& inputs) {
+    // Runs of doubles and integers are gathered and added in bulk. Their order relative to any
+    // decimals does not matter, since those are summed separately.
+    const size_t kBatchSize = 64;
+    double doubles[kBatchSize];
+    long long longs[kBatchSize];
+    size_t numDoubles = 0;
+    size_t numLongs = 0;
+    for (auto&& input : inputs) {
+        switch (input.getType()) {
+            case NumberInt:
+            case NumberLong:
+                totalType = Value::getWidestNumeric(totalType, input.getType());
+                longs[numLongs++] = input.coerceToLong();
+                if (numLongs == kBatchSize) {
+                    nonDecimalTotal.addLongs(longs, numLongs);
+                    numLongs = 0;
+                }
+                break;
+            case NumberDouble:
+                totalType = Value::getWidestNumeric(totalType, NumberDouble);
+                doubles[numDoubles++] = input.getDouble();
+                if (numDoubles == kBatchSize) {
+                    nonDecimalTotal.addDoubles(doubles, numDoubles);
+                    numDoubles = 0;
+                }
+                break;
+            default:
+                processInternal(input, false);
+        }
+    }
+    nonDecimalTotal.addLongs(longs, numLongs);
+    nonDecimalTotal.addDoubles(doubles, numDoubles);
+}
+
 intrusive_ptr<Accumulator> AccumulatorSum::create(
     const boost::intrusive_ptr<ExpressionContext>& expCtx) {
     return new AccumulatorSum(expCtx);
@@ -126,7 +161,7 @@ Value AccumulatorSum::getValue(bool toBeMerged) {
                 total = total.add(Decimal128(sum, Decimal128::kRoundTo34Digits));
                 total = total.add(Decimal128(error, Decimal128::kRoundTo34Digits));
             }
-            total = total.add(decimalTotal);
+            total = total.add(decimalTotal.getDecimal());
             return Value(total);
         }
         default:
@@ -0,0 +1,232 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/change_stream_oplog_buffer.h"
+
+#include <algorithm>
+
+#include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+
+namespace mongo {
+
+namespace {
+
+const auto getChangeStreamOplogBuffer =
+    ServiceContext::declareDecoration<ChangeStreamOplogBuffer>();
+
+/**
+ * Returns false for oplog entries that no $changeStream filter matches.
+ */
+bool isRelevantToChangeStreams(const BSONObj& op) {
+    auto fromMigrate = op["fromMigrate"];
+    if (fromMigrate.isBoolean() && fromMigrate.boolean()) {
+        return false;
+    }
+    if (op["op"].valueStringData() == "n"_sd) {
+        auto o2 = op["o2"];
+        return o2.isABSONObj() && o2.Obj()["type"].str() == "migrateChunkToNewShard";
+    }
+    return true;
+}
+
+}  // namespace
+
+ChangeStreamOplogBuffer& ChangeStreamOplogBuffer::get(ServiceContext* service) {
+    return getChangeStreamOplogBuffer(service);
+}
+
+bool ChangeStreamOplogBuffer::read(const NamespaceString& nss,
+                                   Timestamp after,
+                                   bool inclusive,
+                                   size_t maxEntries,
+                                   std::vector<BSONObj>* out,
+                                   Timestamp* scannedThrough) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    // The entry at '_coveredFrom' itself is not buffered.
+    if (!_seeded || after < _coveredFrom || (inclusive && after == _coveredFrom)) {
+        return false;
+    }
+
+    static const std::deque<uint64_t> kNoEntries;
+    auto nsIt = _byNamespace.find(nss.ns());
+    const auto& crud = (nsIt == _byNamespace.end()) ? kNoEntries : nsIt->second;
+
+    // Merge the entries on 'nss' with the commands, in the order they were logged.
+    auto crudIt = _seek(crud, after, inclusive);
+    auto commandIt = _seek(_commands, after, inclusive);
+    Timestamp lastTaken;
+    for (size_t taken = 0; taken < maxEntries; ++taken) {
+        const bool crudLeft = crudIt != crud.end();
+        const bool commandsLeft = commandIt != _commands.end();
+        if (!crudLeft && !commandsLeft) {
+            break;
+        }
+        auto& next = (!commandsLeft || (crudLeft && *crudIt < *commandIt)) ? crudIt : commandIt;
+        const auto& entry = _entryAt(*next);
+        out->push_back(entry.op);
+        lastTaken = entry.ts;
+        ++next;
+    }
+
+    if (crudIt != crud.end() || commandIt != _commands.end()) {
+        *scannedThrough = lastTaken;
+    } else {
+        *scannedThrough = std::max(after, _end);
+    }
+    return true;
+}
+
+boost::optional<ChangeStreamOplogBuffer::RefillTicket> ChangeStreamOplogBuffer::beginRefill() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_refilling) {
+        return boost::none;
+    }
+    _refilling = true;
+    return RefillTicket{_seeded ? _end : Timestamp(), _generation};
+}
+
+void ChangeStreamOplogBuffer::endRefill(const RefillTicket& ticket,
+                                        Timestamp seed,
+                                        const std::vector<BSONObj>& entries,
+                                        size_t maxBytes) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    invariant(_refilling);
+    _refilling = false;
+    _refillCV.notify_all();
+
+    // If the buffer was reset while the ticket was held, what was read may not follow on from
+    // what the buffer holds now.
+    if (ticket.generation != _generation) {
+        return;
+    }
+
+    if (!_seeded) {
+        if (seed.isNull()) {
+            return;
+        }
+        _seeded = true;
+        _coveredFrom = _end = seed;
+    }
+
+    for (auto&& op : entries) {
+        auto ts = op["ts"].timestamp();
+        if (ts <= _end) {
+            continue;
+        }
+        if (isRelevantToChangeStreams(op)) {
+            _append(op);
+        }
+        _end = ts;
+    }
+
+    while (_bytes > maxBytes && !_entries.empty()) {
+        _evictOldest();
+    }
+}
+
+void ChangeStreamOplogBuffer::abandonRefill(const RefillTicket& ticket) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    invariant(_refilling);
+    _refilling = false;
+    _refillCV.notify_all();
+}
+
+Status ChangeStreamOplogBuffer::waitForRefill(OperationContext* opCtx, Timestamp after) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    while (_refilling && !(_seeded && _end > after)) {
+        auto status = opCtx->waitForConditionOrInterruptNoAssertUntil(_refillCV, lk, Date_t::max());
+        if (!status.isOK()) {
+            return status.getStatus();
+        }
+    }
+    return Status::OK();
+}
+
+void ChangeStreamOplogBuffer::reset() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _entries.clear();
+    _firstSeq = 0;
+    _byNamespace.clear();
+    _commands.clear();
+    _seeded = false;
+    _coveredFrom = _end = Timestamp();
+    _bytes = 0;
+    ++_generation;
+    _refillCV.notify_all();
+}
+
+size_t ChangeStreamOplogBuffer::getApproximateSize() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _bytes;
+}
+
+std::deque<uint64_t>::const_iterator ChangeStreamOplogBuffer::_seek(
+    const std::deque<uint64_t>& seqs, Timestamp after, bool inclusive) const {
+    return std::partition_point(seqs.begin(), seqs.end(), [&](uint64_t seq) {
+        auto ts = _entryAt(seq).ts;
+        return inclusive ? ts < after : ts <= after;
+    });
+}
+
+void ChangeStreamOplogBuffer::_append(const BSONObj& op) {
+    const uint64_t seq = _firstSeq + _entries.size();
+    Entry entry{op["ts"].timestamp(), op, op["ns"].valueStringData(), false};
+    entry.isCommand = op["op"].valueStringData() == "c"_sd;
+    if (entry.isCommand) {
+        _commands.push_back(seq);
+    } else {
+        _byNamespace[entry.ns].push_back(seq);
+    }
+    _entries.push_back(std::move(entry));
+    _bytes += sizeof(Entry) + op.objsize();
+}
+
+void ChangeStreamOplogBuffer::_evictOldest() {
+    const auto& oldest = _entries.front();
+    if (oldest.isCommand) {
+        invariant(_commands.front() == _firstSeq);
+        _commands.pop_front();
+    } else {
+        auto nsIt = _byNamespace.find(oldest.ns);
+        invariant(nsIt != _byNamespace.end() && nsIt->second.front() == _firstSeq);
+        nsIt->second.pop_front();
+        if (nsIt->second.empty()) {
+            _byNamespace.erase(nsIt);
+        }
+    }
+    _bytes -= sizeof(Entry) + oldest.op.objsize();
+    _coveredFrom = oldest.ts;
+    _entries.pop_front();
+    ++_firstSeq;
+}
+
+}  // namespace mongo
@@ -0,0 +1,180 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <deque>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/timestamp.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+class OperationContext;
+class ServiceContext;
+
+/**
+ * The most recent oplog entries, shared by every $changeStream on a mongod so that the oplog is
+ * read once for all of them instead of once per cursor.
+ *
+ * There is no reader thread: whichever stream first finds the buffer exhausted takes a refill
+ * ticket, reads the oplog past the last buffered entry and appends what it found, while every
+ * other stream waits for it. Entries no $changeStream can match (no-ops other than chunk
+ * migrations, and writes tagged 'fromMigrate') are skipped on the way in, and the rest are indexed
+ * by namespace, with commands kept apart since they may concern a collection other than their
+ * own. A stream only considers its own namespace and the commands, and still applies its full
+ * filter to what it is handed.
+ *
+ * The buffer is bounded in bytes and evicts its oldest entries first. A stream positioned before
+ * the oldest entry the buffer covers has fallen behind and must read the oplog itself until it
+ * catches up.
+ */
+class ChangeStreamOplogBuffer {
+    MONGO_DISALLOW_COPYING(ChangeStreamOplogBuffer);
+
+public:
+    /**
+     * Grants the right to append to the buffer. 'from' is the timestamp of the last buffered
+     * entry, or null if the buffer is empty and the caller must pick where it starts.
+     */
+    struct RefillTicket {
+        Timestamp from;
+        uint64_t generation;
+    };
+
+    ChangeStreamOplogBuffer() = default;
+
+    static ChangeStreamOplogBuffer& get(ServiceContext* service);
+
+    /**
+     * Appends to 'out' up to 'maxEntries' buffered entries on 'nss' or commands, whose timestamps
+     * are after 'after' (or equal to it, if 'inclusive'), and sets 'scannedThrough' to the
+     * position a reader has reached once it has consumed them.
+     *
+     * Returns false, leaving 'out' untouched, if the buffer does not hold every entry from that
+     * position onward.
+     */
+    bool read(const NamespaceString& nss,
+              Timestamp after,
+              bool inclusive,
+              size_t maxEntries,
+              std::vector<BSONObj>* out,
+              Timestamp* scannedThrough) const;
+
+    /**
+     * Returns a ticket for reading the oplog on behalf of every stream, or boost::none if another
+     * stream already holds one. The ticket must be returned with endRefill() or abandonRefill().
+     */
+    boost::optional<RefillTicket> beginRefill();
+
+    /**
+     * Appends the oplog 'entries' that follow 'ticket.from', which must be in timestamp order, and
+     * evicts the oldest entries until the buffer fits in 'maxBytes'. An empty buffer starts
+     * covering the oplog after 'seed'. Does nothing but release the ticket if the buffer was
+     * reset since it was taken.
+     */
+    void endRefill(const RefillTicket& ticket,
+                   Timestamp seed,
+                   const std::vector<BSONObj>& entries,
+                   size_t maxBytes);
+
+    /**
+     * Releases 'ticket' without appending anything.
+     */
+    void abandonRefill(const RefillTicket& ticket);
+
+    /**
+     * Blocks until the buffer holds entries after 'after' or no stream holds a refill ticket,
+     * whichever is first. Returns a non-OK status if 'opCtx' is interrupted or times out.
+     */
+    Status waitForRefill(OperationContext* opCtx, Timestamp after);
+
+    /**
+     * Discards every entry, for instance because the newest of them was rolled back.
+     */
+    void reset();
+
+    size_t getApproximateSize() const;
+
+private:
+    struct Entry {
+        Timestamp ts;
+        BSONObj op;
+        StringData ns;
+        bool isCommand;
+    };
+
+    /**
+     * Returns the position in 'seqs' of the first entry after 'after', or at it if 'inclusive'.
+     */
+    std::deque<uint64_t>::const_iterator _seek(const std::deque<uint64_t>& seqs,
+                                               Timestamp after,
+                                               bool inclusive) const;
+
+    const Entry& _entryAt(uint64_t seq) const {
+        return _entries[seq - _firstSeq];
+    }
+
+    void _append(const BSONObj& op);
+    void _evictOldest();
+
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _refillCV;
+
+    // The buffered entries, in timestamp order. Each is identified by a sequence number, which is
+    // '_firstSeq' for the oldest.
+    std::deque<Entry> _entries;
+    uint64_t _firstSeq = 0;
+
+    // The sequence numbers of the buffered CRUD entries on each namespace, and of the commands.
+    StringMap<std::deque<uint64_t>> _byNamespace;
+    std::deque<uint64_t> _commands;
+
+    // Whether the buffer currently covers a range of the oplog, which is the entries after
+    // '_coveredFrom' up to and including '_end'. '_end' may be later than the newest buffered
+    // entry if the entries after it were all skipped.
+    bool _seeded = false;
+    Timestamp _coveredFrom;
+    Timestamp _end;
+
+    size_t _bytes = 0;
+
+    // Whether a stream holds a refill ticket, and how many times the buffer has been reset.
+    bool _refilling = false;
+    uint64_t _generation = 0;
+};
+
+}  // namespace mongo
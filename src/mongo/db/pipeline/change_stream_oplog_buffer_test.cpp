@@ -0,0 +1,200 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <limits>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/pipeline/change_stream_oplog_buffer.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const size_t kUnlimited = std::numeric_limits<size_t>::max();
+const NamespaceString kNss("test.coll");
+
+BSONObj makeInsert(unsigned inc, StringData ns = kNss.ns()) {
+    return BSON("ts" << Timestamp(1, inc) << "op"
+                     << "i"
+                     << "ns"
+                     << ns
+                     << "o"
+                     << BSON("_id" << static_cast<int>(inc)));
+}
+
+BSONObj makeCommand(unsigned inc) {
+    return BSON("ts" << Timestamp(1, inc) << "op"
+                     << "c"
+                     << "ns"
+                     << "test.$cmd"
+                     << "o"
+                     << BSON("drop"
+                             << "coll"));
+}
+
+std::vector<Timestamp> timestampsOf(const std::vector<BSONObj>& entries) {
+    std::vector<Timestamp> timestamps;
+    for (auto&& entry : entries) {
+        timestamps.push_back(entry["ts"].timestamp());
+    }
+    return timestamps;
+}
+
+void fill(ChangeStreamOplogBuffer* buffer,
+          Timestamp seed,
+          const std::vector<BSONObj>& entries,
+          size_t maxBytes = kUnlimited) {
+    auto ticket = buffer->beginRefill();
+    ASSERT(ticket);
+    buffer->endRefill(*ticket, seed, entries, maxBytes);
+}
+
+TEST(ChangeStreamOplogBufferTest, ReadFailsUntilTheBufferIsSeeded) {
+    ChangeStreamOplogBuffer buffer;
+    std::vector<BSONObj> out;
+    Timestamp scannedThrough;
+    ASSERT_FALSE(buffer.read(kNss, Timestamp(1, 0), false, kUnlimited, &out, &scannedThrough));
+
+    fill(&buffer, Timestamp(1, 0), {});
+    ASSERT_TRUE(buffer.read(kNss, Timestamp(1, 0), false, kUnlimited, &out, &scannedThrough));
+    ASSERT(out.empty());
+    ASSERT_EQ(scannedThrough, Timestamp(1, 0));
+}
+
+TEST(ChangeStreamOplogBufferTest, ReadReturnsEntriesOnTheNamespaceAndCommandsInOrder) {
+    ChangeStreamOplogBuffer buffer;
+    fill(&buffer,
+         Timestamp(1, 0),
+         {makeInsert(1), makeInsert(2, "test.other"), makeCommand(3), makeInsert(4)});
+
+    std::vector<BSONObj> out;
+    Timestamp scannedThrough;
+    ASSERT_TRUE(buffer.read(kNss, Timestamp(1, 0), false, kUnlimited, &out, &scannedThrough));
+    ASSERT(timestampsOf(out) ==
+           std::vector<Timestamp>({Timestamp(1, 1), Timestamp(1, 3), Timestamp(1, 4)}));
+    ASSERT_EQ(scannedThrough, Timestamp(1, 4));
+
+    out.clear();
+    ASSERT_TRUE(buffer.read(kNss, Timestamp(1, 3), true, kUnlimited, &out, &scannedThrough));
+    ASSERT(timestampsOf(out) == std::vector<Timestamp>({Timestamp(1, 3), Timestamp(1, 4)}));
+}
+
+TEST(ChangeStreamOplogBufferTest, ReadStopsAfterMaxEntries) {
+    ChangeStreamOplogBuffer buffer;
+    fill(&buffer, Timestamp(1, 0), {makeInsert(1), makeCommand(2), makeInsert(3)});
+
+    std::vector<BSONObj> out;
+    Timestamp scannedThrough;
+    ASSERT_TRUE(buffer.read(kNss, Timestamp(1, 0), false, 2, &out, &scannedThrough));
+    ASSERT(timestampsOf(out) == std::vector<Timestamp>({Timestamp(1, 1), Timestamp(1, 2)}));
+    ASSERT_EQ(scannedThrough, Timestamp(1, 2));
+}
+
+TEST(ChangeStreamOplogBufferTest, EntriesNoStreamMatchesAreSkippedButScanned) {
+    ChangeStreamOplogBuffer buffer;
+    auto noop = BSON("ts" << Timestamp(1, 1) << "op"
+                          << "n"
+                          << "ns"
+                          << kNss.ns()
+                          << "o"
+                          << BSONObj());
+    auto migrated = BSON("ts" << Timestamp(1, 2) << "op"
+                              << "i"
+                              << "ns"
+                              << kNss.ns()
+                              << "fromMigrate"
+                              << true
+                              << "o"
+                              << BSON("_id" << 2));
+    fill(&buffer, Timestamp(1, 0), {noop, migrated});
+    ASSERT_EQ(buffer.getApproximateSize(), 0U);
+
+    std::vector<BSONObj> out;
+    Timestamp scannedThrough;
+    ASSERT_TRUE(buffer.read(kNss, Timestamp(1, 0), false, kUnlimited, &out, &scannedThrough));
+    ASSERT(out.empty());
+    ASSERT_EQ(scannedThrough, Timestamp(1, 2));
+}
+
+TEST(ChangeStreamOplogBufferTest, EvictionLeavesEarlierPositionsBehind) {
+    ChangeStreamOplogBuffer buffer;
+    const size_t maxBytes = 2 * makeInsert(1).objsize() + 100;
+    fill(&buffer, Timestamp(1, 0), {makeInsert(1), makeInsert(2), makeInsert(3), makeInsert(4)});
+    fill(&buffer, Timestamp(), {makeInsert(5)}, maxBytes);
+    ASSERT_LTE(buffer.getApproximateSize(), maxBytes);
+
+    std::vector<BSONObj> out;
+    Timestamp scannedThrough;
+    ASSERT_FALSE(buffer.read(kNss, Timestamp(1, 0), false, kUnlimited, &out, &scannedThrough));
+    ASSERT(out.empty());
+
+    ASSERT_TRUE(buffer.read(kNss, Timestamp(1, 4), false, kUnlimited, &out, &scannedThrough));
+    ASSERT(timestampsOf(out) == std::vector<Timestamp>({Timestamp(1, 5)}));
+
+    // The entry at the oldest covered position was itself evicted.
+    ASSERT_FALSE(buffer.read(kNss, Timestamp(1, 2), true, kUnlimited, &out, &scannedThrough));
+}
+
+TEST(ChangeStreamOplogBufferTest, OnlyOneRefillAtATime) {
+    ChangeStreamOplogBuffer buffer;
+    auto ticket = buffer.beginRefill();
+    ASSERT(ticket);
+    ASSERT(ticket->from.isNull());
+    ASSERT_FALSE(buffer.beginRefill());
+
+    buffer.abandonRefill(*ticket);
+    ticket = buffer.beginRefill();
+    ASSERT(ticket);
+    buffer.endRefill(*ticket, Timestamp(1, 0), {makeInsert(1)}, kUnlimited);
+
+    ticket = buffer.beginRefill();
+    ASSERT(ticket);
+    ASSERT_EQ(ticket->from, Timestamp(1, 1));
+    buffer.abandonRefill(*ticket);
+}
+
+TEST(ChangeStreamOplogBufferTest, ResetDiscardsEntriesReadBeforeIt) {
+    ChangeStreamOplogBuffer buffer;
+    fill(&buffer, Timestamp(1, 0), {makeInsert(1)});
+
+    auto ticket = buffer.beginRefill();
+    ASSERT(ticket);
+    buffer.reset();
+    buffer.endRefill(*ticket, Timestamp(1, 0), {makeInsert(2)}, kUnlimited);
+    ASSERT_EQ(buffer.getApproximateSize(), 0U);
+
+    std::vector<BSONObj> out;
+    Timestamp scannedThrough;
+    ASSERT_FALSE(buffer.read(kNss, Timestamp(1, 0), false, kUnlimited, &out, &scannedThrough));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,113 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/change_stream_post_image_cache.h"
+
+#include "mongo/db/service_context.h"
+
+namespace mongo {
+
+namespace {
+
+const auto getChangeStreamPostImageCache =
+    ServiceContext::declareDecoration<ChangeStreamPostImageCache>();
+
+}  // namespace
+
+ChangeStreamPostImageCache& ChangeStreamPostImageCache::get(ServiceContext* service) {
+    return getChangeStreamPostImageCache(service);
+}
+
+std::string ChangeStreamPostImageCache::makeKey(const UUID& uuid,
+                                                const BSONObj& documentKey,
+                                                Timestamp clusterTime) {
+    // The document keys of a change are built the same way by every stream, so their bytes can be
+    // compared directly.
+    std::string key = uuid.toString();
+    key += clusterTime.toString();
+    key.append(documentKey.objdata(), documentKey.objsize());
+    return key;
+}
+
+bool ChangeStreamPostImageCache::find(const UUID& uuid,
+                                      const BSONObj& documentKey,
+                                      Timestamp clusterTime,
+                                      Date_t now,
+                                      BSONObj* postImage) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _entries.find(makeKey(uuid, documentKey, clusterTime));
+    if (it == _entries.end() || it->second.expiresAt <= now) {
+        return false;
+    }
+    *postImage = it->second.postImage;
+    return true;
+}
+
+void ChangeStreamPostImageCache::insert(const UUID& uuid,
+                                        const BSONObj& documentKey,
+                                        Timestamp clusterTime,
+                                        BSONObj postImage,
+                                        Date_t now,
+                                        Milliseconds expireAfter,
+                                        size_t maxBytes) {
+    invariant(postImage.isOwned());
+    const Date_t expiresAt = now + expireAfter;
+    auto key = makeKey(uuid, documentKey, clusterTime);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto inserted = _entries.emplace(key, Entry{std::move(postImage), expiresAt});
+    if (inserted.second) {
+        _bytes += entrySize(key, inserted.first->second);
+        _insertionOrder.push_back(std::move(key));
+    } else if (inserted.first->second.expiresAt < expiresAt) {
+        // Another stream looked this change up while we did; either result will do, so just keep
+        // it around for longer.
+        inserted.first->second.expiresAt = expiresAt;
+    }
+
+    // Entries expire in roughly the order they were inserted.
+    while (!_insertionOrder.empty()) {
+        auto oldest = _entries.find(_insertionOrder.front());
+        invariant(oldest != _entries.end());
+        if (_bytes <= maxBytes && oldest->second.expiresAt > now) {
+            break;
+        }
+        _bytes -= entrySize(oldest->first, oldest->second);
+        _entries.erase(oldest);
+        _insertionOrder.pop_front();
+    }
+}
+
+size_t ChangeStreamPostImageCache::getApproximateSize() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _bytes;
+}
+
+}  // namespace mongo
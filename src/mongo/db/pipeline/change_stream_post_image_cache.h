@@ -0,0 +1,110 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/timestamp.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+
+class ServiceContext;
+
+/**
+ * The post-images recently looked up by 'updateLookup' change streams, shared by all the streams
+ * on a mongod so that a change reported by many of them is looked up once.
+ *
+ * A post-image is keyed by the change it was looked up for: the collection UUID, the document key
+ * and the cluster time of the update. It may therefore be older than the current version of the
+ * document, but never older than that change. Entries expire after a short time and the oldest
+ * are evicted first once the cache exceeds its size.
+ */
+class ChangeStreamPostImageCache {
+    MONGO_DISALLOW_COPYING(ChangeStreamPostImageCache);
+
+public:
+    ChangeStreamPostImageCache() = default;
+
+    static ChangeStreamPostImageCache& get(ServiceContext* service);
+
+    /**
+     * Returns true and sets 'postImage' if the post-image of the change is cached and has not
+     * expired by 'now'. An empty 'postImage' means the document was not found.
+     */
+    bool find(const UUID& uuid,
+              const BSONObj& documentKey,
+              Timestamp clusterTime,
+              Date_t now,
+              BSONObj* postImage) const;
+
+    /**
+     * Caches the 'postImage' of the change for 'expireAfter' from 'now'. 'postImage' must be owned
+     * and is empty if the document was not found. Evicts the entries which have expired, then the
+     * oldest ones until the cache holds at most 'maxBytes'.
+     */
+    void insert(const UUID& uuid,
+                const BSONObj& documentKey,
+                Timestamp clusterTime,
+                BSONObj postImage,
+                Date_t now,
+                Milliseconds expireAfter,
+                size_t maxBytes);
+
+    size_t getApproximateSize() const;
+
+private:
+    struct Entry {
+        BSONObj postImage;
+        Date_t expiresAt;
+    };
+
+    static std::string makeKey(const UUID& uuid, const BSONObj& documentKey, Timestamp clusterTime);
+
+    static size_t entrySize(const std::string& key, const Entry& entry) {
+        return key.size() + entry.postImage.objsize();
+    }
+
+    mutable stdx::mutex _mutex;
+
+    stdx::unordered_map<std::string, Entry> _entries;
+
+    // The keys of '_entries' in the order they were inserted, oldest first.
+    std::deque<std::string> _insertionOrder;
+
+    size_t _bytes = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,97 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <limits>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/pipeline/change_stream_post_image_cache.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const Timestamp kClusterTime(100, 1);
+const size_t kUnlimited = std::numeric_limits<size_t>::max();
+const Date_t kNow = Date_t::fromMillisSinceEpoch(1000);
+
+BSONObj key(int id) {
+    return BSON("_id" << id);
+}
+
+TEST(ChangeStreamPostImageCacheTest, FindsWhatWasInsertedForTheSameChangeOnly) {
+    ChangeStreamPostImageCache cache;
+    const auto uuid = UUID::gen();
+    const auto doc = BSON("_id" << 1 << "x" << 2);
+    cache.insert(uuid, key(1), kClusterTime, doc, kNow, Seconds(1), kUnlimited);
+    cache.insert(uuid, key(2), kClusterTime, BSONObj(), kNow, Seconds(1), kUnlimited);
+
+    BSONObj postImage;
+    ASSERT_TRUE(cache.find(uuid, key(1), kClusterTime, kNow, &postImage));
+    ASSERT_BSONOBJ_EQ(postImage, doc);
+
+    // A document which was not found is cached as an empty post-image.
+    ASSERT_TRUE(cache.find(uuid, key(2), kClusterTime, kNow, &postImage));
+    ASSERT_TRUE(postImage.isEmpty());
+
+    ASSERT_FALSE(cache.find(uuid, key(1), Timestamp(100, 2), kNow, &postImage));
+    ASSERT_FALSE(cache.find(UUID::gen(), key(1), kClusterTime, kNow, &postImage));
+    ASSERT_FALSE(cache.find(uuid, key(3), kClusterTime, kNow, &postImage));
+}
+
+TEST(ChangeStreamPostImageCacheTest, EntriesExpire) {
+    ChangeStreamPostImageCache cache;
+    const auto uuid = UUID::gen();
+    cache.insert(uuid, key(1), kClusterTime, key(1), kNow, Seconds(1), kUnlimited);
+
+    BSONObj postImage;
+    ASSERT_TRUE(cache.find(uuid, key(1), kClusterTime, kNow + Milliseconds(999), &postImage));
+    ASSERT_FALSE(cache.find(uuid, key(1), kClusterTime, kNow + Seconds(1), &postImage));
+
+    // Inserting after the expiry evicts the expired entry.
+    const auto sizeWithOne = cache.getApproximateSize();
+    cache.insert(uuid, key(2), kClusterTime, key(2), kNow + Seconds(2), Seconds(1), kUnlimited);
+    ASSERT_EQ(cache.getApproximateSize(), sizeWithOne);
+}
+
+TEST(ChangeStreamPostImageCacheTest, EvictsTheOldestEntriesBeyondTheSizeLimit) {
+    ChangeStreamPostImageCache cache;
+    const auto uuid = UUID::gen();
+    cache.insert(uuid, key(1), kClusterTime, key(1), kNow, Seconds(1), kUnlimited);
+    const auto entrySize = cache.getApproximateSize();
+    cache.insert(uuid, key(2), kClusterTime, key(2), kNow, Seconds(1), entrySize);
+
+    BSONObj postImage;
+    ASSERT_FALSE(cache.find(uuid, key(1), kClusterTime, kNow, &postImage));
+    ASSERT_TRUE(cache.find(uuid, key(2), kClusterTime, kNow, &postImage));
+    ASSERT_EQ(cache.getApproximateSize(), entrySize);
+}
+
+}  // namespace
+}  // namespace mongo
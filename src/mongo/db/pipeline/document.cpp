@@ -35,7 +35,9 @@
 #include "mongo/bson/bson_depth.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/field_path.h"
+#include "mongo/util/memory_accounting.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 using namespace mongoutils;
@@ -45,10 +47,106 @@ using std::vector;
 
 const DocumentStorage DocumentStorage::kEmptyDoc;
 
+namespace {
+/**
+ * Free lists of document buffers, one per power-of-two size between 128 bytes and 4KB. These are
+ * the sizes DocumentStorage::alloc() grows buffers to, so a $project or $addFields building a new
+ * document per input reuses the buffer of the document it just freed rather than calling malloc.
+ * Each thread caches up to kMaxCachedBuffersPerSize buffers of each size, and at most
+ * DocumentStorage::kMaxCachedBufferBytes in total.
+ *
+ * The cache is charged to MemoryAccountTag::kDocumentBuffers with the most it has held, in steps
+ * of kChargeStepBytes, and refunded at thread exit. This keeps the shared counter off the
+ * per-document path, and overstates each thread's cache by at most kMaxCachedBufferBytes.
+ *
+ * Everything here is trivially destructible so that documents freed while other thread-locals are
+ * being destroyed can still safely return their buffers; BufferCacheReleaser empties the lists at
+ * thread exit.
+ */
+const size_t kMinCachedBufferLog2 = 7;
+const size_t kNumBufferSizeClasses = 6;
+const size_t kMaxCachedBuffersPerSize = 16;
+const size_t kChargeStepBytes = 1024;
+
+struct BufferCache {
+    char* buffers[kNumBufferSizeClasses][kMaxCachedBuffersPerSize];
+    size_t numBuffers[kNumBufferSizeClasses];
+    size_t cachedBytes;
+    size_t chargedBytes;
+    bool shutDown;
+};
+
+thread_local BufferCache bufferCache;
+
+struct BufferCacheReleaser {
+    ~BufferCacheReleaser() {
+        bufferCache.shutDown = true;
+        for (size_t sizeClass = 0; sizeClass < kNumBufferSizeClasses; ++sizeClass) {
+            for (size_t i = 0; i < bufferCache.numBuffers[sizeClass]; ++i) {
+                delete[] bufferCache.buffers[sizeClass][i];
+            }
+            bufferCache.numBuffers[sizeClass] = 0;
+        }
+        bufferCache.cachedBytes = 0;
+        chargeMemoryAccount(MemoryAccountTag::kDocumentBuffers,
+                            -static_cast<long long>(bufferCache.chargedBytes));
+        bufferCache.chargedBytes = 0;
+    }
+};
+
+thread_local BufferCacheReleaser bufferCacheReleaser;
+
+/**
+ * Returns the free list index for buffers of 'bytes' bytes, or -1 if they are not cached.
+ */
+int bufferSizeClass(size_t bytes) {
+    for (size_t sizeClass = 0; sizeClass < kNumBufferSizeClasses; ++sizeClass) {
+        if (bytes == (size_t(1) << (kMinCachedBufferLog2 + sizeClass))) {
+            return sizeClass;
+        }
+    }
+    return -1;
+}
+}  // namespace
+
+const size_t DocumentStorage::kMaxCachedBufferBytes;
+
+char* DocumentStorage::allocateBuffer(size_t bytes) {
+    const int sizeClass = bufferSizeClass(bytes);
+    if (sizeClass >= 0 && bufferCache.numBuffers[sizeClass] > 0) {
+        bufferCache.cachedBytes -= bytes;
+        return bufferCache.buffers[sizeClass][--bufferCache.numBuffers[sizeClass]];
+    }
+    return new char[bytes];
+}
+
+void DocumentStorage::freeBuffer(char* buffer, size_t bytes) {
+    const int sizeClass = bufferSizeClass(bytes);
+    if (sizeClass >= 0 && !bufferCache.shutDown &&
+        bufferCache.numBuffers[sizeClass] < kMaxCachedBuffersPerSize &&
+        bufferCache.cachedBytes + bytes <= kMaxCachedBufferBytes) {
+        // Touch the releaser so that it is constructed, and will empty the cache at thread exit.
+        static_cast<void>(&bufferCacheReleaser);
+        bufferCache.buffers[sizeClass][bufferCache.numBuffers[sizeClass]++] = buffer;
+        bufferCache.cachedBytes += bytes;
+        if (bufferCache.cachedBytes > bufferCache.chargedBytes) {
+            const size_t charge =
+                (bufferCache.cachedBytes + kChargeStepBytes - 1) / kChargeStepBytes *
+                kChargeStepBytes;
+            chargeMemoryAccount(MemoryAccountTag::kDocumentBuffers,
+                                static_cast<long long>(charge - bufferCache.chargedBytes));
+            bufferCache.chargedBytes = charge;
+        }
+        return;
+    }
+    delete[] buffer;
+}
+
 const std::vector<StringData> Document::allMetadataFieldNames = {
     Document::metaFieldTextScore, Document::metaFieldRandVal, Document::metaFieldSortKey};
 
 Position DocumentStorage::findField(StringData requested) const {
+    loadLazyFields();
     int reqSize = requested.size();  // get size calculation out of the way if needed
 
     if (_numFields >= HASH_TAB_MIN) {  // hash lookup
@@ -77,6 +175,7 @@ Position DocumentStorage::findField(StringData requested) const {
 }
 
 Value& DocumentStorage::appendField(StringData name) {
+    loadLazyFields();
     Position pos = getNextPosition();
     const int nameSize = name.size();
 
@@ -136,6 +235,7 @@ void DocumentStorage::alloc(unsigned newSize) {
     const bool firstAlloc = !_buffer;
     const bool doingRehash = needRehash();
     const size_t oldCapacity = _bufferEnd - _buffer;
+    const size_t oldAllocatedBytes = allocatedBytes();
 
     // make new bucket count big enough
     while (needRehash() || hashTabBuckets() < HASH_TAB_INIT_SIZE)
@@ -148,13 +248,15 @@ void DocumentStorage::alloc(unsigned newSize) {
 
     uassert(16490, "Tried to make oversized document", capacity <= size_t(BufferMaxSize));
 
-    std::unique_ptr<char[]> oldBuf(_buffer);
-    _buffer = new char[capacity];
+    char* oldBuf = _buffer;
+    _buffer = allocateBuffer(capacity);
     _bufferEnd = _buffer + capacity - hashTabBytes();
 
     if (!firstAlloc) {
+        ON_BLOCK_EXIT([&] { freeBuffer(oldBuf, oldAllocatedBytes); });
+
         // This just copies the elements
-        memcpy(_buffer, oldBuf.get(), _usedBytes);
+        memcpy(_buffer, oldBuf, _usedBytes);
 
         if (_numFields >= HASH_TAB_MIN) {
             // if we were hashing, deal with the hash table
@@ -162,13 +264,14 @@ void DocumentStorage::alloc(unsigned newSize) {
                 rehash();
             } else {
                 // no rehash needed so just slide table down to new position
-                memcpy(_hashTab, oldBuf.get() + oldCapacity, hashTabBytes());
+                memcpy(_hashTab, oldBuf + oldCapacity, hashTabBytes());
             }
         }
     }
 }
 
 void DocumentStorage::reserveFields(size_t expectedFields) {
+    loadLazyFields();
     fassert(16487, !_buffer);
 
     unsigned buckets = HASH_TAB_INIT_SIZE;
@@ -181,19 +284,20 @@ void DocumentStorage::reserveFields(size_t expectedFields) {
 
     uassert(16491, "Tried to make oversized document", newSize <= size_t(BufferMaxSize));
 
-    _buffer = new char[newSize + hashTabBytes()];
+    _buffer = allocateBuffer(newSize + hashTabBytes());
     _bufferEnd = _buffer + newSize;
 }
 
 intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
+    loadLazyFields();
     intrusive_ptr<DocumentStorage> out(new DocumentStorage());
 
     // Make a copy of the buffer.
     // It is very important that the positions of each field are the same after cloning.
     const size_t bufferBytes = allocatedBytes();
-    out->_buffer = new char[bufferBytes];
-    out->_bufferEnd = out->_buffer + (_bufferEnd - _buffer);
     if (bufferBytes > 0) {
+        out->_buffer = allocateBuffer(bufferBytes);
+        out->_bufferEnd = out->_buffer + (_bufferEnd - _buffer);
         memcpy(out->_buffer, _buffer, bufferBytes);
     }
 
@@ -215,11 +319,29 @@ intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
 }
 
 DocumentStorage::~DocumentStorage() {
-    std::unique_ptr<char[]> deleteBufferAtScopeEnd(_buffer);
+    // A lazy document has no buffer, and must not be converted just to be destroyed.
+    if (!_buffer) {
+        return;
+    }
 
     for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance()) {
         it->val.~Value();  // explicit destructor call
     }
+
+    freeBuffer(_buffer, allocatedBytes());
+}
+
+void DocumentStorage::_loadLazyFields() {
+    // Cleared first, since appending the fields goes through the public interface.
+    _lazy = false;
+    const BSONObj bson = std::move(_bson);
+    const ConstSharedBuffer owner = std::move(_bsonOwner);
+    _bson = BSONObj();
+
+    reserveFields(bson.nFields());
+    for (auto&& elem : bson) {
+        appendField(elem.fieldNameStringData()) = Document::lazyValue(elem, owner, _bsonDepth);
+    }
 }
 
 Document::Document(const BSONObj& bson) {
@@ -234,6 +356,25 @@ Document::Document(const BSONObj& bson) {
     *this = md.freeze();
 }
 
+Value Document::lazyValue(const BSONElement& elem,
+                          const ConstSharedBuffer& owner,
+                          size_t parentDepth) {
+    switch (elem.type()) {
+        case Object:
+            return Value(
+                Document(new DocumentStorage(elem.embeddedObject(), owner, parentDepth + 1)));
+        case Array: {
+            std::vector<Value> values;
+            for (auto&& sub : elem.embeddedObject()) {
+                values.push_back(lazyValue(sub, owner, parentDepth + 1));
+            }
+            return Value(std::move(values));
+        }
+        default:
+            return Value(elem);
+    }
+}
+
 Document::Document(std::initializer_list<std::pair<StringData, ImplicitValue>> initializerList) {
     MutableDocument mutableDoc(initializerList.size());
 
@@ -258,6 +399,13 @@ void Document::toBson(BSONObjBuilder* builder, size_t recursionLevel) const {
                           << " levels of nesting",
             recursionLevel <= BSONDepth::getMaxAllowableDepth());
 
+    // Converting the fields of a document nobody has looked at would give back the same bytes.
+    // They were within the depth limit at their original level, so they are at this one too.
+    if (storage().isLazy() && recursionLevel <= storage().lazyBsonDepth()) {
+        builder->appendElements(storage().lazyBson());
+        return;
+    }
+
     for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
         it->val.addToBsonObj(builder, it->nameSD(), recursionLevel);
     }
@@ -285,6 +433,21 @@ BSONObj Document::toBsonWithMetaData(bool includeSortKey) const {
     return bb.obj();
 }
 
+Document Document::fromBsonWithMetaDataLazily(const BSONObj& bson) {
+    for (auto&& elem : bson) {
+        if (elem.fieldNameStringData().startsWith("$")) {
+            return fromBsonWithMetaData(bson);
+        }
+    }
+    if (bson.isEmpty()) {
+        return Document();
+    }
+
+    BSONObj owned = bson.getOwned();
+    const ConstSharedBuffer& owner = owned.sharedBuffer();
+    return Document(new DocumentStorage(owned, owner, 1));
+}
+
 Document Document::fromBsonWithMetaData(const BSONObj& bson) {
     MutableDocument md;
 
@@ -381,6 +544,12 @@ size_t Document::getApproximateSize() const {
         return 0;  // we've allocated no memory
 
     size_t size = sizeof(DocumentStorage);
+
+    // Estimated from the BSON rather than by converting the document just to measure it.
+    if (storage().isLazy()) {
+        return size + storage().lazyBson().objsize();
+    }
+
     size += storage().allocatedBytes();
 
     for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
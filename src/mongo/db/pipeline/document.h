@@ -217,6 +217,14 @@ public:
      */
     static Document fromBsonWithMetaData(const BSONObj& bson);
 
+    /**
+     * Like fromBsonWithMetaData(), but unless 'bson' has metadata fields, each field is converted
+     * only once the document is read or modified, and each sub-document only once it is read
+     * itself. Serializing a document nobody has read copies 'bson' back out directly. The
+     * document keeps the buffer behind 'bson' alive, copying it first if it is not owned.
+     */
+    static Document fromBsonWithMetaDataLazily(const BSONObj& bson);
+
     /**
      * Given a BSON object that may have metadata fields added as part of toBsonWithMetadata(),
      * returns the same object without any of the metadata fields.
@@ -287,9 +295,18 @@ private:
     friend class ValueStorage;
     friend class MutableDocument;
     friend class MutableValue;
+    friend class DocumentStorage;
 
     explicit Document(const DocumentStorage* ptr) : _storage(ptr){};
 
+    /**
+     * Converts 'elem', a field of a document at nesting level 'parentDepth', to a Value whose
+     * sub-documents are lazy DocumentStorage sharing 'owner'.
+     */
+    static Value lazyValue(const BSONElement& elem,
+                           const ConstSharedBuffer& owner,
+                           size_t parentDepth);
+
     const DocumentStorage& storage() const {
         return (_storage ? *_storage : DocumentStorage::emptyDoc());
     }
@@ -36,6 +36,7 @@
 #include "mongo/base/static_assert.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/util/intrusive_counter.h"
+#include "mongo/util/shared_buffer.h"
 
 namespace mongo {
 /** Helper class to make the position in a document abstract
@@ -181,6 +182,9 @@ private:
 /// Storage class used by both Document and MutableDocument
 class DocumentStorage : public RefCountable {
 public:
+    /// The most bytes of freed buffers each thread keeps for reuse by new documents.
+    static const size_t kMaxCachedBufferBytes = 8 * 1024;
+
     DocumentStorage()
         : _buffer(NULL),
           _bufferEnd(NULL),
@@ -191,8 +195,45 @@ public:
           _textScore(0),
           _randVal(0) {}
 
+    /**
+     * Creates storage whose fields are converted from 'bson' only when they are first read or
+     * modified. 'owner' must hold the memory behind 'bson', and 'bsonDepth' is the nesting level
+     * 'bson' had in the top-level document it came from. Sub-documents are converted lazily in
+     * turn, sharing 'owner'. Reading a lazy document converts it in place, so it must not be read
+     * from several threads at once until it has been converted.
+     */
+    DocumentStorage(const BSONObj& bson, ConstSharedBuffer owner, size_t bsonDepth)
+        : DocumentStorage() {
+        _bson = bson;
+        _bsonOwner = std::move(owner);
+        _bsonDepth = bsonDepth;
+        _lazy = true;
+    }
+
     ~DocumentStorage();
 
+    /// True until the fields of a lazily constructed document have been converted.
+    bool isLazy() const {
+        return _lazy;
+    }
+
+    /// The BSON a lazy document's fields will be converted from. Only valid while isLazy().
+    const BSONObj& lazyBson() const {
+        return _bson;
+    }
+
+    /// The nesting level lazyBson() had in its top-level document. Only valid while isLazy().
+    size_t lazyBsonDepth() const {
+        return _bsonDepth;
+    }
+
+    /// Converts the fields of a lazy document. A no-op for any other document.
+    void loadLazyFields() const {
+        if (MONGO_unlikely(_lazy)) {
+            const_cast<DocumentStorage*>(this)->_loadLazyFields();
+        }
+    }
+
     enum MetaType : char {
         TEXT_SCORE,
         RAND_VAL,
@@ -255,11 +296,13 @@ public:
 
     /// This skips missing values
     DocumentStorageIterator iterator() const {
+        loadLazyFields();
         return DocumentStorageIterator(_firstElement, end(), false);
     }
 
     /// This includes missing values
     DocumentStorageIterator iteratorAll() const {
+        loadLazyFields();
         return DocumentStorageIterator(_firstElement, end(), true);
     }
 
@@ -320,6 +363,8 @@ public:
     }
 
 private:
+    void _loadLazyFields();
+
     /// Same as lastElement->next() or firstElement() if empty.
     const ValueElement* end() const {
         return _firstElement ? _firstElement->plusBytes(_usedBytes) : nullptr;
@@ -328,6 +373,13 @@ private:
     /// Allocates space in _buffer. Copies existing data if there is any.
     void alloc(unsigned newSize);
 
+    /**
+     * Allocate and free the memory behind _buffer. Buffers of common sizes are recycled through a
+     * per-thread cache, since most documents built while running a pipeline are freed soon after.
+     */
+    static char* allocateBuffer(size_t bytes);
+    static void freeBuffer(char* buffer, size_t bytes);
+
     /// Call after adding field to _buffer and increasing _numFields
     void addFieldToHashTable(Position pos);
 
@@ -401,6 +453,12 @@ private:
     double _textScore;
     double _randVal;
     BSONObj _sortKey;
+
+    // Set while the fields still live only in '_bson', whose memory '_bsonOwner' keeps alive.
+    bool _lazy = false;
+    BSONObj _bson;
+    ConstSharedBuffer _bsonOwner;
+    size_t _bsonDepth = 0;
     // When adding a field, make sure to update clone() method
 
     // Defined in document.cpp
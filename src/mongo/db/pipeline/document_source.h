@@ -660,6 +660,12 @@ public:
         virtual CollectionIndexUsageMap getIndexStats(OperationContext* opCtx,
                                                       const NamespaceString& ns) = 0;
 
+        /**
+         * Returns the sampled query shape statistics for namespace "ns".
+         */
+        virtual std::vector<BSONObj> getQueryStats(OperationContext* opCtx,
+                                                   const NamespaceString& ns) = 0;
+
         /**
          * Appends operation latency statistics for collection "nss" to "builder"
          */
@@ -45,6 +45,8 @@
 #include "mongo/db/repl/oplog_entry.h"
 #include "mongo/db/repl/oplog_entry_gen.h"
 #include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/db/update/document_diff.h"
+#include "mongo/db/update/log_builder.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -86,8 +88,11 @@ static constexpr StringData kOplogMatchExplainName = "$_internalOplogMatch"_sd;
 }  // namespace
 
 intrusive_ptr<DocumentSourceOplogMatch> DocumentSourceOplogMatch::create(
-    BSONObj filter, const intrusive_ptr<ExpressionContext>& expCtx) {
-    return new DocumentSourceOplogMatch(std::move(filter), expCtx);
+    BSONObj filter,
+    Timestamp startFrom,
+    bool isResume,
+    const intrusive_ptr<ExpressionContext>& expCtx) {
+    return new DocumentSourceOplogMatch(std::move(filter), startFrom, isResume, expCtx);
 }
 
 const char* DocumentSourceOplogMatch::getSourceName() const {
@@ -116,8 +121,12 @@ Value DocumentSourceOplogMatch::serialize(optional<ExplainOptions::Verbosity> ex
 }
 
 DocumentSourceOplogMatch::DocumentSourceOplogMatch(BSONObj filter,
+                                                   Timestamp startFrom,
+                                                   bool isResume,
                                                    const intrusive_ptr<ExpressionContext>& expCtx)
-    : DocumentSourceMatch(std::move(filter), expCtx) {}
+    : DocumentSourceMatch(std::move(filter), expCtx),
+      _startFrom(startFrom),
+      _isResume(isResume) {}
 
 void checkValueType(const Value v, const StringData filedName, BSONType expectedType) {
     uassert(40532,
@@ -296,7 +305,10 @@ list<intrusive_ptr<DocumentSource>> DocumentSourceChangeStream::createFromBson(
     const bool shouldLookupPostImage = (fullDocOption == "updateLookup"_sd);
 
     auto oplogMatch = DocumentSourceOplogMatch::create(
-        buildMatchFilter(expCtx->ns, startFrom, changeStreamIsResuming), expCtx);
+        buildMatchFilter(expCtx->ns, startFrom, changeStreamIsResuming),
+        startFrom,
+        changeStreamIsResuming,
+        expCtx);
     auto transformation = createTransformationStage(elem.embeddedObject(), expCtx);
     list<intrusive_ptr<DocumentSource>> stages = {oplogMatch, transformation};
     if (resumeStage) {
@@ -363,7 +375,20 @@ Document DocumentSourceChangeStream::Transformation::applyTransformation(const D
 
                 // Extract the field names of $unset document.
                 vector<Value> removedFieldsVector;
-                if (removedFields.getType() == BSONType::Object) {
+                Value updateSemantics = opObject[LogBuilder::kUpdateSemanticsFieldName];
+                Value diff = opObject[doc_diff::kOplogDiffFieldName];
+                if (updateSemantics.numeric() &&
+                    updateSemantics.coerceToInt() == static_cast<int>(UpdateSemantics::kDelta) &&
+                    diff.getType() == BSONType::Object) {
+                    BSONObjBuilder updatedFieldsBuilder;
+                    std::vector<std::string> removedPaths;
+                    doc_diff::flattenDiff(
+                        diff.getDocument().toBson(), &updatedFieldsBuilder, &removedPaths);
+                    updatedFields = Value(updatedFieldsBuilder.obj());
+                    for (auto&& path : removedPaths) {
+                        removedFieldsVector.push_back(Value(path));
+                    }
+                } else if (removedFields.getType() == BSONType::Object) {
                     auto iter = removedFields.getDocument().fieldIterator();
                     while (iter.more()) {
                         removedFieldsVector.push_back(Value(iter.next().first));
@@ -155,8 +155,15 @@ private:
  */
 class DocumentSourceOplogMatch final : public DocumentSourceMatch {
 public:
+    /**
+     * Creates the stage from the 'filter' built by DocumentSourceChangeStream::buildMatchFilter()
+     * for 'startFrom' and 'isResume'.
+     */
     static boost::intrusive_ptr<DocumentSourceOplogMatch> create(
-        BSONObj filter, const boost::intrusive_ptr<ExpressionContext>& expCtx);
+        BSONObj filter,
+        Timestamp startFrom,
+        bool isResume,
+        const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
     const char* getSourceName() const final;
 
@@ -164,8 +171,22 @@ public:
 
     Value serialize(boost::optional<ExplainOptions::Verbosity> explain) const final;
 
+    Timestamp getStartFrom() const {
+        return _startFrom;
+    }
+
+    bool isResume() const {
+        return _isResume;
+    }
+
 private:
-    DocumentSourceOplogMatch(BSONObj filter, const boost::intrusive_ptr<ExpressionContext>& expCtx);
+    DocumentSourceOplogMatch(BSONObj filter,
+                             Timestamp startFrom,
+                             bool isResume,
+                             const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
+    const Timestamp _startFrom;
+    const bool _isResume;
 };
 
 }  // namespace mongo
@@ -0,0 +1,235 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_change_stream_oplog_scan.h"
+
+#include "mongo/client/dbclientcursor.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/pipeline/change_stream_oplog_buffer.h"
+#include "mongo/db/pipeline/document_source_change_stream.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+
+namespace {
+
+constexpr StringData kExplainName = "$_internalChangeStreamOplogScan"_sd;
+
+// The most oplog entries a stream reads at a time, whether into the shared buffer or for itself.
+const int kOplogReadBatchSize = 1000;
+
+}  // namespace
+
+intrusive_ptr<DocumentSourceChangeStreamOplogScan> DocumentSourceChangeStreamOplogScan::create(
+    BSONObj filter,
+    Timestamp startFrom,
+    bool isResume,
+    std::shared_ptr<CappedInsertNotifier> notifier,
+    const intrusive_ptr<ExpressionContext>& expCtx) {
+    return new DocumentSourceChangeStreamOplogScan(
+        std::move(filter), startFrom, isResume, std::move(notifier), expCtx);
+}
+
+DocumentSourceChangeStreamOplogScan::DocumentSourceChangeStreamOplogScan(
+    BSONObj filter,
+    Timestamp startFrom,
+    bool isResume,
+    std::shared_ptr<CappedInsertNotifier> notifier,
+    const intrusive_ptr<ExpressionContext>& expCtx)
+    : DocumentSource(expCtx),
+      _filter(filter.getOwned()),
+      _matcher(uassertStatusOK(
+          MatchExpressionParser::parse(_filter, expCtx->getCollator(), expCtx))),
+      _notifier(std::move(notifier)),
+      _lastTs(startFrom),
+      _inclusive(isResume) {
+    invariant(_notifier);
+}
+
+const char* DocumentSourceChangeStreamOplogScan::getSourceName() const {
+    // This is used in error reporting, so report the name of the stage this one came from.
+    return DocumentSourceChangeStream::kStageName.rawData();
+}
+
+DocumentSource::StageConstraints DocumentSourceChangeStreamOplogScan::constraints() const {
+    StageConstraints constraints(StreamType::kStreaming,
+                                 PositionRequirement::kFirst,
+                                 HostTypeRequirement::kAnyShard,
+                                 DiskUseRequirement::kNoDiskUse,
+                                 FacetRequirement::kNotAllowed);
+    constraints.requiresInputDocSource = false;
+    return constraints;
+}
+
+Value DocumentSourceChangeStreamOplogScan::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    // Like the $match it replaces, this stage is part of the $changeStream alias and only shows up
+    // in explain output.
+    if (explain) {
+        return Value(Document{{kExplainName, Document{}}});
+    }
+    return Value();
+}
+
+DocumentSource::GetNextResult DocumentSourceChangeStreamOplogScan::getNext() {
+    pExpCtx->checkForInterrupt();
+
+    while (_pending.empty()) {
+        if (!_fetch()) {
+            return GetNextResult::makeEOF();
+        }
+    }
+
+    Document next(_pending.front());
+    _pending.pop_front();
+    return std::move(next);
+}
+
+bool DocumentSourceChangeStreamOplogScan::_fetch() {
+    auto& buffer = ChangeStreamOplogBuffer::get(pExpCtx->opCtx->getServiceContext());
+
+    std::vector<BSONObj> entries;
+    Timestamp scannedThrough;
+    if (buffer.read(
+            pExpCtx->ns, _lastTs, _inclusive, kOplogReadBatchSize, &entries, &scannedThrough)) {
+        return _consume(entries, scannedThrough) || _refillSharedBuffer();
+    }
+
+    // This stream is behind everything the buffer holds, so it reads the oplog itself. Once it
+    // reaches the end of the oplog it is within the buffer again, or can start it.
+    entries = _readOplog(_lastTs, _inclusive);
+    if (entries.empty()) {
+        return _refillSharedBuffer();
+    }
+    _consume(entries, entries.back()["ts"].timestamp());
+    return true;
+}
+
+bool DocumentSourceChangeStreamOplogScan::_refillSharedBuffer() {
+    auto opCtx = pExpCtx->opCtx;
+    auto& buffer = ChangeStreamOplogBuffer::get(opCtx->getServiceContext());
+
+    auto ticket = buffer.beginRefill();
+    if (!ticket) {
+        // Another stream is reading the oplog for all of them.
+        if (!_shouldWaitForInserts()) {
+            return false;
+        }
+        auto status = buffer.waitForRefill(opCtx, _lastTs);
+        if (status == ErrorCodes::ExceededTimeLimit) {
+            // The awaitData timeout expired; this is not an error.
+            return false;
+        }
+        uassertStatusOK(status);
+        return true;
+    }
+    auto abandonGuard = MakeGuard([&] { buffer.abandonRefill(*ticket); });
+
+    // An empty buffer starts at this stream's position. Otherwise the last buffered entry is read
+    // again, to make sure it has not been rolled back since.
+    const bool seeding = ticket->from.isNull();
+    std::vector<BSONObj> entries;
+    while (true) {
+        const uint64_t notifierVersion = _notifier->getVersion();
+        entries = seeding ? _readOplog(_lastTs, false) : _readOplog(ticket->from, true);
+        if (!seeding) {
+            if (entries.empty() || entries.front()["ts"].timestamp() != ticket->from) {
+                buffer.reset();
+                return true;
+            }
+            entries.erase(entries.begin());
+        }
+        if (!entries.empty() || !_shouldWaitForInserts()) {
+            break;
+        }
+
+        // Wait for inserts while still holding the ticket, so that only one stream waits on the
+        // oplog and the rest wait for it.
+        auto curOp = CurOp::get(opCtx);
+        curOp->pauseTimer();
+        ON_BLOCK_EXIT([curOp] { curOp->resumeTimer(); });
+        _notifier->wait(notifierVersion, opCtx->getRemainingMaxTimeMicros());
+    }
+
+    abandonGuard.Dismiss();
+    buffer.endRefill(*ticket,
+                     _lastTs,
+                     entries,
+                     std::max(internalDocumentSourceChangeStreamSharedOplogBytes.load(), 0));
+    return !entries.empty();
+}
+
+std::vector<BSONObj> DocumentSourceChangeStreamOplogScan::_readOplog(Timestamp after,
+                                                                     bool inclusive) {
+    DBDirectClient client(pExpCtx->opCtx);
+    auto cursor = client.query(NamespaceString::kRsOplogNamespace.ns(),
+                               BSON("ts" << (inclusive ? GTE : GT) << after),
+                               kOplogReadBatchSize,
+                               0,
+                               nullptr,
+                               QueryOption_OplogReplay);
+    std::vector<BSONObj> entries;
+    while (cursor->more() && entries.size() < static_cast<size_t>(kOplogReadBatchSize)) {
+        entries.push_back(cursor->nextSafe().getOwned());
+    }
+    return entries;
+}
+
+bool DocumentSourceChangeStreamOplogScan::_consume(const std::vector<BSONObj>& entries,
+                                                   Timestamp scannedThrough) {
+    for (auto&& entry : entries) {
+        if (_matcher->matchesBSON(entry)) {
+            _pending.push_back(entry);
+        }
+    }
+
+    if (entries.empty() && scannedThrough <= _lastTs) {
+        return false;
+    }
+    _lastTs = scannedThrough;
+    _inclusive = false;
+    return true;
+}
+
+bool DocumentSourceChangeStreamOplogScan::_shouldWaitForInserts() const {
+    auto opCtx = pExpCtx->opCtx;
+    return pExpCtx->isTailable() && shouldWaitForInserts(opCtx) &&
+        opCtx->checkForInterruptNoAssert().isOK() &&
+        opCtx->getRemainingMaxTimeMicros() > Microseconds::zero();
+}
+
+}  // namespace mongo
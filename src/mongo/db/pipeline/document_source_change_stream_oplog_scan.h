@@ -0,0 +1,128 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/pipeline/document_source.h"
+
+namespace mongo {
+
+class CappedInsertNotifier;
+
+/**
+ * Takes the place of the oplog cursor of a $changeStream on a mongod, reading oplog entries from
+ * the ChangeStreamOplogBuffer it shares with every other $changeStream instead. It filters them
+ * with the stream's $_internalOplogMatch filter, so it produces the same documents the cursor
+ * would have.
+ *
+ * Whenever the buffer runs dry the stream refills it for everyone, or waits for the stream that
+ * already is. A stream which has fallen behind the oldest buffered entry reads the oplog itself,
+ * in batches, until it catches up.
+ */
+class DocumentSourceChangeStreamOplogScan final : public DocumentSource {
+public:
+    /**
+     * Creates a scan for the oplog entries matching 'filter', which starts after 'startFrom', or
+     * at it if 'isResume'. 'notifier' is the oplog's capped insert notifier, which awaitData
+     * getMores wait on.
+     */
+    static boost::intrusive_ptr<DocumentSourceChangeStreamOplogScan> create(
+        BSONObj filter,
+        Timestamp startFrom,
+        bool isResume,
+        std::shared_ptr<CappedInsertNotifier> notifier,
+        const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
+    GetNextResult getNext() final;
+
+    const char* getSourceName() const final;
+
+    StageConstraints constraints() const final;
+
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
+
+    /**
+     * Returns the timestamp of the latest oplog entry this stage has scanned, whether or not it
+     * matched.
+     */
+    Timestamp getLatestOplogTimestamp() const {
+        return _lastTs;
+    }
+
+private:
+    DocumentSourceChangeStreamOplogScan(BSONObj filter,
+                                        Timestamp startFrom,
+                                        bool isResume,
+                                        std::shared_ptr<CappedInsertNotifier> notifier,
+                                        const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
+    /**
+     * Fills '_pending' with the next entries this stream matches, if there are any. Returns false
+     * if the stream has read everything there is and should report EOF.
+     */
+    bool _fetch();
+
+    /**
+     * Reads the oplog past the end of the shared buffer on behalf of every stream, waiting for
+     * new entries if this is an awaitData getMore, or waits for the stream that is doing so.
+     * Returns false if nothing new arrived and the stream should report EOF.
+     */
+    bool _refillSharedBuffer();
+
+    /**
+     * Reads up to a batch of oplog entries after 'after', or from it if 'inclusive'.
+     */
+    std::vector<BSONObj> _readOplog(Timestamp after, bool inclusive);
+
+    /**
+     * Queues the matching 'entries' and moves the stream's position to 'scannedThrough'. Returns
+     * whether the position advanced.
+     */
+    bool _consume(const std::vector<BSONObj>& entries, Timestamp scannedThrough);
+
+    bool _shouldWaitForInserts() const;
+
+    BSONObj _filter;
+    std::unique_ptr<MatchExpression> _matcher;
+    std::shared_ptr<CappedInsertNotifier> _notifier;
+
+    // The position of the stream in the oplog: the entries at or before '_lastTs' have all been
+    // seen, except for the entry at '_lastTs' itself while '_inclusive' is true.
+    Timestamp _lastTs;
+    bool _inclusive;
+
+    // Entries which matched but have not yet been returned.
+    std::deque<BSONObj> _pending;
+};
+
+}  // namespace mongo
@@ -35,6 +35,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/query/explain.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/util/scopeguard.h"
 
@@ -85,6 +86,8 @@ void DocumentSourceCursor::loadBatch() {
                     _currentBatch.push_back(Document());
                 } else if (_dependencies) {
                     _currentBatch.push_back(_dependencies->extractFields(resultObj));
+                } else if (internalDocumentSourceCursorLazyDocuments.load()) {
+                    _currentBatch.push_back(Document::fromBsonWithMetaDataLazily(resultObj));
                 } else {
                     _currentBatch.push_back(Document::fromBsonWithMetaData(resultObj));
                 }
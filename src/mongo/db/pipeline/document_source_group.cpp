@@ -28,10 +28,13 @@
 
 #include "mongo/platform/basic.h"
 
+#include <boost/functional/hash.hpp>
+
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_path_support.h"
 #include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
@@ -66,10 +69,6 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNext() {
         invariant(initializationResult.isEOF());
     }
 
-    for (auto&& accum : _currentAccumulators) {
-        accum->reset();  // Prep accumulators for a new group.
-    }
-
     if (_spilled) {
         return getNextSpilled();
     } else if (_streaming) {
@@ -80,37 +79,19 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNext() {
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
-    // We aren't streaming, and we have spilled to disk.
-    if (!_sorterIterator)
-        return GetNextResult::makeEOF();
-
-    _currentId = _firstPartOfNextGroup.first;
-    const size_t numAccumulators = _accumulatedFields.size();
-    while (pExpCtx->getValueComparator().evaluate(_currentId == _firstPartOfNextGroup.first)) {
-        // Inside of this loop, _firstPartOfNextGroup is the current data being processed.
-        // At loop exit, it is the first value to be processed in the next group.
-        switch (numAccumulators) {  // mirrors switch in spill()
-            case 1:                 // Single accumulators serialize as a single Value.
-                _currentAccumulators[0]->process(_firstPartOfNextGroup.second, true);
-            case 0:  // No accumulators so no Values.
-                break;
-            default: {  // Multiple accumulators serialize as an array of Values.
-                const vector<Value>& accumulatorStates = _firstPartOfNextGroup.second.getArray();
-                for (size_t i = 0; i < numAccumulators; i++) {
-                    _currentAccumulators[i]->process(accumulatorStates[i], true);
-                }
-            }
-        }
-
-        if (!_sorterIterator->more()) {
+    // We aren't streaming, and we have spilled to disk. Return the groups of one partition at a
+    // time, re-aggregating the next partition once the current one is exhausted.
+    while (groupsIterator == _groups->end()) {
+        if (_pendingPartitions.empty()) {
             dispose();
-            break;
+            return GetNextResult::makeEOF();
         }
-
-        _firstPartOfNextGroup = _sorterIterator->next();
+        loadNextPartition();
     }
 
-    return makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+    Document out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
+    ++groupsIterator;
+    return std::move(out);
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
@@ -127,52 +108,71 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
-    // Streaming optimization is active.
-    if (!_firstDocOfNextGroup) {
-        auto nextInput = pSource->getNext();
-        if (!nextInput.isAdvanced()) {
-            return nextInput;
-        }
-        _firstDocOfNextGroup = nextInput.releaseDocument();
-    }
+    // Streaming optimization is active. '_groups' only holds the groups of the current run of
+    // documents sharing a sort key. Since the input is sorted, no later document can belong to one
+    // of these groups once the sort key changes.
+    while (true) {
+        if (_returningRun) {
+            if (groupsIterator != _groups->end()) {
+                Document out = makeDocument(
+                    groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
+                ++groupsIterator;
+                return std::move(out);
+            }
+
+            if (_streamingInputExhausted) {
+                dispose();
+                return GetNextResult::makeEOF();
+            }
 
-    Value id;
-    do {
-        // Add to the current accumulator(s).
-        for (size_t i = 0; i < _currentAccumulators.size(); i++) {
-            _currentAccumulators[i]->process(
-                _accumulatedFields[i].expression->evaluate(*_firstDocOfNextGroup), _doingMerge);
+            // Start the next run with the document that ended the previous one.
+            _returningRun = false;
+            _groups->clear();
+            _memoryUsageBytes = 0;
+            accumulateIntoGroups(*_firstDocOfNextRun);
+            _firstDocOfNextRun = boost::none;
         }
 
-        // Retrieve the next document.
         auto nextInput = pSource->getNext();
-        if (!nextInput.isAdvanced()) {
+        if (nextInput.isPaused()) {
             return nextInput;
         }
 
-        _firstDocOfNextGroup = nextInput.releaseDocument();
-
-
-        // Compute the id. If it does not match _currentId, we will exit the loop, leaving
-        // _firstDocOfNextGroup set for the next time getNext() is called.
-        id = computeId(*_firstDocOfNextGroup);
-    } while (pExpCtx->getValueComparator().evaluate(_currentId == id));
-
-    Document out = makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
-    _currentId = std::move(id);
+        if (nextInput.isEOF()) {
+            _streamingInputExhausted = true;
+            _returningRun = true;
+            groupsIterator = _groups->begin();
+            continue;
+        }
 
-    return std::move(out);
+        auto rootDocument = nextInput.releaseDocument();
+        Value sortKey = computeSortKey(rootDocument);
+        if (_groups->empty()) {
+            _currentSortKey = std::move(sortKey);
+        } else if (pExpCtx->getValueComparator().evaluate(_currentSortKey != sortKey)) {
+            _currentSortKey = std::move(sortKey);
+            _firstDocOfNextRun = std::move(rootDocument);
+            _returningRun = true;
+            groupsIterator = _groups->begin();
+            continue;
+        }
+        accumulateIntoGroups(rootDocument);
+    }
 }
 
 void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
-    _sorterIterator.reset();
+    _spillPartitions = boost::none;
+    _pendingPartitions.clear();
 
     // Make us look done.
     groupsIterator = _groups->end();
 
-    _firstDocOfNextGroup = boost::none;
+    // A disposed streaming $group has no more runs to return.
+    _firstDocOfNextRun = boost::none;
+    _returningRun = true;
+    _streamingInputExhausted = true;
 }
 
 intrusive_ptr<DocumentSource> DocumentSourceGroup::optimize() {
@@ -322,6 +322,38 @@ void DocumentSourceGroup::setIdExpression(const boost::intrusive_ptr<Expression>
     }
 }
 
+namespace {
+
+// Returns true for the accumulators which skip both null and missing inputs.
+bool ignoresNullishInputs(StringData opName) {
+    return opName == "$avg"_sd || opName == "$max"_sd || opName == "$min"_sd ||
+        opName == "$stdDevPop"_sd || opName == "$stdDevSamp"_sd || opName == "$sum"_sd;
+}
+
+bool isFieldPathOrConstant(const intrusive_ptr<Expression>& expression) {
+    return dynamic_cast<ExpressionFieldPath*>(expression.get()) ||
+        dynamic_cast<ExpressionConstant*>(expression.get());
+}
+
+}  // namespace
+
+bool DocumentSourceGroup::treatsMissingAndNullAlike() const {
+    // A single _id expression whose value is missing groups under null, but an _id document of
+    // several fields leaves a missing field out. Expressions such as $type can tell null from
+    // missing too, so only field paths and constants are allowed.
+    if (_idExpressions.size() != 1 || !isFieldPathOrConstant(_idExpressions.front())) {
+        return false;
+    }
+
+    for (auto&& accumulatedField : _accumulatedFields) {
+        if (!isFieldPathOrConstant(accumulatedField.expression) ||
+            !ignoresNullishInputs(accumulatedField.makeAccumulator(pExpCtx)->getOpName())) {
+            return false;
+        }
+    }
+    return true;
+}
+
 intrusive_ptr<DocumentSource> DocumentSourceGroup::createFromBson(
     BSONElement elem, const intrusive_ptr<ExpressionContext>& pExpCtx) {
     uassert(15947, "a group's fields must be specified in an object", elem.type() == Object);
@@ -359,32 +391,6 @@ namespace {
 
 using GroupsMap = DocumentSourceGroup::GroupsMap;
 
-class SorterComparator {
-public:
-    typedef pair<Value, Value> Data;
-
-    SorterComparator(ValueComparator valueComparator) : _valueComparator(valueComparator) {}
-
-    int operator()(const Data& lhs, const Data& rhs) const {
-        return _valueComparator.compare(lhs.first, rhs.first);
-    }
-
-private:
-    ValueComparator _valueComparator;
-};
-
-class SpillSTLComparator {
-public:
-    SpillSTLComparator(ValueComparator valueComparator) : _valueComparator(valueComparator) {}
-
-    bool operator()(const GroupsMap::value_type* lhs, const GroupsMap::value_type* rhs) const {
-        return _valueComparator.evaluate(lhs->first < rhs->first);
-    }
-
-private:
-    ValueComparator _valueComparator;
-};
-
 bool containsOnlyFieldPathsAndConstants(ExpressionObject* expressionObj) {
     for (auto&& it : expressionObj->getChildExpressions()) {
         const intrusive_ptr<Expression>& childExp = it.second;
@@ -426,117 +432,32 @@ void getFieldPathMap(ExpressionObject* expressionObj,
         }
     }
 }
-
-void getFieldPathListForSpilled(ExpressionObject* expressionObj,
-                                std::string prefix,
-                                std::vector<std::string>* fields) {
-    // Given an expression, attempt to compute a vector of strings, each representing the path
-    // through the object to a leaf. For example, for the expression represented by
-    // {x: 2, y: {z: "$a.b"}}, the output would be ["x", "y.z"].
-    for (auto&& it : expressionObj->getChildExpressions()) {
-        intrusive_ptr<Expression> childExp = it.second;
-        ExpressionObject* expObj = dynamic_cast<ExpressionObject*>(childExp.get());
-
-        std::string newPrefix = prefix.empty() ? it.first : prefix + "." + it.first;
-
-        if (expObj) {
-            getFieldPathListForSpilled(expObj, newPrefix, fields);
-        } else {
-            fields->push_back(newPrefix);
-        }
-    }
-}
 }  // namespace
 
 DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
-    const size_t numAccumulators = _accumulatedFields.size();
-
     boost::optional<BSONObj> inputSort = findRelevantInputSort();
     if (inputSort) {
-        // We can convert to streaming.
+        // We can convert to streaming. Input is consumed one run of equal sort keys at a time by
+        // getNextStreaming().
         _streaming = true;
         _inputSort = *inputSort;
-
-        // Set up accumulators.
-        _currentAccumulators.reserve(numAccumulators);
-        for (auto&& accumulatedField : _accumulatedFields) {
-            _currentAccumulators.push_back(accumulatedField.makeAccumulator(pExpCtx));
+        for (auto&& sortField : _inputSort) {
+            _sortPaths.emplace_back(sortField.fieldNameStringData());
+            _sortPathNames.insert(sortField.fieldName());
         }
-
-        // We only need to load the first document.
-        auto firstInput = pSource->getNext();
-        if (!firstInput.isAdvanced()) {
-            // Leave '_firstDocOfNextGroup' uninitialized and return.
-            return firstInput;
+        if (!_inputSort.isEmpty()) {
+            _sortKeyGen = SortKeyGenerator{_inputSort, nullptr};
         }
-        _firstDocOfNextGroup = firstInput.releaseDocument();
-
-        // Compute the _id value.
-        _currentId = computeId(*_firstDocOfNextGroup);
         _initialized = true;
         return DocumentSource::GetNextResult::makeEOF();
     }
 
-
     // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
     GetNextResult input = pSource->getNext();
     for (; input.isAdvanced(); input = pSource->getNext()) {
-        if (_memoryUsageBytes > _maxMemoryUsageBytes) {
-            uassert(16945,
-                    "Exceeded memory limit for $group, but didn't allow external sort."
-                    " Pass allowDiskUse:true to opt in.",
-                    _allowDiskUse);
-            _sortedFiles.push_back(spill());
-            _memoryUsageBytes = 0;
-        }
-
         // We release the result document here so that it does not outlive the end of this loop
         // iteration. Not releasing could lead to an array copy when this group follows an unwind.
-        auto rootDocument = input.releaseDocument();
-        Value id = computeId(rootDocument);
-
-        // Look for the _id value in the map. If it's not there, add a new entry with a blank
-        // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
-        // looking it up in '_groups' multiple times.
-        const size_t oldSize = _groups->size();
-        vector<intrusive_ptr<Accumulator>>& group = (*_groups)[id];
-        const bool inserted = _groups->size() != oldSize;
-
-        if (inserted) {
-            _memoryUsageBytes += id.getApproximateSize();
-
-            // Add the accumulators
-            group.reserve(numAccumulators);
-            for (auto&& accumulatedField : _accumulatedFields) {
-                group.push_back(accumulatedField.makeAccumulator(pExpCtx));
-            }
-        } else {
-            for (auto&& groupObj : group) {
-                // subtract old mem usage. New usage added back after processing.
-                _memoryUsageBytes -= groupObj->memUsageForSorter();
-            }
-        }
-
-        /* tickle all the accumulators for the group we found */
-        dassert(numAccumulators == group.size());
-
-        for (size_t i = 0; i < numAccumulators; i++) {
-            group[i]->process(_accumulatedFields[i].expression->evaluate(rootDocument),
-                              _doingMerge);
-
-            _memoryUsageBytes += group[i]->memUsageForSorter();
-        }
-
-        if (kDebugBuild && !storageGlobalParams.readOnly) {
-            // In debug mode, spill every time we have a duplicate id to stress merge logic.
-            if (!inserted &&                 // is a dup
-                !pExpCtx->inMongos &&        // can't spill to disk in mongos
-                !_allowDiskUse &&            // don't change behavior when testing external sort
-                _sortedFiles.size() < 20) {  // don't open too many FDs
-
-                _sortedFiles.push_back(spill());
-            }
-        }
+        accumulateIntoGroups(input.releaseDocument());
     }
 
     switch (input.getStatus()) {
@@ -548,26 +469,18 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         }
         case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
             // Do any final steps necessary to prepare to output results.
-            if (!_sortedFiles.empty()) {
+            if (_spillPartitions) {
                 _spilled = true;
                 if (!_groups->empty()) {
-                    _sortedFiles.push_back(spill());
+                    spill();
                 }
+                finishSpillPartitions(_spillPartitions.get_ptr());
+                _spillPartitions = boost::none;
 
-                // We won't be using groups again so free its memory.
+                // Groups are now returned one partition at a time, starting with the first call to
+                // getNextSpilled().
                 _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
-
-                _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
-                    _sortedFiles, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
-
-                // prepare current to accumulate data
-                _currentAccumulators.reserve(numAccumulators);
-                for (auto&& accumulatedField : _accumulatedFields) {
-                    _currentAccumulators.push_back(accumulatedField.makeAccumulator(pExpCtx));
-                }
-
-                verify(_sorterIterator->more());  // we put data in, we should get something out.
-                _firstPartOfNextGroup = _sorterIterator->next();
+                groupsIterator = _groups->end();
             } else {
                 // start the group iterator
                 groupsIterator = _groups->begin();
@@ -582,53 +495,193 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     MONGO_UNREACHABLE;
 }
 
-shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
-    vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
-    ptrs.reserve(_groups->size());
-    for (GroupsMap::const_iterator it = _groups->begin(), end = _groups->end(); it != end; ++it) {
-        ptrs.push_back(&*it);
+void DocumentSourceGroup::accumulateIntoGroups(const Document& root) {
+    const size_t numAccumulators = _accumulatedFields.size();
+
+    if (!_streaming && _memoryUsageBytes > _maxMemoryUsageBytes) {
+        uassert(16945,
+                "Exceeded memory limit for $group, but didn't allow external sort."
+                " Pass allowDiskUse:true to opt in.",
+                _allowDiskUse);
+        spill();
     }
 
-    stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator(pExpCtx->getValueComparator()));
+    Value id = computeId(root);
 
-    SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
-    switch (_accumulatedFields.size()) {  // same as ptrs[i]->second.size() for all i.
-        case 0:                           // no values, essentially a distinct
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first, Value());
+    // Look for the _id value in the map. If it's not there, add a new entry with a blank
+    // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
+    // looking it up in '_groups' multiple times.
+    const size_t oldSize = _groups->size();
+    vector<intrusive_ptr<Accumulator>>& group = (*_groups)[id];
+    const bool inserted = _groups->size() != oldSize;
+
+    if (inserted) {
+        _memoryUsageBytes += id.getApproximateSize();
+
+        // Add the accumulators
+        group.reserve(numAccumulators);
+        for (auto&& accumulatedField : _accumulatedFields) {
+            group.push_back(accumulatedField.makeAccumulator(pExpCtx));
+        }
+    } else {
+        for (auto&& groupObj : group) {
+            // subtract old mem usage. New usage added back after processing.
+            _memoryUsageBytes -= groupObj->memUsageForSorter();
+        }
+    }
+
+    /* tickle all the accumulators for the group we found */
+    dassert(numAccumulators == group.size());
+
+    for (size_t i = 0; i < numAccumulators; i++) {
+        group[i]->process(_accumulatedFields[i].expression->evaluate(root), _doingMerge);
+
+        _memoryUsageBytes += group[i]->memUsageForSorter();
+    }
+
+    if (kDebugBuild && !storageGlobalParams.readOnly) {
+        // In debug mode, spill every time we have a duplicate id to stress merge logic.
+        if (!inserted &&                 // is a dup
+            !_streaming &&               // a streaming $group only holds the current run
+            !pExpCtx->inMongos &&        // can't spill to disk in mongos
+            !_allowDiskUse &&            // don't change behavior when testing external sort
+            _numSpills < 20) {           // don't make debug builds quadratic
+
+            spill();
+        }
+    }
+}
+
+void DocumentSourceGroup::spill() {
+    if (!_spillPartitions) {
+        _spillPartitions.emplace(0);
+    }
+    spillGroupsTo(_spillPartitions.get_ptr());
+    _memoryUsageBytes = 0;
+    ++_numSpills;
+}
+
+void DocumentSourceGroup::spillGroupsTo(SpillPartitions* partitions) {
+    for (auto&& group : *_groups) {
+        writeToPartition(partitions, group.first, serializeAccumulators(group.second));
+    }
+    _groups->clear();
+}
+
+void DocumentSourceGroup::writeToPartition(SpillPartitions* partitions,
+                                           const Value& id,
+                                           const Value& state) {
+    // Mix the depth into the hash, so that splitting a partition again spreads its groups out.
+    size_t hash = _groups->hash_function()(id);
+    boost::hash_combine(hash, partitions->depth);
+
+    auto& writer = partitions->writers[hash % kNumSpillPartitions];
+    if (!writer) {
+        writer = stdx::make_unique<SortedFileWriter<Value, Value>>(
+            SortOptions().TempDir(pExpCtx->tempDir));
+    }
+    // Partition files are read back in the order they were written, so they need not be sorted.
+    writer->addAlreadySorted(id, state);
+}
+
+void DocumentSourceGroup::finishSpillPartitions(SpillPartitions* partitions) {
+    for (auto&& writer : partitions->writers) {
+        if (writer) {
+            std::unique_ptr<Sorter<Value, Value>::Iterator> iterator(writer->done());
+            _pendingPartitions.push_back({std::move(iterator), partitions->depth});
+            writer.reset();
+        }
+    }
+}
+
+void DocumentSourceGroup::loadNextPartition() {
+    invariant(!_pendingPartitions.empty());
+    auto partition = std::move(_pendingPartitions.back());
+    _pendingPartitions.pop_back();
+
+    _groups->clear();
+    _memoryUsageBytes = 0;
+    while (partition.iterator->more()) {
+        if (_memoryUsageBytes > _maxMemoryUsageBytes &&
+            partition.depth < kMaxSpillPartitionDepth) {
+            // Split this partition with a different hash. The groups aggregated so far are
+            // written before the rest of the partition, so that each group's partial states stay
+            // in the order they were accumulated.
+            SpillPartitions subPartitions(partition.depth + 1);
+            spillGroupsTo(&subPartitions);
+            while (partition.iterator->more()) {
+                auto record = partition.iterator->next();
+                writeToPartition(&subPartitions, record.first, record.second);
             }
+            finishSpillPartitions(&subPartitions);
+            _memoryUsageBytes = 0;
             break;
+        }
+
+        pExpCtx->checkForInterrupt();
+        auto record = partition.iterator->next();
+        mergeSpilledGroup(record.first, record.second);
+    }
+
+    groupsIterator = _groups->begin();
+}
+
+Value DocumentSourceGroup::serializeAccumulators(const Accumulators& accums) const {
+    switch (_accumulatedFields.size()) {  // same as accums.size()
+        case 0:                           // no values, essentially a distinct
+            return Value();
 
         case 1:  // just one value, use optimized serialization as single Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first,
-                                        ptrs[i]->second[0]->getValue(/*toBeMerged=*/true));
-            }
-            break;
+            return accums[0]->getValue(/*toBeMerged=*/true);
 
-        default:  // multiple values, serialize as array-typed Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                vector<Value> accums;
-                for (size_t j = 0; j < ptrs[i]->second.size(); j++) {
-                    accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
-                }
-                writer.addAlreadySorted(ptrs[i]->first, Value(std::move(accums)));
+        default: {  // multiple values, serialize as array-typed Value
+            vector<Value> states;
+            states.reserve(accums.size());
+            for (auto&& accum : accums) {
+                states.push_back(accum->getValue(/*toBeMerged=*/true));
             }
-            break;
+            return Value(std::move(states));
+        }
     }
+}
 
-    _groups->clear();
+void DocumentSourceGroup::mergeSpilledGroup(const Value& id, const Value& state) {
+    const size_t numAccumulators = _accumulatedFields.size();
 
-    return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
-}
+    const size_t oldSize = _groups->size();
+    Accumulators& group = (*_groups)[id];
+    if (_groups->size() != oldSize) {
+        _memoryUsageBytes += id.getApproximateSize();
+        group.reserve(numAccumulators);
+        for (auto&& accumulatedField : _accumulatedFields) {
+            group.push_back(accumulatedField.makeAccumulator(pExpCtx));
+        }
+    } else {
+        for (auto&& accum : group) {
+            _memoryUsageBytes -= accum->memUsageForSorter();
+        }
+    }
 
-boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
-    if (true) {
-        // Until streaming $group correctly handles nullish values, the streaming behavior is
-        // disabled. See SERVER-23318.
-        return boost::none;
+    switch (numAccumulators) {  // mirrors switch in serializeAccumulators()
+        case 0:
+            break;
+        case 1:
+            group[0]->process(state, true);
+            break;
+        default: {
+            const vector<Value>& accumulatorStates = state.getArray();
+            for (size_t i = 0; i < numAccumulators; i++) {
+                group[i]->process(accumulatorStates[i], true);
+            }
+        }
+    }
+
+    for (auto&& accum : group) {
+        _memoryUsageBytes += accum->memUsageForSorter();
     }
+}
 
+boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
     if (!pSource) {
         // Sometimes when performing an explain, or using $group as the merge point, 'pSource' will
         // not be set.
@@ -673,6 +726,12 @@ boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
         return BSONObj();
     }
 
+    if (pExpCtx->getCollator()) {
+        // Sort keys of documents with arrays along the sorted paths are computed without a
+        // collation, so they could not be compared against the collated values of other documents.
+        return boost::none;
+    }
+
     for (auto&& obj : sorts) {
         // Note that a sort order of, e.g., {a: 1, b: 1, c: 1} allows us to do a non-blocking group
         // for every permutation of group by (a, b, c), since we are guaranteed that documents with
@@ -691,31 +750,28 @@ boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
 BSONObjSet DocumentSourceGroup::getOutputSorts() {
     if (!_initialized) {
         initialize();  // Note this might not finish initializing, but that's OK. We just want to
-                       // do some initialization to try to determine if we are streaming or spilled.
+                       // do some initialization to try to determine if we are streaming.
                        // False negatives are OK.
     }
 
-    if (!(_streaming || _spilled)) {
+    // A spilled $group returns its groups one hash partition at a time, so only a streaming $group
+    // has a meaningful output order.
+    if (!_streaming) {
         return SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     }
 
     BSONObjBuilder sortOrder;
 
     if (_idFieldNames.empty()) {
-        if (_spilled) {
-            sortOrder.append("_id", 1);
-        } else {
-            // We have an expression like {_id: "$a"}. Check if this is a FieldPath, and if it is,
-            // get the sort order out of it.
-            if (auto obj = dynamic_cast<ExpressionFieldPath*>(_idExpressions[0].get())) {
-                FieldPath _idSort = obj->getFieldPath();
-
-                sortOrder.append(
-                    "_id",
-                    _inputSort.getIntField(_idSort.getFieldName(_idSort.getPathLength() - 1)));
-            }
+        // We have an expression like {_id: "$a"}. Check if this is a FieldPath, and if it is, get
+        // the sort order out of it.
+        if (auto obj = dynamic_cast<ExpressionFieldPath*>(_idExpressions[0].get())) {
+            FieldPath _idSort = obj->getFieldPath();
+
+            sortOrder.append(
+                "_id", _inputSort.getIntField(_idSort.getFieldName(_idSort.getPathLength() - 1)));
         }
-    } else if (_streaming) {
+    } else {
         // At this point, we know that _streaming is true, so _id must have only contained
         // ExpressionObjects, ExpressionConstants or ExpressionFieldPaths. We now process each
         // '_idExpression'.
@@ -749,21 +805,6 @@ BSONObjSet DocumentSourceGroup::getOutputSorts() {
 
             sortOrder.append(itr->second, _inputSort.getIntField(sortString));
         }
-    } else {
-        // We are blocking and have spilled to disk.
-        std::vector<std::string> outputSort;
-        for (size_t i = 0; i < _idFieldNames.size(); i++) {
-            intrusive_ptr<Expression> exp = _idExpressions[i];
-            if (auto obj = dynamic_cast<ExpressionObject*>(exp.get())) {
-                // _id is an object containing a nested document, such as: {_id: {x: {y: "$b"}}}.
-                getFieldPathListForSpilled(obj, "_id." + _idFieldNames[i], &outputSort);
-            } else {
-                outputSort.push_back("_id." + _idFieldNames[i]);
-            }
-        }
-        for (auto&& field : outputSort) {
-            sortOrder.append(field, 1);
-        }
     }
 
     return allPrefixes(sortOrder.obj());
@@ -786,6 +827,35 @@ Value DocumentSourceGroup::computeId(const Document& root) {
     return Value(std::move(vals));
 }
 
+Value DocumentSourceGroup::computeSortKey(const Document& root) const {
+    vector<Value> sortKey;
+    sortKey.reserve(_sortPaths.size());
+    for (auto&& path : _sortPaths) {
+        auto value = document_path_support::extractElementAlongNonArrayPath(root, path);
+        if (!value.isOK()) {
+            // An array along one of the paths. Fall back on the sort key generator, which orders
+            // arrays the same way a sort on these paths would.
+            sortKey.clear();
+            auto bsonDoc = document_path_support::documentToBsonWithPaths(root, _sortPathNames);
+            SortKeyGenerator::Metadata metadata;
+            BSONObj bsonSortKey = uassertStatusOK(_sortKeyGen->getSortKey(bsonDoc, &metadata));
+            for (auto&& keyPart : bsonSortKey) {
+                sortKey.push_back(Value(keyPart));
+            }
+            break;
+        }
+        sortKey.push_back(std::move(value.getValue()));
+    }
+
+    // A sort interleaves missing, undefined and null values, which a group key tells apart.
+    for (auto&& keyPart : sortKey) {
+        if (keyPart.nullish()) {
+            keyPart = Value(BSONNULL);
+        }
+    }
+    return Value(std::move(sortKey));
+}
+
 Value DocumentSourceGroup::expandId(const Value& val) {
     // _id doesn't get wrapped in a document
     if (_idFieldNames.empty())
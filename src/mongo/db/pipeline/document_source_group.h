@@ -29,8 +29,10 @@
 #pragma once
 
 #include <memory>
+#include <set>
 #include <utility>
 
+#include "mongo/db/index/sort_key_generator.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document_source.h"
@@ -45,6 +47,11 @@ public:
 
     static const size_t kDefaultMaxMemoryUsageBytes = 100 * 1024 * 1024;
 
+    // The number of partitions that spilled groups are hashed into, and the number of times a
+    // partition too large to re-aggregate in memory may be split again.
+    static const size_t kNumSpillPartitions = 16;
+    static const int kMaxSpillPartitionDepth = 3;
+
     // Virtuals from DocumentSource.
     boost::intrusive_ptr<DocumentSource> optimize() final;
     GetDepsReturn getDependencies(DepsTracker* deps) const final;
@@ -98,6 +105,12 @@ public:
         return _streaming;
     }
 
+    /**
+     * Returns true if this $group produces the same groups and accumulated values when any field
+     * it reads is null instead of missing, as happens when the fields are read from index keys.
+     */
+    bool treatsMissingAndNullAlike() const;
+
     // Virtuals for SplittableDocumentSource.
     boost::intrusive_ptr<DocumentSource> getShardSource() final;
     boost::intrusive_ptr<DocumentSource> getMergeSource() final;
@@ -111,8 +124,7 @@ private:
 
     /**
      * getNext() dispatches to one of these three depending on what type of $group it is. All three
-     * of these methods expect '_currentAccumulators' to have been reset before being called, and
-     * also expect initialize() to have been called already.
+     * of these methods expect initialize() to have been called already.
      */
     GetNextResult getNextStreaming();
     GetNextResult getNextSpilled();
@@ -126,9 +138,9 @@ private:
 
     /**
      * Before returning anything, this source must prepare itself. In a streaming $group,
-     * initialize() requests the first document from the previous source, and uses it to prepare the
-     * accumulators. In an unsorted $group, initialize() exhausts the previous source before
-     * returning. The '_initialized' boolean indicates that initialize() has finished.
+     * initialize() only records the input sort and does not consume any input. In an unsorted
+     * $group, initialize() exhausts the previous source before returning. The '_initialized'
+     * boolean indicates that initialize() has finished.
      *
      * This method may not be able to finish initialization in a single call if 'pSource' returns a
      * DocumentSource::GetNextResult::kPauseExecution, so it returns the last GetNextResult
@@ -137,11 +149,65 @@ private:
     GetNextResult initialize();
 
     /**
-     * Spill groups map to disk and returns an iterator to the file. Note: Since a sorted $group
-     * does not exhaust the previous stage before returning, and thus does not maintain as large a
-     * store of documents at any one time, only an unsorted group can spill to disk.
+     * Files being written for one round of partitioning. Each group goes to the partition chosen
+     * by hashing its _id together with 'depth', so all partial states for an _id land in the same
+     * partition. Writers are created when their partition receives its first group.
+     */
+    struct SpillPartitions {
+        explicit SpillPartitions(int depth) : depth(depth), writers(kNumSpillPartitions) {}
+
+        int depth;
+        std::vector<std::unique_ptr<SortedFileWriter<Value, Value>>> writers;
+    };
+
+    /**
+     * A finished partition file waiting to be re-aggregated.
+     */
+    struct SpilledPartition {
+        std::unique_ptr<Sorter<Value, Value>::Iterator> iterator;
+        int depth;
+    };
+
+    /**
+     * Spill groups map to disk, hash-partitioned into '_spillPartitions'. Note: Since a sorted
+     * $group does not exhaust the previous stage before returning, and thus does not maintain as
+     * large a store of documents at any one time, only an unsorted group can spill to disk.
+     */
+    void spill();
+
+    /**
+     * Appends the partial state of every group in '_groups' to 'partitions', then clears
+     * '_groups'.
      */
-    std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
+    void spillGroupsTo(SpillPartitions* partitions);
+
+    /**
+     * Appends the partial accumulator state 'state' for group 'id' to its partition.
+     */
+    void writeToPartition(SpillPartitions* partitions, const Value& id, const Value& state);
+
+    /**
+     * Finishes writing 'partitions' and queues each non-empty one in '_pendingPartitions'.
+     */
+    void finishSpillPartitions(SpillPartitions* partitions);
+
+    /**
+     * Re-aggregates the next pending partition into '_groups', and points 'groupsIterator' at its
+     * first group. If the partition outgrows the memory limit, it is instead split into further
+     * partitions, which are queued, and '_groups' is left empty.
+     */
+    void loadNextPartition();
+
+    /**
+     * Serializes the partial state of 'accums' for spilling. Single accumulators serialize as a
+     * single Value, and multiple accumulators as an array of Values.
+     */
+    Value serializeAccumulators(const Accumulators& accums) const;
+
+    /**
+     * Merges the spilled partial state 'state' for group 'id' into '_groups'.
+     */
+    void mergeSpilledGroup(const Value& id, const Value& state);
 
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
@@ -150,6 +216,20 @@ private:
      */
     Value computeId(const Document& root);
 
+    /**
+     * Computes the key under which the input of a streaming $group is sorted: the value of each
+     * '_inputSort' field as the preceding sort would have ordered it, with missing and undefined
+     * treated as null. Documents sharing a group key always share a sort key, so a streaming
+     * $group only needs to hold the groups of one run of equal sort keys at a time.
+     */
+    Value computeSortKey(const Document& root) const;
+
+    /**
+     * Adds 'root' to its group in '_groups', creating the group if necessary. Unless streaming,
+     * spills to disk when over the memory limit.
+     */
+    void accumulateIntoGroups(const Document& root);
+
     /**
      * Converts the internal representation of the group key to the _id shape specified by the
      * user.
@@ -168,27 +248,36 @@ private:
     bool _streaming;
     bool _initialized;
 
-    Value _currentId;
-    Accumulators _currentAccumulators;
+    // Only used when '_streaming' is true. '_groups' holds the groups of the run of input sharing
+    // '_currentSortKey', which are returned once a document with a different sort key arrives.
+    std::vector<FieldPath> _sortPaths;
+    std::set<std::string> _sortPathNames;
+    boost::optional<SortKeyGenerator> _sortKeyGen;
+    Value _currentSortKey;
+    bool _returningRun = false;
+    bool _streamingInputExhausted = false;
 
     // We use boost::optional to defer initialization until the ExpressionContext containing the
     // correct comparator is injected, since the groups must be built using the comparator's
     // definition of equality.
     boost::optional<GroupsMap> _groups;
 
-    std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _sortedFiles;
+    // The partition files groups are spilled to while consuming the input.
+    boost::optional<SpillPartitions> _spillPartitions;
+    int _numSpills = 0;
     bool _spilled;
 
-    // Only used when '_spilled' is false.
+    // Iterates '_groups', which holds either all groups, the groups of the partition currently
+    // being returned if '_spilled' is true, or the groups of the current run if '_streaming' is.
     GroupsMap::iterator groupsIterator;
 
-    // Only used when '_spilled' is true.
-    std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
+    // Only used when '_spilled' is true. Partitions not yet re-aggregated.
+    std::vector<SpilledPartition> _pendingPartitions;
     const bool _allowDiskUse;
 
-    std::pair<Value, Value> _firstPartOfNextGroup;
-    // Only used when '_sorted' is true.
-    boost::optional<Document> _firstDocOfNextGroup;
+    // Only used when '_streaming' is true. The first document of the next run, held back while the
+    // groups of the current run are returned.
+    boost::optional<Document> _firstDocOfNextRun;
 };
 
 }  // namespace mongo
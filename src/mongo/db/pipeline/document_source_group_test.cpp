@@ -28,6 +28,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <boost/intrusive_ptr.hpp>
 #include <deque>
 #include <map>
@@ -38,6 +39,7 @@
 #include "mongo/bson/bsonmisc.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/json.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/pipeline/aggregation_context_fixture.h"
 #include "mongo/db/pipeline/aggregation_request.h"
 #include "mongo/db/pipeline/dependencies.h"
@@ -189,6 +191,175 @@ TEST_F(DocumentSourceGroupTest, ShouldCorrectlyTrackMemoryUsageBetweenPauses) {
     ASSERT_THROWS_CODE(group->getNext(), AssertionException, 16945);
 }
 
+TEST_F(DocumentSourceGroupTest, ShouldReaggregateSpilledPartitionsCorrectly) {
+    auto expCtx = getExpCtx();
+
+    // Allow the $group stage to spill to disk, with a memory limit small enough that every
+    // partition must also be split again while being re-aggregated.
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 1000;
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement countStatement{"count",
+                                         ExpressionConstant::create(expCtx, Value(1)),
+                                         AccumulationStatement::getFactory("$sum")};
+    AccumulationStatement firstStatement{"first",
+                                         ExpressionFieldPath::parse(expCtx, "$seq", vps),
+                                         AccumulationStatement::getFactory("$first")};
+    AccumulationStatement lastStatement{"last",
+                                        ExpressionFieldPath::parse(expCtx, "$seq", vps),
+                                        AccumulationStatement::getFactory("$last")};
+    AccumulationStatement pushStatement{"strs",
+                                        ExpressionFieldPath::parse(expCtx, "$str", vps),
+                                        AccumulationStatement::getFactory("$push")};
+    auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$key", vps);
+    auto group = DocumentSourceGroup::create(expCtx,
+                                             groupByExpression,
+                                             {countStatement, firstStatement, lastStatement,
+                                              pushStatement},
+                                             maxMemoryUsageBytes);
+
+    const int numGroups = 50;
+    const int docsPerGroup = 6;
+    const string str(50, 'x');
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int seq = 0; seq < numGroups * docsPerGroup; ++seq) {
+        inputs.push_back(Document{{"key", seq % numGroups}, {"seq", seq}, {"str", str}});
+    }
+    auto mock = DocumentSourceMock::create(std::move(inputs));
+    group->setSource(mock.get());
+
+    stdx::unordered_set<int> keys;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        const int key = doc["_id"].coerceToInt();
+        ASSERT_TRUE(keys.insert(key).second);
+        ASSERT_VALUE_EQ(doc["count"], Value(docsPerGroup));
+        // Partial states are merged in the order they were accumulated.
+        ASSERT_VALUE_EQ(doc["first"], Value(key));
+        ASSERT_VALUE_EQ(doc["last"], Value(key + (docsPerGroup - 1) * numGroups));
+        ASSERT_EQ(doc["strs"].getArrayLength(), static_cast<size_t>(docsPerGroup));
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+    ASSERT_EQ(keys.size(), static_cast<size_t>(numGroups));
+
+    // Groups come back one hash partition at a time, so there is no output sort.
+    ASSERT_EQ(group->getOutputSorts().size(), 0U);
+}
+
+TEST_F(DocumentSourceGroupTest, StreamingGroupShouldPreservePausesBetweenGroups) {
+    auto expCtx = getExpCtx();
+    auto group = DocumentSourceGroup::createFromBson(
+        fromjson("{$group: {_id: '$a', count: {$sum: 1}}}").firstElement(), expCtx);
+    auto mock = DocumentSourceMock::create({Document{{"a", 1}},
+                                            DocumentSource::GetNextResult::makePauseExecution(),
+                                            Document{{"a", 1}},
+                                            Document{{"a", 2}},
+                                            DocumentSource::GetNextResult::makePauseExecution(),
+                                            Document{{"a", 3}}});
+    mock->sorts = {BSON("a" << 1)};
+    group->setSource(mock.get());
+
+    ASSERT_TRUE(group->getNext().isPaused());
+    ASSERT_TRUE(static_cast<DocumentSourceGroup*>(group.get())->isStreaming());
+
+    auto result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_DOCUMENT_EQ(result.releaseDocument(), (Document{{"_id", 1}, {"count", 2}}));
+
+    ASSERT_TRUE(group->getNext().isPaused());
+
+    result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_DOCUMENT_EQ(result.releaseDocument(), (Document{{"_id", 2}, {"count", 1}}));
+
+    result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_DOCUMENT_EQ(result.releaseDocument(), (Document{{"_id", 3}, {"count", 1}}));
+
+    ASSERT_TRUE(group->getNext().isEOF());
+    ASSERT_TRUE(group->getNext().isEOF());
+}
+
+TEST_F(DocumentSourceGroupTest, StreamingGroupShouldMatchBlockingGroupOnNullishAndArrayKeys) {
+    auto expCtx = getExpCtx();
+    const BSONObj spec = fromjson("{$group: {_id: '$a', count: {$sum: 1}, seqs: {$push: '$seq'}}}");
+
+    // Ordered the way an ascending sort on 'a' would order them: missing, undefined and null sort
+    // equal, and an array sorts by its smallest element.
+    const vector<BSONObj> inputs = {fromjson("{seq: 0, a: null}"),
+                                    fromjson("{seq: 1}"),
+                                    BSON("seq" << 2 << "a" << BSONUndefined),
+                                    fromjson("{seq: 3, a: null}"),
+                                    fromjson("{seq: 4, a: [1, 2]}"),
+                                    fromjson("{seq: 5, a: 1}"),
+                                    fromjson("{seq: 6, a: [1, 2]}"),
+                                    fromjson("{seq: 7, a: 2}"),
+                                    fromjson("{seq: 8, a: [3, 2]}"),
+                                    fromjson("{seq: 9, a: 2}"),
+                                    fromjson("{seq: 10, a: 4}")};
+
+    auto runGroup = [&](bool sorted) {
+        auto group = DocumentSourceGroup::createFromBson(spec.firstElement(), expCtx);
+        deque<DocumentSource::GetNextResult> mockInputs;
+        for (auto&& input : inputs) {
+            mockInputs.push_back(Document(input));
+        }
+        auto mock = DocumentSourceMock::create(std::move(mockInputs));
+        if (sorted) {
+            mock->sorts = {BSON("a" << 1)};
+        }
+        group->setSource(mock.get());
+
+        vector<BSONObj> results;
+        for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+            results.push_back(result.releaseDocument().toBson());
+        }
+        ASSERT_EQ(static_cast<DocumentSourceGroup*>(group.get())->isStreaming(), sorted);
+        return results;
+    };
+
+    auto streamingResults = runGroup(true);
+    auto blockingResults = runGroup(false);
+
+    // The last run of input holds a single group, which must be returned last.
+    ASSERT_FALSE(streamingResults.empty());
+    ASSERT_BSONOBJ_EQ(streamingResults.back(), fromjson("{_id: 4, count: 1, seqs: [10]}"));
+
+    auto lessThan = SimpleBSONObjComparator::kInstance.makeLessThan();
+    std::sort(streamingResults.begin(), streamingResults.end(), lessThan);
+    std::sort(blockingResults.begin(), blockingResults.end(), lessThan);
+    ASSERT_EQ(streamingResults.size(), blockingResults.size());
+    for (size_t i = 0; i < streamingResults.size(); ++i) {
+        ASSERT_BSONOBJ_EQ(streamingResults[i], blockingResults[i]);
+    }
+}
+
+TEST_F(DocumentSourceGroupTest, TreatsMissingAndNullAlikeOnlyForNullishInsensitiveGroups) {
+    auto treatsMissingAndNullAlike = [&](const char* spec) {
+        auto group =
+            DocumentSourceGroup::createFromBson(fromjson(spec).firstElement(), getExpCtx());
+        return static_cast<DocumentSourceGroup*>(group.get())->treatsMissingAndNullAlike();
+    };
+
+    ASSERT_TRUE(treatsMissingAndNullAlike("{$group: {_id: '$a', n: {$sum: 1}}}"));
+    ASSERT_TRUE(
+        treatsMissingAndNullAlike("{$group: {_id: null, s: {$sum: '$b'}, a: {$avg: '$b'}}}"));
+    ASSERT_TRUE(treatsMissingAndNullAlike(
+        "{$group: {_id: {x: '$a'}, lo: {$min: '$b'}, hi: {$max: '$b'}, sd: {$stdDevPop: '$b'}}}"));
+
+    ASSERT_FALSE(treatsMissingAndNullAlike("{$group: {_id: {x: '$a', y: '$b'}}}"));
+    ASSERT_FALSE(treatsMissingAndNullAlike("{$group: {_id: {$type: '$a'}}}"));
+    ASSERT_FALSE(treatsMissingAndNullAlike("{$group: {_id: '$a', b: {$push: '$b'}}}"));
+    ASSERT_FALSE(treatsMissingAndNullAlike("{$group: {_id: '$a', b: {$addToSet: '$b'}}}"));
+    ASSERT_FALSE(treatsMissingAndNullAlike("{$group: {_id: '$a', b: {$first: '$b'}}}"));
+    ASSERT_FALSE(treatsMissingAndNullAlike("{$group: {_id: '$a', b: {$last: '$b'}}}"));
+    ASSERT_FALSE(
+        treatsMissingAndNullAlike("{$group: {_id: '$a', n: {$sum: {$ifNull: ['$b', 1]}}}}"));
+}
+
 BSONObj toBson(const intrusive_ptr<DocumentSource>& source) {
     vector<Value> arr;
     source->serializeToArray(arr);
@@ -1156,8 +1327,6 @@ public:
         add<Dependencies>();
         add<StringConstantIdAndAccumulatorExpressions>();
         add<ArrayConstantAccumulatorExpression>();
-#if 0
-        // Disabled tests until SERVER-23318 is implemented.
         add<StreamingOptimization>();
         add<StreamingWithMultipleIdFields>();
         add<NoOptimizationIfMissingDoubleSort>();
@@ -1169,7 +1338,6 @@ public:
         add<StreamingWithRootSubfield>();
         add<StreamingWithConstantAndFieldPath>();
         add<StreamingWithFieldRepeated>();
-#endif
     }
 };
 
@@ -0,0 +1,248 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_internal_unpack_bucket.h"
+
+#include "mongo/base/parse_number.h"
+#include "mongo/db/pipeline/document_source_match.h"
+#include "mongo/db/pipeline/lite_parsed_document_source.h"
+
+namespace mongo {
+
+REGISTER_DOCUMENT_SOURCE(_internalUnpackBucket,
+                         LiteParsedDocumentSourceDefault::parse,
+                         DocumentSourceInternalUnpackBucket::createFromBson);
+
+constexpr StringData DocumentSourceInternalUnpackBucket::kStageName;
+
+void BucketUnpacker::reset(const Document& bucket) {
+    _meta = bucket[TimeseriesOptions::kBucketMetaFieldName];
+    _timeColumn.clear();
+    _columns.clear();
+    _position = _timeColumn.end();
+
+    auto data = bucket[TimeseriesOptions::kBucketDataFieldName];
+    if (data.missing()) {
+        return;
+    }
+    uassert(40661,
+            str::stream() << "bucket field '" << TimeseriesOptions::kBucketDataFieldName
+                          << "' must be an object",
+            data.getType() == BSONType::Object);
+
+    FieldIterator columns(data.getDocument());
+    while (columns.more()) {
+        auto column = columns.next();
+        uassert(40662,
+                str::stream() << "bucket column '" << column.first << "' must be an object",
+                column.second.getType() == BSONType::Object);
+
+        Column values;
+        FieldIterator it(column.second.getDocument());
+        while (it.more()) {
+            auto value = it.next();
+            int position;
+            uassert(40663,
+                    str::stream() << "invalid position '" << value.first << "' in bucket column '"
+                                  << column.first
+                                  << "'",
+                    parseNumberFromStringWithBase(value.first, 10, &position).isOK() &&
+                        position >= 0);
+            values.emplace(position, value.second);
+        }
+
+        if (column.first == _options.timeField) {
+            _timeColumn = std::move(values);
+        } else if (column.first == "_id") {
+            _columns.emplace(_columns.begin(), column.first.toString(), std::move(values));
+        } else {
+            _columns.emplace_back(column.first.toString(), std::move(values));
+        }
+    }
+    _position = _timeColumn.begin();
+}
+
+Document BucketUnpacker::getNext() {
+    invariant(hasNext());
+
+    MutableDocument measurement;
+    auto appendColumn = [&](const std::pair<std::string, Column>& column) {
+        auto value = column.second.find(_position->first);
+        if (value != column.second.end()) {
+            measurement.addField(column.first, value->second);
+        }
+    };
+
+    auto columnIt = _columns.begin();
+    if (columnIt != _columns.end() && columnIt->first == "_id") {
+        appendColumn(*columnIt++);
+    }
+    measurement.addField(_options.timeField, _position->second);
+    if (_options.metaField && !_meta.missing()) {
+        measurement.addField(*_options.metaField, _meta);
+    }
+    for (; columnIt != _columns.end(); ++columnIt) {
+        appendColumn(*columnIt);
+    }
+
+    ++_position;
+    return measurement.freeze();
+}
+
+boost::intrusive_ptr<DocumentSource> DocumentSourceInternalUnpackBucket::createFromBson(
+    BSONElement elem, const boost::intrusive_ptr<ExpressionContext>& expCtx) {
+    uassert(ErrorCodes::TypeMismatch,
+            str::stream() << "$_internalUnpackBucket must take a nested object but found: "
+                          << elem,
+            elem.type() == BSONType::Object);
+
+    return new DocumentSourceInternalUnpackBucket(
+        expCtx, uassertStatusOK(TimeseriesOptions::parse(elem.embeddedObject())));
+}
+
+DocumentSourceInternalUnpackBucket::DocumentSourceInternalUnpackBucket(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx, TimeseriesOptions options)
+    : DocumentSource(expCtx), _options(options), _unpacker(std::move(options)) {}
+
+DocumentSource::GetNextResult DocumentSourceInternalUnpackBucket::getNext() {
+    pExpCtx->checkForInterrupt();
+
+    while (!_unpacker.hasNext()) {
+        auto nextBucket = pSource->getNext();
+        if (!nextBucket.isAdvanced()) {
+            return nextBucket;
+        }
+        _unpacker.reset(nextBucket.releaseDocument());
+    }
+    return _unpacker.getNext();
+}
+
+void DocumentSourceInternalUnpackBucket::appendBucketLevelPredicates(const BSONObj& query,
+                                                                     BSONArrayBuilder* out) const {
+    const std::string controlSuffix = "." + _options.timeField;
+    const std::string minTimePath = TimeseriesOptions::kBucketControlFieldName + "." +
+        TimeseriesOptions::kControlMinFieldName + controlSuffix;
+    const std::string maxTimePath = TimeseriesOptions::kBucketControlFieldName + "." +
+        TimeseriesOptions::kControlMaxFieldName + controlSuffix;
+
+    for (auto&& predicate : query) {
+        const auto path = predicate.fieldNameStringData();
+
+        if (path == "$and" && predicate.type() == BSONType::Array) {
+            for (auto&& conjunct : predicate.Obj()) {
+                if (conjunct.type() == BSONType::Object) {
+                    appendBucketLevelPredicates(conjunct.Obj(), out);
+                }
+            }
+            continue;
+        }
+
+        // Every measurement of a bucket has the bucket's meta value, so predicates on it carry
+        // over unchanged.
+        if (_options.metaField &&
+            (path == *_options.metaField || path.startsWith(*_options.metaField + "."))) {
+            BSONObjBuilder bucketPredicate(out->subobjStart());
+            bucketPredicate.appendAs(predicate,
+                                     TimeseriesOptions::kBucketMetaFieldName.toString() +
+                                         path.substr(_options.metaField->size()));
+            continue;
+        }
+
+        if (path != _options.timeField) {
+            continue;
+        }
+
+        // A bucket can only hold a measurement in a time range if its own range overlaps it.
+        // Comparisons with anything but a date never match a date, so they are left to the
+        // $match on measurements.
+        auto appendBound = [&](StringData boundPath, StringData op, const BSONElement& time) {
+            out->append(BSON(boundPath << BSON(op << time.Date())));
+        };
+        const bool isOperatorObject = predicate.type() == BSONType::Object &&
+            predicate.Obj().firstElementFieldName()[0] == '$';
+        if (!isOperatorObject) {
+            if (predicate.type() == BSONType::Date) {
+                appendBound(minTimePath, "$lte", predicate);
+                appendBound(maxTimePath, "$gte", predicate);
+            }
+            continue;
+        }
+        for (auto&& op : predicate.Obj()) {
+            if (op.type() != BSONType::Date) {
+                continue;
+            }
+            const auto opName = op.fieldNameStringData();
+            if (opName == "$gt" || opName == "$gte") {
+                appendBound(maxTimePath, opName, op);
+            } else if (opName == "$lt" || opName == "$lte") {
+                appendBound(minTimePath, opName, op);
+            } else if (opName == "$eq") {
+                appendBound(minTimePath, "$lte", op);
+                appendBound(maxTimePath, "$gte", op);
+            }
+        }
+    }
+}
+
+BSONObj DocumentSourceInternalUnpackBucket::makeBucketLevelPredicate(const BSONObj& query) const {
+    BSONArrayBuilder predicates;
+    appendBucketLevelPredicates(query, &predicates);
+    if (predicates.arrSize() == 0) {
+        return BSONObj();
+    }
+    return BSON("$and" << predicates.arr());
+}
+
+Pipeline::SourceContainer::iterator DocumentSourceInternalUnpackBucket::doOptimizeAt(
+    Pipeline::SourceContainer::iterator itr, Pipeline::SourceContainer* container) {
+    invariant(*itr == this);
+
+    auto nextMatch = dynamic_cast<DocumentSourceMatch*>((*std::next(itr)).get());
+    if (_addedBucketLevelMatch || !nextMatch || nextMatch->isTextQuery()) {
+        return std::next(itr);
+    }
+
+    // The $match on measurements stays after this stage, since the bucket-level predicate only
+    // narrows down the buckets which may hold matching measurements.
+    auto bucketPredicate = makeBucketLevelPredicate(nextMatch->getQuery());
+    if (bucketPredicate.isEmpty()) {
+        return std::next(itr);
+    }
+    _addedBucketLevelMatch = true;
+    container->insert(itr, DocumentSourceMatch::create(bucketPredicate, pExpCtx));
+    return std::next(itr);
+}
+
+Value DocumentSourceInternalUnpackBucket::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    return Value(Document{{getSourceName(), Value(_options.toBSON())}});
+}
+
+}  // namespace mongo
@@ -0,0 +1,124 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/timeseries/timeseries_options.h"
+
+namespace mongo {
+
+/**
+ * Turns a bucket of a time-series collection back into the measurements stored in it, in time
+ * order. Each measurement has its _id, its time, its meta value and then its remaining fields.
+ */
+class BucketUnpacker {
+public:
+    explicit BucketUnpacker(TimeseriesOptions options) : _options(std::move(options)) {}
+
+    /**
+     * Starts unpacking 'bucket', dropping whatever remained of the previous one.
+     */
+    void reset(const Document& bucket);
+
+    bool hasNext() const {
+        return _position != _timeColumn.end();
+    }
+
+    /**
+     * Returns the next measurement of the bucket. Requires hasNext().
+     */
+    Document getNext();
+
+private:
+    using Column = std::map<int, Value>;
+
+    const TimeseriesOptions _options;
+
+    Value _meta;
+    Column _timeColumn;
+    std::vector<std::pair<std::string, Column>> _columns;
+    Column::const_iterator _position = _timeColumn.end();
+};
+
+/**
+ * The stage defining time-series views: unpacks each bucket it reads from the buckets collection
+ * into its measurements. When followed by a $match, it adds a $match in front of itself which
+ * selects buckets by meta value and time range, so that the buckets' index can be used.
+ */
+class DocumentSourceInternalUnpackBucket final : public DocumentSource {
+public:
+    static constexpr StringData kStageName = TimeseriesOptions::kUnpackBucketStageName;
+
+    static boost::intrusive_ptr<DocumentSource> createFromBson(
+        BSONElement elem, const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
+    DocumentSourceInternalUnpackBucket(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                       TimeseriesOptions options);
+
+    const char* getSourceName() const final {
+        return kStageName.rawData();
+    }
+
+    StageConstraints constraints() const final {
+        return {StreamType::kStreaming,
+                PositionRequirement::kNone,
+                HostTypeRequirement::kNone,
+                DiskUseRequirement::kNoDiskUse,
+                FacetRequirement::kAllowed};
+    }
+
+    GetNextResult getNext() final;
+
+    /**
+     * Returns the predicate on buckets implied by the predicate 'query' on measurements, or an
+     * empty object if 'query' does not constrain the meta value or the time.
+     */
+    BSONObj makeBucketLevelPredicate(const BSONObj& query) const;
+
+    Pipeline::SourceContainer::iterator doOptimizeAt(Pipeline::SourceContainer::iterator itr,
+                                                     Pipeline::SourceContainer* container) final;
+
+private:
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
+
+    void appendBucketLevelPredicates(const BSONObj& query, BSONArrayBuilder* out) const;
+
+    const TimeseriesOptions _options;
+    BucketUnpacker _unpacker;
+
+    // Whether a bucket-level $match has already been added in front of this stage.
+    bool _addedBucketLevelMatch = false;
+};
+
+}  // namespace mongo
@@ -0,0 +1,188 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bsonmisc.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/pipeline/aggregation_context_fixture.h"
+#include "mongo/db/pipeline/document_source_internal_unpack_bucket.h"
+#include "mongo/db/pipeline/document_source_match.h"
+#include "mongo/db/pipeline/document_source_mock.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using DocumentSourceInternalUnpackBucketTest = AggregationContextFixture;
+
+const BSONObj kSpec = BSON("$_internalUnpackBucket" << BSON("timeField"
+                                                            << "t"
+                                                            << "metaField"
+                                                            << "tag"));
+
+Date_t at(long long millis) {
+    return Date_t::fromMillisSinceEpoch(millis);
+}
+
+boost::intrusive_ptr<DocumentSource> makeUnpackStage(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx) {
+    return DocumentSourceInternalUnpackBucket::createFromBson(kSpec.firstElement(), expCtx);
+}
+
+TEST_F(DocumentSourceInternalUnpackBucketTest, UnpacksMeasurementsInTimeOrder) {
+    auto unpack = makeUnpackStage(getExpCtx());
+    auto source = DocumentSourceMock::create(Document(
+        BSON("_id" << OID::gen() << "meta"
+                   << "a"
+                   << "data"
+                   << BSON("_id" << BSON("0" << 1 << "1" << 2) << "t"
+                                 << BSON("1" << at(2) << "0" << at(1))
+                                 << "x"
+                                 << BSON("0" << 10)))));
+    unpack->setSource(source.get());
+
+    auto next = unpack->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(Document(BSON("_id" << 1 << "t" << at(1) << "tag"
+                                           << "a"
+                                           << "x"
+                                           << 10)),
+                       next.releaseDocument());
+
+    next = unpack->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(Document(BSON("_id" << 2 << "t" << at(2) << "tag"
+                                           << "a")),
+                       next.releaseDocument());
+
+    ASSERT_TRUE(unpack->getNext().isEOF());
+}
+
+TEST_F(DocumentSourceInternalUnpackBucketTest, SkipsEmptyBucketsAndOmitsMissingMeta) {
+    auto unpack = makeUnpackStage(getExpCtx());
+    auto source = DocumentSourceMock::create(
+        {Document(BSON("_id" << OID::gen())),
+         Document(BSON("_id" << OID::gen() << "data" << BSON("t" << BSON("0" << at(5)))))});
+    unpack->setSource(source.get());
+
+    auto next = unpack->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(Document(BSON("t" << at(5))), next.releaseDocument());
+    ASSERT_TRUE(unpack->getNext().isEOF());
+}
+
+TEST_F(DocumentSourceInternalUnpackBucketTest, RejectsInvalidPositions) {
+    auto unpack = makeUnpackStage(getExpCtx());
+    auto source = DocumentSourceMock::create(
+        Document(BSON("_id" << OID::gen() << "data" << BSON("t" << BSON("x" << at(5))))));
+    unpack->setSource(source.get());
+    ASSERT_THROWS_CODE(unpack->getNext(), AssertionException, 40663);
+}
+
+TEST_F(DocumentSourceInternalUnpackBucketTest, RejectsSpecWithoutTimeField) {
+    auto spec = BSON("$_internalUnpackBucket" << BSON("metaField"
+                                                      << "tag"));
+    ASSERT_THROWS(
+        DocumentSourceInternalUnpackBucket::createFromBson(spec.firstElement(), getExpCtx()),
+        AssertionException);
+}
+
+TEST_F(DocumentSourceInternalUnpackBucketTest, SerializesToItsSpec) {
+    auto unpack = makeUnpackStage(getExpCtx());
+    std::vector<Value> serialized;
+    unpack->serializeToArray(serialized);
+    ASSERT_EQ(1U, serialized.size());
+    ASSERT_VALUE_EQ(Value(Document(BSON("$_internalUnpackBucket" << BSON(
+                                            "timeField"
+                                            << "t"
+                                            << "metaField"
+                                            << "tag"
+                                            << "bucketMaxSpanSeconds"
+                                            << TimeseriesOptions::kDefaultBucketMaxSpanSeconds)))),
+                    serialized[0]);
+}
+
+TEST_F(DocumentSourceInternalUnpackBucketTest, MapsMetaAndTimePredicatesToBuckets) {
+    auto unpack = makeUnpackStage(getExpCtx());
+    auto predicate = static_cast<DocumentSourceInternalUnpackBucket*>(unpack.get())
+                         ->makeBucketLevelPredicate(BSON("tag.id" << 3 << "t"
+                                                                  << BSON("$gte" << at(5) << "$lt"
+                                                                                 << at(9))
+                                                                  << "x"
+                                                                  << 1));
+    ASSERT_BSONOBJ_EQ(BSON("$and" << BSON_ARRAY(BSON("meta.id" << 3)
+                                                << BSON("control.max.t" << BSON("$gte" << at(5)))
+                                                << BSON("control.min.t" << BSON("$lt" << at(9))))),
+                      predicate);
+}
+
+TEST_F(DocumentSourceInternalUnpackBucketTest, MapsTimeEqualityToBothBounds) {
+    auto unpack = makeUnpackStage(getExpCtx());
+    auto predicate = static_cast<DocumentSourceInternalUnpackBucket*>(unpack.get())
+                         ->makeBucketLevelPredicate(BSON("$and" << BSON_ARRAY(BSON("t" << at(5)))));
+    ASSERT_BSONOBJ_EQ(BSON("$and" << BSON_ARRAY(BSON("control.min.t" << BSON("$lte" << at(5)))
+                                                << BSON("control.max.t" << BSON("$gte" << at(5))))),
+                      predicate);
+}
+
+TEST_F(DocumentSourceInternalUnpackBucketTest, IgnoresPredicatesOnOtherFields) {
+    auto unpack = makeUnpackStage(getExpCtx());
+    auto predicate =
+        static_cast<DocumentSourceInternalUnpackBucket*>(unpack.get())
+            ->makeBucketLevelPredicate(BSON("x" << 1 << "t" << BSON("$gt" << 5) << "$or"
+                                                << BSON_ARRAY(BSON("tag" << 1) << BSON("y" << 2))));
+    ASSERT_BSONOBJ_EQ(BSONObj(), predicate);
+}
+
+TEST_F(DocumentSourceInternalUnpackBucketTest, AddsBucketLevelMatchOnce) {
+    Pipeline::SourceContainer container;
+    auto unpack = makeUnpackStage(getExpCtx());
+    auto match = DocumentSourceMatch::create(BSON("tag"
+                                                  << "a"),
+                                             getExpCtx());
+    container.push_back(unpack);
+    container.push_back(match);
+
+    unpack->optimizeAt(container.begin(), &container);
+    ASSERT_EQ(3U, container.size());
+    auto bucketMatch = dynamic_cast<DocumentSourceMatch*>(container.front().get());
+    ASSERT(bucketMatch);
+    ASSERT_BSONOBJ_EQ(BSON("$and" << BSON_ARRAY(BSON("meta"
+                                                     << "a"))),
+                      bucketMatch->getQuery());
+    ASSERT_EQ(match.get(), container.back().get());
+
+    unpack->optimizeAt(std::next(container.begin()), &container);
+    ASSERT_EQ(3U, container.size());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -30,9 +30,13 @@
 
 #include "mongo/db/pipeline/document_source_lookup.h"
 
+#include <algorithm>
+#include <cctype>
+
 #include "mongo/base/init.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression_algo.h"
+#include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/document_path_support.h"
 #include "mongo/db/pipeline/expression.h"
@@ -193,6 +197,69 @@ BSONObj buildEqualityOrQuery(const std::string& fieldName, const BSONArray& valu
     return orBuilder.obj();
 }
 
+/**
+ * Returns true if no component of 'path' is numeric. A numeric component may also index into an
+ * array, which the hash join's key extraction does not model.
+ */
+bool canHashJoinOnPath(const FieldPath& path) {
+    for (size_t i = 0; i < path.getPathLength(); ++i) {
+        auto fieldName = path.getFieldName(i);
+        if (std::all_of(fieldName.begin(), fieldName.end(), [](char c) { return isdigit(c); })) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void appendLeafJoinKey(const BSONElement& elem, std::vector<Value>* keys) {
+    keys->emplace_back(elem);
+    // An equality match on null also matches undefined.
+    if (elem.type() == BSONType::Undefined) {
+        keys->emplace_back(BSONNULL);
+    }
+}
+
+/**
+ * Appends to 'keys' every value that an equality predicate on 'path' could match in 'obj',
+ * starting at path component 'depth'. This may include keys the predicate would not actually
+ * match, so callers must confirm each candidate with the predicate itself, but it never omits one
+ * the predicate would match.
+ */
+void appendJoinKeys(const BSONObj& obj,
+                    const FieldPath& path,
+                    size_t depth,
+                    std::vector<Value>* keys) {
+    auto elem = obj[path.getFieldName(depth)];
+    if (elem.eoo()) {
+        keys->emplace_back(BSONNULL);
+        return;
+    }
+
+    if (depth + 1 == path.getPathLength()) {
+        appendLeafJoinKey(elem, keys);
+        if (elem.type() == BSONType::Array) {
+            for (auto&& arrayElem : elem.Obj()) {
+                appendLeafJoinKey(arrayElem, keys);
+            }
+        }
+        return;
+    }
+
+    if (elem.type() == BSONType::Object) {
+        appendJoinKeys(elem.embeddedObject(), path, depth + 1, keys);
+    } else if (elem.type() == BSONType::Array) {
+        // Array elements that are not objects, or that lack the rest of the path, match null.
+        keys->emplace_back(BSONNULL);
+        for (auto&& arrayElem : elem.Obj()) {
+            if (arrayElem.type() == BSONType::Object) {
+                appendJoinKeys(arrayElem.embeddedObject(), path, depth + 1, keys);
+            }
+        }
+    } else {
+        keys->emplace_back(BSONNULL);
+    }
+}
+
 }  // namespace
 
 DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
@@ -202,7 +269,8 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
         return unwindResult();
     }
 
-    auto nextInput = pSource->getNext();
+    boost::optional<std::vector<Document>> matches;
+    auto nextInput = getNextInput(&matches);
     if (!nextInput.isAdvanced()) {
         return nextInput;
     }
@@ -220,20 +288,29 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
         _resolvedPipeline.back() = matchStage;
     }
 
-    auto pipeline = buildPipeline(inputDoc);
-
     std::vector<Value> results;
     int objsize = 0;
 
-    while (auto result = pipeline->getNext()) {
-        objsize += result->getApproximateSize();
+    auto appendResult = [&](Document result) {
+        objsize += result.getApproximateSize();
         uassert(4568,
                 str::stream() << "Total size of documents in " << _fromNs.coll()
                               << " matching pipeline "
                               << getUserPipelineDefinition()
                               << " exceeds maximum document size",
                 objsize <= BSONObjMaxInternalSize);
-        results.emplace_back(std::move(*result));
+        results.emplace_back(std::move(result));
+    };
+
+    if (matches) {
+        for (auto&& result : *matches) {
+            appendResult(std::move(result));
+        }
+    } else {
+        auto pipeline = buildPipeline(inputDoc);
+        while (auto result = pipeline->getNext()) {
+            appendResult(std::move(*result));
+        }
     }
 
     MutableDocument output(std::move(inputDoc));
@@ -241,6 +318,199 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
     return output.freeze();
 }
 
+DocumentSource::GetNextResult DocumentSourceLookUp::getNextInput(
+    boost::optional<std::vector<Document>>* matches) {
+    matches->reset();
+
+    if (_batchPosition == _batch.size()) {
+        if (_batchPendingResult) {
+            auto pendingResult = std::move(*_batchPendingResult);
+            _batchPendingResult = boost::none;
+            return pendingResult;
+        }
+
+        auto nextInput = pSource->getNext();
+        if (!nextInput.isAdvanced()) {
+            return nextInput;
+        }
+
+        maybeBuildHashJoinTable();
+        if (_hashJoinTable) {
+            *matches = probeHashJoinTable(*_hashJoinTable, nextInput.getDocument());
+            return nextInput;
+        }
+
+        const long long batchSize = internalDocumentSourceLookupBatchSize.load();
+        if (wasConstructedWithPipelineSyntax() || _batchingAbandoned || batchSize <= 1) {
+            return nextInput;
+        }
+
+        fillBatch(nextInput.releaseDocument(), batchSize);
+    }
+
+    auto& batchedInput = _batch[_batchPosition++];
+    *matches = std::move(batchedInput.matches);
+    return std::move(batchedInput.doc);
+}
+
+void DocumentSourceLookUp::fillBatch(Document firstInput, size_t batchSize) {
+    // Leave plenty of room below the maximum BSON size for the rest of the batched query.
+    const int kMaxLocalValuesBytes = BSONObjMaxUserSize / 2;
+
+    _batch.clear();
+    _batchPosition = 0;
+
+    BSONArrayBuilder localValues;
+    bool containsRegex = false;
+    auto addToBatch = [&](Document input) {
+        appendLocalFieldValues(input, *_localField, &localValues, &containsRegex);
+        _batch.push_back({std::move(input), boost::none});
+    };
+
+    addToBatch(std::move(firstInput));
+    while (_batch.size() < batchSize && localValues.len() < kMaxLocalValuesBytes) {
+        auto nextInput = pSource->getNext();
+        if (!nextInput.isAdvanced()) {
+            _batchPendingResult = std::move(nextInput);
+            break;
+        }
+        addToBatch(nextInput.releaseDocument());
+    }
+
+    if (_batch.size() == 1) {
+        // Nothing to gain over querying for the document on its own.
+        return;
+    }
+
+    const auto localValuesSize = localValues.arrSize();
+    auto batchPipeline = _resolvedPipeline;
+    batchPipeline.back() = makeMatchStageFromValues(localValues.arr(),
+                                                    localValuesSize,
+                                                    containsRegex,
+                                                    _foreignField->fullPath(),
+                                                    _additionalFilter.value_or(BSONObj()));
+    copyVariablesToExpCtx(_variables, _variablesParseState, _fromExpCtx.get());
+    auto pipeline = uassertStatusOK(_mongod->makePipeline(batchPipeline, _fromExpCtx));
+
+    // Partition the results back to the input documents through a hash table, as for a hash join.
+    const size_t maxMemoryBytes = internalDocumentSourceLookupHashJoinMaxMemoryBytes.load();
+    HashJoinTable table(_fromExpCtx->getValueComparator());
+    while (auto result = pipeline->getNext()) {
+        addToHashJoinTable(result->toBson(), *_foreignField, &table);
+        if (table.memoryUsageBytes > maxMemoryBytes) {
+            _batchingAbandoned = true;
+            return;
+        }
+    }
+
+    for (auto&& batchedInput : _batch) {
+        batchedInput.matches = probeHashJoinTable(table, batchedInput.doc);
+    }
+}
+
+void DocumentSourceLookUp::maybeBuildHashJoinTable() {
+    if (_hashJoinDecided) {
+        return;
+    }
+    _hashJoinDecided = true;
+
+    const long long maxMemoryBytes = internalDocumentSourceLookupHashJoinMaxMemoryBytes.load();
+    if (wasConstructedWithPipelineSyntax() || maxMemoryBytes <= 0 ||
+        !canHashJoinOnPath(*_foreignField)) {
+        return;
+    }
+
+    // Check the foreign collection's data size first, so that we never start scanning a collection
+    // that could not fit. If the stats are unavailable, stick with per-document queries.
+    BSONObjBuilder statsBuilder;
+    if (!_mongod->appendStorageStats(_resolvedNs, BSONObj(), &statsBuilder).isOK() ||
+        statsBuilder.asTempObj()["size"].safeNumberLong() > maxMemoryBytes) {
+        return;
+    }
+
+    // Scan the foreign collection once, applying any $match absorbed from later in the pipeline.
+    auto scanPipeline = _resolvedPipeline;
+    scanPipeline.back() = BSON("$match" << _additionalFilter.value_or(BSONObj()));
+    copyVariablesToExpCtx(_variables, _variablesParseState, _fromExpCtx.get());
+    auto pipeline = uassertStatusOK(_mongod->makePipeline(scanPipeline, _fromExpCtx));
+
+    HashJoinTable table(_fromExpCtx->getValueComparator());
+    while (auto result = pipeline->getNext()) {
+        addToHashJoinTable(result->toBson(), *_foreignField, &table);
+        if (table.memoryUsageBytes > static_cast<size_t>(maxMemoryBytes)) {
+            return;
+        }
+    }
+
+    _hashJoinTable.emplace(std::move(table));
+}
+
+void DocumentSourceLookUp::addToHashJoinTable(BSONObj obj,
+                                              const FieldPath& foreignField,
+                                              HashJoinTable* table) {
+    const size_t docIndex = table->docs.size();
+
+    std::vector<Value> keys;
+    appendJoinKeys(obj, foreignField, 0, &keys);
+    for (auto&& key : keys) {
+        auto& bucket = table->index[key];
+        if (bucket.empty()) {
+            table->memoryUsageBytes += key.getApproximateSize();
+        }
+        // A document may produce the same key more than once.
+        if (bucket.empty() || bucket.back() != docIndex) {
+            bucket.push_back(docIndex);
+            table->memoryUsageBytes += sizeof(size_t);
+        }
+    }
+
+    table->memoryUsageBytes += obj.objsize();
+    table->docs.push_back(std::move(obj));
+}
+
+std::vector<Document> DocumentSourceLookUp::probeHashJoinTable(const HashJoinTable& table,
+                                                               const Document& input) const {
+    // Parse the predicate a per-document query would have used, to confirm each candidate.
+    auto query =
+        makeMatchStageFromInput(input, *_localField, _foreignField->fullPath(), BSONObj())
+            .firstElement()
+            .Obj();
+    auto matcher = uassertStatusOK(
+        MatchExpressionParser::parse(query, _fromExpCtx->getCollator(), _fromExpCtx));
+
+    std::vector<size_t> candidates;
+    auto addCandidates = [&](const Value& value) {
+        auto it = table.index.find(value);
+        if (it != table.index.end()) {
+            candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+        }
+    };
+
+    bool foundLocalValue = false;
+    document_path_support::visitAllValuesAtPath(
+        input, *_localField, [&](const Value& nextValue) {
+            foundLocalValue = true;
+            addCandidates(nextValue);
+        });
+    if (!foundLocalValue) {
+        // Missing values are treated as null.
+        addCandidates(Value(BSONNULL));
+    }
+
+    // Return each match once, in the order it was read from the foreign collection.
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<Document> results;
+    for (auto docIndex : candidates) {
+        const auto& obj = table.docs[docIndex];
+        if (matcher->matchesBSON(obj)) {
+            results.emplace_back(obj);
+        }
+    }
+    return results;
+}
+
 std::unique_ptr<Pipeline, Pipeline::Deleter> DocumentSourceLookUp::buildPipeline(
     const Document& inputDoc) {
     // Copy all 'let' variables into the foreign pipeline's expression context.
@@ -426,6 +696,10 @@ void DocumentSourceLookUp::doDispose() {
         _pipeline->dispose(pExpCtx->opCtx);
         _pipeline.reset();
     }
+    _hashJoinTable.reset();
+    _batch.clear();
+    _batchPosition = 0;
+    _unwindMatches = boost::none;
 }
 
 BSONObj DocumentSourceLookUp::makeMatchStageFromInput(const Document& input,
@@ -437,21 +711,37 @@ BSONObj DocumentSourceLookUp::makeMatchStageFromInput(const Document& input,
     // element to 'localFieldList'.
     BSONArrayBuilder arrBuilder;
     bool containsRegex = false;
+    appendLocalFieldValues(input, localFieldPath, &arrBuilder, &containsRegex);
+
+    const auto localFieldListSize = arrBuilder.arrSize();
+    return makeMatchStageFromValues(
+        arrBuilder.arr(), localFieldListSize, containsRegex, foreignFieldName, additionalFilter);
+}
+
+void DocumentSourceLookUp::appendLocalFieldValues(const Document& input,
+                                                  const FieldPath& localFieldPath,
+                                                  BSONArrayBuilder* arrBuilder,
+                                                  bool* containsRegex) {
+    bool foundValue = false;
     document_path_support::visitAllValuesAtPath(input, localFieldPath, [&](const Value& nextValue) {
-        arrBuilder << nextValue;
-        if (!containsRegex && nextValue.getType() == BSONType::RegEx) {
-            containsRegex = true;
+        foundValue = true;
+        *arrBuilder << nextValue;
+        if (!*containsRegex && nextValue.getType() == BSONType::RegEx) {
+            *containsRegex = true;
         }
     });
 
-    if (arrBuilder.arrSize() == 0) {
+    if (!foundValue) {
         // Missing values are treated as null.
-        arrBuilder << BSONNULL;
+        *arrBuilder << BSONNULL;
     }
+}
 
-    const auto localFieldListSize = arrBuilder.arrSize();
-    const auto localFieldList = arrBuilder.arr();
-
+BSONObj DocumentSourceLookUp::makeMatchStageFromValues(const BSONArray& localFieldList,
+                                                       int localFieldListSize,
+                                                       bool containsRegex,
+                                                       const std::string& foreignFieldName,
+                                                       const BSONObj& additionalFilter) {
     // We construct a query of one of the following forms, depending on the contents of
     // 'localFieldList'.
     //
@@ -518,8 +808,8 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
     // Loop until we get a document that has at least one match.
     // Note we may return early from this loop if our source stage is exhausted or if the unwind
     // source was asked to return empty arrays and we get a document without a match.
-    while (!_pipeline || !_nextValue) {
-        auto nextInput = pSource->getNext();
+    while (!_nextValue) {
+        auto nextInput = getNextInput(&_unwindMatches);
         if (!nextInput.isAdvanced()) {
             return nextInput;
         }
@@ -534,19 +824,23 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
             _resolvedPipeline.back() = matchStage;
         }
 
-        if (_pipeline) {
-            _pipeline->dispose(pExpCtx->opCtx);
-        }
+        if (_unwindMatches) {
+            _unwindMatchIndex = 0;
+        } else {
+            if (_pipeline) {
+                _pipeline->dispose(pExpCtx->opCtx);
+            }
 
-        _pipeline = buildPipeline(*_input);
+            _pipeline = buildPipeline(*_input);
 
-        // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
-        // potentially be used by multiple OperationContexts, and the $lookup stage is part of an
-        // outer Pipeline that will propagate dispose() calls before being destroyed.
-        _pipeline.get_deleter().dismissDisposal();
+            // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
+            // potentially be used by multiple OperationContexts, and the $lookup stage is part of
+            // an outer Pipeline that will propagate dispose() calls before being destroyed.
+            _pipeline.get_deleter().dismissDisposal();
+        }
 
         _cursorIndex = 0;
-        _nextValue = _pipeline->getNext();
+        _nextValue = getNextUnwindMatch();
 
         if (_unwindSrc->preserveNullAndEmptyArrays() && !_nextValue) {
             // There were no results for this cursor, but the $unwind was asked to preserve empty
@@ -564,7 +858,7 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
 
     invariant(bool(_input) && bool(_nextValue));
     auto currentValue = *_nextValue;
-    _nextValue = _pipeline->getNext();
+    _nextValue = getNextUnwindMatch();
 
     // Move input document into output if this is the last or only result, otherwise perform a copy.
     MutableDocument output(_nextValue ? *_input : std::move(*_input));
@@ -578,6 +872,16 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
     return output.freeze();
 }
 
+boost::optional<Document> DocumentSourceLookUp::getNextUnwindMatch() {
+    if (_unwindMatches) {
+        if (_unwindMatchIndex == _unwindMatches->size()) {
+            return boost::none;
+        }
+        return std::move((*_unwindMatches)[_unwindMatchIndex++]);
+    }
+    return _pipeline->getNext();
+}
+
 void DocumentSourceLookUp::copyVariablesToExpCtx(const Variables& vars,
                                                  const VariablesParseState& vps,
                                                  ExpressionContext* expCtx) {
@@ -242,6 +242,95 @@ private:
 
     GetNextResult unwindResult();
 
+    /**
+     * Appends each value of 'localFieldPath' in 'input' to 'arrBuilder', or null if there are none.
+     * Sets 'containsRegex' to true if any of them is a regular expression.
+     */
+    static void appendLocalFieldValues(const Document& input,
+                                       const FieldPath& localFieldPath,
+                                       BSONArrayBuilder* arrBuilder,
+                                       bool* containsRegex);
+
+    /**
+     * Builds the $match used to query the foreign collection for documents whose
+     * 'foreignFieldName' is equal to any of the 'localFieldListSize' values in 'localFieldList'.
+     */
+    static BSONObj makeMatchStageFromValues(const BSONArray& localFieldList,
+                                            int localFieldListSize,
+                                            bool containsRegex,
+                                            const std::string& foreignFieldName,
+                                            const BSONObj& additionalFilter);
+
+    /**
+     * An in-memory hash table over the foreign collection, keyed on every value that
+     * '_foreignField' could match by equality. Used in place of a per-document query when the
+     * foreign side is small enough.
+     */
+    struct HashJoinTable {
+        explicit HashJoinTable(const ValueComparator& comparator)
+            : index(comparator.makeUnorderedValueMap<std::vector<size_t>>()) {}
+
+        std::vector<BSONObj> docs;
+        ValueUnorderedMap<std::vector<size_t>> index;
+        size_t memoryUsageBytes = 0;
+    };
+
+    /**
+     * An input document read ahead into '_batch', along with the foreign documents joined to it
+     * if the batched query for its batch succeeded.
+     */
+    struct BatchedInput {
+        Document doc;
+        boost::optional<std::vector<Document>> matches;
+    };
+
+    /**
+     * Adds 'obj' to 'table' under each key that '_foreignField' could match.
+     */
+    static void addToHashJoinTable(BSONObj obj,
+                                   const FieldPath& foreignField,
+                                   HashJoinTable* table);
+
+    /**
+     * Decides, once per execution, whether to join against an in-memory hash table of the foreign
+     * collection rather than querying it for every input document. The table is built when this
+     * stage uses localField/foreignField syntax and the foreign collection's data size is within
+     * 'internalDocumentSourceLookupHashJoinMaxMemoryBytes'. If the table outgrows that limit
+     * while being built, it is discarded and this stage falls back to per-document queries.
+     */
+    void maybeBuildHashJoinTable();
+
+    /**
+     * Returns the foreign documents joined to 'input' by probing '_hashJoinTable'. Candidates found
+     * in the table are confirmed against the same predicate a per-document query would use, so the
+     * results are identical apart from their order.
+     */
+    std::vector<Document> probeHashJoinTable(const HashJoinTable& table,
+                                             const Document& input) const;
+
+    /**
+     * Returns the next result from our source. If it is a document whose joined foreign documents
+     * are already known, from either the hash join or a batched query, sets 'matches' to them;
+     * otherwise the caller must query the foreign collection for that document itself.
+     */
+    GetNextResult getNextInput(boost::optional<std::vector<Document>>* matches);
+
+    /**
+     * Reads ahead from our source into '_batch', starting with 'firstInput', until the batch holds
+     * 'internalDocumentSourceLookupBatchSize' documents or our source returns something other than
+     * a document, which is held back until the batch is drained. Then runs a single $in query for
+     * the local values of the whole batch and assigns its results to each input document. If the
+     * results outgrow 'internalDocumentSourceLookupHashJoinMaxMemoryBytes', batching is abandoned
+     * and each document in the batch is queried on its own.
+     */
+    void fillBatch(Document firstInput, size_t batchSize);
+
+    /**
+     * Returns the next foreign document joined to '_input' when unwinding, from either
+     * '_unwindMatches' or '_pipeline'.
+     */
+    boost::optional<Document> getNextUnwindMatch();
+
     /**
      * Copies 'vars' and 'vps' to the Variables and VariablesParseState objects in 'expCtx'. These
      * copies provide access to 'let' defined variables in sub-pipeline execution.
@@ -334,6 +423,23 @@ private:
     std::unique_ptr<Pipeline, Pipeline::Deleter> _pipeline;
     boost::optional<Document> _input;
     boost::optional<Document> _nextValue;
+
+    // Set once maybeBuildHashJoinTable() has run. '_hashJoinTable' is engaged only if the hash
+    // join was chosen.
+    bool _hashJoinDecided = false;
+    boost::optional<HashJoinTable> _hashJoinTable;
+
+    // Input documents read ahead for a batched query, the next of them to return, and the result
+    // from our source that ended the batch early, if any.
+    std::vector<BatchedInput> _batch;
+    size_t _batchPosition = 0;
+    boost::optional<GetNextResult> _batchPendingResult;
+    bool _batchingAbandoned = false;
+
+    // When unwinding, the joined documents for '_input' if they were computed in memory rather
+    // than by '_pipeline'.
+    boost::optional<std::vector<Document>> _unwindMatches;
+    size_t _unwindMatchIndex = 0;
 };
 
 }  // namespace mongo
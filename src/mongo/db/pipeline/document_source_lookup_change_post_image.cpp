@@ -31,6 +31,9 @@
 #include "mongo/db/pipeline/document_source_lookup_change_post_image.h"
 
 #include "mongo/bson/simple_bsonelement_comparator.h"
+#include "mongo/db/pipeline/change_stream_post_image_cache.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/service_context.h"
 
 namespace mongo {
 
@@ -58,21 +61,185 @@ Value assertFieldHasType(const Document& fullDoc, StringData fieldName, BSONType
 DocumentSource::GetNextResult DocumentSourceLookupChangePostImage::getNext() {
     pExpCtx->checkForInterrupt();
 
-    auto input = pSource->getNext();
-    if (!input.isAdvanced()) {
-        return input;
+    if (_pending.empty()) {
+        // Return any pause or EOF which reading ahead ran into, now that the changes before it are
+        // out.
+        if (_stashedResult) {
+            auto stashed = std::move(*_stashedResult);
+            _stashedResult = boost::none;
+            return stashed;
+        }
+
+        auto input = pSource->getNext();
+        if (!input.isAdvanced()) {
+            return input;
+        }
+        enqueue(input.releaseDocument());
+
+        const auto batchSize = internalDocumentSourceLookupChangePostImageBatchSize.load();
+        while (_pending.size() < static_cast<size_t>(std::max(batchSize, 1)) && canReadAhead()) {
+            auto next = pSource->getNext();
+            if (!next.isAdvanced()) {
+                _stashedResult = std::move(next);
+                break;
+            }
+            enqueue(next.releaseDocument());
+        }
     }
-    auto opTypeVal = assertFieldHasType(
-        input.getDocument(), DocumentSourceChangeStream::kOperationTypeField, BSONType::String);
-    if (opTypeVal.getString() != DocumentSourceChangeStream::kUpdateOpType) {
-        return input;
+
+    auto& next = _pending.front();
+    if (next.needsPostImage && !next.postImage) {
+        lookupPendingPostImages();
+    }
+
+    if (!next.needsPostImage) {
+        Document change = std::move(next.change);
+        _pending.pop_front();
+        return std::move(change);
     }
 
-    MutableDocument output(input.releaseDocument());
-    output[kFullDocumentFieldName] = lookupPostImage(output.peek());
+    MutableDocument output(std::move(next.change));
+    output[kFullDocumentFieldName] = std::move(*next.postImage);
+    _pending.pop_front();
     return output.freeze();
 }
 
+void DocumentSourceLookupChangePostImage::enqueue(Document change) {
+    auto opTypeVal = assertFieldHasType(
+        change, DocumentSourceChangeStream::kOperationTypeField, BSONType::String);
+    const bool needsPostImage = opTypeVal.getString() == DocumentSourceChangeStream::kUpdateOpType;
+    _pending.push_back({std::move(change), needsPostImage, boost::none});
+}
+
+bool DocumentSourceLookupChangePostImage::canReadAhead() const {
+    // When merging on mongos, the latest oplog timestamp a shard reports must not run ahead of the
+    // changes it has returned.
+    if (pExpCtx->needsMerge) {
+        return false;
+    }
+
+    // The stream is closed after an invalidation, so there is nothing to read past it.
+    auto opType = _pending.back().change[DocumentSourceChangeStream::kOperationTypeField];
+    return opType.getString() != DocumentSourceChangeStream::kInvalidateOpType &&
+        opType.getString() != DocumentSourceChangeStream::kRetryNeededOpType;
+}
+
+void DocumentSourceLookupChangePostImage::lookupPendingPostImages() {
+    auto serviceContext = pExpCtx->opCtx->getServiceContext();
+    auto& cache = ChangeStreamPostImageCache::get(serviceContext);
+    const Milliseconds cacheFor(internalDocumentSourceLookupChangePostImageCacheMillis.load());
+    const bool useCache = cacheFor > Milliseconds(0);
+    const Date_t now = serviceContext->getFastClockSource()->now();
+
+    auto cacheKeyOf = [](const Document& change) {
+        ResumeToken resumeToken(change[DocumentSourceChangeStream::kIdField]);
+        auto documentKey = assertFieldHasType(
+            change, DocumentSourceChangeStream::kDocumentKeyField, BSONType::Object);
+        return std::make_tuple(
+            resumeToken.getUuid(), documentKey.getDocument().toBson(), resumeToken.getTimestamp());
+    };
+
+    std::vector<PendingChange*> misses;
+    for (auto&& pending : _pending) {
+        if (!pending.needsPostImage || pending.postImage) {
+            continue;
+        }
+        if (useCache) {
+            auto key = cacheKeyOf(pending.change);
+            BSONObj cached;
+            if (cache.find(std::get<0>(key), std::get<1>(key), std::get<2>(key), now, &cached)) {
+                pending.postImage = cached.isEmpty() ? Value(BSONNULL) : Value(Document(cached));
+                continue;
+            }
+        }
+        misses.push_back(&pending);
+    }
+
+    if (misses.size() < 2 || !lookupPostImagesInBatch(misses)) {
+        for (auto&& pending : misses) {
+            pending->postImage = lookupPostImage(pending->change);
+        }
+    }
+
+    if (useCache) {
+        const size_t maxBytes =
+            std::max(internalDocumentSourceLookupChangePostImageCacheBytes.load(), 0);
+        for (auto&& pending : misses) {
+            auto key = cacheKeyOf(pending->change);
+            auto postImage = pending->postImage->nullish()
+                ? BSONObj()
+                : pending->postImage->getDocument().toBson();
+            cache.insert(std::get<0>(key),
+                         std::get<1>(key),
+                         std::get<2>(key),
+                         std::move(postImage),
+                         now,
+                         cacheFor,
+                         maxBytes);
+        }
+    }
+}
+
+bool DocumentSourceLookupChangePostImage::lookupPostImagesInBatch(
+    const std::vector<PendingChange*>& updates) const {
+    // Only changes to the same collection whose document keys are a plain _id can be looked up
+    // with a single $in.
+    auto nss = pExpCtx->ns;
+    auto uuidOf = [](const PendingChange* update) {
+        return ResumeToken(update->change[DocumentSourceChangeStream::kIdField]).getUuid();
+    };
+    auto uuid = uuidOf(updates.front());
+    BSONArrayBuilder ids;
+    for (auto&& update : updates) {
+        assertNamespaceMatches(update->change);
+        auto documentKey = assertFieldHasType(update->change,
+                                              DocumentSourceChangeStream::kDocumentKeyField,
+                                              BSONType::Object)
+                               .getDocument();
+        auto id = documentKey["_id"];
+        if (documentKey.size() != 1 || id.missing() || id.getType() == BSONType::RegEx ||
+            uuidOf(update) != uuid) {
+            return false;
+        }
+        id.addToBsonArray(&ids);
+    }
+
+    auto foreignExpCtx = pExpCtx->copyWith(nss, uuid);
+    auto matchSpec = BSON("$match" << BSON("_id" << BSON("$in" << ids.arr())));
+    auto pipelineStatus = _mongod->makePipeline({matchSpec}, foreignExpCtx);
+    if (pipelineStatus.getStatus() == ErrorCodes::NamespaceNotFound) {
+        // We couldn't find the collection with UUID, it may have been dropped.
+        for (auto&& update : updates) {
+            update->postImage = Value(BSONNULL);
+        }
+        return true;
+    }
+    auto pipeline = uassertStatusOK(std::move(pipelineStatus));
+
+    auto lookedUp = pExpCtx->getValueComparator().makeUnorderedValueMap<Value>();
+    while (auto doc = pipeline->getNext()) {
+        auto id = (*doc)["_id"];
+        auto inserted = lookedUp.emplace(id, Value(*doc));
+        uassert(40670,
+                str::stream() << "found more than document with documentKey {_id: "
+                              << id.toString()
+                              << "} while looking up post image after change: ["
+                              << inserted.first->second.toString()
+                              << ", "
+                              << doc->toString()
+                              << "]",
+                inserted.second);
+    }
+
+    // Documents we couldn't find with their documentKey may have been deleted.
+    for (auto&& update : updates) {
+        auto id = update->change[DocumentSourceChangeStream::kDocumentKeyField]["_id"];
+        auto it = lookedUp.find(id);
+        update->postImage = (it == lookedUp.end()) ? Value(BSONNULL) : it->second;
+    }
+    return true;
+}
+
 NamespaceString DocumentSourceLookupChangePostImage::assertNamespaceMatches(
     const Document& inputDoc) const {
     auto namespaceObject =
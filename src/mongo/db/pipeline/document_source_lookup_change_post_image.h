@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include <deque>
+#include <vector>
+
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_change_stream.h"
 
@@ -37,6 +40,10 @@ namespace mongo {
  * Part of the change stream API machinery used to look up the post-image of a document. Uses
  * the "documentKey" field of the input to look up the new version of the document.
  *
+ * Post-images are shared with the other streams on this node through the
+ * ChangeStreamPostImageCache. Unless results are merged on mongos, the stage may also read ahead
+ * a few changes and look up the post-images of all the updates among them with one query.
+ *
  * Uses the ExpressionContext to determine what collection to look up into.
  * TODO SERVER-29134 When we allow change streams on multiple collections, this will need to change.
  */
@@ -101,9 +108,36 @@ public:
     }
 
 private:
+    /**
+     * A change read from the source but not yet returned.
+     */
+    struct PendingChange {
+        Document change;
+        bool needsPostImage;
+        boost::optional<Value> postImage;
+    };
+
     DocumentSourceLookupChangePostImage(const boost::intrusive_ptr<ExpressionContext>& expCtx)
         : DocumentSourceNeedsMongod(expCtx) {}
 
+    void enqueue(Document change);
+
+    /**
+     * Returns whether the stage may read another change before returning the ones it holds.
+     */
+    bool canReadAhead() const;
+
+    /**
+     * Sets the post-image of every pending update, from the cache where possible.
+     */
+    void lookupPendingPostImages();
+
+    /**
+     * Looks up the post-images of 'updates' with a single query. Returns false, having set none of
+     * them, if their document keys cannot be looked up together.
+     */
+    bool lookupPostImagesInBatch(const std::vector<PendingChange*>& updates) const;
+
     /**
      * Uses the "documentKey" field from 'updateOp' to look up the current version of the document.
      * Returns Value(BSONNULL) if the document couldn't be found.
@@ -115,6 +149,11 @@ private:
      * ExpressionContext.
      */
     NamespaceString assertNamespaceMatches(const Document& inputDoc) const;
+
+    std::deque<PendingChange> _pending;
+
+    // A result other than a change which the source returned while the stage read ahead.
+    boost::optional<GetNextResult> _stashedResult;
 };
 
 }  // namespace mongo
@@ -44,6 +44,8 @@
 #include "mongo/db/pipeline/field_path.h"
 #include "mongo/db/pipeline/stub_mongod_interface.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -90,6 +92,7 @@ public:
         const std::vector<BSONObj>& rawPipeline,
         const boost::intrusive_ptr<ExpressionContext>& expCtx,
         const MakePipelineOptions opts) final {
+        ++_numPipelinesMade;
         auto pipeline = Pipeline::parse(rawPipeline, expCtx);
         if (!pipeline.isOK()) {
             return pipeline.getStatus();
@@ -112,8 +115,13 @@ public:
         return Status::OK();
     }
 
+    int getNumPipelinesMade() const {
+        return _numPipelinesMade;
+    }
+
 private:
     deque<DocumentSource::GetNextResult> _mockResults;
+    int _numPipelinesMade = 0;
 };
 
 TEST_F(DocumentSourceLookupChangePostImageTest, ShouldErrorIfMissingDocumentKeyOnUpdate) {
@@ -306,5 +314,96 @@ TEST_F(DocumentSourceLookupChangePostImageTest, ShouldPropagatePauses) {
     ASSERT_TRUE(lookupChangeStage->getNext().isEOF());
 }
 
+TEST_F(DocumentSourceLookupChangePostImageTest, ShouldLookUpAvailableUpdatesTogether) {
+    const auto originalBatchSize = internalDocumentSourceLookupChangePostImageBatchSize.load();
+    internalDocumentSourceLookupChangePostImageBatchSize.store(3);
+    ON_BLOCK_EXIT(
+        [&] { internalDocumentSourceLookupChangePostImageBatchSize.store(originalBatchSize); });
+
+    auto expCtx = getExpCtx();
+    auto lookupChangeStage = DocumentSourceLookupChangePostImage::create(expCtx);
+    const Document ns{{"db", expCtx->ns.db()}, {"coll", expCtx->ns.coll()}};
+
+    // Mock its input with two updates and an insert, followed by a pause.
+    auto mockLocalSource =
+        DocumentSourceMock::create({Document{{"_id", makeResumeToken(0)},
+                                             {"documentKey", Document{{"_id", 0}}},
+                                             {"operationType", "update"_sd},
+                                             {"ns", ns}},
+                                    Document{{"_id", makeResumeToken(1)},
+                                             {"documentKey", Document{{"_id", 1}}},
+                                             {"operationType", "update"_sd},
+                                             {"ns", ns}},
+                                    Document{{"_id", makeResumeToken(2)},
+                                             {"documentKey", Document{{"_id", 2}}},
+                                             {"operationType", "insert"_sd},
+                                             {"ns", ns},
+                                             {"fullDocument", Document{{"_id", 2}}}},
+                                    DocumentSource::GetNextResult::makePauseExecution()});
+    lookupChangeStage->setSource(mockLocalSource.get());
+
+    // Mock out the foreign collection. The document with _id 1 was deleted since it was updated.
+    auto mongod = std::make_shared<MockMongodInterface>(
+        deque<DocumentSource::GetNextResult>{Document{{"_id", 0}, {"x", 1}}});
+    lookupChangeStage->injectMongodInterface(mongod);
+
+    auto next = lookupChangeStage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(next.getDocument()["fullDocument"], Value(Document{{"_id", 0}, {"x", 1}}));
+    next = lookupChangeStage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(next.getDocument()["fullDocument"], Value(BSONNULL));
+    next = lookupChangeStage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(next.getDocument()["fullDocument"], Value(Document{{"_id", 2}}));
+
+    ASSERT_EQ(mongod->getNumPipelinesMade(), 1);
+    ASSERT_TRUE(lookupChangeStage->getNext().isPaused());
+    ASSERT_TRUE(lookupChangeStage->getNext().isEOF());
+}
+
+TEST_F(DocumentSourceLookupChangePostImageTest, ShouldShareCachedPostImagesBetweenStreams) {
+    const auto originalCacheMillis = internalDocumentSourceLookupChangePostImageCacheMillis.load();
+    internalDocumentSourceLookupChangePostImageCacheMillis.store(60 * 1000);
+    ON_BLOCK_EXIT([&] {
+        internalDocumentSourceLookupChangePostImageCacheMillis.store(originalCacheMillis);
+    });
+
+    auto expCtx = getExpCtx();
+    const Document update{{"_id", makeResumeToken(0)},
+                          {"documentKey", Document{{"_id", 0}}},
+                          {"operationType", "update"_sd},
+                          {"ns", Document{{"db", expCtx->ns.db()}, {"coll", expCtx->ns.coll()}}}};
+
+    // The first stream looks the document up.
+    auto firstStage = DocumentSourceLookupChangePostImage::create(expCtx);
+    auto firstSource = DocumentSourceMock::create(update);
+    firstStage->setSource(firstSource.get());
+    auto firstMongod = std::make_shared<MockMongodInterface>(
+        deque<DocumentSource::GetNextResult>{Document{{"_id", 0}, {"version", 1}}});
+    firstStage->injectMongodInterface(firstMongod);
+
+    auto next = firstStage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(next.getDocument()["fullDocument"],
+                    Value(Document{{"_id", 0}, {"version", 1}}));
+    ASSERT_EQ(firstMongod->getNumPipelinesMade(), 1);
+
+    // The second stream reporting the same change gets the post-image the first looked up, even
+    // though the document has changed since.
+    auto secondStage = DocumentSourceLookupChangePostImage::create(expCtx);
+    auto secondSource = DocumentSourceMock::create(update);
+    secondStage->setSource(secondSource.get());
+    auto secondMongod = std::make_shared<MockMongodInterface>(
+        deque<DocumentSource::GetNextResult>{Document{{"_id", 0}, {"version", 2}}});
+    secondStage->injectMongodInterface(secondMongod);
+
+    next = secondStage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(next.getDocument()["fullDocument"],
+                    Value(Document{{"_id", 0}, {"version", 1}}));
+    ASSERT_EQ(secondMongod->getNumPipelinesMade(), 0);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -43,6 +43,7 @@
 #include "mongo/db/pipeline/field_path.h"
 #include "mongo/db/pipeline/stub_mongod_interface.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
 #include "mongo/db/query/query_knobs.h"
 
 namespace mongo {
@@ -457,12 +458,37 @@ public:
         }
 
         pipeline->addInitialSource(DocumentSourceMock::create(_mockResults));
+        ++_numCursorsAttached;
         return Status::OK();
     }
 
+    Status appendStorageStats(const NamespaceString& nss,
+                              const BSONObj& param,
+                              BSONObjBuilder* builder) const final {
+        if (!_collectionSize) {
+            return {ErrorCodes::NamespaceNotFound, "no storage stats in mock"};
+        }
+        builder->appendNumber("size", *_collectionSize);
+        return Status::OK();
+    }
+
+    /**
+     * Makes appendStorageStats() report 'size' as the foreign collection's data size. Until this is
+     * called, storage stats are unavailable.
+     */
+    void setCollectionSize(long long size) {
+        _collectionSize = size;
+    }
+
+    int numCursorsAttached() const {
+        return _numCursorsAttached;
+    }
+
 private:
     deque<DocumentSource::GetNextResult> _mockResults;
     bool _removeLeadingQueryStages = false;
+    boost::optional<long long> _collectionSize;
+    int _numCursorsAttached = 0;
 };
 
 TEST_F(DocumentSourceLookUpTest, ShouldPropagatePauses) {
@@ -995,5 +1021,292 @@ TEST_F(DocumentSourceLookUpTest, ShouldNotCacheIfCorrelatedStageIsAbsorbedIntoPl
     ASSERT_VALUE_EQ(Value(subPipeline->writeExplainOps(kExplain)), Value(BSONArray(expectedPipe)));
 }
 
+//
+// Hash join and batched queries.
+//
+
+/**
+ * Sets a query knob for the lifetime of this object.
+ */
+class ScopedQueryKnob {
+public:
+    ScopedQueryKnob(AtomicInt32& knob, int value) : _knob(knob), _originalValue(knob.load()) {
+        _knob.store(value);
+    }
+
+    ~ScopedQueryKnob() {
+        _knob.store(_originalValue);
+    }
+
+private:
+    AtomicInt32& _knob;
+    const int _originalValue;
+};
+
+/**
+ * Runs a $lookup of 'inputs' against 'foreignContents' on 'localField' and 'foreignField', and
+ * returns the output documents. The mock interface used is returned through 'mongodOut'.
+ */
+vector<Document> runLocalForeignLookup(const intrusive_ptr<ExpressionContextForTest>& expCtx,
+                                       deque<DocumentSource::GetNextResult> inputs,
+                                       deque<DocumentSource::GetNextResult> foreignContents,
+                                       boost::optional<long long> foreignCollectionSize,
+                                       bool unwind,
+                                       std::shared_ptr<MockMongodInterface>* mongodOut) {
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "a"_sd},
+                                         {"foreignField", "b"_sd},
+                                         {"as", "joined"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+    if (unwind) {
+        lookup->setUnwindStage(DocumentSourceUnwind::create(expCtx, "joined", false, boost::none));
+    }
+
+    auto mockLocalSource = DocumentSourceMock::create(std::move(inputs));
+    lookup->setSource(mockLocalSource.get());
+
+    auto mongod = std::make_shared<MockMongodInterface>(std::move(foreignContents));
+    if (foreignCollectionSize) {
+        mongod->setCollectionSize(*foreignCollectionSize);
+    }
+    lookup->injectMongodInterface(mongod);
+
+    vector<Document> results;
+    for (auto next = lookup->getNext(); next.isAdvanced(); next = lookup->getNext()) {
+        results.push_back(next.releaseDocument());
+    }
+    lookup->dispose();
+
+    *mongodOut = std::move(mongod);
+    return results;
+}
+
+deque<DocumentSource::GetNextResult> hashJoinInputs() {
+    return {Document{{"_id", 0}, {"a", 1}},
+            Document{{"_id", 1}, {"a", vector<Value>{Value(1), Value(2)}}},
+            Document{{"_id", 2}},
+            Document{{"_id", 3}, {"a", "x"_sd}},
+            Document{{"_id", 4}, {"a", 5}}};
+}
+
+deque<DocumentSource::GetNextResult> hashJoinForeignContents() {
+    return {Document{{"_id", 0}, {"b", 1}},
+            Document{{"_id", 1}, {"b", vector<Value>{Value(2), Value(3)}}},
+            Document{{"_id", 2}, {"b", BSONNULL}},
+            Document{{"_id", 3}},
+            Document{{"_id", 4}, {"b", 1.0}},
+            Document{{"_id", 5}, {"b", "x"_sd}}};
+}
+
+void assertDocumentsEqual(const vector<Document>& expected, const vector<Document>& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_DOCUMENT_EQ(expected[i], actual[i]);
+    }
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinProducesSameResultsAsPerDocumentQueries) {
+    std::shared_ptr<MockMongodInterface> mongod;
+    auto hashJoinResults = runLocalForeignLookup(
+        getExpCtx(), hashJoinInputs(), hashJoinForeignContents(), 0, false, &mongod);
+    // The foreign collection is scanned once to build the hash table.
+    ASSERT_EQ(1, mongod->numCursorsAttached());
+
+    // Without storage stats, the hash join is not chosen and each input document is queried.
+    ScopedQueryKnob noBatching(internalDocumentSourceLookupBatchSize, 1);
+    auto queryResults = runLocalForeignLookup(
+        getExpCtx(), hashJoinInputs(), hashJoinForeignContents(), boost::none, false, &mongod);
+    ASSERT_EQ(5, mongod->numCursorsAttached());
+
+    assertDocumentsEqual(queryResults, hashJoinResults);
+
+    // Spot check the output.
+    ASSERT_EQ(5U, hashJoinResults.size());
+    ASSERT_VALUE_EQ(hashJoinResults[1]["joined"],
+                    Value(vector<Value>{Value(Document{{"_id", 0}, {"b", 1}}),
+                                        Value(Document{{"_id", 1},
+                                                       {"b", vector<Value>{Value(2), Value(3)}}}),
+                                        Value(Document{{"_id", 4}, {"b", 1.0}})}));
+    ASSERT_VALUE_EQ(hashJoinResults[2]["joined"],
+                    Value(vector<Value>{Value(Document{{"_id", 2}, {"b", BSONNULL}}),
+                                        Value(Document{{"_id", 3}})}));
+    ASSERT_VALUE_EQ(hashJoinResults[4]["joined"], Value(vector<Value>{}));
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinProducesSameResultsAsPerDocumentQueriesWhenUnwinding) {
+    std::shared_ptr<MockMongodInterface> mongod;
+    auto hashJoinResults = runLocalForeignLookup(
+        getExpCtx(), hashJoinInputs(), hashJoinForeignContents(), 0, true, &mongod);
+    ASSERT_EQ(1, mongod->numCursorsAttached());
+
+    ScopedQueryKnob noBatching(internalDocumentSourceLookupBatchSize, 1);
+    auto queryResults = runLocalForeignLookup(
+        getExpCtx(), hashJoinInputs(), hashJoinForeignContents(), boost::none, true, &mongod);
+    assertDocumentsEqual(queryResults, hashJoinResults);
+    ASSERT_EQ(8U, hashJoinResults.size());
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinRespectsCollation) {
+    auto expCtx = getExpCtx();
+    expCtx->setCollator(
+        stdx::make_unique<CollatorInterfaceMock>(CollatorInterfaceMock::MockType::kAlwaysEqual));
+
+    std::shared_ptr<MockMongodInterface> mongod;
+    auto results = runLocalForeignLookup(expCtx,
+                                         {Document{{"_id", 0}, {"a", "foo"_sd}}},
+                                         {Document{{"_id", 0}, {"b", "bar"_sd}}},
+                                         0,
+                                         false,
+                                         &mongod);
+    ASSERT_EQ(1, mongod->numCursorsAttached());
+    ASSERT_EQ(1U, results.size());
+    ASSERT_VALUE_EQ(results[0]["joined"],
+                    Value(vector<Value>{Value(Document{{"_id", 0}, {"b", "bar"_sd}})}));
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinNotUsedWhenForeignCollectionIsTooLarge) {
+    ScopedQueryKnob noBatching(internalDocumentSourceLookupBatchSize, 1);
+    std::shared_ptr<MockMongodInterface> mongod;
+    const long long tooLarge = internalDocumentSourceLookupHashJoinMaxMemoryBytes.load() + 1LL;
+    runLocalForeignLookup(
+        getExpCtx(), hashJoinInputs(), hashJoinForeignContents(), tooLarge, false, &mongod);
+    ASSERT_EQ(5, mongod->numCursorsAttached());
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinNotUsedWhenDisabled) {
+    ScopedQueryKnob noHashJoin(internalDocumentSourceLookupHashJoinMaxMemoryBytes, 0);
+    ScopedQueryKnob noBatching(internalDocumentSourceLookupBatchSize, 1);
+
+    std::shared_ptr<MockMongodInterface> mongod;
+    runLocalForeignLookup(
+        getExpCtx(), hashJoinInputs(), hashJoinForeignContents(), 0, false, &mongod);
+    ASSERT_EQ(5, mongod->numCursorsAttached());
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinFallsBackWhenTableExceedsMemoryLimit) {
+    ScopedQueryKnob smallMemoryLimit(internalDocumentSourceLookupHashJoinMaxMemoryBytes, 64);
+    ScopedQueryKnob noBatching(internalDocumentSourceLookupBatchSize, 1);
+
+    std::shared_ptr<MockMongodInterface> mongod;
+    auto results = runLocalForeignLookup(
+        getExpCtx(), hashJoinInputs(), hashJoinForeignContents(), 0, false, &mongod);
+    // One scan started building the table, then each input document was queried.
+    ASSERT_EQ(6, mongod->numCursorsAttached());
+
+    auto queryResults = runLocalForeignLookup(
+        getExpCtx(), hashJoinInputs(), hashJoinForeignContents(), boost::none, false, &mongod);
+    assertDocumentsEqual(queryResults, results);
+}
+
+TEST_F(DocumentSourceLookUpTest, BatchedQueryProducesSameResultsAsPerDocumentQueries) {
+    std::shared_ptr<MockMongodInterface> mongod;
+    auto batchedResults = runLocalForeignLookup(
+        getExpCtx(), hashJoinInputs(), hashJoinForeignContents(), boost::none, false, &mongod);
+    // A single query covers every input document.
+    ASSERT_EQ(1, mongod->numCursorsAttached());
+
+    ScopedQueryKnob noBatching(internalDocumentSourceLookupBatchSize, 1);
+    auto queryResults = runLocalForeignLookup(
+        getExpCtx(), hashJoinInputs(), hashJoinForeignContents(), boost::none, false, &mongod);
+    ASSERT_EQ(5, mongod->numCursorsAttached());
+
+    assertDocumentsEqual(queryResults, batchedResults);
+}
+
+TEST_F(DocumentSourceLookUpTest, BatchedQueryProducesSameResultsAsPerDocumentQueriesWhenUnwinding) {
+    std::shared_ptr<MockMongodInterface> mongod;
+    auto batchedResults = runLocalForeignLookup(
+        getExpCtx(), hashJoinInputs(), hashJoinForeignContents(), boost::none, true, &mongod);
+    ASSERT_EQ(1, mongod->numCursorsAttached());
+
+    ScopedQueryKnob noBatching(internalDocumentSourceLookupBatchSize, 1);
+    auto queryResults = runLocalForeignLookup(
+        getExpCtx(), hashJoinInputs(), hashJoinForeignContents(), boost::none, true, &mongod);
+    assertDocumentsEqual(queryResults, batchedResults);
+}
+
+TEST_F(DocumentSourceLookUpTest, BatchedQueryReadsAheadAtMostBatchSizeDocuments) {
+    ScopedQueryKnob batchOfTwo(internalDocumentSourceLookupBatchSize, 2);
+
+    std::shared_ptr<MockMongodInterface> mongod;
+    auto batchedResults = runLocalForeignLookup(
+        getExpCtx(), hashJoinInputs(), hashJoinForeignContents(), boost::none, false, &mongod);
+    // Two batches of two documents, then the last document is queried on its own.
+    ASSERT_EQ(3, mongod->numCursorsAttached());
+
+    ScopedQueryKnob noBatching(internalDocumentSourceLookupBatchSize, 1);
+    auto queryResults = runLocalForeignLookup(
+        getExpCtx(), hashJoinInputs(), hashJoinForeignContents(), boost::none, false, &mongod);
+    assertDocumentsEqual(queryResults, batchedResults);
+}
+
+TEST_F(DocumentSourceLookUpTest, BatchedQueryFallsBackWhenResultsExceedMemoryLimit) {
+    ScopedQueryKnob smallMemoryLimit(internalDocumentSourceLookupHashJoinMaxMemoryBytes, 64);
+
+    std::shared_ptr<MockMongodInterface> mongod;
+    auto batchedResults = runLocalForeignLookup(
+        getExpCtx(), hashJoinInputs(), hashJoinForeignContents(), boost::none, false, &mongod);
+    // The batched query is abandoned, and every input document is queried on its own.
+    ASSERT_EQ(6, mongod->numCursorsAttached());
+
+    ScopedQueryKnob noBatching(internalDocumentSourceLookupBatchSize, 1);
+    auto queryResults = runLocalForeignLookup(
+        getExpCtx(), hashJoinInputs(), hashJoinForeignContents(), boost::none, false, &mongod);
+    assertDocumentsEqual(queryResults, batchedResults);
+}
+
+TEST_F(DocumentSourceLookUpTest, BatchedQueryPreservesPausesInOrder) {
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "foreignId"_sd},
+                                         {"foreignField", "_id"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    auto mockLocalSource =
+        DocumentSourceMock::create({Document{{"foreignId", 0}},
+                                    Document{{"foreignId", 1}},
+                                    DocumentSource::GetNextResult::makePauseExecution(),
+                                    Document{{"foreignId", 2}}});
+    lookup->setSource(mockLocalSource.get());
+
+    auto mongod = std::make_shared<MockMongodInterface>(deque<DocumentSource::GetNextResult>{
+        Document{{"_id", 0}}, Document{{"_id", 1}}, Document{{"_id", 2}}});
+    lookup->injectMongodInterface(mongod);
+
+    for (int id = 0; id < 2; ++id) {
+        auto next = lookup->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        auto expectedForeignDocs = vector<Value>{Value(Document{{"_id", id}})};
+        ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                           (Document{{"foreignId", id}, {"foreignDocs", expectedForeignDocs}}));
+    }
+    // The first two documents were joined by one query.
+    ASSERT_EQ(1, mongod->numCursorsAttached());
+
+    ASSERT_TRUE(lookup->getNext().isPaused());
+
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(
+        next.releaseDocument(),
+        (Document{{"foreignId", 2}, {"foreignDocs", vector<Value>{Value(Document{{"_id", 2}})}}}));
+
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    lookup->dispose();
+}
+
 }  // namespace
 }  // namespace mongo
@@ -0,0 +1,82 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_query_stats.h"
+
+#include "mongo/db/pipeline/lite_parsed_document_source.h"
+#include "mongo/util/net/sock.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+
+REGISTER_DOCUMENT_SOURCE(queryStats,
+                         DocumentSourceQueryStats::LiteParsed::parse,
+                         DocumentSourceQueryStats::createFromBson);
+
+const char* DocumentSourceQueryStats::getSourceName() const {
+    return "$queryStats";
+}
+
+DocumentSource::GetNextResult DocumentSourceQueryStats::getNext() {
+    pExpCtx->checkForInterrupt();
+
+    if (!_fetched) {
+        _stats = _mongod->getQueryStats(pExpCtx->opCtx, pExpCtx->ns);
+        _statsIter = _stats.begin();
+        _fetched = true;
+    }
+
+    if (_statsIter != _stats.end()) {
+        MutableDocument doc{Document(*_statsIter)};
+        doc["host"] = Value(_processName);
+        ++_statsIter;
+        return doc.freeze();
+    }
+
+    return GetNextResult::makeEOF();
+}
+
+DocumentSourceQueryStats::DocumentSourceQueryStats(const intrusive_ptr<ExpressionContext>& pExpCtx)
+    : DocumentSourceNeedsMongod(pExpCtx), _processName(getHostNameCachedAndPort()) {}
+
+intrusive_ptr<DocumentSource> DocumentSourceQueryStats::createFromBson(
+    BSONElement elem, const intrusive_ptr<ExpressionContext>& pExpCtx) {
+    uassert(40653,
+            "The $queryStats stage specification must be an empty object",
+            elem.type() == Object && elem.Obj().isEmpty());
+    return new DocumentSourceQueryStats(pExpCtx);
+}
+
+Value DocumentSourceQueryStats::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    return Value(DOC(getSourceName() << Document()));
+}
+}  // namespace mongo
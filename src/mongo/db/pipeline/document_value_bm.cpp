@@ -0,0 +1,109 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/unittest/benchmark.h"
+
+namespace mongo {
+namespace {
+
+std::vector<std::string> makeFieldNames(int64_t numFields) {
+    std::vector<std::string> names;
+    for (int64_t i = 0; i < numFields; ++i) {
+        names.push_back("field" + std::to_string(i));
+    }
+    return names;
+}
+
+BSONObj makeBSON(const std::vector<std::string>& names) {
+    BSONObjBuilder builder;
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (i % 2) {
+            builder.append(names[i], static_cast<int>(i));
+        } else {
+            builder.append(names[i], "a short string value");
+        }
+    }
+    return builder.obj();
+}
+
+void BM_documentFromBSON(benchmark::State& state) {
+    const auto names = makeFieldNames(state.arg());
+    const auto bson = makeBSON(names);
+    for (auto _ : state) {
+        Document doc(bson);
+        benchmark::doNotOptimizeAway(doc[names.back()]);
+    }
+    state.setItemsProcessed(state.iterations() * state.arg());
+}
+BENCHMARK(BM_documentFromBSON)->arg(10)->arg(100);
+
+void BM_mutableDocumentAddFields(benchmark::State& state) {
+    const auto names = makeFieldNames(state.arg());
+    for (auto _ : state) {
+        MutableDocument doc;
+        for (size_t i = 0; i < names.size(); ++i) {
+            doc.addField(names[i], Value(static_cast<int>(i)));
+        }
+        benchmark::doNotOptimizeAway(doc.freeze());
+    }
+    state.setItemsProcessed(state.iterations() * state.arg());
+}
+BENCHMARK(BM_mutableDocumentAddFields)->arg(10)->arg(100);
+
+void BM_documentToBSON(benchmark::State& state) {
+    const Document doc(makeBSON(makeFieldNames(state.arg())));
+    for (auto _ : state) {
+        benchmark::doNotOptimizeAway(doc.toBson());
+    }
+    state.setItemsProcessed(state.iterations() * state.arg());
+}
+BENCHMARK(BM_documentToBSON)->arg(10)->arg(100);
+
+void BM_valueFromBSONArray(benchmark::State& state) {
+    BSONArrayBuilder builder;
+    for (int64_t i = 0; i < state.arg(); ++i) {
+        builder.append(static_cast<int>(i));
+    }
+    const auto array = builder.arr();
+    for (auto _ : state) {
+        benchmark::doNotOptimizeAway(Value(array));
+    }
+    state.setItemsProcessed(state.iterations() * state.arg());
+}
+BENCHMARK(BM_valueFromBSONArray)->arg(10)->arg(1000);
+
+}  // namespace
+}  // namespace mongo
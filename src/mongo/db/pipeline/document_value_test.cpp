@@ -40,6 +40,8 @@
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/pipeline/value_comparator.h"
 #include "mongo/dbtests/dbtests.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/memory_accounting.h"
 
 namespace DocumentTests {
 
@@ -113,6 +115,54 @@ TEST(DocumentConstruction, FromEmptyDocumentClone) {
     ASSERT_DOCUMENT_EQ(document, documentClone);
 }
 
+TEST(DocumentConstruction, LazyFromBsonMatchesEagerConversion) {
+    BSONObj obj = BSON("a" << 1 << "b" << BSON("c" << BSON("d"
+                                                          << "x"))
+                           << "e"
+                           << BSON_ARRAY(BSON("f" << 2) << 3));
+    Document lazy = Document::fromBsonWithMetaDataLazily(obj);
+
+    // Serializing before anything is read hands back the original bytes.
+    ASSERT_BSONOBJ_EQ(obj, toBson(lazy));
+
+    ASSERT_EQUALS(1, lazy["a"].getInt());
+    ASSERT_EQUALS("x", lazy.getNestedField(FieldPath("b.c.d")).getString());
+    ASSERT_EQUALS(2, lazy["e"][0]["f"].getInt());
+    ASSERT_DOCUMENT_EQ(Document(obj), lazy);
+    ASSERT_BSONOBJ_EQ(obj, toBson(lazy));
+}
+
+TEST(DocumentConstruction, LazyFromBsonCanBeModified) {
+    Document lazy = Document::fromBsonWithMetaDataLazily(BSON("a" << 1 << "b" << BSON("c" << 2)));
+    MutableDocument md(lazy);
+    md.setNestedField(FieldPath("b.c"), Value(3));
+    md.addField("d", Value(4));
+    ASSERT_BSONOBJ_EQ(BSON("a" << 1 << "b" << BSON("c" << 3) << "d" << 4), toBson(md.freeze()));
+
+    // The original is left untouched.
+    ASSERT_BSONOBJ_EQ(BSON("a" << 1 << "b" << BSON("c" << 2)), toBson(lazy));
+}
+
+TEST(DocumentConstruction, LazyFromUnownedBsonOutlivesIt) {
+    BSONObj owned = BSON("a"
+                         << "a string long enough not to be stored inline"
+                         << "b"
+                         << BSON("c" << 1));
+    Document lazy = Document::fromBsonWithMetaDataLazily(BSONObj(owned.objdata()));
+    const BSONObj expected = owned.copy();
+    owned = BSONObj();
+    ASSERT_BSONOBJ_EQ(expected, toBson(lazy));
+    ASSERT_EQUALS(1, lazy["b"]["c"].getInt());
+}
+
+TEST(DocumentConstruction, LazyFromBsonWithMetaDataConvertsMetaData) {
+    BSONObj obj = BSON("a" << 1 << Document::metaFieldTextScore << 10.0);
+    Document lazy = Document::fromBsonWithMetaDataLazily(obj);
+    ASSERT_TRUE(lazy.hasTextScore());
+    ASSERT_EQ(10.0, lazy.getTextScore());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 1), toBson(lazy));
+}
+
 /**
  * Appends to 'builder' an object nested 'depth' levels deep.
  */
@@ -352,6 +402,70 @@ public:
     }
 };
 
+/** Documents built in buffers recycled from freed documents see none of the old contents. */
+class RecycledBuffers {
+public:
+    void run() {
+        for (int round = 0; round < 3; ++round) {
+            vector<mongo::Document> documents;
+            for (int i = 0; i < 40; ++i) {
+                // Alternate between buffers sized by reserveFields() and grown by appending.
+                MutableDocument md(round % 2 == 0 ? i % 8 : 0);
+                for (int field = 0; field <= i % 12; ++field) {
+                    md.addField(fieldName(field, round), mongo::Value(round * 100 + field));
+                }
+                documents.push_back(md.freeze());
+                if (i % 3 == 0) {
+                    documents.push_back(documents.back().clone());
+                }
+            }
+
+            for (auto&& doc : documents) {
+                FieldIterator iterator(doc);
+                for (int field = 0; iterator.more(); ++field) {
+                    auto next = iterator.next();
+                    ASSERT_EQUALS(next.first.toString(), fieldName(field, round));
+                    ASSERT_VALUE_EQ(next.second, mongo::Value(round * 100 + field));
+                    ASSERT_VALUE_EQ(doc[next.first], next.second);
+                }
+            }
+        }
+    }
+
+private:
+    static string fieldName(int field, int round) {
+        return "f" + std::to_string(field) + "_" + std::to_string(round);
+    }
+};
+
+/** Each thread keeps at most kMaxCachedBufferBytes of freed buffers, and accounts for them. */
+class CachedBuffersAreCapped {
+public:
+    void run() {
+        const auto before = getMemoryAccountBytes(MemoryAccountTag::kDocumentBuffers);
+        long long whileCached = 0;
+        stdx::thread thread([&] {
+            {
+                // Without a cap, freeing these would cache buffers of every size.
+                vector<mongo::Document> documents;
+                for (int i = 0; i < 20; ++i) {
+                    MutableDocument md;
+                    for (int field = 0; field < 100; ++field) {
+                        md.addField("f" + std::to_string(field), mongo::Value(field));
+                    }
+                    documents.push_back(md.freeze());
+                }
+            }
+            whileCached = getMemoryAccountBytes(MemoryAccountTag::kDocumentBuffers) - before;
+        });
+        thread.join();
+
+        ASSERT_GT(whileCached, 0);
+        ASSERT_LTE(whileCached, static_cast<long long>(DocumentStorage::kMaxCachedBufferBytes));
+        ASSERT_EQ(before, getMemoryAccountBytes(MemoryAccountTag::kDocumentBuffers));
+    }
+};
+
 /** FieldIterator for an empty Document. */
 class FieldIteratorEmpty {
 public:
@@ -1728,6 +1842,8 @@ public:
         add<Document::Compare>();
         add<Document::Clone>();
         add<Document::CloneMultipleFields>();
+        add<Document::RecycledBuffers>();
+        add<Document::CachedBuffersAreCapped>();
         add<Document::FieldIteratorEmpty>();
         add<Document::FieldIteratorSingle>();
         add<Document::FieldIteratorMultiple>();
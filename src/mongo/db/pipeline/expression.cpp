@@ -637,6 +637,124 @@ const char* ExpressionArrayToObject::getOpName() const {
     return "$arrayToObject";
 }
 
+/* ------------------- ExpressionCachedSubexpression ------------------- */
+
+ExpressionCachedSubexpression::ExpressionCachedSubexpression(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx, intrusive_ptr<Expression> expression)
+    : Expression(expCtx), _expression(std::move(expression)) {}
+
+intrusive_ptr<Expression> ExpressionCachedSubexpression::optimize() {
+    _expression = _expression->optimize();
+    return this;
+}
+
+Value ExpressionCachedSubexpression::evaluate(const Document& root) const {
+    if (!_cachedValue) {
+        _cachedValue = _expression->evaluate(root);
+    }
+    return *_cachedValue;
+}
+
+Value ExpressionCachedSubexpression::serialize(bool explain) const {
+    return _expression->serialize(explain);
+}
+
+void ExpressionCachedSubexpression::_doAddDependencies(DepsTracker* deps) const {
+    _expression->addDependencies(deps);
+}
+
+namespace {
+bool canShareSubexpression(const intrusive_ptr<Expression>& expression) {
+    if (dynamic_cast<ExpressionConstant*>(expression.get()) ||
+        dynamic_cast<ExpressionFieldPath*>(expression.get()) ||
+        dynamic_cast<ExpressionObject*>(expression.get())) {
+        return false;
+    }
+
+    // Claim that text score metadata is available so that $meta does not make this throw.
+    DepsTracker deps(DepsTracker::MetadataAvailable::kTextScore);
+    expression->addDependencies(&deps);
+    return deps.vars.empty();
+}
+
+/**
+ * Returns the serialized form of 'expression' as raw BSON, so that two subexpressions only compare
+ * equal if their constants have the same types as well as the same values.
+ */
+std::string serializedBytes(const intrusive_ptr<Expression>& expression) {
+    BSONObjBuilder builder;
+    expression->serialize(false).addToBsonObj(&builder, "");
+    BSONObj serialized = builder.obj();
+    return std::string(serialized.objdata(), serialized.objsize());
+}
+}  // namespace
+
+ExpressionCachedSubexpression::CachedSubexpressions
+ExpressionCachedSubexpression::shareCommonSubexpressions(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx, const ExpressionSlots& expressions) {
+    CachedSubexpressions cached;
+    auto addCached = [&cached](ExpressionCachedSubexpression* subexpression) {
+        if (std::find(cached.begin(), cached.end(), subexpression) == cached.end()) {
+            cached.push_back(subexpression);
+        }
+    };
+
+    // First count how many times each subexpression occurs.
+    std::map<std::string, size_t> occurrences;
+    stdx::function<intrusive_ptr<Expression>(const intrusive_ptr<Expression>&)> countOccurrences =
+        [&](const intrusive_ptr<Expression>& expression) {
+            if (auto subexpression =
+                    dynamic_cast<ExpressionCachedSubexpression*>(expression.get())) {
+                addCached(subexpression);
+                return expression;
+            }
+            if (canShareSubexpression(expression)) {
+                ++occurrences[serializedBytes(expression)];
+            }
+            expression->rewriteChildren(countOccurrences);
+            return expression;
+        };
+    for (auto&& expression : expressions) {
+        countOccurrences(*expression);
+    }
+
+    // Then replace every repeated one with the same shared subexpression. The first occurrence
+    // becomes the shared one, after sharing any repeated subexpressions within it.
+    std::map<std::string, intrusive_ptr<ExpressionCachedSubexpression>> shared;
+    stdx::function<intrusive_ptr<Expression>(const intrusive_ptr<Expression>&)> share =
+        [&](const intrusive_ptr<Expression>& expression) -> intrusive_ptr<Expression> {
+        if (dynamic_cast<ExpressionCachedSubexpression*>(expression.get())) {
+            return expression;
+        }
+        if (!canShareSubexpression(expression)) {
+            expression->rewriteChildren(share);
+            return expression;
+        }
+
+        auto key = serializedBytes(expression);
+        if (occurrences[key] < 2) {
+            expression->rewriteChildren(share);
+            return expression;
+        }
+
+        auto it = shared.find(key);
+        if (it != shared.end()) {
+            return it->second;
+        }
+        expression->rewriteChildren(share);
+        intrusive_ptr<ExpressionCachedSubexpression> subexpression(
+            new ExpressionCachedSubexpression(expCtx, expression));
+        shared.emplace(std::move(key), subexpression);
+        addCached(subexpression.get());
+        return subexpression;
+    };
+    for (auto&& expression : expressions) {
+        *expression = share(*expression);
+    }
+
+    return cached;
+}
+
 /* ------------------------- ExpressionCeil -------------------------- */
 
 Value ExpressionCeil::evaluateNumericArg(const Value& numericArg) const {
@@ -1739,6 +1857,13 @@ intrusive_ptr<Expression> ExpressionObject::optimize() {
     return this;
 }
 
+void ExpressionObject::rewriteChildren(
+    const stdx::function<intrusive_ptr<Expression>(const intrusive_ptr<Expression>&)>& rewrite) {
+    for (auto&& pair : _expressions) {
+        pair.second = rewrite(pair.second);
+    }
+}
+
 void ExpressionObject::_doAddDependencies(DepsTracker* deps) const {
     for (auto&& pair : _expressions) {
         pair.second->addDependencies(deps);
@@ -2919,6 +3044,13 @@ void ExpressionNary::_doAddDependencies(DepsTracker* deps) const {
     }
 }
 
+void ExpressionNary::rewriteChildren(
+    const stdx::function<intrusive_ptr<Expression>(const intrusive_ptr<Expression>&)>& rewrite) {
+    for (auto&& operand : vpOperand) {
+        operand = rewrite(operand);
+    }
+}
+
 void ExpressionNary::addOperand(const intrusive_ptr<Expression>& pExpression) {
     vpOperand.push_back(pExpression);
 }
@@ -157,6 +157,15 @@ public:
         return {{exprFieldPath}, {}};
     }
 
+    /**
+     * Replaces each direct subexpression of this expression with the result of calling 'rewrite'
+     * on it. Only expressions which hold all of their operands as plain subexpressions, such as
+     * ExpressionNary and ExpressionObject, override this; the default visits nothing.
+     */
+    virtual void rewriteChildren(
+        const stdx::function<boost::intrusive_ptr<Expression>(
+            const boost::intrusive_ptr<Expression>&)>& rewrite) {}
+
     /**
      * Parses a BSON Object that could represent an object literal or a functional expression like
      * $add.
@@ -272,6 +281,9 @@ public:
         return vpOperand;
     }
 
+    void rewriteChildren(const stdx::function<boost::intrusive_ptr<Expression>(
+                             const boost::intrusive_ptr<Expression>&)>& rewrite) final;
+
 protected:
     explicit ExpressionNary(const boost::intrusive_ptr<ExpressionContext>& expCtx)
         : Expression(expCtx) {}
@@ -370,9 +382,7 @@ public:
         if (n == 1) {
             Value singleVal = this->vpOperand[0]->evaluate(root);
             if (singleVal.getType() == Array) {
-                for (const Value& val : singleVal.getArray()) {
-                    accum.process(val, false);
-                }
+                accum.processAll(singleVal.getArray());
             } else {
                 accum.process(singleVal, false);
             }
@@ -487,6 +497,54 @@ private:
     Value _value;
 };
 
+/**
+ * Wraps a subexpression that occurs more than once among the expressions of a stage, so that it is
+ * evaluated at most once per document no matter how many places refer to it. These are created by
+ * shareCommonSubexpressions() once the expressions have been optimized, and are never parsed.
+ *
+ * The value is computed lazily on first use, so a subexpression guarded by $cond or $ifNull is
+ * still only evaluated when needed. The stage owning the expressions must call reset() before
+ * evaluating them against another document.
+ */
+class ExpressionCachedSubexpression final : public Expression {
+public:
+    using ExpressionSlots = std::vector<boost::intrusive_ptr<Expression>*>;
+    using CachedSubexpressions = std::vector<boost::intrusive_ptr<ExpressionCachedSubexpression>>;
+
+    boost::intrusive_ptr<Expression> optimize() final;
+    Value evaluate(const Document& root) const final;
+    Value serialize(bool explain) const final;
+
+    /**
+     * Forgets the value computed for the previous document.
+     */
+    void reset() {
+        _cachedValue = boost::none;
+    }
+
+    /**
+     * Replaces every subexpression which occurs more than once across the trees in 'expressions'
+     * with one shared ExpressionCachedSubexpression, and returns all of the shared subexpressions
+     * in those trees, including any created by a previous call.
+     *
+     * Constants, field paths and object literals are never shared since they are as cheap to
+     * evaluate as to look up, nor is anything referring to a variable, whose value might differ
+     * between the places the subexpression occurs.
+     */
+    static CachedSubexpressions shareCommonSubexpressions(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx, const ExpressionSlots& expressions);
+
+protected:
+    void _doAddDependencies(DepsTracker* deps) const final;
+
+private:
+    ExpressionCachedSubexpression(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                  boost::intrusive_ptr<Expression> expression);
+
+    boost::intrusive_ptr<Expression> _expression;
+    mutable boost::optional<Value> _cachedValue;
+};
+
 /**
  * Inherit from this class if your expression works with date types, and accepts either a single
  * argument which is a date, or an object {date: <date>, timezone: <string>}.
@@ -1438,6 +1496,9 @@ public:
     ComputedPaths getComputedPaths(const std::string& exprFieldPath,
                                    Variables::Id renamingVar) const final;
 
+    void rewriteChildren(const stdx::function<boost::intrusive_ptr<Expression>(
+                             const boost::intrusive_ptr<Expression>&)>& rewrite) final;
+
 protected:
     void _doAddDependencies(DepsTracker* deps) const final;
 
@@ -81,6 +81,10 @@ void ParsedAddFields::parse(const BSONObj& spec) {
 }
 
 Document ParsedAddFields::applyProjection(const Document& inputDoc) const {
+    for (auto&& subexpression : _cachedSubexpressions) {
+        subexpression->reset();
+    }
+
     // The output doc is the same as the input doc, with the added fields.
     MutableDocument output(inputDoc);
     _root->addComputedFields(&output, inputDoc);
@@ -82,6 +82,7 @@ public:
      */
     void optimize() final {
         _root->optimize();
+        _cachedSubexpressions = _root->shareCommonSubexpressions(_expCtx);
     }
 
     DocumentSource::GetDepsReturn addDependencies(DepsTracker* deps) const final {
@@ -135,6 +136,9 @@ private:
 
     // The InclusionNode tree does most of the execution work once constructed.
     std::unique_ptr<InclusionNode> _root;
+
+    // Subexpressions shared between computed fields, which are reset for every input document.
+    ExpressionCachedSubexpression::CachedSubexpressions _cachedSubexpressions;
 };
 }  // namespace parsed_aggregation_projection
 }  // namespace mongo
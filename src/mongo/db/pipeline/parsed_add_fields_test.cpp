@@ -533,6 +533,63 @@ TEST(ParsedAddFieldsExecutionTest, AddsNestedAddedFieldsInOrderSpecified) {
     ASSERT_DOCUMENT_EQ(result, expectedResult);
 }
 
+//
+// Common subexpressions.
+//
+
+TEST(ParsedAddFieldsExecutionTest, SharesRepeatedSubexpressionsAfterOptimizing) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    ParsedAddFields addition(expCtx);
+    addition.parse(fromjson("{a: {$arrayElemAt: [{$split: ['$s', ',']}, 0]},"
+                            " b: {$arrayElemAt: [{$split: ['$s', ',']}, 1]},"
+                            " 'c.d': {$split: ['$s', ',']}}"));
+    auto serializedBeforeOptimizing = addition.serializeStageOptions(boost::none);
+    addition.optimize();
+    ASSERT_DOCUMENT_EQ(addition.serializeStageOptions(boost::none), serializedBeforeOptimizing);
+
+    // Each document gets its own values for the shared subexpressions.
+    auto result = addition.applyProjection(Document{{"s", "x,y"_sd}});
+    auto split = vector<Value>{Value("x"_sd), Value("y"_sd)};
+    auto expectedResult = Document{
+        {"s", "x,y"_sd}, {"a", "x"_sd}, {"b", "y"_sd}, {"c", Document{{"d", split}}}};
+    ASSERT_DOCUMENT_EQ(result, expectedResult);
+
+    result = addition.applyProjection(Document{{"s", "p,q"_sd}});
+    split = vector<Value>{Value("p"_sd), Value("q"_sd)};
+    expectedResult = Document{
+        {"s", "p,q"_sd}, {"a", "p"_sd}, {"b", "q"_sd}, {"c", Document{{"d", split}}}};
+    ASSERT_DOCUMENT_EQ(result, expectedResult);
+}
+
+TEST(ParsedAddFieldsExecutionTest, OnlyEvaluatesSharedSubexpressionsWhenNeeded) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    ParsedAddFields addition(expCtx);
+    addition.parse(fromjson("{a: {$cond: [{$eq: ['$x', 0]}, 'zero', {$divide: [1, '$x']}]},"
+                            " b: {$cond: [{$eq: ['$x', 0]}, 'none', {$divide: [1, '$x']}]}}"));
+    addition.optimize();
+
+    // Dividing by zero would throw, so the shared $divide must not be evaluated here.
+    auto result = addition.applyProjection(Document{{"x", 0}});
+    auto expectedResult = Document{{"x", 0}, {"a", "zero"_sd}, {"b", "none"_sd}};
+    ASSERT_DOCUMENT_EQ(result, expectedResult);
+
+    result = addition.applyProjection(Document{{"x", 4}});
+    expectedResult = Document{{"x", 4}, {"a", 0.25}, {"b", 0.25}};
+    ASSERT_DOCUMENT_EQ(result, expectedResult);
+}
+
+TEST(ParsedAddFieldsExecutionTest, DoesNotShareSubexpressionsWithDifferentlyTypedConstants) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    ParsedAddFields addition(expCtx);
+    addition.parse(BSON("a" << BSON("$add" << BSON_ARRAY("$x" << 1)) << "b"
+                            << BSON("$add" << BSON_ARRAY("$x" << 1.0))));
+    addition.optimize();
+
+    auto result = addition.applyProjection(Document{{"x", 1}});
+    ASSERT_EQ(result["a"].getType(), NumberInt);
+    ASSERT_EQ(result["b"].getType(), NumberDouble);
+}
+
 //
 // Misc/Metadata.
 //
@@ -54,6 +54,23 @@ void InclusionNode::optimize() {
     }
 }
 
+ExpressionCachedSubexpression::CachedSubexpressions InclusionNode::shareCommonSubexpressions(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx) {
+    ExpressionCachedSubexpression::ExpressionSlots expressions;
+    addExpressionSlots(&expressions);
+    return ExpressionCachedSubexpression::shareCommonSubexpressions(expCtx, expressions);
+}
+
+void InclusionNode::addExpressionSlots(
+    ExpressionCachedSubexpression::ExpressionSlots* expressions) {
+    for (auto&& expressionIt : _expressions) {
+        expressions->push_back(&expressionIt.second);
+    }
+    for (auto&& childPair : _children) {
+        childPair.second->addExpressionSlots(expressions);
+    }
+}
+
 void InclusionNode::serialize(MutableDocument* output,
                               boost::optional<ExplainOptions::Verbosity> explain) const {
     // Always put "_id" first if it was included (implicitly or explicitly).
@@ -338,6 +355,10 @@ void ParsedInclusionProjection::parse(const BSONObj& spec) {
 }
 
 Document ParsedInclusionProjection::applyProjection(const Document& inputDoc) const {
+    for (auto&& subexpression : _cachedSubexpressions) {
+        subexpression->reset();
+    }
+
     // All expressions will be evaluated in the context of the input document, before any
     // transformations have been applied.
     MutableDocument output;
@@ -59,6 +59,14 @@ public:
      */
     void optimize();
 
+    /**
+     * Shares subexpressions repeated across the computed fields of this subtree so that each is
+     * evaluated once per document. Returns the shared subexpressions, which must be reset before
+     * the computed fields are added to another document.
+     */
+    ExpressionCachedSubexpression::CachedSubexpressions shareCommonSubexpressions(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
     /**
      * Serialize this projection.
      */
@@ -141,6 +149,11 @@ private:
     Value applyInclusionsToValue(Value inputVal) const;
     Value addComputedFields(Value inputVal, const Document& root) const;
 
+    /**
+     * Recursively appends a pointer to each computed field's expression to 'expressions'.
+     */
+    void addExpressionSlots(ExpressionCachedSubexpression::ExpressionSlots* expressions);
+
     /**
      * Returns nullptr if no such child exists.
      */
@@ -213,6 +226,7 @@ public:
      */
     void optimize() final {
         _root->optimize();
+        _cachedSubexpressions = _root->shareCommonSubexpressions(_expCtx);
     }
 
     DocumentSource::GetDepsReturn addDependencies(DepsTracker* deps) const final {
@@ -277,6 +291,9 @@ private:
 
     // The InclusionNode tree does most of the execution work once constructed.
     std::unique_ptr<InclusionNode> _root;
+
+    // Subexpressions shared between computed fields, which are reset for every input document.
+    ExpressionCachedSubexpression::CachedSubexpressions _cachedSubexpressions;
 };
 }  // namespace parsed_aggregation_projection
 }  // namespace mongo
@@ -53,7 +53,9 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_change_stream.h"
+#include "mongo/db/pipeline/document_source_change_stream_oplog_scan.h"
 #include "mongo/db/pipeline/document_source_cursor.h"
+#include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_merge_cursors.h"
 #include "mongo/db/pipeline/document_source_sample.h"
@@ -64,7 +66,9 @@
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/query_stats.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/service_context.h"
@@ -132,6 +136,10 @@ public:
         return collection->infoCache()->getIndexUsageStats();
     }
 
+    std::vector<BSONObj> getQueryStats(OperationContext* opCtx, const NamespaceString& ns) final {
+        return QueryStatsStore::get(opCtx->getServiceContext()).getStats(ns.ns());
+    }
+
     void appendLatencyStats(const NamespaceString& nss,
                             bool includeHistograms,
                             BSONObjBuilder* builder) const final {
@@ -500,6 +508,24 @@ void PipelineD::prepareCursorSource(Collection* collection,
         return;
     }
 
+    // A $changeStream can read the oplog through the buffer it shares with the other streams on
+    // this node rather than through a cursor of its own.
+    if (!sources.empty() && collection && !expCtx->explain &&
+        internalDocumentSourceChangeStreamSharedOplogBytes.load() > 0) {
+        if (auto oplogMatch = dynamic_cast<DocumentSourceOplogMatch*>(sources.front().get())) {
+            invariant(nss == NamespaceString::kRsOplogNamespace);
+            auto oplogScan =
+                DocumentSourceChangeStreamOplogScan::create(oplogMatch->getQuery(),
+                                                            oplogMatch->getStartFrom(),
+                                                            oplogMatch->isResume(),
+                                                            collection->getCappedInsertNotifier(),
+                                                            expCtx);
+            sources.pop_front();
+            pipeline->addInitialSource(oplogScan);
+            return;
+        }
+    }
+
     // We are going to generate an input cursor, so we need to be holding the collection lock.
     dassert(expCtx->opCtx->lockState()->isCollectionLockedForMode(nss.ns(), MODE_IS));
 
@@ -649,6 +675,17 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> PipelineD::prep
         plannerOpts |= QueryPlannerParams::TRACK_LATEST_OPLOG_TS;
     }
 
+    // A $group whose fields are all in some index can read them from a covered scan of the whole
+    // index, without fetching any document, even if there is no query that would select the
+    // index. Index keys hold null for a missing field, so this is only done when the $group's
+    // result does not depend on the difference.
+    if (!pipeline->_sources.empty()) {
+        auto group = dynamic_cast<DocumentSourceGroup*>(pipeline->_sources.front().get());
+        if (group && group->treatsMissingAndNullAlike()) {
+            plannerOpts |= QueryPlannerParams::GENERATE_COVERED_IXSCANS;
+        }
+    }
+
     const BSONObj emptyProjection;
     const BSONObj metaSortProjection = BSON("$meta"
                                             << "sortKey");
@@ -808,6 +845,10 @@ Timestamp PipelineD::getLatestOplogTimestamp(const Pipeline* pipeline) {
             dynamic_cast<DocumentSourceCursor*>(pipeline->_sources.front().get())) {
         return docSourceCursor->getLatestOplogTimestamp();
     }
+    if (auto oplogScan =
+            dynamic_cast<DocumentSourceChangeStreamOplogScan*>(pipeline->_sources.front().get())) {
+        return oplogScan->getLatestOplogTimestamp();
+    }
     return Timestamp();
 }
 
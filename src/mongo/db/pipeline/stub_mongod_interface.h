@@ -63,6 +63,11 @@ public:
         MONGO_UNREACHABLE;
     }
 
+    std::vector<BSONObj> getQueryStats(OperationContext* opCtx,
+                                       const NamespaceString& ns) override {
+        MONGO_UNREACHABLE;
+    }
+
     void appendLatencyStats(const NamespaceString& nss,
                             bool includeHistograms,
                             BSONObjBuilder* builder) const override {
@@ -38,6 +38,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
 #include "mongo/db/query/indexability.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/util/log.h"
 
@@ -63,9 +64,21 @@ namespace {
  * The two OR nodes would compare as equal in this case were it not for tuple item #3 (sort
  * order of children).
  */
-int matchExpressionComparator(const MatchExpression* lhs, const MatchExpression* rhs) {
-    MatchExpression::MatchType lhsMatchType = lhs->matchType();
-    MatchExpression::MatchType rhsMatchType = rhs->matchType();
+/**
+ * The MatchType by which 'expr' is sorted. With 'parameterizeInLists', an equality sorts as a $in.
+ */
+MatchExpression::MatchType sortMatchType(const MatchExpression* expr, bool parameterizeInLists) {
+    if (parameterizeInLists && MatchExpression::EQ == expr->matchType()) {
+        return MatchExpression::MATCH_IN;
+    }
+    return expr->matchType();
+}
+
+int matchExpressionComparator(const MatchExpression* lhs,
+                              const MatchExpression* rhs,
+                              bool parameterizeInLists) {
+    MatchExpression::MatchType lhsMatchType = sortMatchType(lhs, parameterizeInLists);
+    MatchExpression::MatchType rhsMatchType = sortMatchType(rhs, parameterizeInLists);
     if (lhsMatchType != rhsMatchType) {
         return lhsMatchType < rhsMatchType ? -1 : 1;
     }
@@ -79,8 +92,8 @@ int matchExpressionComparator(const MatchExpression* lhs, const MatchExpression*
 
     const size_t numChildren = std::min(lhs->numChildren(), rhs->numChildren());
     for (size_t childIdx = 0; childIdx < numChildren; ++childIdx) {
-        int childCompare =
-            matchExpressionComparator(lhs->getChild(childIdx), rhs->getChild(childIdx));
+        int childCompare = matchExpressionComparator(
+            lhs->getChild(childIdx), rhs->getChild(childIdx), parameterizeInLists);
         if (childCompare != 0) {
             return childCompare;
         }
@@ -90,14 +103,15 @@ int matchExpressionComparator(const MatchExpression* lhs, const MatchExpression*
         return lhs->numChildren() < rhs->numChildren() ? -1 : 1;
     }
 
+    // An equality and a $in on the same path still get a deterministic order.
+    if (lhs->matchType() != rhs->matchType()) {
+        return lhs->matchType() < rhs->matchType() ? -1 : 1;
+    }
+
     // They're equal!
     return 0;
 }
 
-bool matchExpressionLessThan(const MatchExpression* lhs, const MatchExpression* rhs) {
-    return matchExpressionComparator(lhs, rhs) < 0;
-}
-
 bool parsingCanProduceNoopMatchNodes(const ExtensionsCallback& extensionsCallback,
                                      MatchExpressionParser::AllowedFeatureSet allowedFeatures) {
     return extensionsCallback.hasNoopExtensions() &&
@@ -212,11 +226,12 @@ Status CanonicalQuery::init(std::unique_ptr<QueryRequest> qr,
 
     _canHaveNoopMatchNodes = canHaveNoopMatchNodes;
     _isIsolated = QueryRequest::isQueryIsolated(_qr->getFilter());
+    _parameterizeInLists = internalQueryCacheParameterizeInLists.load();
 
     // Normalize, sort and validate tree.
     root = normalizeTree(root);
 
-    sortTree(root);
+    sortTree(root, _parameterizeInLists);
     _root.reset(root);
     Status validStatus = isValid(root, *_qr);
     if (!validStatus.isOK()) {
@@ -398,13 +413,17 @@ MatchExpression* CanonicalQuery::normalizeTree(MatchExpression* root) {
 }
 
 // static
-void CanonicalQuery::sortTree(MatchExpression* tree) {
+void CanonicalQuery::sortTree(MatchExpression* tree, bool parameterizeInLists) {
     for (size_t i = 0; i < tree->numChildren(); ++i) {
-        sortTree(tree->getChild(i));
+        sortTree(tree->getChild(i), parameterizeInLists);
     }
     std::vector<MatchExpression*>* children = tree->getChildVector();
     if (NULL != children) {
-        std::sort(children->begin(), children->end(), matchExpressionLessThan);
+        std::sort(children->begin(),
+                  children->end(),
+                  [parameterizeInLists](const MatchExpression* lhs, const MatchExpression* rhs) {
+                      return matchExpressionComparator(lhs, rhs, parameterizeInLists) < 0;
+                  });
     }
 }
 
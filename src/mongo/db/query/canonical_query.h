@@ -157,8 +157,11 @@ public:
     /**
      * Traverses expression tree post-order.
      * Sorts children at each non-leaf node by (MatchType, path(), children, number of children)
+     *
+     * If 'parameterizeInLists' is true, equalities and $in predicates sort as if they had the same
+     * MatchType, so that none of the other children moves when one is replaced by the other.
      */
-    static void sortTree(MatchExpression* tree);
+    static void sortTree(MatchExpression* tree, bool parameterizeInLists = false);
 
     /**
      * Returns a count of 'type' nodes in expression tree.
@@ -186,6 +189,14 @@ public:
         return _isIsolated;
     }
 
+    /**
+     * Returns true if this query was sorted for a plan cache key in which equalities and $in
+     * predicates are interchangeable. See internalQueryCacheParameterizeInLists.
+     */
+    bool parameterizeInLists() const {
+        return _parameterizeInLists;
+    }
+
 private:
     // You must go through canonicalize to create a CanonicalQuery.
     CanonicalQuery() {}
@@ -207,6 +218,8 @@ private:
     bool _canHaveNoopMatchNodes = false;
 
     bool _isIsolated;
+
+    bool _parameterizeInLists = false;
 };
 
 }  // namespace mongo
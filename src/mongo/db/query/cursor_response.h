@@ -71,6 +71,17 @@ public:
         _batch.append(obj);
     }
 
+    /**
+     * Grows the response buffer once so that about 'bytes' worth of documents can be appended
+     * without the buffer being reallocated and copied as the batch grows.
+     */
+    void reserveBatchBytes(int bytes) {
+        invariant(_active);
+        auto& buf = _batch.bb();
+        buf.reserveBytes(bytes);
+        buf.claimReservedBytes(bytes);
+    }
+
     void setLatestOplogTimestamp(Timestamp ts) {
         _latestOplogTimestamp = ts;
     }
@@ -114,6 +114,17 @@ MultiPlanStage* getMultiPlanStage(PlanStage* root) {
     return NULL;
 }
 
+/**
+ * Returns the estimated cost of 'solution' as reported by explain, or an empty object if there is
+ * no estimate.
+ */
+BSONObj getCostEstimate(const QuerySolution* solution) {
+    if (!solution || !solution->costEstimate) {
+        return BSONObj();
+    }
+    return solution->costEstimate->toBSON();
+}
+
 /**
  * Given the SpecificStats object for a stage and the type of the stage, returns the
  * number of index keys examined by the stage.
@@ -136,6 +147,9 @@ size_t getKeysExamined(StageType type, const SpecificStats* specific) {
     } else if (STAGE_DISTINCT_SCAN == type) {
         const DistinctScanStats* spec = static_cast<const DistinctScanStats*>(specific);
         return spec->keysExamined;
+    } else if (STAGE_GEO_NEAR_2DSPHERE == type) {
+        const NearStats* spec = static_cast<const NearStats*>(specific);
+        return spec->keysExamined;
     }
 
     return 0;
@@ -163,6 +177,9 @@ size_t getDocsExamined(StageType type, const SpecificStats* specific) {
     } else if (STAGE_TEXT_OR == type) {
         const TextOrStats* spec = static_cast<const TextOrStats*>(specific);
         return spec->fetches;
+    } else if (STAGE_GEO_NEAR_2DSPHERE == type) {
+        const NearStats* spec = static_cast<const NearStats*>(specific);
+        return spec->docsExamined;
     }
 
     return 0;
@@ -391,6 +408,9 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("docsExamined", spec->docsExamined);
             bob->appendNumber("alreadyHasObj", spec->alreadyHasObj);
+            if (spec->docsPrefetched > 0) {
+                bob->appendNumber("docsPrefetched", spec->docsPrefetched);
+            }
         }
     } else if (STAGE_GEO_NEAR_2D == stats.stageType || STAGE_GEO_NEAR_2DSPHERE == stats.stageType) {
         NearStats* spec = static_cast<NearStats*>(stats.specific.get());
@@ -399,7 +419,14 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         bob->append("indexName", spec->indexName);
         bob->append("indexVersion", spec->indexVersion);
 
-        if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
+        if (spec->bestFirst) {
+            bob->appendBool("bestFirst", true);
+            if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
+                bob->appendNumber("cellsSearched", spec->cellsSearched);
+                bob->appendNumber("keysExamined", spec->keysExamined);
+                bob->appendNumber("docsExamined", spec->docsExamined);
+            }
+        } else if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             BSONArrayBuilder intervalsBob(bob->subarrayStart("searchIntervals"));
             for (vector<IntervalStats>::const_iterator it = spec->intervalStats.begin();
                  it != spec->intervalStats.end();
@@ -485,6 +512,9 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("memUsage", spec->memUsage);
             bob->appendNumber("memLimit", spec->memLimit);
+            if (spec->usedDisk) {
+                bob->appendBool("usedDisk", true);
+            }
         }
 
         if (spec->limit > 0) {
@@ -514,6 +544,10 @@ void Explain::statsToBSON(const PlanStageStats& stats,
     } else if (STAGE_TEXT_OR == stats.stageType) {
         TextOrStats* spec = static_cast<TextOrStats*>(stats.specific.get());
 
+        if (spec->topK) {
+            bob->appendNumber("topK", spec->topK);
+        }
+
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("docsExamined", spec->fetches);
         }
@@ -591,6 +625,8 @@ void Explain::generatePlannerInfo(PlanExecutor* exec,
                                   const Collection* collection,
                                   PlanStageStats* winnerStats,
                                   const vector<unique_ptr<PlanStageStats>>& rejectedStats,
+                                  const BSONObj& winnerCostEstimate,
+                                  const vector<BSONObj>& rejectedCostEstimates,
                                   BSONObjBuilder* out) {
     CanonicalQuery* query = exec->getCanonicalQuery();
 
@@ -629,6 +665,9 @@ void Explain::generatePlannerInfo(PlanExecutor* exec,
 
     BSONObjBuilder winningPlanBob(plannerBob.subobjStart("winningPlan"));
     statsToBSON(*winnerStats, &winningPlanBob, ExplainOptions::Verbosity::kQueryPlanner);
+    if (!winnerCostEstimate.isEmpty()) {
+        winningPlanBob.append("costEstimate", winnerCostEstimate);
+    }
     winningPlanBob.doneFast();
 
     // Genenerate array of rejected plans.
@@ -636,6 +675,9 @@ void Explain::generatePlannerInfo(PlanExecutor* exec,
     for (size_t i = 0; i < rejectedStats.size(); i++) {
         BSONObjBuilder childBob(allPlansBob.subobjStart());
         statsToBSON(*rejectedStats[i], &childBob, ExplainOptions::Verbosity::kQueryPlanner);
+        if (i < rejectedCostEstimates.size() && !rejectedCostEstimates[i].isEmpty()) {
+            childBob.append("costEstimate", rejectedCostEstimates[i]);
+        }
     }
     allPlansBob.doneFast();
 
@@ -716,11 +758,13 @@ void Explain::explainStages(PlanExecutor* exec,
     // If more than one plan was considered, get the stats from the trial period for the rejected
     // plans.
     vector<unique_ptr<PlanStageStats>> allPlansStats;
+    vector<BSONObj> rejectedCostEstimates;
     if (mps) {
         auto mpsStats = mps->getStats();
         for (size_t i = 0; i < mpsStats->children.size(); ++i) {
             if (i != static_cast<size_t>(mps->bestPlanIdx())) {
                 allPlansStats.emplace_back(std::move(mpsStats->children[i]));
+                rejectedCostEstimates.push_back(getCostEstimate(mps->getCandidateSolution(i)));
             }
         }
     }
@@ -748,7 +792,15 @@ void Explain::explainStages(PlanExecutor* exec,
     //
 
     if (verbosity >= ExplainOptions::Verbosity::kQueryPlanner) {
-        generatePlannerInfo(exec, collection, winningStats.get(), allPlansStats, out);
+        const BSONObj winnerCostEstimate =
+            getCostEstimate(mps ? mps->bestSolution() : exec->getQuerySolution());
+        generatePlannerInfo(exec,
+                            collection,
+                            winningStats.get(),
+                            allPlansStats,
+                            winnerCostEstimate,
+                            rejectedCostEstimates,
+                            out);
     }
 
     if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
@@ -893,9 +945,8 @@ void Explain::getSummaryStats(const PlanExecutor& exec, PlanSummaryStats* statsO
             statsOut->indexesUsed.insert(textStats->indexName);
         } else if (STAGE_GEO_NEAR_2D == stages[i]->stageType() ||
                    STAGE_GEO_NEAR_2DSPHERE == stages[i]->stageType()) {
-            const NearStage* nearStage = static_cast<const NearStage*>(stages[i]);
             const NearStats* nearStats =
-                static_cast<const NearStats*>(nearStage->getSpecificStats());
+                static_cast<const NearStats*>(stages[i]->getSpecificStats());
             statsOut->indexesUsed.insert(nearStats->indexName);
         } else if (STAGE_CACHED_PLAN == stages[i]->stageType()) {
             const CachedPlanStage* cachedPlan = static_cast<const CachedPlanStage*>(stages[i]);
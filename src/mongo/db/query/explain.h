@@ -144,12 +144,16 @@ private:
      * @param collection -- the collection used in the operation.
      * @param winnerStats -- the stats tree for the winning plan.
      * @param rejectedStats -- an array of stats trees, one per rejected plan
+     * @param winnerCostEstimate -- the estimated cost of the winning plan, or an empty object
+     * @param rejectedCostEstimates -- the estimated costs matching 'rejectedStats', if any
      */
     static void generatePlannerInfo(
         PlanExecutor* exec,
         const Collection* collection,
         PlanStageStats* winnerStats,
         const std::vector<std::unique_ptr<PlanStageStats>>& rejectedStats,
+        const BSONObj& winnerCostEstimate,
+        const std::vector<BSONObj>& rejectedCostEstimates,
         BSONObjBuilder* out);
 
     /**
@@ -30,6 +30,8 @@
 
 #include "mongo/db/query/find_common.h"
 
+#include <algorithm>
+
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/query/query_request.h"
 #include "mongo/util/assert_util.h"
@@ -49,6 +51,15 @@ bool FindCommon::enoughForFirstBatch(const QueryRequest& qr, long long numDocs)
     return numDocs >= qr.getEffectiveBatchSize().value();
 }
 
+int FindCommon::estimateBatchBytes(long long numDocs, long long avgObjSize, long long dataSize) {
+    long long estimate =
+        std::max(std::min(dataSize, static_cast<long long>(kMaxReplyBufferReservation)), 0LL);
+    if (numDocs > 0 && avgObjSize > 0 && numDocs < estimate / avgObjSize) {
+        estimate = numDocs * avgObjSize;
+    }
+    return static_cast<int>(estimate);
+}
+
 bool FindCommon::haveSpaceForNext(const BSONObj& nextDoc, long long numDocs, int bytesBuffered) {
     invariant(numDocs >= 0);
     if (!numDocs) {
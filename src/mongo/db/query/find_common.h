@@ -59,6 +59,11 @@ public:
     // The initial size of the query response buffer.
     static const int kInitReplyBufferSize = 32768;
 
+    // The most reply buffer space reserved up front for a batch. Larger batches grow the buffer
+    // as their documents are appended, so a batch that turns out small does not pay for a large
+    // reservation.
+    static const int kMaxReplyBufferReservation = 1024 * 1024;
+
     /**
      * Returns true if the batchSize for the initial find has been satisfied.
      *
@@ -83,6 +88,15 @@ public:
      */
     static bool haveSpaceForNext(const BSONObj& nextDoc, long long numDocs, int bytesBuffered);
 
+    /**
+     * Estimates how many bytes a batch of 'numDocs' documents will take up in a reply, given the
+     * average document size and the total data size of the collection they come from. A 'numDocs'
+     * of zero means the batch is bounded only by kMaxBytesToReturnToClientAtOnce. The result never
+     * exceeds kMaxReplyBufferReservation, since it is used to reserve reply buffer space before
+     * knowing how many documents actually match.
+     */
+    static int estimateBatchBytes(long long numDocs, long long avgObjSize, long long dataSize);
+
     /**
      * Transforms the raw sort spec into one suitable for use as the ordering specification in
      * BSONObj::woCompare().
@@ -0,0 +1,68 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/find_common.h"
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(FindCommonTest, EstimateBatchBytesUsesBatchSizeTimesAverageObjectSize) {
+    ASSERT_EQ(10 * 100, FindCommon::estimateBatchBytes(10, 100, 1000 * 1000));
+}
+
+TEST(FindCommonTest, EstimateBatchBytesIsBoundedByDataSize) {
+    ASSERT_EQ(500, FindCommon::estimateBatchBytes(10, 100, 500));
+    ASSERT_EQ(500, FindCommon::estimateBatchBytes(0, 100, 500));
+}
+
+TEST(FindCommonTest, EstimateBatchBytesWithoutBatchSizeIsCapped) {
+    const long long dataSize = 64LL * 1024 * 1024;
+    ASSERT_EQ(FindCommon::kMaxReplyBufferReservation,
+              FindCommon::estimateBatchBytes(0, 100, dataSize));
+}
+
+TEST(FindCommonTest, EstimateBatchBytesForLargeBatchIsCapped) {
+    ASSERT_EQ(FindCommon::kMaxReplyBufferReservation,
+              FindCommon::estimateBatchBytes(1000 * 1000, 1000, 1000LL * 1000 * 1000));
+}
+
+TEST(FindCommonTest, EstimateBatchBytesIgnoresUnknownAverageObjectSize) {
+    ASSERT_EQ(500, FindCommon::estimateBatchBytes(10, 0, 500));
+}
+
+TEST(FindCommonTest, EstimateBatchBytesOfEmptyCollectionIsZero) {
+    ASSERT_EQ(0, FindCommon::estimateBatchBytes(10, 0, 0));
+    ASSERT_EQ(0, FindCommon::estimateBatchBytes(0, 0, -1));
+}
+
+}  // namespace
+}  // namespace mongo
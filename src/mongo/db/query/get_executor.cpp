@@ -32,6 +32,7 @@
 
 #include "mongo/db/query/get_executor.h"
 
+#include <algorithm>
 #include <boost/optional.hpp>
 #include <limits>
 #include <memory>
@@ -65,12 +66,14 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/plan_ranker.h"
 #include "mongo/db/query/planner_access.h"
 #include "mongo/db/query/planner_analysis.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/query_settings.h"
+#include "mongo/db/query/query_stats.h"
 #include "mongo/db/query/stage_builder.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/s/collection_metadata.h"
@@ -194,6 +197,14 @@ void fillOutPlannerParams(OperationContext* opCtx,
         plannerParams->options |= QueryPlannerParams::GENERATE_COVERED_IXSCANS;
     }
 
+    if (internalQueryPlannerEnableSkipScan.load()) {
+        plannerParams->options |= QueryPlannerParams::SKIP_SCAN;
+    }
+
+    if (internalQueryPlannerEnableLateFetchForSort.load()) {
+        plannerParams->options |= QueryPlannerParams::FETCH_AFTER_SORT;
+    }
+
     plannerParams->options |= QueryPlannerParams::SPLIT_LIMITED_SORT;
 
     // Doc-level locking storage engines cannot answer predicates implicitly via exact index
@@ -262,6 +273,9 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
             std::move(canonicalQuery), std::move(querySolution), std::move(root));
     }
 
+    QueryStatsStore::get(opCtx->getServiceContext())
+        .noteQueryShape(opCtx, collection, *canonicalQuery);
+
     // Fill out the planning params.  We use these for both cached solutions and non-cached.
     QueryPlannerParams plannerParams;
     plannerParams.options = plannerOptions;
@@ -423,6 +437,30 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
         }
     }
 
+    // Estimate the cost of each candidate, and leave out of the race those that the estimates
+    // rule out.
+    const long long numRecords = collection->numRecords(opCtx);
+    for (auto solution : solutions) {
+        solution->costEstimate = PlanRanker::estimateCost(*solution, numRecords);
+    }
+    if (solutions.size() > 1) {
+        const std::vector<size_t> candidates = PlanRanker::selectCandidatesByCost(solutions);
+        if (candidates.size() < solutions.size()) {
+            LOG(2) << "Estimated costs leave " << candidates.size() << " of " << solutions.size()
+                   << " candidate plans to race for " << redact(canonicalQuery->toStringShort());
+
+            std::vector<QuerySolution*> selected;
+            for (size_t i = 0; i < solutions.size(); ++i) {
+                if (std::find(candidates.begin(), candidates.end(), i) != candidates.end()) {
+                    selected.push_back(solutions[i]);
+                } else {
+                    delete solutions[i];
+                }
+            }
+            solutions.swap(selected);
+        }
+    }
+
     if (1 == solutions.size()) {
         // Only one possible plan.  Run it.  Build the stages from the solution.
         PlanStage* rawRoot;
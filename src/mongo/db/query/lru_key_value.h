@@ -188,6 +188,22 @@ public:
         return _kvMap.find(key) != _kvMap.end();
     }
 
+    /**
+     * Removes the least recently used entry from the kv-store and transfers its ownership to the
+     * caller. Returns nullptr if the kv-store is empty.
+     */
+    std::unique_ptr<V> removeLeastRecentlyUsed() {
+        if (_kvList.empty()) {
+            return std::unique_ptr<V>();
+        }
+
+        V* evictedEntry = _kvList.back().second;
+        _kvMap.erase(_kvList.back().first);
+        _kvList.pop_back();
+        _currentSize--;
+        return std::unique_ptr<V>(evictedEntry);
+    }
+
     /**
      * Returns the number of entries currently in the kv-store.
      */
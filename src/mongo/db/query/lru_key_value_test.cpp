@@ -175,6 +175,35 @@ TEST(LRUKeyValueTest, ReplaceKeyTest) {
     assertInKVStore(cache, 4, 5);
 }
 
+/**
+ * Removing the least recently used entry takes the oldest entry not since promoted.
+ */
+TEST(LRUKeyValueTest, RemoveLeastRecentlyUsedTest) {
+    LRUKeyValue<int, int> cache(10);
+    ASSERT(!cache.removeLeastRecentlyUsed());
+
+    cache.add(1, new int(1));
+    cache.add(2, new int(2));
+    cache.add(3, new int(3));
+
+    // Promote 1.
+    int* value;
+    ASSERT_OK(cache.get(1, &value));
+
+    std::unique_ptr<int> evicted = cache.removeLeastRecentlyUsed();
+    ASSERT(evicted);
+    ASSERT_EQUALS(*evicted, 2);
+    assertNotInKVStore(cache, 2);
+    ASSERT_EQUALS(cache.size(), 2U);
+
+    evicted = cache.removeLeastRecentlyUsed();
+    ASSERT_EQUALS(*evicted, 3);
+    evicted = cache.removeLeastRecentlyUsed();
+    ASSERT_EQUALS(*evicted, 1);
+    ASSERT_EQUALS(cache.size(), 0U);
+    ASSERT(!cache.removeLeastRecentlyUsed());
+}
+
 /**
  * Test iteration over the kv-store.
  */
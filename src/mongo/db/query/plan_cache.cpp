@@ -37,8 +37,10 @@
 #include <memory>
 #include <vector>
 
+#include "mongo/base/counter.h"
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/client/dbclientinterface.h"  // For QueryOption_foobar
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/matcher/expression_array.h"
 #include "mongo/db/matcher/expression_geo.h"
 #include "mongo/db/query/collation/collator_interface.h"
@@ -47,12 +49,44 @@
 #include "mongo/db/query/query_solution.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
+#include "mongo/util/memory_accounting.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/transitional_tools_do_not_use/vector_spooling.h"
 
 namespace mongo {
+
 namespace {
 
+// The bytes used by all plan caches in the server.
+Counter64 planCacheTotalSizeEstimateBytes;
+ServerStatusMetricField<Counter64> displayPlanCacheTotalSizeEstimateBytes(
+    "query.planCache.totalSizeEstimateBytes", &planCacheTotalSizeEstimateBytes);
+
+void chargePlanCacheBytes(size_t bytes) {
+    planCacheTotalSizeEstimateBytes.increment(bytes);
+    chargeMemoryAccount(MemoryAccountTag::kPlanCache, bytes);
+}
+
+void releasePlanCacheBytes(size_t bytes) {
+    planCacheTotalSizeEstimateBytes.decrement(bytes);
+    chargeMemoryAccount(MemoryAccountTag::kPlanCache, -static_cast<long long>(bytes));
+}
+
+/**
+ * Approximate number of bytes used by a tree of plan stats. The type of the specific stats is not
+ * known here, so each stage is charged as if it were an index scan.
+ */
+size_t estimateStatsSizeInBytes(const PlanStageStats& stats) {
+    size_t size = sizeof(stats) + stats.common.filter.objsize();
+    if (stats.specific) {
+        size += sizeof(IndexScanStats);
+    }
+    for (auto&& child : stats.children) {
+        size += sizeof(child) + estimateStatsSizeInBytes(*child);
+    }
+    return size;
+}
+
 // Delimiters for cache key encoding.
 const char kEncodeDiscriminatorsBegin = '<';
 const char kEncodeDiscriminatorsEnd = '>';
@@ -418,6 +452,22 @@ PlanCacheEntry::~PlanCacheEntry() {
     }
 }
 
+size_t PlanCacheEntry::estimateObjectSizeInBytes() const {
+    size_t size = sizeof(*this) + query.objsize() + sort.objsize() + projection.objsize() +
+        collation.objsize();
+    for (auto&& data : plannerData) {
+        size += sizeof(data) + data->estimateObjectSizeInBytes();
+    }
+    if (decision) {
+        size += sizeof(*decision) + decision->scores.capacity() * sizeof(double) +
+            decision->candidateOrder.capacity() * sizeof(size_t);
+        for (auto&& stats : decision->stats) {
+            size += sizeof(stats) + estimateStatsSizeInBytes(*stats);
+        }
+    }
+    return size;
+}
+
 PlanCacheEntry* PlanCacheEntry::clone() const {
     std::vector<std::unique_ptr<QuerySolution>> solutions;
     for (size_t i = 0; i < plannerData.size(); ++i) {
@@ -459,6 +509,22 @@ std::string CachedSolution::toString() const {
 // PlanCacheIndexTree
 //
 
+size_t PlanCacheIndexTree::estimateObjectSizeInBytes() const {
+    size_t size = sizeof(*this) + children.capacity() * sizeof(PlanCacheIndexTree*);
+    for (auto&& child : children) {
+        size += child->estimateObjectSizeInBytes();
+    }
+    if (entry) {
+        size += sizeof(*entry) + entry->keyPattern.objsize() + entry->infoObj.objsize() +
+            entry->name.size();
+    }
+    for (auto&& orPushdown : orPushdowns) {
+        size += sizeof(orPushdown) + orPushdown.indexName.size() +
+            orPushdown.route.size() * sizeof(size_t);
+    }
+    return size;
+}
+
 void PlanCacheIndexTree::setIndexEntry(const IndexEntry& ie) {
     entry.reset(new IndexEntry(ie));
 }
@@ -533,6 +599,14 @@ SolutionCacheData* SolutionCacheData::clone() const {
     return other;
 }
 
+size_t SolutionCacheData::estimateObjectSizeInBytes() const {
+    size_t size = sizeof(*this);
+    if (tree) {
+        size += tree->estimateObjectSizeInBytes();
+    }
+    return size;
+}
+
 std::string SolutionCacheData::toString() const {
     switch (this->solnType) {
         case WHOLE_IXSCAN_SOLN:
@@ -554,20 +628,44 @@ std::string SolutionCacheData::toString() const {
 // PlanCache
 //
 
-PlanCache::PlanCache() : _cache(internalQueryCacheSize.load()) {}
+PlanCache::Partition::Partition()
+    : cache(std::max<size_t>(
+          1, (internalQueryCacheSize.load() + kNumPartitions - 1) / kNumPartitions)) {}
+
+PlanCache::PlanCache() : _partitions(kNumPartitions) {}
+
+PlanCache::PlanCache(const std::string& ns) : _partitions(kNumPartitions), _ns(ns) {}
+
+PlanCache::~PlanCache() {
+    releasePlanCacheBytes(sizeEstimateBytes());
+}
 
-PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize.load()), _ns(ns) {}
+PlanCache::Partition& PlanCache::partitionFor(const PlanCacheKey& key) const {
+    return _partitions[std::hash<PlanCacheKey>()(key) % kNumPartitions];
+}
 
-PlanCache::~PlanCache() {}
+void PlanCache::releaseBytes(Partition* partition, size_t bytes) {
+    invariant(partition->sizeEstimateBytes >= bytes);
+    partition->sizeEstimateBytes -= bytes;
+    releasePlanCacheBytes(bytes);
+}
 
 /**
  * Traverses expression tree pre-order.
  * Appends an encoding of each node's match type and path name
  * to the output stream.
  */
-void PlanCache::encodeKeyForMatch(const MatchExpression* tree, StringBuilder* keyBuilder) const {
-    // Encode match type and path.
-    *keyBuilder << encodeMatchType(tree->matchType());
+void PlanCache::encodeKeyForMatch(const MatchExpression* tree,
+                                  bool parameterizeInLists,
+                                  StringBuilder* keyBuilder) const {
+    // Encode match type and path. An equality is planned like a $in of one value, so with
+    // 'parameterizeInLists' both share the encoding of a $in. The index bounds of the cached plan
+    // are rebuilt from the values of each query when it is instantiated.
+    if (parameterizeInLists && MatchExpression::EQ == tree->matchType()) {
+        *keyBuilder << encodeMatchType(MatchExpression::MATCH_IN);
+    } else {
+        *keyBuilder << encodeMatchType(tree->matchType());
+    }
 
     encodeUserString(tree->path(), keyBuilder);
 
@@ -600,7 +698,7 @@ void PlanCache::encodeKeyForMatch(const MatchExpression* tree, StringBuilder* ke
         if (i > 0) {
             *keyBuilder << kEncodeChildrenSeparator;
         }
-        encodeKeyForMatch(tree->getChild(i), keyBuilder);
+        encodeKeyForMatch(tree->getChild(i), parameterizeInLists, keyBuilder);
     }
     if (tree->numChildren() > 0) {
         *keyBuilder << kEncodeChildrenEnd;
@@ -733,14 +831,54 @@ Status PlanCache::add(const CanonicalQuery& query,
     }
     entry->projection = projBuilder.obj();
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(computeKey(query), entry);
+    const PlanCacheKey key = computeKey(query);
+    entry->sizeEstimateBytes = key.size() + entry->estimateObjectSizeInBytes();
+
+    const size_t entryBytes = entry->sizeEstimateBytes;
+
+    Partition& partition = partitionFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+
+    // The entry being replaced, if any, is deleted by add() below.
+    PlanCacheEntry* replacedEntry;
+    if (partition.cache.get(key, &replacedEntry).isOK()) {
+        releaseBytes(&partition, replacedEntry->sizeEstimateBytes);
+    }
+
+    partition.sizeEstimateBytes += entry->sizeEstimateBytes;
+    chargePlanCacheBytes(entry->sizeEstimateBytes);
+    std::unique_ptr<PlanCacheEntry> evictedEntry = partition.cache.add(key, entry);
 
     if (NULL != evictedEntry.get()) {
+        releaseBytes(&partition, evictedEntry->sizeEstimateBytes);
         LOG(1) << _ns << ": plan cache maximum size exceeded - "
                << "removed least recently used entry " << redact(evictedEntry->toString());
     }
 
+    // Only this partition's lock is held, so the budget shared by all plan caches is enforced by
+    // evicting from this partition alone. Since every cache over budget evicts on its next add,
+    // the total does not stay above the limit for long.
+    const long long maxTotalBytes = internalQueryCacheMaxTotalSizeBytes.load();
+    bool addedEntryEvicted = false;
+    while (static_cast<long long>(planCacheTotalSizeEstimateBytes.get()) > maxTotalBytes) {
+        evictedEntry = partition.cache.removeLeastRecentlyUsed();
+        if (!evictedEntry) {
+            break;
+        }
+        releaseBytes(&partition, evictedEntry->sizeEstimateBytes);
+        addedEntryEvicted = addedEntryEvicted || evictedEntry.get() == entry;
+        LOG(1) << _ns << ": plan cache memory budget of " << maxTotalBytes << " bytes exceeded - "
+               << "removed least recently used entry " << redact(evictedEntry->toString());
+    }
+
+    if (addedEntryEvicted) {
+        return Status(ErrorCodes::ExceededMemoryLimit,
+                      str::stream() << "plan cache entry of " << entryBytes
+                                    << " bytes does not fit in the plan cache memory budget of "
+                                    << maxTotalBytes
+                                    << " bytes");
+    }
+
     return Status::OK();
 }
 
@@ -748,9 +886,10 @@ Status PlanCache::get(const CanonicalQuery& query, CachedSolution** crOut) const
     PlanCacheKey key = computeKey(query);
     verify(crOut);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    Partition& partition = partitionFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
+    Status cacheStatus = partition.cache.get(key, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
@@ -768,9 +907,10 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
     std::unique_ptr<PlanCacheEntryFeedback> autoFeedback(feedback);
     PlanCacheKey ck = computeKey(cq);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    Partition& partition = partitionFor(ck);
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(ck, &entry);
+    Status cacheStatus = partition.cache.get(ck, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
@@ -778,25 +918,43 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
 
     // We store up to a constant number of feedback entries.
     if (entry->feedback.size() < static_cast<size_t>(internalQueryCacheFeedbacksStored.load())) {
+        size_t feedbackBytes = sizeof(*feedback) + sizeof(feedback);
+        if (feedback->stats) {
+            feedbackBytes += estimateStatsSizeInBytes(*feedback->stats);
+        }
         entry->feedback.push_back(autoFeedback.release());
+        entry->sizeEstimateBytes += feedbackBytes;
+        partition.sizeEstimateBytes += feedbackBytes;
+        chargePlanCacheBytes(feedbackBytes);
     }
 
     return Status::OK();
 }
 
 Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.remove(computeKey(canonicalQuery));
+    const PlanCacheKey key = computeKey(canonicalQuery);
+    Partition& partition = partitionFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+    PlanCacheEntry* entry;
+    Status cacheStatus = partition.cache.get(key, &entry);
+    if (!cacheStatus.isOK()) {
+        return cacheStatus;
+    }
+    releaseBytes(&partition, entry->sizeEstimateBytes);
+    return partition.cache.remove(key);
 }
 
 void PlanCache::clear() {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    _cache.clear();
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+        releaseBytes(&partition, partition.sizeEstimateBytes);
+        partition.cache.clear();
+    }
 }
 
 PlanCacheKey PlanCache::computeKey(const CanonicalQuery& cq) const {
     StringBuilder keyBuilder;
-    encodeKeyForMatch(cq.root(), &keyBuilder);
+    encodeKeyForMatch(cq.root(), cq.parameterizeInLists(), &keyBuilder);
     encodeKeyForSort(cq.getQueryRequest().getSort(), &keyBuilder);
     encodeKeyForProj(cq.getQueryRequest().getProj(), &keyBuilder);
     return keyBuilder.str();
@@ -806,9 +964,10 @@ Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOu
     PlanCacheKey key = computeKey(query);
     verify(entryOut);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    Partition& partition = partitionFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
+    Status cacheStatus = partition.cache.get(key, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
@@ -820,25 +979,46 @@ Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOu
 }
 
 std::vector<PlanCacheEntry*> PlanCache::getAllEntries() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
     std::vector<PlanCacheEntry*> entries;
     typedef std::list<std::pair<PlanCacheKey, PlanCacheEntry*>>::const_iterator ConstIterator;
-    for (ConstIterator i = _cache.begin(); i != _cache.end(); i++) {
-        PlanCacheEntry* entry = i->second;
-        entries.push_back(entry->clone());
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+        for (ConstIterator i = partition.cache.begin(); i != partition.cache.end(); i++) {
+            PlanCacheEntry* entry = i->second;
+            entries.push_back(entry->clone());
+        }
     }
 
     return entries;
 }
 
 bool PlanCache::contains(const CanonicalQuery& cq) const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.hasKey(computeKey(cq));
+    const PlanCacheKey key = computeKey(cq);
+    Partition& partition = partitionFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+    return partition.cache.hasKey(key);
 }
 
 size_t PlanCache::size() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.size();
+    size_t size = 0;
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+        size += partition.cache.size();
+    }
+    return size;
+}
+
+size_t PlanCache::sizeEstimateBytes() const {
+    size_t size = 0;
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+        size += partition.sizeEstimateBytes;
+    }
+    return size;
+}
+
+long long PlanCache::totalSizeEstimateBytes() {
+    return planCacheTotalSizeEstimateBytes.get();
 }
 
 void PlanCache::notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries) {
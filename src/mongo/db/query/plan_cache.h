@@ -28,8 +28,10 @@
 
 #pragma once
 
+#include <boost/align/aligned_allocator.hpp>
 #include <boost/optional/optional.hpp>
 #include <set>
+#include <vector>
 
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/query/canonical_query.h"
@@ -39,6 +41,7 @@
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/with_alignment.h"
 
 namespace mongo {
 
@@ -124,6 +127,11 @@ struct PlanCacheIndexTree {
      */
     std::string toString(int indents = 0) const;
 
+    /**
+     * Approximate number of bytes used by this tree, including its children.
+     */
+    size_t estimateObjectSizeInBytes() const;
+
     // Children owned here.
     std::vector<PlanCacheIndexTree*> children;
 
@@ -159,6 +167,9 @@ struct SolutionCacheData {
     // For debugging.
     std::string toString() const;
 
+    // Approximate number of bytes used by this object.
+    size_t estimateObjectSizeInBytes() const;
+
     // Owned here. If 'wholeIXSoln' is false, then 'tree'
     // can be used to tag an isomorphic match expression. If 'wholeIXSoln'
     // is true, then 'tree' is used to store the relevant IndexEntry.
@@ -249,6 +260,11 @@ public:
     // For debugging.
     std::string toString() const;
 
+    /**
+     * Approximate number of bytes used by this entry, not counting its feedback.
+     */
+    size_t estimateObjectSizeInBytes() const;
+
     //
     // Planner data
     //
@@ -279,6 +295,10 @@ public:
     // Annotations from cached runs.  The CachedPlanStage provides these stats about its
     // runs when they complete.
     std::vector<PlanCacheEntryFeedback*> feedback;
+
+    // The number of bytes this entry was charged against the plan cache memory budget, including
+    // its feedback. Maintained by the PlanCache.
+    size_t sizeEstimateBytes = 0;
 };
 
 /**
@@ -402,6 +422,17 @@ public:
      */
     size_t size() const;
 
+    /**
+     * Returns the approximate number of bytes used by the entries in this cache.
+     */
+    size_t sizeEstimateBytes() const;
+
+    /**
+     * Returns the approximate number of bytes used by the entries of all plan caches in the
+     * server. This is what internalQueryCacheMaxTotalSizeBytes is compared against.
+     */
+    static long long totalSizeEstimateBytes();
+
     /**
      * Updates internal state kept about the collection's indexes.  Must be called when the set
      * of indexes on the associated collection have changed.
@@ -411,14 +442,39 @@ public:
     void notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries);
 
 private:
-    void encodeKeyForMatch(const MatchExpression* tree, StringBuilder* keyBuilder) const;
+    void encodeKeyForMatch(const MatchExpression* tree,
+                           bool parameterizeInLists,
+                           StringBuilder* keyBuilder) const;
     void encodeKeyForSort(const BSONObj& sortObj, StringBuilder* keyBuilder) const;
     void encodeKeyForProj(const BSONObj& projObj, StringBuilder* keyBuilder) const;
 
-    LRUKeyValue<PlanCacheKey, PlanCacheEntry> _cache;
+    /**
+     * The cache is split into partitions by hash of the cache key, each its own LRU with its own
+     * lock, so that concurrent queries against one collection rarely contend. Each partition
+     * holds at most 1/kNumPartitions of internalQueryCacheSize entries, and evicts its own least
+     * recently used entries when all plan caches together exceed the memory budget.
+     */
+    struct Partition {
+        Partition();
+
+        // Protects 'cache' and 'sizeEstimateBytes'.
+        mutable stdx::mutex mutex;
+        LRUKeyValue<PlanCacheKey, PlanCacheEntry> cache;
+        size_t sizeEstimateBytes = 0;
+    };
+    static constexpr size_t kNumPartitions = 8;
+
+    Partition& partitionFor(const PlanCacheKey& key) const;
+
+    /**
+     * Removes 'bytes' from the accounting of 'partition', whose mutex must be held.
+     */
+    static void releaseBytes(Partition* partition, size_t bytes);
+
+    template <typename T>
+    using AlignedVector = std::vector<T, boost::alignment::aligned_allocator<T>>;
 
-    // Protects _cache.
-    mutable stdx::mutex _cacheMutex;
+    mutable AlignedVector<CacheAligned<Partition>> _partitions;
 
     // Full namespace of collection.
     std::string _ns;
@@ -0,0 +1,86 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/extensions_callback_noop.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/query_test_service_context.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/benchmark.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("test.collection");
+
+std::unique_ptr<CanonicalQuery> canonicalize(const char* filter,
+                                             const char* sort,
+                                             const char* proj) {
+    QueryTestServiceContext serviceContext;
+    auto opCtx = serviceContext.makeOperationContext();
+
+    auto qr = stdx::make_unique<QueryRequest>(kNss);
+    qr->setFilter(fromjson(filter));
+    qr->setSort(fromjson(sort));
+    qr->setProj(fromjson(proj));
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    return uassertStatusOK(
+        CanonicalQuery::canonicalize(opCtx.get(),
+                                     std::move(qr),
+                                     expCtx,
+                                     ExtensionsCallbackNoop(),
+                                     MatchExpressionParser::kAllowAllSpecialFeatures));
+}
+
+void runComputeKey(benchmark::State& state, const CanonicalQuery& cq) {
+    PlanCache planCache;
+    for (auto _ : state) {
+        benchmark::doNotOptimizeAway(planCache.computeKey(cq));
+    }
+}
+
+void BM_computeKeySimple(benchmark::State& state) {
+    runComputeKey(state, *canonicalize("{a: 1}", "{}", "{}"));
+}
+BENCHMARK(BM_computeKeySimple);
+
+void BM_computeKeyCompound(benchmark::State& state) {
+    runComputeKey(state,
+                  *canonicalize("{a: {$gt: 5}, b: {$in: [1, 2, 3]}, $or: [{c: 1}, {d: {$lt: 2}}]}",
+                                "{a: 1, e: -1}",
+                                "{_id: 0, a: 1, b: 1}"));
+}
+BENCHMARK(BM_computeKeyCompound);
+
+}  // namespace
+}  // namespace mongo
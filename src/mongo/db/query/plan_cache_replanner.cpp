@@ -0,0 +1,212 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cache_replanner.h"
+
+#include "mongo/base/counter.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/exec/multi_plan.h"
+#include "mongo/db/matcher/extensions_callback_real.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/explain.h"
+#include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/stage_builder.h"
+#include "mongo/db/service_context.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/transitional_tools_do_not_use/vector_spooling.h"
+
+namespace mongo {
+
+namespace {
+
+const auto getPlanCacheReplanner = ServiceContext::declareDecoration<PlanCacheReplanner>();
+
+Counter64 staleCachedPlans;
+Counter64 backgroundReplansScheduled;
+Counter64 backgroundReplansDropped;
+Counter64 backgroundReplansFailed;
+
+ServerStatusMetricField<Counter64> displayStaleCachedPlans("query.planCache.staleDetections",
+                                                           &staleCachedPlans);
+ServerStatusMetricField<Counter64> displayBackgroundReplansScheduled(
+    "query.planCache.backgroundReplans.scheduled", &backgroundReplansScheduled);
+ServerStatusMetricField<Counter64> displayBackgroundReplansDropped(
+    "query.planCache.backgroundReplans.dropped", &backgroundReplansDropped);
+ServerStatusMetricField<Counter64> displayBackgroundReplansFailed(
+    "query.planCache.backgroundReplans.failed", &backgroundReplansFailed);
+
+ThreadPool::Options makeThreadPoolOptions() {
+    ThreadPool::Options options;
+    options.poolName = "PlanCacheReplanner";
+    options.minThreads = 0;
+    options.maxThreads = 1;
+    options.onCreateThread = [](const std::string& threadName) {
+        Client::initThread(threadName.c_str());
+    };
+    return options;
+}
+
+}  // namespace
+
+PlanCacheReplanner::PlanCacheReplanner() : _pool(makeThreadPoolOptions()) {}
+
+// static
+PlanCacheReplanner* PlanCacheReplanner::get(ServiceContext* serviceContext) {
+    return &getPlanCacheReplanner(serviceContext);
+}
+
+// static
+void PlanCacheReplanner::recordStalePlan() {
+    staleCachedPlans.increment();
+}
+
+bool PlanCacheReplanner::schedule(const CanonicalQuery& query, const std::string& planCacheKey) {
+    const NamespaceString nss = query.nss();
+    std::string pendingKey = nss.ns() + '\0' + planCacheKey;
+    BSONObj findCommand = query.getQueryRequest().asFindCommand();
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_pending.size() >= kMaxPendingReplans || !_pending.insert(pendingKey).second) {
+        backgroundReplansDropped.increment();
+        return false;
+    }
+
+    if (!_started) {
+        _pool.startup();
+        _started = true;
+    }
+
+    Status status = _pool.schedule([this, nss, findCommand, pendingKey] {
+        ON_BLOCK_EXIT([this, &pendingKey] {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _pending.erase(pendingKey);
+        });
+        _replan(nss, findCommand);
+    });
+    if (!status.isOK()) {
+        _pending.erase(pendingKey);
+        backgroundReplansDropped.increment();
+        return false;
+    }
+
+    backgroundReplansScheduled.increment();
+    return true;
+}
+
+void PlanCacheReplanner::waitForIdle() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (!_started) {
+            return;
+        }
+    }
+    _pool.waitForIdle();
+}
+
+// static
+void PlanCacheReplanner::_replan(const NamespaceString& nss, const BSONObj& findCommand) {
+    try {
+        auto opCtx = cc().makeOperationContext();
+        AutoGetCollectionForRead autoColl(opCtx.get(), nss);
+        Collection* collection = autoColl.getCollection();
+        if (!collection) {
+            return;
+        }
+
+        const bool isExplain = false;
+        auto qr = uassertStatusOK(QueryRequest::makeFromFindCommand(nss, findCommand, isExplain));
+        ExtensionsCallbackReal extensionsCallback(opCtx.get(), &nss);
+        const boost::intrusive_ptr<ExpressionContext> expCtx;
+        auto cq = uassertStatusOK(
+            CanonicalQuery::canonicalize(opCtx.get(),
+                                         std::move(qr),
+                                         expCtx,
+                                         extensionsCallback,
+                                         MatchExpressionParser::kAllowAllSpecialFeatures &
+                                             ~MatchExpressionParser::AllowedFeatures::kExpr));
+
+        QueryPlannerParams plannerParams;
+        fillOutPlannerParams(opCtx.get(), collection, cq.get(), &plannerParams);
+
+        std::vector<QuerySolution*> rawSolutions;
+        uassertStatusOK(QueryPlanner::plan(*cq, plannerParams, &rawSolutions));
+        std::vector<std::unique_ptr<QuerySolution>> solutions =
+            transitional_tools_do_not_use::spool_vector(rawSolutions);
+
+        // A single solution is not cached, so the stale entry just goes away.
+        PlanCache* planCache = collection->infoCache()->getPlanCache();
+        if (solutions.size() < 2) {
+            planCache->remove(*cq).transitional_ignore();
+            return;
+        }
+
+        auto ws = stdx::make_unique<WorkingSet>();
+        auto multiPlanStage = stdx::make_unique<MultiPlanStage>(
+            opCtx.get(), collection, cq.get(), MultiPlanStage::CachingMode::AlwaysCache);
+        for (auto&& solution : solutions) {
+            if (solution->cacheData) {
+                solution->cacheData->indexFilterApplied = plannerParams.indexFiltersApplied;
+            }
+
+            PlanStage* root;
+            verify(StageBuilder::build(opCtx.get(), collection, *cq, *solution, ws.get(), &root));
+
+            // Takes ownership of 'solution' and 'root'.
+            multiPlanStage->addPlan(solution.release(), root, ws.get());
+        }
+
+        // Building the executor runs the trial, and the MultiPlanStage then replaces the cache
+        // entry with the winner.
+        auto exec = uassertStatusOK(PlanExecutor::make(opCtx.get(),
+                                                       std::move(ws),
+                                                       std::move(multiPlanStage),
+                                                       std::move(cq),
+                                                       collection,
+                                                       PlanExecutor::YIELD_AUTO));
+        LOG(1) << "Background replanning of " << redact(exec->getCanonicalQuery()->toStringShort())
+               << " resulted in plan with summary: " << redact(Explain::getPlanSummary(exec.get()));
+    } catch (const DBException& ex) {
+        backgroundReplansFailed.increment();
+        LOG(1) << "Background replanning of a query on " << nss.ns()
+               << " failed: " << redact(ex.toStatus());
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,100 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <set>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+
+class BSONObj;
+class CanonicalQuery;
+class NamespaceString;
+class ServiceContext;
+
+/**
+ * Re-evaluates stale plan cache entries in the background. When a cached plan needs far more works
+ * than it was cached with, CachedPlanStage can hand the query to the replanner and keep running
+ * the cached plan, rather than replanning on the user's operation.
+ *
+ * A single worker thread reruns the multi-plan trial for a copy of the query, and the winner
+ * replaces the stale entry in the collection's plan cache. At most one re-evaluation per query
+ * shape is pending at a time.
+ */
+class PlanCacheReplanner {
+    MONGO_DISALLOW_COPYING(PlanCacheReplanner);
+
+public:
+    // The most re-evaluations that may be pending at once; more are dropped.
+    static constexpr size_t kMaxPendingReplans = 32;
+
+    PlanCacheReplanner();
+
+    static PlanCacheReplanner* get(ServiceContext* serviceContext);
+
+    /**
+     * Counts a cached plan found to need more works than internalQueryCacheEvictionRatio allows,
+     * whether it is then replanned inline or in the background.
+     */
+    static void recordStalePlan();
+
+    /**
+     * Schedules a re-evaluation of the cached plan for 'query', whose plan cache key is
+     * 'planCacheKey'. Returns false if one is already pending for that key, or too many are
+     * pending.
+     */
+    bool schedule(const CanonicalQuery& query, const std::string& planCacheKey);
+
+    /**
+     * Waits until no re-evaluation is pending or running. Used for testing.
+     */
+    void waitForIdle();
+
+private:
+    /**
+     * Reruns the multi-plan trial for the query described by 'findCommand' against 'nss', which
+     * installs the winner in the plan cache.
+     */
+    static void _replan(const NamespaceString& nss, const BSONObj& findCommand);
+
+    stdx::mutex _mutex;
+
+    // Started on first use.
+    ThreadPool _pool;
+    bool _started = false;
+
+    // Namespace and plan cache key of each pending re-evaluation.
+    std::set<std::string> _pending;
+};
+
+}  // namespace mongo
@@ -449,6 +449,106 @@ TEST(PlanCacheTest, AddValidSolution) {
     ASSERT_EQUALS(planCache.size(), 1U);
 }
 
+TEST(PlanCacheTest, SizeEstimateTracksEntries) {
+    const long long baselineTotalBytes = PlanCache::totalSizeEstimateBytes();
+    PlanCache planCache;
+    ASSERT_EQUALS(planCache.sizeEstimateBytes(), 0U);
+
+    unique_ptr<CanonicalQuery> cqA(canonicalize("{a: 1}"));
+    unique_ptr<CanonicalQuery> cqB(canonicalize("{b: 1, c: 1}"));
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    ASSERT_OK(planCache.add(*cqA, solns, createDecision(1U)));
+    const size_t bytesA = planCache.sizeEstimateBytes();
+    ASSERT_GREATER_THAN(bytesA, 0U);
+    ASSERT_OK(planCache.add(*cqB, solns, createDecision(1U)));
+    ASSERT_GREATER_THAN(planCache.sizeEstimateBytes(), bytesA);
+    ASSERT_EQUALS(PlanCache::totalSizeEstimateBytes(),
+                  baselineTotalBytes + static_cast<long long>(planCache.sizeEstimateBytes()));
+
+    // Replacing an entry does not count it twice.
+    const size_t bytesAB = planCache.sizeEstimateBytes();
+    ASSERT_OK(planCache.add(*cqA, solns, createDecision(1U)));
+    ASSERT_EQUALS(planCache.sizeEstimateBytes(), bytesAB);
+
+    // Stored feedback is charged to the entry.
+    auto feedback = stdx::make_unique<PlanCacheEntryFeedback>();
+    feedback->stats = stdx::make_unique<PlanStageStats>(CommonStats("COLLSCAN"), STAGE_COLLSCAN);
+    feedback->score = 0;
+    ASSERT_OK(planCache.feedback(*cqB, feedback.release()));
+    ASSERT_GREATER_THAN(planCache.sizeEstimateBytes(), bytesAB);
+
+    ASSERT_OK(planCache.remove(*cqB));
+    ASSERT_EQUALS(planCache.sizeEstimateBytes(), bytesA);
+    planCache.clear();
+    ASSERT_EQUALS(planCache.sizeEstimateBytes(), 0U);
+    ASSERT_EQUALS(PlanCache::totalSizeEstimateBytes(), baselineTotalBytes);
+}
+
+TEST(PlanCacheTest, GetAllEntriesListsEveryPartition) {
+    PlanCache planCache;
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    const size_t numEntries = 50;
+    for (size_t i = 0; i < numEntries; ++i) {
+        unique_ptr<CanonicalQuery> cq(canonicalize(BSON(("a" + std::to_string(i)) << 1)));
+        ASSERT_OK(planCache.add(*cq, solns, createDecision(1U)));
+    }
+    ASSERT_EQUALS(planCache.size(), numEntries);
+
+    std::vector<PlanCacheEntry*> entries = planCache.getAllEntries();
+    ON_BLOCK_EXIT([&entries] {
+        for (auto entry : entries) {
+            delete entry;
+        }
+    });
+    ASSERT_EQUALS(entries.size(), numEntries);
+}
+
+TEST(PlanCacheTest, MemoryBudgetEvictsLeastRecentlyUsedEntries) {
+    const long long oldMaxTotalBytes = internalQueryCacheMaxTotalSizeBytes.load();
+    ON_BLOCK_EXIT([oldMaxTotalBytes] {
+        internalQueryCacheMaxTotalSizeBytes.store(oldMaxTotalBytes);
+    });
+
+    // The three queries have equally large cache entries.
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cqA(canonicalize("{a: 1}"));
+    unique_ptr<CanonicalQuery> cqB(canonicalize("{b: 1}"));
+    unique_ptr<CanonicalQuery> cqC(canonicalize("{c: 1}"));
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    ASSERT_OK(planCache.add(*cqA, solns, createDecision(1U)));
+    const long long entryBytes = planCache.sizeEstimateBytes();
+
+    // There is room for one entry only, so adding 'b' evicts 'a'.
+    internalQueryCacheMaxTotalSizeBytes.store(PlanCache::totalSizeEstimateBytes() +
+                                              entryBytes / 2);
+    ASSERT_OK(planCache.add(*cqB, solns, createDecision(1U)));
+    ASSERT_FALSE(planCache.contains(*cqA));
+    ASSERT_TRUE(planCache.contains(*cqB));
+    ASSERT_EQUALS(planCache.size(), 1U);
+
+    // Without room for any entry, adding 'c' evicts both 'b' and 'c' and reports the failure.
+    internalQueryCacheMaxTotalSizeBytes.store(PlanCache::totalSizeEstimateBytes() - 1);
+    ASSERT_EQUALS(planCache.add(*cqC, solns, createDecision(1U)),
+                  ErrorCodes::ExceededMemoryLimit);
+    ASSERT_EQUALS(planCache.size(), 0U);
+    ASSERT_EQUALS(planCache.sizeEstimateBytes(), 0U);
+}
+
 /**
  * Each test in the CachePlanSelectionTest suite goes through
  * the following flow:
@@ -1426,6 +1526,34 @@ TEST(PlanCacheTest, ComputeKey) {
     testComputeKey("{$or: [{a: 1}]}", "{}", "{'a.$': 1}", "eqa|ia.$");
 }
 
+TEST(PlanCacheTest, ComputeKeyParameterizedInLists) {
+    PlanCache planCache;
+    ASSERT_NOT_EQUALS(planCache.computeKey(*canonicalize("{a: 1, b: {$gt: 1}}")),
+                      planCache.computeKey(*canonicalize("{a: {$in: [1, 2]}, b: {$gt: 1}}")));
+
+    const bool oldParameterizeInLists = internalQueryCacheParameterizeInLists.load();
+    ON_BLOCK_EXIT([oldParameterizeInLists] {
+        internalQueryCacheParameterizeInLists.store(oldParameterizeInLists);
+    });
+    internalQueryCacheParameterizeInLists.store(true);
+
+    // Equalities and $in lists of any length share a key.
+    testComputeKey("{a: 1}", "{}", "{}", "ina");
+    testComputeKey("{a: {$in: [1]}}", "{}", "{}", "ina");
+    testComputeKey("{a: {$in: [1, 2, 3]}}", "{}", "{}", "ina");
+
+    // Replacing an equality by a $in does not reorder the other predicates.
+    PlanCacheKey key = planCache.computeKey(*canonicalize("{a: 1, b: {$gt: 1}, c: 1}"));
+    ASSERT_EQUALS(key,
+                  planCache.computeKey(*canonicalize("{a: {$in: [1, 2]}, b: {$gt: 1}, c: 1}")));
+    ASSERT_EQUALS(
+        key, planCache.computeKey(*canonicalize("{a: {$in: [1, 2]}, b: {$gt: 1}, c: {$in: [3]}}")));
+
+    // Other predicates keep their own encoding.
+    testComputeKey("{a: {$gt: 1}}", "{}", "{}", "gta");
+    testComputeKey("{a: {$in: [/foo/]}}", "{}", "{}", "rea");
+}
+
 // Delimiters found in user field names or non-standard projection field values
 // must be escaped.
 TEST(PlanCacheTest, ComputeKeyEscaped) {
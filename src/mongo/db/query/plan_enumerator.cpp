@@ -257,6 +257,7 @@ PlanEnumerator::PlanEnumerator(const PlanEnumeratorParams& params)
     : _root(params.root),
       _indices(params.indices),
       _ixisect(params.intersect),
+      _skipScan(params.skipScan),
       _orLimit(params.maxSolutionsPerOr),
       _intersectLimit(params.maxIntersectPerAnd) {}
 
@@ -923,6 +924,36 @@ void PlanEnumerator::enumerateOneIndex(
             andAssignment->choices.push_back(std::move(state));
         }
     }
+
+    if (!_skipScan) {
+        return;
+    }
+
+    // Indices that only have predicates over their later fields can be skip scanned. The
+    // leading fields get all-values bounds, and the index scan seeks from each distinct prefix to
+    // the bounds of the later fields. We only do this for non-multikey btree indices, so that all
+    // of the predicates can be compounded.
+    for (IndexToPredMap::const_iterator it = idxToNotFirst.begin(); it != idxToNotFirst.end();
+         ++it) {
+        const IndexEntry& thisIndex = (*_indices)[it->first];
+        if (idxToFirst.find(it->first) != idxToFirst.end() || thisIndex.multikey ||
+            INDEX_BTREE != thisIndex.type) {
+            continue;
+        }
+
+        OneIndexAssignment indexAssign;
+        indexAssign.index = it->first;
+        for (auto pred : it->second) {
+            assignPredicate(outsidePreds, pred, getPosition(thisIndex, pred), &indexAssign);
+        }
+
+        // Do not output this assignment if it consists only of outside predicates.
+        if (!indexAssign.preds.empty()) {
+            AndEnumerableState state;
+            state.assignments.push_back(std::move(indexAssign));
+            andAssignment->choices.push_back(std::move(state));
+        }
+    }
 }
 
 void PlanEnumerator::enumerateAndIntersect(const IndexToPredMap& idxToFirst,
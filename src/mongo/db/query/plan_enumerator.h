@@ -43,6 +43,7 @@ namespace mongo {
 struct PlanEnumeratorParams {
     PlanEnumeratorParams()
         : intersect(false),
+          skipScan(false),
           maxSolutionsPerOr(internalQueryEnumerationMaxOrSolutions.load()),
           maxIntersectPerAnd(internalQueryEnumerationMaxIntersectPerAnd.load()) {}
 
@@ -50,6 +51,10 @@ struct PlanEnumeratorParams {
     // an indexed solution?
     bool intersect;
 
+    // Do we assign predicates to an index that has none over its leading field? The index is
+    // then skip scanned, seeking past each distinct value of the leading fields.
+    bool skipScan;
+
     // Not owned here.
     MatchExpression* root;
 
@@ -495,6 +500,9 @@ private:
     // Do we output >1 index per AND (index intersection)?
     bool _ixisect;
 
+    // Do we output assignments with no predicate over the leading field of the index?
+    bool _skipScan;
+
     // How many enumerations are we willing to produce from each OR?
     size_t _orLimit;
 
@@ -47,6 +47,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/query/mock_yield_policies.h"
 #include "mongo/db/query/plan_yield_policy.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/record_fetcher.h"
@@ -303,6 +304,10 @@ CanonicalQuery* PlanExecutor::getCanonicalQuery() const {
     return _cq.get();
 }
 
+const QuerySolution* PlanExecutor::getQuerySolution() const {
+    return _qs.get();
+}
+
 unique_ptr<PlanStageStats> PlanExecutor::getStats() const {
     return _root->getStats();
 }
@@ -543,7 +548,7 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
         fetcher.reset();
 
         WorkingSetID id = WorkingSet::INVALID_ID;
-        PlanStage::StageState code = _root->work(&id);
+        PlanStage::StageState code = _workRoot(&id);
 
         if (code != PlanStage::NEED_YIELD)
             writeConflictsInARow = 0;
@@ -630,9 +635,33 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
     }
 }
 
+PlanStage::StageState PlanExecutor::_workRoot(WorkingSetID* out) {
+    if (_batchPosition < _batch.size()) {
+        *out = _batch[_batchPosition++];
+        return PlanStage::ADVANCED;
+    }
+
+    const int batchSize = internalQueryExecBatchSize.load();
+    if (batchSize <= 1 ||
+        !_opCtx->getServiceContext()->getGlobalStorageEngine()->supportsDocLocking()) {
+        return _root->work(out);
+    }
+
+    // Batched results stay in the working set until they are returned, which relies on the
+    // storage engine not invalidating records under the plan.
+    _batch.clear();
+    _batchPosition = 0;
+    PlanStage::StageState code = _root->workBatch(batchSize, &_batch);
+    if (!_batch.empty()) {
+        *out = _batch[_batchPosition++];
+    }
+    return code;
+}
+
 bool PlanExecutor::isEOF() {
     invariant(_currentState == kUsable);
-    return isMarkedAsKilled() || (_stash.empty() && _root->isEOF());
+    return isMarkedAsKilled() ||
+        (_stash.empty() && _batchPosition == _batch.size() && _root->isEOF());
 }
 
 void PlanExecutor::markAsKilled(string reason) {
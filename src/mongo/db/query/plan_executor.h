@@ -33,6 +33,7 @@
 
 #include "mongo/base/status.h"
 #include "mongo/db/catalog/util/partitioned.h"
+#include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/invalidation_type.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/storage/snapshot.h"
@@ -260,6 +261,13 @@ public:
      */
     CanonicalQuery* getCanonicalQuery() const;
 
+    /**
+     * Get the solution that this executor was built from, without transferring ownership. Returns
+     * nullptr if the executor was not built from a single solution, as when plans are still
+     * being ranked by a MultiPlanStage.
+     */
+    const QuerySolution* getQuerySolution() const;
+
     /**
      * Return the NS that the query is running over.
      */
@@ -492,6 +500,11 @@ private:
 
     ExecState getNextImpl(Snapshotted<BSONObj>* objOut, RecordId* dlOut);
 
+    /**
+     * Gets the next result or state from '_root', going through '_batch' when batching is enabled.
+     */
+    PlanStage::StageState _workRoot(WorkingSetID* out);
+
     /**
      * New PlanExecutor instances are created with the static make() methods above.
      */
@@ -574,6 +587,11 @@ private:
     // stages.
     std::queue<BSONObj> _stash;
 
+    // Results produced by the last PlanStage::workBatch() call on '_root' that haven't been
+    // returned yet, starting at '_batchPosition'. See internalQueryExecBatchSize.
+    std::vector<WorkingSetID> _batch;
+    size_t _batchPosition = 0;
+
     enum { kUsable, kSaved, kDetached, kDisposed } _currentState = kUsable;
 
     // Set if this PlanExecutor is registered with the CursorManager.
@@ -32,6 +32,8 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <numeric>
 #include <utility>
 #include <vector>
 
@@ -57,6 +59,137 @@ bool scoreComparator(const std::pair<double, size_t>& lhs, const std::pair<doubl
     return lhs.first > rhs.first;
 }
 
+// Fractions of the documents assumed to match a point and a range interval on an index field.
+const double kPointIntervalSelectivity = 0.01;
+const double kRangeIntervalSelectivity = 0.3;
+
+bool isFullInterval(const mongo::Interval& interval) {
+    return (interval.start.type() == mongo::MinKey && interval.end.type() == mongo::MaxKey) ||
+        (interval.start.type() == mongo::MaxKey && interval.end.type() == mongo::MinKey);
+}
+
+/**
+ * Estimates the number of keys examined by 'ixscan'. Sets 'isUpperBound' to whether the scan is
+ * certain to examine no more keys than that.
+ */
+double estimateKeysExamined(const mongo::IndexScanNode& ixscan,
+                            double numRecords,
+                            bool* isUpperBound) {
+    const mongo::IndexBounds& bounds = ixscan.bounds;
+    *isUpperBound = false;
+    if (bounds.isSimpleRange) {
+        return numRecords * kRangeIntervalSelectivity;
+    }
+
+    double selectivity = 1;
+    double numPoints = 1;
+    bool allPoints = true;
+    for (auto&& oil : bounds.fields) {
+        double fieldSelectivity = 0;
+        for (auto&& interval : oil.intervals) {
+            if (interval.isPoint()) {
+                fieldSelectivity += kPointIntervalSelectivity;
+            } else {
+                allPoints = false;
+                fieldSelectivity += isFullInterval(interval) ? 1.0 : kRangeIntervalSelectivity;
+            }
+        }
+        selectivity *= std::min(1.0, fieldSelectivity);
+        numPoints *= oil.intervals.size();
+
+        // The fields after the first one that is not bounded by points do not narrow the range of
+        // keys scanned.
+        if (!allPoints) {
+            break;
+        }
+    }
+
+    if (allPoints && ixscan.index.unique && !ixscan.index.multikey) {
+        *isUpperBound = true;
+        return std::min(numPoints, numRecords);
+    }
+    return numRecords * selectivity;
+}
+
+/**
+ * Adds the work done by the subtree rooted at 'node' to 'estimate', and sets 'nReturned' to the
+ * number of results it produces. Returns false if the subtree cannot be estimated.
+ */
+bool estimateNode(const mongo::QuerySolutionNode* node,
+                  double numRecords,
+                  mongo::PlanCostEstimate* estimate,
+                  double* nReturned) {
+    using namespace mongo;
+
+    switch (node->getType()) {
+        case STAGE_COLLSCAN:
+            estimate->docsExamined += numRecords;
+            *nReturned = numRecords;
+            return true;
+        case STAGE_IXSCAN: {
+            bool isUpperBound;
+            *nReturned = estimateKeysExamined(
+                *static_cast<const IndexScanNode*>(node), numRecords, &isUpperBound);
+            estimate->keysExamined += *nReturned;
+            estimate->isUpperBound = estimate->isUpperBound && isUpperBound;
+            return true;
+        }
+        case STAGE_FETCH:
+            if (!estimateNode(node->children[0], numRecords, estimate, nReturned)) {
+                return false;
+            }
+            estimate->docsExamined += *nReturned;
+            return true;
+        case STAGE_AND_HASH:
+        case STAGE_AND_SORTED:
+        case STAGE_OR:
+        case STAGE_SORT_MERGE: {
+            const bool isIntersection =
+                STAGE_AND_HASH == node->getType() || STAGE_AND_SORTED == node->getType();
+            *nReturned = isIntersection ? numRecords : 0;
+            for (auto&& child : node->children) {
+                double childReturned;
+                if (!estimateNode(child, numRecords, estimate, &childReturned)) {
+                    return false;
+                }
+                if (isIntersection) {
+                    *nReturned = std::min(*nReturned, childReturned);
+                } else {
+                    *nReturned += childReturned;
+                }
+            }
+            return true;
+        }
+        case STAGE_SORT: {
+            if (!estimateNode(node->children[0], numRecords, estimate, nReturned)) {
+                return false;
+            }
+            estimate->docsSorted += *nReturned;
+            const size_t limit = static_cast<const SortNode*>(node)->limit;
+            if (limit > 0) {
+                *nReturned = std::min(*nReturned, static_cast<double>(limit));
+            }
+            return true;
+        }
+        case STAGE_LIMIT:
+            if (!estimateNode(node->children[0], numRecords, estimate, nReturned)) {
+                return false;
+            }
+            *nReturned = std::min(*nReturned,
+                                  static_cast<double>(static_cast<const LimitNode*>(node)->limit));
+            return true;
+        case STAGE_SKIP:
+        case STAGE_PROJECTION:
+        case STAGE_SHARDING_FILTER:
+        case STAGE_KEEP_MUTATIONS:
+        case STAGE_SORT_KEY_GENERATOR:
+        case STAGE_ENSURE_SORTED:
+            return estimateNode(node->children[0], numRecords, estimate, nReturned);
+        default:
+            return false;
+    }
+}
+
 }  // namespace
 
 namespace mongo {
@@ -112,13 +245,34 @@ size_t PlanRanker::pickBestPlan(const vector<CandidatePlan>& candidates, PlanRan
         scoresAndCandidateindices.begin(), scoresAndCandidateindices.end(), scoreComparator);
 
     // Determine whether plans tied for the win.
+    const double epsilon = 1e-10;
     if (scoresAndCandidateindices.size() > 1U) {
         double bestScore = scoresAndCandidateindices[0].first;
         double runnerUpScore = scoresAndCandidateindices[1].first;
-        const double epsilon = 1e-10;
         why->tieForBest = std::abs(bestScore - runnerUpScore) < epsilon;
     }
 
+    // Break a tie for the win by estimated cost, so that equally productive plans do not take
+    // turns winning from one run to the next.
+    if (why->tieForBest) {
+        auto tiedEnd = std::find_if(scoresAndCandidateindices.begin(),
+                                    scoresAndCandidateindices.end(),
+                                    [&](const std::pair<double, size_t>& scoreAndCandidate) {
+                                        return std::abs(scoresAndCandidateindices[0].first -
+                                                        scoreAndCandidate.first) >= epsilon;
+                                    });
+        auto estimatedCost = [&](const std::pair<double, size_t>& scoreAndCandidate) {
+            const auto& costEstimate = candidates[scoreAndCandidate.second].solution->costEstimate;
+            return costEstimate ? costEstimate->cost() : std::numeric_limits<double>::infinity();
+        };
+        std::stable_sort(
+            scoresAndCandidateindices.begin(),
+            tiedEnd,
+            [&](const std::pair<double, size_t>& lhs, const std::pair<double, size_t>& rhs) {
+                return estimatedCost(lhs) < estimatedCost(rhs);
+            });
+    }
+
     // Update results in 'why'
     // Stats and scores in 'why' are sorted in descending order by score.
     why->stats.clear();
@@ -261,4 +415,67 @@ double PlanRanker::scoreTree(const PlanStageStats* stats) {
     return score;
 }
 
+// static
+boost::optional<PlanCostEstimate> PlanRanker::estimateCost(const QuerySolution& solution,
+                                                           long long numRecords) {
+    if (!solution.root) {
+        return boost::none;
+    }
+
+    PlanCostEstimate estimate;
+    if (!estimateNode(
+            solution.root.get(), static_cast<double>(numRecords), &estimate, &estimate.nReturned)) {
+        return boost::none;
+    }
+    return estimate;
+}
+
+// static
+std::vector<size_t> PlanRanker::selectCandidatesByCost(
+    const std::vector<QuerySolution*>& solutions) {
+    // A plan certain to be cheap runs without a race, since no other candidate could win back the
+    // works spent racing it.
+    const double maxCostToSkipRace = internalQueryPlannerMaxCostToSkipMultiPlanning.load();
+    boost::optional<size_t> cheapestBounded;
+    for (size_t i = 0; i < solutions.size(); ++i) {
+        const auto& estimate = solutions[i]->costEstimate;
+        if (maxCostToSkipRace > 0 && estimate && estimate->isUpperBound &&
+            estimate->cost() <= maxCostToSkipRace &&
+            (!cheapestBounded ||
+             estimate->cost() < solutions[*cheapestBounded]->costEstimate->cost())) {
+            cheapestBounded = i;
+        }
+    }
+    if (cheapestBounded) {
+        return {*cheapestBounded};
+    }
+
+    std::vector<size_t> candidates(solutions.size());
+    std::iota(candidates.begin(), candidates.end(), 0);
+
+    const double costRatio = internalQueryPlannerCostRatioToSkipCandidate.load();
+    if (costRatio <= 0) {
+        return candidates;
+    }
+
+    double minCost = std::numeric_limits<double>::infinity();
+    for (auto&& solution : solutions) {
+        if (!solution->costEstimate) {
+            return candidates;
+        }
+        minCost = std::min(minCost, solution->costEstimate->cost());
+    }
+
+    // Every plan does at least one work, so a cost below one does not make the others look
+    // arbitrarily expensive.
+    const double maxCost = std::max(minCost, 1.0) * costRatio;
+    candidates.erase(std::remove_if(candidates.begin(),
+                                    candidates.end(),
+                                    [&](size_t i) {
+                                        return solutions[i]->costEstimate->cost() > maxCost;
+                                    }),
+                     candidates.end());
+    return candidates;
+}
+
 }  // namespace mongo
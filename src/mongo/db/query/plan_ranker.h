@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <list>
 #include <memory>
 #include <vector>
@@ -62,6 +63,26 @@ public:
      * the plan. The exact value isn't meaningful except for imposing a ranking.
      */
     static double scoreTree(const PlanStageStats* stats);
+
+    /**
+     * Estimates the work 'solution' does against a collection of 'numRecords' documents, from the
+     * shape of its index bounds. Returns boost::none if the plan has a stage the estimate does not
+     * model, such as a text or geo search.
+     *
+     * No statistics about the values in the collection are kept, so each interval on an index
+     * field is assumed to match a fixed fraction of the documents, and filters are assumed to
+     * pass everything. The estimate is an upper bound only for scans of a unique index that are
+     * bounded by points on all of its fields, which examine at most one key per point.
+     */
+    static boost::optional<PlanCostEstimate> estimateCost(const QuerySolution& solution,
+                                                          long long numRecords);
+
+    /**
+     * Returns the indices of the candidates in 'solutions' that are worth racing against each
+     * other, judged by their 'costEstimate'. A single index means that this plan should run
+     * without a race.
+     */
+    static std::vector<size_t> selectCandidatesByCost(const std::vector<QuerySolution*>& solutions);
 };
 
 /**
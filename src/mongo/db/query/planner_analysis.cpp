@@ -267,6 +267,36 @@ bool hasNode(QuerySolutionNode* root, StageType type) {
     return false;
 }
 
+/**
+ * Returns true if the index keys flowing out of 'solnRoot', which has not fetched, hold every field
+ * of 'sortObj' with the values that the fetched documents would be sorted by.
+ */
+bool sortCoveredByIndexKeys(const CanonicalQuery& query,
+                            const BSONObj& sortObj,
+                            QuerySolutionNode* solnRoot) {
+    // The sort key generator only applies the query's collation to documents, and an index with a
+    // collation holds collation keys rather than the strings of the document.
+    if (query.getCollator()) {
+        return false;
+    }
+
+    vector<QuerySolutionNode*> leafNodes;
+    getLeafNodes(solnRoot, &leafNodes);
+    for (QuerySolutionNode* leaf : leafNodes) {
+        if (STAGE_IXSCAN != leaf->getType() ||
+            static_cast<IndexScanNode*>(leaf)->index.collator) {
+            return false;
+        }
+    }
+
+    for (auto&& elt : sortObj) {
+        if (!elt.isNumber() || !solnRoot->hasField(elt.fieldName())) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void geoSkipValidationOn(const std::set<StringData>& twoDSphereFields,
                          QuerySolutionNode* solnRoot) {
     // If there is a GeoMatchExpression in the tree on a field with a 2dsphere index,
@@ -290,6 +320,20 @@ void geoSkipValidationOn(const std::set<StringData>& twoDSphereFields,
     }
 }
 
+/**
+ * Passes 'limit' down to a GEO_NEAR_2DSPHERE node under 'root', provided that none of the nodes in
+ * between may drop any of its results.
+ */
+void setGeoNearLimit(QuerySolutionNode* root, long long limit) {
+    while (root->children.size() == 1 && !root->filter &&
+           (STAGE_PROJECTION == root->getType() || STAGE_FETCH == root->getType())) {
+        root = root->children[0];
+    }
+    if (STAGE_GEO_NEAR_2DSPHERE == root->getType()) {
+        static_cast<GeoNear2DSphereNode*>(root)->limit = limit;
+    }
+}
+
 }  // namespace
 
 // static
@@ -513,10 +557,12 @@ QuerySolutionNode* QueryPlannerAnalysis::analyzeSort(const CanonicalQuery& query
         return NULL;
     }
 
-    // Add a fetch stage so we have the full object when we hit the sort stage.  TODO: Can we
-    // pull the values that we sort by out of the key and if so in what cases?  Perhaps we can
-    // avoid a fetch.
-    if (!solnRoot->fetched()) {
+    // Add a fetch stage so we have the full object when we hit the sort stage, unless the index
+    // keys hold everything the sort needs. In that case the sort buffers index keys, and the fetch
+    // added above it later on only reads the documents that survive the sort's limit.
+    const bool fetchAfterSort = (params.options & QueryPlannerParams::FETCH_AFTER_SORT) &&
+        !solnRoot->fetched() && sortCoveredByIndexKeys(query, sortObj, solnRoot);
+    if (!solnRoot->fetched() && !fetchAfterSort) {
         FetchNode* fetch = new FetchNode();
         fetch->children.push_back(solnRoot);
         solnRoot = fetch;
@@ -598,6 +644,15 @@ QuerySolutionNode* QueryPlannerAnalysis::analyzeSort(const CanonicalQuery& query
         sort->limit = 0;
     }
 
+    // A text stage right below a limited sort on text score only needs to produce the best scoring
+    // documents.
+    const bool limitIsTrue = qr.getLimit() || (qr.getNToReturn() && !qr.wantMore());
+    if (limitIsTrue && sort->limit && sortObj.nFields() == 1 &&
+        QueryRequest::isTextScoreMeta(sortObj.firstElement()) &&
+        STAGE_TEXT == keyGenNode->children[0]->getType()) {
+        static_cast<TextNode*>(keyGenNode->children[0])->topK = sort->limit;
+    }
+
     *blockingSortOut = true;
 
     return solnRoot;
@@ -829,6 +884,16 @@ QuerySolution* QueryPlannerAnalysis::analyzeDataAccess(
     // Otherwise, we need to limit the results in the case of a hard limit
     // (ie. limit in raw query is negative)
     if (!hasSortStage) {
+        // A $near search returns its results in order, so it only needs to produce as many as the
+        // skip and limit let through.
+        boost::optional<long long> hardLimit = qr.getLimit();
+        if (!hardLimit && qr.getNToReturn() && !qr.wantMore()) {
+            hardLimit = qr.getNToReturn();
+        }
+        if (hardLimit) {
+            setGeoNearLimit(solnRoot.get(), *hardLimit + qr.getSkip().value_or(0));
+        }
+
         // We don't have a sort stage. This means that, if there is a limit, we will have
         // to enforce it ourselves since it's not handled inside SORT.
         if (qr.getLimit()) {
@@ -175,13 +175,22 @@ void QueryPlannerIXSelect::getFields(const MatchExpression* node,
 // static
 void QueryPlannerIXSelect::findRelevantIndices(const unordered_set<string>& fields,
                                                const vector<IndexEntry>& allIndices,
+                                               bool allowSkipScan,
                                                vector<IndexEntry>* out) {
     for (size_t i = 0; i < allIndices.size(); ++i) {
-        BSONObjIterator it(allIndices[i].keyPattern);
+        const IndexEntry& index = allIndices[i];
+        const bool canSkipScan = allowSkipScan && INDEX_BTREE == index.type && !index.multikey;
+
+        BSONObjIterator it(index.keyPattern);
         verify(it.more());
         BSONElement elt = it.next();
-        if (fields.end() != fields.find(elt.fieldName())) {
-            out->push_back(allIndices[i]);
+        bool relevant = fields.end() != fields.find(elt.fieldName());
+        while (!relevant && canSkipScan && it.more()) {
+            relevant = fields.end() != fields.find(it.next().fieldName());
+        }
+
+        if (relevant) {
+            out->push_back(index);
         }
     }
 }
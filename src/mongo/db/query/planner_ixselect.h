@@ -55,10 +55,12 @@ public:
 
     /**
      * Find all indices prefixed by fields we have predicates over.  Only these indices are
-     * useful in answering the query.
+     * useful in answering the query. If 'allowSkipScan' is true, non-multikey btree indices with
+     * a predicate over any of their fields are relevant too, as they can be skip scanned.
      */
     static void findRelevantIndices(const unordered_set<std::string>& fields,
                                     const std::vector<IndexEntry>& indices,
+                                    bool allowSkipScan,
                                     std::vector<IndexEntry>* out);
 
     /**
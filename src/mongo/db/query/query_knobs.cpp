@@ -38,12 +38,22 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationCollFraction, double, 0
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationMaxResults, int, 101);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerMaxCostToSkipMultiPlanning, int, 10);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerCostRatioToSkipCandidate, double, 0.0);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheSize, int, 5000);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheMaxTotalSizeBytes, long long, 512 * 1024 * 1024);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheParameterizeInLists, bool, false);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheFeedbacksStored, int, 20);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheEvictionRatio, double, 10.0);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheBackgroundReplanning, bool, false);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerMaxIndexedSolutions, int, 64);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryEnumerationMaxOrSolutions, int, 10);
@@ -62,10 +72,26 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryMaxScansToExplode, int, 200);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxBlockingSortBytes, int, 32 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecFetchPrefetchBatchSize, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecAllowDiskUseForBlockingSort, bool, false);
+
 // Yield every 128 cycles or 10ms.
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldIterations, int, 128);
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldPeriodMS, int, 10);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCollectionScanMaxBatchSize, int, 64);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCollectionScanReadAheadMinRecords, int, 10000);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecBatchSize, int, 1);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecCompileFilters, bool, true);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecUpdateBatchSize, int, 16);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryGeoNearBestFirstMaxResults, int, 1000);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryFacetBufferSizeBytes, int, 100 * 1024 * 1024);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalInsertMaxBatchSize,
@@ -74,11 +100,35 @@ MONGO_EXPORT_SERVER_PARAMETER(internalInsertMaxBatchSize,
 
 MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceCursorBatchSizeBytes, int, 4 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceCursorLazyDocuments, bool, false);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupCacheSizeBytes, int, 100 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupHashJoinMaxMemoryBytes,
+                              int,
+                              100 * 1024 * 1024);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupBatchSize, int, 100);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceChangeStreamSharedOplogBytes, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupChangePostImageCacheMillis, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupChangePostImageCacheBytes,
+                              int,
+                              16 * 1024 * 1024);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupChangePostImageBatchSize, int, 1);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerGenerateCoveredWholeIndexScans, bool, false);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerEnableSkipScan, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerEnableLateFetchForSort, bool, false);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryIgnoreUnknownJSONSchemaKeywords, bool, false);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryProhibitBlockingMergeOnMongoS, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryMatcherFieldIndexMinFields, int, 128);
 }  // namespace mongo
@@ -57,6 +57,15 @@ extern AtomicBool internalQueryPlannerEnableIndexIntersection;
 // Do we use hash-based intersection for rooted $and queries?
 extern AtomicBool internalQueryPlannerEnableHashIntersection;
 
+// A candidate plan certain to need at most this many works runs without racing the others. Zero
+// disables the shortcut.
+extern AtomicInt32 internalQueryPlannerMaxCostToSkipMultiPlanning;
+
+// If positive, candidate plans whose estimated cost exceeds that of the cheapest candidate by more
+// than this factor are left out of the race. The estimates are not based on statistics about the
+// data, so this is off by default.
+extern AtomicDouble internalQueryPlannerCostRatioToSkipCandidate;
+
 //
 // plan cache
 //
@@ -64,6 +73,14 @@ extern AtomicBool internalQueryPlannerEnableHashIntersection;
 // How many entries in the cache?
 extern AtomicInt32 internalQueryCacheSize;
 
+// How many bytes may the plan caches of all collections use together? Once exceeded, a cache adding
+// an entry evicts its least recently used entries to make room.
+extern AtomicInt64 internalQueryCacheMaxTotalSizeBytes;
+
+// Should equalities and $in predicates share plan cache entries? If so, $in lists of every length
+// map to one cached plan, whose index bounds are rebuilt from each query's own values.
+extern AtomicBool internalQueryCacheParameterizeInLists;
+
 // How many feedback entries do we collect before possibly evicting from the cache based on bad
 // performance?
 extern AtomicInt32 internalQueryCacheFeedbacksStored;
@@ -72,6 +89,10 @@ extern AtomicInt32 internalQueryCacheFeedbacksStored;
 // and replanning?
 extern AtomicDouble internalQueryCacheEvictionRatio;
 
+// Should a cached plan that exceeds the eviction ratio keep running while its query shape is
+// replanned in the background? If not, the query is replanned inline before it continues.
+extern AtomicBool internalQueryCacheBackgroundReplanning;
+
 //
 // Planning and enumeration.
 //
@@ -95,6 +116,14 @@ extern AtomicInt32 internalQueryMaxScansToExplode;
 // Allow the planner to generate covered whole index scans, rather than falling back to a COLLSCAN.
 extern AtomicBool internalQueryPlannerGenerateCoveredWholeIndexScans;
 
+// Allow the planner to skip scan a compound index whose leading fields have no predicates,
+// seeking past each distinct leading value. Such plans compete with a COLLSCAN.
+extern AtomicBool internalQueryPlannerEnableSkipScan;
+
+// Allow the planner to sort index keys and fetch only the documents that survive the sort and its
+// limit, when the index keys cover the sort pattern.
+extern AtomicBool internalQueryPlannerEnableLateFetchForSort;
+
 // Ignore unknown JSON Schema keywords.
 extern AtomicBool internalQueryIgnoreUnknownJSONSchemaKeywords;
 
@@ -104,12 +133,47 @@ extern AtomicBool internalQueryIgnoreUnknownJSONSchemaKeywords;
 
 extern AtomicInt32 internalQueryExecMaxBlockingSortBytes;
 
+// How many results does a FETCH stage read from its child before asking the storage engine to
+// prefetch their records? Zero disables prefetching.
+extern AtomicInt32 internalQueryExecFetchPrefetchBatchSize;
+
+// Whether blocking sorts may spill to disk once they exceed internalQueryExecMaxBlockingSortBytes,
+// even if the query did not ask for it.
+extern AtomicBool internalQueryExecAllowDiskUseForBlockingSort;
+
 // Yield after this many "should yield?" checks.
 extern AtomicInt32 internalQueryExecYieldIterations;
 
 // Yield if it's been at least this many milliseconds since we last yielded.
 extern AtomicInt32 internalQueryExecYieldPeriodMS;
 
+// The most records a collection scan reads from its cursor at once. Values of 1 or less make it
+// read one record per call to work().
+extern AtomicInt32 internalQueryCollectionScanMaxBatchSize;
+
+// Full collection scans of collections with at least this many records ask the storage engine to
+// read ahead of them. 0 disables read-ahead.
+extern AtomicInt32 internalQueryCollectionScanReadAheadMinRecords;
+
+// The most units of work a PlanExecutor asks of its plan at once through PlanStage::workBatch().
+// Values of 1 or less make it call work() once per result. Only used with storage engines that
+// support document-level locking. Plan stages that process whole batches count one work per
+// result they return in their explain stats.
+extern AtomicInt32 internalQueryExecBatchSize;
+
+// Whether collection scans and fetches evaluate filters made only of equality, comparison, $in
+// and $exists leaves with a CompiledMatchExpression rather than walking the MatchExpression tree.
+extern AtomicBool internalQueryExecCompileFilters;
+
+// How many documents a multi-update groups into each WriteUnitOfWork. Values of 1 or less update
+// each document in its own. Only used with storage engines that support document-level locking.
+extern AtomicInt32 internalQueryExecUpdateBatchSize;
+
+// $near queries on a 2dsphere index whose result count is limited to at most this many documents
+// search the index best-first, nearest cell or document first, instead of over growing annuli.
+// 0 disables the best-first search.
+extern AtomicInt32 internalQueryGeoNearBestFirstMaxResults;
+
 // Limit the size that we write without yielding to 16MB / 64 (max expected number of indexes)
 const int64_t insertVectorMaxBytes = 256 * 1024;
 
@@ -120,7 +184,39 @@ extern AtomicInt32 internalInsertMaxBatchSize;
 
 extern AtomicInt32 internalDocumentSourceCursorBatchSizeBytes;
 
+// Whether $cursor hands whole documents to the pipeline lazily, converting their fields from BSON
+// only when a later stage reads or modifies them.
+extern AtomicBool internalDocumentSourceCursorLazyDocuments;
+
 extern AtomicInt32 internalDocumentSourceLookupCacheSizeBytes;
 
+// The largest foreign collection, in bytes, that $lookup with localField/foreignField will load
+// into an in-memory hash table instead of querying it once per input document. Zero disables the
+// hash join.
+extern AtomicInt32 internalDocumentSourceLookupHashJoinMaxMemoryBytes;
+
+// The number of input documents for which $lookup with localField/foreignField issues a single
+// $in query against the foreign collection. One or less queries for each document separately.
+extern AtomicInt32 internalDocumentSourceLookupBatchSize;
+
+// The number of bytes of recent oplog entries that $changeStream cursors on a mongod share, so that
+// the oplog is read once for all of them rather than once per cursor. Zero disables the sharing.
+extern AtomicInt32 internalDocumentSourceChangeStreamSharedOplogBytes;
+
+// How long, in milliseconds, the post-images looked up for 'updateLookup' change streams are kept
+// for other streams reporting the same change. Zero disables the cache.
+extern AtomicInt32 internalDocumentSourceLookupChangePostImageCacheMillis;
+
+// The most bytes of post-images the cache above holds.
+extern AtomicInt32 internalDocumentSourceLookupChangePostImageCacheBytes;
+
+// The number of update events for which an 'updateLookup' change stream looks up post-images with a
+// single query, when the events are already available. One or less looks up each separately.
+extern AtomicInt32 internalDocumentSourceLookupChangePostImageBatchSize;
+
 extern AtomicBool internalQueryProhibitBlockingMergeOnMongoS;
+
+// The number of top-level fields from which a document matched against more than one path gets a
+// hash from field name to element instead of being scanned for each path. Zero or less disables.
+extern AtomicInt32 internalQueryMatcherFieldIndexMinFields;
 }  // namespace mongo
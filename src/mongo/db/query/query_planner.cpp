@@ -32,6 +32,7 @@
 
 #include "mongo/db/query/query_planner.h"
 
+#include <algorithm>
 #include <boost/optional.hpp>
 #include <vector>
 
@@ -45,6 +46,7 @@
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/collation/collation_index_key.h"
 #include "mongo/db/query/collation/collator_interface.h"
+#include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_enumerator.h"
 #include "mongo/db/query/planner_access.h"
@@ -135,6 +137,13 @@ string optionString(size_t options) {
                 break;
             case QueryPlannerParams::TRACK_LATEST_OPLOG_TS:
                 ss << "TRACK_LATEST_OPLOG_TS ";
+                break;
+            case QueryPlannerParams::SKIP_SCAN:
+                ss << "SKIP_SCAN ";
+                break;
+            case QueryPlannerParams::FETCH_AFTER_SORT:
+                ss << "FETCH_AFTER_SORT ";
+                break;
             case QueryPlannerParams::DEFAULT:
                 MONGO_UNREACHABLE;
                 break;
@@ -268,6 +277,38 @@ static BSONObj finishMaxObj(const IndexEntry& indexEntry,
     }
 }
 
+static bool isAllValuesInterval(const OrderedIntervalList& oil) {
+    if (oil.intervals.size() != 1) {
+        return false;
+    }
+    // The interval is reversed if the field is descending in the key pattern.
+    Interval allValues = IndexBoundsBuilder::allValues();
+    if (oil.intervals[0].equals(allValues)) {
+        return true;
+    }
+    allValues.reverse();
+    return oil.intervals[0].equals(allValues);
+}
+
+/**
+ * Returns true if the solution tree rooted at 'node' contains a skip scan: an index scan with
+ * all-values bounds on its leading field and tighter bounds on some later field.
+ */
+static bool hasSkipScan(const QuerySolutionNode* node) {
+    if (STAGE_IXSCAN == node->getType()) {
+        const IndexBounds& bounds = static_cast<const IndexScanNode*>(node)->bounds;
+        if (bounds.isSimpleRange || bounds.fields.empty() ||
+            !isAllValuesInterval(bounds.fields[0])) {
+            return false;
+        }
+        return !std::all_of(bounds.fields.begin() + 1, bounds.fields.end(), isAllValuesInterval);
+    }
+
+    return std::any_of(node->children.begin(),
+                       node->children.end(),
+                       [](const QuerySolutionNode* child) { return hasSkipScan(child); });
+}
+
 QuerySolution* buildCollscanSoln(const CanonicalQuery& query,
                                  bool tailable,
                                  const QueryPlannerParams& params) {
@@ -641,7 +682,9 @@ Status QueryPlanner::plan(const CanonicalQuery& query,
     boost::optional<size_t> hintIndexNumber;
 
     if (hintIndex.isEmpty()) {
-        QueryPlannerIXSelect::findRelevantIndices(fields, params.indices, &relevantIndices);
+        const bool allowSkipScan = params.options & QueryPlannerParams::SKIP_SCAN;
+        QueryPlannerIXSelect::findRelevantIndices(
+            fields, params.indices, allowSkipScan, &relevantIndices);
     } else {
         // Sigh.  If the hint is specified it might be using the index name.
         BSONElement firstHintElt = hintIndex.firstElement();
@@ -859,6 +902,7 @@ Status QueryPlanner::plan(const CanonicalQuery& query,
         // The enumerator spits out trees tagged with IndexTag(s).
         PlanEnumeratorParams enumParams;
         enumParams.intersect = params.options & QueryPlannerParams::INDEX_INTERSECTION;
+        enumParams.skipScan = params.options & QueryPlannerParams::SKIP_SCAN;
         enumParams.root = query.root();
         enumParams.indices = &relevantIndices;
 
@@ -1079,7 +1123,14 @@ Status QueryPlanner::plan(const CanonicalQuery& query,
     // No indexed plans?  We must provide a collscan if possible or else we can't run the query.
     bool collscanNeeded = (0 == out->size() && canTableScan);
 
-    if (possibleToCollscan && (collscanRequested || collscanNeeded)) {
+    // A skip scan only beats a collscan when the leading index fields have few distinct values.
+    // We keep no statistics to tell, so the collscan competes with it in the multi-plan trial.
+    bool collscanForSkipScan = canTableScan &&
+        std::any_of(out->begin(), out->end(), [](const QuerySolution* soln) {
+            return soln->root && hasSkipScan(soln->root.get());
+        });
+
+    if (possibleToCollscan && (collscanRequested || collscanNeeded || collscanForSkipScan)) {
         QuerySolution* collscan = buildCollscanSoln(query, isTailable, params);
         if (NULL != collscan) {
             SolutionCacheData* scd = new SolutionCacheData();
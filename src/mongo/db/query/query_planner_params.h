@@ -101,6 +101,14 @@ struct QueryPlannerParams {
 
         // Set this to track the most recent timestamp seen by this cursor while scanning the oplog.
         TRACK_LATEST_OPLOG_TS = 1 << 12,
+
+        // Set this to consider skip scans: index scans of a compound index that has predicates
+        // only on its later fields, which seek past each distinct value of the leading fields.
+        SKIP_SCAN = 1 << 13,
+
+        // Set this to let a blocking sort buffer index keys, rather than fetched documents, when
+        // the keys hold the sort pattern. The documents are then fetched above the sort.
+        FETCH_AFTER_SORT = 1 << 14,
     };
 
     // See Options enum above.
@@ -5445,4 +5445,128 @@ TEST_F(QueryPlannerTest, EmptyQueryWithProjectionUsesCollscanIfIndexCollationDif
         "{proj: {spec: {_id: 0, a: 1}, node: "
         "{cscan: {dir: 1}}}}");
 }
+
+//
+// Skip scans.
+//
+
+TEST_F(QueryPlannerTest, SkipScanNotConsideredByDefault) {
+    params.options = 0;
+    addIndex(BSON("a" << 1 << "b" << 1));
+    runQuery(fromjson("{b: 5}"));
+
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {dir: 1, filter: {b: 5}}}");
+}
+
+TEST_F(QueryPlannerTest, SkipScanOnNonLeadingFieldCompetesWithCollscan) {
+    params.options = QueryPlannerParams::SKIP_SCAN;
+    addIndex(BSON("a" << 1 << "b" << 1));
+    runQuery(fromjson("{b: {$gte: 5, $lt: 10}}"));
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{fetch: {filter: null, node: {ixscan: {pattern: {a: 1, b: 1}, bounds: "
+        "{a: [['MinKey','MaxKey',true,true]], b: [[5,10,true,false]]}}}}}");
+    assertSolutionExists("{cscan: {dir: 1, filter: {b: {$gte: 5, $lt: 10}}}}");
+}
+
+TEST_F(QueryPlannerTest, SkipScanCompoundsAllNonLeadingPredicates) {
+    params.options = QueryPlannerParams::SKIP_SCAN;
+    addIndex(BSON("a" << 1 << "b" << -1 << "c" << 1));
+    runQuery(fromjson("{b: 5, c: {$gt: 1}}"));
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{fetch: {filter: null, node: {ixscan: {pattern: {a: 1, b: -1, c: 1}, bounds: "
+        "{a: [['MinKey','MaxKey',true,true]], b: [[5,5,true,true]], "
+        "c: [[1,Infinity,false,true]]}}}}}");
+    assertSolutionExists("{cscan: {dir: 1}}");
+}
+
+TEST_F(QueryPlannerTest, SkipScanNotUsedWhenLeadingFieldHasPredicate) {
+    params.options = QueryPlannerParams::SKIP_SCAN;
+    addIndex(BSON("a" << 1 << "b" << 1));
+    runQuery(fromjson("{a: 1, b: 5}"));
+
+    assertNumSolutions(1U);
+    assertSolutionExists(
+        "{fetch: {filter: null, node: {ixscan: {pattern: {a: 1, b: 1}, bounds: "
+        "{a: [[1,1,true,true]], b: [[5,5,true,true]]}}}}}");
+}
+
+TEST_F(QueryPlannerTest, SkipScanNotUsedForMultikeyIndex) {
+    params.options = QueryPlannerParams::SKIP_SCAN;
+    addIndex(BSON("a" << 1 << "b" << 1), true);
+    runQuery(fromjson("{b: 5}"));
+
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {dir: 1, filter: {b: 5}}}");
+}
+
+TEST_F(QueryPlannerTest, SkipScanAlongsideLeadingFieldScanOfAnotherIndex) {
+    params.options = QueryPlannerParams::SKIP_SCAN;
+    addIndex(BSON("a" << 1 << "b" << 1));
+    addIndex(BSON("c" << 1));
+    runQuery(fromjson("{b: 5, c: 6}"));
+
+    assertNumSolutions(3U);
+    assertSolutionExists(
+        "{fetch: {filter: {c: 6}, node: {ixscan: {pattern: {a: 1, b: 1}, bounds: "
+        "{a: [['MinKey','MaxKey',true,true]], b: [[5,5,true,true]]}}}}}");
+    assertSolutionExists(
+        "{fetch: {filter: {b: 5}, node: {ixscan: {pattern: {c: 1}, bounds: "
+        "{c: [[6,6,true,true]]}}}}}");
+    assertSolutionExists("{cscan: {dir: 1}}");
+}
+//
+// Fetching after a blocking sort.
+//
+
+TEST_F(QueryPlannerTest, FetchAfterSortWhenIndexKeysHoldSortPattern) {
+    params.options = QueryPlannerParams::INCLUDE_COLLSCAN | QueryPlannerParams::FETCH_AFTER_SORT;
+    addIndex(BSON("a" << 1 << "b" << 1));
+    runQuerySortProjSkipNToReturn(fromjson("{a: {$gt: 1}}"), fromjson("{b: 1}"), BSONObj(), 0, -3);
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{fetch: {filter: null, node: {sort: {pattern: {b: 1}, limit: 3, node: {sortKeyGen: "
+        "{node: {ixscan: {filter: null, pattern: {a: 1, b: 1}}}}}}}}}");
+    assertSolutionExists(
+        "{sort: {pattern: {b: 1}, limit: 3, node: {sortKeyGen: "
+        "{node: {cscan: {dir: 1, filter: {a: {$gt: 1}}}}}}}}");
+}
+
+TEST_F(QueryPlannerTest, FetchAfterSortNotUsedByDefault) {
+    addIndex(BSON("a" << 1 << "b" << 1));
+    runQuerySortProjSkipNToReturn(fromjson("{a: {$gt: 1}}"), fromjson("{b: 1}"), BSONObj(), 0, -3);
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{sort: {pattern: {b: 1}, limit: 3, node: {sortKeyGen: {node: {fetch: {filter: null, "
+        "node: {ixscan: {filter: null, pattern: {a: 1, b: 1}}}}}}}}}");
+}
+
+TEST_F(QueryPlannerTest, FetchAfterSortNotUsedWhenSortFieldNotInIndex) {
+    params.options = QueryPlannerParams::INCLUDE_COLLSCAN | QueryPlannerParams::FETCH_AFTER_SORT;
+    addIndex(BSON("a" << 1));
+    runQuerySortProjSkipNToReturn(fromjson("{a: {$gt: 1}}"), fromjson("{b: 1}"), BSONObj(), 0, -3);
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{sort: {pattern: {b: 1}, limit: 3, node: {sortKeyGen: {node: {fetch: {filter: null, "
+        "node: {ixscan: {filter: null, pattern: {a: 1}}}}}}}}}");
+}
+
+TEST_F(QueryPlannerTest, FetchAfterSortNotNeededForCoveredProjection) {
+    params.options = QueryPlannerParams::INCLUDE_COLLSCAN | QueryPlannerParams::FETCH_AFTER_SORT;
+    addIndex(BSON("a" << 1 << "b" << 1));
+    runQuerySortProj(
+        fromjson("{a: {$gt: 1}}"), fromjson("{b: 1}"), fromjson("{_id: 0, a: 1, b: 1}"));
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{proj: {spec: {_id: 0, a: 1, b: 1}, node: {sort: {pattern: {b: 1}, limit: 0, node: "
+        "{sortKeyGen: {node: {ixscan: {filter: null, pattern: {a: 1, b: 1}}}}}}}}}");
+}
 }  // namespace
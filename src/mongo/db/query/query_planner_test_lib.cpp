@@ -402,6 +402,13 @@ bool QueryPlannerTestLib::solutionMatches(const BSONObj& testSoln,
             }
         }
 
+        BSONElement topK = textObj["topK"];
+        if (!topK.eoo()) {
+            if (!topK.isNumber() || static_cast<size_t>(topK.numberLong()) != node->topK) {
+                return false;
+            }
+        }
+
         BSONElement indexPrefix = textObj["prefix"];
         if (!indexPrefix.eoo()) {
             if (!indexPrefix.isABSONObj()) {
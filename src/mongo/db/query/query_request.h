@@ -389,6 +389,14 @@ public:
         _allowPartialResults = allowPartialResults;
     }
 
+    bool allowDiskUse() const {
+        return _allowDiskUse;
+    }
+
+    void setAllowDiskUse(bool allowDiskUse) {
+        _allowDiskUse = allowDiskUse;
+    }
+
     boost::optional<long long> getReplicationTerm() const {
         return _replicationTerm;
     }
@@ -512,6 +520,9 @@ private:
     bool _snapshot = false;
     bool _hasReadPref = false;
 
+    // Whether a blocking sort may spill to disk.
+    bool _allowDiskUse = false;
+
     // Options that can be specified in the OP_QUERY 'flags' header.
     TailableMode _tailableMode = TailableMode::kNormal;
     bool _slaveOk = false;
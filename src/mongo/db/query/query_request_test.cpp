@@ -734,6 +734,29 @@ TEST(QueryRequestTest, ParseFromCommandTailableWrongType) {
     ASSERT_NOT_OK(result.getStatus());
 }
 
+TEST(QueryRequestTest, ParseFromCommandAllowDiskUse) {
+    BSONObj cmdObj = fromjson(
+        "{find: 'testns',"
+        "sort: {a: 1},"
+        "allowDiskUse: true}");
+    const NamespaceString nss("test.testns");
+    bool isExplain = false;
+    unique_ptr<QueryRequest> qr(
+        assertGet(QueryRequest::makeFromFindCommand(nss, cmdObj, isExplain)));
+    ASSERT(qr->allowDiskUse());
+}
+
+TEST(QueryRequestTest, ParseFromCommandAllowDiskUseWrongType) {
+    BSONObj cmdObj = fromjson(
+        "{find: 'testns',"
+        "sort: {a: 1},"
+        "allowDiskUse: 1}");
+    const NamespaceString nss("test.testns");
+    bool isExplain = false;
+    auto result = QueryRequest::makeFromFindCommand(nss, cmdObj, isExplain);
+    ASSERT_NOT_OK(result.getStatus());
+}
+
 TEST(QueryRequestTest, ParseFromCommandSlaveOkWrongType) {
     BSONObj cmdObj = fromjson(
         "{find: 'testns',"
@@ -1053,6 +1076,7 @@ TEST(QueryRequestTest, DefaultQueryParametersCorrect) {
     ASSERT_EQUALS(false, qr->isTailableAndAwaitData());
     ASSERT_EQUALS(false, qr->isExhaust());
     ASSERT_EQUALS(false, qr->isAllowPartialResults());
+    ASSERT_EQUALS(false, qr->allowDiskUse());
 }
 
 //
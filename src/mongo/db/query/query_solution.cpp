@@ -151,6 +151,17 @@ void addEqualityFieldSorts(const BSONObj& sortPattern,
 }
 }
 
+BSONObj PlanCostEstimate::toBSON() const {
+    BSONObjBuilder bob;
+    bob.append("cost", cost());
+    bob.append("keysExamined", keysExamined);
+    bob.append("docsExamined", docsExamined);
+    bob.append("docsSorted", docsSorted);
+    bob.append("nReturned", nReturned);
+    bob.append("isUpperBound", isUpperBound);
+    return bob.obj();
+}
+
 string QuerySolutionNode::toString() const {
     mongoutils::str::stream ss;
     appendToString(&ss, 0);
@@ -198,6 +209,10 @@ void TextNode::appendToString(mongoutils::str::stream* ss, int indent) const {
     *ss << "diacriticSensitive= " << ftsQuery->getDiacriticSensitive() << '\n';
     addIndent(ss, indent + 1);
     *ss << "indexPrefix = " << indexPrefix.toString() << '\n';
+    if (topK) {
+        addIndent(ss, indent + 1);
+        *ss << "topK = " << topK << '\n';
+    }
     if (NULL != filter) {
         addIndent(ss, indent + 1);
         *ss << " filter = " << filter->toString();
@@ -212,6 +227,7 @@ QuerySolutionNode* TextNode::clone() const {
     copy->_sort = this->_sort;
     copy->ftsQuery = this->ftsQuery->clone();
     copy->indexPrefix = this->indexPrefix;
+    copy->topK = this->topK;
 
     return copy;
 }
@@ -1021,6 +1037,10 @@ void GeoNear2DSphereNode::appendToString(mongoutils::str::stream* ss, int indent
     *ss << "baseBounds = " << baseBounds.toString() << '\n';
     addIndent(ss, indent + 1);
     *ss << "nearQuery = " << nq->toString() << '\n';
+    if (limit) {
+        addIndent(ss, indent + 1);
+        *ss << "limit = " << limit << '\n';
+    }
     if (NULL != filter) {
         addIndent(ss, indent + 1);
         *ss << " filter = " << filter->toString();
@@ -1036,6 +1056,7 @@ QuerySolutionNode* GeoNear2DSphereNode::clone() const {
     copy->baseBounds = this->baseBounds;
     copy->addPointMeta = this->addPointMeta;
     copy->addDistMeta = this->addDistMeta;
+    copy->limit = this->limit;
 
     return copy;
 }
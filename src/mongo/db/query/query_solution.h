@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <memory>
 
 #include "mongo/bson/bsonobj_comparator_interface.h"
@@ -167,6 +168,28 @@ private:
     MONGO_DISALLOW_COPYING(QuerySolutionNode);
 };
 
+/**
+ * An estimate, made before a plan runs, of how much work it does. See PlanRanker::estimateCost().
+ */
+struct PlanCostEstimate {
+    /**
+     * The number of works the plan is expected to need.
+     */
+    double cost() const {
+        return keysExamined + docsExamined + docsSorted;
+    }
+
+    BSONObj toBSON() const;
+
+    double keysExamined = 0;
+    double docsExamined = 0;
+    double docsSorted = 0;
+    double nReturned = 0;
+
+    // Whether the counts above are certain not to be exceeded, rather than guessed.
+    bool isUpperBound = true;
+};
+
 /**
  * A QuerySolution must be entirely self-contained and own everything inside of it.
  *
@@ -200,6 +223,10 @@ struct QuerySolution {
     // Owned here. Used by the plan cache.
     std::unique_ptr<SolutionCacheData> cacheData;
 
+    // Set by the planning process when the cost of this solution could be estimated. Reported by
+    // explain.
+    boost::optional<PlanCostEstimate> costEstimate;
+
     /**
      * Output a human-readable std::string representing the plan.
      */
@@ -254,6 +281,10 @@ struct TextNode : public QuerySolutionNode {
     // text node while creating the text leaf node and convert them into a BSONObj index prefix
     // when we finish the text leaf node.
     BSONObj indexPrefix;
+
+    // If non-zero, the results are only sorted by text score and limited to this many, so the text
+    // stage may stop reading the index once it has found the best scoring documents.
+    size_t topK = 0;
 };
 
 struct CollectionScanNode : public QuerySolutionNode {
@@ -784,6 +815,9 @@ struct GeoNear2DSphereNode : public QuerySolutionNode {
     IndexEntry index;
     bool addPointMeta;
     bool addDistMeta;
+
+    // If non-zero, the query needs at most this many results from the stage.
+    size_t limit = 0;
 };
 
 //
@@ -0,0 +1,196 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_stats.h"
+
+#include <limits>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/platform/bits.h"
+
+namespace mongo {
+
+// Fraction of queries whose shape statistics are recorded. Zero (or less) disables sampling.
+MONGO_EXPORT_SERVER_PARAMETER(queryStatsSampleRate, double, 0.0);
+
+// Number of distinct query shapes kept; the least recently used shape is dropped beyond this.
+MONGO_EXPORT_SERVER_PARAMETER(queryStatsMaxShapes, int, 1000);
+
+namespace {
+
+const auto getQueryStatsStore = ServiceContext::declareDecoration<QueryStatsStore>();
+
+}  // namespace
+
+// static
+QueryStatsStore& QueryStatsStore::get(ServiceContext* service) {
+    return getQueryStatsStore(service);
+}
+
+QueryStatsStore::QueryStatsStore() : _entries(std::numeric_limits<size_t>::max()) {}
+
+// static
+std::string QueryStatsStore::makeKey(StringData ns, StringData shape) {
+    return ns.toString() + '\0' + shape.toString();
+}
+
+void QueryStatsStore::noteQueryShape(OperationContext* opCtx,
+                                     const Collection* collection,
+                                     const CanonicalQuery& cq) {
+    const double sampleRate = queryStatsSampleRate.load();
+    if (sampleRate <= 0.0 || !collection || !opCtx->getClient()) {
+        return;
+    }
+
+    OpDebug& debug = CurOp::get(opCtx)->debug();
+    if (debug.queryStatsConsidered) {
+        return;
+    }
+    debug.queryStatsConsidered = true;
+
+    if (sampleRate < 1.0 && opCtx->getClient()->getPrng().nextCanonicalDouble() >= sampleRate) {
+        return;
+    }
+
+    debug.queryStatsNs = cq.ns();
+    debug.queryStatsShape = collection->infoCache()->getPlanCache()->computeKey(cq);
+
+    const std::string key = makeKey(debug.queryStatsNs, debug.queryStatsShape);
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    Entry* entry;
+    if (_entries.get(key, &entry).isOK()) {
+        return;
+    }
+
+    entry = new Entry();
+    entry->ns = debug.queryStatsNs;
+    entry->shape = debug.queryStatsShape;
+    entry->query = cq.getQueryRequest().getFilter().getOwned();
+    entry->sort = cq.getQueryRequest().getSort().getOwned();
+    entry->projection = cq.getQueryRequest().getProj().getOwned();
+    entry->firstSeen = Date_t::now();
+    _entries.add(key, entry);
+
+    const size_t maxShapes = std::max(queryStatsMaxShapes.load(), 1);
+    while (_entries.size() > maxShapes) {
+        _entries.removeLeastRecentlyUsed();
+    }
+}
+
+void QueryStatsStore::recordOp(const CurOp& curOp) {
+    const OpDebug& debug = curOp.debug();
+    if (debug.queryStatsShape.empty()) {
+        return;
+    }
+
+    const long long micros = debug.executionTimeMicros;
+    const size_t bucket = micros <= 0
+        ? 0
+        : std::min<size_t>(64 - countLeadingZeros64(micros), kLatencyBuckets - 1);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    Entry* entry;
+    if (!_entries.get(makeKey(debug.queryStatsNs, debug.queryStatsShape), &entry).isOK()) {
+        // Evicted while the operation ran.
+        return;
+    }
+
+    entry->count++;
+    entry->totalMicros += micros;
+    entry->maxMicros = std::max(entry->maxMicros, micros);
+    entry->latencyMicros[bucket]++;
+    entry->docsExamined += std::max(debug.docsExamined, 0LL);
+    entry->keysExamined += std::max(debug.keysExamined, 0LL);
+    entry->nreturned += std::max(debug.nreturned, 0LL);
+    if (!curOp.getPlanSummary().empty()) {
+        entry->lastPlanSummary = curOp.getPlanSummary().toString();
+    }
+    entry->lastSeen = Date_t::now();
+}
+
+std::vector<BSONObj> QueryStatsStore::getStats(StringData ns) const {
+    std::vector<BSONObj> out;
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+        const Entry& entry = *it->second;
+        if (entry.ns != ns) {
+            continue;
+        }
+
+        BSONObjBuilder bob;
+        bob.append("ns", entry.ns);
+        bob.append("queryShape", entry.shape);
+        bob.append("query", entry.query);
+        bob.append("sort", entry.sort);
+        bob.append("projection", entry.projection);
+        bob.appendNumber("count", entry.count);
+        bob.appendNumber("totalMicros", entry.totalMicros);
+        bob.appendNumber("maxMicros", entry.maxMicros);
+        {
+            // Only the buckets that have counts, each labelled with its exclusive upper bound.
+            BSONArrayBuilder histogram(bob.subarrayStart("latencyMicros"));
+            for (size_t i = 0; i < kLatencyBuckets; ++i) {
+                if (!entry.latencyMicros[i]) {
+                    continue;
+                }
+                BSONObjBuilder b(histogram.subobjStart());
+                if (i + 1 < kLatencyBuckets) {
+                    b.appendNumber("lessThan", 1LL << i);
+                }
+                b.appendNumber("count", entry.latencyMicros[i]);
+            }
+        }
+        bob.appendNumber("docsExamined", entry.docsExamined);
+        bob.appendNumber("keysExamined", entry.keysExamined);
+        bob.appendNumber("nreturned", entry.nreturned);
+        bob.append("planSummary", entry.lastPlanSummary);
+        bob.append("firstSeen", entry.firstSeen);
+        if (entry.count) {
+            bob.append("lastSeen", entry.lastSeen);
+        }
+        out.push_back(bob.obj());
+    }
+    return out;
+}
+
+void QueryStatsStore::clear() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _entries.clear();
+}
+
+}  // namespace mongo
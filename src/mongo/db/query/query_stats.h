@@ -0,0 +1,119 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/query/lru_key_value.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class CanonicalQuery;
+class Collection;
+class CurOp;
+class OperationContext;
+class ServiceContext;
+
+/**
+ * An in-memory, sampling alternative to the profiler. A fraction of operations, chosen by the
+ * 'queryStatsSampleRate' server parameter, have their query shape (the plan cache key) noted while
+ * the executor is being built. When the operation completes its latency and work are folded into
+ * the entry for that shape. Entries are kept in an LRU table of at most 'queryStatsMaxShapes'
+ * shapes, and are read through the $queryStats aggregation stage.
+ *
+ * Unsampled operations pay only a random draw, and nothing at all when sampling is disabled.
+ * Work done by getMores is not attributed to the shape of the originating query.
+ */
+class QueryStatsStore {
+    MONGO_DISALLOW_COPYING(QueryStatsStore);
+
+public:
+    static QueryStatsStore& get(ServiceContext* service);
+
+    QueryStatsStore();
+
+    /**
+     * Decides whether the operation running on 'opCtx' is sampled and, if so, remembers the shape
+     * of 'cq' on its CurOp. Only the first query planned by an operation is considered.
+     */
+    void noteQueryShape(OperationContext* opCtx,
+                        const Collection* collection,
+                        const CanonicalQuery& cq);
+
+    /**
+     * Records the completed operation 'curOp' against its query shape, if it was sampled.
+     */
+    void recordOp(const CurOp& curOp);
+
+    /**
+     * Returns one document per query shape on namespace 'ns', most recently used first.
+     */
+    std::vector<BSONObj> getStats(StringData ns) const;
+
+    void clear();
+
+private:
+    // Latencies are bucketed by powers of two microseconds; the last bucket is open-ended.
+    static const size_t kLatencyBuckets = 32;
+
+    struct Entry {
+        std::string ns;
+        std::string shape;
+        BSONObj query;
+        BSONObj sort;
+        BSONObj projection;
+
+        long long count = 0;
+        long long totalMicros = 0;
+        long long maxMicros = 0;
+        long long docsExamined = 0;
+        long long keysExamined = 0;
+        long long nreturned = 0;
+        std::array<long long, kLatencyBuckets> latencyMicros{};
+        std::string lastPlanSummary;
+
+        Date_t firstSeen;
+        Date_t lastSeen;
+    };
+
+    static std::string makeKey(StringData ns, StringData shape);
+
+    mutable stdx::mutex _mutex;
+
+    // Bounded by hand rather than by LRUKeyValue so the limit can change at runtime.
+    LRUKeyValue<std::string, Entry> _entries;
+};
+
+}  // namespace mongo
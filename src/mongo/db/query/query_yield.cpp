@@ -35,6 +35,7 @@
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -62,6 +63,10 @@ void QueryYield::yieldAllLocks(OperationContext* opCtx,
         return;
     }
 
+    // Covers everything from releasing the locks to having them back, including any wait to
+    // reacquire them.
+    Timer yieldTimer;
+
     // Top-level locks are freed, release any potential low-level (storage engine-specific
     // locks). If we are yielding, we are at a safe place to do so.
     opCtx->recoveryUnit()->abandonSnapshot();
@@ -84,6 +89,8 @@ void QueryYield::yieldAllLocks(OperationContext* opCtx,
     }
 
     locker->restoreLockState(snapshot);
+
+    CurOp::get(opCtx)->addYieldTime(Microseconds(yieldTimer.micros()));
 }
 
 }  // namespace mongo
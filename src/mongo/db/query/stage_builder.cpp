@@ -57,6 +57,7 @@
 #include "mongo/db/exec/text.h"
 #include "mongo/db/index/fts_access_method.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
@@ -122,6 +123,7 @@ PlanStage* buildStages(OperationContext* opCtx,
             params.collection = collection;
             params.pattern = sn->pattern;
             params.limit = sn->limit;
+            params.allowDiskUse = cq.getQueryRequest().allowDiskUse();
             return new SortStage(opCtx, params, ws, childStage);
         }
         case STAGE_SORT_KEY_GENERATOR: {
@@ -265,6 +267,12 @@ PlanStage* buildStages(OperationContext* opCtx,
                 collection->getIndexCatalog()->findIndexByName(opCtx, node->index.name);
             invariant(s2Index);
 
+            const size_t maxBestFirstResults =
+                std::max(0, internalQueryGeoNearBestFirstMaxResults.load());
+            if (node->limit > 0 && node->limit <= maxBestFirstResults &&
+                GeoNear2DSphereBestFirstStage::canSearch(params, s2Index)) {
+                return new GeoNear2DSphereBestFirstStage(params, opCtx, ws, collection, s2Index);
+            }
             return new GeoNear2DSphereStage(params, opCtx, ws, collection, s2Index);
         }
         case STAGE_TEXT: {
@@ -285,6 +293,7 @@ PlanStage* buildStages(OperationContext* opCtx,
             // planning a query that contains "no-op" expressions. TODO: make StageBuilder::build()
             // fail in this case (this improvement is being tracked by SERVER-21510).
             params.query = static_cast<FTSQueryImpl&>(*node->ftsQuery);
+            params.topK = node->topK;
             return new TextStage(opCtx, params, ws, node->filter.get());
         }
         case STAGE_SHARDING_FILTER: {
@@ -55,6 +55,7 @@
 #include "mongo/db/repl/storage_interface.h"
 #include "mongo/db/s/shard_identity_rollback_notifier.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/timer_stats.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/rpc/metadata/repl_set_metadata.h"
 #include "mongo/stdx/memory.h"
@@ -162,6 +163,13 @@ static ServerStatusMetricField<Counter64> displayBufferSize("repl.buffer.sizeByt
 static Counter64 bufferMaxSizeGauge;
 static ServerStatusMetricField<Counter64> displayBufferMaxSize("repl.buffer.maxSizeBytes",
                                                                &bufferMaxSizeGauge);
+// Time from a fetched batch entering the buffer until its last op was taken for application
+static TimerHistogram bufferWaitStats;
+static ServerStatusMetricField<TimerHistogram> displayBufferWait("repl.pipeline.bufferWait",
+                                                                 &bufferWaitStats);
+
+// Upper bound on the batches remembered for the bufferWait metric, in case nothing consumes them.
+const size_t kMaxBufferedBatches = 10000;
 
 
 BackgroundSync::BackgroundSync(
@@ -559,6 +567,15 @@ Status BackgroundSync::_enqueueDocuments(Fetcher::Documents::const_iterator begi
         // Buffer docs for later application.
         _oplogBuffer->pushAllNonBlocking(opCtx.get(), begin, end);
 
+        {
+            stdx::lock_guard<stdx::mutex> lk(_bufferedBatchesMutex);
+            if (_bufferedBatches.size() >= kMaxBufferedBatches) {
+                _bufferedBatches.pop_front();
+            }
+            _bufferedBatches.emplace_back(info.lastDocument.opTime.getTimestamp(),
+                                          curTimeMicros64());
+        }
+
         // Update last fetched info.
         _lastFetchedHash = info.lastDocument.value;
         _lastOpTimeFetched = info.lastDocument.opTime;
@@ -586,6 +603,10 @@ bool BackgroundSync::peek(OperationContext* opCtx, BSONObj* op) {
     return _oplogBuffer->peek(opCtx, op);
 }
 
+bool BackgroundSync::peekParsed(OperationContext* opCtx, boost::optional<OplogEntry>* op) {
+    return _oplogBuffer->peekParsed(opCtx, op);
+}
+
 void BackgroundSync::waitForMore() {
     // Block for one second before timing out.
     _oplogBuffer->waitForData(Seconds(1));
@@ -598,6 +619,7 @@ void BackgroundSync::consume(OperationContext* opCtx) {
     if (_oplogBuffer->tryPop(opCtx, &op)) {
         bufferCountGauge.decrement(1);
         bufferSizeGauge.decrement(getSize(op));
+        _recordBufferWait(op);
     } else {
         invariant(inShutdown());
         // This means that shutdown() was called between the consumer's calls to peek() and
@@ -828,8 +850,26 @@ void BackgroundSync::start(OperationContext* opCtx) {
     LOG(1) << "bgsync fetch queue set to: " << _lastOpTimeFetched << " " << _lastFetchedHash;
 }
 
+void BackgroundSync::_recordBufferWait(const BSONObj& op) {
+    stdx::lock_guard<stdx::mutex> lk(_bufferedBatchesMutex);
+    if (_bufferedBatches.empty()) {
+        return;
+    }
+
+    const auto ts = op["ts"].timestamp();
+    const auto now = curTimeMicros64();
+    while (!_bufferedBatches.empty() && _bufferedBatches.front().first <= ts) {
+        bufferWaitStats.recordMicros(now - _bufferedBatches.front().second);
+        _bufferedBatches.pop_front();
+    }
+}
+
 void BackgroundSync::clearBuffer(OperationContext* opCtx) {
     _oplogBuffer->clear(opCtx);
+    {
+        stdx::lock_guard<stdx::mutex> lk(_bufferedBatchesMutex);
+        _bufferedBatches.clear();
+    }
     const auto count = bufferCountGauge.get();
     bufferCountGauge.decrement(count);
     const auto size = bufferSizeGauge.get();
@@ -28,7 +28,9 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <utility>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
@@ -116,6 +118,7 @@ public:
     // Interface implementation
 
     bool peek(OperationContext* opCtx, BSONObj* op);
+    bool peekParsed(OperationContext* opCtx, boost::optional<OplogEntry>* op);
     void consume(OperationContext* opCtx);
     void clearSyncTarget();
     void waitForMore();
@@ -208,6 +211,9 @@ private:
 
     OpTimeWithHash _readLastAppliedOpTimeWithHash(OperationContext* opCtx);
 
+    // Records how long the batches which 'op' completes waited in the buffer.
+    void _recordBufferWait(const BSONObj& op);
+
     // Production thread
     std::unique_ptr<OplogBuffer> _oplogBuffer;
 
@@ -265,6 +271,12 @@ private:
     // Current oplog fetcher tailing the oplog on the sync source.
     std::unique_ptr<OplogFetcher> _oplogFetcher;
 
+    // Protects _bufferedBatches. Kept separate from _mutex since it is taken for every op applied.
+    stdx::mutex _bufferedBatchesMutex;
+
+    // The timestamp of the last op of each batch in the buffer, and when the batch was buffered.
+    std::deque<std::pair<Timestamp, unsigned long long>> _bufferedBatches;  // (S)
+
     // Current rollback process. If this component is active, we are currently reverting local
     // operations in the local oplog in order to bring this server to a consistent state relative
     // to the sync source.
@@ -43,6 +43,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/collection_bulk_loader_impl.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/destructor_guard.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -53,6 +54,11 @@ namespace repl {
 
 namespace {
 
+// When true, secondary indexes are not maintained while documents are inserted. They are built
+// at commit time by a single scan over the loaded collection, which keeps the index sorters out
+// of memory while the collection is being copied.
+MONGO_EXPORT_SERVER_PARAMETER(initialSyncDeferSecondaryIndexBuilds, bool, false);
+
 /**
  * Utility class to temporarily swap which client is bound to the running thread.
  *
@@ -117,6 +123,7 @@ Status CollectionBulkLoaderImpl::init(const std::vector<BSONObj>& secondaryIndex
             // This enforces the buildIndexes setting in the replica set configuration.
             _secondaryIndexesBlock->removeExistingIndexes(&specs);
             if (specs.size()) {
+                _deferSecondaryIndexBuilds = initialSyncDeferSecondaryIndexBuilds.load();
                 _secondaryIndexesBlock->ignoreUniqueConstraint();
                 auto status = _secondaryIndexesBlock->init(specs).getStatus();
                 if (!status.isOK()) {
@@ -149,14 +156,14 @@ Status CollectionBulkLoaderImpl::insertDocuments(const std::vector<BSONObj>::con
             if (_idIndexBlock) {
                 indexers.push_back(_idIndexBlock.get());
             }
-            if (_secondaryIndexesBlock) {
+            if (_secondaryIndexesBlock && !_deferSecondaryIndexBuilds) {
                 indexers.push_back(_secondaryIndexesBlock.get());
             }
 
             Status status = writeConflictRetry(
                 _opCtx.get(), "CollectionBulkLoaderImpl::insertDocuments", _nss.ns(), [&] {
                     WriteUnitOfWork wunit(_opCtx.get());
-                    if (!indexers.empty()) {
+                    if (_idIndexBlock || _secondaryIndexesBlock) {
                         // This flavor of insertDocument will not update any pre-existing indexes,
                         // only the indexers passed in.
                         const auto status = _autoColl->getCollection()->insertDocument(
@@ -199,7 +206,10 @@ Status CollectionBulkLoaderImpl::commit() {
         // deleted.
         if (_secondaryIndexesBlock) {
             std::set<RecordId> secDups;
-            auto status = _secondaryIndexesBlock->doneInserting(&secDups);
+            // A deferred build scans the loaded documents now and then finishes inserting.
+            auto status = _deferSecondaryIndexBuilds
+                ? _secondaryIndexesBlock->insertAllDocumentsInCollection(&secDups)
+                : _secondaryIndexesBlock->doneInserting(&secDups);
             if (!status.isOK()) {
                 return status;
             }
@@ -89,6 +89,8 @@ private:
     std::unique_ptr<MultiIndexBlock> _idIndexBlock;
     std::unique_ptr<MultiIndexBlock> _secondaryIndexesBlock;
     BSONObj _idIndexSpec;
+    // If true, documents are not inserted into the secondary indexes until commit().
+    bool _deferSecondaryIndexBuilds = false;
     Stats _stats;
 };
 
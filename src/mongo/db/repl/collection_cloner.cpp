@@ -32,6 +32,7 @@
 
 #include "mongo/db/repl/collection_cloner.h"
 
+#include <limits>
 #include <utility>
 
 #include "mongo/base/string_data.h"
@@ -68,6 +69,9 @@ MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncCollectionCountAttempts, int, 3);
 MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncListIndexesAttempts, int, 3);
 // The number of attempts for the find command, which gets the data.
 MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncCollectionFindAttempts, int, 3);
+// Whether each cursor keeps its next batch in flight while the documents of the current one are
+// being inserted, bounded by internalQueryMongosPrefetchMaxBufferedBytes.
+MONGO_EXPORT_SERVER_PARAMETER(initialSyncCollectionClonerReadAhead, bool, false);
 }  // namespace
 
 // Failpoint which causes initial sync to hang when it has cloned 'numDocsToClone' documents to
@@ -265,6 +269,12 @@ void CollectionCloner::waitForDbWorker() {
     _dbWorkTaskRunner.join();
 }
 
+void CollectionCloner::setCollectionCreated() {
+    LockGuard lk(_mutex);
+    invariant(_state == State::kPreStart);
+    _collectionCreated = true;
+}
+
 void CollectionCloner::setScheduleDbWorkFn_forTest(const ScheduleDbWorkFn& scheduleDbWorkFn) {
     LockGuard lk(_mutex);
     _scheduleDbWorkFn = scheduleDbWorkFn;
@@ -435,8 +445,11 @@ void CollectionCloner::_beginCollectionCallback(const executor::TaskExecutor::Ca
             << this->_sourceNss;
     }
 
-    auto collectionBulkLoader = _storageInterface->createCollectionForBulkLoading(
-        _destNss, _options, _idIndexSpec, _indexSpecs);
+    auto collectionBulkLoader = _collectionCreated
+        ? _storageInterface->createBulkLoaderForCollection(
+              _destNss, _options, _idIndexSpec, _indexSpecs)
+        : _storageInterface->createCollectionForBulkLoading(
+              _destNss, _options, _idIndexSpec, _indexSpecs);
 
     if (!collectionBulkLoader.isOK()) {
         _finishCallback(collectionBulkLoader.getStatus());
@@ -600,6 +613,9 @@ void CollectionCloner::_establishCollectionCursorsCallback(const RemoteCommandCa
     _clusterClientCursorParams =
         stdx::make_unique<ClusterClientCursorParams>(_sourceNss, UserNameIterator());
     _clusterClientCursorParams->remotes = std::move(remoteCursors);
+    if (initialSyncCollectionClonerReadAhead.load()) {
+        _clusterClientCursorParams->prefetchLowWaterMark = std::numeric_limits<int>::max();
+    }
     Client::initThreadIfNotAlready();
     _arm = stdx::make_unique<AsyncResultsMerger>(
         cc().getOperationContext(), _executor, _clusterClientCursorParams.get());
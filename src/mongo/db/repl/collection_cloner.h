@@ -129,6 +129,13 @@ public:
 
     CollectionCloner::Stats getStats() const;
 
+    /**
+     * Tells this cloner that the destination collection was already created by
+     * StorageInterface::createCollectionsForBulkLoading(), so that it only builds the indexes.
+     * Must be called before startup().
+     */
+    void setCollectionCreated();
+
     //
     // Testing only functions below.
     //
@@ -274,6 +281,7 @@ private:
     NamespaceString _sourceNss;                         // (R)
     NamespaceString _destNss;                           // (R)
     CollectionOptions _options;                         // (R)
+    bool _collectionCreated = false;                    // (R) Set before startup().
     std::unique_ptr<CollectionBulkLoader> _collLoader;  // (M)
     CallbackFn _onCompletion;             // (M) Invoked once when cloning completes or fails.
     StorageInterface* _storageInterface;  // (R) Not owned by us.
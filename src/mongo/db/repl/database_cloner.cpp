@@ -35,6 +35,8 @@
 #include <algorithm>
 #include <iterator>
 #include <set>
+#include <utility>
+#include <vector>
 
 #include "mongo/client/remote_command_retry_scheduler.h"
 #include "mongo/db/catalog/collection_options.h"
@@ -71,6 +73,10 @@ MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncListCollectionsAttempts, int, 3);
 // The number of cursors to use in the collection cloning process.
 MONGO_EXPORT_SERVER_PARAMETER(maxNumInitialSyncCollectionClonerCursors, int, 1);
 
+// The number of collections of a database to clone concurrently. Each collection is cloned by its
+// own CollectionCloner into its own bulk loader.
+MONGO_EXPORT_SERVER_PARAMETER(maxNumInitialSyncConcurrentCollectionCloners, int, 1);
+
 /**
  * Default listCollections predicate.
  */
@@ -213,6 +219,7 @@ void DatabaseCloner::shutdown() {
 DatabaseCloner::Stats DatabaseCloner::getStats() const {
     LockGuard lk(_mutex);
     DatabaseCloner::Stats stats = _stats;
+    stats.activeCollections = _activeCollectionCloners;
     for (auto&& collectionCloner : _collectionCloners) {
         stats.collectionStats.emplace_back(collectionCloner.getStats());
     }
@@ -281,6 +288,7 @@ void DatabaseCloner::_listCollectionsCallback(const StatusWith<Fetcher::QueryRes
     }
 
     _collectionNamespaces.reserve(_collectionInfos.size());
+    std::vector<std::pair<NamespaceString, CollectionOptions>> collectionsToCreate;
     std::set<std::string> seen;
     for (auto&& info : _collectionInfos) {
         BSONElement nameElement = info.getField(kNameFieldName);
@@ -357,6 +365,7 @@ void DatabaseCloner::_listCollectionsCallback(const StatusWith<Fetcher::QueryRes
 
         _collectionNamespaces.emplace_back(_dbname, collectionName);
         auto&& nss = *_collectionNamespaces.crbegin();
+        collectionsToCreate.emplace_back(nss, options);
 
         try {
             _collectionCloners.emplace_back(
@@ -382,20 +391,67 @@ void DatabaseCloner::_listCollectionsCallback(const StatusWith<Fetcher::QueryRes
         }
     }
 
-    // Start first collection cloner.
-    _currentCollectionClonerIter = _collectionCloners.begin();
+    _maxActiveCollectionCloners =
+        static_cast<size_t>(std::max(1, maxNumInitialSyncConcurrentCollectionCloners.load()));
 
-    LOG(1) << "    cloning collection " << _currentCollectionClonerIter->getSourceNamespace();
+    // Each collection cloner's bulk loader holds a lock on the database until its collection is
+    // cloned, while creating a collection needs the database locked exclusively. Create all of the
+    // collections at once, before any cloner starts, so that concurrent cloners don't wait for
+    // each other.
+    if (_maxActiveCollectionCloners > 1 && _collectionCloners.size() > 1) {
+        // Don't hold our mutex while waiting for the database lock.
+        lk.unlock();
+        Status createStatus =
+            _storageInterface->createCollectionsForBulkLoading(collectionsToCreate);
+        lk.lock();
 
-    Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
-    if (!startStatus.isOK()) {
-        LOG(1) << "    failed to start collection cloning on "
-               << _currentCollectionClonerIter->getSourceNamespace() << ": " << redact(startStatus);
+        if (!createStatus.isOK()) {
+            _finishCallback_inlock(lk, createStatus);
+            return;
+        }
+        if (!_isActive_inlock()) {
+            return;
+        }
+        if (State::kShuttingDown == _state) {
+            _finishCallback_inlock(
+                lk, {ErrorCodes::ShutdownInProgress, "database cloner shutting down"});
+            return;
+        }
+        for (auto&& collectionCloner : _collectionCloners) {
+            collectionCloner.setCollectionCreated();
+        }
+    }
+
+    // Start the first batch of collection cloners.
+    _nextCollectionClonerIter = _collectionCloners.begin();
+
+    Status startStatus = _startCollectionCloners_inlock();
+    if (!startStatus.isOK() && _activeCollectionCloners == 0) {
         _finishCallback_inlock(lk, startStatus);
         return;
     }
 }
 
+Status DatabaseCloner::_startCollectionCloners_inlock() {
+    while (_startCollectionClonerStatus.isOK() &&
+           _activeCollectionCloners < _maxActiveCollectionCloners &&
+           _nextCollectionClonerIter != _collectionCloners.end()) {
+        auto& collectionCloner = *_nextCollectionClonerIter;
+        LOG(1) << "    cloning collection " << collectionCloner.getSourceNamespace();
+
+        Status startStatus = _startCollectionCloner(collectionCloner);
+        if (!startStatus.isOK()) {
+            LOG(1) << "    failed to start collection cloning on "
+                   << collectionCloner.getSourceNamespace() << ": " << redact(startStatus);
+            _startCollectionClonerStatus = startStatus;
+            break;
+        }
+        ++_nextCollectionClonerIter;
+        ++_activeCollectionCloners;
+    }
+    return _startCollectionClonerStatus;
+}
+
 void DatabaseCloner::_collectionClonerCallback(const Status& status, const NamespaceString& nss) {
     auto newStatus = status;
 
@@ -416,17 +472,16 @@ void DatabaseCloner::_collectionClonerCallback(const Status& status, const Names
     lk.unlock();
     _collectionWork(newStatus, nss);
     lk.lock();
-    _currentCollectionClonerIter++;
+    invariant(_activeCollectionCloners > 0);
+    --_activeCollectionCloners;
 
-    if (_currentCollectionClonerIter != _collectionCloners.end()) {
-        Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
-        if (!startStatus.isOK()) {
-            LOG(1) << "    failed to start collection cloning on "
-                   << _currentCollectionClonerIter->getSourceNamespace() << ": "
-                   << redact(startStatus);
-            _finishCallback_inlock(lk, startStatus);
-            return;
-        }
+    // A failure to start a collection cloner is reported once every running cloner has finished.
+    Status startStatus = _startCollectionCloners_inlock();
+    if (_activeCollectionCloners > 0) {
+        return;
+    }
+    if (!startStatus.isOK()) {
+        _finishCallback_inlock(lk, startStatus);
         return;
     }
 
@@ -477,6 +532,7 @@ BSONObj DatabaseCloner::Stats::toBSON() const {
 void DatabaseCloner::Stats::append(BSONObjBuilder* builder) const {
     builder->appendNumber("collections", collections);
     builder->appendNumber("clonedCollections", clonedCollections);
+    builder->appendNumber("activeCollections", activeCollections);
     if (start != Date_t()) {
         builder->appendDate("start", start);
         if (end != Date_t()) {
@@ -68,6 +68,7 @@ public:
         Date_t end;
         size_t collections{0};
         size_t clonedCollections{0};
+        size_t activeCollections{0};
         std::vector<CollectionCloner::Stats> collectionStats;
 
         std::string toString() const;
@@ -190,6 +191,13 @@ private:
      */
     void _collectionClonerCallback(const Status& status, const NamespaceString& nss);
 
+    /**
+     * Starts collection cloners until 'maxNumInitialSyncConcurrentCollectionCloners' cloners are
+     * active or there are no collections left to clone.
+     * On failure to start a cloner, no further cloners are started and the failure is returned.
+     */
+    Status _startCollectionCloners_inlock();
+
     /**
      * Reports completion status.
      * Sets cloner to inactive.
@@ -233,7 +241,10 @@ private:
     std::vector<BSONObj> _collectionInfos;                               // (M)
     std::vector<NamespaceString> _collectionNamespaces;                  // (M)
     std::list<CollectionCloner> _collectionCloners;                      // (M)
-    std::list<CollectionCloner>::iterator _currentCollectionClonerIter;  // (M)
+    std::list<CollectionCloner>::iterator _nextCollectionClonerIter;     // (M)
+    size_t _activeCollectionCloners = 0;                                 // (M)
+    size_t _maxActiveCollectionCloners = 1;                              // (M)
+    Status _startCollectionClonerStatus = Status::OK();                  // (M)
     std::vector<std::pair<Status, NamespaceString>> _failedNamespaces;   // (M)
     CollectionCloner::ScheduleDbWorkFn
         _scheduleDbWorkFn;  // (RT) Function for scheduling database work using the executor.
@@ -38,9 +38,11 @@
 #include "mongo/db/repl/base_cloner_test_fixture.h"
 #include "mongo/db/repl/database_cloner.h"
 #include "mongo/db/repl/storage_interface.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/unittest/task_executor_proxy.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/uuid.h"
 
 namespace {
@@ -908,4 +910,163 @@ TEST_F(DatabaseClonerTest, CreateCollections) {
     stats.commitCalled = true;
 }
 
+TEST_F(DatabaseClonerTest, CreateCollectionsConcurrently) {
+    auto maxClonersParameter = ServerParameterSet::getGlobal()->getMap().at(
+        "maxNumInitialSyncConcurrentCollectionCloners");
+    ASSERT_OK(maxClonersParameter->setFromString("2"));
+    ON_BLOCK_EXIT([maxClonersParameter] {
+        maxClonersParameter->setFromString("1").transitional_ignore();
+    });
+
+    std::vector<NamespaceString> createdCollections;
+    storageInterface->createCollectionsForBulkFn =
+        [&createdCollections](
+            const std::vector<std::pair<NamespaceString, CollectionOptions>>& collections) {
+            for (auto&& collection : collections) {
+                createdCollections.push_back(collection.first);
+            }
+            return Status::OK();
+        };
+
+    // The collection cloners must only build the indexes of the collections created above.
+    storageInterface->createBulkLoaderForCollectionFn = storageInterface->createCollectionForBulkFn;
+    storageInterface->createCollectionForBulkFn =
+        [](const NamespaceString& nss,
+           const CollectionOptions& options,
+           const BSONObj& idIndexSpec,
+           const std::vector<BSONObj>& secondaryIndexSpecs)
+        -> StatusWith<std::unique_ptr<CollectionBulkLoader>> {
+        return Status(ErrorCodes::NamespaceExists, "collection exists");
+    };
+
+    ASSERT_OK(_databaseCloner->startup());
+
+    const std::vector<BSONObj> sourceInfos = {BSON("name"
+                                                   << "a"
+                                                   << "options"
+                                                   << BSONObj()),
+                                              BSON("name"
+                                                   << "b"
+                                                   << "options"
+                                                   << BSONObj())};
+    auto net = getNet();
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+        processNetworkResponse(
+            createListCollectionsResponse(0, BSON_ARRAY(sourceInfos[0] << sourceInfos[1])));
+    }
+    ASSERT_EQUALS(getDetectableErrorStatus(), getStatus());
+    ASSERT_TRUE(_databaseCloner->isActive());
+    ASSERT_EQUALS(2U, _databaseCloner->getStats().activeCollections);
+
+    // Both collections are created together before either cloner starts.
+    ASSERT_EQUALS(2U, createdCollections.size());
+    ASSERT_EQUALS(NamespaceString("db.a"), createdCollections[0]);
+    ASSERT_EQUALS(NamespaceString("db.b"), createdCollections[1]);
+
+    // Both collection cloners have sent their count requests before either one has finished.
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+        auto noi = net->getNextReadyRequest();
+        assertRemoteCommandNameEquals("count", noi->getRequest());
+        ASSERT_EQUALS("a", noi->getRequest().cmdObj.firstElement().String());
+        scheduleNetworkResponse(noi, createCountResponse(0));
+        noi = net->getNextReadyRequest();
+        assertRemoteCommandNameEquals("count", noi->getRequest());
+        ASSERT_EQUALS("b", noi->getRequest().cmdObj.firstElement().String());
+        scheduleNetworkResponse(noi, createCountResponse(0));
+        net->runReadyNetworkOperations();
+
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    }
+    ASSERT_TRUE(_databaseCloner->isActive());
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+        processNetworkResponse(createCursorResponse(0, BSONArray()));
+        processNetworkResponse(createCursorResponse(0, BSONArray()));
+    }
+
+    _databaseCloner->join();
+    ASSERT_OK(getStatus());
+    ASSERT_FALSE(_databaseCloner->isActive());
+    ASSERT_EQUALS(0U, _databaseCloner->getStats().activeCollections);
+    ASSERT_EQUALS(2U, _databaseCloner->getStats().clonedCollections);
+
+    ASSERT_EQUALS(2U, _collections.size());
+    ASSERT_OK(_collections[NamespaceString{"db.a"}].status);
+    ASSERT_TRUE(_collections[NamespaceString{"db.a"}].stats.commitCalled);
+    ASSERT_OK(_collections[NamespaceString{"db.b"}].status);
+    ASSERT_TRUE(_collections[NamespaceString{"db.b"}].stats.commitCalled);
+}
+
+TEST_F(DatabaseClonerTest, FailureToCreateCollectionsForConcurrentCloningStopsCloner) {
+    auto maxClonersParameter = ServerParameterSet::getGlobal()->getMap().at(
+        "maxNumInitialSyncConcurrentCollectionCloners");
+    ASSERT_OK(maxClonersParameter->setFromString("2"));
+    ON_BLOCK_EXIT([maxClonersParameter] {
+        maxClonersParameter->setFromString("1").transitional_ignore();
+    });
+
+    storageInterface->createCollectionsForBulkFn =
+        [](const std::vector<std::pair<NamespaceString, CollectionOptions>>&) {
+            return Status(ErrorCodes::NamespaceExists, "collection exists");
+        };
+
+    ASSERT_OK(_databaseCloner->startup());
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createListCollectionsResponse(0,
+                                                             BSON_ARRAY(BSON("name"
+                                                                             << "a"
+                                                                             << "options"
+                                                                             << BSONObj())
+                                                                        << BSON("name"
+                                                                                << "b"
+                                                                                << "options"
+                                                                                << BSONObj()))));
+    }
+
+    ASSERT_EQUALS(ErrorCodes::NamespaceExists, getStatus().code());
+    ASSERT_FALSE(_databaseCloner->isActive());
+    ASSERT_FALSE(getNet()->hasReadyRequests());
+    ASSERT_TRUE(_collections.empty());
+}
+
+TEST_F(DatabaseClonerTest, ShutdownWhileCreatingCollectionsForConcurrentCloningStopsCloner) {
+    auto maxClonersParameter = ServerParameterSet::getGlobal()->getMap().at(
+        "maxNumInitialSyncConcurrentCollectionCloners");
+    ASSERT_OK(maxClonersParameter->setFromString("2"));
+    ON_BLOCK_EXIT([maxClonersParameter] {
+        maxClonersParameter->setFromString("1").transitional_ignore();
+    });
+
+    // The database cloner must not hold its mutex while the collections are created.
+    storageInterface->createCollectionsForBulkFn =
+        [this](const std::vector<std::pair<NamespaceString, CollectionOptions>>&) {
+            _databaseCloner->shutdown();
+            return Status::OK();
+        };
+
+    ASSERT_OK(_databaseCloner->startup());
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createListCollectionsResponse(0,
+                                                             BSON_ARRAY(BSON("name"
+                                                                             << "a"
+                                                                             << "options"
+                                                                             << BSONObj())
+                                                                        << BSON("name"
+                                                                                << "b"
+                                                                                << "options"
+                                                                                << BSONObj()))));
+    }
+
+    ASSERT_EQUALS(ErrorCodes::ShutdownInProgress, getStatus().code());
+    ASSERT_FALSE(_databaseCloner->isActive());
+    ASSERT_FALSE(getNet()->hasReadyRequests());
+    ASSERT_EQUALS(0U, _databaseCloner->getStats().activeCollections);
+    ASSERT_TRUE(_collections.empty());
+}
+
 }  // namespace
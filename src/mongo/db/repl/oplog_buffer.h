@@ -34,6 +34,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/db/repl/oplog_entry.h"
 #include "mongo/util/time_support.h"
 
 namespace mongo {
@@ -156,6 +157,23 @@ public:
      */
     virtual bool peek(OperationContext* opCtx, Value* value) = 0;
 
+    /**
+     * Returns false if oplog buffer is empty.
+     * Otherwise, returns true and sets "entry" to last item in oplog buffer, parsed. Throws if the
+     * item is not a valid oplog entry.
+     *
+     * Buffers which parse entries as they are pushed override this so that the consumer does not
+     * pay for parsing. By default, the item returned by peek() is parsed on demand.
+     */
+    virtual bool peekParsed(OperationContext* opCtx, boost::optional<OplogEntry>* entry) {
+        Value value;
+        if (!peek(opCtx, &value)) {
+            return false;
+        }
+        entry->emplace(value);
+        return true;
+    }
+
     /**
      * Returns the item most recently added to the oplog buffer or nothing if the buffer is empty.
      */
@@ -30,6 +30,9 @@
 
 #include "mongo/db/repl/oplog_buffer_blocking_queue.h"
 
+#include <algorithm>
+#include <iterator>
+
 namespace mongo {
 namespace repl {
 
@@ -38,14 +41,22 @@ namespace {
 // Limit buffer to 256MB
 const size_t kOplogBufferSize = 256 * 1024 * 1024;
 
-size_t getDocumentSize(const BSONObj& o) {
-    // SERVER-9808 Avoid Fortify complaint about implicit signed->unsigned conversion
-    return static_cast<size_t>(o.objsize());
-}
-
 }  // namespace
 
-OplogBufferBlockingQueue::OplogBufferBlockingQueue() : _queue(kOplogBufferSize, &getDocumentSize) {}
+OplogBufferBlockingQueue::OplogBufferBlockingQueue()
+    : _queue(kOplogBufferSize, [](const Entry& entry) {
+          // SERVER-9808 Avoid Fortify complaint about implicit signed->unsigned conversion
+          return static_cast<size_t>(entry.raw.objsize());
+      }) {}
+
+OplogBufferBlockingQueue::Entry OplogBufferBlockingQueue::_makeEntry(const BSONObj& raw) {
+    Entry entry{raw, nullptr};
+    auto parsed = OplogEntry::parse(raw);
+    if (parsed.isOK()) {
+        entry.parsed = std::make_shared<const OplogEntry>(std::move(parsed.getValue()));
+    }
+    return entry;
+}
 
 void OplogBufferBlockingQueue::startup(OperationContext*) {}
 
@@ -54,17 +65,22 @@ void OplogBufferBlockingQueue::shutdown(OperationContext* opCtx) {
 }
 
 void OplogBufferBlockingQueue::pushEvenIfFull(OperationContext*, const Value& value) {
-    _queue.pushEvenIfFull(value);
+    _queue.pushEvenIfFull(_makeEntry(value));
 }
 
 void OplogBufferBlockingQueue::push(OperationContext*, const Value& value) {
-    _queue.push(value);
+    _queue.push(_makeEntry(value));
 }
 
 void OplogBufferBlockingQueue::pushAllNonBlocking(OperationContext*,
                                                   Batch::const_iterator begin,
                                                   Batch::const_iterator end) {
-    _queue.pushAllNonBlocking(begin, end);
+    // Parse everything before handing it to the queue so that parsing happens outside of the
+    // queue's mutex.
+    std::vector<Entry> entries;
+    entries.reserve(std::distance(begin, end));
+    std::transform(begin, end, std::back_inserter(entries), &_makeEntry);
+    _queue.pushAllNonBlocking(entries.cbegin(), entries.cend());
 }
 
 void OplogBufferBlockingQueue::waitForSpace(OperationContext*, std::size_t size) {
@@ -92,21 +108,48 @@ void OplogBufferBlockingQueue::clear(OperationContext*) {
 }
 
 bool OplogBufferBlockingQueue::tryPop(OperationContext*, Value* value) {
-    return _queue.tryPop(*value);
+    Entry entry;
+    if (!_queue.tryPop(entry)) {
+        return false;
+    }
+    *value = std::move(entry.raw);
+    return true;
 }
 
 bool OplogBufferBlockingQueue::waitForData(Seconds waitDuration) {
-    Value ignored;
+    Entry ignored;
     return _queue.blockingPeek(ignored, static_cast<int>(durationCount<Seconds>(waitDuration)));
 }
 
 bool OplogBufferBlockingQueue::peek(OperationContext*, Value* value) {
-    return _queue.peek(*value);
+    Entry entry;
+    if (!_queue.peek(entry)) {
+        return false;
+    }
+    *value = std::move(entry.raw);
+    return true;
+}
+
+bool OplogBufferBlockingQueue::peekParsed(OperationContext*, boost::optional<OplogEntry>* entry) {
+    Entry peeked;
+    if (!_queue.peek(peeked)) {
+        return false;
+    }
+    if (peeked.parsed) {
+        entry->emplace(*peeked.parsed);
+    } else {
+        entry->emplace(peeked.raw);
+    }
+    return true;
 }
 
 boost::optional<OplogBuffer::Value> OplogBufferBlockingQueue::lastObjectPushed(
     OperationContext*) const {
-    return _queue.lastObjectPushed();
+    auto entry = _queue.lastObjectPushed();
+    if (!entry) {
+        return boost::none;
+    }
+    return entry->raw;
 }
 
 }  // namespace repl
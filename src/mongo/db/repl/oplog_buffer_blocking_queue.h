@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include "mongo/db/repl/oplog_buffer.h"
 #include "mongo/util/queue.h"
 
@@ -36,6 +38,9 @@ namespace repl {
 
 /**
  * Oplog buffer backed by in memory blocking queue of BSONObj.
+ *
+ * Entries are parsed as they are pushed, on the producer's thread, so that peekParsed() hands the
+ * consumer an entry which is ready to be batched.
  */
 class OplogBufferBlockingQueue final : public OplogBuffer {
 public:
@@ -57,10 +62,23 @@ public:
     bool tryPop(OperationContext* opCtx, Value* value) override;
     bool waitForData(Seconds waitDuration) override;
     bool peek(OperationContext* opCtx, Value* value) override;
+    bool peekParsed(OperationContext* opCtx, boost::optional<OplogEntry>* entry) override;
     boost::optional<Value> lastObjectPushed(OperationContext* opCtx) const override;
 
 private:
-    BlockingQueue<BSONObj> _queue;
+    /**
+     * An item in the queue. "parsed" is shared so that copying an entry in and out of the queue
+     * stays cheap. It is null if "raw" failed to parse, in which case it is parsed again by
+     * peekParsed() so that the consumer sees the same error it would have without parsing ahead.
+     */
+    struct Entry {
+        BSONObj raw;
+        std::shared_ptr<const OplogEntry> parsed;
+    };
+
+    static Entry _makeEntry(const BSONObj& raw);
+
+    BlockingQueue<Entry> _queue;
 };
 
 }  // namespace repl
@@ -0,0 +1,121 @@
+/**
+ *    Copyright 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplog_buffer_blocking_queue.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+using namespace mongo::repl;
+
+/**
+ * Generates oplog entries with the given number used for the timestamp.
+ */
+BSONObj makeOplogEntry(int t) {
+    return BSON("ts" << Timestamp(t, t) << "h" << t << "ns"
+                     << "a.a"
+                     << "v"
+                     << 2
+                     << "op"
+                     << "i"
+                     << "o"
+                     << BSON("_id" << t << "a" << t));
+}
+
+TEST(OplogBufferBlockingQueueTest, PeekParsedReturnsEntryParsedOnPush) {
+    OplogBufferBlockingQueue oplogBuffer;
+    oplogBuffer.startup(nullptr);
+
+    const auto oplog = makeOplogEntry(1);
+    oplogBuffer.push(nullptr, oplog);
+
+    boost::optional<OplogEntry> entry;
+    ASSERT_TRUE(oplogBuffer.peekParsed(nullptr, &entry));
+    ASSERT_TRUE(entry);
+    ASSERT_BSONOBJ_EQ(oplog, entry->raw);
+    ASSERT_EQUALS(Timestamp(1, 1), entry->getTimestamp());
+
+    // Peeking does not remove the entry.
+    ASSERT_EQUALS(1U, oplogBuffer.getCount());
+
+    BSONObj doc;
+    ASSERT_TRUE(oplogBuffer.tryPop(nullptr, &doc));
+    ASSERT_BSONOBJ_EQ(oplog, doc);
+    ASSERT_FALSE(oplogBuffer.peekParsed(nullptr, &entry));
+
+    oplogBuffer.shutdown(nullptr);
+}
+
+TEST(OplogBufferBlockingQueueTest, PushAllNonBlockingParsesEveryEntryInOrder) {
+    OplogBufferBlockingQueue oplogBuffer;
+    oplogBuffer.startup(nullptr);
+
+    const std::vector<BSONObj> oplog = {makeOplogEntry(1), makeOplogEntry(2), makeOplogEntry(3)};
+    oplogBuffer.pushAllNonBlocking(nullptr, oplog.cbegin(), oplog.cend());
+    ASSERT_EQUALS(oplog.size(), oplogBuffer.getCount());
+    ASSERT_EQUALS(std::size_t(oplog[0].objsize() + oplog[1].objsize() + oplog[2].objsize()),
+                  oplogBuffer.getSize());
+    ASSERT_BSONOBJ_EQ(oplog.back(), *oplogBuffer.lastObjectPushed(nullptr));
+
+    for (const auto& expected : oplog) {
+        boost::optional<OplogEntry> entry;
+        ASSERT_TRUE(oplogBuffer.peekParsed(nullptr, &entry));
+        ASSERT_BSONOBJ_EQ(expected, entry->raw);
+
+        BSONObj doc;
+        ASSERT_TRUE(oplogBuffer.tryPop(nullptr, &doc));
+        ASSERT_BSONOBJ_EQ(expected, doc);
+    }
+    ASSERT_TRUE(oplogBuffer.isEmpty());
+
+    oplogBuffer.shutdown(nullptr);
+}
+
+TEST(OplogBufferBlockingQueueTest, PeekParsedThrowsOnEntryWhichFailedToParse) {
+    OplogBufferBlockingQueue oplogBuffer;
+    oplogBuffer.startup(nullptr);
+
+    const auto invalid = BSON("ts" << Timestamp(1, 1));
+    oplogBuffer.push(nullptr, invalid);
+
+    // The raw document is still available to consumers which don't need it parsed.
+    BSONObj doc;
+    ASSERT_TRUE(oplogBuffer.peek(nullptr, &doc));
+    ASSERT_BSONOBJ_EQ(invalid, doc);
+
+    boost::optional<OplogEntry> entry;
+    ASSERT_THROWS(oplogBuffer.peekParsed(nullptr, &entry), AssertionException);
+
+    oplogBuffer.shutdown(nullptr);
+}
+
+}  // namespace
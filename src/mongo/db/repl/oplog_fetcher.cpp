@@ -63,6 +63,12 @@ ServerStatusMetricField<Counter64> displayOpsRead("repl.network.ops", &opsReadSt
 Counter64 networkByteStats;
 ServerStatusMetricField<Counter64> displayBytesRead("repl.network.bytes", &networkByteStats);
 
+// Time from the newest op of each fetched batch being written on the sync source, according to
+// its wall clock, until the batch arrived here. Clock skew between the nodes shifts these values.
+TimerHistogram fetchLatencyStats;
+ServerStatusMetricField<TimerHistogram> displayFetchLatency("repl.pipeline.fetch",
+                                                            &fetchLatencyStats);
+
 /**
  * Calculates await data timeout based on the current replica set configuration.
  */
@@ -480,6 +486,14 @@ StatusWith<BSONObj> OplogFetcher::_onSuccessfulBatch(const Fetcher::QueryRespons
     // Record time for each batch.
     getmoreReplStats.recordMillis(durationCount<Milliseconds>(queryResponse.elapsedMillis));
 
+    if (!documents.empty()) {
+        const auto wallClockTime = documents.back()["wall"];
+        if (wallClockTime.type() == Date) {
+            fetchLatencyStats.recordMicros(
+                durationCount<Microseconds>(Date_t::now() - wallClockTime.date()));
+        }
+    }
+
     // TODO: back pressure handling will be added in SERVER-23499.
     auto status = _enqueueDocumentsFn(firstDocToApply, documents.cend(), info);
     if (!status.isOK()) {
@@ -32,7 +32,10 @@
 
 #include "mongo/db/repl/replication_coordinator_external_state_impl.h"
 
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
 #include <string>
+#include <vector>
 
 #include "mongo/base/init.h"
 #include "mongo/base/status_with.h"
@@ -136,6 +139,12 @@ MONGO_EXPORT_STARTUP_SERVER_PARAMETER(initialSyncOplogBuffer,
 // Set this to specify size of read ahead buffer in the OplogBufferCollection.
 MONGO_EXPORT_STARTUP_SERVER_PARAMETER(initialSyncOplogBufferPeekCacheSize, int, 10000);
 
+// Comma-separated list of network message compressors that connections used to fetch the oplog
+// and clone data from the sync source should prefer over the order given by
+// --networkMessageCompressors. Only compressors enabled by --networkMessageCompressors are used.
+// For example, "zlib" trades CPU for less egress to secondaries in a remote region.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(replNetworkMessageCompressors, std::string, "");
+
 // Set this to specify maximum number of times the oplog fetcher will consecutively restart the
 // oplog tailing query on non-cancellation errors.
 server_parameter_storage_type<int, ServerParameterType::kStartupAndRuntime>::value_type
@@ -303,9 +312,18 @@ void ReplicationCoordinatorExternalStateImpl::startThreads(const ReplSettings& s
 
     auto hookList = stdx::make_unique<rpc::EgressMetadataHookList>();
     hookList->addHook(stdx::make_unique<rpc::LogicalTimeMetadataHook>(_service));
+    std::vector<std::string> preferredCompressors;
+    if (!replNetworkMessageCompressors.empty()) {
+        boost::algorithm::split(
+            preferredCompressors, replNetworkMessageCompressors, boost::is_any_of(", "));
+    }
     _taskExecutor = stdx::make_unique<executor::ThreadPoolTaskExecutor>(
         makeThreadPool(),
-        executor::makeNetworkInterface("NetworkInterfaceASIO-RS", nullptr, std::move(hookList)));
+        executor::makeNetworkInterface("NetworkInterfaceASIO-RS",
+                                       nullptr,
+                                       std::move(hookList),
+                                       executor::ConnectionPool::Options(),
+                                       std::move(preferredCompressors)));
     _taskExecutor->startup();
 
     _writerPool = SyncTail::makeWriterPool();
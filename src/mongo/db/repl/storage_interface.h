@@ -33,6 +33,8 @@
 #include <cstddef>
 #include <iosfwd>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/string_data.h"
@@ -103,6 +105,29 @@ public:
         const BSONObj idIndexSpec,
         const std::vector<BSONObj>& secondaryIndexSpecs) = 0;
 
+    /**
+     * Like createCollectionForBulkLoading(), but for an empty collection that was already created
+     * by createCollectionsForBulkLoading(). Only takes an intent lock on the database.
+     *
+     * Assumes that no database locks have been acquired prior to calling this function.
+     */
+    virtual StatusWith<std::unique_ptr<CollectionBulkLoader>> createBulkLoaderForCollection(
+        const NamespaceString& nss,
+        const CollectionOptions& options,
+        const BSONObj idIndexSpec,
+        const std::vector<BSONObj>& secondaryIndexSpecs) = 0;
+
+    /**
+     * Creates empty collections, without indexes, for createBulkLoaderForCollection() to fill in
+     * later. All of the collections must be in the same database, which is locked exclusively once
+     * for all of them. A bulk loader holds a lock on its database until it commits, so this lets
+     * several collections of a database be loaded at once.
+     *
+     * Assumes that no database locks have been acquired prior to calling this function.
+     */
+    virtual Status createCollectionsForBulkLoading(
+        const std::vector<std::pair<NamespaceString, CollectionOptions>>& collections) = 0;
+
     /**
      * Inserts a document with a timestamp into a collection.
      *
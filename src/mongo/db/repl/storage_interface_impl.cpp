@@ -88,6 +88,30 @@ using UniqueLock = stdx::unique_lock<stdx::mutex>;
 
 const auto kIdIndexName = "_id_"_sd;
 
+/**
+ * Takes the current thread's Client, if any, away for the lifetime of this object, so that a new
+ * Client can be bound in its place. Restores it on destruction.
+ */
+class StashClient {
+public:
+    StashClient() {
+        if (Client::getCurrent()) {
+            _stashedClient = Client::releaseCurrent();
+        }
+    }
+    ~StashClient() {
+        if (Client::getCurrent()) {
+            Client::releaseCurrent();
+        }
+        if (_stashedClient) {
+            Client::setCurrent(std::move(_stashedClient));
+        }
+    }
+
+private:
+    ServiceContext::UniqueClient _stashedClient;
+};
+
 }  // namespace
 
 StorageInterfaceImpl::StorageInterfaceImpl()
@@ -172,26 +196,28 @@ StorageInterfaceImpl::createCollectionForBulkLoading(
     const std::vector<BSONObj>& secondaryIndexSpecs) {
 
     LOG(2) << "StorageInterfaceImpl::createCollectionForBulkLoading called for ns: " << nss.ns();
+    return _createBulkLoader(nss, options, idIndexSpec, secondaryIndexSpecs, false);
+}
 
-    class StashClient {
-    public:
-        StashClient() {
-            if (Client::getCurrent()) {
-                _stashedClient = Client::releaseCurrent();
-            }
-        }
-        ~StashClient() {
-            if (Client::getCurrent()) {
-                Client::releaseCurrent();
-            }
-            if (_stashedClient) {
-                Client::setCurrent(std::move(_stashedClient));
-            }
-        }
+StatusWith<std::unique_ptr<CollectionBulkLoader>>
+StorageInterfaceImpl::createBulkLoaderForCollection(
+    const NamespaceString& nss,
+    const CollectionOptions& options,
+    const BSONObj idIndexSpec,
+    const std::vector<BSONObj>& secondaryIndexSpecs) {
+
+    LOG(2) << "StorageInterfaceImpl::createBulkLoaderForCollection called for ns: " << nss.ns();
+    return _createBulkLoader(nss, options, idIndexSpec, secondaryIndexSpecs, true);
+}
 
-    private:
-        ServiceContext::UniqueClient _stashedClient;
-    } stash;
+StatusWith<std::unique_ptr<CollectionBulkLoader>> StorageInterfaceImpl::_createBulkLoader(
+    const NamespaceString& nss,
+    const CollectionOptions& options,
+    const BSONObj idIndexSpec,
+    const std::vector<BSONObj>& secondaryIndexSpecs,
+    bool collectionCreated) {
+
+    StashClient stash;
     Client::setCurrent(
         getGlobalServiceContext()->makeClient(str::stream() << nss.ns() << " loader"));
     auto opCtx = cc().makeOperationContext();
@@ -203,18 +229,28 @@ StorageInterfaceImpl::createCollectionForBulkLoading(
     Status status = writeConflictRetry(opCtx.get(), "beginCollectionClone", nss.ns(), [&] {
         UnreplicatedWritesBlock uwb(opCtx.get());
 
-        // Get locks and create the collection.
-        AutoGetOrCreateDb db(opCtx.get(), nss.db(), MODE_X);
-        AutoGetCollection coll(opCtx.get(), nss, MODE_IX);
+        // Get locks and create the collection. A collection created by
+        // createCollectionsForBulkLoading() only needs to be locked exclusively itself, which does
+        // not wait for the bulk loaders of other collections in the database.
+        boost::optional<AutoGetOrCreateDb> db;
+        boost::optional<AutoGetCollection> coll;
+        if (collectionCreated) {
+            coll.emplace(opCtx.get(), nss, MODE_IX, MODE_X);
+            if (!coll->getCollection()) {
+                return Status(ErrorCodes::NamespaceNotFound,
+                              str::stream() << "Collection " << nss.ns() << " no longer exists.");
+            }
+        } else {
+            db.emplace(opCtx.get(), nss.db(), MODE_X);
+            coll.emplace(opCtx.get(), nss, MODE_IX);
 
-        if (coll.getCollection()) {
-            return Status(ErrorCodes::NamespaceExists,
-                          str::stream() << "Collection " << nss.ns() << " already exists.");
-        }
-        {
+            if (coll->getCollection()) {
+                return Status(ErrorCodes::NamespaceExists,
+                              str::stream() << "Collection " << nss.ns() << " already exists.");
+            }
             // Create the collection.
             WriteUnitOfWork wunit(opCtx.get());
-            fassert(40332, db.getDb()->createCollection(opCtx.get(), nss.ns(), options, false));
+            fassert(40332, db->getDb()->createCollection(opCtx.get(), nss.ns(), options, false));
             wunit.commit();
         }
 
@@ -265,6 +301,44 @@ StorageInterfaceImpl::createCollectionForBulkLoading(
     return {std::move(loader)};
 }
 
+Status StorageInterfaceImpl::createCollectionsForBulkLoading(
+    const std::vector<std::pair<NamespaceString, CollectionOptions>>& collections) {
+    if (collections.empty()) {
+        return Status::OK();
+    }
+    const auto dbName = collections.front().first.db();
+
+    LOG(2) << "StorageInterfaceImpl::createCollectionsForBulkLoading called for "
+           << collections.size() << " collection(s) in db: " << dbName;
+
+    StashClient stash;
+    Client::setCurrent(
+        getGlobalServiceContext()->makeClient(str::stream() << dbName << " bulk loading"));
+    auto opCtx = cc().makeOperationContext();
+
+    Status status = writeConflictRetry(opCtx.get(), "beginCollectionClones", dbName, [&] {
+        UnreplicatedWritesBlock uwb(opCtx.get());
+
+        AutoGetOrCreateDb db(opCtx.get(), dbName, MODE_X);
+        WriteUnitOfWork wunit(opCtx.get());
+        for (auto&& collection : collections) {
+            const auto& nss = collection.first;
+            invariant(nss.db() == dbName);
+            if (db.getDb()->getCollection(opCtx.get(), nss)) {
+                return Status(ErrorCodes::NamespaceExists,
+                              str::stream() << "Collection " << nss.ns() << " already exists.");
+            }
+            // The indexes are built by the collection's bulk loader.
+            fassert(40671,
+                    db.getDb()->createCollection(
+                        opCtx.get(), nss.ns(), collection.second, false /* createIdIndex */));
+        }
+        wunit.commit();
+        return Status::OK();
+    });
+    return status;
+}
+
 Status StorageInterfaceImpl::insertDocument(OperationContext* opCtx,
                                             const NamespaceString& nss,
                                             const TimestampedBSONObj& doc,
@@ -64,6 +64,15 @@ public:
         const BSONObj idIndexSpec,
         const std::vector<BSONObj>& secondaryIndexSpecs) override;
 
+    StatusWith<std::unique_ptr<CollectionBulkLoader>> createBulkLoaderForCollection(
+        const NamespaceString& nss,
+        const CollectionOptions& options,
+        const BSONObj idIndexSpec,
+        const std::vector<BSONObj>& secondaryIndexSpecs) override;
+
+    Status createCollectionsForBulkLoading(
+        const std::vector<std::pair<NamespaceString, CollectionOptions>>& collections) override;
+
     Status insertDocument(OperationContext* opCtx,
                           const NamespaceString& nss,
                           const TimestampedBSONObj& doc,
@@ -151,6 +160,17 @@ public:
     void waitForAllEarlierOplogWritesToBeVisible(OperationContext* opCtx) override;
 
 private:
+    /**
+     * Implements createCollectionForBulkLoading() and, when 'collectionCreated' is true,
+     * createBulkLoaderForCollection().
+     */
+    StatusWith<std::unique_ptr<CollectionBulkLoader>> _createBulkLoader(
+        const NamespaceString& nss,
+        const CollectionOptions& options,
+        const BSONObj idIndexSpec,
+        const std::vector<BSONObj>& secondaryIndexSpecs,
+        bool collectionCreated);
+
     const NamespaceString _rollbackIdNss;
 };
 
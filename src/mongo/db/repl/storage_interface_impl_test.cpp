@@ -48,12 +48,14 @@
 #include "mongo/db/repl/oplog_interface_local.h"
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/storage_interface_impl.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context_d_test_fixture.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace {
 
@@ -510,6 +512,42 @@ TEST_F(StorageInterfaceImplTest, CreateCollectionWithIDIndexCommits) {
     ASSERT_EQ(count, 2LL);
 }
 
+TEST_F(StorageInterfaceImplTest, CreateCollectionWithDeferredSecondaryIndexBuildCommits) {
+    auto deferParameter =
+        ServerParameterSet::getGlobal()->getMap().at("initialSyncDeferSecondaryIndexBuilds");
+    ASSERT_OK(deferParameter->setFromString("true"));
+    ON_BLOCK_EXIT(
+        [deferParameter] { deferParameter->setFromString("false").transitional_ignore(); });
+
+    auto opCtx = getOperationContext();
+    StorageInterfaceImpl storage;
+    auto nss = makeNamespace(_agent);
+    CollectionOptions opts;
+    std::vector<BSONObj> indexes = {BSON("v" << 1 << "key" << BSON("x" << 1) << "name"
+                                             << "x_1"
+                                             << "ns"
+                                             << nss.ns())};
+    auto loaderStatus =
+        storage.createCollectionForBulkLoading(nss, opts, makeIdIndexSpec(nss), indexes);
+    ASSERT_OK(loaderStatus.getStatus());
+    auto loader = std::move(loaderStatus.getValue());
+    std::vector<BSONObj> docs = {
+        BSON("_id" << 1 << "x" << 1), BSON("_id" << 1 << "x" << 1), BSON("_id" << 2 << "x" << 2)};
+    ASSERT_OK(loader->insertDocuments(docs.begin(), docs.end()));
+    ASSERT_OK(loader->commit());
+
+    AutoGetCollectionForReadCommand autoColl(opCtx, nss);
+    auto coll = autoColl.getCollection();
+    ASSERT(coll);
+    ASSERT_EQ(coll->getRecordStore()->numRecords(opCtx), 2LL);
+    auto collIdxCat = coll->getIndexCatalog();
+    auto idIdxDesc = collIdxCat->findIdIndex(opCtx);
+    ASSERT_EQ(getIndexKeyCount(opCtx, collIdxCat, idIdxDesc), 2LL);
+    auto secondaryIdxDesc = collIdxCat->findIndexByName(opCtx, "x_1");
+    ASSERT(secondaryIdxDesc);
+    ASSERT_EQ(getIndexKeyCount(opCtx, collIdxCat, secondaryIdxDesc), 2LL);
+}
+
 void _testDestroyUncommitedCollectionBulkLoader(
     OperationContext* opCtx,
     const NamespaceString& nss,
@@ -594,6 +632,82 @@ TEST_F(StorageInterfaceImplTest, CreateCollectionThatAlreadyExistsFails) {
     ASSERT_NOT_OK(status.getStatus());
 }
 
+TEST_F(StorageInterfaceImplTest, CreateCollectionsForBulkLoadingLetsLoadersRunConcurrently) {
+    auto opCtx = getOperationContext();
+    StorageInterfaceImpl storage;
+    auto nss = makeNamespace(_agent, "a");
+    auto cappedNss = makeNamespace(_agent, "b");
+    CollectionOptions opts;
+    CollectionOptions cappedOpts;
+    cappedOpts.capped = true;
+    cappedOpts.cappedSize = 1024 * 1024;
+    ASSERT_OK(storage.createCollectionsForBulkLoading({{nss, opts}, {cappedNss, cappedOpts}}));
+
+    std::vector<BSONObj> indexes = {BSON("v" << 1 << "key" << BSON("x" << 1) << "name"
+                                             << "x_1"
+                                             << "ns"
+                                             << nss.ns())};
+    auto loader = unittest::assertGet(
+        storage.createBulkLoaderForCollection(nss, opts, makeIdIndexSpec(nss), indexes));
+
+    // 'loader' holds its locks until it commits. Starting a second loader in the same database
+    // would wait for them forever if it had to create its collection.
+    auto cappedLoader = unittest::assertGet(storage.createBulkLoaderForCollection(
+        cappedNss, cappedOpts, makeIdIndexSpec(cappedNss), {}));
+
+    std::vector<BSONObj> docs = {BSON("_id" << 1 << "x" << 1), BSON("_id" << 2 << "x" << 2)};
+    ASSERT_OK(cappedLoader->insertDocuments(docs.begin(), docs.end()));
+    ASSERT_OK(loader->insertDocuments(docs.begin(), docs.end()));
+    ASSERT_OK(cappedLoader->commit());
+    ASSERT_OK(loader->commit());
+
+    for (auto&& loadedNss : {nss, cappedNss}) {
+        AutoGetCollectionForReadCommand autoColl(opCtx, loadedNss);
+        auto coll = autoColl.getCollection();
+        ASSERT(coll);
+        ASSERT_EQ(coll->getRecordStore()->numRecords(opCtx), 2LL);
+        auto collIdxCat = coll->getIndexCatalog();
+        ASSERT_EQ(getIndexKeyCount(opCtx, collIdxCat, collIdxCat->findIdIndex(opCtx)), 2LL);
+    }
+    AutoGetCollectionForReadCommand autoColl(opCtx, nss);
+    auto collIdxCat = autoColl.getCollection()->getIndexCatalog();
+    auto secondaryIdxDesc = collIdxCat->findIndexByName(opCtx, "x_1");
+    ASSERT(secondaryIdxDesc);
+    ASSERT_EQ(getIndexKeyCount(opCtx, collIdxCat, secondaryIdxDesc), 2LL);
+}
+
+TEST_F(StorageInterfaceImplTest, CreateCollectionsForBulkLoadingFailsIfACollectionExists) {
+    auto opCtx = getOperationContext();
+    StorageInterfaceImpl storage;
+    auto nss = makeNamespace(_agent, "a");
+    auto existingNss = makeNamespace(_agent, "b");
+    createCollection(opCtx, existingNss);
+
+    ASSERT_EQUALS(ErrorCodes::NamespaceExists,
+                  storage.createCollectionsForBulkLoading(
+                      {{nss, CollectionOptions()}, {existingNss, CollectionOptions()}}));
+
+    // No collection was created.
+    ASSERT_EQUALS(ErrorCodes::NamespaceNotFound,
+                  storage
+                      .createBulkLoaderForCollection(
+                          nss, CollectionOptions(), makeIdIndexSpec(nss), {})
+                      .getStatus());
+}
+
+TEST_F(StorageInterfaceImplTest,
+       CreateCollectionForBulkLoadingFailsOnCollectionFromCreateCollectionsForBulkLoading) {
+    StorageInterfaceImpl storage;
+    auto nss = makeNamespace(_agent);
+    ASSERT_OK(storage.createCollectionsForBulkLoading({{nss, CollectionOptions()}}));
+
+    ASSERT_EQUALS(ErrorCodes::NamespaceExists,
+                  storage
+                      .createCollectionForBulkLoading(
+                          nss, CollectionOptions(), makeIdIndexSpec(nss), {})
+                      .getStatus());
+}
+
 TEST_F(StorageInterfaceImplTest, CreateOplogCreateCappedCollection) {
     auto opCtx = getOperationContext();
     StorageInterfaceImpl storage;
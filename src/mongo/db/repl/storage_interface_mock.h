@@ -89,6 +89,8 @@ public:
             const CollectionOptions& options,
             const BSONObj idIndexSpec,
             const std::vector<BSONObj>& secondaryIndexSpecs)>;
+    using CreateCollectionsForBulkFn = stdx::function<Status(
+        const std::vector<std::pair<NamespaceString, CollectionOptions>>& collections)>;
     using InsertDocumentFn = stdx::function<Status(OperationContext* opCtx,
                                                    const NamespaceString& nss,
                                                    const TimestampedBSONObj& doc,
@@ -137,6 +139,19 @@ public:
         return createCollectionForBulkFn(nss, options, idIndexSpec, secondaryIndexSpecs);
     };
 
+    StatusWith<std::unique_ptr<CollectionBulkLoader>> createBulkLoaderForCollection(
+        const NamespaceString& nss,
+        const CollectionOptions& options,
+        const BSONObj idIndexSpec,
+        const std::vector<BSONObj>& secondaryIndexSpecs) override {
+        return createBulkLoaderForCollectionFn(nss, options, idIndexSpec, secondaryIndexSpecs);
+    };
+
+    Status createCollectionsForBulkLoading(
+        const std::vector<std::pair<NamespaceString, CollectionOptions>>& collections) override {
+        return createCollectionsForBulkFn(collections);
+    };
+
     Status insertDocument(OperationContext* opCtx,
                           const NamespaceString& nss,
                           const TimestampedBSONObj& doc,
@@ -282,6 +297,20 @@ public:
                secondaryIndexSpecs) -> StatusWith<std::unique_ptr<CollectionBulkLoader>> {
         return Status{ErrorCodes::IllegalOperation, "CreateCollectionForBulkFn not implemented."};
     };
+    CreateCollectionForBulkFn createBulkLoaderForCollectionFn =
+        [](const NamespaceString& nss,
+           const CollectionOptions& options,
+           const BSONObj idIndexSpec,
+           const std::vector<BSONObj>&
+               secondaryIndexSpecs) -> StatusWith<std::unique_ptr<CollectionBulkLoader>> {
+        return Status{ErrorCodes::IllegalOperation,
+                      "createBulkLoaderForCollectionFn not implemented."};
+    };
+    CreateCollectionsForBulkFn createCollectionsForBulkFn =
+        [](const std::vector<std::pair<NamespaceString, CollectionOptions>>& collections) {
+            return Status{ErrorCodes::IllegalOperation,
+                          "CreateCollectionsForBulkFn not implemented."};
+        };
     InsertDocumentFn insertDocumentFn = [](OperationContext* opCtx,
                                            const NamespaceString& nss,
                                            const TimestampedBSONObj& doc,
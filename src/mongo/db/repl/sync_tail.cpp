@@ -35,7 +35,10 @@
 
 #include "third_party/murmurhash3/MurmurHash3.h"
 #include <boost/functional/hash.hpp>
+#include <deque>
 #include <memory>
+#include <numeric>
+#include <queue>
 
 #include "mongo/base/counter.h"
 #include "mongo/bson/bsonelement_comparator.h"
@@ -71,13 +74,17 @@
 #include "mongo/db/session.h"
 #include "mongo/db/session_txn_record.h"
 #include "mongo/db/stats/timer_stats.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/net/socket_exception.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -86,6 +93,7 @@ using std::endl;
 namespace repl {
 
 AtomicInt32 SyncTail::replBatchLimitOperations{50 * 1000};
+AtomicInt32 SyncTail::replBatchApplyTargetMillis{0};
 
 /**
  * This variable determines the number of writer threads SyncTail will have. It has a default
@@ -137,6 +145,25 @@ public:
     }
 } exportedBatchLimitOperationsParam;
 
+class ExportedBatchApplyTargetMillisParameter
+    : public ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime> {
+public:
+    ExportedBatchApplyTargetMillisParameter()
+        : ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(),
+              "replBatchApplyTargetMillis",
+              &SyncTail::replBatchApplyTargetMillis) {}
+
+    virtual Status validate(const int& potentialNewValue) {
+        if (potentialNewValue < 0 || potentialNewValue > (60 * 1000)) {
+            return Status(ErrorCodes::BadValue,
+                          "replBatchApplyTargetMillis must be between 0 and 60000, inclusive");
+        }
+
+        return Status::OK();
+    }
+} exportedBatchApplyTargetMillisParam;
+
 // The oplog entries applied
 Counter64 opsAppliedStats;
 ServerStatusMetricField<Counter64> displayOpsApplied("repl.apply.ops", &opsAppliedStats);
@@ -149,6 +176,66 @@ ServerStatusMetricField<Counter64> displayAttemptsToBecomeSecondary(
 // Number and time of each ApplyOps worker pool round
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
+
+// Number of independent dependency chains the applied batches were split into
+Counter64 applyChainsStats;
+ServerStatusMetricField<Counter64> displayApplyChains("repl.apply.parallelism.chains",
+                                                      &applyChainsStats);
+
+// Number of writer threads which were given work, summed across batches
+Counter64 applyWritersUsedStats;
+ServerStatusMetricField<Counter64> displayApplyWritersUsed("repl.apply.parallelism.writersUsed",
+                                                           &applyWritersUsedStats);
+
+// Current number of operations per batch chosen by adaptive batch sizing
+AtomicInt64 batchOpsLimitGauge;
+
+class BatchOpsLimitMetric final : public ServerStatusMetric {
+public:
+    BatchOpsLimitMetric() : ServerStatusMetric("repl.apply.batchOpsLimit") {}
+
+    void appendAtLeaf(BSONObjBuilder& b) const final {
+        b.append(_leafName, batchOpsLimitGauge.load());
+    }
+} displayBatchOpsLimit;
+
+// Number of chunks of work taken by a writer thread from another writer's queue
+Counter64 applyWriterStealsStats;
+ServerStatusMetricField<Counter64> displayApplyWriterSteals("repl.apply.writers.steals",
+                                                            &applyWriterStealsStats);
+
+// Time writer threads spent without work while a batch was being applied
+Counter64 applyWriterIdleMicrosStats;
+ServerStatusMetricField<Counter64> displayApplyWriterIdleMicros("repl.apply.writers.idleMicros",
+                                                                &applyWriterIdleMicrosStats);
+
+// Number of ops given to the most loaded writer thread, summed across batches. Compared against
+// "repl.apply.ops" this shows how much of each batch was serialized on a single writer.
+Counter64 applyMaxWriterOpsStats;
+ServerStatusMetricField<Counter64> displayApplyMaxWriterOps("repl.apply.parallelism.maxWriterOps",
+                                                            &applyMaxWriterOpsStats);
+
+// Stages of the apply pipeline, see also "repl.pipeline.fetch" and "repl.pipeline.bufferWait".
+
+// Time from the first op of a batch leaving the buffer until the batch was complete
+TimerHistogram batchFormationStats;
+ServerStatusMetricField<TimerHistogram> displayBatchFormation("repl.pipeline.batchFormation",
+                                                              &batchFormationStats);
+
+// Time to write a batch to the local oplog
+TimerHistogram oplogWriteStats;
+ServerStatusMetricField<TimerHistogram> displayOplogWrite("repl.pipeline.oplogWrite",
+                                                          &oplogWriteStats);
+
+// Time each writer thread which was given work spent applying its share of a batch
+TimerHistogram writerApplyStats;
+ServerStatusMetricField<TimerHistogram> displayWriterApply("repl.pipeline.writerApply",
+                                                           &writerApplyStats);
+
+// Time from a batch being applied until it was journaled and reported durable
+TimerHistogram journalWaitStats;
+ServerStatusMetricField<TimerHistogram> displayJournalWait("repl.pipeline.journalWait",
+                                                           &journalWaitStats);
 void initializePrefetchThread() {
     if (!Client::getCurrent()) {
         Client::initThreadIfNotAlready();
@@ -216,6 +303,8 @@ private:
     stdx::condition_variable _cond;
     // The next OpTime to set as the ReplicationCoordinator's lastOpTime after flushing.
     OpTime _latestOpTime;
+    // When the oldest batch not yet flushed was recorded, for the journalWait metric.
+    unsigned long long _pendingSinceMicros = 0;
     // Once this is set to true the _run method will terminate.
     bool _shutdownSignaled = false;
     // Thread that will _run(). Must be initialized last as it depends on the other variables.
@@ -235,6 +324,9 @@ void ApplyBatchFinalizerForJournal::record(const OpTime& newOpTime) {
     _recordApplied(newOpTime);
 
     stdx::unique_lock<stdx::mutex> lock(_mutex);
+    if (_latestOpTime.isNull()) {
+        _pendingSinceMicros = curTimeMicros64();
+    }
     _latestOpTime = newOpTime;
     _cond.notify_all();
 }
@@ -244,6 +336,7 @@ void ApplyBatchFinalizerForJournal::_run() {
 
     while (true) {
         OpTime latestOpTime;
+        unsigned long long pendingSinceMicros;
 
         {
             stdx::unique_lock<stdx::mutex> lock(_mutex);
@@ -256,12 +349,14 @@ void ApplyBatchFinalizerForJournal::_run() {
             }
 
             latestOpTime = _latestOpTime;
+            pendingSinceMicros = _pendingSinceMicros;
             _latestOpTime = OpTime();
         }
 
         auto opCtx = cc().makeOperationContext();
         opCtx->recoveryUnit()->waitUntilDurable();
         _recordDurable(latestOpTime);
+        journalWaitStats.recordMicros(curTimeMicros64() - pendingSinceMicros);
     }
 }
 
@@ -285,10 +380,46 @@ SyncTail::SyncTail(BackgroundSync* q, MultiSyncApplyFunc func)
 SyncTail::SyncTail(BackgroundSync* q,
                    MultiSyncApplyFunc func,
                    std::unique_ptr<OldThreadPool> writerPool)
-    : _networkQueue(q), _applyFunc(func), _writerPool(std::move(writerPool)) {}
+    : _networkQueue(q),
+      _applyFunc(func),
+      _writerPool(std::move(writerPool)),
+      _batchSizeController(replBatchLimitOperations.load()) {}
 
 SyncTail::~SyncTail() {}
 
+SyncTail::BatchSizeController::BatchSizeController(std::size_t initialOpsLimit)
+    : _opsLimit(initialOpsLimit) {}
+
+std::size_t SyncTail::BatchSizeController::getOpsLimit() const {
+    return _opsLimit.load();
+}
+
+void SyncTail::BatchSizeController::recordBatch(std::size_t numOps,
+                                                Microseconds applyTime,
+                                                Milliseconds target,
+                                                std::size_t maxOps) {
+    if (numOps == 0 || target <= Milliseconds(0)) {
+        return;
+    }
+
+    // React to a slowdown right away, but smooth out speedups so that a single cheap batch does
+    // not cause the following batch to overshoot the target.
+    const double kSmoothing = 0.25;
+    const double observedMicrosPerOp =
+        std::max(1.0, static_cast<double>(durationCount<Microseconds>(applyTime))) / numOps;
+    if (_microsPerOp == 0 || observedMicrosPerOp > _microsPerOp) {
+        _microsPerOp = observedMicrosPerOp;
+    } else {
+        _microsPerOp = kSmoothing * observedMicrosPerOp + (1 - kSmoothing) * _microsPerOp;
+    }
+
+    const double targetMicros = durationCount<Microseconds>(target);
+    auto newLimit = static_cast<std::size_t>(targetMicros / _microsPerOp);
+    newLimit = std::min(newLimit, 2 * static_cast<std::size_t>(_opsLimit.load()));
+    newLimit = std::max<std::size_t>(1, std::min(newLimit, maxOps));
+    _opsLimit.store(newLimit);
+}
+
 std::unique_ptr<OldThreadPool> SyncTail::makeWriterPool() {
     return stdx::make_unique<OldThreadPool>(replWriterThreadCount, "repl writer worker ");
 }
@@ -443,21 +574,77 @@ void prefetchOps(const MultiApplier::Operations& ops, OldThreadPool* prefetcherP
     prefetcherPool->join();
 }
 
-// Doles out all the work to the writer pool threads.
-// Does not modify writerVectors, but passes non-const pointers to inner vectors into func.
-void applyOps(std::vector<MultiApplier::OperationPtrs>& writerVectors,
+/**
+ * The work assigned to a single writer thread, split into chunks made of whole dependency chains.
+ * A writer takes chunks from the front of its own queue and, once that runs dry, steals from the
+ * back of another writer's queue, so no writer sits idle at the end of a batch while others still
+ * have work left.
+ */
+struct WriterQueue {
+    stdx::mutex mutex;
+    std::deque<MultiApplier::OperationPtrs> chunks;
+};
+
+// Takes the next chunk for writer 'self', stealing from another writer if its own queue is empty.
+// Returns false once there is no work left anywhere.
+bool takeNextChunk(std::vector<WriterQueue>* writerQueues,
+                   size_t self,
+                   MultiApplier::OperationPtrs* chunk) {
+    {
+        auto& own = (*writerQueues)[self];
+        stdx::lock_guard<stdx::mutex> lk(own.mutex);
+        if (!own.chunks.empty()) {
+            *chunk = std::move(own.chunks.front());
+            own.chunks.pop_front();
+            return true;
+        }
+    }
+
+    const size_t numWriters = writerQueues->size();
+    for (size_t offset = 1; offset < numWriters; ++offset) {
+        auto& victim = (*writerQueues)[(self + offset) % numWriters];
+        stdx::lock_guard<stdx::mutex> lk(victim.mutex);
+        if (!victim.chunks.empty()) {
+            *chunk = std::move(victim.chunks.back());
+            victim.chunks.pop_back();
+            applyWriterStealsStats.increment();
+            return true;
+        }
+    }
+    return false;
+}
+
+// Doles out all the work to the writer pool threads and waits for it to complete.
+// Every writer is started, even one with an empty queue, so that it can steal work from the others.
+void applyOps(std::vector<WriterQueue>* writerQueues,
               OldThreadPool* writerPool,
               const MultiApplier::ApplyOperationFn& func,
               std::vector<Status>* statusVector) {
-    invariant(writerVectors.size() == statusVector->size());
+    invariant(writerQueues->size() == statusVector->size());
     TimerHolder timer(&applyBatchStats);
-    for (size_t i = 0; i < writerVectors.size(); i++) {
-        if (!writerVectors[i].empty()) {
-            writerPool->schedule([&func, &writerVectors, statusVector, i] {
-                (*statusVector)[i] = func(&writerVectors[i]);
-            });
-        }
+    Timer batchTimer;
+    AtomicInt64 busyMicros(0);
+    for (size_t i = 0; i < writerQueues->size(); i++) {
+        writerPool->schedule([&func, writerQueues, statusVector, &busyMicros, i] {
+            Timer busyTimer;
+            auto& status = (*statusVector)[i];
+            MultiApplier::OperationPtrs chunk;
+            bool applied = false;
+            while (status.isOK() && takeNextChunk(writerQueues, i, &chunk)) {
+                status = func(&chunk);
+                applied = true;
+            }
+            const long long micros = busyTimer.micros();
+            busyMicros.fetchAndAdd(micros);
+            if (applied) {
+                writerApplyStats.recordMicros(micros);
+            }
+        });
     }
+    writerPool->join();
+
+    const long long totalMicros = batchTimer.micros() * writerQueues->size();
+    applyWriterIdleMicrosStats.increment(std::max(0LL, totalMicros - busyMicros.load()));
 }
 
 void initializeWriterThread() {
@@ -627,15 +814,26 @@ private:
 
 // This only modifies the isForCappedCollection field on each op. It does not alter the ops vector
 // in any other way.
+//
+// The ops are first grouped into dependency chains: ops in the same chain touch the same document
+// (or, for capped collections and engines without document-level locking, the same collection) and
+// must be applied in order, while ops in different chains are independent of each other. Commands
+// and index builds are always applied in a batch of their own, so they never need to act as
+// barriers here. The chains are then handed out largest first to the least loaded writer, which
+// keeps a few popular documents or collections from piling up on one writer while the others idle.
+// Each writer's chains are packed into chunks which idle writers may steal while applying.
 void fillWriterVectors(OperationContext* opCtx,
                        MultiApplier::Operations* ops,
-                       std::vector<MultiApplier::OperationPtrs>* writerVectors) {
+                       std::vector<WriterQueue>* writerQueues) {
     const bool supportsDocLocking =
         getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking();
-    const uint32_t numWriters = writerVectors->size();
+    const size_t numWriters = writerQueues->size();
 
     CachedCollectionProperties collPropertiesCache;
 
+    std::vector<MultiApplier::OperationPtrs> chains;
+    stdx::unordered_map<uint32_t, size_t> chainIndexByHash;
+
     for (auto&& op : *ops) {
         StringMapTraits::HashedKey hashedNs(op.getNamespace().ns());
         uint32_t hash = hashedNs.hash();
@@ -663,11 +861,65 @@ void fillWriterVectors(OperationContext* opCtx,
             }
         }
 
-        auto& writer = (*writerVectors)[hash % numWriters];
-        if (writer.empty())
-            writer.reserve(8);  // skip a few growth rounds.
-        writer.push_back(&op);
+        // Ops whose hashes collide share a chain. This only costs parallelism, never correctness.
+        auto inserted = chainIndexByHash.emplace(hash, chains.size());
+        if (inserted.second) {
+            chains.emplace_back();
+        }
+        chains[inserted.first->second].push_back(&op);
+    }
+
+    // Sort stably so that the assignment is deterministic for a given batch.
+    std::vector<size_t> chainOrder(chains.size());
+    std::iota(chainOrder.begin(), chainOrder.end(), 0);
+    std::stable_sort(chainOrder.begin(), chainOrder.end(), [&chains](size_t l, size_t r) {
+        return chains[l].size() > chains[r].size();
+    });
+
+    // Min-heap of (number of ops assigned, writer index).
+    using WriterLoad = std::pair<size_t, size_t>;
+    std::priority_queue<WriterLoad, std::vector<WriterLoad>, std::greater<WriterLoad>> writerLoads;
+    for (size_t i = 0; i < numWriters; ++i) {
+        writerLoads.emplace(0, i);
+    }
+
+    std::vector<std::vector<size_t>> chainsByWriter(numWriters);
+    for (auto chainIndex : chainOrder) {
+        auto leastLoaded = writerLoads.top();
+        writerLoads.pop();
+
+        chainsByWriter[leastLoaded.second].push_back(chainIndex);
+        writerLoads.emplace(leastLoaded.first + chains[chainIndex].size(), leastLoaded.second);
+    }
+
+    // Chunks are kept at least as large as the largest group of inserts multiSyncApply() will
+    // build, so that chunking rarely breaks up a bulk insert. This also amortizes the per-call
+    // setup cost of the apply function.
+    const size_t kMinOpsPerChunk = 64;
+
+    size_t writersUsed = 0;
+    size_t maxWriterOps = 0;
+    for (size_t i = 0; i < numWriters; ++i) {
+        auto& chunks = (*writerQueues)[i].chunks;
+        size_t writerOps = 0;
+        for (auto chainIndex : chainsByWriter[i]) {
+            auto& chain = chains[chainIndex];
+            if (chunks.empty() || chunks.back().size() >= kMinOpsPerChunk) {
+                chunks.emplace_back();
+            }
+            auto& chunk = chunks.back();
+            chunk.insert(chunk.end(), chain.begin(), chain.end());
+            writerOps += chain.size();
+        }
+
+        if (writerOps > 0) {
+            ++writersUsed;
+        }
+        maxWriterOps = std::max(maxWriterOps, writerOps);
     }
+    applyChainsStats.increment(chains.size());
+    applyWritersUsedStats.increment(writersUsed);
+    applyMaxWriterOpsStats.increment(maxWriterOps);
 }
 
 }  // namespace
@@ -771,16 +1023,29 @@ private:
 
             // Check this once per batch since users can change it at runtime.
             batchLimits.ops = replBatchLimitOperations.load();
+            if (replBatchApplyTargetMillis.load() > 0) {
+                batchLimits.ops =
+                    std::min(batchLimits.ops, _syncTail->_batchSizeController.getOpsLimit());
+            }
 
             OpQueue ops;
+            // Batch formation is timed from the first op, not from when we started waiting.
+            boost::optional<Timer> formationTimer;
             // tryPopAndWaitForMore adds to ops and returns true when we need to end a batch early.
             while (!_syncTail->tryPopAndWaitForMore(&opCtx, &ops, batchLimits)) {
+                if (!formationTimer && !ops.empty()) {
+                    formationTimer.emplace();
+                }
             }
 
             if (ops.empty() && !ops.mustShutdown()) {
                 continue;  // Don't emit empty batches.
             }
 
+            if (!ops.empty()) {
+                batchFormationStats.recordMicros(formationTimer ? formationTimer->micros() : 0);
+            }
+
             stdx::unique_lock<stdx::mutex> lk(_mutex);
             // Block until the previous batch has been taken.
             _cv.wait(lk, [&] { return _ops.empty(); });
@@ -854,10 +1119,8 @@ void SyncTail::oplogApplication(ReplicationCoordinator* replCoord) {
         }
 
         // Extract some info from ops that we'll need after releasing the batch below.
-        const auto firstOpTimeInBatch =
-            fassertStatusOK(40299, OpTime::parseFromOplogEntry(ops.front().raw));
-        const auto lastOpTimeInBatch =
-            fassertStatusOK(28773, OpTime::parseFromOplogEntry(ops.back().raw));
+        const auto firstOpTimeInBatch = ops.front().getOpTime();
+        const auto lastOpTimeInBatch = ops.back().getOpTime();
 
         // Make sure the oplog doesn't go back in time or repeat an entry.
         if (firstOpTimeInBatch <= replCoord->getMyLastAppliedOpTime()) {
@@ -874,8 +1137,20 @@ void SyncTail::oplogApplication(ReplicationCoordinator* replCoord) {
         stdx::lock_guard<SimpleMutex> fsynclk(filesLockedFsync);
 
         // Do the work.
+        const auto numOpsInBatch = ops.getCount();
+        Timer applyTimer;
         multiApply(&opCtx, ops.releaseBatch());
 
+        const auto applyTargetMillis = replBatchApplyTargetMillis.load();
+        if (applyTargetMillis > 0) {
+            _batchSizeController.recordBatch(numOpsInBatch,
+                                             Microseconds(applyTimer.micros()),
+                                             Milliseconds(applyTargetMillis),
+                                             replBatchLimitOperations.load());
+            const auto opsLimit = _batchSizeController.getOpsLimit();
+            batchOpsLimitGauge.store(static_cast<long long>(opsLimit));
+        }
+
         // Update various things that care about our last applied optime. Tests rely on 2 happening
         // before 3 even though it isn't strictly necessary. The order of 1 doesn't matter.
         setNewTimestamp(opCtx.getServiceContext(), lastOpTimeInBatch.getTimestamp());  // 1
@@ -897,9 +1172,10 @@ bool SyncTail::tryPopAndWaitForMore(OperationContext* opCtx,
                                     SyncTail::OpQueue* ops,
                                     const BatchLimits& limits) {
     {
-        BSONObj op;
+        // The bgsync queue parses entries as they are fetched, so this only has to batch them.
+        boost::optional<OplogEntry> op;
         // Check to see if there are ops waiting in the bgsync queue
-        bool peek_success = peek(opCtx, &op);
+        bool peek_success = _networkQueue->peekParsed(opCtx, &op);
         if (!peek_success) {
             // If we don't have anything in the queue, wait a bit for something to appear.
             if (ops->empty()) {
@@ -918,8 +1194,8 @@ bool SyncTail::tryPopAndWaitForMore(OperationContext* opCtx,
         // If this op would put us over the byte limit don't include it unless the batch is empty.
         // We allow single-op batches to exceed the byte limit so that large ops are able to be
         // processed.
-        if (!ops->empty() && (ops->getBytes() + size_t(op.objsize())) > limits.bytes) {
-            return true;  // Return before wasting time parsing the op.
+        if (!ops->empty() && (ops->getBytes() + size_t(op->raw.objsize())) > limits.bytes) {
+            return true;
         }
 
         // Don't consume the op if we are told to stop.
@@ -928,7 +1204,7 @@ bool SyncTail::tryPopAndWaitForMore(OperationContext* opCtx,
             return true;
         }
 
-        ops->emplace_back(std::move(op));  // Parses the op in-place.
+        ops->emplace_back(std::move(*op));
     }
 
     auto& entry = ops->back();
@@ -1412,24 +1688,25 @@ StatusWith<OpTime> multiApply(OperationContext* opCtx,
     std::vector<Status> statusVector(workerPool->getNumThreads(), Status::OK());
     {
         // We must wait for the all work we've dispatched to complete before leaving this block
-        // because the spawned threads refer to objects on our stack, including writerVectors.
-        std::vector<MultiApplier::OperationPtrs> writerVectors(workerPool->getNumThreads());
+        // because the spawned threads refer to objects on our stack, including writerQueues.
+        std::vector<WriterQueue> writerQueues(workerPool->getNumThreads());
         ON_BLOCK_EXIT([&] { workerPool->join(); });
 
         // Write batch of ops into oplog.
+        Timer oplogWriteTimer;
         consistencyMarkers->setOplogTruncateAfterPoint(opCtx, ops.front().getTimestamp());
         scheduleWritesToOplog(opCtx, workerPool, ops);
-        fillWriterVectors(opCtx, &ops, &writerVectors);
+        fillWriterVectors(opCtx, &ops, &writerQueues);
 
         // Wait for writes to finish before applying ops.
         workerPool->join();
+        oplogWriteStats.record(oplogWriteTimer);
 
         // Reset consistency markers in case the node fails while applying ops.
         consistencyMarkers->setOplogTruncateAfterPoint(opCtx, Timestamp());
         consistencyMarkers->setMinValidToAtLeast(opCtx, ops.back().getOpTime());
 
-        applyOps(writerVectors, workerPool, applyOperation, &statusVector);
-        workerPool->join();
+        applyOps(&writerQueues, workerPool, applyOperation, &statusVector);
 
         // Update the transaction table to point to the latest oplog entries for each session id.
         scheduleTxnTableUpdates(opCtx, workerPool, latestTxnRecords);
@@ -31,12 +31,15 @@
 #include <deque>
 #include <memory>
 
+#include "mongo/base/disallow_copying.h"
 #include "mongo/base/status.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/repl/multiapplier.h"
 #include "mongo/db/repl/oplog_entry.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/util/concurrency/old_thread_pool.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -146,6 +149,11 @@ public:
             _bytes += obj.objsize();
             _batch.emplace_back(std::move(obj));
         }
+        void emplace_back(OplogEntry entry) {
+            invariant(!_mustShutdown);
+            _bytes += entry.raw.objsize();
+            _batch.emplace_back(std::move(entry));
+        }
         void pop_back() {
             _bytes -= back().raw.objsize();
             _batch.pop_back();
@@ -190,6 +198,40 @@ public:
         boost::optional<Date_t> slaveDelayLatestTimestamp = {};
     };
 
+    /**
+     * Feedback controller for the number of operations per batch, used when
+     * "replBatchApplyTargetMillis" is set. After each batch it estimates what a single operation
+     * costs to apply and picks the number of operations which should take about the target time.
+     * The limit at most doubles from one batch to the next, but shrinks as far as needed at once
+     * so that a slow batch is not followed by another one.
+     *
+     * recordBatch() must only be called by the applier thread. getOpsLimit() may be called from
+     * any thread.
+     */
+    class BatchSizeController {
+        MONGO_DISALLOW_COPYING(BatchSizeController);
+
+    public:
+        explicit BatchSizeController(std::size_t initialOpsLimit);
+
+        std::size_t getOpsLimit() const;
+
+        /**
+         * Updates the limit after applying 'numOps' operations in 'applyTime'. The new limit is
+         * kept between 1 and 'maxOps'.
+         */
+        void recordBatch(std::size_t numOps,
+                         Microseconds applyTime,
+                         Milliseconds target,
+                         std::size_t maxOps);
+
+    private:
+        // Smoothed apply cost of a single operation. Zero until the first batch is recorded.
+        double _microsPerOp = 0;
+
+        AtomicUInt64 _opsLimit;
+    };
+
     /**
      * Attempts to pop an OplogEntry off the BGSync queue and add it to ops.
      *
@@ -221,6 +263,9 @@ public:
 
     static AtomicInt32 replBatchLimitOperations;
 
+    // Target time to apply a single batch, in milliseconds. Zero disables adaptive batch sizing.
+    static AtomicInt32 replBatchApplyTargetMillis;
+
 protected:
     static const unsigned int replBatchLimitBytes = 100 * 1024 * 1024;
     static const int replBatchLimitSeconds = 1;
@@ -241,6 +286,9 @@ private:
 
     // persistent pool of worker threads for writing ops to the databases
     std::unique_ptr<OldThreadPool> _writerPool;
+
+    // Picks the number of operations per batch while adaptive batch sizing is enabled.
+    BatchSizeController _batchSizeController;
 };
 
 /**
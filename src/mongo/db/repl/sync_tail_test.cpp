@@ -29,6 +29,7 @@
 #include "mongo/platform/basic.h"
 
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -41,6 +42,7 @@
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/document_validation.h"
 #include "mongo/db/client.h"
+#include "mongo/db/commands/server_status_internal.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop.h"
@@ -63,6 +65,7 @@
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_d_test_fixture.h"
 #include "mongo/db/session_catalog.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/old_thread_pool.h"
@@ -510,6 +513,146 @@ TEST_F(SyncTailTest, MultiApplyAssignsOperationsToWriterThreadsBasedOnNamespaceH
     ASSERT_BSONOBJ_EQ(op2.raw, operationsWrittenToOplog[1].doc);
 }
 
+TEST_F(SyncTailTest, MultiApplyBalancesIndependentOperationsAcrossWriterThreads) {
+    // Three ops on one namespace form a single dependency chain which must stay on one writer in
+    // oplog order. The remaining independent ops should be handed to the other writer rather than
+    // being stacked behind that chain.
+    NamespaceString nss0("test.t0");
+    NamespaceString nss1("test.t1");
+    NamespaceString nss2("test.t2");
+    NamespaceString nss3("test.t3");
+    OldThreadPool writerPool(2);
+
+    stdx::mutex mutex;
+    std::vector<MultiApplier::Operations> operationsApplied;
+    auto applyOperationFn = [&mutex, &operationsApplied](
+        MultiApplier::OperationPtrs* operationsForWriterThreadToApply) -> Status {
+        stdx::lock_guard<stdx::mutex> lock(mutex);
+        operationsApplied.emplace_back();
+        for (auto&& opPtr : *operationsForWriterThreadToApply) {
+            operationsApplied.back().push_back(*opPtr);
+        }
+        return Status::OK();
+    };
+
+    auto op1 = makeInsertDocumentOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss0, BSON("x" << 1));
+    auto op2 = makeInsertDocumentOplogEntry({Timestamp(Seconds(2), 0), 1LL}, nss0, BSON("x" << 2));
+    auto op3 = makeInsertDocumentOplogEntry({Timestamp(Seconds(3), 0), 1LL}, nss0, BSON("x" << 3));
+    auto op4 = makeInsertDocumentOplogEntry({Timestamp(Seconds(4), 0), 1LL}, nss1, BSON("x" << 4));
+    auto op5 = makeInsertDocumentOplogEntry({Timestamp(Seconds(5), 0), 1LL}, nss2, BSON("x" << 5));
+    auto op6 = makeInsertDocumentOplogEntry({Timestamp(Seconds(6), 0), 1LL}, nss3, BSON("x" << 6));
+
+    auto lastOpTime = unittest::assertGet(multiApply(
+        _opCtx.get(), &writerPool, {op1, op2, op3, op4, op5, op6}, applyOperationFn));
+    ASSERT_EQUALS(op6.getOpTime(), lastOpTime);
+
+    stdx::lock_guard<stdx::mutex> lock(mutex);
+    ASSERT_EQUALS(2U, operationsApplied.size());
+    for (auto&& operationsAppliedByThread : operationsApplied) {
+        ASSERT_EQUALS(3U, operationsAppliedByThread.size());
+        if (operationsAppliedByThread.front().getNamespace() == nss0) {
+            ASSERT_EQUALS(op1, operationsAppliedByThread[0]);
+            ASSERT_EQUALS(op2, operationsAppliedByThread[1]);
+            ASSERT_EQUALS(op3, operationsAppliedByThread[2]);
+        } else {
+            for (auto&& oplogEntry : operationsAppliedByThread) {
+                ASSERT_NOT_EQUALS(nss0, oplogEntry.getNamespace());
+            }
+        }
+    }
+}
+
+/**
+ * Returns the "repl.apply.writers.steals" server status metric.
+ */
+long long getWriterSteals() {
+    BSONObjBuilder bob;
+    MetricTree::theMetricTree->appendTo(bob);
+    return bob.obj()["repl"]["apply"]["writers"]["steals"].numberLong();
+}
+
+TEST_F(SyncTailTest, MultiApplyAppliesEachOperationExactlyOnceWhenWritersStealWork) {
+    // One long dependency chain and many short ones on two writers. The long chain is a chunk of
+    // its own at the front of the first writer's queue, followed by a chunk of short chains. The
+    // writer applying the long chain blocks until every short chain has been applied, which can
+    // only happen if the other writer steals the short chains queued behind it.
+    OldThreadPool writerPool(2);
+    const NamespaceString longChainNss("test.long");
+    const size_t longChainLength = 200;
+    const size_t numShortChains = 150;
+    const size_t numShortChainOps = 2 * numShortChains;
+
+    stdx::mutex mutex;
+    stdx::condition_variable shortChainOpApplied;
+    std::map<NamespaceString, std::vector<Timestamp>> timestampsAppliedByChain;
+    size_t shortChainOpsApplied = 0;
+    auto applyOperationFn = [&](MultiApplier::OperationPtrs* operationsForWriterThreadToApply)
+        -> Status {
+        stdx::unique_lock<stdx::mutex> lock(mutex);
+        bool appliesLongChain = false;
+        for (auto&& opPtr : *operationsForWriterThreadToApply) {
+            timestampsAppliedByChain[opPtr->getNamespace()].push_back(opPtr->getTimestamp());
+            if (opPtr->getNamespace() == longChainNss) {
+                appliesLongChain = true;
+            } else {
+                ++shortChainOpsApplied;
+            }
+        }
+        shortChainOpApplied.notify_all();
+        if (appliesLongChain &&
+            !shortChainOpApplied.wait_for(lock, Seconds(30).toSystemDuration(), [&] {
+                return shortChainOpsApplied == numShortChainOps;
+            })) {
+            return {ErrorCodes::ExceededTimeLimit, "short chains were not applied by stealing"};
+        }
+        return Status::OK();
+    };
+
+    // Interleave the chains in the oplog. Each chain is on a single document, so that it stays a
+    // chain whether or not the storage engine supports document-level locking.
+    MultiApplier::Operations ops;
+    auto addOp = [&ops](const NamespaceString& nss) {
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(1), ops.size() + 1), 1LL}, nss, BSON("_id" << 0)));
+    };
+    for (size_t i = 0; i < longChainLength; ++i) {
+        addOp(longChainNss);
+        if (i < numShortChains) {
+            addOp(NamespaceString("test.short" + std::to_string(i)));
+        }
+    }
+    for (size_t i = 0; i < numShortChains; ++i) {
+        addOp(NamespaceString("test.short" + std::to_string(i)));
+    }
+    const auto numOps = ops.size();
+    const auto lastOpTime = ops.back().getOpTime();
+
+    const auto stealsBefore = getWriterSteals();
+    ASSERT_EQUALS(lastOpTime,
+                  unittest::assertGet(
+                      multiApply(_opCtx.get(), &writerPool, std::move(ops), applyOperationFn)));
+    ASSERT_GREATER_THAN(getWriterSteals(), stealsBefore);
+
+    stdx::lock_guard<stdx::mutex> lock(mutex);
+    ASSERT_EQUALS(numShortChains + 1, timestampsAppliedByChain.size());
+    ASSERT_EQUALS(longChainLength, timestampsAppliedByChain[longChainNss].size());
+    std::vector<Timestamp> timestampsApplied;
+    for (auto&& chain : timestampsAppliedByChain) {
+        // Each chain is applied in oplog order.
+        ASSERT_TRUE(std::is_sorted(chain.second.begin(), chain.second.end()))
+            << chain.first.ns();
+        timestampsApplied.insert(
+            timestampsApplied.end(), chain.second.begin(), chain.second.end());
+    }
+
+    // Each op is applied exactly once.
+    ASSERT_EQUALS(numOps, timestampsApplied.size());
+    std::sort(timestampsApplied.begin(), timestampsApplied.end());
+    for (size_t i = 0; i < numOps; ++i) {
+        ASSERT_EQUALS(Timestamp(Seconds(1), i + 1), timestampsApplied[i]);
+    }
+}
+
 TEST_F(SyncTailTest, MultiApplyUpdatesTheTransactionTable) {
     // Set up the transactions collection, which can only be done by the primary.
     ASSERT_OK(ReplicationCoordinator::get(_opCtx.get())->setFollowerMode(MemberState::RS_PRIMARY));
@@ -1063,6 +1206,45 @@ TEST_F(SyncTailTest,
     ASSERT_EQUALS(ErrorCodes::CollectionIsEmpty, iter->next().getStatus());
 }
 
+TEST(SyncTailBatchSizeControllerTest, ShrinksLimitAtOnceWhenBatchIsSlowerThanTarget) {
+    SyncTail::BatchSizeController controller(1000);
+    ASSERT_EQUALS(1000U, controller.getOpsLimit());
+
+    // 1000 ops in 400ms is 400us per op, so a 100ms target fits 250 ops.
+    controller.recordBatch(1000, Milliseconds(400), Milliseconds(100), 5000);
+    ASSERT_EQUALS(250U, controller.getOpsLimit());
+}
+
+TEST(SyncTailBatchSizeControllerTest, GrowsLimitByAtMostAFactorOfTwoPerBatch) {
+    SyncTail::BatchSizeController controller(100);
+
+    // 100 ops in 1ms would allow 10000 ops in 100ms, but growth is capped at doubling.
+    controller.recordBatch(100, Milliseconds(1), Milliseconds(100), 50000);
+    ASSERT_EQUALS(200U, controller.getOpsLimit());
+    controller.recordBatch(200, Milliseconds(2), Milliseconds(100), 50000);
+    ASSERT_EQUALS(400U, controller.getOpsLimit());
+}
+
+TEST(SyncTailBatchSizeControllerTest, KeepsLimitBetweenOneAndMaximum) {
+    SyncTail::BatchSizeController controller(1000);
+
+    // A single op slower than the target still leaves room for one op per batch.
+    controller.recordBatch(1, Seconds(1), Milliseconds(100), 5000);
+    ASSERT_EQUALS(1U, controller.getOpsLimit());
+
+    SyncTail::BatchSizeController fastController(1000);
+    fastController.recordBatch(1000, Milliseconds(1), Milliseconds(100), 1500);
+    ASSERT_EQUALS(1500U, fastController.getOpsLimit());
+}
+
+TEST(SyncTailBatchSizeControllerTest, IgnoresEmptyBatchesAndDisabledTarget) {
+    SyncTail::BatchSizeController controller(1000);
+    controller.recordBatch(0, Milliseconds(400), Milliseconds(100), 5000);
+    ASSERT_EQUALS(1000U, controller.getOpsLimit());
+    controller.recordBatch(1000, Milliseconds(400), Milliseconds(0), 5000);
+    ASSERT_EQUALS(1000U, controller.getOpsLimit());
+}
+
 TEST_F(IdempotencyTest, Geo2dsphereIndexFailedOnUpdate) {
     ASSERT_OK(
         ReplicationCoordinator::get(_opCtx.get())->setFollowerMode(MemberState::RS_RECOVERING));
@@ -30,19 +30,24 @@
 
 #include "mongo/db/s/active_migrations_registry.h"
 
+#include <algorithm>
+
 #include "mongo/base/status_with.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/migration_session_id.h"
 #include "mongo/db/s/migration_source_manager.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/assert_util.h"
 
 namespace mongo {
 
+MONGO_EXPORT_SERVER_PARAMETER(maxConcurrentChunkDonationsPerShard, int, 1);
+
 ActiveMigrationsRegistry::ActiveMigrationsRegistry() = default;
 
 ActiveMigrationsRegistry::~ActiveMigrationsRegistry() {
-    invariant(!_activeMoveChunkState);
+    invariant(_activeMoveChunkStates.empty());
 }
 
 StatusWith<ScopedRegisterDonateChunk> ActiveMigrationsRegistry::registerDonateChunk(
@@ -52,17 +57,29 @@ StatusWith<ScopedRegisterDonateChunk> ActiveMigrationsRegistry::registerDonateCh
         return _activeReceiveChunkState->constructErrorStatus();
     }
 
-    if (_activeMoveChunkState) {
-        if (_activeMoveChunkState->args == args) {
-            return {ScopedRegisterDonateChunk(nullptr, false, _activeMoveChunkState->notification)};
+    for (const auto& activeMoveChunkState : _activeMoveChunkStates) {
+        if (activeMoveChunkState.args == args) {
+            return {ScopedRegisterDonateChunk(nullptr, false, activeMoveChunkState.notification)};
         }
+    }
 
-        return _activeMoveChunkState->constructErrorStatus();
+    // A collection can only have one migration source at a time and a shard can only receive one
+    // chunk at a time.
+    for (const auto& activeMoveChunkState : _activeMoveChunkStates) {
+        if (activeMoveChunkState.args.getNss() == args.getNss() ||
+            activeMoveChunkState.args.getToShardId() == args.getToShardId()) {
+            return activeMoveChunkState.constructErrorStatus();
+        }
     }
 
-    _activeMoveChunkState.emplace(args);
+    const size_t maxDonations = std::max(maxConcurrentChunkDonationsPerShard.load(), 1);
+    if (_activeMoveChunkStates.size() >= maxDonations) {
+        return _activeMoveChunkStates.front().constructErrorStatus();
+    }
+
+    _activeMoveChunkStates.emplace_back(args);
 
-    return {ScopedRegisterDonateChunk(this, true, _activeMoveChunkState->notification)};
+    return {ScopedRegisterDonateChunk(this, true, _activeMoveChunkStates.back().notification)};
 }
 
 StatusWith<ScopedRegisterReceiveChunk> ActiveMigrationsRegistry::registerReceiveChunk(
@@ -72,8 +89,8 @@ StatusWith<ScopedRegisterReceiveChunk> ActiveMigrationsRegistry::registerReceive
         return _activeReceiveChunkState->constructErrorStatus();
     }
 
-    if (_activeMoveChunkState) {
-        return _activeMoveChunkState->constructErrorStatus();
+    if (!_activeMoveChunkStates.empty()) {
+        return _activeMoveChunkStates.front().constructErrorStatus();
     }
 
     _activeReceiveChunkState.emplace(nss, chunkRange, fromShardId);
@@ -83,23 +100,26 @@ StatusWith<ScopedRegisterReceiveChunk> ActiveMigrationsRegistry::registerReceive
 
 boost::optional<NamespaceString> ActiveMigrationsRegistry::getActiveDonateChunkNss() {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
-    if (_activeMoveChunkState) {
-        return _activeMoveChunkState->args.getNss();
+    if (!_activeMoveChunkStates.empty()) {
+        return _activeMoveChunkStates.front().args.getNss();
     }
 
     return boost::none;
 }
 
-BSONObj ActiveMigrationsRegistry::getActiveMigrationStatusReport(OperationContext* opCtx) {
-    boost::optional<NamespaceString> nss;
-    {
-        stdx::lock_guard<stdx::mutex> lk(_mutex);
-
-        if (_activeMoveChunkState) {
-            nss = _activeMoveChunkState->args.getNss();
-        }
+std::vector<NamespaceString> ActiveMigrationsRegistry::getActiveDonateChunkNamespaces() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    std::vector<NamespaceString> namespaces;
+    for (const auto& activeMoveChunkState : _activeMoveChunkStates) {
+        namespaces.push_back(activeMoveChunkState.args.getNss());
     }
 
+    return namespaces;
+}
+
+BSONObj ActiveMigrationsRegistry::getActiveMigrationStatusReport(OperationContext* opCtx) {
+    boost::optional<NamespaceString> nss = getActiveDonateChunkNss();
+
     // The state of the MigrationSourceManager could change between taking and releasing the mutex
     // above and then taking the collection lock here, but that's fine because it isn't important to
     // return information on a migration that just ended or started. This is just best effort and
@@ -117,10 +137,16 @@ BSONObj ActiveMigrationsRegistry::getActiveMigrationStatusReport(OperationContex
     return BSONObj();
 }
 
-void ActiveMigrationsRegistry::_clearDonateChunk() {
+void ActiveMigrationsRegistry::_clearDonateChunk(
+    const std::shared_ptr<Notification<Status>>& notification) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
-    invariant(_activeMoveChunkState);
-    _activeMoveChunkState.reset();
+    auto it = std::find_if(_activeMoveChunkStates.begin(),
+                           _activeMoveChunkStates.end(),
+                           [&](const ActiveMoveChunkState& activeMoveChunkState) {
+                               return activeMoveChunkState.notification == notification;
+                           });
+    invariant(it != _activeMoveChunkStates.end());
+    _activeMoveChunkStates.erase(it);
 }
 
 void ActiveMigrationsRegistry::_clearReceiveChunk() {
@@ -163,7 +189,7 @@ ScopedRegisterDonateChunk::~ScopedRegisterDonateChunk() {
     if (_registry && _forUnregister) {
         // If this is a newly started migration the caller must always signal on completion
         invariant(*_completionNotification);
-        _registry->_clearDonateChunk();
+        _registry->_clearDonateChunk(_completionNotification);
     }
 }
 
@@ -29,9 +29,12 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <list>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/s/migration_session_id.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/move_chunk_request.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
@@ -39,6 +42,9 @@
 
 namespace mongo {
 
+// How many chunks a shard may donate at the same time.
+extern AtomicInt32 maxConcurrentChunkDonationsPerShard;
+
 class OperationContext;
 class ScopedRegisterDonateChunk;
 class ScopedRegisterReceiveChunk;
@@ -46,8 +52,10 @@ template <typename T>
 class StatusWith;
 
 /**
- * Thread-safe object, which keeps track of the active migrations running on a node and limits them
- * to only one per-shard. There is only one instance of this object per shard.
+ * Thread-safe object, which keeps track of the active migrations running on a node. A shard either
+ * receives one chunk or donates up to maxConcurrentChunkDonationsPerShard chunks at a time, each
+ * from a different collection and to a different recipient. There is only one instance of this
+ * object per shard.
  */
 class ActiveMigrationsRegistry {
     MONGO_DISALLOW_COPYING(ActiveMigrationsRegistry);
@@ -57,14 +65,15 @@ public:
     ~ActiveMigrationsRegistry();
 
     /**
-     * If there are no migrations running on this shard, registers an active migration with the
-     * specified arguments and returns a ScopedRegisterDonateChunk, which must be signaled by the
-     * caller before it goes out of scope.
-     *
      * If there is an active migration already running on this shard and it has the exact same
      * arguments, returns a ScopedRegisterDonateChunk, which can be used to join the already running
      * migration.
      *
+     * Otherwise, if this shard is not receiving a chunk, is donating fewer chunks than
+     * maxConcurrentChunkDonationsPerShard, and none of them is from the same collection or to the
+     * same recipient, registers an active migration with the specified arguments and returns a
+     * ScopedRegisterDonateChunk, which must be signaled by the caller before it goes out of scope.
+     *
      * Otherwise returns a ConflictingOperationInProgress error.
      */
     StatusWith<ScopedRegisterDonateChunk> registerDonateChunk(const MoveChunkRequest& args);
@@ -82,13 +91,19 @@ public:
 
     /**
      * If a migration has been previously registered through a call to registerDonateChunk returns
-     * that namespace. Otherwise returns boost::none.
+     * the namespace of the longest running one. Otherwise returns boost::none.
      */
     boost::optional<NamespaceString> getActiveDonateChunkNss();
 
     /**
-     * Returns a report on the active migration if there currently is one. Otherwise, returns an
-     * empty BSONObj.
+     * Returns the namespaces of all the migrations registered through registerDonateChunk, longest
+     * running first.
+     */
+    std::vector<NamespaceString> getActiveDonateChunkNamespaces();
+
+    /**
+     * Returns a report on the longest running active migration if there currently is one.
+     * Otherwise, returns an empty BSONObj.
      *
      * Takes an IS lock on the namespace of the active migration, if one is active.
      */
@@ -136,10 +151,10 @@ private:
     };
 
     /**
-     * Unregisters a previously registered namespace with ongoing migration. Must only be called if
-     * a previous call to registerDonateChunk has succeeded.
+     * Unregisters the previously registered migration, which signals 'notification' on completion.
+     * Must only be called if a previous call to registerDonateChunk has succeeded.
      */
-    void _clearDonateChunk();
+    void _clearDonateChunk(const std::shared_ptr<Notification<Status>>& notification);
 
     /**
      * Unregisters a previously registered incoming migration. Must only be called if a previous
@@ -150,9 +165,8 @@ private:
     // Protects the state below
     stdx::mutex _mutex;
 
-    // If there is an active moveChunk operation going on, this field contains the request, which
-    // initiated it
-    boost::optional<ActiveMoveChunkState> _activeMoveChunkState;
+    // The requests which initiated the active moveChunk operations, longest running first
+    std::list<ActiveMoveChunkState> _activeMoveChunkStates;
 
     // If there is an active receive of a chunk going on, this field contains the session id, which
     // initiated it
@@ -35,6 +35,7 @@
 #include "mongo/db/service_context_noop.h"
 #include "mongo/s/move_chunk_request.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -64,7 +65,8 @@ protected:
     ActiveMigrationsRegistry _registry;
 };
 
-MoveChunkRequest createMoveChunkRequest(const NamespaceString& nss) {
+MoveChunkRequest createMoveChunkRequest(const NamespaceString& nss,
+                                        const ShardId& toShardId = ShardId("shard0002")) {
     const ChunkVersion chunkVersion(1, 2, OID::gen());
 
     BSONObjBuilder builder;
@@ -74,7 +76,7 @@ MoveChunkRequest createMoveChunkRequest(const NamespaceString& nss) {
         chunkVersion,
         assertGet(ConnectionString::parse("TestConfigRS/CS1:12345,CS2:12345,CS3:12345")),
         ShardId("shard0001"),
-        ShardId("shard0002"),
+        toShardId,
         ChunkRange(BSON("Key" << -100), BSON("Key" << 100)),
         1024,
         MigrationSecondaryThrottleOptions::create(MigrationSecondaryThrottleOptions::kOff),
@@ -124,6 +126,64 @@ TEST_F(MoveChunkRegistration, SecondMigrationReturnsConflictingOperationInProgre
     originalScopedRegisterDonateChunk.complete(Status::OK());
 }
 
+TEST_F(MoveChunkRegistration, ConcurrentDonationsOfDifferentCollectionsToDifferentShards) {
+    const int oldMaxDonations = maxConcurrentChunkDonationsPerShard.load();
+    maxConcurrentChunkDonationsPerShard.store(2);
+    ON_BLOCK_EXIT([&] { maxConcurrentChunkDonationsPerShard.store(oldMaxDonations); });
+
+    const NamespaceString nss1("TestDB", "TestColl1");
+    const NamespaceString nss2("TestDB", "TestColl2");
+
+    auto firstScopedRegisterDonateChunk = assertGet(
+        _registry.registerDonateChunk(createMoveChunkRequest(nss1, ShardId("shard0002"))));
+    ASSERT(firstScopedRegisterDonateChunk.mustExecute());
+
+    // Another chunk of the same collection, or a chunk for the same recipient, must wait.
+    ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress,
+              _registry.registerDonateChunk(createMoveChunkRequest(nss1, ShardId("shard0003")))
+                  .getStatus());
+    ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress,
+              _registry.registerDonateChunk(createMoveChunkRequest(nss2, ShardId("shard0002")))
+                  .getStatus());
+
+    auto secondScopedRegisterDonateChunk = assertGet(
+        _registry.registerDonateChunk(createMoveChunkRequest(nss2, ShardId("shard0003"))));
+    ASSERT(secondScopedRegisterDonateChunk.mustExecute());
+
+    auto namespaces = _registry.getActiveDonateChunkNamespaces();
+    ASSERT_EQ(2U, namespaces.size());
+    ASSERT_EQ(nss1, namespaces[0]);
+    ASSERT_EQ(nss2, namespaces[1]);
+
+    // The limit is reached.
+    const NamespaceString nss3("TestDB", "TestColl3");
+    ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress,
+              _registry.registerDonateChunk(createMoveChunkRequest(nss3, ShardId("shard0004")))
+                  .getStatus());
+
+    // A shard which is donating cannot receive.
+    ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress,
+              _registry
+                  .registerReceiveChunk(nss3,
+                                        ChunkRange(BSON("Key" << -100), BSON("Key" << 100)),
+                                        ShardId("shard0004"))
+                  .getStatus());
+
+    // Completing the first donation leaves room for another one.
+    firstScopedRegisterDonateChunk.complete(Status::OK());
+    {
+        auto unregister = std::move(firstScopedRegisterDonateChunk);
+    }
+    ASSERT_EQ(nss2, *_registry.getActiveDonateChunkNss());
+
+    auto thirdScopedRegisterDonateChunk = assertGet(
+        _registry.registerDonateChunk(createMoveChunkRequest(nss1, ShardId("shard0002"))));
+    ASSERT(thirdScopedRegisterDonateChunk.mustExecute());
+
+    secondScopedRegisterDonateChunk.complete(Status::OK());
+    thirdScopedRegisterDonateChunk.complete(Status::OK());
+}
+
 TEST_F(MoveChunkRegistration, SecondMigrationWithSameArgumentsJoinsFirst) {
     auto originalScopedRegisterDonateChunk = assertGet(_registry.registerDonateChunk(
         createMoveChunkRequest(NamespaceString("TestDB", "TestColl"))));
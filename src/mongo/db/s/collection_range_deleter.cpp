@@ -34,6 +34,7 @@
 
 #include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/index_catalog.h"
@@ -53,15 +54,24 @@
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/metadata_manager.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/s/sharding_statistics.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchSize, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterDocsPerWriteUnit, int, 1);
+
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxMajorityWaitMillis, int, 0);
+
 class ChunkRange;
 
 using CallbackArgs = executor::TaskExecutor::CallbackArgs;
@@ -169,6 +179,7 @@ auto CollectionRangeDeleter::cleanUpNextRange(OperationContext* opCtx,
                 // clang-format on
             }
 
+            Timer deletionTimer;
             try {
                 auto keyPattern = scopedCollectionMetadata->getKeyPattern();
 
@@ -181,6 +192,7 @@ auto CollectionRangeDeleter::cleanUpNextRange(OperationContext* opCtx,
                 if (wrote.isOK()) {
                     log() << "No documents remain to delete in " << nss << " range "
                           << redact(range->toString());
+                    ShardingStatistics::get(opCtx).countRangesDeletedByRangeDeleter.addAndFetch(1);
                 }
                 stdx::lock_guard<stdx::mutex> scopedLock(css->_metadataManager->_managerLock);
                 self->_pop(wrote.getStatus());
@@ -190,6 +202,10 @@ auto CollectionRangeDeleter::cleanUpNextRange(OperationContext* opCtx,
                 }
                 return Date_t{};
             }
+
+            auto& stats = ShardingStatistics::get(opCtx);
+            stats.countDocsDeletedByRangeDeleter.addAndFetch(wrote.getValue());
+            stats.rangeDeleterTotalDeleteTimeMillis.addAndFetch(deletionTimer.millis());
         }  // drop scopedCollectionMetadata
     }      // drop autoColl
 
@@ -203,11 +219,15 @@ auto CollectionRangeDeleter::cleanUpNextRange(OperationContext* opCtx,
     // Wait for replication outside the lock
     WriteConcernResult unusedWCResult;
     Status status = Status::OK();
+    Timer majorityWaitTimer;
     try {
         status = waitForWriteConcern(opCtx, clientOpTime, kMajorityWriteConcern, &unusedWCResult);
     } catch (const DBException& e) {
         status = e.toStatus();
     }
+    const Milliseconds majorityWait(majorityWaitTimer.millis());
+    ShardingStatistics::get(opCtx).rangeDeleterTotalMajorityWaitTimeMillis.addAndFetch(
+        durationCount<Milliseconds>(majorityWait));
     if (!status.isOK()) {
         log() << "Error when waiting for write concern after removing " << nss << " range "
               << redact(range->toString()) << " : " << redact(status.reason());
@@ -228,6 +248,18 @@ auto CollectionRangeDeleter::cleanUpNextRange(OperationContext* opCtx,
     } else {
         log() << "Deleted " << wrote.getValue() << " documents in " << nss.ns() << " range "
               << redact(range->toString());
+
+        // If the secondaries took too long to catch up with this batch, give them as much time
+        // again before deleting the next one, so that replication lag does not keep growing.
+        const Milliseconds maxMajorityWait(rangeDeleterMaxMajorityWaitMillis.load());
+        if (maxMajorityWait > Milliseconds(0) && majorityWait > maxMajorityWait) {
+            ShardingStatistics::get(opCtx).countRangeDeleterBatchesThrottled.addAndFetch(1);
+            LOG(1) << "Postponing next deletion batch in " << nss.ns() << " by " << majorityWait
+                   << " because replication of the last batch took longer than "
+                   << maxMajorityWait;
+            notification.abandon();
+            return Date_t::now() + majorityWait;
+        }
     }
 
     notification.abandon();
@@ -279,40 +311,65 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
         saver.emplace("moveChunk", nss.ns(), "cleaning");
     }
 
+    const int docsPerWriteUnit = std::max(rangeDeleterDocsPerWriteUnit.load(), 1);
+
     int numDeleted = 0;
-    do {
+    bool exhausted = false;
+    while (!exhausted && numDeleted < maxToDelete) {
         auto halfOpen = BoundInclusion::kIncludeStartKeyOnly;
         auto manual = PlanExecutor::YIELD_MANUAL;
         auto forward = InternalPlanner::FORWARD;
         auto fetch = InternalPlanner::IXSCAN_FETCH;
 
+        // Position the index cursor once at the start of what is left of the range and collect the
+        // run of records which follows it, so that they can be removed in a single write unit.
         auto exec = InternalPlanner::indexScan(
             opCtx, collection, descriptor, min, max, halfOpen, manual, forward, fetch);
 
-        RecordId rloc;
-        BSONObj obj;
-        PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
-        if (state == PlanExecutor::IS_EOF) {
-            break;
+        std::vector<std::pair<RecordId, BSONObj>> toDelete;
+        const int runLength = std::min(docsPerWriteUnit, maxToDelete - numDeleted);
+        while (int(toDelete.size()) < runLength) {
+            RecordId rloc;
+            BSONObj obj;
+            PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
+            if (state == PlanExecutor::IS_EOF) {
+                exhausted = true;
+                break;
+            }
+            if (state == PlanExecutor::FAILURE || state == PlanExecutor::DEAD) {
+                warning(LogComponent::kSharding)
+                    << PlanExecutor::statestr(state) << " - cursor error while trying to delete "
+                    << min << " to " << max << " in " << nss << ": "
+                    << WorkingSetCommon::toStatusString(obj)
+                    << ", stats: " << Explain::getWinningPlanStats(exec.get());
+                exhausted = true;
+                break;
+            }
+            invariant(PlanExecutor::ADVANCED == state);
+            toDelete.emplace_back(rloc, obj.getOwned());
         }
-        if (state == PlanExecutor::FAILURE || state == PlanExecutor::DEAD) {
-            warning(LogComponent::kSharding)
-                << PlanExecutor::statestr(state) << " - cursor error while trying to delete " << min
-                << " to " << max << " in " << nss << ": " << WorkingSetCommon::toStatusString(obj)
-                << ", stats: " << Explain::getWinningPlanStats(exec.get());
+        exec.reset();
+
+        if (toDelete.empty()) {
             break;
         }
-        invariant(PlanExecutor::ADVANCED == state);
+
+        if (saver) {
+            for (auto const& entry : toDelete) {
+                saver->goingToDelete(entry.second).transitional_ignore();
+            }
+        }
 
         writeConflictRetry(opCtx, "delete range", nss.ns(), [&] {
             WriteUnitOfWork wuow(opCtx);
-            if (saver) {
-                saver->goingToDelete(obj).transitional_ignore();
+            for (auto const& entry : toDelete) {
+                collection->deleteDocument(opCtx, kUninitializedStmtId, entry.first, nullptr, true);
             }
-            collection->deleteDocument(opCtx, kUninitializedStmtId, rloc, nullptr, true);
             wuow.commit();
         });
-    } while (++numDeleted < maxToDelete);
+
+        numDeleted += toDelete.size();
+    }
 
     return numDeleted;
 }
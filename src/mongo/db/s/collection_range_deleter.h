@@ -30,12 +30,24 @@
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/executor/task_executor.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/util/concurrency/notification.h"
 #include "mongo/util/time_support.h"
 
 namespace mongo {
 
+// Maximum number of documents to delete in one pass of the range deleter before waiting for the
+// deletions to replicate. Zero means internalQueryExecYieldIterations.
+extern AtomicInt32 rangeDeleterBatchSize;
+
+// Number of contiguous documents the range deleter removes in a single write unit of work.
+extern AtomicInt32 rangeDeleterDocsPerWriteUnit;
+
+// If waiting for a batch of deletions to replicate to a majority takes longer than this, the range
+// deleter postpones its next batch by the time it waited. Zero disables the throttling.
+extern AtomicInt32 rangeDeleterMaxMajorityWaitMillis;
+
 class BSONObj;
 class Collection;
 class OperationContext;
@@ -43,12 +43,14 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/s/sharding_statistics.h"
 #include "mongo/db/service_context_d_test_fixture.h"
 #include "mongo/s/balancer_configuration.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/sharding_mongod_test_fixture.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -245,6 +247,47 @@ TEST_F(CollectionRangeDeleterTest, MultipleCleanupNextRangeCalls) {
     ASSERT_EQUALS(0ULL, dbclient.count(kAdminSysVer.ns(), BSON(kPattern << "startRangeDeletion")));
 }
 
+// Tests that documents are removed in runs of rangeDeleterDocsPerWriteUnit, that each pass stops at
+// maxToDelete, and that the deletions are reported in the sharding statistics.
+TEST_F(CollectionRangeDeleterTest, MultipleDocumentsPerWriteUnit) {
+    const int oldDocsPerWriteUnit = rangeDeleterDocsPerWriteUnit.load();
+    rangeDeleterDocsPerWriteUnit.store(2);
+    ON_BLOCK_EXIT([&] { rangeDeleterDocsPerWriteUnit.store(oldDocsPerWriteUnit); });
+
+    auto& stats = ShardingStatistics::get(operationContext());
+    const long long docsDeletedBefore = stats.countDocsDeletedByRangeDeleter.load();
+    const long long rangesDeletedBefore = stats.countRangesDeletedByRangeDeleter.load();
+
+    CollectionRangeDeleter rangeDeleter;
+    DBDirectClient dbclient(operationContext());
+    for (int i = 1; i <= 5; ++i) {
+        dbclient.insert(kNss.toString(), BSON(kPattern << i));
+    }
+    dbclient.insert(kNss.toString(), BSON(kPattern << 15));
+    ASSERT_EQUALS(6ULL, dbclient.count(kNss.toString(), BSON(kPattern << LT << 20)));
+
+    std::list<Deletion> ranges;
+    ranges.emplace_back(Deletion{ChunkRange(BSON(kPattern << 0), BSON(kPattern << 10)), Date_t{}});
+    auto when = rangeDeleter.add(std::move(ranges));
+    ASSERT(when && *when == Date_t{});
+
+    ASSERT_TRUE(next(rangeDeleter, 3));
+    ASSERT_EQUALS(2ULL, dbclient.count(kNss.toString(), BSON(kPattern << LT << 10)));
+    ASSERT_EQUALS(docsDeletedBefore + 3, stats.countDocsDeletedByRangeDeleter.load());
+
+    ASSERT_TRUE(next(rangeDeleter, 3));
+    ASSERT_EQUALS(0ULL, dbclient.count(kNss.toString(), BSON(kPattern << LT << 10)));
+    ASSERT_EQUALS(docsDeletedBefore + 5, stats.countDocsDeletedByRangeDeleter.load());
+    ASSERT_EQUALS(rangesDeletedBefore, stats.countRangesDeletedByRangeDeleter.load());
+
+    ASSERT_TRUE(next(rangeDeleter, 3));
+    ASSERT_TRUE(rangeDeleter.isEmpty());
+    ASSERT_EQUALS(rangesDeletedBefore + 1, stats.countRangesDeletedByRangeDeleter.load());
+
+    ASSERT_EQUALS(1ULL, dbclient.count(kNss.toString(), BSON(kPattern << 15)));
+    ASSERT_FALSE(next(rangeDeleter, 3));
+}
+
 // Tests the case that there are two ranges to clean, each containing multiple documents.
 TEST_F(CollectionRangeDeleterTest, MultipleDocumentsInMultipleRangesToClean) {
     CollectionRangeDeleter rangeDeleter;
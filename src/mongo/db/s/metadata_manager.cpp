@@ -401,7 +401,9 @@ void scheduleCleanup(executor::TaskExecutor* executor,
     std::ignore = executor->scheduleWorkAt(
         when, [ executor, nss = std::move(nss), epoch = std::move(epoch) ](auto&) {
             MONGO_FAIL_POINT_PAUSE_WHILE_SET(suspendRangeDeletion);
-            const int maxToDelete = std::max(int(internalQueryExecYieldIterations.load()), 1);
+            const int batchSize = rangeDeleterBatchSize.load();
+            const int maxToDelete = std::max(
+                batchSize > 0 ? batchSize : int(internalQueryExecYieldIterations.load()), 1);
             Client::initThreadIfNotAlready("Collection Range Deleter");
             auto UniqueOpCtx = Client::getCurrent()->makeOperationContext();
             auto opCtx = UniqueOpCtx.get();
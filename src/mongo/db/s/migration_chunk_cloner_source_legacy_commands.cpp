@@ -50,8 +50,8 @@ namespace {
 
 /**
  * Shortcut class to perform the appropriate checks and acquire the cloner associated with the
- * currently active migration. Uses the currently registered migration for this shard and ensures
- * the session ids match.
+ * currently active migration. Uses the migration registered for this shard whose session id
+ * matches, since a shard may be donating several chunks at once.
  */
 class AutoGetActiveCloner {
     MONGO_DISALLOW_COPYING(AutoGetActiveCloner);
@@ -60,32 +60,19 @@ public:
     AutoGetActiveCloner(OperationContext* opCtx, const MigrationSessionId& migrationSessionId) {
         ShardingState* const gss = ShardingState::get(opCtx);
 
-        const auto nss = gss->getActiveDonateChunkNss();
-        uassert(ErrorCodes::NotYetInitialized, "No active migrations were found", nss);
+        const auto namespaces = gss->getActiveDonateChunkNamespaces();
+        uassert(
+            ErrorCodes::NotYetInitialized, "No active migrations were found", !namespaces.empty());
 
-        // Once the collection is locked, the migration status cannot change
-        _autoColl.emplace(opCtx, *nss, MODE_IS);
-
-        uassert(ErrorCodes::NamespaceNotFound,
-                str::stream() << "Collection " << nss->ns() << " does not exist",
-                _autoColl->getCollection());
-
-        auto css = CollectionShardingState::get(opCtx, *nss);
-        uassert(ErrorCodes::IllegalOperation,
-                str::stream() << "No active migrations were found for collection " << nss->ns(),
-                css && css->getMigrationSourceManager());
-
-        // It is now safe to access the cloner
-        _chunkCloner = dynamic_cast<MigrationChunkClonerSourceLegacy*>(
-            css->getMigrationSourceManager()->getCloner());
-        invariant(_chunkCloner);
+        Status status = Status::OK();
+        for (const auto& nss : namespaces) {
+            status = _acquire(opCtx, nss, migrationSessionId);
+            if (status.isOK()) {
+                return;
+            }
+        }
 
-        // Ensure the session ids are correct
-        uassert(ErrorCodes::IllegalOperation,
-                str::stream() << "Requested migration session id " << migrationSessionId.toString()
-                              << " does not match active session id "
-                              << _chunkCloner->getSessionId().toString(),
-                migrationSessionId.matches(_chunkCloner->getSessionId()));
+        uassertStatusOK(status);
     }
 
     Database* getDb() const {
@@ -104,6 +91,45 @@ public:
     }
 
 private:
+    /**
+     * Locks 'nss' and acquires the cloner of its active migration, provided that migration has the
+     * session id 'migrationSessionId'.
+     */
+    Status _acquire(OperationContext* opCtx,
+                    const NamespaceString& nss,
+                    const MigrationSessionId& migrationSessionId) {
+        // Once the collection is locked, the migration status cannot change
+        _autoColl.emplace(opCtx, nss, MODE_IS);
+
+        if (!_autoColl->getCollection()) {
+            return {ErrorCodes::NamespaceNotFound,
+                    str::stream() << "Collection " << nss.ns() << " does not exist"};
+        }
+
+        auto css = CollectionShardingState::get(opCtx, nss);
+        if (!css || !css->getMigrationSourceManager()) {
+            return {ErrorCodes::IllegalOperation,
+                    str::stream() << "No active migrations were found for collection "
+                                  << nss.ns()};
+        }
+
+        // It is now safe to access the cloner
+        _chunkCloner = dynamic_cast<MigrationChunkClonerSourceLegacy*>(
+            css->getMigrationSourceManager()->getCloner());
+        invariant(_chunkCloner);
+
+        // Ensure the session ids are correct
+        if (!migrationSessionId.matches(_chunkCloner->getSessionId())) {
+            return {ErrorCodes::IllegalOperation,
+                    str::stream() << "Requested migration session id "
+                                  << migrationSessionId.toString()
+                                  << " does not match active session id "
+                                  << _chunkCloner->getSessionId().toString()};
+        }
+
+        return Status::OK();
+    }
+
     // Scoped database + collection lock
     boost::optional<AutoGetCollection> _autoColl;
 
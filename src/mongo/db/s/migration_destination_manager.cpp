@@ -59,6 +59,9 @@
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/stdx/chrono.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/concurrency/notification.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -197,6 +200,109 @@ BSONObj createTransferModsRequest(const NamespaceString& nss, const MigrationSes
     return builder.obj();
 }
 
+/**
+ * Fetches the batches of the initial clone from the donor shard on a thread and connection of its
+ * own, so that the next batch is already on its way while the migrate thread inserts the current
+ * one. At most one fetched batch waits to be taken, which bounds the memory used to the size of two
+ * batches. Fetching stops after the donor returns an empty batch or an error.
+ */
+class CloneBatchFetcher {
+    MONGO_DISALLOW_COPYING(CloneBatchFetcher);
+
+public:
+    CloneBatchFetcher(const ConnectionString& fromShardConnString, BSONObj migrateCloneRequest)
+        : _fromShardConnString(fromShardConnString),
+          _migrateCloneRequest(std::move(migrateCloneRequest)),
+          _thread([this] { _run(); }) {}
+
+    ~CloneBatchFetcher() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _shutdown = true;
+        }
+        _condVar.notify_all();
+        _thread.join();
+    }
+
+    /**
+     * Waits for the next batch and returns the donor's response to '_migrateClone', or the error
+     * which prevented getting one.
+     */
+    StatusWith<BSONObj> next(OperationContext* opCtx) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        opCtx->waitForConditionOrInterrupt(_condVar, lk, [&] { return bool(_fetched); });
+
+        auto fetched = std::move(*_fetched);
+        _fetched.reset();
+        _condVar.notify_all();
+        return fetched;
+    }
+
+private:
+    void _run() {
+        boost::optional<ScopedDbConnection> conn;
+        while (true) {
+            StatusWith<BSONObj> fetched{BSONObj()};
+            try {
+                if (!conn) {
+                    conn.emplace(_fromShardConnString);
+                }
+
+                BSONObj res;
+                if (conn->get()->runCommand("admin", _migrateCloneRequest, res)) {
+                    fetched = res.getOwned();
+                } else {
+                    fetched = Status(ErrorCodes::OperationFailed,
+                                     str::stream() << "_migrateClone failed: "
+                                                   << redact(res.toString()));
+                }
+            } catch (const DBException& ex) {
+                fetched = ex.toStatus("_migrateClone failed");
+            }
+
+            const bool isLast = !fetched.isOK() ||
+                fetched.getValue()["objects"].type() != BSONType::Array ||
+                fetched.getValue()["objects"].Obj().isEmpty();
+
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+            _condVar.wait(lk, [&] { return !_fetched || _shutdown; });
+            if (_shutdown) {
+                break;
+            }
+
+            _fetched = std::move(fetched);
+            _condVar.notify_all();
+
+            if (isLast) {
+                break;
+            }
+        }
+
+        // Only a connection which finished all its requests can go back to the pool
+        if (conn) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (!_shutdown) {
+                conn->done();
+            }
+        }
+    }
+
+    const ConnectionString _fromShardConnString;
+    const BSONObj _migrateCloneRequest;
+
+    // Protects the state below
+    stdx::mutex _mutex;
+    stdx::condition_variable _condVar;
+
+    // A fetched batch which has not been taken yet
+    boost::optional<StatusWith<BSONObj>> _fetched;
+
+    // Set when the migrate thread no longer needs any batches
+    bool _shutdown{false};
+
+    stdx::thread _thread;
+};
+
 // Enabling / disabling these fail points pauses / resumes MigrateStatus::_go(), the thread which
 // receives a chunk migration from the donor.
 MONGO_FP_DECLARE(migrateThreadHangAtStep1);
@@ -672,21 +778,21 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
         // 3. Initial bulk clone
         setState(CLONE);
 
-        const BSONObj migrateCloneRequest = createMigrateCloneRequest(_nss, *_sessionId);
-
         _chunkMarkedPending = true;  // no lock needed, only the migrate thread looks.
 
+        // Gets arrays of objects to copy, in disk order, while the previous array is inserted
+        CloneBatchFetcher fetcher(fromShardConnString,
+                                  createMigrateCloneRequest(_nss, *_sessionId));
+
         while (true) {
-            BSONObj res;
-            if (!conn->runCommand("admin",
-                                  migrateCloneRequest,
-                                  res)) {  // gets array of objects to copy, in disk order
-                setStateFail(str::stream() << "_migrateClone failed: " << redact(res.toString()));
+            auto swRes = fetcher.next(opCtx);
+            if (!swRes.isOK()) {
+                setStateFail(swRes.getStatus().reason());
                 conn.done();
                 return;
             }
 
-            BSONObj arr = res["objects"].Obj();
+            BSONObj arr = swRes.getValue()["objects"].Obj();
             int thisTime = 0;
 
             BSONObjIterator i(arr);
@@ -31,6 +31,7 @@
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/s/sharding_statistics.h"
 #include "mongo/db/server_options.h"
 #include "mongo/s/balancer_configuration.h"
 #include "mongo/s/grid.h"
@@ -77,5 +78,27 @@ public:
 
 } shardingServerStatus;
 
+class ShardingStatisticsServerStatus : public ServerStatusSection {
+public:
+    ShardingStatisticsServerStatus() : ServerStatusSection("shardingStatistics") {}
+
+    bool includeByDefault() const final {
+        return true;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx, const BSONElement& configElement) const final {
+        BSONObjBuilder result;
+
+        auto shardingState = ShardingState::get(opCtx);
+        if (shardingState->enabled() &&
+            serverGlobalParams.clusterRole != ClusterRole::ConfigServer) {
+            ShardingStatistics::get(opCtx).report(&result);
+        }
+
+        return result.obj();
+    }
+
+} shardingStatisticsServerStatus;
+
 }  // namespace
 }  // namespace mongo
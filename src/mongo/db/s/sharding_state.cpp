@@ -536,8 +536,8 @@ StatusWith<ScopedRegisterReceiveChunk> ShardingState::registerReceiveChunk(
     return _activeMigrationsRegistry.registerReceiveChunk(nss, chunkRange, fromShardId);
 }
 
-boost::optional<NamespaceString> ShardingState::getActiveDonateChunkNss() {
-    return _activeMigrationsRegistry.getActiveDonateChunkNss();
+std::vector<NamespaceString> ShardingState::getActiveDonateChunkNamespaces() {
+    return _activeMigrationsRegistry.getActiveDonateChunkNamespaces();
 }
 
 BSONObj ShardingState::getActiveMigrationStatusReport(OperationContext* opCtx) {
@@ -234,13 +234,13 @@ public:
                                                                 const ShardId& fromShardId);
 
     /**
-     * If a migration has been previously registered through a call to registerDonateChunk returns
-     * that namespace. Otherwise returns boost::none.
+     * Returns the namespaces of the migrations previously registered through calls to
+     * registerDonateChunk, longest running first.
      *
-     * This method can be called without any locks, but once the namespace is fetched it needs to be
+     * This method can be called without any locks, but once a namespace is fetched it needs to be
      * re-checked after acquiring some intent lock on that namespace.
      */
-    boost::optional<NamespaceString> getActiveDonateChunkNss();
+    std::vector<NamespaceString> getActiveDonateChunkNamespaces();
 
     /**
      * Get a migration status report from the migration registry. If no migration is active, this
@@ -0,0 +1,74 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+class OperationContext;
+class ServiceContext;
+
+/**
+ * Encapsulates per-process statistics for the sharding subsystem, which are reported in the
+ * "shardingStatistics" section of serverStatus.
+ */
+struct ShardingStatistics {
+    // Total number of orphaned documents removed by the collection range deleter.
+    AtomicInt64 countDocsDeletedByRangeDeleter{0};
+
+    // Total number of ranges the collection range deleter finished cleaning up.
+    AtomicInt64 countRangesDeletedByRangeDeleter{0};
+
+    // Total time, in milliseconds, the collection range deleter spent deleting documents, not
+    // counting the time spent waiting for the deletions to replicate.
+    AtomicInt64 rangeDeleterTotalDeleteTimeMillis{0};
+
+    // Total time, in milliseconds, the collection range deleter spent waiting for its deletions to
+    // reach a majority of the replica set.
+    AtomicInt64 rangeDeleterTotalMajorityWaitTimeMillis{0};
+
+    // Number of times the collection range deleter postponed its next batch because replication
+    // was lagging behind it.
+    AtomicInt64 countRangeDeleterBatchesThrottled{0};
+
+    /**
+     * Obtains the per-process instance of the sharding statistics object.
+     */
+    static ShardingStatistics& get(ServiceContext* serviceContext);
+    static ShardingStatistics& get(OperationContext* opCtx);
+
+    /**
+     * Reports the accumulated statistics for serverStatus.
+     */
+    void report(BSONObjBuilder* builder) const;
+};
+
+}  // namespace mongo
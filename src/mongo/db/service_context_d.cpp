@@ -34,6 +34,7 @@
 
 #include "mongo/base/init.h"
 #include "mongo/base/initializer.h"
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/client.h"
 #include "mongo/db/concurrency/lock_state.h"
 #include "mongo/db/service_entry_point_mongod.h"
@@ -272,6 +273,9 @@ std::unique_ptr<OperationContext> ServiceContextMongoD::_newOpCtx(Client* client
         opCtx->setLockState(stdx::make_unique<DefaultLockerImpl>());
     }
 
+    // Lets lock wait tracing report which client and operation hold a lock.
+    opCtx->lockState()->setDebugInfo(BSON("desc" << client->desc() << "opid" << opId));
+
     opCtx->setRecoveryUnit(getGlobalStorageEngine()->newRecoveryUnit(),
                            OperationContext::kNotInUnitOfWork);
     return opCtx;
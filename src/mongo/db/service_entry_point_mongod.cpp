@@ -44,6 +44,7 @@
 #include "mongo/db/curop_metrics.h"
 #include "mongo/db/cursor_manager.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/ftdc/ftdc_server.h"
 #include "mongo/db/initialize_operation_session_info.h"
 #include "mongo/db/introspect.h"
 #include "mongo/db/jsobj.h"
@@ -55,6 +56,7 @@
 #include "mongo/db/ops/write_ops.h"
 #include "mongo/db/ops/write_ops_exec.h"
 #include "mongo/db/query/find.h"
+#include "mongo/db/query/query_stats.h"
 #include "mongo/db/read_concern.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/db/repl/read_concern_args.h"
@@ -67,6 +69,7 @@
 #include "mongo/db/session_catalog.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/stats/top.h"
+#include "mongo/db/traffic_recorder.h"
 #include "mongo/rpc/factory.h"
 #include "mongo/rpc/metadata.h"
 #include "mongo/rpc/metadata/config_server_metadata.h"
@@ -1063,6 +1066,10 @@ DbResponse ServiceEntryPointMongod::handleRequest(OperationContext* opCtx, const
         LastError::get(c).startRequest();
         AuthorizationSession::get(c)->startRequest(opCtx);
 
+        if (c.session()) {
+            TrafficRecorder::get(opCtx->getServiceContext()).observe(c.session()->id(), m);
+        }
+
         // We should not be holding any locks at this point
         invariant(!opCtx->lockState()->isLocked());
     }
@@ -1150,6 +1157,9 @@ DbResponse ServiceEntryPointMongod::handleRequest(OperationContext* opCtx, const
             opCtx,
             durationCount<Microseconds>(currentOp.elapsedTimeExcludingPauses()),
             currentOp.getReadWriteType());
+    QueryStatsStore::get(opCtx->getServiceContext()).recordOp(currentOp);
+    startFTDCBurstIfSlow(opCtx->getServiceContext(),
+                         duration_cast<Milliseconds>(currentOp.elapsedTimeExcludingPauses()));
 
     const bool shouldSample = serverGlobalParams.sampleRate == 1.0
         ? true
@@ -1158,7 +1168,7 @@ DbResponse ServiceEntryPointMongod::handleRequest(OperationContext* opCtx, const
     if (shouldLogOpDebug || (shouldSample && debug.executionTimeMicros > logThresholdMs * 1000LL)) {
         Locker::LockerInfo lockerInfo;
         opCtx->lockState()->getLockerInfo(&lockerInfo);
-        log() << debug.report(&c, currentOp, lockerInfo.stats);
+        log() << debug.report(&c, currentOp, lockerInfo);
     }
 
     if (currentOp.shouldDBProfile(shouldSample)) {
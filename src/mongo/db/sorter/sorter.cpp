@@ -62,6 +62,7 @@
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
 #include "mongo/util/destructor_guard.h"
+#include "mongo/util/memory_accounting.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/unowned_ptr.h"
 
@@ -102,6 +103,105 @@ void dassertCompIsSane(const Comparator& comp, const Data& lhs, const Data& rhs)
 #endif
 }
 
+/**
+ * Prefix-compressed keys in spill files.
+ *
+ * With SortOptions::prefixCompressKeys, each serialized key in a spill file block is stored
+ * relative to the previous key in the same block as
+ *
+ *     <lead> <gap> <gap bytes> <mid> <tail> <tail bytes>
+ *
+ * where every count is a varint. The key is the first 'lead' bytes of the previous key, followed by
+ * the 'gap' bytes, then 'mid' more bytes of the previous key taken from the same offset, then the
+ * 'tail' bytes. The gap lets the shared run continue past a few differing bytes near the start of
+ * a key, such as the length header of a BSONObj. Blocks start over with an empty previous key so
+ * each one can be decoded on its own.
+ */
+const size_t kMaxPrefixGapOffset = 16;
+const size_t kMaxPrefixGapBytes = 4;
+const size_t kMinPrefixRunAfterGap = 4;
+
+/**
+ * Brings a sorter's charge against the sorter memory account up to date with 'memUsed', once they
+ * differ by enough to matter. Updating it on every add would put a shared atomic on the hot path.
+ */
+inline void updateMemoryCharge(MemoryCharge* charge, size_t memUsed) {
+    const long long kGranularity = 64 * 1024;
+    const long long diff = static_cast<long long>(memUsed) - charge->bytes();
+    if (diff >= kGranularity || diff <= -kGranularity) {
+        charge->set(memUsed);
+    }
+}
+
+inline void appendVarUInt(BufBuilder& buf, size_t value) {
+    while (value >= 0x80) {
+        buf.appendUChar(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    buf.appendUChar(static_cast<unsigned char>(value));
+}
+
+inline size_t readVarUInt(BufReader& reader) {
+    size_t value = 0;
+    for (int shift = 0;; shift += 7) {
+        massert(40643, "corrupt prefix-compressed key in sort file", shift < 64);
+        const unsigned char byte = reader.read<unsigned char>();
+        value |= static_cast<size_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+}
+
+inline size_t commonPrefixLength(StringData lhs, StringData rhs, size_t offset) {
+    const size_t end = std::min(lhs.size(), rhs.size());
+    size_t i = offset;
+    while (i < end && lhs[i] == rhs[i])
+        i++;
+    return i - offset;
+}
+
+inline void appendPrefixCompressedKey(BufBuilder& buf, StringData prevKey, StringData key) {
+    const size_t lead = commonPrefixLength(prevKey, key, 0);
+    size_t gap = 0;
+    size_t mid = 0;
+    if (lead < kMaxPrefixGapOffset) {
+        for (size_t i = 1; i <= kMaxPrefixGapBytes; i++) {
+            const size_t run = commonPrefixLength(prevKey, key, lead + i);
+            if (run >= kMinPrefixRunAfterGap) {
+                gap = i;
+                mid = run;
+                break;
+            }
+        }
+    }
+
+    const size_t tailStart = std::min(lead + gap + mid, key.size());
+    appendVarUInt(buf, lead);
+    appendVarUInt(buf, gap);
+    buf.appendBuf(key.rawData() + lead, gap);
+    appendVarUInt(buf, mid);
+    appendVarUInt(buf, key.size() - tailStart);
+    buf.appendBuf(key.rawData() + tailStart, key.size() - tailStart);
+}
+
+/** Decodes a key written by appendPrefixCompressedKey() into 'key'. */
+inline void readPrefixCompressedKey(BufReader& reader, StringData prevKey, std::string* key) {
+    const size_t lead = readVarUInt(reader);
+    const size_t gap = readVarUInt(reader);
+    massert(40644, "corrupt prefix-compressed key in sort file", lead <= prevKey.size());
+    key->assign(prevKey.rawData(), lead);
+    key->append(static_cast<const char*>(reader.skip(gap)), gap);
+
+    const size_t mid = readVarUInt(reader);
+    massert(40645,
+            "corrupt prefix-compressed key in sort file",
+            mid == 0 || lead + gap + mid <= prevKey.size());
+    key->append(prevKey.rawData() + lead + gap, mid);
+
+    const size_t tail = readVarUInt(reader);
+    key->append(static_cast<const char*>(reader.skip(tail)), tail);
+}
+
 /** Ensures a named file is deleted when this object goes out of scope */
 class FileDeleter {
 public:
@@ -154,8 +254,10 @@ public:
 
     FileIterator(const std::string& fileName,
                  const Settings& settings,
-                 std::shared_ptr<FileDeleter> fileDeleter)
+                 std::shared_ptr<FileDeleter> fileDeleter,
+                 bool prefixCompressedKeys = false)
         : _settings(settings),
+          _prefixCompressedKeys(prefixCompressedKeys),
           _done(false),
           _fileName(fileName),
           _fileDeleter(fileDeleter),
@@ -180,6 +282,17 @@ public:
         verify(!_done);
         fillIfNeeded();
 
+        if (_prefixCompressedKeys) {
+            // Decode into the spare string so the previous key stays intact while it is read
+            // from. The returned key is unowned and remains valid until the next call.
+            readPrefixCompressedKey(*_reader, _prevKey, &_key);
+            _key.swap(_prevKey);
+            BufReader keyReader(_prevKey.data(), _prevKey.size());
+            auto first = Key::deserializeForSorter(keyReader, _settings.first);
+            auto second = Value::deserializeForSorter(*_reader, _settings.second);
+            return Data(std::move(first), std::move(second));
+        }
+
         // Note: key must be read before value so can't pass directly to Data constructor
         auto first = Key::deserializeForSorter(*_reader, _settings.first);
         auto second = Value::deserializeForSorter(*_reader, _settings.second);
@@ -200,6 +313,9 @@ private:
         if (_done)
             return;
 
+        // Prefix-compressed keys only refer to earlier keys in the same block.
+        _prevKey.clear();
+
         // negative size means compressed
         const bool compressed = rawSize < 0;
         int32_t blockSize = std::abs(rawSize);
@@ -264,9 +380,12 @@ private:
     }
 
     const Settings _settings;
+    const bool _prefixCompressedKeys;
     bool _done;
     std::unique_ptr<char[]> _buffer;
     std::unique_ptr<BufReader> _reader;
+    std::string _key;      // Only used with prefix-compressed keys.
+    std::string _prevKey;  // Backs the most recently returned key when prefix-compressed.
     std::string _fileName;
     std::shared_ptr<FileDeleter> _fileDeleter;  // Must outlive _file
     std::ifstream _file;
@@ -417,6 +536,7 @@ public:
 
         _memUsed += key.memUsageForSorter();
         _memUsed += val.memUsageForSorter();
+        updateMemoryCharge(&_memCharge, _memUsed);
 
         if (_memUsed > _opts.maxMemoryUsageBytes)
             spill();
@@ -489,12 +609,14 @@ private:
         _iters.push_back(std::shared_ptr<Iterator>(writer.done()));
 
         _memUsed = 0;
+        _memCharge.set(0);
     }
 
     const Comparator _comp;
     const Settings _settings;
     SortOptions _opts;
     size_t _memUsed;
+    MemoryCharge _memCharge{MemoryAccountTag::kSorter};
     std::deque<Data> _data;                         // the "current" data
     std::vector<std::shared_ptr<Iterator>> _iters;  // data that has already been spilled
 };
@@ -591,6 +713,8 @@ public:
             _memUsed += key.memUsageForSorter();
             _memUsed += val.memUsageForSorter();
 
+            updateMemoryCharge(&_memCharge, _memUsed);
+
             if (_data.size() == _opts.limit)
                 std::make_heap(_data.begin(), _data.end(), less);
 
@@ -616,6 +740,7 @@ public:
         std::pop_heap(_data.begin(), _data.end(), less);
         _data.back() = contender;
         std::push_heap(_data.begin(), _data.end(), less);
+        updateMemoryCharge(&_memCharge, _memUsed);
 
         if (_memUsed > _opts.maxMemoryUsageBytes)
             spill();
@@ -774,12 +899,14 @@ private:
         _iters.push_back(std::shared_ptr<Iterator>(writer.done()));
 
         _memUsed = 0;
+        _memCharge.set(0);
     }
 
     const Comparator _comp;
     const Settings _settings;
     SortOptions _opts;
     size_t _memUsed;
+    MemoryCharge _memCharge{MemoryAccountTag::kSorter};
     std::vector<Data> _data;  // the "current" data. Organized as max-heap if size == limit.
     std::vector<std::shared_ptr<Iterator>> _iters;  // data that has already been spilled
 
@@ -806,7 +933,7 @@ inline unsigned nextFileNumber() {
 
 template <typename Key, typename Value>
 SortedFileWriter<Key, Value>::SortedFileWriter(const SortOptions& opts, const Settings& settings)
-    : _settings(settings) {
+    : _settings(settings), _prefixCompressKeys(opts.prefixCompressKeys) {
     namespace str = mongoutils::str;
 
     // This should be checked by consumers, but if we get here don't allow writes.
@@ -839,7 +966,15 @@ SortedFileWriter<Key, Value>::SortedFileWriter(const SortOptions& opts, const Se
 
 template <typename Key, typename Value>
 void SortedFileWriter<Key, Value>::addAlreadySorted(const Key& key, const Value& val) {
-    key.serializeForSorter(_buffer);
+    if (_prefixCompressKeys) {
+        _keyBuffer.reset();
+        key.serializeForSorter(_keyBuffer);
+        const StringData serializedKey(_keyBuffer.buf(), _keyBuffer.len());
+        sorter::appendPrefixCompressedKey(_buffer, _prevKey, serializedKey);
+        _prevKey.assign(serializedKey.rawData(), serializedKey.size());
+    } else {
+        key.serializeForSorter(_buffer);
+    }
     val.serializeForSorter(_buffer);
 
     if (_buffer.len() > 64 * 1024)
@@ -897,13 +1032,15 @@ void SortedFileWriter<Key, Value>::spill() {
     }
 
     _buffer.reset();
+    _prevKey.clear();
 }
 
 template <typename Key, typename Value>
 SortIteratorInterface<Key, Value>* SortedFileWriter<Key, Value>::done() {
     spill();
     _file.close();
-    return new sorter::FileIterator<Key, Value>(_fileName, _settings, _fileDeleter);
+    return new sorter::FileIterator<Key, Value>(
+        _fileName, _settings, _fileDeleter, _prefixCompressKeys);
 }
 
 //
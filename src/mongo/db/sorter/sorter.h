@@ -98,8 +98,14 @@ struct SortOptions {
     bool extSortAllowed;         /// If false, uassert if more mem needed than allowed.
     std::string tempDir;         /// Directory to directly place files in.
                                  /// Must be explicitly set if extSortAllowed is true.
+    bool prefixCompressKeys;     /// If true, spill files omit the bytes each serialized key
+                                 /// shares with the key before it.
 
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    SortOptions()
+        : limit(0),
+          maxMemoryUsageBytes(64 * 1024 * 1024),
+          extSortAllowed(false),
+          prefixCompressKeys(false) {}
 
     /// Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -122,6 +128,11 @@ struct SortOptions {
         tempDir = newTempDir;
         return *this;
     }
+
+    SortOptions& PrefixCompressKeys(bool newPrefixCompressKeys = true) {
+        prefixCompressKeys = newPrefixCompressKeys;
+        return *this;
+    }
 };
 
 /// This is the output from the sorting framework
@@ -200,10 +211,15 @@ private:
     void spill();
 
     const Settings _settings;
+    const bool _prefixCompressKeys;
     std::string _fileName;
     std::shared_ptr<sorter::FileDeleter> _fileDeleter;  // Must outlive _file
     std::ofstream _file;
     BufBuilder _buffer;
+
+    // Only used with SortOptions::prefixCompressKeys.
+    BufBuilder _keyBuffer;
+    std::string _prevKey;  // Previous serialized key in the current block.
 };
 }
 
@@ -0,0 +1,119 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/sorter/sorter.h"
+
+#include <vector>
+
+#include "mongo/base/data_type_endian.h"
+#include "mongo/platform/random.h"
+#include "mongo/unittest/benchmark.h"
+
+// Need access to internal classes
+#include "mongo/db/sorter/sorter.cpp"
+
+namespace mongo {
+namespace {
+
+class IntWrapper {
+public:
+    IntWrapper(int i = 0) : _i(i) {}
+    operator const int&() const {
+        return _i;
+    }
+
+    /// members for Sorter
+    struct SorterDeserializeSettings {};  // unused
+    void serializeForSorter(BufBuilder& buf) const {
+        buf.appendNum(_i);
+    }
+    static IntWrapper deserializeForSorter(BufReader& buf, const SorterDeserializeSettings&) {
+        return buf.read<LittleEndian<int>>().value;
+    }
+    int memUsageForSorter() const {
+        return sizeof(IntWrapper);
+    }
+    IntWrapper getOwned() const {
+        return *this;
+    }
+
+private:
+    int _i;
+};
+
+using IWSorter = Sorter<IntWrapper, IntWrapper>;
+
+struct IWComparator {
+    int operator()(const IWSorter::Data& lhs, const IWSorter::Data& rhs) const {
+        const int l = lhs.first;
+        const int r = rhs.first;
+        return l < r ? -1 : l > r ? 1 : 0;
+    }
+};
+
+/**
+ * Sorts state.arg() pseudo-random integers in memory, optionally keeping only the first 100.
+ */
+void runSort(benchmark::State& state, unsigned long long limit) {
+    PseudoRandom random(int64_t{1});
+    std::vector<int> input;
+    for (int64_t i = 0; i < state.arg(); ++i) {
+        input.push_back(random.nextInt32());
+    }
+
+    for (auto _ : state) {
+        std::unique_ptr<IWSorter> sorter(
+            IWSorter::make(SortOptions().Limit(limit), IWComparator()));
+        for (auto value : input) {
+            sorter->add(value, value);
+        }
+
+        std::unique_ptr<IWSorter::Iterator> it(sorter->done());
+        int last = 0;
+        while (it->more()) {
+            last = it->next().first;
+        }
+        benchmark::doNotOptimizeAway(last);
+    }
+    state.setItemsProcessed(state.iterations() * state.arg());
+}
+
+void BM_sortInMemory(benchmark::State& state) {
+    runSort(state, 0);
+}
+BENCHMARK(BM_sortInMemory)->arg(1000)->arg(100000);
+
+void BM_sortInMemoryTopK(benchmark::State& state) {
+    runSort(state, 100);
+}
+BENCHMARK(BM_sortInMemoryTopK)->arg(1000)->arg(100000);
+
+}  // namespace
+}  // namespace mongo
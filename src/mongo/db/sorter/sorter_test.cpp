@@ -272,10 +272,55 @@ public:
                                         make_shared<IntIterator>(0, 10 * 1000 * 1000));
         }
 
+        {  // prefix-compressed keys, spanning several blocks
+            SortedFileWriter<IntWrapper, IntWrapper> sorter(SortOptions(opts).PrefixCompressKeys());
+            for (int i = 0; i < 100 * 1000; i++)
+                sorter.addAlreadySorted(i, -i);
+
+            ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter.done()),
+                                        make_shared<IntIterator>(0, 100 * 1000));
+        }
+
         ASSERT(boost::filesystem::is_empty(tempDir.path()));
     }
 };
 
+class PrefixCompressedKeyTests {
+public:
+    void run() {
+        // Shared prefix, shared run after a differing length header, disjoint and repeated keys.
+        const std::vector<std::string> keys = {"",
+                                               "abc",
+                                               "abcdef",
+                                               std::string("\x10\x00\x00\x00keyprefix-1", 15),
+                                               std::string("\x11\x00\x00\x00keyprefix-10", 16),
+                                               std::string("\x11\x00\x00\x00keyprefix-10", 16),
+                                               "zzz",
+                                               ""};
+
+        BufBuilder buf;
+        std::string prevKey;
+        for (auto&& key : keys) {
+            appendPrefixCompressedKey(buf, prevKey, key);
+            prevKey = key;
+        }
+
+        BufReader reader(buf.buf(), buf.len());
+        std::string decoded;
+        prevKey.clear();
+        for (auto&& key : keys) {
+            readPrefixCompressedKey(reader, prevKey, &decoded);
+            ASSERT_EQ(decoded, key);
+            prevKey = decoded;
+        }
+        ASSERT(reader.atEof());
+
+        // The shared run after the length header is elided rather than written out again.
+        BufBuilder gapBuf;
+        appendPrefixCompressedKey(gapBuf, keys[3], keys[4]);
+        ASSERT_LT(gapBuf.len(), 10);
+    }
+};
 
 class MergeIteratorTests {
 public:
@@ -550,6 +595,7 @@ public:
     void setupTests() {
         add<InMemIterTests>();
         add<SortedFileWriterAndFileIteratorTests>();
+        add<PrefixCompressedKeyTests>();
         add<MergeIteratorTests>();
         add<SorterTests::Basic>();
         add<SorterTests::Limit>();
@@ -68,12 +68,25 @@ void fillLockerInfo(const Locker::LockerInfo& lockerInfo, BSONObjBuilder& infoBu
     // "waitingForLock" section
     infoBuilder.append("waitingForLock", lockerInfo.waitingResource.isValid());
 
+    // Only present once a lock wait has been traced, see lockWaitTraceThresholdMillis
+    if (!lockerInfo.blockingHolders.empty()) {
+        BSONArrayBuilder holders(infoBuilder.subarrayStart("waitingForLockHolders"));
+        for (const auto& holder : lockerInfo.blockingHolders) {
+            holders.append(holder.toBSON());
+        }
+    }
+
     // "lockStats" section
     {
         BSONObjBuilder lockStats(infoBuilder.subobjStart("lockStats"));
         lockerInfo.stats.report(&lockStats);
         lockStats.done();
     }
+
+    if (lockerInfo.ticketWaitTime > Microseconds{0}) {
+        infoBuilder.append("ticketWaitMicros",
+                           durationCount<Microseconds>(lockerInfo.ticketWaitTime));
+    }
 }
 
 }  // namespace mongo
@@ -31,6 +31,8 @@
 #include "mongo/db/stats/operation_latency_histogram.h"
 
 #include <algorithm>
+#include <array>
+#include <cmath>
 
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/namespace_string.h"
@@ -38,79 +40,80 @@
 
 namespace mongo {
 
-const std::array<uint64_t, OperationLatencyHistogram::kMaxBuckets>
-    OperationLatencyHistogram::kLowerBounds = {0,
-                                               2,
-                                               4,
-                                               8,
-                                               16,
-                                               32,
-                                               64,
-                                               128,
-                                               256,
-                                               512,
-                                               1024,
-                                               2048,
-                                               3072,
-                                               4096,
-                                               6144,
-                                               8192,
-                                               12288,
-                                               16384,
-                                               24576,
-                                               32768,
-                                               49152,
-                                               65536,
-                                               98304,
-                                               131072,
-                                               196608,
-                                               262144,
-                                               393216,
-                                               524288,
-                                               786432,
-                                               1048576,
-                                               1572864,
-                                               2097152,
-                                               4194304,
-                                               8388608,
-                                               16777216,
-                                               33554432,
-                                               67108864,
-                                               134217728,
-                                               268435456,
-                                               536870912,
-                                               1073741824,
-                                               2147483648,
-                                               4294967296,
-                                               8589934592,
-                                               17179869184,
-                                               34359738368,
-                                               68719476736,
-                                               137438953472,
-                                               274877906944,
-                                               549755813888,
-                                               1099511627776};
+namespace {
+
+// Percentiles reported alongside each histogram, with the field name they are reported under.
+const struct {
+    const char* name;
+    double fraction;
+} kPercentiles[] = {{"p50", 0.5}, {"p99", 0.99}, {"p999", 0.999}};
+
+}  // namespace
+
+OperationLatencyHistogram::HistogramData::~HistogramData() {
+    delete[] buckets.load();
+}
+
+OperationLatencyHistogram::~OperationLatencyHistogram() = default;
+
+uint64_t OperationLatencyHistogram::getBucketLowerBound(int bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+
+    const int exponent = bucket / kSubBuckets - 1 + kSubBucketBits;
+    const uint64_t mantissa = bucket % kSubBuckets + kSubBuckets;
+    return mantissa << (exponent - kSubBucketBits);
+}
 
 void OperationLatencyHistogram::_append(const HistogramData& data,
                                         const char* key,
                                         bool includeHistograms,
                                         BSONObjBuilder* builder) const {
+    // Take a snapshot of the counts first so that the totals and percentiles agree with each
+    // other even while increments are happening.
+    std::array<uint64_t, kMaxBuckets> counts{};
+    uint64_t entryCount = 0;
+    if (const AtomicUInt64* buckets = data.buckets.load()) {
+        for (int i = 0; i < kMaxBuckets; i++) {
+            counts[i] = buckets[i].loadRelaxed();
+            entryCount += counts[i];
+        }
+    }
 
     BSONObjBuilder histogramBuilder(builder->subobjStart(key));
     if (includeHistograms) {
         BSONArrayBuilder arrayBuilder(histogramBuilder.subarrayStart("histogram"));
         for (int i = 0; i < kMaxBuckets; i++) {
-            if (data.buckets[i] == 0)
+            if (counts[i] == 0)
                 continue;
             BSONObjBuilder entryBuilder(arrayBuilder.subobjStart());
-            entryBuilder.append("micros", static_cast<long long>(kLowerBounds[i]));
-            entryBuilder.append("count", static_cast<long long>(data.buckets[i]));
+            entryBuilder.append("micros", static_cast<long long>(getBucketLowerBound(i)));
+            entryBuilder.append("count", static_cast<long long>(counts[i]));
             entryBuilder.doneFast();
         }
         arrayBuilder.doneFast();
     }
-    histogramBuilder.append("latency", static_cast<long long>(data.sum));
-    histogramBuilder.append("ops", static_cast<long long>(data.entryCount));
+    histogramBuilder.append("latency", static_cast<long long>(data.sum.loadRelaxed()));
+    histogramBuilder.append("ops", static_cast<long long>(entryCount));
+
+    if (entryCount > 0) {
+        // Each percentile is reported as the midpoint of the bucket it falls into.
+        int bucket = 0;
+        uint64_t seen = counts[0];
+        for (const auto& percentile : kPercentiles) {
+            const uint64_t rank = std::max<uint64_t>(
+                1, static_cast<uint64_t>(std::ceil(percentile.fraction * entryCount)));
+            while (seen < rank) {
+                seen += counts[++bucket];
+            }
+            const uint64_t lower = getBucketLowerBound(bucket);
+            const uint64_t upper =
+                bucket + 1 < kMaxBuckets ? getBucketLowerBound(bucket + 1) : lower + 1;
+            histogramBuilder.append(percentile.name,
+                                    static_cast<long long>(lower + (upper - lower - 1) / 2));
+        }
+    }
     histogramBuilder.doneFast();
 }
 
@@ -120,37 +123,33 @@ void OperationLatencyHistogram::append(bool includeHistograms, BSONObjBuilder* b
     _append(_commands, "commands", includeHistograms, builder);
 }
 
-// Computes the log base 2 of value, and checks for cases of split buckets.
 int OperationLatencyHistogram::_getBucket(uint64_t value) {
-    // Zero is a special case since log(0) is undefined.
-    if (value == 0) {
-        return 0;
+    if (value < static_cast<uint64_t>(kSubBuckets)) {
+        return static_cast<int>(value);
     }
 
-    int log2 = 63 - countLeadingZeros64(value);
-    // Half splits occur in range [2^11, 2^21) giving 10 extra buckets.
-    if (log2 < 11) {
-        return log2;
-    } else if (log2 < 21) {
-        int extra = log2 - 11;
-        // Split value boundary is at (2^n + 2^(n+1))/2 = 2^n + 2^(n-1).
-        // Which corresponds to (1ULL << log2) | (1ULL << (log2 - 1))
-        // Which is equivalent to the following:
-        uint64_t splitBoundary = 3ULL << (log2 - 1);
-        if (value >= splitBoundary) {
-            extra++;
-        }
-        return log2 + extra;
-    } else {
-        // Add all of the extra 10 buckets.
-        return std::min(log2 + 10, kMaxBuckets - 1);
+    const int log2 = 63 - countLeadingZeros64(value);
+    if (log2 > kMaxExponent) {
+        return kMaxBuckets - 1;
     }
+
+    // The kSubBucketBits bits below the leading one select the bucket within its power of two.
+    const int mantissa = static_cast<int>(value >> (log2 - kSubBucketBits));
+    return (log2 - kSubBucketBits) * kSubBuckets + mantissa;
 }
 
 void OperationLatencyHistogram::_incrementData(uint64_t latency, int bucket, HistogramData* data) {
-    data->buckets[bucket]++;
-    data->entryCount++;
-    data->sum += latency;
+    AtomicUInt64* buckets = data->buckets.load();
+    if (MONGO_unlikely(!buckets)) {
+        std::unique_ptr<AtomicUInt64[]> allocated(new AtomicUInt64[kMaxBuckets]);
+        if (data->buckets.compare_exchange_strong(buckets, allocated.get())) {
+            buckets = allocated.release();
+        }
+        // On failure 'buckets' now holds the array another thread installed first.
+    }
+
+    buckets[bucket].fetchAndAdd(1);
+    data->sum.fetchAndAdd(latency);
 }
 
 void OperationLatencyHistogram::increment(uint64_t latency, Command::ReadWriteType type) {
@@ -27,9 +27,12 @@
  */
 #pragma once
 
-#include <array>
+#include <atomic>
+#include <memory>
 
+#include "mongo/base/disallow_copying.h"
 #include "mongo/db/commands.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
@@ -38,14 +41,31 @@ class BSONObjBuilder;
 /**
  * Stores statistics for latencies of read, write, and command operations.
  *
- * Note: This class is not thread-safe.
+ * Latencies below kSubBuckets microseconds are counted exactly. Above that, each power of two is
+ * split into kSubBuckets equal buckets, so a bucket is never wider than 1/kSubBuckets of its lower
+ * bound and percentiles read back from the histogram are within about 2% of the true value.
+ *
+ * Increments are lock-free and may happen concurrently with each other and with append(). The
+ * counts of a type are only allocated once an operation of that type is recorded.
  */
 class OperationLatencyHistogram {
+    MONGO_DISALLOW_COPYING(OperationLatencyHistogram);
+
 public:
-    static const int kMaxBuckets = 51;
+    static const int kSubBucketBits = 5;
+    static const int kSubBuckets = 1 << kSubBucketBits;
+
+    // Latencies of 2^(kMaxExponent + 1) microseconds (about 25 days) or more share the last bucket.
+    static const int kMaxExponent = 40;
+    static const int kMaxBuckets = (kMaxExponent - kSubBucketBits) * kSubBuckets + 2 * kSubBuckets;
+
+    OperationLatencyHistogram() = default;
+    ~OperationLatencyHistogram();
 
-    // Inclusive lower bounds of the histogram buckets.
-    static const std::array<uint64_t, kMaxBuckets> kLowerBounds;
+    /**
+     * Returns the inclusive lower bound of 'bucket', in microseconds.
+     */
+    static uint64_t getBucketLowerBound(int bucket);
 
     /**
      * Increments the bucket of the histogram based on the operation type.
@@ -53,21 +73,22 @@ public:
     void increment(uint64_t latency, Command::ReadWriteType type);
 
     /**
-     * Appends the three histograms with latency totals and operation counts.
+     * Appends the three histograms with latency totals, operation counts and the 50th, 99th and
+     * 99.9th percentile latencies. The histograms themselves only list buckets that have counts.
      */
     void append(bool includeHistograms, BSONObjBuilder* builder) const;
 
 private:
     struct HistogramData {
-        std::array<uint64_t, kMaxBuckets> buckets{};
-        uint64_t entryCount = 0;
-        uint64_t sum = 0;
+        ~HistogramData();
+
+        // Allocated on first increment; never freed before the histogram is destroyed.
+        std::atomic<AtomicUInt64*> buckets{nullptr};  // NOLINT
+        AtomicUInt64 sum;
     };
 
     static int _getBucket(uint64_t latency);
 
-    static uint64_t _getBucketMicros(int bucket);
-
     void _append(const HistogramData& data,
                  const char* key,
                  bool includeHistograms,
@@ -30,7 +30,9 @@
 
 #include "mongo/db/stats/operation_latency_histogram.h"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <iostream>
 #include <numeric>
 #include <vector>
@@ -43,7 +45,10 @@ namespace mongo {
 
 namespace {
 const int kMaxBuckets = OperationLatencyHistogram::kMaxBuckets;
-const std::array<uint64_t, kMaxBuckets>& kLowerBounds = OperationLatencyHistogram::kLowerBounds;
+
+uint64_t lowerBound(int bucket) {
+    return OperationLatencyHistogram::getBucketLowerBound(bucket);
+}
 }  // namespace
 
 TEST(OperationLatencyHistogram, EnsureIncrementsStored) {
@@ -61,32 +66,85 @@ TEST(OperationLatencyHistogram, EnsureIncrementsStored) {
     ASSERT_EQUALS(out["commands"]["ops"].Long(), kMaxBuckets);
 }
 
+TEST(OperationLatencyHistogram, BucketBoundsAreIncreasingAndNarrow) {
+    for (int i = 1; i < kMaxBuckets; i++) {
+        ASSERT_LT(lowerBound(i - 1), lowerBound(i));
+        const uint64_t width = lowerBound(i) - lowerBound(i - 1);
+        ASSERT_LTE(width * OperationLatencyHistogram::kSubBuckets,
+                   std::max<uint64_t>(lowerBound(i - 1), OperationLatencyHistogram::kSubBuckets));
+    }
+}
+
 TEST(OperationLatencyHistogram, CheckBucketCountsAndTotalLatency) {
     OperationLatencyHistogram hist;
-    // Increment at the boundary, boundary+1, and boundary-1.
+    // Increment at the boundary, and at the last value of the previous bucket.
+    uint64_t expectedSum = 0;
     for (int i = 0; i < kMaxBuckets; i++) {
-        hist.increment(kLowerBounds[i], Command::ReadWriteType::kRead);
-        hist.increment(kLowerBounds[i] + 1, Command::ReadWriteType::kRead);
+        hist.increment(lowerBound(i), Command::ReadWriteType::kRead);
+        expectedSum += lowerBound(i);
         if (i > 0) {
-            hist.increment(kLowerBounds[i] - 1, Command::ReadWriteType::kRead);
+            hist.increment(lowerBound(i) - 1, Command::ReadWriteType::kRead);
+            expectedSum += lowerBound(i) - 1;
         }
     }
+    // Values beyond the range of the histogram land in the last bucket.
+    hist.increment(lowerBound(kMaxBuckets - 1) * 4, Command::ReadWriteType::kRead);
+    expectedSum += lowerBound(kMaxBuckets - 1) * 4;
 
-    // The additional +1 because of the first boundary.
-    uint64_t expectedSum = 3 * std::accumulate(kLowerBounds.begin(), kLowerBounds.end(), 0ULL) + 1;
     BSONObjBuilder outBuilder;
     hist.append(true, &outBuilder);
     BSONObj out = outBuilder.done();
     ASSERT_EQUALS(static_cast<uint64_t>(out["reads"]["latency"].Long()), expectedSum);
 
-    // Each bucket has three counts with the exception of the last bucket, which has two.
-    ASSERT_EQUALS(out["reads"]["ops"].Long(), 3 * kMaxBuckets - 1);
+    // Each bucket has two counts: its lower bound and the last value before the next bucket.
+    ASSERT_EQUALS(out["reads"]["ops"].Long(), 2 * kMaxBuckets);
     std::vector<BSONElement> readBuckets = out["reads"]["histogram"].Array();
     ASSERT_EQUALS(readBuckets.size(), static_cast<unsigned int>(kMaxBuckets));
     for (int i = 0; i < kMaxBuckets; i++) {
         BSONObj bucket = readBuckets[i].Obj();
-        ASSERT_EQUALS(static_cast<uint64_t>(bucket["micros"].Long()), kLowerBounds[i]);
-        ASSERT_EQUALS(bucket["count"].Long(), (i < kMaxBuckets - 1) ? 3 : 2);
+        ASSERT_EQUALS(static_cast<uint64_t>(bucket["micros"].Long()), lowerBound(i));
+        ASSERT_EQUALS(bucket["count"].Long(), 2);
+    }
+
+    // Unused types report no histogram buckets and no percentiles.
+    ASSERT_EQUALS(out["writes"]["ops"].Long(), 0);
+    ASSERT_TRUE(out["writes"]["histogram"].Array().empty());
+    ASSERT_FALSE(out["writes"].Obj().hasField("p50"));
+}
+
+TEST(OperationLatencyHistogram, PercentilesAreWithinTwoPercent) {
+    OperationLatencyHistogram hist;
+    // Latencies 1 through 100000 micros, so the p-th percentile is p * 100000.
+    for (uint64_t latency = 1; latency <= 100000; latency++) {
+        hist.increment(latency, Command::ReadWriteType::kCommand);
+    }
+
+    BSONObjBuilder outBuilder;
+    hist.append(false, &outBuilder);
+    BSONObj commands = outBuilder.done()["commands"].Obj();
+    ASSERT_FALSE(commands.hasField("histogram"));
+
+    const std::pair<const char*, double> expected[] = {
+        {"p50", 50000}, {"p99", 99000}, {"p999", 99900}};
+    for (const auto& percentile : expected) {
+        const double actual = commands[percentile.first].Long();
+        ASSERT_LTE(std::abs(actual - percentile.second) / percentile.second, 0.02)
+            << percentile.first << ": " << actual;
     }
 }
+
+TEST(OperationLatencyHistogram, SmallLatenciesAreExact) {
+    OperationLatencyHistogram hist;
+    for (int i = 0; i < 10; i++) {
+        hist.increment(7, Command::ReadWriteType::kWrite);
+    }
+    hist.increment(20, Command::ReadWriteType::kWrite);
+
+    BSONObjBuilder outBuilder;
+    hist.append(false, &outBuilder);
+    BSONObj writes = outBuilder.done()["writes"].Obj();
+    ASSERT_EQUALS(writes["p50"].Long(), 7);
+    ASSERT_EQUALS(writes["p99"].Long(), 20);
+    ASSERT_EQUALS(writes["p999"].Long(), 20);
+}
 }  // namespace mongo
@@ -29,6 +29,10 @@
 
 #include "mongo/db/stats/timer_stats.h"
 
+#include <algorithm>
+
+#include "mongo/platform/bits.h"
+
 namespace mongo {
 
 TimerHolder::TimerHolder(TimerStats* stats) : _stats(stats), _recorded(false) {}
@@ -69,4 +73,62 @@ BSONObj TimerStats::getReport() const {
     b.appendNumber("totalMillis", t);
     return b.obj();
 }
+
+int TimerHistogram::getBucket(long long micros) {
+    if (micros <= 0) {
+        return 0;
+    }
+
+    const int bitLength = 64 - countLeadingZeros64(static_cast<unsigned long long>(micros));
+    return std::min(bitLength, kNumBuckets - 1);
+}
+
+void TimerHistogram::recordMicros(long long micros) {
+    micros = std::max(micros, 0LL);
+    _num.fetchAndAdd(1);
+    _totalMicros.fetchAndAdd(micros);
+    _buckets[getBucket(micros)].fetchAndAdd(1);
+}
+
+long long TimerHistogram::record(const Timer& timer) {
+    long long micros = timer.micros();
+    recordMicros(micros);
+    return micros;
+}
+
+BSONObj TimerHistogram::getReport() const {
+    long long counts[kNumBuckets];
+    long long n = 0;
+    for (int i = 0; i < kNumBuckets; i++) {
+        counts[i] = _buckets[i].loadRelaxed();
+        n += counts[i];
+    }
+
+    // Reports the upper bound of the bucket holding the 'fraction' percentile, or 0 if empty.
+    auto percentile = [&](double fraction) -> long long {
+        const long long rank = std::max(1LL, static_cast<long long>(fraction * n + 0.5));
+        long long seen = 0;
+        for (int i = 0; i < kNumBuckets; i++) {
+            seen += counts[i];
+            if (n > 0 && seen >= rank) {
+                return i == 0 ? 0 : (1LL << i) - 1;
+            }
+        }
+        return 0;
+    };
+
+    BSONObjBuilder b(512);
+    b.appendNumber("num", n);
+    b.appendNumber("totalMicros", _totalMicros.loadRelaxed());
+    b.appendNumber("p50Micros", percentile(0.5));
+    b.appendNumber("p99Micros", percentile(0.99));
+
+    BSONArrayBuilder bucketsBuilder(b.subarrayStart("buckets"));
+    for (int i = 0; i < kNumBuckets; i++) {
+        bucketsBuilder.append(counts[i]);
+    }
+    bucketsBuilder.doneFast();
+
+    return b.obj();
+}
 }
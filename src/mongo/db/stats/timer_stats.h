@@ -59,6 +59,41 @@ private:
     AtomicInt64 _totalMillis;
 };
 
+/**
+ * Holds timing information in microseconds: the number of times and total microseconds, like
+ * TimerStats, plus a histogram with one bucket per power of two. The report always has the same
+ * fields, which keeps it cheap to capture in FTDC.
+ */
+class TimerHistogram {
+public:
+    // Bucket 0 counts zero durations and bucket i counts durations in [2^(i-1), 2^i) micros. The
+    // last bucket also counts everything longer, from about 8 seconds on.
+    static const int kNumBuckets = 25;
+
+    void recordMicros(long long micros);
+
+    /**
+     * @return number of micros
+     */
+    long long record(const Timer& timer);
+
+    /**
+     * Reports "num", "totalMicros", the "p50Micros" and "p99Micros" percentiles as the upper bound
+     * of the bucket they fall into, and the "buckets" counts.
+     */
+    BSONObj getReport() const;
+    operator BSONObj() const {
+        return getReport();
+    }
+
+    static int getBucket(long long micros);
+
+private:
+    AtomicInt64 _num;
+    AtomicInt64 _totalMicros;
+    AtomicInt64 _buckets[kNumBuckets];
+};
+
 /**
  * Holds an instance of a Timer such that we the time is recorded
  * when the TimerHolder goes out of scope
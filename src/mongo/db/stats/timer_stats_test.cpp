@@ -48,4 +48,36 @@ TEST(TimerStatsTest, GetReportOneRecording) {
     ASSERT_BSONOBJ_EQ(BSON("num" << 1 << "totalMillis" << millis), timerStats.getReport());
 }
 
+TEST(TimerHistogramTest, Buckets) {
+    ASSERT_EQ(0, TimerHistogram::getBucket(-5));
+    ASSERT_EQ(0, TimerHistogram::getBucket(0));
+    ASSERT_EQ(1, TimerHistogram::getBucket(1));
+    ASSERT_EQ(2, TimerHistogram::getBucket(2));
+    ASSERT_EQ(2, TimerHistogram::getBucket(3));
+    ASSERT_EQ(11, TimerHistogram::getBucket(1024));
+    ASSERT_EQ(TimerHistogram::kNumBuckets - 1, TimerHistogram::getBucket(1LL << 40));
+}
+
+TEST(TimerHistogramTest, GetReport) {
+    TimerHistogram histogram;
+    BSONObj report = histogram.getReport();
+    ASSERT_EQ(0, report["num"].numberLong());
+    ASSERT_EQ(0, report["p50Micros"].numberLong());
+    ASSERT_EQ(static_cast<size_t>(TimerHistogram::kNumBuckets), report["buckets"].Array().size());
+
+    for (int i = 0; i < 98; i++) {
+        histogram.recordMicros(100);
+    }
+    histogram.recordMicros(5000);
+    histogram.recordMicros(5000);
+
+    report = histogram.getReport();
+    ASSERT_EQ(100, report["num"].numberLong());
+    ASSERT_EQ(98 * 100 + 2 * 5000, report["totalMicros"].numberLong());
+    ASSERT_EQ(127, report["p50Micros"].numberLong());
+    ASSERT_EQ(8191, report["p99Micros"].numberLong());
+    ASSERT_EQ(98, report["buckets"].Array()[7].numberLong());
+    ASSERT_EQ(2, report["buckets"].Array()[13].numberLong());
+}
+
 }  // namespace
@@ -50,23 +50,6 @@ const auto getTop = ServiceContext::declareDecoration<Top>();
 
 }  // namespace
 
-Top::UsageData::UsageData(const UsageData& older, const UsageData& newer) {
-    // this won't be 100% accurate on rollovers and drop(), but at least it won't be negative
-    time = (newer.time >= older.time) ? (newer.time - older.time) : newer.time;
-    count = (newer.count >= older.count) ? (newer.count - older.count) : newer.count;
-}
-
-Top::CollectionData::CollectionData(const CollectionData& older, const CollectionData& newer)
-    : total(older.total, newer.total),
-      readLock(older.readLock, newer.readLock),
-      writeLock(older.writeLock, newer.writeLock),
-      queries(older.queries, newer.queries),
-      getmore(older.getmore, newer.getmore),
-      insert(older.insert, newer.insert),
-      update(older.update, newer.update),
-      remove(older.remove, newer.remove),
-      commands(older.commands, newer.commands) {}
-
 // static
 Top& Top::get(ServiceContext* service) {
     return getTop(service);
@@ -77,21 +60,36 @@ void Top::record(OperationContext* opCtx,
                  LogicalOp logicalOp,
                  LockType lockType,
                  long long micros,
+                 long long cpuMicros,
                  bool command,
                  Command::ReadWriteType readWriteType) {
     if (ns[0] == '?')
         return;
 
+    auto coll = _getOrCreate(ns, command, logicalOp);
+    if (!coll) {
+        return;
+    }
+
+    _record(opCtx, *coll, logicalOp, lockType, micros, cpuMicros, readWriteType);
+}
+
+std::shared_ptr<Top::CollectionData> Top::_getOrCreate(StringData ns,
+                                                        bool command,
+                                                        LogicalOp logicalOp) {
     auto hashedNs = UsageMap::HashedKey(ns);
     stdx::lock_guard<SimpleMutex> lk(_lock);
 
     if ((command || logicalOp == LogicalOp::opQuery) && ns == _lastDropped) {
         _lastDropped = "";
-        return;
+        return nullptr;
     }
 
-    CollectionData& coll = _usage[hashedNs];
-    _record(opCtx, coll, logicalOp, lockType, micros, readWriteType);
+    auto& coll = _usage[hashedNs];
+    if (!coll) {
+        coll = std::make_shared<CollectionData>();
+    }
+    return coll;
 }
 
 void Top::_record(OperationContext* opCtx,
@@ -99,12 +97,17 @@ void Top::_record(OperationContext* opCtx,
                   LogicalOp logicalOp,
                   LockType lockType,
                   long long micros,
+                  long long cpuMicros,
                   Command::ReadWriteType readWriteType) {
 
     _incrementHistogram(opCtx, micros, &c.opLatencyHistogram, readWriteType);
 
     c.total.inc(micros);
 
+    // A negative value means CPU time is not measurable here.
+    if (cpuMicros >= 0)
+        c.cpuTime.inc(cpuMicros);
+
     if (lockType == LockType::WriteLocked)
         c.writeLock.inc(micros);
     else if (lockType == LockType::ReadLocked)
@@ -149,30 +152,26 @@ void Top::collectionDropped(StringData ns, bool databaseDropped) {
     }
 }
 
-void Top::cloneMap(Top::UsageMap& out) const {
-    stdx::lock_guard<SimpleMutex> lk(_lock);
-    out = _usage;
-}
-
 void Top::append(BSONObjBuilder& b) {
-    stdx::lock_guard<SimpleMutex> lk(_lock);
-    _appendToUsageMap(b, _usage);
-}
-
-void Top::_appendToUsageMap(BSONObjBuilder& b, const UsageMap& map) const {
-    // pull all the names into a vector so we can sort them for the user
-
-    vector<string> names;
-    for (UsageMap::const_iterator i = map.begin(); i != map.end(); ++i) {
-        names.push_back(i->first);
+    // Take references to the entries under the mutex, sorted by name for the user, and read the
+    // counters without it.
+    std::vector<std::pair<std::string, std::shared_ptr<CollectionData>>> entries;
+    {
+        stdx::lock_guard<SimpleMutex> lk(_lock);
+        entries.reserve(_usage.size());
+        for (const auto& entry : _usage) {
+            entries.emplace_back(entry.first, entry.second);
+        }
     }
 
-    std::sort(names.begin(), names.end());
+    std::sort(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    });
 
-    for (size_t i = 0; i < names.size(); i++) {
-        BSONObjBuilder bb(b.subobjStart(names[i]));
+    for (const auto& entry : entries) {
+        BSONObjBuilder bb(b.subobjStart(entry.first));
 
-        const CollectionData& coll = map.find(names[i])->second;
+        const CollectionData& coll = *entry.second;
 
         _appendStatsEntry(b, "total", coll.total);
 
@@ -185,6 +184,7 @@ void Top::_appendToUsageMap(BSONObjBuilder& b, const UsageMap& map) const {
         _appendStatsEntry(b, "update", coll.update);
         _appendStatsEntry(b, "remove", coll.remove);
         _appendStatsEntry(b, "commands", coll.commands);
+        _appendStatsEntry(b, "cpuTime", coll.cpuTime);
 
         bb.done();
     }
@@ -192,16 +192,28 @@ void Top::_appendToUsageMap(BSONObjBuilder& b, const UsageMap& map) const {
 
 void Top::_appendStatsEntry(BSONObjBuilder& b, const char* statsName, const UsageData& map) const {
     BSONObjBuilder bb(b.subobjStart(statsName));
-    bb.appendNumber("time", map.time);
-    bb.appendNumber("count", map.count);
+    bb.appendNumber("time", map.time.load());
+    bb.appendNumber("count", map.count.load());
     bb.done();
 }
 
 void Top::appendLatencyStats(StringData ns, bool includeHistograms, BSONObjBuilder* builder) {
-    auto hashedNs = UsageMap::HashedKey(ns);
-    stdx::lock_guard<SimpleMutex> lk(_lock);
+    std::shared_ptr<CollectionData> coll;
+    {
+        auto hashedNs = UsageMap::HashedKey(ns);
+        stdx::lock_guard<SimpleMutex> lk(_lock);
+        auto it = _usage.find(hashedNs);
+        if (it != _usage.end()) {
+            coll = it->second;
+        }
+    }
+
     BSONObjBuilder latencyStatsBuilder;
-    _usage[hashedNs].opLatencyHistogram.append(includeHistograms, &latencyStatsBuilder);
+    if (coll) {
+        coll->opLatencyHistogram.append(includeHistograms, &latencyStatsBuilder);
+    } else {
+        OperationLatencyHistogram().append(includeHistograms, &latencyStatsBuilder);
+    }
     builder->append("ns", ns);
     builder->append("latencyStats", latencyStatsBuilder.obj());
 }
@@ -209,12 +221,10 @@ void Top::appendLatencyStats(StringData ns, bool includeHistograms, BSONObjBuild
 void Top::incrementGlobalLatencyStats(OperationContext* opCtx,
                                       uint64_t latency,
                                       Command::ReadWriteType readWriteType) {
-    stdx::lock_guard<SimpleMutex> guard(_lock);
     _incrementHistogram(opCtx, latency, &_globalHistogramStats, readWriteType);
 }
 
 void Top::appendGlobalLatencyStats(bool includeHistograms, BSONObjBuilder* builder) {
-    stdx::lock_guard<SimpleMutex> guard(_lock);
     _globalHistogramStats.append(includeHistograms, builder);
 }
 
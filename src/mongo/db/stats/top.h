@@ -30,10 +30,12 @@
 #pragma once
 
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <memory>
 
 #include "mongo/db/commands.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/stats/operation_latency_histogram.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/net/message.h"
 #include "mongo/util/string_map.h"
@@ -44,6 +46,10 @@ class ServiceContext;
 
 /**
  * tracks usage by collection
+ *
+ * The mutex only guards the map from namespace to statistics. The statistics of a collection are
+ * updated with atomic increments after the mutex is released, so recording an operation never
+ * waits behind another operation's bookkeeping.
  */
 class Top {
 public:
@@ -52,24 +58,16 @@ public:
     Top() = default;
 
     struct UsageData {
-        UsageData() : time(0), count(0) {}
-        UsageData(const UsageData& older, const UsageData& newer);
-        long long time;
-        long long count;
+        AtomicInt64 time;
+        AtomicInt64 count;
 
         void inc(long long micros) {
-            count++;
-            time += micros;
+            count.fetchAndAdd(1);
+            time.fetchAndAdd(micros);
         }
     };
 
     struct CollectionData {
-        /**
-         * constructs a diff
-         */
-        CollectionData() {}
-        CollectionData(const CollectionData& older, const CollectionData& newer);
-
         UsageData total;
 
         UsageData readLock;
@@ -81,6 +79,9 @@ public:
         UsageData update;
         UsageData remove;
         UsageData commands;
+
+        // CPU time of the operations counted in 'total', where the platform can measure it.
+        UsageData cpuTime;
         OperationLatencyHistogram opLatencyHistogram;
     };
 
@@ -90,7 +91,9 @@ public:
         NotLocked,
     };
 
-    typedef StringMap<CollectionData> UsageMap;
+    // Entries are shared so that they can be updated and read outside of the mutex, even while
+    // the collection is being dropped.
+    typedef StringMap<std::shared_ptr<CollectionData>> UsageMap;
 
 public:
     void record(OperationContext* opCtx,
@@ -98,13 +101,12 @@ public:
                 LogicalOp logicalOp,
                 LockType lockType,
                 long long micros,
+                long long cpuMicros,
                 bool command,
                 Command::ReadWriteType readWriteType);
 
     void append(BSONObjBuilder& b);
 
-    void cloneMap(UsageMap& out) const;
-
     void collectionDropped(StringData ns, bool databaseDropped = false);
 
     /**
@@ -125,8 +127,6 @@ public:
     void appendGlobalLatencyStats(bool includeHistograms, BSONObjBuilder* builder);
 
 private:
-    void _appendToUsageMap(BSONObjBuilder& b, const UsageMap& map) const;
-
     void _appendStatsEntry(BSONObjBuilder& b, const char* statsName, const UsageData& map) const;
 
     void _record(OperationContext* opCtx,
@@ -134,6 +134,7 @@ private:
                  LogicalOp logicalOp,
                  LockType lockType,
                  long long micros,
+                 long long cpuMicros,
                  Command::ReadWriteType readWriteType);
 
     void _incrementHistogram(OperationContext* opCtx,
@@ -141,7 +142,15 @@ private:
                              OperationLatencyHistogram* histogram,
                              Command::ReadWriteType readWriteType);
 
+    /**
+     * Returns the statistics for 'ns', or null if they should not be recorded because 'ns' was
+     * just dropped.
+     */
+    std::shared_ptr<CollectionData> _getOrCreate(StringData ns, bool command, LogicalOp logicalOp);
+
     mutable SimpleMutex _lock;
+
+    // Thread-safe on its own; not protected by _lock.
     OperationLatencyHistogram _globalHistogramStats;
     UsageMap _usage;
     std::string _lastDropped;
@@ -0,0 +1,74 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/ordering.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/unittest/benchmark.h"
+
+namespace mongo {
+namespace {
+
+const Ordering kOrdering = Ordering::make(BSON("a" << 1 << "b" << -1 << "c" << 1));
+
+// A compound index key of the shapes most indexes hold: an integer, a short string and a double.
+const BSONObj kKey = BSON("" << 123456789 << ""
+                             << "user1234@example.com"
+                             << ""
+                             << 3.14159);
+
+void BM_keyStringFromBSON(benchmark::State& state) {
+    for (auto _ : state) {
+        KeyString ks(KeyString::Version::V1, kKey, kOrdering);
+        benchmark::doNotOptimizeAway(ks.getSize());
+    }
+}
+BENCHMARK(BM_keyStringFromBSON);
+
+void BM_keyStringResetToKey(benchmark::State& state) {
+    KeyString ks(KeyString::Version::V1);
+    for (auto _ : state) {
+        ks.resetToKey(kKey, kOrdering, RecordId(42));
+        benchmark::doNotOptimizeAway(ks.getSize());
+    }
+}
+BENCHMARK(BM_keyStringResetToKey);
+
+void BM_keyStringToBSON(benchmark::State& state) {
+    const KeyString ks(KeyString::Version::V1, kKey, kOrdering);
+    for (auto _ : state) {
+        benchmark::doNotOptimizeAway(
+            KeyString::toBson(ks.getBuffer(), ks.getSize(), kOrdering, ks.getTypeBits()));
+    }
+}
+BENCHMARK(BM_keyStringToBSON);
+
+}  // namespace
+}  // namespace mongo
@@ -1108,7 +1108,9 @@ unsigned newSeed() {
  * Evaluates ROUNDTRIP on all items in Numbers a sufficient number of times to take at least
  * kMinPerfMicros microseconds. Logs the elapsed time per ROUNDTRIP evaluation.
  */
-void perfTest(KeyString::Version version, const Numbers& numbers) {
+void perfTest(KeyString::Version version,
+              const Numbers& numbers,
+              Ordering order = ALL_ASCENDING) {
     uint64_t micros = 0;
     uint64_t iters;
     // Ensure at least 16 iterations are done and at least 50 milliseconds is timed
@@ -1120,8 +1122,8 @@ void perfTest(KeyString::Version version, const Numbers& numbers) {
             for (auto item : numbers) {
                 // Assuming there are sufficient invariants in the to/from KeyString methods
                 // that calls will not be optimized away.
-                const KeyString ks(version, item, ALL_ASCENDING);
-                const BSONObj& converted = toBson(ks, ALL_ASCENDING);
+                const KeyString ks(version, item, order);
+                const BSONObj& converted = toBson(ks, order);
                 invariant(converted.binaryEqual(item));
             }
 
@@ -1138,6 +1140,37 @@ void perfTest(KeyString::Version version, const Numbers& numbers) {
 }
 }  // namespace
 
+namespace {
+/**
+ * Returns strings of up to 'maxLength' printable characters, with an occasional NUL byte so the
+ * escaping paths are exercised too.
+ */
+std::vector<BSONObj> randomStrings(size_t maxLength) {
+    std::mt19937 gen(newSeed());
+    std::uniform_int_distribution<size_t> length(0, maxLength);
+    std::uniform_int_distribution<int> character(0, 95);
+
+    std::vector<BSONObj> strings;
+    for (uint64_t x = 0; x < kMinPerfSamples; x++) {
+        std::string str(length(gen), '\0');
+        for (auto&& c : str) {
+            const int value = character(gen);
+            c = value == 0 ? '\0' : static_cast<char>(' ' + value);
+        }
+        strings.push_back(BSON("" << str));
+    }
+    return strings;
+}
+}  // namespace
+
+TEST_F(KeyStringTest, StringPerf) {
+    perfTest(version, randomStrings(100));
+}
+
+TEST_F(KeyStringTest, DescendingStringPerf) {
+    perfTest(version, randomStrings(100), ONE_DESCENDING);
+}
+
 TEST_F(KeyStringTest, CommonIntPerf) {
     // Exponential distribution, so skewed towards smaller integers.
     std::mt19937 gen(newSeed());
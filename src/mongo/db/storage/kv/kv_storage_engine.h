@@ -120,6 +120,8 @@ public:
 
     virtual void replicationBatchIsComplete() const override;
 
+    double getCacheDirtyRatio() const override;
+
     SnapshotManager* getSnapshotManager() const final;
 
     void setJournalListener(JournalListener* jl) final;
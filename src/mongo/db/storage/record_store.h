@@ -31,6 +31,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <vector>
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/mutable/damage_vector.h"
@@ -153,6 +154,29 @@ public:
      */
     virtual boost::optional<Record> next() = 0;
 
+    /**
+     * Moves forward up to 'maxRecords' times, appending each record to 'out', and returns the
+     * number of records appended. Returning fewer than 'maxRecords' means EOF was reached.
+     *
+     * Unlike next(), the data of every appended record is owned, so it stays valid after the
+     * cursor moves again or is saved. If this throws, the records already appended to 'out' have
+     * been consumed from the cursor and remain valid.
+     *
+     * Storage engines may override this to avoid the per-record overhead of next().
+     */
+    virtual size_t nextBatch(std::vector<Record>* out, size_t maxRecords) {
+        size_t numAppended = 0;
+        while (numAppended < maxRecords) {
+            auto record = next();
+            if (!record)
+                break;
+            record->data.makeOwned();
+            out->push_back(std::move(*record));
+            ++numAppended;
+        }
+        return numAppended;
+    }
+
     //
     // Saving and restoring state
     //
@@ -207,6 +231,13 @@ public:
      */
     virtual void invalidate(OperationContext* opCtx, const RecordId& id) {}
 
+    /**
+     * Hints that this cursor is about to be used for a long sequential scan, so the storage engine
+     * may start reading the records past its position in the background. Storage engines are free
+     * to ignore this.
+     */
+    virtual void enableReadAhead() {}
+
     //
     // RecordFetchers
     //
@@ -248,6 +279,15 @@ public:
      */
     virtual boost::optional<Record> seekExact(const RecordId& id) = 0;
 
+    /**
+     * Hints that seekExact() is about to be called for each of 'ids', which are in ascending
+     * order, so the storage engine may start reading those records in the background. Returns
+     * false if the storage engine ignores the hint, so callers can stop gathering ids for it.
+     */
+    virtual bool prefetch(const std::vector<RecordId>& ids) {
+        return false;
+    }
+
     /**
      * Prepares for state changes in underlying data without necessarily saving the current
      * state.
@@ -443,5 +443,52 @@ TEST(RecordStoreTestHarness, SeekAfterEofAndContinue) {
     ASSERT(!cursor->next());
 }
 
+// Insert multiple records and read them in batches with nextBatch(), saving and restoring the
+// cursor between batches. Records returned by earlier batches must stay valid.
+TEST(RecordStoreTestHarness, NextBatchReturnsOwnedRecordsInOrder) {
+    const auto harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+    const int nToInsert = 10;
+    RecordId locs[nToInsert];
+    for (int i = 0; i < nToInsert; i++) {
+        StringBuilder sb;
+        sb << "record " << i;
+        string data = sb.str();
+
+        WriteUnitOfWork uow(opCtx.get());
+        StatusWith<RecordId> res =
+            rs->insertRecord(opCtx.get(), data.c_str(), data.size() + 1, Timestamp(), false);
+        ASSERT_OK(res.getStatus());
+        locs[i] = res.getValue();
+        uow.commit();
+    }
+
+    std::sort(locs, locs + nToInsert);  // inserted records may not be in RecordId order
+
+    for (bool forward : {true, false}) {
+        auto cursor = rs->getCursor(opCtx.get(), forward);
+        std::vector<Record> records;
+        ASSERT_EQUALS(4U, cursor->nextBatch(&records, 4));
+        cursor->save();
+        ASSERT(cursor->restore());
+        ASSERT_EQUALS(4U, cursor->nextBatch(&records, 4));
+        ASSERT_EQUALS(2U, cursor->nextBatch(&records, 4));
+        ASSERT_EQUALS(0U, cursor->nextBatch(&records, 4));
+        ASSERT(!cursor->next());
+
+        ASSERT_EQUALS(static_cast<size_t>(nToInsert), records.size());
+        for (int i = 0; i < nToInsert; i++) {
+            const RecordId& expectedId = forward ? locs[i] : locs[nToInsert - 1 - i];
+            ASSERT_EQUALS(expectedId, records[i].id);
+            ASSERT(records[i].data.isOwned());
+            ASSERT_EQUALS(rs->dataFor(opCtx.get(), expectedId).data(),
+                          std::string(records[i].data.data()));
+        }
+    }
+}
+
 }  // namespace
 }  // namespace mongo
@@ -61,6 +61,10 @@ public:
         return std::to_string(_id);
     }
 
+    uint64_t toNumber() const {
+        return _id;
+    }
+
 private:
     uint64_t _id;
 };
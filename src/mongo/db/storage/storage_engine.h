@@ -337,6 +337,15 @@ public:
      */
     virtual void replicationBatchIsComplete() const {};
 
+    /**
+     * Returns the fraction of the storage engine's cache which holds modified data that has not
+     * been written out yet, or 0 for engines without such a cache. Background work such as TTL
+     * deletion uses this to back off before it adds to eviction pressure.
+     */
+    virtual double getCacheDirtyRatio() const {
+        return 0;
+    }
+
     // (CollectionName, IndexName)
     typedef std::pair<std::string, std::string> CollectionIndexNamePair;
 
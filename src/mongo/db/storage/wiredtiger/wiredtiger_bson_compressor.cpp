@@ -0,0 +1,315 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_bson_compressor.h"
+
+#include <algorithm>
+#include <snappy.h>
+#include <string>
+#include <vector>
+#include <wiredtiger.h>
+
+#include "mongo/base/init.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_extensions.h"
+#include "mongo/platform/compiler.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+namespace {
+
+const uint8_t kFormatVersion = 1;
+
+// Introduces either a dictionary reference (followed by the entry's index plus one) or a literal
+// kEscape byte (followed by zero).
+const uint8_t kEscape = 0xFE;
+
+const size_t kMaxEntries = 254;
+const size_t kMaxFieldNameLength = 64;
+const size_t kMaxEntryLength = kMaxFieldNameLength + 2;
+
+// Bound on the size of the version byte, entry count and dictionary.
+const size_t kMaxHeaderLength = 2 + kMaxEntries * (1 + kMaxEntryLength);
+
+bool isBsonTypeByte(uint8_t byte) {
+    return (byte >= 0x01 && byte <= 0x13) || byte == 0x7F || byte == 0xFF;
+}
+
+bool isFieldNameByte(uint8_t byte) {
+    return byte >= 0x21 && byte <= 0x7E;
+}
+
+/**
+ * Returns the length of the BSON element header (type byte, field name and terminating NUL) which
+ * may start at 'pos', or 0 if none does.
+ */
+size_t elementHeaderLength(const uint8_t* src, size_t srcLen, size_t pos) {
+    if (!isBsonTypeByte(src[pos])) {
+        return 0;
+    }
+    size_t end = pos + 1;
+    while (end < srcLen && end - pos - 1 < kMaxFieldNameLength && isFieldNameByte(src[end])) {
+        ++end;
+    }
+    if (end == pos + 1 || end >= srcLen || src[end] != '\0') {
+        return 0;
+    }
+    return end + 1 - pos;
+}
+
+/**
+ * Picks the element headers of 'src' which save the most bytes when stored once.
+ */
+std::vector<std::string> buildDictionary(const uint8_t* src, size_t srcLen) {
+    StringMap<size_t> counts;
+    for (size_t pos = 0; pos < srcLen;) {
+        const size_t len = elementHeaderLength(src, srcLen, pos);
+        if (len == 0) {
+            ++pos;
+            continue;
+        }
+        ++counts[StringData(reinterpret_cast<const char*>(src) + pos, len)];
+        pos += len;
+    }
+
+    // Each use saves all but two bytes, and the entry itself costs its length plus one.
+    auto savings = [](const std::pair<std::string, size_t>& entry) {
+        return static_cast<long long>(entry.second * (entry.first.size() - 2)) -
+            static_cast<long long>(entry.first.size() + 1);
+    };
+    std::vector<std::pair<std::string, size_t>> candidates;
+    for (auto&& entry : counts) {
+        if (savings(entry) > 0) {
+            candidates.push_back(entry);
+        }
+    }
+    std::sort(candidates.begin(),
+              candidates.end(),
+              [&](const std::pair<std::string, size_t>& a,
+                  const std::pair<std::string, size_t>& b) { return savings(a) > savings(b); });
+    if (candidates.size() > kMaxEntries) {
+        candidates.resize(kMaxEntries);
+    }
+
+    std::vector<std::string> dictionary;
+    for (auto&& candidate : candidates) {
+        dictionary.push_back(std::move(candidate.first));
+    }
+    return dictionary;
+}
+
+int bsonCompress(WT_COMPRESSOR* compressor,
+                 WT_SESSION* session,
+                 uint8_t* src,
+                 size_t srcLen,
+                 uint8_t* dst,
+                 size_t dstLen,
+                 size_t* resultLen,
+                 int* compressionFailed) {
+    try {
+        auto compressedLen = WiredTigerBsonCompressor::compress(reinterpret_cast<const char*>(src),
+                                                                srcLen,
+                                                                reinterpret_cast<char*>(dst),
+                                                                dstLen);
+        *compressionFailed = compressedLen ? 0 : 1;
+        *resultLen = compressedLen.value_or(0);
+        return 0;
+    } catch (const std::bad_alloc&) {
+        return ENOMEM;
+    }
+}
+
+int bsonDecompress(WT_COMPRESSOR* compressor,
+                   WT_SESSION* session,
+                   uint8_t* src,
+                   size_t srcLen,
+                   uint8_t* dst,
+                   size_t dstLen,
+                   size_t* resultLen) {
+    try {
+        auto decompressedLen =
+            WiredTigerBsonCompressor::decompress(reinterpret_cast<const char*>(src),
+                                                 srcLen,
+                                                 reinterpret_cast<char*>(dst),
+                                                 dstLen);
+        if (!decompressedLen.isOK()) {
+            return WT_ERROR;
+        }
+        *resultLen = decompressedLen.getValue();
+        return 0;
+    } catch (const std::bad_alloc&) {
+        return ENOMEM;
+    }
+}
+
+int bsonPreSize(WT_COMPRESSOR* compressor,
+                WT_SESSION* session,
+                uint8_t* src,
+                size_t srcLen,
+                size_t* resultLen) {
+    *resultLen = WiredTigerBsonCompressor::maxCompressedLength(srcLen);
+    return 0;
+}
+
+}  // namespace
+
+constexpr StringData WiredTigerBsonCompressor::kName;
+
+size_t WiredTigerBsonCompressor::maxCompressedLength(size_t srcLen) {
+    // Every byte of the page may need escaping.
+    return snappy::MaxCompressedLength(kMaxHeaderLength + 2 * srcLen);
+}
+
+boost::optional<size_t> WiredTigerBsonCompressor::compress(const char* src,
+                                                           size_t srcLen,
+                                                           char* dst,
+                                                           size_t dstLen) {
+    invariant(dstLen >= maxCompressedLength(srcLen));
+    const auto* bytes = reinterpret_cast<const uint8_t*>(src);
+    const auto dictionary = buildDictionary(bytes, srcLen);
+
+    std::string encoded;
+    encoded.reserve(kMaxHeaderLength + srcLen);
+    encoded.push_back(static_cast<char>(kFormatVersion));
+    encoded.push_back(static_cast<char>(dictionary.size()));
+    StringMap<uint8_t> references;
+    for (size_t i = 0; i < dictionary.size(); ++i) {
+        encoded.push_back(static_cast<char>(dictionary[i].size()));
+        encoded.append(dictionary[i]);
+        references[dictionary[i]] = static_cast<uint8_t>(i + 1);
+    }
+
+    for (size_t pos = 0; pos < srcLen;) {
+        const size_t len = elementHeaderLength(bytes, srcLen, pos);
+        if (len != 0) {
+            auto reference = references.find(StringData(src + pos, len));
+            if (reference != references.end()) {
+                encoded.push_back(static_cast<char>(kEscape));
+                encoded.push_back(static_cast<char>(reference->second));
+                pos += len;
+                continue;
+            }
+        }
+        encoded.push_back(src[pos]);
+        if (bytes[pos] == kEscape) {
+            encoded.push_back('\0');
+        }
+        ++pos;
+    }
+
+    size_t compressedLen;
+    snappy::RawCompress(encoded.data(), encoded.size(), dst, &compressedLen);
+    if (compressedLen >= srcLen) {
+        return boost::none;
+    }
+    return compressedLen;
+}
+
+StatusWith<size_t> WiredTigerBsonCompressor::decompress(const char* src,
+                                                        size_t srcLen,
+                                                        char* dst,
+                                                        size_t dstLen) {
+    const Status corrupt(ErrorCodes::BadValue, "corrupt bsondict compressed block");
+
+    size_t encodedLen;
+    if (!snappy::GetUncompressedLength(src, srcLen, &encodedLen) ||
+        encodedLen > kMaxHeaderLength + 2 * dstLen) {
+        return corrupt;
+    }
+    std::string encoded(encodedLen, '\0');
+    if (!snappy::RawUncompress(src, srcLen, &encoded[0])) {
+        return corrupt;
+    }
+
+    const auto* bytes = reinterpret_cast<const uint8_t*>(encoded.data());
+    if (encodedLen < 2 || bytes[0] != kFormatVersion) {
+        return corrupt;
+    }
+    std::vector<StringData> dictionary;
+    size_t pos = 2;
+    for (size_t i = 0; i < bytes[1]; ++i) {
+        if (pos >= encodedLen || pos + 1 + bytes[pos] > encodedLen) {
+            return corrupt;
+        }
+        dictionary.emplace_back(encoded.data() + pos + 1, bytes[pos]);
+        pos += 1 + bytes[pos];
+    }
+
+    size_t out = 0;
+    while (pos < encodedLen) {
+        if (bytes[pos] != kEscape) {
+            if (out == dstLen) {
+                return corrupt;
+            }
+            dst[out++] = encoded[pos++];
+            continue;
+        }
+
+        if (pos + 1 == encodedLen) {
+            return corrupt;
+        }
+        const uint8_t reference = bytes[pos + 1];
+        pos += 2;
+        if (reference > dictionary.size()) {
+            return corrupt;
+        }
+        const StringData expansion = reference == 0
+            ? StringData(reinterpret_cast<const char*>(&kEscape), 1)
+            : dictionary[reference - 1];
+        if (dstLen - out < expansion.size()) {
+            return corrupt;
+        }
+        std::copy(expansion.begin(), expansion.end(), dst + out);
+        out += expansion.size();
+    }
+    return out;
+}
+
+extern "C" MONGO_COMPILER_API_EXPORT int mongo_addBsonCompressor(WT_CONNECTION* conn,
+                                                                 WT_CONFIG_ARG* cfg) {
+    static WT_COMPRESSOR compressor;
+
+    compressor.compress = bsonCompress;
+    compressor.decompress = bsonDecompress;
+    compressor.pre_size = bsonPreSize;
+    return conn->add_compressor(
+        conn, WiredTigerBsonCompressor::kName.toString().c_str(), &compressor, NULL);
+}
+
+// Registered whatever the configured compressor, so that tables written with it stay readable.
+MONGO_INITIALIZER_WITH_PREREQUISITES(AddWiredTigerBsonCompressor, ("SetWiredTigerExtensions"))
+(InitializerContext* context) {
+    WiredTigerExtensions::get(getGlobalServiceContext())
+        ->addExtension("local=(entry=mongo_addBsonCompressor)");
+    return Status::OK();
+}
+
+}  // namespace mongo
@@ -0,0 +1,75 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <cstddef>
+
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+
+namespace mongo {
+
+/**
+ * A WiredTiger block compressor for pages of BSON documents which share field names.
+ *
+ * Before handing a page to snappy, it replaces each BSON element header (type byte and field name)
+ * which recurs often enough on the page with a two byte reference into a dictionary stored at the
+ * start of the compressed page. Field names are thus stored once per page rather than once per
+ * document, and snappy only has to find the repetition in the values.
+ *
+ * The compressor is registered with every WiredTiger connection under kName, so that collections
+ * may select it through their block_compressor setting.
+ */
+class WiredTigerBsonCompressor {
+public:
+    static constexpr StringData kName = "bsondict"_sd;
+
+    /**
+     * Returns the size of the buffer compress() needs for 'srcLen' bytes.
+     */
+    static size_t maxCompressedLength(size_t srcLen);
+
+    /**
+     * Compresses 'src' into 'dst', returning the compressed length, or boost::none if compressing
+     * does not shrink the data. 'dstLen' must be at least maxCompressedLength(srcLen).
+     */
+    static boost::optional<size_t> compress(const char* src,
+                                            size_t srcLen,
+                                            char* dst,
+                                            size_t dstLen);
+
+    /**
+     * Decompresses 'src' into 'dst', returning the decompressed length. Fails if 'src' is
+     * malformed or does not fit in 'dstLen' bytes.
+     */
+    static StatusWith<size_t> decompress(const char* src, size_t srcLen, char* dst, size_t dstLen);
+};
+
+}  // namespace mongo
@@ -0,0 +1,137 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_bson_compressor.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+std::vector<char> compress(const std::string& data) {
+    std::vector<char> compressed(WiredTigerBsonCompressor::maxCompressedLength(data.size()));
+    auto len = WiredTigerBsonCompressor::compress(
+        data.data(), data.size(), compressed.data(), compressed.size());
+    if (!len) {
+        return {};
+    }
+    compressed.resize(*len);
+    return compressed;
+}
+
+std::string decompress(const std::vector<char>& compressed, size_t originalLen) {
+    std::string data(originalLen, '\0');
+    auto len = WiredTigerBsonCompressor::decompress(
+        compressed.data(), compressed.size(), &data[0], data.size());
+    ASSERT_OK(len.getStatus());
+    data.resize(len.getValue());
+    return data;
+}
+
+std::string makePage(int numDocs) {
+    std::string page;
+    for (int i = 0; i < numDocs; ++i) {
+        auto doc = BSON("_id" << i << "deviceIdentifier" << (i % 7) << "measurementTimestamp"
+                              << Date_t::fromMillisSinceEpoch(i * 1000LL)
+                              << "temperatureCelsius"
+                              << 20.5 + i
+                              << "location"
+                              << BSON("buildingName"
+                                      << "north"
+                                      << "floorNumber"
+                                      << i % 3));
+        page.append(doc.objdata(), doc.objsize());
+    }
+    return page;
+}
+
+TEST(WiredTigerBsonCompressorTest, RoundTripsPageOfDocuments) {
+    const auto page = makePage(200);
+    auto compressed = compress(page);
+    ASSERT_FALSE(compressed.empty());
+    ASSERT_EQ(page, decompress(compressed, page.size()));
+}
+
+TEST(WiredTigerBsonCompressorTest, StoresRepeatedFieldNamesOnce) {
+    const auto page = makePage(200);
+    auto compressed = compress(page);
+    ASSERT_LT(compressed.size(), page.size() / 2);
+}
+
+TEST(WiredTigerBsonCompressorTest, RoundTripsEscapeBytesAndHeaderLookalikes) {
+    std::string data;
+    for (int i = 0; i < 500; ++i) {
+        data.push_back(static_cast<char>(0xFE));
+        data.append("\x02name", 5);
+        data.push_back('\0');
+        data.push_back(static_cast<char>(0xFE));
+        data.push_back(static_cast<char>(i % 256));
+    }
+    auto compressed = compress(data);
+    ASSERT_FALSE(compressed.empty());
+    ASSERT_EQ(data, decompress(compressed, data.size()));
+}
+
+TEST(WiredTigerBsonCompressorTest, RoundTripsRandomBytes) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> byte(0, 255);
+    for (size_t size : {1, 2, 100, 4096, 65536}) {
+        std::string data;
+        for (size_t i = 0; i < size; ++i) {
+            data.push_back(static_cast<char>(byte(gen) % (i % 3 == 0 ? 20 : 256)));
+        }
+        auto compressed = compress(data);
+        if (!compressed.empty()) {
+            ASSERT_EQ(data, decompress(compressed, data.size()));
+        }
+    }
+}
+
+TEST(WiredTigerBsonCompressorTest, RejectsCorruptInput) {
+    const auto page = makePage(50);
+    auto compressed = compress(page);
+    ASSERT_FALSE(compressed.empty());
+
+    std::string data(page.size(), '\0');
+    ASSERT_NOT_OK(WiredTigerBsonCompressor::decompress(
+                      compressed.data(), compressed.size() / 2, &data[0], data.size())
+                      .getStatus());
+    ASSERT_NOT_OK(WiredTigerBsonCompressor::decompress(
+                      compressed.data(), compressed.size(), &data[0], page.size() / 2)
+                      .getStatus());
+}
+
+}  // namespace
+}  // namespace mongo
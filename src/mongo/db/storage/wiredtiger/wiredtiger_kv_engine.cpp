@@ -60,16 +60,19 @@
 #include "mongo/db/server_options.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/stats/top.h"
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_extensions.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_index.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_read_ahead.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/memory.h"
@@ -306,11 +309,146 @@ TicketHolder openReadTransaction(128);
 TicketServerParameter openReadTransactionParam(&openReadTransaction,
                                                "wiredTigerConcurrentReadTransactions");
 
+// When true, the ticket controller thread resizes the read and write ticket pools based on cache
+// pressure, ticket saturation and operation latency, overriding the two parameters above.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerConcurrentTransactionsAdaptive, bool, false);
+
+// Average operation latency above which the ticket controller shrinks a ticket pool. 0 means
+// latency is not taken into account.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerConcurrentTransactionsTargetLatencyMicros, long long, 0);
+
+// How often the ticket controller thread samples and resizes the ticket pools.
+const int kTicketControllerIntervalMillis = 1000;
+
+WiredTigerTicketController ticketController;
+
 stdx::function<bool(StringData)> initRsOplogBackgroundThreadCallback = [](StringData) -> bool {
     fassertFailed(40358);
 };
 }  // namespace
 
+class WiredTigerKVEngine::WiredTigerTicketControllerThread : public BackgroundJob {
+public:
+    explicit WiredTigerTicketControllerThread(WT_CONNECTION* conn)
+        : BackgroundJob(false /* deleteSelf */), _conn(conn) {}
+
+    virtual string name() const {
+        return "WTTicketController";
+    }
+
+    virtual void run() {
+        Client::initThread(name().c_str());
+
+        LOG(1) << "starting " << name() << " thread";
+
+        while (!_shuttingDown.load()) {
+            {
+                stdx::unique_lock<stdx::mutex> lock(_mutex);
+                MONGO_IDLE_THREAD_BLOCK;
+                _condvar.wait_for(lock,
+                                  stdx::chrono::milliseconds(kTicketControllerIntervalMillis),
+                                  [this] { return _shuttingDown.load(); });
+            }
+            if (_shuttingDown.load()) {
+                break;
+            }
+
+            // Latencies are sampled on every round so that the first round after the controller
+            // is enabled only sees operations from the last interval.
+            WiredTigerTicketController::Sample sample;
+            _sampleLatencies(&sample);
+            if (!wiredTigerConcurrentTransactionsAdaptive.load()) {
+                continue;
+            }
+            if (!_sampleCache(&sample)) {
+                continue;
+            }
+            sample.read.used = openReadTransaction.used();
+            sample.read.total = openReadTransaction.outof();
+            sample.write.used = openWriteTransaction.used();
+            sample.write.total = openWriteTransaction.outof();
+            sample.targetLatencyMicros = wiredTigerConcurrentTransactionsTargetLatencyMicros.load();
+
+            auto result = ticketController.update(sample, Date_t::now());
+            if (result.readTickets != sample.read.total ||
+                result.writeTickets != sample.write.total) {
+                LOG(1) << "Resizing WiredTiger tickets due to " << result.reason
+                       << ". read: " << sample.read.total << " -> " << result.readTickets
+                       << ", write: " << sample.write.total << " -> " << result.writeTickets;
+            }
+            // Shrinking a pool waits for tickets to be returned, but never for longer than the
+            // operations currently holding them.
+            if (result.readTickets != sample.read.total) {
+                openReadTransaction.resize(result.readTickets).transitional_ignore();
+            }
+            if (result.writeTickets != sample.write.total) {
+                openWriteTransaction.resize(result.writeTickets).transitional_ignore();
+            }
+        }
+        LOG(1) << "stopping " << name() << " thread";
+    }
+
+    void shutdown() {
+        _shuttingDown.store(true);
+        _condvar.notify_one();
+        wait();
+    }
+
+private:
+    struct LatencyTotals {
+        long long latencyMicros = 0;
+        long long ops = 0;
+    };
+
+    static double _averageLatency(const BSONObj& stats, LatencyTotals* previous) {
+        LatencyTotals current;
+        current.latencyMicros = stats["latency"].safeNumberLong();
+        current.ops = stats["ops"].safeNumberLong();
+        const auto ops = current.ops - previous->ops;
+        const auto latency = current.latencyMicros - previous->latencyMicros;
+        *previous = current;
+        return ops > 0 ? static_cast<double>(latency) / ops : 0;
+    }
+
+    void _sampleLatencies(WiredTigerTicketController::Sample* sample) {
+        if (!hasGlobalServiceContext()) {
+            return;
+        }
+        BSONObjBuilder bob;
+        Top::get(getGlobalServiceContext()).appendGlobalLatencyStats(false, &bob);
+        auto stats = bob.obj();
+        sample->read.avgLatencyMicros = _averageLatency(stats["reads"].Obj(), &_reads);
+        sample->write.avgLatencyMicros = _averageLatency(stats["writes"].Obj(), &_writes);
+    }
+
+    bool _sampleCache(WiredTigerTicketController::Sample* sample) {
+        WiredTigerSession session(_conn);
+        auto getStat = [&](int key) {
+            return WiredTigerUtil::getStatisticsValueAs<long long>(
+                session.getSession(), "statistics:", "statistics=(fast)", key);
+        };
+        auto inUse = getStat(WT_STAT_CONN_CACHE_BYTES_INUSE);
+        auto dirty = getStat(WT_STAT_CONN_CACHE_BYTES_DIRTY);
+        auto max = getStat(WT_STAT_CONN_CACHE_BYTES_MAX);
+        if (!inUse.isOK() || !dirty.isOK() || !max.isOK() || max.getValue() <= 0) {
+            LOG(2) << "Unable to read WiredTiger cache statistics for the ticket controller";
+            return false;
+        }
+        sample->cacheUsedRatio = static_cast<double>(inUse.getValue()) / max.getValue();
+        sample->cacheDirtyRatio = static_cast<double>(dirty.getValue()) / max.getValue();
+        return true;
+    }
+
+    WT_CONNECTION* const _conn;
+    LatencyTotals _reads;
+    LatencyTotals _writes;
+
+    // _mutex/_condvar used to notify when _shuttingDown is flipped.
+    stdx::mutex _mutex;
+    stdx::condition_variable _condvar;
+    AtomicBool _shuttingDown{false};
+};
+
 WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
                                        const std::string& path,
                                        ClockSource* cs,
@@ -421,6 +559,16 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
         _checkpointThread->go();
     }
 
+    if (!_readOnly) {
+        _ticketControllerThread = stdx::make_unique<WiredTigerTicketControllerThread>(_conn);
+        _ticketControllerThread->go();
+    }
+
+    if (!_ephemeral) {
+        _readAhead = stdx::make_unique<WiredTigerReadAhead>(_sessionCache.get());
+        _readAhead->go();
+    }
+
     _sizeStorerUri = "table:sizeStorer";
     WiredTigerSession session(_conn);
     if (!_readOnly && repair && _hasUri(session.getSession(), _sizeStorerUri)) {
@@ -461,6 +609,12 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("totalTickets", openReadTransaction.outof());
         bbb.done();
     }
+    {
+        BSONObjBuilder bbb(bb.subobjStart("adaptive"));
+        bbb.append("enabled", wiredTigerConcurrentTransactionsAdaptive.load());
+        ticketController.append(&bbb);
+        bbb.done();
+    }
     bb.done();
 }
 
@@ -474,6 +628,10 @@ void WiredTigerKVEngine::cleanShutdown() {
             _journalFlusher->shutdown();
         if (_checkpointThread)
             _checkpointThread->shutdown();
+        if (_ticketControllerThread)
+            _ticketControllerThread->shutdown();
+        if (_readAhead)
+            _readAhead->shutdown();
         _sizeStorer.reset();
         _sessionCache->shuttingDown();
 
@@ -1092,4 +1250,18 @@ void WiredTigerKVEngine::replicationBatchIsComplete() const {
     }
 }
 
+double WiredTigerKVEngine::getCacheDirtyRatio() const {
+    WiredTigerSession session(_conn);
+    auto getStat = [&](int key) {
+        return WiredTigerUtil::getStatisticsValueAs<long long>(
+            session.getSession(), "statistics:", "statistics=(fast)", key);
+    };
+    auto dirty = getStat(WT_STAT_CONN_CACHE_BYTES_DIRTY);
+    auto max = getStat(WT_STAT_CONN_CACHE_BYTES_MAX);
+    if (!dirty.isOK() || !max.isOK() || max.getValue() <= 0) {
+        return 0;
+    }
+    return static_cast<double>(dirty.getValue()) / max.getValue();
+}
+
 }  // namespace mongo
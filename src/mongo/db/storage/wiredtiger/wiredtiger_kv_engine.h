@@ -49,6 +49,7 @@ namespace mongo {
 
 class ClockSource;
 class JournalListener;
+class WiredTigerReadAhead;
 class WiredTigerRecordStore;
 class WiredTigerSessionCache;
 class WiredTigerSizeStorer;
@@ -176,6 +177,14 @@ public:
     WT_CONNECTION* getConnection() {
         return _conn;
     }
+
+    /**
+     * Returns the thread that reads ahead of long record store scans, or nullptr for in-memory
+     * engines, which have nothing to read ahead.
+     */
+    WiredTigerReadAhead* getReadAhead() const {
+        return _readAhead.get();
+    }
     void dropSomeQueuedIdents();
     std::list<WiredTigerCachedCursor> filterCursorsWithQueuedDrops(
         std::list<WiredTigerCachedCursor>* cache);
@@ -207,6 +216,8 @@ public:
      */
     void replicationBatchIsComplete() const override;
 
+    double getCacheDirtyRatio() const override;
+
     /**
      * Sets the implementation for `initRsOplogBackgroundThread` (allowing tests to skip the
      * background job, for example). Intended to be called from a MONGO_INITIALIZER and therefroe in
@@ -227,6 +238,7 @@ public:
 private:
     class WiredTigerJournalFlusher;
     class WiredTigerCheckpointThread;
+    class WiredTigerTicketControllerThread;
 
     Status _salvageIfNeeded(const char* uri);
     void _checkIdentPath(StringData ident);
@@ -264,6 +276,8 @@ private:
     bool _readOnly;
     std::unique_ptr<WiredTigerJournalFlusher> _journalFlusher;  // Depends on _sizeStorer
     std::unique_ptr<WiredTigerCheckpointThread> _checkpointThread;
+    std::unique_ptr<WiredTigerTicketControllerThread> _ticketControllerThread;
+    std::unique_ptr<WiredTigerReadAhead> _readAhead;
 
     std::string _rsOptions;
     std::string _indexOptions;
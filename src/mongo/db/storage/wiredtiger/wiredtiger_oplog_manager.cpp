@@ -125,11 +125,17 @@ void WiredTigerOplogManager::waitForAllEarlierOplogWritesToBeVisible(
 }
 
 void WiredTigerOplogManager::triggerJournalFlush() {
-    stdx::lock_guard<stdx::mutex> lk(_oplogVisibilityStateMutex);
-    if (!_opsWaitingForJournal) {
-        _opsWaitingForJournal = true;
-        _opsWaitingForJournalCV.notify_one();
+    // Every commit of an oplog write calls this, so concurrent writers group-commit their
+    // visibility updates: only the first writer since the journal thread last picked up work takes
+    // the mutex to wake it, and everyone after that is covered by the same pending flush. The
+    // journal thread clears the flag with a swap before it reads all_committed, so a writer which
+    // finds the flag already set is guaranteed its commit will be seen by that read.
+    if (_opsWaitingForJournal.swap(true)) {
+        return;
     }
+
+    stdx::lock_guard<stdx::mutex> lk(_oplogVisibilityStateMutex);
+    _opsWaitingForJournalCV.notify_one();
 }
 
 void WiredTigerOplogManager::_oplogJournalThreadLoop(
@@ -143,8 +149,8 @@ void WiredTigerOplogManager::_oplogJournalThreadLoop(
         stdx::unique_lock<stdx::mutex> lk(_oplogVisibilityStateMutex);
         {
             MONGO_IDLE_THREAD_BLOCK;
-            _opsWaitingForJournalCV.wait(lk,
-                                         [&] { return _shuttingDown || _opsWaitingForJournal; });
+            _opsWaitingForJournalCV.wait(
+                lk, [&] { return _shuttingDown || _opsWaitingForJournal.load(); });
         }
 
         while (!_shuttingDown && MONGO_FAIL_POINT(WTPausePrimaryOplogDurabilityLoop)) {
@@ -157,7 +163,7 @@ void WiredTigerOplogManager::_oplogJournalThreadLoop(
             log() << "oplog journal thread loop shutting down";
             return;
         }
-        _opsWaitingForJournal = false;
+        _opsWaitingForJournal.swap(false);
         lk.unlock();
 
         char allCommittedTimestampBuf[TIMESTAMP_BUF_SIZE];
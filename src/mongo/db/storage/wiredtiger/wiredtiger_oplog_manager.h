@@ -59,6 +59,7 @@ public:
     void setOplogReadTimestamp(Timestamp ts);
 
     // Triggers the oplogJournal thread to update its oplog read timestamp, by flushing the journal.
+    // Calls made while a flush is already pending are folded into it without taking any locks.
     void triggerJournalFlush();
 
     // Waits until all committed writes at this point to become visible (that is, no holes exist in
@@ -90,7 +91,11 @@ private:
     // This is the RecordId of the newest oplog document in the oplog on startup.  It is used as a
     // floor in waitForAllEarlierOplogWritesToBeVisible().
     RecordId _oplogMaxAtStartup = RecordId(0);  // Guarded by oplogVisibilityStateMutex.
-    bool _opsWaitingForJournal = false;         // Guarded by oplogVisibilityStateMutex.
+
+    // Set by committing oplog writers and cleared by the journal thread when it starts a flush.
+    // Writers only take oplogVisibilityStateMutex, to signal the journal thread, when they are the
+    // ones to set it.
+    AtomicBool _opsWaitingForJournal{false};
 
     AtomicUInt64 _oplogReadTimestamp;
 };
@@ -0,0 +1,155 @@
+/**
+ *    Copyright 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_read_ahead.h"
+
+#include "mongo/db/client.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+const size_t WiredTigerReadAhead::kMaxQueuedRequests;
+
+WiredTigerReadAhead::WiredTigerReadAhead(WiredTigerSessionCache* sessionCache)
+    : BackgroundJob(false /* deleteSelf */), _sessionCache(sessionCache) {}
+
+void WiredTigerReadAhead::run() {
+    Client::initThread(name().c_str());
+
+    LOG(1) << "starting " << name() << " thread";
+
+    while (true) {
+        Request request;
+        {
+            stdx::unique_lock<stdx::mutex> lock(_mutex);
+            {
+                MONGO_IDLE_THREAD_BLOCK;
+                _condvar.wait(lock, [&] { return _shuttingDown || !_queue.empty(); });
+            }
+            if (_shuttingDown)
+                break;
+            request = std::move(_queue.front());
+            _queue.pop_front();
+        }
+
+        {
+            auto session = _sessionCache->getSession();
+            _readAhead(session.get(), request);
+        }
+        request.progress->done.store(true);
+    }
+
+    LOG(1) << "stopping " << name() << " thread";
+}
+
+bool WiredTigerReadAhead::schedule(Request request) {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    if (_shuttingDown || _queue.size() >= kMaxQueuedRequests)
+        return false;
+    _queue.push_back(std::move(request));
+    _condvar.notify_one();
+    return true;
+}
+
+void WiredTigerReadAhead::shutdown() {
+    {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        _shuttingDown = true;
+        for (auto&& request : _queue) {
+            request.progress->done.store(true);
+        }
+        _queue.clear();
+        _condvar.notify_one();
+    }
+    wait();
+}
+
+void WiredTigerReadAhead::_readAhead(WiredTigerSession* session, const Request& request) {
+    WT_CURSOR* c = session->getCursor(request.uri, request.tableId, true);
+    if (!c) {
+        // The table was dropped after the request was scheduled.
+        return;
+    }
+
+    const bool prefixed = request.prefix.isPrefixed();
+    if (!request.ids.empty()) {
+        // The ids are sorted, so the searches walk the btree in order.
+        for (const RecordId& id : request.ids) {
+            if (prefixed) {
+                c->set_key(c, request.prefix.repr(), id.repr());
+            } else {
+                c->set_key(c, id.repr());
+            }
+
+            // A record deleted since the request was scheduled is simply skipped.
+            WT_ITEM value;
+            if (c->search(c) == 0 && c->get_value(c, &value) == 0) {
+                request.progress->lastRecordId.store(id.repr());
+            }
+        }
+        session->releaseCursor(request.tableId, c);
+        return;
+    }
+
+    if (prefixed) {
+        c->set_key(c, request.prefix.repr(), request.start.repr());
+    } else {
+        c->set_key(c, request.start.repr());
+    }
+
+    // Any error, including WT_ROLLBACK under cache pressure, just ends the request early: reading
+    // ahead is only an optimization.
+    int exact;
+    int ret = c->search_near(c, &exact);
+    for (int i = 0; ret == 0 && i < request.numRecords; i++) {
+        std::int64_t prefix = request.prefix.repr();
+        std::int64_t recordId;
+        ret = prefixed ? c->get_key(c, &prefix, &recordId) : c->get_key(c, &recordId);
+        if (ret != 0 || prefix != request.prefix.repr())
+            break;
+
+        // Fetching the value also reads in any overflow item the record is stored in.
+        WT_ITEM value;
+        ret = c->get_value(c, &value);
+        if (ret != 0)
+            break;
+        request.progress->lastRecordId.store(recordId);
+
+        ret = request.forward ? c->next(c) : c->prev(c);
+    }
+
+    session->releaseCursor(request.tableId, c);
+}
+
+}  // namespace mongo
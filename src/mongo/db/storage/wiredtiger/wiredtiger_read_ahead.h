@@ -0,0 +1,114 @@
+/**
+ *    Copyright 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/db/record_id.h"
+#include "mongo/db/storage/kv/kv_prefix.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/background.h"
+
+namespace mongo {
+
+class WiredTigerSession;
+class WiredTigerSessionCache;
+
+/**
+ * Background thread that warms the WiredTiger cache ahead of long sequential record store scans.
+ *
+ * WiredTiger reads btree pages synchronously as a cursor reaches them and has no read-ahead of
+ * its own. A scanning cursor instead schedules requests to read a window of records past its
+ * position; this thread walks that window with its own session and cursor, so the pages are
+ * already in cache by the time the scan gets there.
+ *
+ * Requests only warm the cache and never return data, so they don't need to run in the scan's
+ * snapshot. Requests are dropped rather than queued without bound when the thread falls behind.
+ */
+class WiredTigerReadAhead : public BackgroundJob {
+public:
+    static const size_t kMaxQueuedRequests = 16;
+
+    /**
+     * Shared between a scanning cursor and this thread, so the cursor can tell whether the
+     * window it asked for has been read yet and where it ended.
+     */
+    struct Progress {
+        AtomicWord<bool> done{false};
+        AtomicInt64 lastRecordId{0};  // repr() of the last RecordId read, 0 if none.
+    };
+
+    struct Request {
+        std::string uri;
+        uint64_t tableId;
+        KVPrefix prefix = KVPrefix::kNotPrefixed;
+        RecordId start;
+        bool forward = true;
+        int numRecords = 0;
+        // If not empty, only these records are read, rather than a window from 'start'.
+        std::vector<RecordId> ids;
+        std::shared_ptr<Progress> progress;
+    };
+
+    explicit WiredTigerReadAhead(WiredTigerSessionCache* sessionCache);
+
+    std::string name() const override {
+        return "WTReadAhead";
+    }
+
+    void run() override;
+
+    /**
+     * Queues 'request'. Returns false without queuing it if the queue is full or the thread is
+     * shutting down.
+     */
+    bool schedule(Request request);
+
+    /**
+     * Stops the thread, discarding queued requests, and waits for it to exit.
+     */
+    void shutdown();
+
+private:
+    void _readAhead(WiredTigerSession* session, const Request& request);
+
+    WiredTigerSessionCache* const _sessionCache;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _condvar;
+    std::deque<Request> _queue;
+    bool _shuttingDown = false;
+};
+
+}  // namespace mongo
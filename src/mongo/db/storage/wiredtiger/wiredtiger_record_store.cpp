@@ -44,6 +44,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/repl_settings.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/oplog_hack.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
@@ -87,6 +88,28 @@ void checkOplogFormatVersion(OperationContext* opCtx, const std::string& uri) {
 MONGO_FP_DECLARE(WTWriteConflictException);
 MONGO_FP_DECLARE(WTWriteConflictExceptionForReads);
 
+// Number of records a cursor asks to be read ahead of its position once read-ahead is enabled.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerReadAheadRecords, int, 1000);
+
+// How getManyCursors() splits a collection: into at most wiredTigerParallelScanMaxCursors ranges
+// of RecordIds, each with at least wiredTigerParallelScanMinRecordsPerCursor records on average.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerParallelScanMaxCursors, int, 16);
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerParallelScanMinRecordsPerCursor, int, 10000);
+
+// Pacing of the oplog reclaim thread, see WiredTigerRecordStore::reclaimOplogPaced(). Pacing is
+// off by default because it lets the oplog run past its configured maximum size by up to
+// wiredTigerOplogReclaimBurstRatio of it.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerOplogReclaimIntervalMillis, int, 0);
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerOplogReclaimBurstRatio, double, 0.1);
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerOplogReclaimMaxCacheDirtyRatio, double, 0.15);
+
+// In-place updates are written with WT_CURSOR::modify, which only caches and logs the changed
+// bytes, when their damages cover at most wiredTigerModifyMaxDamageRatio of the record in at most
+// wiredTigerModifyMaxEntries pieces. Larger updates overwrite the whole record, which is cheaper
+// for WiredTiger to read back than a long chain of modifications.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerModifyMaxDamageRatio, double, 0.25);
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerModifyMaxEntries, int, 16);
+
 const std::string kWiredTigerEngineName = "wiredTiger";
 
 class WiredTigerRecordStore::OplogInsertChange final : public RecoveryUnit::Change {
@@ -1063,45 +1086,100 @@ bool WiredTigerRecordStore::yieldAndAwaitOplogDeletionRequest(OperationContext*
 }
 
 void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx) {
-    while (auto stone = _oplogStones->peekOldestStoneIfNeeded()) {
-        invariant(stone->lastRecord.isNormal());
+    while (_reclaimOldestOplogStone(opCtx)) {
+    }
+
+    LOG(1) << "Finished truncating the oplog, it now contains approximately " << _numRecords.load()
+           << " records totaling to " << _dataSize.load() << " bytes";
+}
 
-        LOG(1) << "Truncating the oplog between " << _oplogStones->firstRecord << " and "
-               << stone->lastRecord << " to remove approximately " << stone->records
-               << " records totaling to " << stone->bytes << " bytes";
+Milliseconds WiredTigerRecordStore::reclaimOplogPaced(OperationContext* opCtx) {
+    const Milliseconds interval(wiredTigerOplogReclaimIntervalMillis.load());
+    const int64_t burstAllowance =
+        static_cast<int64_t>(_cappedMaxSize * wiredTigerOplogReclaimBurstRatio.load());
 
-        WiredTigerRecoveryUnit* ru = WiredTigerRecoveryUnit::get(opCtx);
-        WT_SESSION* session = ru->getSession(opCtx)->getSession();
+    if (interval <= Milliseconds(0)) {
+        reclaimOplog(opCtx);
+        return Milliseconds(0);
+    }
 
-        try {
-            WriteUnitOfWork wuow(opCtx);
+    if (_oplogStones->excessBytes() > burstAllowance) {
+        // Reclaim is falling too far behind the inserts; catch up now rather than let the oplog
+        // keep growing.
+        _oplogReclaimStats.burstOverflows.fetchAndAdd(1);
+        reclaimOplog(opCtx);
+        return Milliseconds(0);
+    }
 
-            WiredTigerCursor startwrap(_uri, _tableId, true, opCtx);
-            WT_CURSOR* start = startwrap.get();
-            setKey(start, _oplogStones->firstRecord);
+    if (_cacheTooDirtyForOplogReclaim(opCtx)) {
+        _oplogReclaimStats.cacheDirtyDeferrals.fetchAndAdd(1);
+        return interval;
+    }
 
-            WiredTigerCursor endwrap(_uri, _tableId, true, opCtx);
-            WT_CURSOR* end = endwrap.get();
-            setKey(end, stone->lastRecord);
+    _reclaimOldestOplogStone(opCtx);
+    return _oplogStones->excessBytes() > 0 ? interval : Milliseconds(0);
+}
 
-            invariantWTOK(session->truncate(session, nullptr, start, end, nullptr));
-            _changeNumRecords(opCtx, -stone->records);
-            _increaseDataSize(opCtx, -stone->bytes);
+bool WiredTigerRecordStore::_reclaimOldestOplogStone(OperationContext* opCtx) {
+    auto stone = _oplogStones->peekOldestStoneIfNeeded();
+    if (!stone) {
+        return false;
+    }
+    invariant(stone->lastRecord.isNormal());
 
-            wuow.commit();
+    LOG(1) << "Truncating the oplog between " << _oplogStones->firstRecord << " and "
+           << stone->lastRecord << " to remove approximately " << stone->records
+           << " records totaling to " << stone->bytes << " bytes";
 
-            // Remove the stone after a successful truncation.
-            _oplogStones->popOldestStone();
+    WiredTigerRecoveryUnit* ru = WiredTigerRecoveryUnit::get(opCtx);
+    WT_SESSION* session = ru->getSession(opCtx)->getSession();
 
-            // Stash the truncate point for next time to cleanly skip over tombstones, etc.
-            _oplogStones->firstRecord = stone->lastRecord;
-        } catch (const WriteConflictException& wce) {
-            LOG(1) << "Caught WriteConflictException while truncating oplog entries, retrying";
-        }
+    try {
+        WriteUnitOfWork wuow(opCtx);
+
+        WiredTigerCursor startwrap(_uri, _tableId, true, opCtx);
+        WT_CURSOR* start = startwrap.get();
+        setKey(start, _oplogStones->firstRecord);
+
+        WiredTigerCursor endwrap(_uri, _tableId, true, opCtx);
+        WT_CURSOR* end = endwrap.get();
+        setKey(end, stone->lastRecord);
+
+        invariantWTOK(session->truncate(session, nullptr, start, end, nullptr));
+        _changeNumRecords(opCtx, -stone->records);
+        _increaseDataSize(opCtx, -stone->bytes);
+
+        wuow.commit();
+
+        // Remove the stone after a successful truncation.
+        _oplogStones->popOldestStone();
+
+        // Stash the truncate point for next time to cleanly skip over tombstones, etc.
+        _oplogStones->firstRecord = stone->lastRecord;
+
+        _oplogReclaimStats.stonesTruncated.fetchAndAdd(1);
+        _oplogReclaimStats.bytesTruncated.fetchAndAdd(stone->bytes);
+    } catch (const WriteConflictException& wce) {
+        LOG(1) << "Caught WriteConflictException while truncating oplog entries, retrying";
     }
+    return true;
+}
 
-    LOG(1) << "Finished truncating the oplog, it now contains approximately " << _numRecords.load()
-           << " records totaling to " << _dataSize.load() << " bytes";
+bool WiredTigerRecordStore::_cacheTooDirtyForOplogReclaim(OperationContext* opCtx) const {
+    const double maxDirtyRatio = wiredTigerOplogReclaimMaxCacheDirtyRatio.load();
+    if (maxDirtyRatio <= 0 || maxDirtyRatio >= 1) {
+        return false;
+    }
+
+    WT_SESSION* session = WiredTigerRecoveryUnit::get(opCtx)->getSessionNoTxn(opCtx)->getSession();
+    auto dirty = WiredTigerUtil::getStatisticsValueAs<long long>(
+        session, "statistics:", "statistics=(fast)", WT_STAT_CONN_CACHE_BYTES_DIRTY);
+    auto max = WiredTigerUtil::getStatisticsValueAs<long long>(
+        session, "statistics:", "statistics=(fast)", WT_STAT_CONN_CACHE_BYTES_MAX);
+    if (!dirty.isOK() || !max.isOK() || max.getValue() <= 0) {
+        return false;
+    }
+    return static_cast<double>(dirty.getValue()) / max.getValue() > maxDirtyRatio;
 }
 
 Status WiredTigerRecordStore::insertRecords(OperationContext* opCtx,
@@ -1138,23 +1216,28 @@ Status WiredTigerRecordStore::_insertRecords(OperationContext* opCtx,
 
     RecordId highestId = RecordId();
     dassert(nRecords != 0);
-    for (size_t i = 0; i < nRecords; i++) {
-        auto& record = records[i];
-        if (_isOplog) {
+    if (_isOplog) {
+        for (size_t i = 0; i < nRecords; i++) {
+            auto& record = records[i];
             StatusWith<RecordId> status =
                 oploghack::extractKey(record.data.data(), record.data.size());
             if (!status.isOK())
                 return status.getStatus();
             record.id = status.getValue();
-        } else if (_isCapped) {
-            record.id = _nextId();
-        } else {
-            record.id = _nextId();
+            dassert(record.id > highestId);
+            highestId = record.id;
+        }
+    } else {
+        // Reserve the whole batch's RecordIds at once. They are contiguous and ascending, so the
+        // inserts below walk the end of the table in order.
+        const int64_t firstId = _reserveIds(nRecords).repr();
+        for (size_t i = 0; i < nRecords; i++) {
+            records[i].id = RecordId(firstId + static_cast<int64_t>(i));
         }
-        dassert(record.id > highestId);
-        highestId = record.id;
+        highestId = records[nRecords - 1].id;
     }
 
+    Timestamp lastTimestamp;
     for (size_t i = 0; i < nRecords; i++) {
         auto& record = records[i];
         Timestamp ts;
@@ -1167,8 +1250,9 @@ Status WiredTigerRecordStore::_insertRecords(OperationContext* opCtx,
             ts = timestamps[i];
         }
         LOG(4) << "inserting record with timestamp " << ts.asULL();
-        if (!ts.isNull()) {
+        if (!ts.isNull() && ts != lastTimestamp) {
             fassertStatusOK(39001, opCtx->recoveryUnit()->setTimestamp(SnapshotName(ts)));
+            lastTimestamp = ts;
         }
         setKey(c, record.id);
         WiredTigerItem value(record.data.data(), record.data.size());
@@ -1304,6 +1388,16 @@ StatusWith<RecordData> WiredTigerRecordStore::updateWithDamages(
     const mutablebson::DamageVector& damages) {
 
     const int nentries = damages.size();
+
+    size_t damagedBytes = 0;
+    for (const auto& damage : damages) {
+        damagedBytes += damage.size;
+    }
+    if (nentries > wiredTigerModifyMaxEntries.load() ||
+        damagedBytes > wiredTigerModifyMaxDamageRatio.load() * oldRec.size()) {
+        return _updateWithDamagesByOverwrite(opCtx, id, oldRec, damageSource, damages);
+    }
+
     mutablebson::DamageVector::const_iterator where = damages.begin();
     const mutablebson::DamageVector::const_iterator end = damages.cend();
     std::vector<WT_MODIFY> entries(nentries);
@@ -1332,6 +1426,33 @@ StatusWith<RecordData> WiredTigerRecordStore::updateWithDamages(
     return RecordData(static_cast<const char*>(value.data), value.size).getOwned();
 }
 
+StatusWith<RecordData> WiredTigerRecordStore::_updateWithDamagesByOverwrite(
+    OperationContext* opCtx,
+    const RecordId& id,
+    const RecordData& oldRec,
+    const char* damageSource,
+    const mutablebson::DamageVector& damages) {
+    auto buffer = SharedBuffer::allocate(oldRec.size());
+    std::memcpy(buffer.get(), oldRec.data(), oldRec.size());
+    for (const auto& damage : damages) {
+        std::memcpy(
+            buffer.get() + damage.targetOffset, damageSource + damage.sourceOffset, damage.size);
+    }
+    RecordData newRec(std::move(buffer), oldRec.size());
+
+    // Damages never change the size of the record, so there is no data size to account for.
+    WiredTigerCursor curwrap(_uri, _tableId, true, opCtx);
+    curwrap.assertInActiveTxn();
+    WT_CURSOR* c = curwrap.get();
+    invariant(c);
+    setKey(c, id);
+    WiredTigerItem value(newRec.data(), newRec.size());
+    c->set_value(c, value.Get());
+    invariantWTOK(WT_OP_CHECK(c->insert(c)));
+
+    return newRec;
+}
+
 std::unique_ptr<RecordCursor> WiredTigerRecordStore::getRandomCursor(
     OperationContext* opCtx) const {
     const char* extraConfig = "";
@@ -1340,8 +1461,37 @@ std::unique_ptr<RecordCursor> WiredTigerRecordStore::getRandomCursor(
 
 std::vector<std::unique_ptr<RecordCursor>> WiredTigerRecordStore::getManyCursors(
     OperationContext* opCtx) const {
-    std::vector<std::unique_ptr<RecordCursor>> cursors(1);
-    cursors[0] = getCursor(opCtx, /*forward=*/true);
+    std::vector<std::unique_ptr<RecordCursor>> cursors;
+
+    const long long minRecordsPerCursor =
+        std::max(wiredTigerParallelScanMinRecordsPerCursor.load(), 1);
+    const long long numCursors = std::min<long long>(
+        numRecords(opCtx) / minRecordsPerCursor, wiredTigerParallelScanMaxCursors.load());
+
+    // Capped collections and the oplog must be read in insertion order by a single cursor.
+    boost::optional<Record> first;
+    boost::optional<Record> last;
+    if (!_isCapped && numCursors > 1) {
+        first = getCursor(opCtx, /*forward=*/true)->next();
+        last = getCursor(opCtx, /*forward=*/false)->next();
+    }
+    if (!first || !last || last->id.repr() - first->id.repr() < numCursors) {
+        cursors.push_back(getCursor(opCtx, /*forward=*/true));
+        return cursors;
+    }
+
+    // Split the ids between the first and last record evenly. The first and last ranges are
+    // unbounded, so records inserted outside of [first, last] are still seen.
+    const long long step = (last->id.repr() - first->id.repr()) / numCursors + 1;
+    for (long long i = 0; i < numCursors; ++i) {
+        const RecordId start = i == 0 ? RecordId() : RecordId(first->id.repr() + i * step);
+        const RecordId end =
+            i == numCursors - 1 ? RecordId() : RecordId(first->id.repr() + (i + 1) * step);
+
+        auto cursor = getCursor(opCtx, /*forward=*/true);
+        checked_cast<WiredTigerRecordStoreCursorBase*>(cursor.get())->restrictToRange(start, end);
+        cursors.push_back(std::move(cursor));
+    }
     return cursors;
 }
 
@@ -1457,6 +1607,18 @@ void WiredTigerRecordStore::appendCustomStats(OperationContext* opCtx,
         result->appendIntOrLL("sleepCount", _cappedSleep.load());
         result->appendIntOrLL("sleepMS", _cappedSleepMS.load());
     }
+    if (_oplogStones) {
+        BSONObjBuilder reclaim(result->subobjStart("oplogReclaim"));
+        reclaim.appendNumber("excessBytes",
+                             static_cast<long long>(
+                                 std::max(_oplogStones->excessBytes(), int64_t(0)) / scale));
+        reclaim.appendNumber("stonesTruncated", _oplogReclaimStats.stonesTruncated.load());
+        reclaim.appendNumber("bytesTruncated",
+                             static_cast<long long>(_oplogReclaimStats.bytesTruncated.load() /
+                                                    scale));
+        reclaim.appendNumber("cacheDirtyDeferrals", _oplogReclaimStats.cacheDirtyDeferrals.load());
+        reclaim.appendNumber("burstOverflows", _oplogReclaimStats.burstOverflows.load());
+    }
     WiredTigerSession* session = WiredTigerRecoveryUnit::get(opCtx)->getSession(opCtx);
     WT_SESSION* s = session->getSession();
     BSONObjBuilder bob(result->subobjStart(_engineName));
@@ -1485,6 +1647,16 @@ void WiredTigerRecordStore::appendCustomStats(OperationContext* opCtx,
         bob.append("type", type);
     }
 
+    {
+        BSONObjBuilder readAhead(bob.subobjStart("readAhead"));
+        readAhead.append("requests", _readAheadStats.requests.load());
+        readAhead.append("hits", _readAheadStats.hits.load());
+        readAhead.append("misses", _readAheadStats.misses.load());
+        readAhead.append("dropped", _readAheadStats.dropped.load());
+        readAhead.append("prefetches", _readAheadStats.prefetches.load());
+        readAhead.append("prefetchesDropped", _readAheadStats.prefetchesDropped.load());
+    }
+
     Status status =
         WiredTigerUtil::exportTableToBSON(s, "statistics:" + getURI(), "statistics=(fast)", &bob);
     if (!status.isOK()) {
@@ -1544,10 +1716,12 @@ void WiredTigerRecordStore::updateStatsAfterRepair(OperationContext* opCtx,
     }
 }
 
-RecordId WiredTigerRecordStore::_nextId() {
+RecordId WiredTigerRecordStore::_reserveIds(size_t numIds) {
     invariant(!_isOplog);
-    RecordId out = RecordId(_nextIdNum.fetchAndAdd(1));
+    invariant(numIds > 0);
+    RecordId out = RecordId(_nextIdNum.fetchAndAdd(numIds));
     invariant(out.isNormal());
+    invariant(RecordId(out.repr() + static_cast<int64_t>(numIds) - 1).isNormal());
     return out;
 }
 
@@ -1703,31 +1877,61 @@ WiredTigerRecordStoreCursorBase::WiredTigerRecordStoreCursorBase(OperationContex
 }
 
 boost::optional<Record> WiredTigerRecordStoreCursorBase::next() {
-    if (_eof)
+    RecordId id;
+    WT_ITEM value;
+    if (!_advance(&id, &value))
         return {};
+    return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
+}
 
-    WT_CURSOR* c = _cursor->get();
+size_t WiredTigerRecordStoreCursorBase::nextBatch(std::vector<Record>* out, size_t maxRecords) {
+    out->reserve(out->size() + maxRecords);
 
+    size_t numAppended = 0;
     RecordId id;
+    WT_ITEM value;
+    while (numAppended < maxRecords && _advance(&id, &value)) {
+        // The value is only valid until the cursor moves again, so copy it out now.
+        const int size = static_cast<int>(value.size);
+        auto buffer = SharedBuffer::allocate(size);
+        memcpy(buffer.get(), value.data, size);
+        out->push_back({id, RecordData(std::move(buffer), size)});
+        ++numAppended;
+    }
+    return numAppended;
+}
+
+bool WiredTigerRecordStoreCursorBase::_advance(RecordId* id, WT_ITEM* value) {
+    if (_eof)
+        return false;
+
+    WT_CURSOR* c = _cursor->get();
+
+    *id = RecordId();
     if (!_skipNextAdvance) {
         // Nothing after the next line can throw WCEs.
         // Note that an unpositioned (or eof) WT_CURSOR returns the first/last entry in the
         // table when you call next/prev.
         int advanceRet = WT_READ_CHECK(_forward ? c->next(c) : c->prev(c));
-        if (advanceRet == WT_NOTFOUND || hasWrongPrefix(c, &id)) {
+        if (advanceRet == WT_NOTFOUND || hasWrongPrefix(c, id)) {
             _eof = true;
-            return {};
+            return false;
         }
         invariantWTOK(advanceRet);
     }
 
     _skipNextAdvance = false;
-    if (!id.isNormal()) {
-        id = getKey(c);
+    if (!id->isNormal()) {
+        *id = getKey(c);
+    }
+
+    if (!_rangeEnd.isNull() && *id >= _rangeEnd) {
+        _eof = true;
+        return false;
     }
 
-    if (_forward && _lastReturnedId >= id) {
-        log() << "WTCursor::next -- c->next_key ( " << id
+    if (_forward && _lastReturnedId >= *id) {
+        log() << "WTCursor::next -- c->next_key ( " << *id
               << ") was not greater than _lastReturnedId (" << _lastReturnedId
               << ") which is a bug.";
         // Force a retry of the operation from our last known position by acting as-if
@@ -1735,11 +1939,81 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::next() {
         throw WriteConflictException();
     }
 
-    WT_ITEM value;
-    invariantWTOK(c->get_value(c, &value));
+    invariantWTOK(c->get_value(c, value));
 
-    _lastReturnedId = id;
-    return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
+    _lastReturnedId = *id;
+    if (_readAheadRecords > 0) {
+        _maybeReadAhead(*id);
+    }
+    return true;
+}
+
+void WiredTigerRecordStoreCursorBase::enableReadAhead() {
+    if (!_rs._kvEngine || !_rs._kvEngine->getReadAhead())
+        return;
+    _readAheadRecords = std::max(wiredTigerReadAheadRecords.load(), 0);
+    _recordsUntilReadAheadCheck = 0;
+}
+
+void WiredTigerRecordStoreCursorBase::_maybeReadAhead(const RecordId& id) {
+    if (--_recordsUntilReadAheadCheck > 0)
+        return;
+    _recordsUntilReadAheadCheck = std::max(_readAheadRecords / 2, 1);
+
+    WiredTigerReadAhead::Request request;
+    request.start = id;
+    if (_readAheadProgress) {
+        if (!_readAheadProgress->done.load()) {
+            // The last window is still being read; don't pile more work on the thread.
+            _rs._readAheadStats.misses.fetchAndAdd(1);
+            return;
+        }
+        _rs._readAheadStats.hits.fetchAndAdd(1);
+
+        // Continue from where the last window ended unless the scan has already passed it.
+        const RecordId lastRead(_readAheadProgress->lastRecordId.load());
+        if (lastRead.isNormal() && (_forward ? lastRead > id : lastRead < id)) {
+            request.start = lastRead;
+        }
+    }
+
+    request.uri = _rs.getURI();
+    request.tableId = _rs.tableId();
+    request.prefix = _rs.getPrefix();
+    request.forward = _forward;
+    request.numRecords = _readAheadRecords;
+    request.progress = std::make_shared<WiredTigerReadAhead::Progress>();
+
+    auto progress = request.progress;
+    if (!_rs._kvEngine->getReadAhead()->schedule(std::move(request))) {
+        _rs._readAheadStats.dropped.fetchAndAdd(1);
+        _readAheadProgress.reset();
+        return;
+    }
+    _rs._readAheadStats.requests.fetchAndAdd(1);
+    _readAheadProgress = std::move(progress);
+}
+
+bool WiredTigerRecordStoreCursorBase::prefetch(const std::vector<RecordId>& ids) {
+    if (!_rs._kvEngine || !_rs._kvEngine->getReadAhead())
+        return false;
+    if (ids.empty())
+        return true;
+
+    WiredTigerReadAhead::Request request;
+    request.uri = _rs.getURI();
+    request.tableId = _rs.tableId();
+    request.prefix = _rs.getPrefix();
+    request.ids = ids;
+    request.progress = std::make_shared<WiredTigerReadAhead::Progress>();
+
+    // A dropped batch is just read synchronously by the seeks that follow.
+    if (!_rs._kvEngine->getReadAhead()->schedule(std::move(request))) {
+        _rs._readAheadStats.prefetchesDropped.fetchAndAdd(1);
+        return true;
+    }
+    _rs._readAheadStats.prefetches.fetchAndAdd(1);
+    return true;
 }
 
 boost::optional<Record> WiredTigerRecordStoreCursorBase::seekExact(const RecordId& id) {
@@ -1763,6 +2037,19 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::seekExact(const RecordI
     return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
 }
 
+void WiredTigerRecordStoreCursorBase::restrictToRange(const RecordId& start, const RecordId& end) {
+    invariant(_forward);
+    invariant(_lastReturnedId.isNull());
+    _rangeEnd = end;
+    if (start.isNull()) {
+        return;
+    }
+
+    // Position the cursor as if it had just returned the id before 'start', so the next record
+    // it returns is the first one in the range.
+    _lastReturnedId = RecordId(start.repr() - 1);
+    restore();
+}
 
 void WiredTigerRecordStoreCursorBase::save() {
     try {
@@ -40,6 +40,7 @@
 #include "mongo/db/storage/kv/kv_prefix.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_read_ahead.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
@@ -239,6 +240,10 @@ public:
         return _tableId;
     }
 
+    virtual KVPrefix getPrefix() const {
+        return KVPrefix::kNotPrefixed;
+    }
+
     void setSizeStorer(WiredTigerSizeStorer* ss) {
         _sizeStorer = ss;
     }
@@ -247,8 +252,22 @@ public:
 
     bool inShutdown() const;
 
+    /**
+     * Truncates the oldest oplog stones until the oplog is back within its maximum size.
+     */
     void reclaimOplog(OperationContext* opCtx);
 
+    /**
+     * Truncates the oplog gradually, at most one stone per call, and returns how long the caller
+     * should wait before calling again. Zero means the oplog is within its maximum size.
+     *
+     * While paced, the oplog may run over its maximum size by up to
+     * wiredTigerOplogReclaimBurstRatio of it, and stones are not truncated while the WiredTiger
+     * cache is dirtier than wiredTigerOplogReclaimMaxCacheDirtyRatio. Beyond the burst allowance,
+     * or when wiredTigerOplogReclaimIntervalMillis is 0, this behaves like reclaimOplog().
+     */
+    Milliseconds reclaimOplogPaced(OperationContext* opCtx);
+
     int64_t cappedDeleteAsNeeded(OperationContext* opCtx, const RecordId& justInserted);
 
     int64_t cappedDeleteAsNeeded_inlock(OperationContext* opCtx, const RecordId& justInserted);
@@ -297,13 +316,30 @@ private:
                           const Timestamp* timestamps,
                           size_t nRecords);
 
-    RecordId _nextId();
+    /**
+     * Reserves 'numIds' consecutive RecordIds and returns the first of them.
+     */
+    RecordId _reserveIds(size_t numIds);
     void _setId(RecordId id);
     bool cappedAndNeedDelete() const;
     void _changeNumRecords(OperationContext* opCtx, int64_t diff);
     void _increaseDataSize(OperationContext* opCtx, int64_t amount);
     RecordData _getData(const WiredTigerCursor& cursor) const;
 
+    // Applies 'damages' to a copy of 'oldRec' and writes it over the record.
+    StatusWith<RecordData> _updateWithDamagesByOverwrite(OperationContext* opCtx,
+                                                         const RecordId& id,
+                                                         const RecordData& oldRec,
+                                                         const char* damageSource,
+                                                         const mutablebson::DamageVector& damages);
+
+    // Truncates the oldest oplog stone if the oplog is over its maximum size. Returns false if
+    // there was nothing to truncate.
+    bool _reclaimOldestOplogStone(OperationContext* opCtx);
+
+    // Returns true if the WiredTiger cache is too dirty for a paced oplog truncation.
+    bool _cacheTooDirtyForOplogReclaim(OperationContext* opCtx) const;
+
 
     const std::string _uri;
     const uint64_t _tableId;  // not persisted
@@ -322,6 +358,15 @@ private:
     RecordId _cappedFirstRecord;
     AtomicInt64 _cappedSleep;
     AtomicInt64 _cappedSleepMS;
+
+    // Oplog reclaim counters, reported by collStats.
+    struct OplogReclaimStats {
+        AtomicInt64 stonesTruncated;
+        AtomicInt64 bytesTruncated;
+        AtomicInt64 cacheDirtyDeferrals;  // Paced truncations skipped because of cache pressure.
+        AtomicInt64 burstOverflows;       // Times the burst allowance ran out while paced.
+    };
+    OplogReclaimStats _oplogReclaimStats;
     CappedCallback* _cappedCallback;
     bool _shuttingDown;
     stdx::mutex _cappedCallbackMutex;  // guards _cappedCallback and _shuttingDown
@@ -339,6 +384,19 @@ private:
 
     WiredTigerKVEngine* _kvEngine;  // not owned.
 
+    // Counters for cursors reading ahead of their scans, reported by collStats. A hit is a window
+    // that had been read by the time its scan was halfway through the previous one. Prefetches
+    // are batches of ids that a cursor is about to seek to.
+    struct ReadAheadStats {
+        AtomicInt64 requests;
+        AtomicInt64 hits;
+        AtomicInt64 misses;
+        AtomicInt64 dropped;
+        AtomicInt64 prefetches;
+        AtomicInt64 prefetchesDropped;
+    };
+    mutable ReadAheadStats _readAheadStats;
+
     // Non-null if this record store is underlying the active oplog.
     std::shared_ptr<OplogStones> _oplogStones;
 };
@@ -414,8 +472,20 @@ public:
 
     boost::optional<Record> next();
 
+    size_t nextBatch(std::vector<Record>* out, size_t maxRecords);
+
+    void enableReadAhead();
+
     boost::optional<Record> seekExact(const RecordId& id);
 
+    bool prefetch(const std::vector<RecordId>& ids);
+
+    /**
+     * Limits a forward cursor that has not yet returned a record to ids in [start, end). A null
+     * 'start' or 'end' leaves that side unbounded. seekExact() ignores the range.
+     */
+    void restrictToRange(const RecordId& start, const RecordId& end);
+
     void save();
 
     void saveUnpositioned();
@@ -452,9 +522,26 @@ protected:
     boost::optional<WiredTigerCursor> _cursor;
     bool _eof = false;
     RecordId _lastReturnedId;  // If null, need to seek to first/last record.
+    RecordId _rangeEnd;        // If not null, the scan stops before this record.
 
 private:
     bool isVisible(const RecordId& id);
+
+    /**
+     * Moves the cursor one record in the scan direction. Returns false at EOF; otherwise fills in
+     * 'id' and 'value', which is only valid until the cursor next moves.
+     */
+    bool _advance(RecordId* id, WT_ITEM* value);
+
+    /**
+     * Called with each record returned while reading ahead. Every half window, checks whether the
+     * last read-ahead request finished and, if so, schedules the next one.
+     */
+    void _maybeReadAhead(const RecordId& id);
+
+    int _readAheadRecords = 0;  // Read-ahead window, in records. 0 if not reading ahead.
+    int _recordsUntilReadAheadCheck = 0;
+    std::shared_ptr<WiredTigerReadAhead::Progress> _readAheadProgress;
 };
 
 class WiredTigerRecordStoreStandardCursor final : public WiredTigerRecordStoreCursorBase {
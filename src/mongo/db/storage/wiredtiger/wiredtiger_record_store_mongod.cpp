@@ -69,9 +69,10 @@ public:
     }
 
     /**
-     * Returns true iff there was an oplog to delete from.
+     * Returns true iff there was an oplog to delete from. Sets 'wait' to how long to pause before
+     * the next round of deletions.
      */
-    bool _deleteExcessDocuments() {
+    bool _deleteExcessDocuments(Milliseconds* wait) {
         if (!getGlobalServiceContext()->getGlobalStorageEngine()) {
             LOG(2) << "no global storage engine yet";
             return false;
@@ -102,7 +103,7 @@ public:
             if (!rs->yieldAndAwaitOplogDeletionRequest(&opCtx)) {
                 return false;  // Oplog went away.
             }
-            rs->reclaimOplog(&opCtx);
+            *wait = rs->reclaimOplogPaced(&opCtx);
         } catch (const std::exception& e) {
             severe() << "error in WiredTigerRecordStoreThread: " << e.what();
             fassertFailedNoTrace(!"error in WiredTigerRecordStoreThread");
@@ -116,8 +117,12 @@ public:
         Client::initThread(_name.c_str());
 
         while (!globalInShutdownDeprecated()) {
-            if (!_deleteExcessDocuments()) {
+            Milliseconds wait(0);
+            if (!_deleteExcessDocuments(&wait)) {
                 sleepmillis(1000);  // Back off in case there were problems deleting.
+            } else if (wait > Milliseconds(0)) {
+                // Pace truncation; no locks are held here.
+                sleepmillis(durationCount<Milliseconds>(wait));
             }
         }
     }
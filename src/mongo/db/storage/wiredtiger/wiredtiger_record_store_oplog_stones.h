@@ -58,13 +58,24 @@ public:
     void kill();
 
     bool hasExcessStones_inlock() const {
+        return excessBytes_inlock() > 0;
+    }
+
+    // Returns by how many bytes the full stones exceed the oplog's maximum size; zero or negative
+    // if they don't.
+    int64_t excessBytes_inlock() const {
         int64_t total_bytes = 0;
         for (std::deque<OplogStones::Stone>::const_iterator it = _stones.begin();
              it != _stones.end();
              ++it) {
             total_bytes += it->bytes;
         }
-        return total_bytes > _rs->cappedMaxSize();
+        return total_bytes - _rs->cappedMaxSize();
+    }
+
+    int64_t excessBytes() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return excessBytes_inlock();
     }
 
     void awaitHasExcessStonesOrDead();
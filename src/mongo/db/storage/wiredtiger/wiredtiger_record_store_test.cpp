@@ -36,10 +36,12 @@
 #include "mongo/base/checked_cast.h"
 #include "mongo/base/init.h"
 #include "mongo/base/string_data.h"
+#include "mongo/bson/mutable/damage_vector.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/json.h"
 #include "mongo/db/operation_context_noop.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/kv/kv_prefix.h"
 #include "mongo/db/storage/record_store_test_harness.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
@@ -806,6 +808,82 @@ TEST(WiredTigerRecordStoreTest, OplogStones_ReclaimStones) {
     }
 }
 
+// Verify that paced reclaiming truncates one oplog stone per call while within the burst allowance.
+TEST(WiredTigerRecordStoreTest, OplogStones_ReclaimStonesPaced) {
+    auto& params = ServerParameterSet::getGlobal()->getMap();
+    ASSERT_OK(params.at("wiredTigerOplogReclaimIntervalMillis")->setFromString("100"));
+    ASSERT_OK(params.at("wiredTigerOplogReclaimBurstRatio")->setFromString("10"));
+    ASSERT_OK(params.at("wiredTigerOplogReclaimMaxCacheDirtyRatio")->setFromString("1"));
+    ON_BLOCK_EXIT([&] {
+        params.at("wiredTigerOplogReclaimIntervalMillis")->setFromString("0").transitional_ignore();
+        params.at("wiredTigerOplogReclaimBurstRatio")->setFromString("0.1").transitional_ignore();
+        params.at("wiredTigerOplogReclaimMaxCacheDirtyRatio")
+            ->setFromString("0.15")
+            .transitional_ignore();
+    });
+
+    std::unique_ptr<RecordStoreHarnessHelper> harnessHelper = newRecordStoreHarnessHelper();
+
+    const int64_t cappedMaxSize = 10 * 1024;  // 10KB
+    unique_ptr<RecordStore> rs(
+        harnessHelper->newCappedRecordStore("local.oplog.stones", cappedMaxSize, -1));
+
+    WiredTigerRecordStore* wtrs = static_cast<WiredTigerRecordStore*>(rs.get());
+    WiredTigerRecordStore::OplogStones* oplogStones = wtrs->oplogStones();
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        ASSERT_OK(wtrs->updateCappedSize(opCtx.get(), 230U));
+    }
+
+    oplogStones->setMinBytesPerStone(100);
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 1), 100), RecordId(1, 1));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 2), 110), RecordId(1, 2));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 3), 120), RecordId(1, 3));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 4), 130), RecordId(1, 4));
+
+        ASSERT_EQ(4U, oplogStones->numStones());
+        ASSERT_EQ(230, oplogStones->excessBytes());
+    }
+
+    // Each call truncates a single stone and asks to be called again while excess remains.
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+        ASSERT_EQ(Milliseconds(100), wtrs->reclaimOplogPaced(opCtx.get()));
+        ASSERT_EQ(3, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(3U, oplogStones->numStones());
+
+        ASSERT_EQ(Milliseconds(100), wtrs->reclaimOplogPaced(opCtx.get()));
+        ASSERT_EQ(2, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(2U, oplogStones->numStones());
+
+        ASSERT_EQ(Milliseconds(0), wtrs->reclaimOplogPaced(opCtx.get()));
+        ASSERT_EQ(1, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(130, rs->dataSize(opCtx.get()));
+        ASSERT_EQ(1U, oplogStones->numStones());
+    }
+
+    // Beyond the burst allowance, all excess stones are truncated at once.
+    ASSERT_OK(params.at("wiredTigerOplogReclaimBurstRatio")->setFromString("0"));
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 5), 140), RecordId(1, 5));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 6), 150), RecordId(1, 6));
+        ASSERT_EQ(3U, oplogStones->numStones());
+
+        ASSERT_EQ(Milliseconds(0), wtrs->reclaimOplogPaced(opCtx.get()));
+        ASSERT_EQ(1, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(150, rs->dataSize(opCtx.get()));
+        ASSERT_EQ(1U, oplogStones->numStones());
+    }
+}
+
 // Verify that an oplog stone isn't created if it would cause the logical representation of the
 // records to not be in increasing order.
 TEST(WiredTigerRecordStoreTest, OplogStones_AscendingOrder) {
@@ -853,5 +931,56 @@ TEST(WiredTigerRecordStoreTest, OplogStones_AscendingOrder) {
     }
 }
 
+// Small in-place updates go through WT_CURSOR::modify and large ones overwrite the record, with
+// the same result.
+TEST(WiredTigerRecordStoreTest, UpdateWithDamagesModifyAndOverwrite) {
+    std::unique_ptr<RecordStoreHarnessHelper> harnessHelper = newRecordStoreHarnessHelper();
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+    ASSERT_TRUE(rs->updateWithDamagesSupported());
+
+    string data(1000, 'a');
+    RecordId id;
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        StatusWith<RecordId> res =
+            rs->insertRecord(opCtx.get(), data.c_str(), data.size() + 1, Timestamp(), false);
+        ASSERT_OK(res.getStatus());
+        id = res.getValue();
+        uow.commit();
+    }
+
+    auto update = [&](const mutablebson::DamageVector& damages, const string& damageSource) {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        const RecordData oldRec = rs->dataFor(opCtx.get(), id);
+        StatusWith<RecordData> newRec =
+            rs->updateWithDamages(opCtx.get(), id, oldRec, damageSource.c_str(), damages);
+        ASSERT_OK(newRec.getStatus());
+        uow.commit();
+
+        for (const auto& damage : damages) {
+            data.replace(damage.targetOffset,
+                         damage.size,
+                         damageSource.substr(damage.sourceOffset, damage.size));
+        }
+        ASSERT_EQUALS(data, string(newRec.getValue().data()));
+        ASSERT_EQUALS(data, string(rs->dataFor(opCtx.get(), id).data()));
+    };
+
+    // A few bytes changed in two places.
+    update({{0, 10, 2}, {2, 500, 3}}, "bcdef");
+
+    // Most of the record changed.
+    update({{0, 0, 800}}, string(800, 'z'));
+
+    // Too many small changes.
+    mutablebson::DamageVector damages;
+    for (uint32_t i = 0; i < 100; ++i) {
+        damages.push_back({i, i * 10, 1});
+    }
+    update(damages, string(100, 'y'));
+}
+
 }  // namespace
 }  // namespace mongo
@@ -69,12 +69,32 @@ BSONObj WiredTigerServerStatusSection::generateSection(OperationContext* opCtx,
     invariant(s);
     const string uri = "statistics:";
 
-    BSONObjBuilder bob;
-    Status status = WiredTigerUtil::exportTableToBSON(s, uri, "statistics=(fast)", &bob);
+    BSONObjBuilder statsBuilder;
+    Status status = WiredTigerUtil::exportTableToBSON(s, uri, "statistics=(fast)", &statsBuilder);
     if (!status.isOK()) {
-        bob.append("error", "unable to retrieve statistics");
-        bob.append("code", static_cast<int>(status.code()));
-        bob.append("reason", status.reason());
+        statsBuilder.append("error", "unable to retrieve statistics");
+        statsBuilder.append("code", static_cast<int>(status.code()));
+        statsBuilder.append("reason", status.reason());
+    }
+
+    // Our cursor cache counters go alongside WiredTiger's own session statistics.
+    BSONObjBuilder bob;
+    bool appendedSessionStats = false;
+    for (auto&& elem : statsBuilder.done()) {
+        if (elem.fieldNameStringData() == "session" && elem.type() == Object) {
+            BSONObjBuilder sessionBuilder(bob.subobjStart("session"));
+            sessionBuilder.appendElements(elem.Obj());
+            WiredTigerRecoveryUnit::get(opCtx)->getSessionCache()->appendCursorCacheStats(
+                &sessionBuilder);
+            appendedSessionStats = true;
+        } else {
+            bob.append(elem);
+        }
+    }
+    if (!appendedSessionStats) {
+        BSONObjBuilder sessionBuilder(bob.subobjStart("session"));
+        WiredTigerRecoveryUnit::get(opCtx)->getSessionCache()->appendCursorCacheStats(
+            &sessionBuilder);
     }
 
     WiredTigerKVEngine::appendGlobalStats(bob);
@@ -35,9 +35,14 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "mongo/base/error_codes.h"
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/mongod_options.h"
 #include "mongo/db/repl/repl_settings.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
@@ -48,9 +53,18 @@
 
 namespace mongo {
 
+namespace {
+// The most cursors a single session keeps cached, however large its working set.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerSessionMaxCachedCursors, int, 10000);
+}  // namespace
+
+const uint64_t WiredTigerSession::kMinCursorAge;
+constexpr size_t WiredTigerSessionCache::kNumSessionPartitions;
+
 WiredTigerSession::WiredTigerSession(WT_CONNECTION* conn, uint64_t epoch, uint64_t cursorEpoch)
     : _epoch(epoch),
       _cursorEpoch(cursorEpoch),
+      _cache(nullptr),
       _session(NULL),
       _cursorGen(0),
       _cursorsCached(0),
@@ -79,17 +93,19 @@ WiredTigerSession::~WiredTigerSession() {
 }
 
 WT_CURSOR* WiredTigerSession::getCursor(const std::string& uri, uint64_t id, bool forRecordStore) {
-    // Find the most recently used cursor
-    for (CursorCache::iterator i = _cursors.begin(); i != _cursors.end(); ++i) {
-        if (i->_id == id) {
-            WT_CURSOR* c = i->_cursor;
-            _cursors.erase(i);
-            _cursorsOut++;
-            _cursorsCached--;
-            return c;
-        }
+    auto indexed = _cursorIndex.find(id);
+    if (indexed != _cursorIndex.end()) {
+        CursorCache::iterator i = indexed->second;
+        WT_CURSOR* c = i->_cursor;
+        _cursorIndex.erase(indexed);
+        _cursors.erase(i);
+        _cursorsOut++;
+        _cursorsCached--;
+        _cursorCacheHits++;
+        return c;
     }
 
+    _cursorCacheMisses++;
     WT_CURSOR* c = NULL;
     int ret = _session->open_cursor(
         _session, uri.c_str(), NULL, forRecordStore ? "" : "overwrite=false", &c);
@@ -109,17 +125,24 @@ void WiredTigerSession::releaseCursor(uint64_t id, WT_CURSOR* cursor) {
 
     // Cursors are pushed to the front of the list and removed from the back
     _cursors.push_front(WiredTigerCachedCursor(id, _cursorGen++, cursor));
+    _cursorIndex.emplace(id, _cursors.begin());
     _cursorsCached++;
 
     // "Old" is defined as not used in the last N**2 operations, if we have N cursors cached.
     // The reasoning here is to imagine a workload with N tables performing operations randomly
     // across all of them (i.e., each cursor has 1/N chance of used for each operation).  We
     // would like to cache N cursors in that case, so any given cursor could go N**2 operations
-    // in between use.
-    while (_cursorGen - _cursors.back()._gen > 10000) {
+    // in between use. The cache therefore grows with the session's working set, up to
+    // wiredTigerSessionMaxCachedCursors.
+    const uint64_t numCached = _cursorsCached;
+    const uint64_t maxAge = std::max(kMinCursorAge, numCached * numCached);
+    const int maxCached = std::max(wiredTigerSessionMaxCachedCursors.load(), 1);
+    while (_cursorsCached > maxCached || _cursorGen - _cursors.back()._gen > maxAge) {
         cursor = _cursors.back()._cursor;
+        _removeFromIndex(std::prev(_cursors.end()));
         _cursors.pop_back();
         _cursorsCached--;
+        _cursorCacheEvictions++;
         invariantWTOK(cursor->close(cursor));
     }
 }
@@ -131,7 +154,9 @@ void WiredTigerSession::closeAllCursors(const std::string& uri) {
         WT_CURSOR* cursor = i->_cursor;
         if (cursor && uri == cursor->uri) {
             invariantWTOK(cursor->close(cursor));
+            _removeFromIndex(i);
             i = _cursors.erase(i);
+            _cursorsCached--;
         } else
             ++i;
     }
@@ -142,6 +167,9 @@ void WiredTigerSession::closeCursorsForQueuedDrops(WiredTigerKVEngine* engine) {
 
     _cursorEpoch = _cache->getCursorEpoch();
     auto toDrop = engine->filterCursorsWithQueuedDrops(&_cursors);
+    if (toDrop.empty())
+        return;
+    _rebuildIndex();
 
     for (auto i = toDrop.begin(); i != toDrop.end(); i++) {
         WT_CURSOR* cursor = i->_cursor;
@@ -151,8 +179,35 @@ void WiredTigerSession::closeCursorsForQueuedDrops(WiredTigerKVEngine* engine) {
     }
 }
 
+void WiredTigerSession::_removeFromIndex(CursorCache::iterator it) {
+    auto range = _cursorIndex.equal_range(it->_id);
+    for (auto i = range.first; i != range.second; ++i) {
+        if (i->second == it) {
+            _cursorIndex.erase(i);
+            return;
+        }
+    }
+    MONGO_UNREACHABLE;
+}
+
+void WiredTigerSession::_rebuildIndex() {
+    _cursorIndex.clear();
+    for (auto i = _cursors.begin(); i != _cursors.end(); ++i) {
+        _cursorIndex.emplace(i->_id, i);
+    }
+    _cursorsCached = _cursors.size();
+}
+
 namespace {
 AtomicUInt64 nextTableId(1);
+
+// Threads are assigned home session partitions round-robin, the first time they need one.
+AtomicUInt32 nextSessionPartition;
+
+size_t homeSessionPartition(size_t numPartitions) {
+    thread_local const size_t partition = nextSessionPartition.fetchAndAdd(1);
+    return partition % numPartitions;
+}
 }
 // static
 uint64_t WiredTigerSession::genTableId() {
@@ -162,10 +217,18 @@ uint64_t WiredTigerSession::genTableId() {
 // -----------------------
 
 WiredTigerSessionCache::WiredTigerSessionCache(WiredTigerKVEngine* engine)
-    : _engine(engine), _conn(engine->getConnection()), _snapshotManager(_conn), _shuttingDown(0) {}
+    : _engine(engine),
+      _conn(engine->getConnection()),
+      _snapshotManager(_conn),
+      _shuttingDown(0),
+      _partitions(kNumSessionPartitions) {}
 
 WiredTigerSessionCache::WiredTigerSessionCache(WT_CONNECTION* conn)
-    : _engine(NULL), _conn(conn), _snapshotManager(_conn), _shuttingDown(0) {}
+    : _engine(NULL),
+      _conn(conn),
+      _snapshotManager(_conn),
+      _shuttingDown(0),
+      _partitions(kNumSessionPartitions) {}
 
 WiredTigerSessionCache::~WiredTigerSessionCache() {
     shuttingDown();
@@ -269,9 +332,12 @@ void WiredTigerSessionCache::waitUntilDurable(bool forceCheckpoint, bool stableC
 }
 
 void WiredTigerSessionCache::closeAllCursors(const std::string& uri) {
-    stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeAllCursors(uri);
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lock(partition.lock);
+        for (SessionCache::iterator i = partition.sessions.begin(); i != partition.sessions.end();
+             i++) {
+            (*i)->closeAllCursors(uri);
+        }
     }
 }
 
@@ -279,9 +345,12 @@ void WiredTigerSessionCache::closeCursorsForQueuedDrops() {
     // Increment the cursor epoch so that all cursors from this epoch are closed.
     _cursorEpoch.fetchAndAdd(1);
 
-    stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeCursorsForQueuedDrops(_engine);
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lock(partition.lock);
+        for (SessionCache::iterator i = partition.sessions.begin(); i != partition.sessions.end();
+             i++) {
+            (*i)->closeCursorsForQueuedDrops(_engine);
+        }
     }
 }
 
@@ -290,9 +359,20 @@ void WiredTigerSessionCache::closeAll() {
     SessionCache swap;
 
     {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
+        // Hold every partition lock while bumping the epoch, so that no session from the old
+        // epoch can be handed out or cached once it has changed. Partition locks are always taken
+        // in this order.
+        std::vector<stdx::unique_lock<stdx::mutex>> locks;
+        locks.reserve(kNumSessionPartitions);
+        for (auto&& partition : _partitions) {
+            locks.emplace_back(partition.lock);
+        }
+
         _epoch.fetchAndAdd(1);
-        _sessions.swap(swap);
+        for (auto&& partition : _partitions) {
+            swap.insert(swap.end(), partition.sessions.begin(), partition.sessions.end());
+            partition.sessions.clear();
+        }
     }
 
     for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
@@ -309,13 +389,16 @@ UniqueWiredTigerSession WiredTigerSessionCache::getSession() {
     // operations should be allowed to start.
     invariant(!(_shuttingDown.loadRelaxed() & kShuttingDownMask));
 
-    {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        if (!_sessions.empty()) {
+    // Try the home partition first, then the others in turn.
+    const size_t home = homeSessionPartition(kNumSessionPartitions);
+    for (size_t i = 0; i < kNumSessionPartitions; i++) {
+        auto& partition = _partitions[(home + i) % kNumSessionPartitions];
+        stdx::lock_guard<stdx::mutex> lock(partition.lock);
+        if (!partition.sessions.empty()) {
             // Get the most recently used session so that if we discard sessions, we're
             // discarding older ones
-            WiredTigerSession* cachedSession = _sessions.back();
-            _sessions.pop_back();
+            WiredTigerSession* cachedSession = partition.sessions.back();
+            partition.sessions.pop_back();
             return UniqueWiredTigerSession(cachedSession);
         }
     }
@@ -355,6 +438,13 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
         invariantWTOK(ss->reset(ss));
     }
 
+    _cursorCacheHits.fetchAndAdd(session->_cursorCacheHits);
+    _cursorCacheMisses.fetchAndAdd(session->_cursorCacheMisses);
+    _cursorCacheEvictions.fetchAndAdd(session->_cursorCacheEvictions);
+    session->_cursorCacheHits = 0;
+    session->_cursorCacheMisses = 0;
+    session->_cursorCacheEvictions = 0;
+
     // If the cursor epoch has moved on, close all cursors in the session.
     uint64_t cursorEpoch = _cursorEpoch.load();
     if (session->_getCursorEpoch() != cursorEpoch)
@@ -364,10 +454,11 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
     uint64_t currentEpoch = _epoch.load();
 
     if (session->_getEpoch() == currentEpoch) {  // check outside of lock to reduce contention
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
+        auto& partition = _partitions[homeSessionPartition(kNumSessionPartitions)];
+        stdx::lock_guard<stdx::mutex> lock(partition.lock);
         if (session->_getEpoch() == _epoch.load()) {  // recheck inside the lock for correctness
             returnedToCache = true;
-            _sessions.push_back(session);
+            partition.sessions.push_back(session);
         }
     } else
         invariant(session->_getEpoch() < currentEpoch);
@@ -379,6 +470,11 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
         _engine->dropSomeQueuedIdents();
 }
 
+void WiredTigerSessionCache::appendCursorCacheStats(BSONObjBuilder* builder) const {
+    builder->append("cursor cache hits", _cursorCacheHits.load());
+    builder->append("cursor cache misses", _cursorCacheMisses.load());
+    builder->append("cursor cache evictions", _cursorCacheEvictions.load());
+}
 
 void WiredTigerSessionCache::setJournalListener(JournalListener* jl) {
     stdx::unique_lock<stdx::mutex> lk(_journalListenerMutex);
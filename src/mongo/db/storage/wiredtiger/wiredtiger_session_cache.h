@@ -33,17 +33,22 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
+#include <boost/align/aligned_allocator.hpp>
 #include <wiredtiger.h>
 
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_snapshot_manager.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/concurrency/spin_lock.h"
+#include "mongo/util/with_alignment.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
 class WiredTigerKVEngine;
 class WiredTigerSessionCache;
 
@@ -114,8 +119,19 @@ public:
 private:
     friend class WiredTigerSessionCache;
 
-    // The cursor cache is a list of pairs that contain an ID and cursor
+    // The cursor cache is a list of pairs that contain an ID and cursor, most recently released
+    // first. It is indexed by ID so lookups don't have to walk the list.
     typedef std::list<WiredTigerCachedCursor> CursorCache;
+    typedef stdx::unordered_multimap<uint64_t, CursorCache::iterator> CursorCacheIndex;
+
+    // Cursors cached and not reused for fewer than this many operations are never aged out.
+    static const uint64_t kMinCursorAge = 10000;
+
+    // Removes 'it', which must be in _cursors, from _cursorIndex.
+    void _removeFromIndex(CursorCache::iterator it);
+
+    // Recomputes _cursorIndex and _cursorsCached after _cursors was changed directly.
+    void _rebuildIndex();
 
     // Used internally by WiredTigerSessionCache
     uint64_t _getEpoch() const {
@@ -132,8 +148,16 @@ private:
     WiredTigerSessionCache* _cache;  // not owned
     WT_SESSION* _session;            // owned
     CursorCache _cursors;            // owned
+    CursorCacheIndex _cursorIndex;
     uint64_t _cursorGen;
     int _cursorsCached, _cursorsOut;
+
+    // Cursor cache activity since this session was last returned to the WiredTigerSessionCache,
+    // which then adds them to its totals. Kept per session so that cursor operations don't
+    // contend on shared counters.
+    long long _cursorCacheHits = 0;
+    long long _cursorCacheMisses = 0;
+    long long _cursorCacheEvictions = 0;
 };
 
 /**
@@ -214,6 +238,12 @@ public:
         return _engine;
     }
 
+    /**
+     * Appends the cursor cache hit, miss and eviction counts of all sessions, as of the last time
+     * each was returned to this cache.
+     */
+    void appendCursorCacheStats(BSONObjBuilder* builder) const;
+
 private:
     WiredTigerKVEngine* _engine;  // not owned, might be NULL
     WT_CONNECTION* _conn;         // not owned
@@ -225,9 +255,19 @@ private:
     AtomicUInt32 _shuttingDown;
     static const uint32_t kShuttingDownMask = 1 << 31;
 
-    stdx::mutex _cacheLock;
+    // Released sessions are pooled in several partitions, each with its own lock, so that threads
+    // getting and releasing sessions concurrently rarely contend. Each thread has a home partition
+    // it releases sessions to and takes them from, and only looks at the others when its home
+    // partition is empty. Sessions are taken most recently released first within a partition.
     typedef std::vector<WiredTigerSession*> SessionCache;
-    SessionCache _sessions;
+    struct SessionPartition {
+        stdx::mutex lock;
+        SessionCache sessions;
+    };
+    template <typename T>
+    using AlignedVector = std::vector<T, boost::alignment::aligned_allocator<T>>;
+    static constexpr size_t kNumSessionPartitions = 16;
+    AlignedVector<CacheAligned<SessionPartition>> _partitions;
 
     // Bumped when all open sessions need to be closed
     AtomicUInt64 _epoch;  // atomic so we can check it outside of the lock
@@ -235,6 +275,11 @@ private:
     // Bumped when all open cursors need to be closed
     AtomicUInt64 _cursorEpoch;  // atomic so we can check it outside of the lock
 
+    // Totals of the per-session cursor cache counters.
+    AtomicInt64 _cursorCacheHits;
+    AtomicInt64 _cursorCacheMisses;
+    AtomicInt64 _cursorCacheEvictions;
+
     // Counter and critical section mutex for waitUntilDurable
     AtomicUInt32 _lastSyncTime;
     stdx::mutex _lastSyncMutex;
@@ -0,0 +1,177 @@
+/**
+ *    Copyright 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+class WiredTigerSessionCacheTest : public unittest::Test {
+public:
+    WiredTigerSessionCacheTest() : _dbpath("wt_test") {
+        ASSERT_OK(wtRCToStatus(wiredtiger_open(_dbpath.path().c_str(), NULL, "create", &_conn)));
+        _sessionCache = stdx::make_unique<WiredTigerSessionCache>(_conn);
+    }
+
+    ~WiredTigerSessionCacheTest() {
+        _sessionCache.reset();
+        _conn->close(_conn, NULL);
+    }
+
+protected:
+    std::string createTable(WiredTigerSession* session, const std::string& name) {
+        const std::string uri = "table:" + name;
+        WT_SESSION* s = session->getSession();
+        ASSERT_OK(wtRCToStatus(s->create(s, uri.c_str(), "key_format=q,value_format=u")));
+        return uri;
+    }
+
+    BSONObj getStats() {
+        BSONObjBuilder builder;
+        _sessionCache->appendCursorCacheStats(&builder);
+        return builder.obj();
+    }
+
+    unittest::TempDir _dbpath;
+    WT_CONNECTION* _conn = nullptr;
+    std::unique_ptr<WiredTigerSessionCache> _sessionCache;
+};
+
+TEST_F(WiredTigerSessionCacheTest, ReleasedCursorIsReused) {
+    {
+        auto session = _sessionCache->getSession();
+        const std::string uri = createTable(session.get(), "a");
+        const uint64_t id = WiredTigerSession::genTableId();
+
+        WT_CURSOR* cursor = session->getCursor(uri, id, true);
+        ASSERT(cursor);
+        session->releaseCursor(id, cursor);
+
+        // A cursor for another table must not be handed out for 'id'.
+        const std::string otherUri = createTable(session.get(), "b");
+        const uint64_t otherId = WiredTigerSession::genTableId();
+        WT_CURSOR* otherCursor = session->getCursor(otherUri, otherId, true);
+        ASSERT(otherCursor != cursor);
+        session->releaseCursor(otherId, otherCursor);
+
+        ASSERT_EQUALS(cursor, session->getCursor(uri, id, true));
+        session->releaseCursor(id, cursor);
+    }
+
+    // Counters are only added to the totals once the session is released.
+    BSONObj stats = getStats();
+    ASSERT_EQUALS(1, stats["cursor cache hits"].numberLong());
+    ASSERT_EQUALS(2, stats["cursor cache misses"].numberLong());
+    ASSERT_EQUALS(0, stats["cursor cache evictions"].numberLong());
+}
+
+TEST_F(WiredTigerSessionCacheTest, LeastRecentlyUsedCursorIsEvictedAtCapacity) {
+    auto maxCachedCursors =
+        ServerParameterSet::getGlobal()->getMap().at("wiredTigerSessionMaxCachedCursors");
+    ASSERT_OK(maxCachedCursors->setFromString("2"));
+    ON_BLOCK_EXIT([&] { maxCachedCursors->setFromString("10000").transitional_ignore(); });
+
+    {
+        auto session = _sessionCache->getSession();
+        const std::string uris[] = {createTable(session.get(), "a"),
+                                    createTable(session.get(), "b"),
+                                    createTable(session.get(), "c")};
+        uint64_t ids[3];
+        WT_CURSOR* cursors[3];
+        for (int i = 0; i < 3; i++) {
+            ids[i] = WiredTigerSession::genTableId();
+            cursors[i] = session->getCursor(uris[i], ids[i], true);
+        }
+        for (int i = 0; i < 3; i++) {
+            session->releaseCursor(ids[i], cursors[i]);
+        }
+
+        // The first cursor released was evicted; the other two are still cached.
+        WT_CURSOR* reopened = session->getCursor(uris[0], ids[0], true);
+        session->releaseCursor(ids[0], reopened);
+        ASSERT_EQUALS(cursors[2], session->getCursor(uris[2], ids[2], true));
+        session->releaseCursor(ids[2], cursors[2]);
+    }
+
+    BSONObj stats = getStats();
+    ASSERT_EQUALS(1, stats["cursor cache hits"].numberLong());
+    ASSERT_EQUALS(4, stats["cursor cache misses"].numberLong());
+    ASSERT_EQUALS(2, stats["cursor cache evictions"].numberLong());
+}
+
+TEST_F(WiredTigerSessionCacheTest, ReleasedSessionIsReusedByTheSameThread) {
+    WiredTigerSession* released;
+    {
+        auto session = _sessionCache->getSession();
+        released = session.get();
+    }
+    auto session = _sessionCache->getSession();
+    ASSERT_EQUALS(released, session.get());
+}
+
+TEST_F(WiredTigerSessionCacheTest, ConcurrentGetAndReleaseAcrossCloseAll) {
+    const int kNumThreads = 8;
+    const int kIterations = 500;
+
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < kNumThreads; i++) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < kIterations; j++) {
+                auto first = _sessionCache->getSession();
+                auto second = _sessionCache->getSession();
+                ASSERT(first.get() != second.get());
+            }
+        });
+    }
+
+    // Sessions handed out before this are closed when released rather than cached again.
+    _sessionCache->closeAll();
+
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+
+    _sessionCache->closeAll();
+    ASSERT(_sessionCache->getSession()->getSession());
+}
+
+}  // namespace
+}  // namespace mongo
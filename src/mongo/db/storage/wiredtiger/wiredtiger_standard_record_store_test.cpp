@@ -40,6 +40,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/json.h"
 #include "mongo/db/operation_context_noop.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/kv/kv_engine_test_harness.h"
 #include "mongo/db/storage/kv/kv_prefix.h"
 #include "mongo/db/storage/record_store_test_harness.h"
@@ -55,6 +56,7 @@
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/clock_source_mock.h"
 #include "mongo/util/fail_point.h"
+#include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
@@ -205,6 +207,122 @@ TEST(WiredTigerRecordStoreTest, StorageSizeStatisticsDisabled) {
     ASSERT_THROWS(rs->storageSize(opCtx.get()), AssertionException);
 }
 
+TEST(WiredTigerRecordStoreTest, InsertRecordsAssignsContiguousIds) {
+    WiredTigerHarnessHelper harnessHelper;
+    unique_ptr<RecordStore> rs(harnessHelper.newNonCappedRecordStore("a.b"));
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+
+    const int nToInsert = 5;
+    std::vector<std::string> datas;
+    std::vector<Record> records;
+    std::vector<Timestamp> timestamps(nToInsert);
+    for (int i = 0; i < nToInsert; i++) {
+        datas.push_back(str::stream() << "record " << i);
+    }
+    for (auto&& data : datas) {
+        records.push_back({RecordId(), RecordData(data.c_str(), data.size() + 1)});
+    }
+
+    {
+        WriteUnitOfWork uow(opCtx.get());
+        ASSERT_OK(rs->insertRecords(opCtx.get(), &records, &timestamps, false));
+        uow.commit();
+    }
+
+    ASSERT_EQUALS(nToInsert, rs->numRecords(opCtx.get()));
+    for (int i = 0; i < nToInsert; i++) {
+        ASSERT_EQUALS(records[0].id.repr() + i, records[i].id.repr());
+        ASSERT_EQUALS(datas[i], rs->dataFor(opCtx.get(), records[i].id).data());
+    }
+}
+
+TEST(WiredTigerRecordStoreTest, ReadAheadDoesNotChangeScanResults) {
+    auto readAheadRecords =
+        ServerParameterSet::getGlobal()->getMap().at("wiredTigerReadAheadRecords");
+    ASSERT_OK(readAheadRecords->setFromString("4"));
+    ON_BLOCK_EXIT([&] { readAheadRecords->setFromString("1000").transitional_ignore(); });
+
+    WiredTigerHarnessHelper harnessHelper;
+    unique_ptr<RecordStore> rs(harnessHelper.newNonCappedRecordStore("a.b"));
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+
+    const int nToInsert = 50;
+    std::vector<RecordId> ids;
+    {
+        WriteUnitOfWork uow(opCtx.get());
+        for (int i = 0; i < nToInsert; i++) {
+            StatusWith<RecordId> res = rs->insertRecord(opCtx.get(), "a", 2, Timestamp(), false);
+            ASSERT_OK(res.getStatus());
+            ids.push_back(res.getValue());
+        }
+        uow.commit();
+    }
+
+    for (bool forward : {true, false}) {
+        auto cursor = rs->getCursor(opCtx.get(), forward);
+        cursor->enableReadAhead();
+        for (int i = 0; i < nToInsert; i++) {
+            auto record = cursor->next();
+            ASSERT(record);
+            ASSERT_EQUALS(forward ? ids[i] : ids[nToInsert - 1 - i], record->id);
+        }
+        ASSERT(!cursor->next());
+    }
+
+    BSONObjBuilder builder;
+    rs->appendCustomStats(opCtx.get(), &builder, 1);
+    BSONObj readAhead = builder.obj()[kWiredTigerEngineName]["readAhead"].Obj();
+    // Each scan schedules its first window unconditionally, and one more after every hit.
+    ASSERT_EQUALS(2 + readAhead["hits"].numberLong(),
+                  readAhead["requests"].numberLong() + readAhead["dropped"].numberLong());
+}
+
+TEST(WiredTigerRecordStoreTest, GetManyCursorsPartitionsRecords) {
+    auto& parameters = ServerParameterSet::getGlobal()->getMap();
+    auto maxCursors = parameters.at("wiredTigerParallelScanMaxCursors");
+    auto minRecordsPerCursor = parameters.at("wiredTigerParallelScanMinRecordsPerCursor");
+    ASSERT_OK(maxCursors->setFromString("4"));
+    ASSERT_OK(minRecordsPerCursor->setFromString("10"));
+    ON_BLOCK_EXIT([&] {
+        maxCursors->setFromString("16").transitional_ignore();
+        minRecordsPerCursor->setFromString("10000").transitional_ignore();
+    });
+
+    WiredTigerHarnessHelper harnessHelper;
+    unique_ptr<RecordStore> rs(harnessHelper.newNonCappedRecordStore("a.b"));
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+
+    // Too few records to split.
+    ASSERT_EQUALS(1U, rs->getManyCursors(opCtx.get()).size());
+
+    const int nToInsert = 50;
+    std::vector<RecordId> ids;
+    {
+        WriteUnitOfWork uow(opCtx.get());
+        for (int i = 0; i < nToInsert; i++) {
+            StatusWith<RecordId> res = rs->insertRecord(opCtx.get(), "a", 2, Timestamp(), false);
+            ASSERT_OK(res.getStatus());
+            ids.push_back(res.getValue());
+        }
+        uow.commit();
+    }
+
+    auto cursors = rs->getManyCursors(opCtx.get());
+    ASSERT_EQUALS(4U, cursors.size());
+
+    // Draining the cursors in order returns every record once, in RecordId order, and each
+    // cursor returns some of them.
+    std::vector<RecordId> seen;
+    for (auto&& cursor : cursors) {
+        const size_t seenBefore = seen.size();
+        while (auto record = cursor->next()) {
+            seen.push_back(record->id);
+        }
+        ASSERT_GT(seen.size(), seenBefore);
+    }
+    ASSERT(ids == seen);
+}
+
 TEST(WiredTigerRecordStoreTest, SizeStorer1) {
     unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
     unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
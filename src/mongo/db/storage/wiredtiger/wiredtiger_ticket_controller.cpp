@@ -0,0 +1,146 @@
+/**
+ *    Copyright 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+const char* decisionName(WiredTigerTicketController::Decision decision) {
+    switch (decision) {
+        case WiredTigerTicketController::Decision::kHold:
+            return "hold";
+        case WiredTigerTicketController::Decision::kIncrease:
+            return "increase";
+        case WiredTigerTicketController::Decision::kDecrease:
+            return "decrease";
+    }
+    MONGO_UNREACHABLE;
+}
+
+void appendResult(const WiredTigerTicketController::Result& result, BSONObjBuilder* builder) {
+    builder->appendDate("date", result.date);
+    builder->append("reason", result.reason);
+    builder->append("read", decisionName(result.readDecision));
+    builder->append("readTickets", result.readTickets);
+    builder->append("write", decisionName(result.writeDecision));
+    builder->append("writeTickets", result.writeTickets);
+}
+
+}  // namespace
+
+WiredTigerTicketController::WiredTigerTicketController(Options options) : _options(options) {
+    invariant(_options.minTickets > 0);
+    invariant(_options.minTickets <= _options.maxTickets);
+    invariant(_options.increaseStep > 0);
+    invariant(_options.decreaseFactor > 0 && _options.decreaseFactor < 1);
+}
+
+WiredTigerTicketController::Decision WiredTigerTicketController::_decide(
+    const Sample& sample, const PoolSample& pool, const char** reason) const {
+    if (sample.cacheUsedRatio >= _options.cacheUsedTrigger) {
+        *reason = "cacheUsed";
+        return Decision::kDecrease;
+    }
+    if (sample.cacheDirtyRatio >= _options.cacheDirtyTrigger) {
+        *reason = "cacheDirty";
+        return Decision::kDecrease;
+    }
+    if (sample.targetLatencyMicros > 0 && pool.avgLatencyMicros > sample.targetLatencyMicros) {
+        *reason = "latency";
+        return Decision::kDecrease;
+    }
+    if (pool.used >= pool.total) {
+        *reason = "saturated";
+        return Decision::kIncrease;
+    }
+    return Decision::kHold;
+}
+
+int WiredTigerTicketController::_apply(Decision decision, int total) const {
+    switch (decision) {
+        case Decision::kHold:
+            return std::max(_options.minTickets, std::min(_options.maxTickets, total));
+        case Decision::kIncrease:
+            return std::max(_options.minTickets,
+                            std::min(_options.maxTickets, total + _options.increaseStep));
+        case Decision::kDecrease:
+            return std::max(_options.minTickets,
+                            std::min(_options.maxTickets,
+                                     static_cast<int>(total * _options.decreaseFactor)));
+    }
+    MONGO_UNREACHABLE;
+}
+
+WiredTigerTicketController::Result WiredTigerTicketController::update(const Sample& sample,
+                                                                      Date_t now) {
+    Result result;
+    result.date = now;
+
+    const char* readReason = "";
+    const char* writeReason = "";
+    result.readDecision = _decide(sample, sample.read, &readReason);
+    result.writeDecision = _decide(sample, sample.write, &writeReason);
+    result.readTickets = _apply(result.readDecision, sample.read.total);
+    result.writeTickets = _apply(result.writeDecision, sample.write.total);
+
+    // The cache signals are shared by both pools, so one reason describes the decision.
+    result.reason = result.writeDecision != Decision::kHold ? writeReason : readReason;
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _last = result;
+    if (result.readTickets != sample.read.total || result.writeTickets != sample.write.total) {
+        _history.push_back(result);
+        if (_history.size() > kMaxHistory) {
+            _history.pop_front();
+        }
+    }
+    return result;
+}
+
+void WiredTigerTicketController::append(BSONObjBuilder* builder) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_last.date != Date_t()) {
+        BSONObjBuilder lastBuilder(builder->subobjStart("lastDecision"));
+        appendResult(_last, &lastBuilder);
+    }
+    BSONArrayBuilder historyBuilder(builder->subarrayStart("history"));
+    for (auto&& result : _history) {
+        BSONObjBuilder resultBuilder(historyBuilder.subobjStart());
+        appendResult(result, &resultBuilder);
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,125 @@
+/**
+ *    Copyright 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+/**
+ * Decides how many read and write tickets WiredTiger transactions may hold.
+ *
+ * The controller is fed a sample of the storage engine and ticket pools at a fixed interval and
+ * resizes each pool AIMD-style: a pool whose tickets are all in use grows by a fixed step, and
+ * both pools shrink by a constant factor while the WiredTiger cache is above its eviction
+ * triggers. A pool also shrinks while the average latency of its operations over the last
+ * interval exceeds the configured target.
+ *
+ * This class only makes decisions; applying them to the TicketHolders is up to the caller.
+ */
+class WiredTigerTicketController {
+    MONGO_DISALLOW_COPYING(WiredTigerTicketController);
+
+public:
+    enum class Decision { kHold, kIncrease, kDecrease };
+
+    struct Options {
+        int minTickets = 16;
+        int maxTickets = 1024;
+        int increaseStep = 8;
+        double decreaseFactor = 0.75;
+
+        // Fractions of the configured cache size, matching WiredTiger's default eviction_trigger
+        // and eviction_dirty_trigger settings.
+        double cacheUsedTrigger = 0.95;
+        double cacheDirtyTrigger = 0.20;
+    };
+
+    struct PoolSample {
+        int used = 0;
+        int total = 0;
+
+        // Average latency of the operations that completed during the last interval, or 0 if
+        // none did.
+        double avgLatencyMicros = 0;
+    };
+
+    struct Sample {
+        double cacheUsedRatio = 0;
+        double cacheDirtyRatio = 0;
+        PoolSample read;
+        PoolSample write;
+
+        // 0 disables the latency signal.
+        long long targetLatencyMicros = 0;
+    };
+
+    struct Result {
+        Date_t date;
+        int readTickets = 0;
+        int writeTickets = 0;
+        Decision readDecision = Decision::kHold;
+        Decision writeDecision = Decision::kHold;
+        const char* reason = "";
+    };
+
+    static const size_t kMaxHistory = 16;
+
+    WiredTigerTicketController() = default;
+    explicit WiredTigerTicketController(Options options);
+
+    /**
+     * Returns the new ticket pool sizes for 'sample'. Results that resize a pool are kept in the
+     * history reported by append().
+     */
+    Result update(const Sample& sample, Date_t now);
+
+    /**
+     * Appends the last decision and the recent resize history for serverStatus.
+     */
+    void append(BSONObjBuilder* builder) const;
+
+private:
+    Decision _decide(const Sample& sample, const PoolSample& pool, const char** reason) const;
+    int _apply(Decision decision, int total) const;
+
+    const Options _options;
+
+    mutable stdx::mutex _mutex;
+    Result _last;                  // (M)
+    std::deque<Result> _history;  // (M)
+};
+
+}  // namespace mongo
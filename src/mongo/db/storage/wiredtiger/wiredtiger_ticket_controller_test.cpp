@@ -0,0 +1,136 @@
+/**
+ *    Copyright 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using Decision = WiredTigerTicketController::Decision;
+
+WiredTigerTicketController::Sample makeSample(int readUsed, int writeUsed, int total = 128) {
+    WiredTigerTicketController::Sample sample;
+    sample.cacheUsedRatio = 0.5;
+    sample.cacheDirtyRatio = 0.01;
+    sample.read.used = readUsed;
+    sample.read.total = total;
+    sample.write.used = writeUsed;
+    sample.write.total = total;
+    return sample;
+}
+
+TEST(WiredTigerTicketControllerTest, HoldsWhenTicketsAreAvailable) {
+    WiredTigerTicketController controller;
+    auto result = controller.update(makeSample(10, 10), Date_t::now());
+    ASSERT(result.readDecision == Decision::kHold);
+    ASSERT(result.writeDecision == Decision::kHold);
+    ASSERT_EQUALS(128, result.readTickets);
+    ASSERT_EQUALS(128, result.writeTickets);
+}
+
+TEST(WiredTigerTicketControllerTest, IncreasesSaturatedPoolAdditively) {
+    WiredTigerTicketController::Options options;
+    options.increaseStep = 8;
+    WiredTigerTicketController controller(options);
+    auto result = controller.update(makeSample(10, 128), Date_t::now());
+    ASSERT(result.readDecision == Decision::kHold);
+    ASSERT(result.writeDecision == Decision::kIncrease);
+    ASSERT_EQUALS(128, result.readTickets);
+    ASSERT_EQUALS(136, result.writeTickets);
+    ASSERT_EQUALS(std::string("saturated"), result.reason);
+}
+
+TEST(WiredTigerTicketControllerTest, DecreasesBothPoolsMultiplicativelyUnderCachePressure) {
+    WiredTigerTicketController controller;
+    auto sample = makeSample(128, 128);
+    sample.cacheDirtyRatio = 0.25;
+    auto result = controller.update(sample, Date_t::now());
+    ASSERT(result.readDecision == Decision::kDecrease);
+    ASSERT(result.writeDecision == Decision::kDecrease);
+    ASSERT_EQUALS(96, result.readTickets);
+    ASSERT_EQUALS(96, result.writeTickets);
+    ASSERT_EQUALS(std::string("cacheDirty"), result.reason);
+}
+
+TEST(WiredTigerTicketControllerTest, DecreasesOnlyThePoolAboveTheLatencyTarget) {
+    WiredTigerTicketController controller;
+    auto sample = makeSample(128, 128);
+    sample.targetLatencyMicros = 1000;
+    sample.read.avgLatencyMicros = 5000;
+    sample.write.avgLatencyMicros = 200;
+    auto result = controller.update(sample, Date_t::now());
+    ASSERT(result.readDecision == Decision::kDecrease);
+    ASSERT(result.writeDecision == Decision::kIncrease);
+    ASSERT_EQUALS(96, result.readTickets);
+    ASSERT_EQUALS(136, result.writeTickets);
+}
+
+TEST(WiredTigerTicketControllerTest, StaysWithinBounds) {
+    WiredTigerTicketController::Options options;
+    options.minTickets = 16;
+    options.maxTickets = 130;
+    WiredTigerTicketController controller(options);
+
+    auto result = controller.update(makeSample(128, 128), Date_t::now());
+    ASSERT_EQUALS(130, result.readTickets);
+    ASSERT_EQUALS(130, result.writeTickets);
+
+    auto sample = makeSample(0, 0, 20);
+    sample.cacheUsedRatio = 0.99;
+    result = controller.update(sample, Date_t::now());
+    ASSERT_EQUALS(16, result.readTickets);
+    ASSERT_EQUALS(16, result.writeTickets);
+    ASSERT_EQUALS(std::string("cacheUsed"), result.reason);
+}
+
+TEST(WiredTigerTicketControllerTest, HistoryOnlyRecordsResizes) {
+    WiredTigerTicketController controller;
+    for (size_t i = 0; i < WiredTigerTicketController::kMaxHistory + 4; i++) {
+        controller.update(makeSample(128, 0), Date_t::now());
+        controller.update(makeSample(0, 0), Date_t::now());
+    }
+
+    BSONObjBuilder builder;
+    controller.append(&builder);
+    auto stats = builder.obj();
+    ASSERT_EQUALS("hold", stats["lastDecision"]["read"].str());
+    ASSERT_EQUALS(static_cast<int>(WiredTigerTicketController::kMaxHistory),
+                  stats["history"].Obj().nFields());
+    for (auto&& entry : stats["history"].Obj()) {
+        ASSERT_EQUALS("increase", entry["read"].str());
+        ASSERT_EQUALS("saturated", entry["reason"].str());
+    }
+}
+
+}  // namespace
+}  // namespace mongo
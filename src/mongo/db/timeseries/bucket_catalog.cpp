@@ -0,0 +1,109 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/timeseries/bucket_catalog.h"
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+
+namespace mongo {
+
+namespace {
+
+MONGO_EXPORT_SERVER_PARAMETER(timeseriesBucketMaxCount, int, 1000);
+
+const auto getBucketCatalog = ServiceContext::declareDecoration<BucketCatalog>();
+
+std::string makeKey(const NamespaceString& bucketsNss, const BSONObj& meta) {
+    std::string key = bucketsNss.ns();
+    key.push_back('\0');
+    key.append(meta.objdata(), meta.objsize());
+    return key;
+}
+
+}  // namespace
+
+BucketCatalog& BucketCatalog::get(ServiceContext* svcCtx) {
+    return getBucketCatalog(svcCtx);
+}
+
+Date_t BucketCatalog::getWindowStart(Date_t time, int bucketMaxSpanSeconds) {
+    const long long millis = time.toMillisSinceEpoch();
+    const long long spanMillis = durationCount<Milliseconds>(Seconds(bucketMaxSpanSeconds));
+    long long windowStartMillis = millis / spanMillis * spanMillis;
+    if (windowStartMillis > millis) {
+        // Division rounds towards zero, which is up for times before the epoch.
+        windowStartMillis -= spanMillis;
+    }
+    return Date_t::fromMillisSinceEpoch(windowStartMillis);
+}
+
+std::vector<BucketCatalog::Allocation> BucketCatalog::allocate(const NamespaceString& bucketsNss,
+                                                               const BSONObj& meta,
+                                                               Date_t time,
+                                                               int bucketMaxSpanSeconds,
+                                                               int count) {
+    const auto windowStart = getWindowStart(time, bucketMaxSpanSeconds);
+    const int maxCount = std::max(1, timeseriesBucketMaxCount.load());
+
+    std::vector<Allocation> allocations;
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto& bucket = _openBuckets[makeKey(bucketsNss, meta)];
+    while (count > 0) {
+        if (!bucket.id.isSet() || bucket.windowStart != windowStart ||
+            bucket.numMeasurements >= maxCount) {
+            bucket.id = OID::gen();
+            bucket.windowStart = windowStart;
+            bucket.numMeasurements = 0;
+        }
+
+        const int allocated = std::min(count, maxCount - bucket.numMeasurements);
+        allocations.push_back({bucket.id, bucket.numMeasurements, allocated});
+        bucket.numMeasurements += allocated;
+        count -= allocated;
+    }
+    return allocations;
+}
+
+void BucketCatalog::clear(const NamespaceString& bucketsNss) {
+    std::string prefix = bucketsNss.ns();
+    prefix.push_back('\0');
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    for (auto it = _openBuckets.begin(); it != _openBuckets.end();) {
+        if (StringData(it->first).startsWith(prefix)) {
+            it = _openBuckets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,107 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/oid.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class ServiceContext;
+
+/**
+ * Tracks the open bucket of each meta value of each time-series collection, and hands out slots
+ * in it to measurements.
+ *
+ * A bucket stays open until it holds timeseriesBucketMaxCount measurements, or until a
+ * measurement arrives which falls outside the time window the bucket was opened for. The catalog
+ * lives in memory only: after a restart, measurements go to new buckets.
+ */
+class BucketCatalog {
+    MONGO_DISALLOW_COPYING(BucketCatalog);
+
+public:
+    /**
+     * Slots [firstPosition, firstPosition + count) of the bucket 'bucketId'.
+     */
+    struct Allocation {
+        OID bucketId;
+        int firstPosition;
+        int count;
+    };
+
+    static BucketCatalog& get(ServiceContext* svcCtx);
+
+    /**
+     * Returns the start of the window of length 'bucketMaxSpanSeconds' holding 'time'. Windows
+     * are aligned to multiples of their length, so that measurements which arrive out of order
+     * still land in the bucket of their window while it is open.
+     */
+    static Date_t getWindowStart(Date_t time, int bucketMaxSpanSeconds);
+
+    BucketCatalog() = default;
+
+    /**
+     * Reserves slots for 'count' measurements with meta value 'meta', which is either empty or
+     * holds the value as its only element, and time 'time'. The slots may be spread over several
+     * buckets when the open one fills up.
+     */
+    std::vector<Allocation> allocate(const NamespaceString& bucketsNss,
+                                     const BSONObj& meta,
+                                     Date_t time,
+                                     int bucketMaxSpanSeconds,
+                                     int count);
+
+    /**
+     * Forgets the open buckets of 'bucketsNss', for instance because it has been dropped.
+     */
+    void clear(const NamespaceString& bucketsNss);
+
+private:
+    struct Bucket {
+        OID id;
+        Date_t windowStart;
+        int numMeasurements = 0;
+    };
+
+    stdx::mutex _mutex;
+
+    // Keyed by the buckets namespace followed by the bytes of the meta value.
+    std::unordered_map<std::string, Bucket> _openBuckets;
+};
+
+}  // namespace mongo
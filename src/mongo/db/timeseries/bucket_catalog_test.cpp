@@ -0,0 +1,103 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/timeseries/bucket_catalog.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("test.system.buckets.weather");
+const int kSpan = 3600;
+
+Date_t at(long long seconds) {
+    return Date_t::fromMillisSinceEpoch(seconds * 1000);
+}
+
+TEST(BucketCatalogTest, SameMetaAndWindowShareBucket) {
+    BucketCatalog catalog;
+    auto first = catalog.allocate(kNss, BSON("" << 1), at(10), kSpan, 2);
+    auto second = catalog.allocate(kNss, BSON("" << 1), at(20), kSpan, 3);
+    ASSERT_EQ(1U, first.size());
+    ASSERT_EQ(1U, second.size());
+    ASSERT_EQ(first[0].bucketId, second[0].bucketId);
+    ASSERT_EQ(0, first[0].firstPosition);
+    ASSERT_EQ(2, second[0].firstPosition);
+    ASSERT_EQ(3, second[0].count);
+}
+
+TEST(BucketCatalogTest, DifferentMetaUsesDifferentBucket) {
+    BucketCatalog catalog;
+    auto first = catalog.allocate(kNss, BSON("" << 1), at(10), kSpan, 1);
+    auto second = catalog.allocate(kNss, BSON("" << 2), at(10), kSpan, 1);
+    auto noMeta = catalog.allocate(kNss, BSONObj(), at(10), kSpan, 1);
+    ASSERT_NE(first[0].bucketId, second[0].bucketId);
+    ASSERT_NE(first[0].bucketId, noMeta[0].bucketId);
+    ASSERT_EQ(0, second[0].firstPosition);
+}
+
+TEST(BucketCatalogTest, NewWindowOpensNewBucket) {
+    BucketCatalog catalog;
+    auto first = catalog.allocate(kNss, BSONObj(), at(kSpan - 1), kSpan, 1);
+    auto second = catalog.allocate(kNss, BSONObj(), at(kSpan), kSpan, 1);
+    ASSERT_NE(first[0].bucketId, second[0].bucketId);
+    ASSERT_EQ(0, second[0].firstPosition);
+}
+
+TEST(BucketCatalogTest, WindowsAreAlignedToTheirSpan) {
+    ASSERT_EQ(at(0), BucketCatalog::getWindowStart(at(kSpan - 1), kSpan));
+    ASSERT_EQ(at(kSpan), BucketCatalog::getWindowStart(at(kSpan), kSpan));
+    ASSERT_EQ(at(-kSpan), BucketCatalog::getWindowStart(at(-1), kSpan));
+}
+
+TEST(BucketCatalogTest, FullBucketSpillsIntoNewBucket) {
+    BucketCatalog catalog;
+    auto allocations = catalog.allocate(kNss, BSONObj(), at(0), kSpan, 2500);
+    ASSERT_EQ(3U, allocations.size());
+    ASSERT_EQ(1000, allocations[0].count);
+    ASSERT_EQ(1000, allocations[1].count);
+    ASSERT_EQ(500, allocations[2].count);
+    ASSERT_EQ(0, allocations[2].firstPosition);
+    ASSERT_NE(allocations[0].bucketId, allocations[1].bucketId);
+}
+
+TEST(BucketCatalogTest, ClearForgetsOpenBuckets) {
+    BucketCatalog catalog;
+    auto first = catalog.allocate(kNss, BSONObj(), at(0), kSpan, 1);
+    catalog.clear(kNss);
+    auto second = catalog.allocate(kNss, BSONObj(), at(0), kSpan, 1);
+    ASSERT_NE(first[0].bucketId, second[0].bucketId);
+    ASSERT_EQ(0, second[0].firstPosition);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,120 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/timeseries/timeseries_options.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+constexpr StringData TimeseriesOptions::kUnpackBucketStageName;
+constexpr StringData TimeseriesOptions::kBucketMetaFieldName;
+constexpr StringData TimeseriesOptions::kBucketControlFieldName;
+constexpr StringData TimeseriesOptions::kBucketDataFieldName;
+constexpr StringData TimeseriesOptions::kControlMinFieldName;
+constexpr StringData TimeseriesOptions::kControlMaxFieldName;
+constexpr StringData TimeseriesOptions::kTimeFieldName;
+constexpr StringData TimeseriesOptions::kMetaFieldName;
+constexpr StringData TimeseriesOptions::kBucketMaxSpanSecondsFieldName;
+
+namespace {
+
+Status validateFieldName(StringData option, const BSONElement& elem) {
+    if (elem.type() != String) {
+        return {ErrorCodes::TypeMismatch,
+                str::stream() << "'" << option << "' must be a string, not " << elem};
+    }
+    const auto name = elem.valueStringData();
+    if (name.empty() || name[0] == '$' || name.find('.') != std::string::npos) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "'" << option << "' must name a top-level field, not '" << name
+                              << "'"};
+    }
+    return Status::OK();
+}
+
+}  // namespace
+
+StatusWith<TimeseriesOptions> TimeseriesOptions::parse(const BSONObj& obj) {
+    TimeseriesOptions options;
+    bool hasTimeField = false;
+    for (const auto& elem : obj) {
+        const auto name = elem.fieldNameStringData();
+        if (name == kTimeFieldName) {
+            Status status = validateFieldName(name, elem);
+            if (!status.isOK()) {
+                return status;
+            }
+            options.timeField = elem.String();
+            hasTimeField = true;
+        } else if (name == kMetaFieldName) {
+            Status status = validateFieldName(name, elem);
+            if (!status.isOK()) {
+                return status;
+            }
+            options.metaField = elem.String();
+        } else if (name == kBucketMaxSpanSecondsFieldName) {
+            if (!elem.isNumber() || elem.numberLong() <= 0 ||
+                elem.numberLong() > std::numeric_limits<int>::max()) {
+                return {ErrorCodes::BadValue,
+                        str::stream() << "'" << name << "' must be a positive number of seconds, "
+                                      << "not " << elem};
+            }
+            options.bucketMaxSpanSeconds = elem.numberInt();
+        } else {
+            return {ErrorCodes::FailedToParse,
+                    str::stream() << "Unknown time-series option '" << name << "'"};
+        }
+    }
+
+    if (!hasTimeField) {
+        return {ErrorCodes::FailedToParse,
+                str::stream() << "Time-series options require '" << kTimeFieldName << "'"};
+    }
+    if (options.metaField && *options.metaField == options.timeField) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "'" << kMetaFieldName << "' and '" << kTimeFieldName
+                              << "' must be different fields"};
+    }
+    return options;
+}
+
+BSONObj TimeseriesOptions::toBSON() const {
+    BSONObjBuilder builder;
+    builder.append(kTimeFieldName, timeField);
+    if (metaField) {
+        builder.append(kMetaFieldName, *metaField);
+    }
+    builder.append(kBucketMaxSpanSecondsFieldName, bucketMaxSpanSeconds);
+    return builder.obj();
+}
+
+}  // namespace mongo
@@ -0,0 +1,88 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <string>
+
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+
+namespace mongo {
+
+/**
+ * A time-series collection is a view over a buckets collection named system.buckets.<view name>.
+ * Each bucket document holds the measurements of one meta value over one time window, stored by
+ * field rather than by measurement:
+ *
+ *   {_id: <ObjectId>,
+ *    meta: <the measurements' metaField value, if the collection has a metaField>,
+ *    control: {min: {<timeField>: <earliest time>}, max: {<timeField>: <latest time>}},
+ *    data: {<field>: {"0": <value in measurement 0>, "1": <value in measurement 1>, ...}, ...}}
+ *
+ * The view's pipeline is a single $_internalUnpackBucket stage whose specification is the
+ * collection's TimeseriesOptions, so the options live in the view catalog.
+ */
+struct TimeseriesOptions {
+    // Name of the aggregation stage defining time-series views.
+    static constexpr StringData kUnpackBucketStageName = "$_internalUnpackBucket"_sd;
+
+    static constexpr StringData kBucketMetaFieldName = "meta"_sd;
+    static constexpr StringData kBucketControlFieldName = "control"_sd;
+    static constexpr StringData kBucketDataFieldName = "data"_sd;
+    static constexpr StringData kControlMinFieldName = "min"_sd;
+    static constexpr StringData kControlMaxFieldName = "max"_sd;
+
+    static constexpr StringData kTimeFieldName = "timeField"_sd;
+    static constexpr StringData kMetaFieldName = "metaField"_sd;
+    static constexpr StringData kBucketMaxSpanSecondsFieldName = "bucketMaxSpanSeconds"_sd;
+
+    static constexpr int kDefaultBucketMaxSpanSeconds = 3600;
+
+    /**
+     * Parses {timeField: <string>, metaField: <string>, bucketMaxSpanSeconds: <int>}, of which
+     * only timeField is required.
+     */
+    static StatusWith<TimeseriesOptions> parse(const BSONObj& obj);
+
+    BSONObj toBSON() const;
+
+    // Field of each measurement holding its time, which must be a date.
+    std::string timeField;
+
+    // Field of each measurement holding what it measures, such as a sensor id. Measurements are
+    // only bucketed together if they have the same meta value.
+    boost::optional<std::string> metaField;
+
+    // Longest time span covered by one bucket.
+    int bucketMaxSpanSeconds = kDefaultBucketMaxSpanSeconds;
+};
+
+}  // namespace mongo
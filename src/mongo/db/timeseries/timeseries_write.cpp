@@ -0,0 +1,391 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/timeseries/timeseries_write.h"
+
+#include <map>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/catalog/create_collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/drop_collection.h"
+#include "mongo/db/commands/feature_compatibility_version_command_parser.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/ops/insert.h"
+#include "mongo/db/ops/write_ops_gen.h"
+#include "mongo/db/server_options.h"
+#include "mongo/db/timeseries/bucket_catalog.h"
+#include "mongo/db/views/view_catalog.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace {
+
+struct Measurement {
+    size_t index;
+    BSONObj doc;
+    Date_t time;
+};
+
+/**
+ * Measurements with the same meta value and time window, which go to the same buckets.
+ */
+struct Group {
+    BSONObj meta;
+    Date_t windowStart;
+    std::vector<Measurement> measurements;
+};
+
+std::string makeGroupKey(const BSONObj& meta, Date_t windowStart) {
+    std::string key(meta.objdata(), meta.objsize());
+    key.append(std::to_string(windowStart.toMillisSinceEpoch()));
+    return key;
+}
+
+/**
+ * Checks 'doc' can be stored in a bucket and fills in its _id, returning it with its time.
+ */
+StatusWith<Measurement> makeMeasurement(OperationContext* opCtx,
+                                        size_t index,
+                                        const BSONObj& doc,
+                                        const TimeseriesOptions& options) {
+    auto fixed = fixDocumentForInsert(opCtx->getServiceContext(), doc);
+    if (!fixed.isOK()) {
+        return fixed.getStatus();
+    }
+    BSONObj measurement = fixed.getValue().isEmpty() ? doc : fixed.getValue();
+
+    for (auto&& elem : measurement) {
+        if (StringData(elem.fieldNameStringData()).find('.') != std::string::npos) {
+            return {ErrorCodes::BadValue,
+                    str::stream() << "field names of time-series measurements may not contain "
+                                     "'.': "
+                                  << elem.fieldNameStringData()};
+        }
+    }
+
+    auto timeElem = measurement[options.timeField];
+    if (timeElem.type() != BSONType::Date) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "'" << options.timeField
+                              << "' must be present and contain a valid BSON UTC datetime value"};
+    }
+    return Measurement{index, measurement, timeElem.Date()};
+}
+
+BSONObj getMeta(const Measurement& measurement, const TimeseriesOptions& options) {
+    if (!options.metaField) {
+        return BSONObj();
+    }
+    auto metaElem = measurement.doc[*options.metaField];
+    return metaElem ? metaElem.wrap("") : BSONObj();
+}
+
+/**
+ * Builds the upsert which adds 'measurements', starting at position 'firstPosition', to the
+ * bucket 'bucketId'.
+ */
+write_ops::UpdateOpEntry makeBucketUpdate(const OID& bucketId,
+                                          int firstPosition,
+                                          const BSONObj& meta,
+                                          std::vector<Measurement>::const_iterator begin,
+                                          std::vector<Measurement>::const_iterator end,
+                                          const TimeseriesOptions& options) {
+    Date_t minTime = begin->time;
+    Date_t maxTime = begin->time;
+    for (auto it = begin; it != end; ++it) {
+        minTime = std::min(minTime, it->time);
+        maxTime = std::max(maxTime, it->time);
+    }
+
+    const std::string controlSuffix = "." + options.timeField;
+    const std::string dataPrefix = TimeseriesOptions::kBucketDataFieldName + ".";
+
+    BSONObjBuilder u;
+    if (!meta.isEmpty()) {
+        BSONObjBuilder setOnInsert(u.subobjStart("$setOnInsert"));
+        setOnInsert.appendAs(meta.firstElement(), TimeseriesOptions::kBucketMetaFieldName);
+    }
+    {
+        BSONObjBuilder min(u.subobjStart("$min"));
+        min.append(TimeseriesOptions::kBucketControlFieldName + "." +
+                       TimeseriesOptions::kControlMinFieldName + controlSuffix,
+                   minTime);
+    }
+    {
+        BSONObjBuilder max(u.subobjStart("$max"));
+        max.append(TimeseriesOptions::kBucketControlFieldName + "." +
+                       TimeseriesOptions::kControlMaxFieldName + controlSuffix,
+                   maxTime);
+    }
+    {
+        BSONObjBuilder set(u.subobjStart("$set"));
+        int position = firstPosition;
+        for (auto it = begin; it != end; ++it, ++position) {
+            const std::string positionSuffix = "." + std::to_string(position);
+            for (auto&& elem : it->doc) {
+                if (options.metaField && elem.fieldNameStringData() == *options.metaField) {
+                    continue;
+                }
+                set.appendAs(elem, dataPrefix + elem.fieldNameStringData() + positionSuffix);
+            }
+        }
+    }
+
+    write_ops::UpdateOpEntry update;
+    update.setQ(BSON("_id" << bucketId));
+    update.setU(u.obj());
+    update.setUpsert(true);
+    update.setMulti(false);
+    return update;
+}
+
+SingleWriteResult makeInsertResult() {
+    SingleWriteResult result;
+    result.setN(1);
+    result.setNModified(0);
+    return result;
+}
+
+}  // namespace
+
+boost::optional<TimeseriesOptions> getTimeseriesOptions(OperationContext* opCtx,
+                                                        const NamespaceString& nss) {
+    AutoGetDb autoDb(opCtx, nss.db(), MODE_IS);
+    Database* db = autoDb.getDb();
+    if (!db || db->getCollection(opCtx, nss)) {
+        return boost::none;
+    }
+
+    auto view = db->getViewCatalog()->lookup(opCtx, nss.ns());
+    if (!view || view->viewOn() != nss.makeTimeseriesBucketsNamespace() ||
+        view->pipeline().size() != 1) {
+        return boost::none;
+    }
+
+    auto stage = view->pipeline().front().firstElement();
+    if (stage.fieldNameStringData() != TimeseriesOptions::kUnpackBucketStageName ||
+        stage.type() != BSONType::Object) {
+        return boost::none;
+    }
+
+    auto options = TimeseriesOptions::parse(stage.Obj());
+    if (!options.isOK()) {
+        return boost::none;
+    }
+    return std::move(options.getValue());
+}
+
+Status createTimeseriesCollection(OperationContext* opCtx,
+                                  const NamespaceString& nss,
+                                  const BSONObj& cmdObj) {
+    if (serverGlobalParams.featureCompatibility.version.load() ==
+        ServerGlobalParams::FeatureCompatibility::Version::k34) {
+        return {ErrorCodes::InvalidOptions,
+                str::stream() << "The featureCompatibilityVersion must be 3.6 to create a "
+                                 "time-series collection. See "
+                              << feature_compatibility_version::kDochubLink
+                              << "."};
+    }
+    if (cmdObj["timeseries"].type() != BSONType::Object) {
+        return {ErrorCodes::TypeMismatch, "'timeseries' has to be a document"};
+    }
+    auto options = TimeseriesOptions::parse(cmdObj["timeseries"].Obj());
+    if (!options.isOK()) {
+        return options.getStatus();
+    }
+
+    const auto bucketsNss = nss.makeTimeseriesBucketsNamespace();
+    BSONObjBuilder bucketsCmd;
+    bucketsCmd.append("create", bucketsNss.coll());
+    for (auto&& elem : cmdObj) {
+        const auto fieldName = elem.fieldNameStringData();
+        if (fieldName != "create" && fieldName != "timeseries") {
+            bucketsCmd.append(elem);
+        }
+    }
+    auto status = createCollection(opCtx, nss.db().toString(), bucketsCmd.obj());
+    if (!status.isOK()) {
+        return status;
+    }
+
+    // Queries select buckets by meta value and time range; see DocumentSourceInternalUnpackBucket.
+    BSONObjBuilder keyPattern;
+    if (options.getValue().metaField) {
+        keyPattern.append(TimeseriesOptions::kBucketMetaFieldName, 1);
+    }
+    const std::string controlSuffix = "." + options.getValue().timeField;
+    keyPattern.append(TimeseriesOptions::kBucketControlFieldName + "." +
+                          TimeseriesOptions::kControlMinFieldName + controlSuffix,
+                      1);
+    keyPattern.append(TimeseriesOptions::kBucketControlFieldName + "." +
+                          TimeseriesOptions::kControlMaxFieldName + controlSuffix,
+                      1);
+
+    DBDirectClient client(opCtx);
+    BSONObj indexResult;
+    client.runCommand(nss.db().toString(),
+                      BSON("createIndexes" << bucketsNss.coll() << "indexes"
+                                           << BSON_ARRAY(BSON("key" << keyPattern.obj() << "name"
+                                                                    << "meta_time"))),
+                      indexResult);
+    status = getStatusFromCommandResult(indexResult);
+
+    if (status.isOK()) {
+        status = createCollection(
+            opCtx,
+            nss.db().toString(),
+            BSON("create" << nss.coll() << "viewOn" << bucketsNss.coll() << "pipeline"
+                          << BSON_ARRAY(BSON(TimeseriesOptions::kUnpackBucketStageName
+                                             << options.getValue().toBSON()))));
+    }
+
+    if (!status.isOK()) {
+        BSONObj dropResult;
+        client.runCommand(nss.db().toString(), BSON("drop" << bucketsNss.coll()), dropResult);
+    }
+    return status;
+}
+
+Status dropTimeseriesBuckets(OperationContext* opCtx, const NamespaceString& nss) {
+    const auto bucketsNss = nss.makeTimeseriesBucketsNamespace();
+    BSONObjBuilder result;
+    auto status = dropCollection(opCtx,
+                                 bucketsNss,
+                                 result,
+                                 {},
+                                 DropCollectionSystemCollectionMode::kAllowSystemCollectionDrops);
+    BucketCatalog::get(opCtx->getServiceContext()).clear(bucketsNss);
+    return status == ErrorCodes::NamespaceNotFound ? Status::OK() : status;
+}
+
+WriteResult performTimeseriesInserts(OperationContext* opCtx,
+                                     const write_ops::Insert& wholeOp,
+                                     const TimeseriesOptions& options) {
+    const auto& docs = wholeOp.getDocuments();
+    const bool ordered = wholeOp.getWriteCommandBase().getOrdered();
+    const auto bucketsNss = wholeOp.getNamespace().makeTimeseriesBucketsNamespace();
+
+    // An ordered insert stops at the first invalid measurement, and only groups runs of
+    // consecutive measurements so that the buckets are written in the order of the measurements.
+    std::vector<boost::optional<StatusWith<SingleWriteResult>>> docResults(docs.size());
+    std::vector<Group> groups;
+    std::map<std::string, size_t> groupIndexes;
+    for (size_t i = 0; i < docs.size(); ++i) {
+        auto measurement = makeMeasurement(opCtx, i, docs[i], options);
+        if (!measurement.isOK()) {
+            docResults[i] = measurement.getStatus();
+            if (ordered) {
+                break;
+            }
+            continue;
+        }
+
+        auto meta = getMeta(measurement.getValue(), options);
+        auto windowStart = BucketCatalog::getWindowStart(measurement.getValue().time,
+                                                         options.bucketMaxSpanSeconds);
+        auto key = makeGroupKey(meta, windowStart);
+        if (ordered) {
+            const bool startsRun = groups.empty() ||
+                makeGroupKey(groups.back().meta, groups.back().windowStart) != key;
+            if (startsRun) {
+                groups.push_back({meta, windowStart, {}});
+            }
+            groups.back().measurements.push_back(std::move(measurement.getValue()));
+            continue;
+        }
+
+        auto inserted = groupIndexes.emplace(key, groups.size());
+        if (inserted.second) {
+            groups.push_back({meta, windowStart, {}});
+        }
+        groups[inserted.first->second].measurements.push_back(std::move(measurement.getValue()));
+    }
+
+    auto& catalog = BucketCatalog::get(opCtx->getServiceContext());
+    write_ops::Update updateOp(bucketsNss);
+    updateOp.setWriteCommandBase(wholeOp.getWriteCommandBase());
+    std::vector<write_ops::UpdateOpEntry> updates;
+    std::vector<std::pair<std::vector<Measurement>::const_iterator,
+                          std::vector<Measurement>::const_iterator>>
+        updateMeasurements;
+    for (const auto& group : groups) {
+        auto allocations = catalog.allocate(bucketsNss,
+                                            group.meta,
+                                            group.windowStart,
+                                            options.bucketMaxSpanSeconds,
+                                            group.measurements.size());
+        auto begin = group.measurements.cbegin();
+        for (const auto& allocation : allocations) {
+            auto end = begin + allocation.count;
+            updates.push_back(makeBucketUpdate(
+                allocation.bucketId, allocation.firstPosition, group.meta, begin, end, options));
+            updateMeasurements.emplace_back(begin, end);
+            begin = end;
+        }
+    }
+
+    WriteResult out;
+    if (!updates.empty()) {
+        updateOp.setUpdates(std::move(updates));
+        auto reply = performUpdates(opCtx, updateOp);
+        for (size_t i = 0; i < reply.results.size(); ++i) {
+            for (auto it = updateMeasurements[i].first; it != updateMeasurements[i].second; ++it) {
+                if (reply.results[i].isOK()) {
+                    docResults[it->index] = makeInsertResult();
+                } else {
+                    docResults[it->index] = reply.results[i].getStatus();
+                    if (ordered) {
+                        break;
+                    }
+                }
+            }
+        }
+        out.staleConfigException = std::move(reply.staleConfigException);
+    }
+
+    // Results stop at the first measurement which was not attempted.
+    for (auto&& result : docResults) {
+        if (!result) {
+            break;
+        }
+        out.results.push_back(std::move(*result));
+        if (ordered && !out.results.back().isOK()) {
+            break;
+        }
+    }
+    return out;
+}
+
+}  // namespace mongo
@@ -0,0 +1,75 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+
+#include "mongo/base/status.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/ops/write_ops_exec.h"
+#include "mongo/db/timeseries/timeseries_options.h"
+
+namespace mongo {
+
+class OperationContext;
+
+namespace write_ops {
+class Insert;
+}  // namespace write_ops
+
+/**
+ * Returns the options of 'nss' if it is a time-series collection, that is a view on its buckets
+ * collection defined by a $_internalUnpackBucket stage.
+ */
+boost::optional<TimeseriesOptions> getTimeseriesOptions(OperationContext* opCtx,
+                                                        const NamespaceString& nss);
+
+/**
+ * Creates the time-series collection 'nss' as described by the "timeseries" field of the create
+ * command 'cmdObj': its buckets collection, the buckets' index on meta value and time, and the
+ * view over them. The remaining options of 'cmdObj' apply to the buckets collection.
+ */
+Status createTimeseriesCollection(OperationContext* opCtx,
+                                  const NamespaceString& nss,
+                                  const BSONObj& cmdObj);
+
+/**
+ * Drops the buckets collection of the time-series collection 'nss', once its view is dropped.
+ */
+Status dropTimeseriesBuckets(OperationContext* opCtx, const NamespaceString& nss);
+
+/**
+ * Inserts the measurements of 'wholeOp' into the buckets of the time-series collection it
+ * targets. Results map 1-to-1 to the measurements, as for performInserts().
+ */
+WriteResult performTimeseriesInserts(OperationContext* opCtx,
+                                     const write_ops::Insert& wholeOp,
+                                     const TimeseriesOptions& options);
+
+}  // namespace mongo
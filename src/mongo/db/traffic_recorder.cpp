@@ -0,0 +1,304 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kControl
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/traffic_recorder.h"
+
+#include <boost/filesystem.hpp>
+#include <deque>
+#include <fstream>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/traffic_recording_format.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+namespace {
+
+// Recording is refused unless this names a directory, so that an administrator, and not a client
+// with the right privileges, decides where recordings may be written.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(trafficRecordingDirectory, std::string, "");
+
+const auto getTrafficRecorder = ServiceContext::declareDecoration<TrafficRecorder>();
+
+}  // namespace
+
+class TrafficRecorder::Recording {
+    MONGO_DISALLOW_COPYING(Recording);
+
+public:
+    Recording(std::string path,
+              long long maxFileSize,
+              long long maxBufferSize,
+              AtomicWord<bool>* shouldRecord)
+        : _path(std::move(path)),
+          _maxFileSize(maxFileSize),
+          _maxBufferSize(maxBufferSize),
+          _shouldRecord(shouldRecord) {}
+
+    ~Recording() {
+        shutdown();
+    }
+
+    Status open() {
+        _out.open(_path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        if (!_out) {
+            return {ErrorCodes::FileOpenFailed,
+                    str::stream() << "Failed to open traffic recording file " << _path};
+        }
+
+        _startMicros = curTimeMicros64();
+        writeTrafficRecordingHeader(_out, Date_t::now());
+        _bytesWritten = kTrafficRecordingHeaderSize;
+
+        _thread = stdx::thread([this] { _run(); });
+        return Status::OK();
+    }
+
+    void push(transport::SessionId sessionId, const Message& message) {
+        TrafficRecordingPacket packet;
+        packet.sessionId = sessionId;
+        packet.offsetMicros = static_cast<long long>(curTimeMicros64() - _startMicros);
+        // Shares the received buffer rather than copying it. Requests are not modified once they
+        // have been received.
+        packet.message = message;
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_bufferedBytes + message.size() > _maxBufferSize) {
+            ++_packetsDropped;
+            return;
+        }
+        _bufferedBytes += message.size();
+        _buffer.push_back(std::move(packet));
+        _condition.notify_one();
+    }
+
+    /**
+     * Waits for the writer to drain the buffer and exit. Safe to call more than once.
+     */
+    void shutdown() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _inShutdown = true;
+            _condition.notify_one();
+        }
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    void report(BSONObjBuilder* builder) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        builder->append("file", _path);
+        builder->append("packetsRecorded", _packetsRecorded);
+        builder->append("packetsDropped", _packetsDropped);
+        builder->append("bytesWritten", _bytesWritten);
+        if (!_writerStatus.isOK()) {
+            builder->append("stoppedEarly", _writerStatus.reason());
+        }
+    }
+
+private:
+    void _run() {
+        setThreadName("trafficRecorder");
+
+        while (true) {
+            std::deque<TrafficRecordingPacket> batch;
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                MONGO_IDLE_THREAD_BLOCK;
+                _condition.wait(lk, [&] { return _inShutdown || !_buffer.empty(); });
+                if (_buffer.empty()) {
+                    return;
+                }
+                batch.swap(_buffer);
+            }
+
+            // The batch still counts against the buffer limit until it has been written, so that
+            // the limit bounds all the memory held on behalf of the recording.
+            long long batchBytes = 0;
+            long long batchWritten = 0;
+            long long batchPackets = 0;
+            Status status = Status::OK();
+            for (const auto& packet : batch) {
+                batchBytes += packet.message.size();
+
+                const long long size = kTrafficRecordingPacketHeaderSize + packet.message.size();
+                if (_bytesWritten + batchWritten + size > _maxFileSize) {
+                    status = {ErrorCodes::OperationFailed,
+                              str::stream() << "Traffic recording reached its maximum size of "
+                                            << _maxFileSize << " bytes"};
+                    break;
+                }
+
+                writeTrafficRecordingPacket(_out, packet);
+                batchWritten += size;
+                ++batchPackets;
+            }
+
+            _out.flush();
+            if (status.isOK() && !_out) {
+                status = {ErrorCodes::FileStreamFailed,
+                          str::stream() << "Failed to write traffic recording file " << _path};
+            }
+
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _bufferedBytes -= batchBytes;
+            _bytesWritten += batchWritten;
+            _packetsRecorded += batchPackets;
+            if (!status.isOK()) {
+                log() << "Stopping traffic recording: " << status.reason();
+                _writerStatus = status;
+                _shouldRecord->store(false);
+                return;
+            }
+        }
+    }
+
+    const std::string _path;
+    const long long _maxFileSize;
+    const long long _maxBufferSize;
+    AtomicWord<bool>* const _shouldRecord;
+
+    // Only used by the writer thread once it has been started.
+    std::ofstream _out;
+    unsigned long long _startMicros = 0;
+    stdx::thread _thread;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _condition;
+
+    // Requests waiting for the writer, and their total size.
+    std::deque<TrafficRecordingPacket> _buffer;
+    long long _bufferedBytes = 0;
+
+    bool _inShutdown = false;
+    Status _writerStatus = Status::OK();
+
+    long long _packetsRecorded = 0;
+    long long _packetsDropped = 0;
+    long long _bytesWritten = 0;
+};
+
+TrafficRecorder& TrafficRecorder::get(ServiceContext* svc) {
+    return getTrafficRecorder(svc);
+}
+
+TrafficRecorder::TrafficRecorder() = default;
+
+TrafficRecorder::~TrafficRecorder() = default;
+
+Status TrafficRecorder::start(const std::string& filename,
+                              long long maxFileSize,
+                              long long maxBufferSize) {
+    if (trafficRecordingDirectory.empty()) {
+        return {ErrorCodes::IllegalOperation,
+                "Traffic recording is disabled; set the trafficRecordingDirectory startup "
+                "parameter to enable it"};
+    }
+
+    if (filename.empty() || filename.find_first_of("/\\") != std::string::npos ||
+        filename[0] == '.') {
+        return {ErrorCodes::BadValue,
+                str::stream() << "Invalid traffic recording file name '" << filename
+                              << "', it must name a file directly inside "
+                              << trafficRecordingDirectory};
+    }
+
+    if (maxFileSize <= 0 || maxBufferSize <= 0) {
+        return {ErrorCodes::BadValue, "Traffic recording sizes must be positive"};
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_recording) {
+        return {ErrorCodes::IllegalOperation, "Traffic recording is already running"};
+    }
+
+    const auto path = boost::filesystem::path(trafficRecordingDirectory) / filename;
+    auto recording =
+        std::make_shared<Recording>(path.string(), maxFileSize, maxBufferSize, &_shouldRecord);
+    Status status = recording->open();
+    if (!status.isOK()) {
+        return status;
+    }
+
+    log() << "Started recording traffic to " << path.string();
+    _recording = std::move(recording);
+    _shouldRecord.store(true);
+    return Status::OK();
+}
+
+Status TrafficRecorder::stop(BSONObjBuilder* result) {
+    std::shared_ptr<Recording> recording;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (!_recording) {
+            return {ErrorCodes::IllegalOperation, "Traffic recording is not running"};
+        }
+        _shouldRecord.store(false);
+        recording = std::move(_recording);
+    }
+
+    // Connections which loaded the old recording just before the flag was cleared may still push
+    // into it. Whatever they push after the writer has exited is discarded with the recording.
+    recording->shutdown();
+    recording->report(result);
+    log() << "Stopped recording traffic";
+    return Status::OK();
+}
+
+void TrafficRecorder::_observe(transport::SessionId sessionId, const Message& message) {
+    const auto op = message.operation();
+    if (op != dbMsg && op != dbQuery) {
+        return;
+    }
+
+    std::shared_ptr<Recording> recording;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        recording = _recording;
+    }
+
+    if (recording) {
+        recording->push(sessionId, message);
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,100 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/compiler.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/transport/session_id.h"
+#include "mongo/util/net/message.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+class ServiceContext;
+
+/**
+ * Records inbound OP_MSG and OP_QUERY requests to a file in the format described in
+ * traffic_recording_format.h, so that a production workload can later be replayed against another
+ * build to look for performance regressions.
+ *
+ * Recording never blocks the connection it observes: requests are appended to a bounded in-memory
+ * buffer which a background thread drains to disk, and requests that do not fit in the buffer are
+ * dropped and counted instead. When no recording is running, observe() costs a single atomic load.
+ */
+class TrafficRecorder {
+    MONGO_DISALLOW_COPYING(TrafficRecorder);
+
+public:
+    static TrafficRecorder& get(ServiceContext* svc);
+
+    TrafficRecorder();
+    ~TrafficRecorder();
+
+    /**
+     * Starts recording to 'filename' in the directory named by the trafficRecordingDirectory
+     * startup parameter. Recording stops by itself once the file would grow past 'maxFileSize'
+     * bytes. At most 'maxBufferSize' bytes of requests wait in memory for the writer.
+     */
+    Status start(const std::string& filename, long long maxFileSize, long long maxBufferSize);
+
+    /**
+     * Stops the running recording, waits for its buffered requests to reach the file, and reports
+     * what it recorded into 'result'.
+     */
+    Status stop(BSONObjBuilder* result);
+
+    /**
+     * Records 'message', which has just been received on session 'sessionId', if a recording is
+     * running.
+     */
+    void observe(transport::SessionId sessionId, const Message& message) {
+        if (MONGO_likely(!_shouldRecord.load())) {
+            return;
+        }
+        _observe(sessionId, message);
+    }
+
+private:
+    class Recording;
+
+    void _observe(transport::SessionId sessionId, const Message& message);
+
+    AtomicWord<bool> _shouldRecord{false};
+
+    stdx::mutex _mutex;
+    std::shared_ptr<Recording> _recording;
+};
+
+}  // namespace mongo
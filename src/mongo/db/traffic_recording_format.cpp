@@ -0,0 +1,115 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/traffic_recording_format.h"
+
+#include <istream>
+#include <ostream>
+
+#include "mongo/base/data_view.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+const StringData kTrafficRecordingMagic = "MDBTRAF1"_sd;
+
+namespace {
+
+const size_t kMinRecordSize = kTrafficRecordingPacketHeaderSize + sizeof(MSGHEADER::Value);
+const size_t kMaxRecordSize = kTrafficRecordingPacketHeaderSize + MaxMessageSizeBytes;
+
+}  // namespace
+
+void writeTrafficRecordingHeader(std::ostream& out, Date_t started) {
+    char header[kTrafficRecordingHeaderSize];
+    std::copy(kTrafficRecordingMagic.begin(), kTrafficRecordingMagic.end(), header);
+    DataView(header).write<LittleEndian<long long>>(started.toMillisSinceEpoch(), 8);
+    out.write(header, sizeof(header));
+}
+
+size_t writeTrafficRecordingPacket(std::ostream& out, const TrafficRecordingPacket& packet) {
+    const size_t size = kTrafficRecordingPacketHeaderSize + packet.message.size();
+
+    char header[kTrafficRecordingPacketHeaderSize];
+    DataView view(header);
+    view.write<LittleEndian<int32_t>>(static_cast<int32_t>(size), 0);
+    view.write<LittleEndian<uint64_t>>(packet.sessionId, 4);
+    view.write<LittleEndian<long long>>(packet.offsetMicros, 12);
+
+    out.write(header, sizeof(header));
+    out.write(packet.message.buf(), packet.message.size());
+    return size;
+}
+
+StatusWith<TrafficRecording> readTrafficRecording(std::istream& in) {
+    char header[kTrafficRecordingHeaderSize];
+    if (!in.read(header, sizeof(header)) ||
+        StringData(header, kTrafficRecordingMagic.size()) != kTrafficRecordingMagic) {
+        return {ErrorCodes::FailedToParse, "Not a traffic recording"};
+    }
+
+    TrafficRecording recording;
+    recording.started =
+        Date_t::fromMillisSinceEpoch(ConstDataView(header).read<LittleEndian<long long>>(8));
+
+    char packetHeader[kTrafficRecordingPacketHeaderSize];
+    while (in.read(packetHeader, sizeof(packetHeader))) {
+        ConstDataView view(packetHeader);
+        const auto size = view.read<LittleEndian<int32_t>>();
+        if (size < static_cast<int32_t>(kMinRecordSize) ||
+            size > static_cast<int32_t>(kMaxRecordSize)) {
+            return {ErrorCodes::FailedToParse,
+                    str::stream() << "Invalid traffic recording record size " << size
+                                  << " after " << recording.packets.size() << " records"};
+        }
+
+        TrafficRecordingPacket packet;
+        packet.sessionId = view.read<LittleEndian<uint64_t>>(4);
+        packet.offsetMicros = view.read<LittleEndian<long long>>(12);
+
+        const size_t messageSize = size - kTrafficRecordingPacketHeaderSize;
+        auto buffer = SharedBuffer::allocate(messageSize);
+        if (!in.read(buffer.get(), messageSize)) {
+            break;
+        }
+        packet.message.setData(std::move(buffer));
+        if (static_cast<size_t>(packet.message.size()) != messageSize) {
+            return {ErrorCodes::FailedToParse,
+                    str::stream() << "Traffic recording record " << recording.packets.size()
+                                  << " does not hold a single message"};
+        }
+
+        recording.packets.push_back(std::move(packet));
+    }
+
+    return std::move(recording);
+}
+
+}  // namespace mongo
@@ -0,0 +1,98 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <iosfwd>
+#include <vector>
+
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+#include "mongo/transport/session_id.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+/**
+ * Traffic recordings are flat files of inbound client requests, written by the server's
+ * TrafficRecorder and read back by the shell's traffic replay.
+ *
+ * A recording starts with a header:
+ *   char[8]  magic, "MDBTRAF1"
+ *   int64    wall clock time at which the recording started, in milliseconds since the epoch
+ *
+ * followed by one record per request, all integers little-endian:
+ *   int32    length of the record, including this field
+ *   uint64   id of the session on which the request arrived
+ *   int64    arrival time, in microseconds since the start of the recording
+ *   ...      the request exactly as received, starting with its MsgHeader
+ */
+extern const StringData kTrafficRecordingMagic;
+
+/**
+ * One recorded request.
+ */
+struct TrafficRecordingPacket {
+    transport::SessionId sessionId = 0;
+    long long offsetMicros = 0;
+    Message message;
+};
+
+/**
+ * A recording read back into memory.
+ */
+struct TrafficRecording {
+    Date_t started;
+    std::vector<TrafficRecordingPacket> packets;
+};
+
+/**
+ * Sizes, in bytes, of the recording header and of the fixed part of each record.
+ */
+constexpr size_t kTrafficRecordingHeaderSize = 16;
+constexpr size_t kTrafficRecordingPacketHeaderSize = 20;
+
+/**
+ * Writes the recording header. Stream errors are left for the caller to check.
+ */
+void writeTrafficRecordingHeader(std::ostream& out, Date_t started);
+
+/**
+ * Writes one record and returns the number of bytes written. Stream errors are left for the
+ * caller to check.
+ */
+size_t writeTrafficRecordingPacket(std::ostream& out, const TrafficRecordingPacket& packet);
+
+/**
+ * Reads a whole recording. A record truncated by the end of the stream, as happens when the
+ * server stops while writing, ends the recording rather than failing it.
+ */
+StatusWith<TrafficRecording> readTrafficRecording(std::istream& in);
+
+}  // namespace mongo
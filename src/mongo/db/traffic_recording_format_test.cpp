@@ -0,0 +1,115 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/traffic_recording_format.h"
+
+#include <sstream>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/net/op_msg.h"
+
+namespace mongo {
+namespace {
+
+TrafficRecordingPacket makePacket(transport::SessionId sessionId,
+                                  long long offsetMicros,
+                                  const BSONObj& body) {
+    TrafficRecordingPacket packet;
+    packet.sessionId = sessionId;
+    packet.offsetMicros = offsetMicros;
+    packet.message = OpMsgRequest::fromDBAndBody("test", body).serialize();
+    return packet;
+}
+
+TEST(TrafficRecordingFormat, RoundTrip) {
+    const auto started = Date_t::fromMillisSinceEpoch(1500000000000LL);
+    std::vector<TrafficRecordingPacket> packets{
+        makePacket(1, 0, BSON("ping" << 1)),
+        makePacket(2, 150, BSON("find"
+                                << "coll"
+                                << "filter"
+                                << BSON("x" << 1))),
+        makePacket(1, 1000000, BSON("insert"
+                                    << "coll")),
+    };
+
+    std::stringstream stream;
+    writeTrafficRecordingHeader(stream, started);
+    size_t expectedSize = kTrafficRecordingHeaderSize;
+    for (const auto& packet : packets) {
+        expectedSize += writeTrafficRecordingPacket(stream, packet);
+    }
+    ASSERT_EQ(expectedSize, stream.str().size());
+
+    auto swRecording = readTrafficRecording(stream);
+    ASSERT_OK(swRecording.getStatus());
+    const auto& recording = swRecording.getValue();
+    ASSERT_EQ(started, recording.started);
+    ASSERT_EQ(packets.size(), recording.packets.size());
+    for (size_t i = 0; i < packets.size(); ++i) {
+        const auto& expected = packets[i];
+        const auto& actual = recording.packets[i];
+        ASSERT_EQ(expected.sessionId, actual.sessionId);
+        ASSERT_EQ(expected.offsetMicros, actual.offsetMicros);
+        ASSERT_EQ(expected.message.size(), actual.message.size());
+        ASSERT_EQ(0, memcmp(expected.message.buf(), actual.message.buf(), actual.message.size()));
+    }
+}
+
+TEST(TrafficRecordingFormat, TruncatedRecordEndsRecording) {
+    std::stringstream stream;
+    writeTrafficRecordingHeader(stream, Date_t::now());
+    writeTrafficRecordingPacket(stream, makePacket(1, 0, BSON("ping" << 1)));
+    writeTrafficRecordingPacket(stream, makePacket(1, 10, BSON("ping" << 1)));
+
+    auto contents = stream.str();
+    std::stringstream truncated(contents.substr(0, contents.size() - 5));
+    auto swRecording = readTrafficRecording(truncated);
+    ASSERT_OK(swRecording.getStatus());
+    ASSERT_EQ(1U, swRecording.getValue().packets.size());
+}
+
+TEST(TrafficRecordingFormat, RejectsOtherFiles) {
+    std::stringstream stream("not a recording at all");
+    ASSERT_EQ(ErrorCodes::FailedToParse, readTrafficRecording(stream).getStatus());
+}
+
+TEST(TrafficRecordingFormat, RejectsCorruptRecordSize) {
+    std::stringstream stream;
+    writeTrafficRecordingHeader(stream, Date_t::now());
+    auto contents = stream.str();
+    contents.append(std::string(kTrafficRecordingPacketHeaderSize, '\0'));
+    std::stringstream corrupt(contents);
+    ASSERT_EQ(ErrorCodes::FailedToParse, readTrafficRecording(corrupt).getStatus());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -34,6 +34,9 @@
 
 #include "mongo/db/ttl.h"
 
+#include <algorithm>
+#include <map>
+
 #include "mongo/base/counter.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/user_name.h"
@@ -44,19 +47,23 @@
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands/fsync.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
-#include "mongo/db/exec/delete.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/ops/insert.h"
+#include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/ttl_collection_cache.h"
 #include "mongo/util/background.h"
 #include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
 
@@ -64,14 +71,110 @@ namespace mongo {
 
 Counter64 ttlPasses;
 Counter64 ttlDeletedDocuments;
+Counter64 ttlThrottledMillis;
 
 ServerStatusMetricField<Counter64> ttlPassesDisplay("ttl.passes", &ttlPasses);
 ServerStatusMetricField<Counter64> ttlDeletedDocumentsDisplay("ttl.deletedDocuments",
                                                               &ttlDeletedDocuments);
+ServerStatusMetricField<Counter64> ttlThrottledMillisDisplay("ttl.throttledMillis",
+                                                             &ttlThrottledMillis);
 
 MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorEnabled, bool, true);
 MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorSleepSecs, int, 60);  // used for testing
 
+// Number of TTL indexes processed at the same time.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ttlMonitorMaxThreads, int, 4);
+
+// Number of expired documents deleted per storage transaction.
+MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorBatchSize, int, 100);
+
+// Time a pass may spend on one index. Documents still expired when it runs out are deleted by
+// later passes, so that one large backlog cannot hold up every other TTL index.
+MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorIndexDeadlineSecs, int, 60);
+
+// Deletion pauses while the majority commit point trails this node's last applied optime by more
+// than this many seconds, or while a larger fraction of the storage engine cache than
+// ttlMonitorMaxCacheDirtyRatio is dirty. Zero disables either check. Both are off by default: a
+// pause is only bounded by ttlMonitorIndexDeadlineSecs, so when the commit point cannot advance
+// (e.g. a PSA set with its secondary down) or the cache stays dirty under load, every pass would
+// delete nothing and expired documents would accumulate without bound.
+MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorMaxReplicationLagSecs, int, 0);
+MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorMaxCacheDirtyRatio, double, 0.0);
+
+namespace {
+
+const Milliseconds kThrottleInterval{100};
+
+// Upper bound on the keys scanned to estimate an index's backlog.
+const long long kBacklogScanLimit = 10000;
+
+/**
+ * What the last pass over one TTL index did, and what it left behind.
+ */
+struct TTLIndexStats {
+    BSONObj toBSON() const {
+        BSONObjBuilder builder;
+        builder.append("ns", ns);
+        builder.append("name", name);
+        builder.append("lastPassDeleted", lastPassDeleted);
+        builder.append("lastPassMillis", lastPassMillis);
+        builder.append("lastPassThrottledMillis", lastPassThrottledMillis);
+        builder.append("lastPassComplete", lastPassComplete);
+        builder.append("backlog", backlog);
+        builder.append("backlogIsLowerBound", backlogIsLowerBound);
+        builder.append("totalDeleted", totalDeleted);
+        return builder.obj();
+    }
+
+    std::string ns;
+    std::string name;
+    long long lastPassDeleted = 0;
+    long long lastPassMillis = 0;
+    long long lastPassThrottledMillis = 0;
+    bool lastPassComplete = true;
+    // Number of expired keys left in the index when the last pass ended, counting no further than
+    // kBacklogScanLimit.
+    long long backlog = 0;
+    bool backlogIsLowerBound = false;
+    long long totalDeleted = 0;
+};
+
+stdx::mutex ttlIndexStatsMutex;
+std::map<std::pair<std::string, std::string>, TTLIndexStats> ttlIndexStats;
+
+class TTLIndexesServerStatusSection final : public ServerStatusSection {
+public:
+    TTLIndexesServerStatusSection() : ServerStatusSection("ttlIndexes") {}
+
+    bool includeByDefault() const override {
+        return false;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx,
+                            const BSONElement& configElement) const override {
+        BSONArrayBuilder indexes;
+        stdx::lock_guard<stdx::mutex> lk(ttlIndexStatsMutex);
+        for (const auto& entry : ttlIndexStats) {
+            indexes.append(entry.second.toBSON());
+        }
+        return BSON("indexes" << indexes.arr());
+    }
+} ttlIndexesServerStatusSection;
+
+/**
+ * The key range of a TTL index which holds expired documents.
+ */
+struct ExpiredRange {
+    BSONObj startKey;
+    BSONObj endKey;
+    InternalPlanner::Direction direction;
+    // Matches the documents in the range, to recheck documents which may have changed since their
+    // key was read.
+    BSONObj query;
+};
+
+}  // namespace
+
 class TTLMonitor : public BackgroundJob {
 public:
     TTLMonitor() {}
@@ -87,6 +190,17 @@ public:
         Client::initThread(name().c_str());
         AuthorizationSession::get(cc())->grantInternalAuthorization();
 
+        ThreadPool::Options options;
+        options.poolName = "TTLMonitorPool";
+        options.threadNamePrefix = "TTLMonitor-";
+        options.maxThreads = std::max(1, ttlMonitorMaxThreads);
+        options.onCreateThread = [](const std::string& threadName) {
+            Client::initThread(threadName.c_str());
+            AuthorizationSession::get(cc())->grantInternalAuthorization();
+        };
+        _workers = stdx::make_unique<ThreadPool>(options);
+        _workers->startup();
+
         while (!globalInShutdownDeprecated()) {
             {
                 MONGO_IDLE_THREAD_BLOCK;
@@ -153,20 +267,44 @@ private:
             }
         }
 
+        // Indexes are processed concurrently, each on its own operation context, and the pass
+        // ends when all of them are done.
         for (const BSONObj& idx : ttlIndexes) {
-            try {
-                doTTLForIndex(&opCtx, idx);
-            } catch (const DBException& dbex) {
-                error() << "Error processing ttl index: " << idx << " -- " << dbex.toString();
-                // Continue on to the next index.
-                continue;
+            Status status = _workers->schedule([this, idx] {
+                auto indexOpCtx = cc().makeOperationContext();
+                try {
+                    doTTLForIndex(indexOpCtx.get(), idx);
+                } catch (const DBException& dbex) {
+                    error() << "Error processing ttl index: " << idx << " -- " << dbex.toString();
+                }
+            });
+            if (!status.isOK()) {
+                // The pool only refuses work once it has been shut down.
+                return;
             }
         }
+        _workers->waitForIdle();
+
+        // Forget the statistics of indexes which no longer exist.
+        stdx::lock_guard<stdx::mutex> lk(ttlIndexStatsMutex);
+        for (auto it = ttlIndexStats.begin(); it != ttlIndexStats.end();) {
+            const bool found =
+                std::any_of(ttlIndexes.begin(), ttlIndexes.end(), [&](const BSONObj& idx) {
+                    return idx["ns"].String() == it->first.first &&
+                        idx["name"].String() == it->first.second;
+                });
+            it = found ? std::next(it) : ttlIndexStats.erase(it);
+        }
     }
 
     /**
      * Remove documents from the collection using the specified TTL index after a sufficient amount
      * of time has passed according to its expiry specification.
+     *
+     * Expired documents are deleted in batches of ttlMonitorBatchSize, in RecordId order and each
+     * batch in a single storage transaction, until none are left, the index's deadline passes, or
+     * the index can no longer be processed. Locks are released between batches, and deletion
+     * pauses while replication or the storage engine cache is falling behind.
      */
     void doTTLForIndex(OperationContext* opCtx, BSONObj idx) {
         const NamespaceString collectionNSS(idx["ns"].String());
@@ -180,7 +318,7 @@ private:
         }
 
         const BSONObj key = idx["key"].Obj();
-        const StringData name = idx["name"].valueStringData();
+        const std::string name = idx["name"].String();
         if (key.nFields() != 1) {
             error() << "key for ttl index can only have 1 field, skipping ttl job for: " << idx;
             return;
@@ -188,31 +326,105 @@ private:
 
         LOG(1) << "ns: " << collectionNSS << " key: " << key << " name: " << name;
 
-        AutoGetCollection autoGetCollection(opCtx, collectionNSS, MODE_IX);
-        Collection* collection = autoGetCollection.getCollection();
-        if (!collection) {
-            // Collection was dropped.
-            return;
+        TTLIndexStats pass;
+        pass.ns = collectionNSS.ns();
+        pass.name = name;
+        pass.lastPassComplete = false;
+
+        // Documents which expire while the pass runs are left for the next one.
+        const Date_t now = Date_t::now();
+        const Date_t deadline = now + Seconds(ttlMonitorIndexDeadlineSecs.load());
+        const int batchSize = std::max(1, ttlMonitorBatchSize.load());
+        while (waitForCapacity(opCtx, deadline, &pass) && Date_t::now() < deadline) {
+            long long scanned = 0;
+            long long deleted = 0;
+            if (!deleteBatch(opCtx, collectionNSS, name, now, batchSize, &scanned, &deleted)) {
+                break;
+            }
+
+            pass.lastPassDeleted += deleted;
+            ttlDeletedDocuments.increment(deleted);
+            if (scanned < batchSize) {
+                pass.lastPassComplete = true;
+                break;
+            }
+            if (deleted == 0) {
+                // Every document in the batch changed since its key was read. Rather than scan
+                // the same keys again, leave them to the next pass.
+                break;
+            }
         }
 
-        if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(opCtx, collectionNSS)) {
-            return;
+        if (!pass.lastPassComplete) {
+            pass.backlog = countExpiredKeys(opCtx, collectionNSS, name, now);
+            pass.backlogIsLowerBound = pass.backlog >= kBacklogScanLimit;
         }
+        pass.lastPassMillis = durationCount<Milliseconds>(Date_t::now() - now);
 
-        IndexDescriptor* desc = collection->getIndexCatalog()->findIndexByName(opCtx, name);
-        if (!desc) {
-            LOG(1) << "index not found (index build in progress? index dropped?), skipping "
-                   << "ttl job for: " << idx;
-            return;
+        LOG(1) << "deleted: " << pass.lastPassDeleted;
+        if (!pass.lastPassComplete) {
+            LOG(1) << "ttl index " << name << " on " << collectionNSS << " still has "
+                   << pass.backlog << (pass.backlogIsLowerBound ? " or more" : "")
+                   << " expired documents after its pass";
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(ttlIndexStatsMutex);
+        auto& stats = ttlIndexStats[std::make_pair(pass.ns, pass.name)];
+        pass.totalDeleted = stats.totalDeleted + pass.lastPassDeleted;
+        stats = pass;
+    }
+
+    /**
+     * Waits while deleting would add to replication lag or cache pressure beyond the configured
+     * limits. Returns false if 'deadline' passes first.
+     */
+    bool waitForCapacity(OperationContext* opCtx, Date_t deadline, TTLIndexStats* pass) {
+        StringData reason;
+        while (!(reason = throttleReason(opCtx)).empty()) {
+            if (Date_t::now() + kThrottleInterval > deadline) {
+                return false;
+            }
+            LOG(2) << "ttl deletion paused because of " << reason;
+            opCtx->sleepFor(kThrottleInterval);
+            pass->lastPassThrottledMillis += durationCount<Milliseconds>(kThrottleInterval);
+            ttlThrottledMillis.increment(durationCount<Milliseconds>(kThrottleInterval));
+        }
+        return true;
+    }
+
+    StringData throttleReason(OperationContext* opCtx) {
+        const int maxLagSecs = ttlMonitorMaxReplicationLagSecs.load();
+        auto replCoord = repl::getGlobalReplicationCoordinator();
+        if (maxLagSecs > 0 &&
+            replCoord->getReplicationMode() == repl::ReplicationCoordinator::modeReplSet) {
+            const auto lastCommitted = replCoord->getLastCommittedOpTime();
+            const auto lastApplied = replCoord->getMyLastAppliedOpTime();
+            if (!lastCommitted.isNull() &&
+                lastApplied.getTimestamp().getSecs() >
+                    lastCommitted.getTimestamp().getSecs() + static_cast<unsigned>(maxLagSecs)) {
+                return "replication lag"_sd;
+            }
+        }
+
+        const double maxDirtyRatio = ttlMonitorMaxCacheDirtyRatio.load();
+        if (maxDirtyRatio > 0 &&
+            opCtx->getServiceContext()->getGlobalStorageEngine()->getCacheDirtyRatio() >
+                maxDirtyRatio) {
+            return "storage engine cache dirty ratio"_sd;
         }
 
-        // Re-read 'idx' from the descriptor, in case the collection or index definition changed
-        // before we re-acquired the collection lock.
-        idx = desc->infoObj();
+        return StringData();
+    }
 
+    /**
+     * Returns the range of keys of the TTL index 'desc' which hold documents expired at 'now', or
+     * boost::none if 'desc' can't be used as a TTL index.
+     */
+    boost::optional<ExpiredRange> getExpiredRange(const IndexDescriptor* desc, Date_t now) {
+        const BSONObj idx = desc->infoObj();
         if (IndexType::INDEX_BTREE != IndexNames::nameToType(desc->getAccessMethodName())) {
             error() << "special index can't be used as a ttl index, skipping ttl job for: " << idx;
-            return;
+            return boost::none;
         }
 
         BSONElement secondsExpireElt = idx[secondsExpireField];
@@ -220,57 +432,157 @@ private:
             error() << "ttl indexes require the " << secondsExpireField << " field to be "
                     << "numeric but received a type of " << typeName(secondsExpireElt.type())
                     << ", skipping ttl job for: " << idx;
-            return;
+            return boost::none;
         }
 
+        const BSONObj key = desc->keyPattern();
         const Date_t kDawnOfTime =
             Date_t::fromMillisSinceEpoch(std::numeric_limits<long long>::min());
-        const Date_t expirationTime = Date_t::now() - Seconds(secondsExpireElt.numberLong());
-        const BSONObj startKey = BSON("" << kDawnOfTime);
-        const BSONObj endKey = BSON("" << expirationTime);
+        const Date_t expirationTime = now - Seconds(secondsExpireElt.numberLong());
+
+        ExpiredRange range;
+        range.startKey = BSON("" << kDawnOfTime);
+        range.endKey = BSON("" << expirationTime);
         // The canonical check as to whether a key pattern element is "ascending" or
         // "descending" is (elt.number() >= 0).  This is defined by the Ordering class.
-        const InternalPlanner::Direction direction = (key.firstElement().number() >= 0)
+        range.direction = (key.firstElement().number() >= 0)
             ? InternalPlanner::Direction::FORWARD
             : InternalPlanner::Direction::BACKWARD;
+        range.query = BSON(key.firstElement().fieldName()
+                           << BSON("$gte" << kDawnOfTime << "$lte" << expirationTime));
+        return range;
+    }
 
-        // We need to pass into the DeleteStageParams (below) a CanonicalQuery with a BSONObj that
-        // queries for the expired documents correctly so that we do not delete documents that are
-        // not actually expired when our snapshot changes during deletion.
-        const char* keyFieldName = key.firstElement().fieldName();
-        BSONObj query =
-            BSON(keyFieldName << BSON("$gte" << kDawnOfTime << "$lte" << expirationTime));
+    /**
+     * Deletes up to 'batchSize' documents expired at 'now' through the TTL index 'name', in one
+     * storage transaction. Sets 'scanned' to the number of expired keys read and 'deleted' to
+     * the number of documents deleted. Returns false if the index can no longer be processed.
+     */
+    bool deleteBatch(OperationContext* opCtx,
+                     const NamespaceString& collectionNSS,
+                     const std::string& name,
+                     Date_t now,
+                     int batchSize,
+                     long long* scanned,
+                     long long* deleted) {
+        AutoGetCollection autoGetCollection(opCtx, collectionNSS, MODE_IX);
+        Collection* collection = autoGetCollection.getCollection();
+        if (!collection) {
+            // Collection was dropped.
+            return false;
+        }
+
+        if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(opCtx, collectionNSS)) {
+            return false;
+        }
+
+        IndexDescriptor* desc = collection->getIndexCatalog()->findIndexByName(opCtx, name);
+        if (!desc) {
+            LOG(1) << "index not found (index build in progress? index dropped?), skipping "
+                   << "ttl job for: " << name << " on " << collectionNSS;
+            return false;
+        }
+
+        // Re-read the index definition from the descriptor, in case the collection or index
+        // definition changed while the collection lock was not held.
+        const auto range = getExpiredRange(desc, now);
+        if (!range) {
+            return false;
+        }
+
+        std::vector<RecordId> recordIds;
+        {
+            auto exec = InternalPlanner::indexScan(opCtx,
+                                                   collection,
+                                                   desc,
+                                                   range->startKey,
+                                                   range->endKey,
+                                                   BoundInclusion::kIncludeBothStartAndEndKeys,
+                                                   PlanExecutor::NO_YIELD,
+                                                   range->direction);
+            RecordId recordId;
+            PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
+            while (recordIds.size() < static_cast<size_t>(batchSize) &&
+                   PlanExecutor::ADVANCED == (state = exec->getNext(nullptr, &recordId))) {
+                recordIds.push_back(recordId);
+            }
+            if (PlanExecutor::FAILURE == state || PlanExecutor::DEAD == state) {
+                error() << "ttl index scan of " << name << " on " << collectionNSS << " failed";
+                return false;
+            }
+        }
+        *scanned = recordIds.size();
+
+        // Visiting the documents in storage order keeps the deletes of a batch close together
+        // in the collection, rather than scattered in expiry order.
+        std::sort(recordIds.begin(), recordIds.end());
+
+        // A document may have been updated so that it no longer expires since its key was read,
+        // so each one is checked again before it is deleted.
         auto qr = stdx::make_unique<QueryRequest>(collectionNSS);
-        qr->setFilter(query);
+        qr->setFilter(range->query);
         auto canonicalQuery = CanonicalQuery::canonicalize(opCtx, std::move(qr));
         invariantOK(canonicalQuery.getStatus());
+        const MatchExpression* filter = canonicalQuery.getValue()->root();
+
+        writeConflictRetry(opCtx, "ttl", collectionNSS.ns(), [&] {
+            *deleted = 0;
+            WriteUnitOfWork wuow(opCtx);
+            for (const auto& recordId : recordIds) {
+                Snapshotted<BSONObj> doc;
+                if (!collection->findDoc(opCtx, recordId, &doc) ||
+                    !filter->matchesBSON(doc.value())) {
+                    continue;
+                }
+                collection->deleteDocument(opCtx, kUninitializedStmtId, recordId, nullptr);
+                ++*deleted;
+            }
+            wuow.commit();
+        });
+        return true;
+    }
 
-        DeleteStageParams params;
-        params.isMulti = true;
-        params.canonicalQuery = canonicalQuery.getValue().get();
-
-        auto exec =
-            InternalPlanner::deleteWithIndexScan(opCtx,
-                                                 collection,
-                                                 params,
-                                                 desc,
-                                                 startKey,
-                                                 endKey,
-                                                 BoundInclusion::kIncludeBothStartAndEndKeys,
-                                                 PlanExecutor::YIELD_AUTO,
-                                                 direction);
-
-        Status result = exec->executePlan();
-        if (!result.isOK()) {
-            error() << "ttl query execution for index " << idx
-                    << " failed with status: " << redact(result);
-            return;
+    /**
+     * Counts the keys of the TTL index 'name' which hold documents expired at 'now', stopping at
+     * kBacklogScanLimit.
+     */
+    long long countExpiredKeys(OperationContext* opCtx,
+                               const NamespaceString& collectionNSS,
+                               const std::string& name,
+                               Date_t now) {
+        AutoGetCollection autoGetCollection(opCtx, collectionNSS, MODE_IS);
+        Collection* collection = autoGetCollection.getCollection();
+        if (!collection) {
+            return 0;
         }
 
-        const long long numDeleted = DeleteStage::getNumDeleted(*exec);
-        ttlDeletedDocuments.increment(numDeleted);
-        LOG(1) << "deleted: " << numDeleted;
+        IndexDescriptor* desc = collection->getIndexCatalog()->findIndexByName(opCtx, name);
+        if (!desc) {
+            return 0;
+        }
+
+        const auto range = getExpiredRange(desc, now);
+        if (!range) {
+            return 0;
+        }
+
+        auto exec = InternalPlanner::indexScan(opCtx,
+                                               collection,
+                                               desc,
+                                               range->startKey,
+                                               range->endKey,
+                                               BoundInclusion::kIncludeBothStartAndEndKeys,
+                                               PlanExecutor::NO_YIELD,
+                                               range->direction);
+        long long count = 0;
+        while (count < kBacklogScanLimit &&
+               PlanExecutor::ADVANCED == exec->getNext(nullptr, nullptr)) {
+            ++count;
+        }
+        return count;
     }
+
+    std::unique_ptr<ThreadPool> _workers;
 };
 
 namespace {
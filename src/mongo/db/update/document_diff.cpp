@@ -0,0 +1,364 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/update/document_diff.h"
+
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+namespace doc_diff {
+
+namespace {
+
+bool computeObjectDiff(const BSONObj& pre, const BSONObj& post, BSONObjBuilder* out);
+bool computeArrayDiff(const BSONObj& pre, const BSONObj& post, BSONObjBuilder* out);
+
+/**
+ * Appends a diff turning 'pre' into 'post' to 'section' under 'fieldName', if both are objects or
+ * both are arrays and the diff is smaller than 'post'. Returns whether it did.
+ */
+bool appendSubDiff(StringData fieldName,
+                   const BSONElement& pre,
+                   const BSONElement& post,
+                   BSONObjBuilder* section) {
+    BSONObjBuilder subDiff;
+    bool diffed = false;
+    if (Object == pre.type() && Object == post.type()) {
+        diffed = computeObjectDiff(pre.embeddedObject(), post.embeddedObject(), &subDiff);
+    } else if (Array == pre.type() && Array == post.type()) {
+        diffed = computeArrayDiff(pre.embeddedObject(), post.embeddedObject(), &subDiff);
+    }
+    if (!diffed || subDiff.len() >= post.valuesize()) {
+        return false;
+    }
+    section->append(fieldName, subDiff.obj());
+    return true;
+}
+
+void appendSection(StringData fieldName, BSONObjBuilder* section, BSONObjBuilder* out) {
+    if (!section->asTempObj().isEmpty()) {
+        out->append(fieldName, section->obj());
+    }
+}
+
+bool computeObjectDiff(const BSONObj& pre, const BSONObj& post, BSONObjBuilder* out) {
+    StringMap<BSONElement> preFields;
+    for (auto&& elem : pre) {
+        preFields[elem.fieldNameStringData()] = elem;
+    }
+    StringMap<BSONElement> postFields;
+    for (auto&& elem : post) {
+        postFields[elem.fieldNameStringData()] = elem;
+    }
+    if (preFields.size() != static_cast<size_t>(pre.nFields()) ||
+        postFields.size() != static_cast<size_t>(post.nFields())) {
+        // Duplicate field names.
+        return false;
+    }
+
+    // Applying the diff keeps the fields of 'pre' in place and appends new ones, so the fields
+    // that 'post' shares with 'pre' must come first and in the same order.
+    BSONObjIterator preIt(pre);
+    bool sawNewField = false;
+    for (auto&& postElem : post) {
+        if (preFields.find(postElem.fieldNameStringData()) == preFields.end()) {
+            sawNewField = true;
+            continue;
+        }
+        if (sawNewField) {
+            return false;
+        }
+        BSONElement preElem;
+        while (preIt.more()) {
+            preElem = preIt.next();
+            if (postFields.find(preElem.fieldNameStringData()) != postFields.end()) {
+                break;
+            }
+        }
+        if (preElem.fieldNameStringData() != postElem.fieldNameStringData()) {
+            return false;
+        }
+    }
+
+    BSONObjBuilder deletes;
+    for (auto&& preElem : pre) {
+        if (postFields.find(preElem.fieldNameStringData()) == postFields.end()) {
+            deletes.appendBool(preElem.fieldNameStringData(), false);
+        }
+    }
+
+    BSONObjBuilder updates;
+    BSONObjBuilder subDiffs;
+    for (auto&& postElem : post) {
+        auto preField = preFields.find(postElem.fieldNameStringData());
+        if (preField != preFields.end()) {
+            if (preField->second.binaryEqualValues(postElem) ||
+                appendSubDiff(
+                    postElem.fieldNameStringData(), preField->second, postElem, &subDiffs)) {
+                continue;
+            }
+        }
+        updates.append(postElem);
+    }
+
+    appendSection(kDeleteSectionFieldName, &deletes, out);
+    appendSection(kUpdateSectionFieldName, &updates, out);
+    appendSection(kSubDiffSectionFieldName, &subDiffs, out);
+    return true;
+}
+
+bool computeArrayDiff(const BSONObj& pre, const BSONObj& post, BSONObjBuilder* out) {
+    std::vector<BSONElement> preElems;
+    for (auto&& elem : pre) {
+        preElems.push_back(elem);
+    }
+
+    BSONObjBuilder updates;
+    BSONObjBuilder subDiffs;
+    int length = 0;
+    for (auto&& postElem : post) {
+        const std::string index = BSONObjBuilder::numStr(length);
+        const size_t i = length++;
+        if (i < preElems.size() &&
+            (preElems[i].binaryEqualValues(postElem) ||
+             appendSubDiff(index, preElems[i], postElem, &subDiffs))) {
+            continue;
+        }
+        updates.appendAs(postElem, index);
+    }
+
+    out->appendBool(kArrayHeaderFieldName, true);
+    out->append(kArrayLengthFieldName, length);
+    appendSection(kUpdateSectionFieldName, &updates, out);
+    appendSection(kSubDiffSectionFieldName, &subDiffs, out);
+    return true;
+}
+
+BSONObj applyObjectDiff(const BSONObj& pre, const BSONObj& diff);
+BSONObj applyArrayDiff(const BSONObj& pre, const BSONObj& diff);
+
+/**
+ * Appends 'pre' changed according to 'subDiff' to 'out' under 'fieldName'. 'pre' may be missing
+ * or of another type when an oplog entry is applied again, in which case the diff is applied to an
+ * empty object or array.
+ */
+void appendAppliedSubDiff(StringData fieldName,
+                          const BSONElement& pre,
+                          const BSONElement& subDiff,
+                          BSONObjBuilder* out) {
+    uassert(40664,
+            str::stream() << "Invalid document diff, expected an object: " << subDiff,
+            Object == subDiff.type());
+    const BSONObj diff = subDiff.embeddedObject();
+    if (diff.hasField(kArrayHeaderFieldName)) {
+        out->appendArray(fieldName,
+                         applyArrayDiff(Array == pre.type() ? pre.embeddedObject() : BSONObj(),
+                                        diff));
+    } else {
+        out->append(fieldName,
+                    applyObjectDiff(Object == pre.type() ? pre.embeddedObject() : BSONObj(),
+                                    diff));
+    }
+}
+
+StringMap<BSONElement> sectionFields(const BSONElement& section) {
+    uassert(40665,
+            str::stream() << "Invalid document diff section, expected an object: " << section,
+            Object == section.type());
+    StringMap<BSONElement> fields;
+    for (auto&& elem : section.embeddedObject()) {
+        fields[elem.fieldNameStringData()] = elem;
+    }
+    return fields;
+}
+
+BSONObj applyObjectDiff(const BSONObj& pre, const BSONObj& diff) {
+    BSONObj updates;
+    BSONObj subDiffs;
+    StringMap<BSONElement> deleteFields;
+    StringMap<BSONElement> updateFields;
+    StringMap<BSONElement> subDiffFields;
+    for (auto&& section : diff) {
+        const StringData sectionName = section.fieldNameStringData();
+        if (kDeleteSectionFieldName == sectionName) {
+            deleteFields = sectionFields(section);
+        } else if (kUpdateSectionFieldName == sectionName) {
+            updateFields = sectionFields(section);
+            updates = section.embeddedObject();
+        } else if (kSubDiffSectionFieldName == sectionName) {
+            subDiffFields = sectionFields(section);
+            subDiffs = section.embeddedObject();
+        } else {
+            uasserted(40666,
+                      str::stream() << "Unknown section '" << sectionName
+                                    << "' in document diff: "
+                                    << diff);
+        }
+    }
+
+    BSONObjBuilder out;
+    StringMap<bool> preFields;
+    for (auto&& preElem : pre) {
+        const StringData fieldName = preElem.fieldNameStringData();
+        preFields[fieldName] = true;
+        if (deleteFields.find(fieldName) != deleteFields.end()) {
+            continue;
+        }
+
+        auto update = updateFields.find(fieldName);
+        auto subDiff = subDiffFields.find(fieldName);
+        if (update != updateFields.end()) {
+            out.append(update->second);
+        } else if (subDiff != subDiffFields.end()) {
+            appendAppliedSubDiff(fieldName, preElem, subDiff->second, &out);
+        } else {
+            out.append(preElem);
+        }
+    }
+
+    for (auto&& update : updates) {
+        if (preFields.find(update.fieldNameStringData()) == preFields.end()) {
+            out.append(update);
+        }
+    }
+    for (auto&& subDiff : subDiffs) {
+        if (preFields.find(subDiff.fieldNameStringData()) == preFields.end()) {
+            appendAppliedSubDiff(subDiff.fieldNameStringData(), BSONElement(), subDiff, &out);
+        }
+    }
+    return out.obj();
+}
+
+BSONObj applyArrayDiff(const BSONObj& pre, const BSONObj& diff) {
+    long long length = -1;
+    StringMap<BSONElement> updateFields;
+    StringMap<BSONElement> subDiffFields;
+    for (auto&& section : diff) {
+        const StringData sectionName = section.fieldNameStringData();
+        if (kArrayHeaderFieldName == sectionName) {
+            continue;
+        } else if (kArrayLengthFieldName == sectionName) {
+            uassert(40667,
+                    str::stream() << "Invalid array length in document diff: " << diff,
+                    section.isNumber() && section.numberLong() >= 0 &&
+                        section.numberLong() <= BSONObjMaxInternalSize);
+            length = section.numberLong();
+        } else if (kUpdateSectionFieldName == sectionName) {
+            updateFields = sectionFields(section);
+        } else if (kSubDiffSectionFieldName == sectionName) {
+            subDiffFields = sectionFields(section);
+        } else {
+            uasserted(40668,
+                      str::stream() << "Unknown section '" << sectionName
+                                    << "' in array diff: "
+                                    << diff);
+        }
+    }
+    uassert(40669, str::stream() << "Missing array length in document diff: " << diff, length >= 0);
+
+    std::vector<BSONElement> preElems;
+    for (auto&& elem : pre) {
+        preElems.push_back(elem);
+    }
+
+    BSONObjBuilder out;
+    for (long long i = 0; i < length; ++i) {
+        const std::string index = BSONObjBuilder::numStr(static_cast<int>(i));
+        const BSONElement preElem =
+            static_cast<size_t>(i) < preElems.size() ? preElems[i] : BSONElement();
+
+        auto update = updateFields.find(index);
+        auto subDiff = subDiffFields.find(index);
+        if (update != updateFields.end()) {
+            out.appendAs(update->second, index);
+        } else if (subDiff != subDiffFields.end()) {
+            appendAppliedSubDiff(index, preElem, subDiff->second, &out);
+        } else if (!preElem.eoo()) {
+            out.appendAs(preElem, index);
+        } else {
+            out.appendNull(index);
+        }
+    }
+    return out.obj();
+}
+
+void flattenDiff(const std::string& prefix,
+                 const BSONObj& diff,
+                 BSONObjBuilder* updatedFields,
+                 std::vector<std::string>* removedFields) {
+    for (auto&& section : diff) {
+        const StringData sectionName = section.fieldNameStringData();
+        if (Object != section.type()) {
+            continue;
+        }
+        for (auto&& elem : section.embeddedObject()) {
+            const std::string path = prefix + elem.fieldName();
+            if (kDeleteSectionFieldName == sectionName) {
+                removedFields->push_back(path);
+            } else if (kUpdateSectionFieldName == sectionName) {
+                updatedFields->appendAs(elem, path);
+            } else if (kSubDiffSectionFieldName == sectionName && Object == elem.type()) {
+                flattenDiff(path + '.', elem.embeddedObject(), updatedFields, removedFields);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+boost::optional<BSONObj> computeDiff(const BSONObj& pre, const BSONObj& post, size_t maxSize) {
+    BSONObjBuilder diff;
+    if (!computeObjectDiff(pre, post, &diff)) {
+        return boost::none;
+    }
+    BSONObj diffObj = diff.obj();
+    if (static_cast<size_t>(diffObj.objsize()) >= maxSize) {
+        return boost::none;
+    }
+    return diffObj;
+}
+
+BSONObj applyDiff(const BSONObj& pre, const BSONObj& diff) {
+    return applyObjectDiff(pre, diff);
+}
+
+void flattenDiff(const BSONObj& diff,
+                 BSONObjBuilder* updatedFields,
+                 std::vector<std::string>* removedFields) {
+    flattenDiff("", diff, updatedFields, removedFields);
+}
+
+}  // namespace doc_diff
+}  // namespace mongo
@@ -0,0 +1,87 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+
+namespace mongo {
+namespace doc_diff {
+
+/**
+ * A diff describes how to turn one document into another, and is logged in place of an update
+ * whose oplog entry would otherwise be much larger than the change it made, such as one that
+ * changed a few elements of a large array. A diff of two objects looks like
+ *
+ *     {d: {<field>: false, ...}, u: {<field>: <value>, ...}, s: {<field>: <diff>, ...}}
+ *
+ * where 'd' lists the deleted fields, 'u' the fields set to a new value, and 's' the fields that
+ * are themselves changed according to a nested diff. Fields added by 'u' which the original
+ * document does not have are appended in order. A diff of two arrays looks like
+ *
+ *     {a: true, l: <new length>, u: {<index>: <value>, ...}, s: {<index>: <diff>, ...}}
+ *
+ * Empty sections are left out. Applying a diff only ever sets fields and array elements to their
+ * final value, so applying it again to its own result changes nothing, as oplog application
+ * requires.
+ */
+// The field of a "$v: 2" oplog update entry holding the diff.
+constexpr StringData kOplogDiffFieldName = "diff"_sd;
+
+constexpr StringData kDeleteSectionFieldName = "d"_sd;
+constexpr StringData kUpdateSectionFieldName = "u"_sd;
+constexpr StringData kSubDiffSectionFieldName = "s"_sd;
+constexpr StringData kArrayHeaderFieldName = "a"_sd;
+constexpr StringData kArrayLengthFieldName = "l"_sd;
+
+/**
+ * Computes a diff turning 'pre' into 'post', or returns boost::none if the diff would not be
+ * smaller than 'maxSize' bytes or cannot preserve the order of the fields of 'post'.
+ */
+boost::optional<BSONObj> computeDiff(const BSONObj& pre, const BSONObj& post, size_t maxSize);
+
+/**
+ * Applies 'diff' to 'pre'. Throws if 'diff' is malformed.
+ */
+BSONObj applyDiff(const BSONObj& pre, const BSONObj& diff);
+
+/**
+ * Describes 'diff' as the dotted paths it sets, appended to 'updatedFields', and the paths it
+ * removes, appended to 'removedFields'. Arrays the diff shortens are not reported.
+ */
+void flattenDiff(const BSONObj& diff,
+                 BSONObjBuilder* updatedFields,
+                 std::vector<std::string>* removedFields);
+
+}  // namespace doc_diff
+}  // namespace mongo
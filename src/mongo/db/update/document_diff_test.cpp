@@ -0,0 +1,141 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/update/document_diff.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Diffs 'pre' and 'post', checks that applying the diff to 'pre' gives 'post', and that applying it
+ * again changes nothing. Returns the diff.
+ */
+BSONObj checkDiff(const BSONObj& pre, const BSONObj& post) {
+    auto diff = doc_diff::computeDiff(pre, post, BSONObjMaxInternalSize);
+    ASSERT(diff);
+    const BSONObj applied = doc_diff::applyDiff(pre, *diff);
+    ASSERT_BSONOBJ_EQ(post, applied);
+    ASSERT(post.binaryEqual(applied));
+    ASSERT(post.binaryEqual(doc_diff::applyDiff(applied, *diff)));
+    return *diff;
+}
+
+TEST(DocumentDiffTest, IdenticalDocumentsHaveEmptyDiff) {
+    const BSONObj doc = fromjson("{_id: 1, a: [1, 2, 3], b: {c: 'x'}}");
+    ASSERT_BSONOBJ_EQ(BSONObj(), checkDiff(doc, doc));
+}
+
+TEST(DocumentDiffTest, SetUnsetAndAddFields) {
+    const BSONObj diff =
+        checkDiff(fromjson("{_id: 1, a: 1, b: 2, c: 3}"), fromjson("{_id: 1, a: 5, c: 3, d: 4}"));
+    ASSERT_BSONOBJ_EQ(fromjson("{d: {b: false}, u: {a: 5, d: 4}}"), diff);
+}
+
+TEST(DocumentDiffTest, ChangedTypeIsAnUpdate) {
+    const BSONObj diff = checkDiff(BSON("a" << 1), BSON("a" << 1.0));
+    ASSERT_BSONOBJ_EQ(fromjson("{u: {a: 1.0}}"), diff);
+}
+
+TEST(DocumentDiffTest, PushOntoLargeArray) {
+    BSONArrayBuilder items;
+    for (int i = 0; i < 100; ++i) {
+        items.append(BSON("sku" << i << "qty" << 1));
+    }
+    const BSONArray pre = items.arr();
+    BSONArrayBuilder pushed;
+    for (auto&& item : pre) {
+        pushed.append(item);
+    }
+    pushed.append(BSON("sku" << 100 << "qty" << 2));
+
+    const BSONObj diff =
+        checkDiff(BSON("_id" << 1 << "cart" << pre), BSON("_id" << 1 << "cart" << pushed.arr()));
+    ASSERT_BSONOBJ_EQ(fromjson("{s: {cart: {a: true, l: 101, u: {'100': {sku: 100, qty: 2}}}}}"),
+                      diff);
+}
+
+TEST(DocumentDiffTest, PullFromArrayShortensIt) {
+    checkDiff(fromjson("{a: [1, 2, 3, 4, 5, 6, 7, 8]}"), fromjson("{a: [1, 2, 3, 4, 5, 6, 8]}"));
+}
+
+TEST(DocumentDiffTest, NestedPositionalUpdate) {
+    const BSONObj diff =
+        checkDiff(fromjson("{a: [{b: 1, c: 'a long string to keep'}, {b: 2}]}"),
+                  fromjson("{a: [{b: 1, c: 'a long string to keep'}, {b: 3}]}"));
+    ASSERT_BSONOBJ_EQ(fromjson("{s: {a: {a: true, l: 2, u: {'1': {b: 3}}}}}"), diff);
+}
+
+TEST(DocumentDiffTest, ReorderedFieldsCannotBeDiffed) {
+    ASSERT_FALSE(doc_diff::computeDiff(
+        fromjson("{a: 1, b: 2}"), fromjson("{b: 2, a: 1}"), BSONObjMaxInternalSize));
+}
+
+TEST(DocumentDiffTest, ReorderedNestedFieldsAreReplaced) {
+    const BSONObj diff = checkDiff(fromjson("{x: 1, a: {b: 1, c: 2}}"),
+                                   fromjson("{x: 1, a: {c: 2, b: 1}}"));
+    ASSERT_BSONOBJ_EQ(fromjson("{u: {a: {c: 2, b: 1}}}"), diff);
+}
+
+TEST(DocumentDiffTest, DiffLargerThanMaxSize) {
+    ASSERT_FALSE(doc_diff::computeDiff(fromjson("{a: 1}"), fromjson("{a: 2}"), 10));
+}
+
+TEST(DocumentDiffTest, ApplyToMissingOrMistypedFields) {
+    const BSONObj diff = fromjson("{s: {a: {a: true, l: 2, u: {'1': 5}}, b: {u: {c: 1}}}}");
+    ASSERT_BSONOBJ_EQ(fromjson("{a: [null, 5], b: {c: 1}}"),
+                      doc_diff::applyDiff(fromjson("{a: 1}"), diff));
+}
+
+TEST(DocumentDiffTest, ApplyMalformedDiffThrows) {
+    ASSERT_THROWS_CODE(doc_diff::applyDiff(fromjson("{a: 1}"), fromjson("{x: {a: 1}}")),
+                       AssertionException,
+                       40666);
+    ASSERT_THROWS_CODE(doc_diff::applyDiff(fromjson("{a: [1]}"), fromjson("{s: {a: {a: true}}}")),
+                       AssertionException,
+                       40669);
+}
+
+TEST(DocumentDiffTest, FlattenDiff) {
+    const BSONObj diff = checkDiff(fromjson("{a: 1, b: 2, c: {d: [1, 2], e: 'some long string'}}"),
+                                   fromjson("{a: 3, c: {d: [1, 4], e: 'some long string'}}"));
+    BSONObjBuilder updatedFields;
+    std::vector<std::string> removedFields;
+    doc_diff::flattenDiff(diff, &updatedFields, &removedFields);
+    ASSERT_BSONOBJ_EQ(fromjson("{a: 3, 'c.d': [1, 4]}"), updatedFields.obj());
+    ASSERT_EQ(1U, removedFields.size());
+    ASSERT_EQ("b", removedFields[0]);
+}
+
+}  // namespace
+}  // namespace mongo
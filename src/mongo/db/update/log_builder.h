@@ -47,6 +47,10 @@ enum class UpdateSemantics {
     // field name. This system introduces support for arrayFilters and $[] syntax.
     kUpdateNode = 1,
 
+    // Only found in oplog entries: the update is a document diff, see document_diff.h, logged in
+    // place of updates that changed little of a large value.
+    kDelta = 2,
+
     // Must be last.
     kNumUpdateSemantics
 };
@@ -39,6 +39,8 @@
 #include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/matcher/extensions_callback_noop.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/update/delta_node.h"
+#include "mongo/db/update/document_diff.h"
 #include "mongo/db/update/log_builder.h"
 #include "mongo/db/update/modifier_table.h"
 #include "mongo/db/update/object_replace_node.h"
@@ -243,6 +245,19 @@ Status UpdateDriver::parse(
             _root = std::move(root);
             break;
         }
+        case UpdateSemantics::kDelta: {
+            auto diff = updateExpr[doc_diff::kOplogDiffFieldName];
+            if (diff.type() != BSONType::Object) {
+                return {ErrorCodes::FailedToParse,
+                        str::stream() << "Invalid document diff in oplog update: " << updateExpr};
+            }
+            _root = stdx::make_unique<DeltaNode>(diff.Obj());
+
+            // Like a replacement, a diff rewrites the whole document, and an upsert only takes the
+            // immutable fields from the query.
+            _replacementMode = true;
+            break;
+        }
         default:
             MONGO_UNREACHABLE;
     }
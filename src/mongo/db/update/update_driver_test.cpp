@@ -139,6 +139,32 @@ TEST(Parse, SetOnInsert) {
     ASSERT_FALSE(driver.isDocReplacement());
 }
 
+TEST(Parse, DeltaFromOplog) {
+    UpdateDriver::Options opts;
+    opts.modOptions.fromOplogApplication = true;
+    UpdateDriver driver(opts);
+    std::map<StringData, std::unique_ptr<ExpressionWithPlaceholder>> arrayFilters;
+    const BSONObj updateDocument =
+        fromjson("{$v: 2, diff: {u: {a: 2}, s: {b: {a: true, l: 2, u: {'1': 3}}}}}");
+    ASSERT_OK(driver.parse(updateDocument, arrayFilters));
+    ASSERT_TRUE(driver.isDocReplacement());
+
+    const FieldRefSet emptyImmutablePaths;
+    bool modified = false;
+    mutablebson::Document doc(fromjson("{_id: 0, a: 1, b: [1, 2, 4]}"));
+    ASSERT_OK(driver.update(
+        StringData(), BSONObj(), &doc, false, emptyImmutablePaths, nullptr, &modified));
+    ASSERT_TRUE(modified);
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 0, a: 2, b: [1, 3]}"), doc.getObject());
+}
+
+TEST(Parse, DeltaOnlyFromOplog) {
+    UpdateDriver::Options opts;
+    UpdateDriver driver(opts);
+    std::map<StringData, std::unique_ptr<ExpressionWithPlaceholder>> arrayFilters;
+    ASSERT_NOT_OK(driver.parse(fromjson("{$v: 2, diff: {u: {a: 2}}}"), arrayFilters));
+}
+
 TEST(Collator, SetCollationUpdatesModifierInterfaces) {
     CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kReverseString);
     BSONObj updateDocument = fromjson("{$max: {a: 'abd'}}");
@@ -38,10 +38,14 @@
 #include "mongo/db/client.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_d.h"
 #include "mongo/dbtests/dbtests.h"
+#include "mongo/util/fail_point_service.h"
+#include "mongo/util/scopeguard.h"
 
 namespace IndexUpdateTests {
 
@@ -440,6 +444,167 @@ Status IndexBuildBase::createIndex(const std::string& dbname, const BSONObj& ind
     return Status::OK();
 }
 
+// Enough documents for the key generation threads of an index build to be handed several batches.
+const int kNumDocs = 2000;
+
+/**
+ * Fixture for foreground builds of several indexes at once, with or without generating the keys of
+ * each index on its own thread.
+ */
+template <bool parallelKeyGeneration>
+class MultipleIndexBuildBase : public IndexBuildBase {
+public:
+    MultipleIndexBuildBase()
+        : _parallelKeyGeneration(
+              ServerParameterSet::getGlobal()->getMap().at("indexBuildParallelKeyGeneration")) {
+        ASSERT_OK(_parallelKeyGeneration->setFromString(parallelKeyGeneration ? "true" : "false"));
+    }
+    ~MultipleIndexBuildBase() {
+        _parallelKeyGeneration->setFromString("true").transitional_ignore();
+    }
+
+protected:
+    void insertDocuments(stdx::function<BSONObj(int)> makeDoc) {
+        std::vector<BSONObj> docs;
+        for (int i = 0; i < kNumDocs; ++i) {
+            docs.push_back(makeDoc(i));
+        }
+        _client.insert(_ns, docs);
+        ASSERT_EQUALS(static_cast<unsigned long long>(kNumDocs), _client.count(_ns));
+    }
+
+    BSONObj indexSpec(const std::string& name,
+                      const BSONObj& key,
+                      const BSONObj& options = BSONObj()) {
+        BSONObjBuilder spec;
+        spec.append("name", name);
+        spec.append("ns", _ns);
+        spec.append("key", key);
+        spec.append("v", static_cast<int>(kIndexVersion));
+        spec.appendElements(options);
+        return spec.obj();
+    }
+
+    /**
+     * Runs the whole build, returning any error thrown instead of reported.
+     */
+    Status buildIndexes(MultiIndexBlock* indexer, const std::vector<BSONObj>& specs) {
+        try {
+            uassertStatusOK(indexer->init(specs).getStatus());
+            uassertStatusOK(indexer->insertAllDocumentsInCollection());
+            WriteUnitOfWork wunit(&_opCtx);
+            indexer->commit();
+            wunit.commit();
+        } catch (const DBException& ex) {
+            return ex.toStatus();
+        }
+        return Status::OK();
+    }
+
+    int64_t numKeys(StringData indexName) {
+        auto indexCatalog = collection()->getIndexCatalog();
+        auto desc = indexCatalog->findIndexByName(&_opCtx, indexName);
+        ASSERT(desc);
+        int64_t numKeys;
+        ValidateResults results;
+        indexCatalog->getIndex(desc)->validate(&_opCtx, &numKeys, &results);
+        return numKeys;
+    }
+
+private:
+    ServerParameter* const _parallelKeyGeneration;
+};
+
+/** A key generation error for one index fails the build of every index. */
+template <bool parallelKeyGeneration>
+class BuildMultipleIndexesKeyGenerationError
+    : public MultipleIndexBuildBase<parallelKeyGeneration> {
+public:
+    void run() {
+        // The first document can't be indexed by a compound index on two arrays. It is followed by
+        // enough documents that a key generation thread fails while the others have work queued.
+        this->insertDocuments([](int i) {
+            if (i == 0) {
+                return BSON("_id" << i << "a" << BSON_ARRAY(1 << 2) << "b" << BSON_ARRAY(1 << 2));
+            }
+            return BSON("_id" << i << "a" << i << "b" << i);
+        });
+
+        {
+            MultiIndexBlock indexer(&this->_opCtx, this->collection());
+            Status status =
+                this->buildIndexes(&indexer,
+                                   {this->indexSpec("a_1", BSON("a" << 1)),
+                                    this->indexSpec("a_1_b_1", BSON("a" << 1 << "b" << 1)),
+                                    this->indexSpec("b_1", BSON("b" << 1))});
+            ASSERT_EQUALS(ErrorCodes::CannotIndexParallelArrays, status.code());
+        }
+
+        auto indexCatalog = this->collection()->getIndexCatalog();
+        ASSERT_EQUALS(1, indexCatalog->numIndexesTotal(&this->_opCtx));
+        ASSERT(!indexCatalog->findIndexByName(&this->_opCtx, "a_1"));
+        ASSERT(!indexCatalog->findIndexByName(&this->_opCtx, "a_1_b_1"));
+        ASSERT(!indexCatalog->findIndexByName(&this->_opCtx, "b_1"));
+    }
+};
+
+/** Each index of a build only gets the keys of the documents that match its partial filter. */
+template <bool parallelKeyGeneration>
+class BuildMultipleIndexesWithPartialFilters
+    : public MultipleIndexBuildBase<parallelKeyGeneration> {
+public:
+    void run() {
+        this->insertDocuments([](int i) { return BSON("_id" << i << "a" << i << "b" << i % 3); });
+
+        MultiIndexBlock indexer(&this->_opCtx, this->collection());
+        ASSERT_OK(this->buildIndexes(
+            &indexer,
+            {this->indexSpec("a_1", BSON("a" << 1)),
+             this->indexSpec("a_1_b0",
+                             BSON("a" << 1),
+                             BSON("partialFilterExpression" << BSON("b" << 0))),
+             this->indexSpec("b_1_alt",
+                             BSON("b" << 1),
+                             BSON("partialFilterExpression"
+                                  << BSON("a" << BSON("$gte" << kNumDocs / 2))))}));
+
+        ASSERT_EQUALS(kNumDocs, this->numKeys("a_1"));
+        ASSERT_EQUALS((kNumDocs + 2) / 3, this->numKeys("a_1_b0"));
+        ASSERT_EQUALS(kNumDocs / 2, this->numKeys("b_1_alt"));
+    }
+};
+
+/**
+ * Destroying a MultiIndexBlock whose key generation threads still have documents to index stops
+ * them and drops the unfinished indexes.
+ */
+class BuildMultipleIndexesInterruptedWithKeyGenerationQueued : public MultipleIndexBuildBase<true> {
+public:
+    void run() {
+        insertDocuments([](int i) { return BSON("_id" << i << "a" << i << "b" << -i); });
+
+        // Interruptions are only noticed once the whole collection has been scanned, by which time
+        // every batch of documents has been handed to the key generation threads.
+        auto failPoint = getGlobalFailPointRegistry()->getFailPoint("hangAfterStartingIndexBuild");
+        failPoint->setMode(FailPoint::nTimes, 1);
+        ON_BLOCK_EXIT([failPoint] { failPoint->setMode(FailPoint::off); });
+        getGlobalServiceContext()->setKillAllOperations();
+
+        {
+            MultiIndexBlock indexer(&_opCtx, collection());
+            Status status = buildIndexes(
+                &indexer, {indexSpec("a_1", BSON("a" << 1)), indexSpec("b_1", BSON("b" << 1))});
+            ASSERT_TRUE(ErrorCodes::isInterruption(status.code())) << status;
+        }
+        getGlobalServiceContext()->unsetKillAllOperations();
+
+        auto indexCatalog = collection()->getIndexCatalog();
+        ASSERT_EQUALS(1, indexCatalog->numIndexesTotal(&_opCtx));
+        ASSERT(!indexCatalog->findIndexByName(&_opCtx, "a_1"));
+        ASSERT(!indexCatalog->findIndexByName(&_opCtx, "b_1"));
+    }
+};
+
 /**
  * Fixture class that has a basic compound index.
  */
@@ -818,6 +983,11 @@ public:
         add<InsertBuildIndexInterruptDisallowed>();
         add<InsertBuildIdIndexInterrupt>();
         add<InsertBuildIdIndexInterruptDisallowed>();
+        add<BuildMultipleIndexesKeyGenerationError<true>>();
+        add<BuildMultipleIndexesKeyGenerationError<false>>();
+        add<BuildMultipleIndexesWithPartialFilters<true>>();
+        add<BuildMultipleIndexesWithPartialFilters<false>>();
+        add<BuildMultipleIndexesInterruptedWithKeyGenerationQueued>();
         add<SameSpecDifferentOption>();
         add<SameSpecSameOptions>();
         add<DifferentSpecSameName>();
@@ -396,6 +396,22 @@ public:
     }
 };
 
+class BinDataFollowedByNumbers {
+public:
+    void run() {
+        // Every element is written into the same stream, so the formatting BinData uses for its
+        // type must not leak into the elements after it.
+        BSONObjBuilder b;
+        b.appendBinData("a", 1, BinDataGeneral, "z");
+        b.append("b", 10);
+        b.append("c", 1.5);
+        ASSERT_EQUALS(
+            "{ \"a\" : { \"$binary\" : \"eg==\", \"$type\" : \"00\" }, \"b\" : 10, "
+            "\"c\" : 1.5 }",
+            b.done().jsonString(Strict));
+    }
+};
+
 class Symbol {
 public:
     void run() {
@@ -2725,6 +2741,7 @@ public:
         add<JsonStringTests::DBRefZero>();
         add<JsonStringTests::ObjectId>();
         add<JsonStringTests::BinData>();
+        add<JsonStringTests::BinDataFollowedByNumbers>();
         add<JsonStringTests::Symbol>();
         add<JsonStringTests::Date>();
         add<JsonStringTests::DateNegative>();
@@ -45,12 +45,14 @@
 #include "mongo/db/json.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/plan_ranker.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_test_lib.h"
 #include "mongo/db/query/stage_builder.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -95,8 +97,55 @@ public:
         _client.insert(nss.ns(), obj);
     }
 
-    void addIndex(const BSONObj& obj) {
-        ASSERT_OK(dbtests::createIndex(&_opCtx, nss.ns(), obj));
+    void addIndex(const BSONObj& obj, bool unique = false) {
+        ASSERT_OK(dbtests::createIndex(&_opCtx, nss.ns(), obj, unique));
+    }
+
+    /**
+     * Plans 'cq' and estimates the cost of each solution, as getExecutor does before racing them.
+     */
+    vector<unique_ptr<QuerySolution>> planWithCostEstimates(CanonicalQuery* cq) {
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+        Collection* collection = ctx.getCollection();
+
+        QueryPlannerParams plannerParams;
+        fillOutPlannerParams(&_opCtx, collection, cq, &plannerParams);
+        plannerParams.options &= ~QueryPlannerParams::KEEP_MUTATIONS;
+
+        vector<QuerySolution*> rawSolutions;
+        ASSERT_OK(QueryPlanner::plan(*cq, plannerParams, &rawSolutions));
+
+        vector<unique_ptr<QuerySolution>> solutions;
+        for (auto solution : rawSolutions) {
+            solution->costEstimate =
+                PlanRanker::estimateCost(*solution, collection->numRecords(&_opCtx));
+            solutions.emplace_back(solution);
+        }
+        return solutions;
+    }
+
+    /**
+     * Returns the index in 'solutions' of the only solution using an index with 'keyPattern'.
+     */
+    static size_t findSolutionUsingIndex(const vector<unique_ptr<QuerySolution>>& solutions,
+                                         const char* keyPattern) {
+        const std::string solutionStr =
+            str::stream() << "{fetch: {node: {ixscan: {pattern: " << keyPattern << "}}}}";
+        for (size_t i = 0; i < solutions.size(); ++i) {
+            if (QueryPlannerTestLib::solutionMatches(solutionStr, solutions[i]->root.get())) {
+                return i;
+            }
+        }
+        FAIL(str::stream() << "no solution uses index " << keyPattern);
+        MONGO_UNREACHABLE;
+    }
+
+    static vector<QuerySolution*> toRaw(const vector<unique_ptr<QuerySolution>>& solutions) {
+        vector<QuerySolution*> raw;
+        for (auto&& solution : solutions) {
+            raw.push_back(solution.get());
+        }
+        return raw;
     }
 
     /**
@@ -611,6 +660,93 @@ public:
     }
 };
 
+/**
+ * A point lookup on a unique index is certain to be cheap, so it runs without racing the others.
+ */
+class PlanRankingCostEstimateSkipsRaceForUniquePoint : public PlanRankingTestBase {
+public:
+    void run() {
+        for (int i = 0; i < N; ++i) {
+            insert(BSON("a" << i << "b" << 1));
+        }
+        addIndex(BSON("a" << 1), true);
+        addIndex(BSON("b" << 1));
+
+        auto qr = stdx::make_unique<QueryRequest>(nss);
+        qr->setFilter(fromjson("{a: 5, b: 1}"));
+        auto statusWithCQ = CanonicalQuery::canonicalize(opCtx(), std::move(qr));
+        ASSERT_OK(statusWithCQ.getStatus());
+        unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+        auto solutions = planWithCostEstimates(cq.get());
+        ASSERT_EQUALS(solutions.size(), 2U);
+        const size_t uniqueIdx = findSolutionUsingIndex(solutions, "{a: 1}");
+        const size_t otherIdx = findSolutionUsingIndex(solutions, "{b: 1}");
+
+        const auto& uniqueEstimate = solutions[uniqueIdx]->costEstimate;
+        ASSERT(uniqueEstimate);
+        ASSERT(uniqueEstimate->isUpperBound);
+        ASSERT_EQUALS(uniqueEstimate->keysExamined, 1.0);
+        ASSERT_EQUALS(uniqueEstimate->docsExamined, 1.0);
+
+        const auto& otherEstimate = solutions[otherIdx]->costEstimate;
+        ASSERT(otherEstimate);
+        ASSERT_FALSE(otherEstimate->isUpperBound);
+        ASSERT_GREATER_THAN(otherEstimate->cost(), uniqueEstimate->cost());
+
+        ASSERT(PlanRanker::selectCandidatesByCost(toRaw(solutions)) ==
+               std::vector<size_t>{uniqueIdx});
+
+        // With the shortcut disabled, both plans race.
+        const int oldMaxCost = internalQueryPlannerMaxCostToSkipMultiPlanning.load();
+        ON_BLOCK_EXIT([oldMaxCost] {
+            internalQueryPlannerMaxCostToSkipMultiPlanning.store(oldMaxCost);
+        });
+        internalQueryPlannerMaxCostToSkipMultiPlanning.store(0);
+        ASSERT_EQUALS(PlanRanker::selectCandidatesByCost(toRaw(solutions)).size(), 2U);
+    }
+};
+
+/**
+ * With a cost ratio set, plans estimated to cost far more than the cheapest one are not raced.
+ */
+class PlanRankingCostEstimatePrunesExpensiveCandidates : public PlanRankingTestBase {
+public:
+    void run() {
+        for (int i = 0; i < N; ++i) {
+            insert(BSON("a" << i << "b" << i));
+        }
+        addIndex(BSON("a" << 1));
+        addIndex(BSON("b" << 1));
+
+        auto qr = stdx::make_unique<QueryRequest>(nss);
+        qr->setFilter(fromjson("{a: 5, b: {$gt: 0}}"));
+        auto statusWithCQ = CanonicalQuery::canonicalize(opCtx(), std::move(qr));
+        ASSERT_OK(statusWithCQ.getStatus());
+        unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+        auto solutions = planWithCostEstimates(cq.get());
+        ASSERT_EQUALS(solutions.size(), 2U);
+        const size_t pointIdx = findSolutionUsingIndex(solutions, "{a: 1}");
+        ASSERT_LESS_THAN(solutions[pointIdx]->costEstimate->cost(),
+                         solutions[1 - pointIdx]->costEstimate->cost());
+
+        // By default every candidate races.
+        ASSERT_EQUALS(PlanRanker::selectCandidatesByCost(toRaw(solutions)).size(), 2U);
+
+        const double oldCostRatio = internalQueryPlannerCostRatioToSkipCandidate.load();
+        ON_BLOCK_EXIT([oldCostRatio] {
+            internalQueryPlannerCostRatioToSkipCandidate.store(oldCostRatio);
+        });
+        internalQueryPlannerCostRatioToSkipCandidate.store(10.0);
+        ASSERT(PlanRanker::selectCandidatesByCost(toRaw(solutions)) ==
+               std::vector<size_t>{pointIdx});
+
+        internalQueryPlannerCostRatioToSkipCandidate.store(1000.0);
+        ASSERT_EQUALS(PlanRanker::selectCandidatesByCost(toRaw(solutions)).size(), 2U);
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_plan_ranking") {}
@@ -628,6 +764,8 @@ public:
         add<PlanRankingAvoidBlockingSort>();
         add<PlanRankingWorkPlansLongEnough>();
         add<PlanRankingAccountForKeySkips>();
+        add<PlanRankingCostEstimateSkipsRaceForUniquePoint>();
+        add<PlanRankingCostEstimatePrunesExpensiveCandidates>();
     }
 };
 
@@ -42,11 +42,13 @@
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_cache_replanner.h"
 #include "mongo/db/query/plan_yield_policy.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/scopeguard.h"
 
 namespace QueryStageCachedPlan {
 
@@ -247,6 +249,77 @@ public:
     }
 };
 
+/**
+ * With background replanning enabled, a cached plan that hits the works threshold keeps running,
+ * and the replanner caches a new plan for the shape.
+ */
+class QueryStageCachedPlanHitMaxWorksBackground : public QueryStageCachedPlanBase {
+public:
+    void run() {
+        const bool oldBackgroundReplanning = internalQueryCacheBackgroundReplanning.load();
+        internalQueryCacheBackgroundReplanning.store(true);
+        ON_BLOCK_EXIT([oldBackgroundReplanning] {
+            internalQueryCacheBackgroundReplanning.store(oldBackgroundReplanning);
+        });
+
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+        Collection* collection = ctx.getCollection();
+        ASSERT(collection);
+
+        // Query can be answered by either index on "a" or index on "b".
+        auto qr = stdx::make_unique<QueryRequest>(nss);
+        qr->setFilter(fromjson("{a: {$gte: 8}, b: 1}"));
+        auto statusWithCQ = CanonicalQuery::canonicalize(opCtx(), std::move(qr));
+        ASSERT_OK(statusWithCQ.getStatus());
+        const std::unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+        PlanCache* cache = collection->infoCache()->getPlanCache();
+        ASSERT(cache);
+        CachedSolution* rawCachedSolution;
+        ASSERT_NOT_OK(cache->get(*cq, &rawCachedSolution));
+
+        QueryPlannerParams plannerParams;
+        fillOutPlannerParams(&_opCtx, collection, cq.get(), &plannerParams);
+
+        // The mock child takes long enough to exceed the works threshold, then returns EOF.
+        const size_t decisionWorks = 10;
+        const size_t mockWorks =
+            1U + static_cast<size_t>(internalQueryCacheEvictionRatio * decisionWorks);
+        auto mockChild = stdx::make_unique<QueuedDataStage>(&_opCtx, &_ws);
+        for (size_t i = 0; i < mockWorks; i++) {
+            mockChild->pushBack(PlanStage::NEED_TIME);
+        }
+
+        CachedPlanStage cachedPlanStage(
+            &_opCtx, collection, &_ws, cq.get(), plannerParams, decisionWorks, mockChild.release());
+
+        PlanYieldPolicy yieldPolicy(PlanExecutor::NO_YIELD,
+                                    _opCtx.getServiceContext()->getFastClockSource());
+        ASSERT_OK(cachedPlanStage.pickBestPlan(&yieldPolicy));
+
+        // The query was not replanned, so it still runs the mock child, which produces nothing.
+        size_t numResults = 0;
+        PlanStage::StageState state = PlanStage::NEED_TIME;
+        while (state != PlanStage::IS_EOF) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            state = cachedPlanStage.work(&id);
+
+            ASSERT_NE(state, PlanStage::FAILURE);
+            ASSERT_NE(state, PlanStage::DEAD);
+
+            if (state == PlanStage::ADVANCED) {
+                numResults++;
+            }
+        }
+        ASSERT_EQ(numResults, 0U);
+
+        // Once the background re-evaluation finishes, the shape has a cache entry.
+        PlanCacheReplanner::get(_opCtx.getServiceContext())->waitForIdle();
+        ASSERT_OK(cache->get(*cq, &rawCachedSolution));
+        const std::unique_ptr<CachedSolution> cachedSolution(rawCachedSolution);
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_cached_plan") {}
@@ -254,6 +327,7 @@ public:
     void setupTests() {
         add<QueryStageCachedPlanFailure>();
         add<QueryStageCachedPlanHitMaxWorks>();
+        add<QueryStageCachedPlanHitMaxWorksBackground>();
     }
 };
 
@@ -43,8 +43,10 @@
 #include "mongo/db/exec/queued_data_stage.h"
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/scopeguard.h"
 
 namespace QueryStageFetch {
 
@@ -217,6 +219,66 @@ public:
     }
 };
 
+//
+// Test that reading ahead of the child to prefetch still returns results in the child's order.
+//
+class FetchStageLookAhead : public QueryStageFetchBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_opCtx, ns());
+        Database* db = ctx.db();
+        Collection* coll = db->getCollection(&_opCtx, ns());
+        if (!coll) {
+            WriteUnitOfWork wuow(&_opCtx);
+            coll = db->createCollection(&_opCtx, ns());
+            wuow.commit();
+        }
+
+        const int oldBatchSize = internalQueryExecFetchPrefetchBatchSize.load();
+        ON_BLOCK_EXIT(
+            [oldBatchSize] { internalQueryExecFetchPrefetchBatchSize.store(oldBatchSize); });
+        internalQueryExecFetchPrefetchBatchSize.store(3);
+
+        WorkingSet ws;
+
+        for (int i = 0; i < 5; ++i) {
+            insert(BSON("foo" << i));
+        }
+        set<RecordId> recordIds;
+        getRecordIds(&recordIds, coll);
+        ASSERT_EQUALS(size_t(5), recordIds.size());
+
+        // Hand the ids to the fetch stage in descending order, as a reverse index scan would.
+        auto mockStage = make_unique<QueuedDataStage>(&_opCtx, &ws);
+        std::vector<RecordId> expected(recordIds.rbegin(), recordIds.rend());
+        for (auto&& recordId : expected) {
+            WorkingSetID id = ws.allocate();
+            WorkingSetMember* mockMember = ws.get(id);
+            mockMember->recordId = recordId;
+            ws.transitionToRecordIdAndIdx(id);
+            mockStage->pushBack(id);
+        }
+
+        unique_ptr<FetchStage> fetchStage(
+            new FetchStage(&_opCtx, &ws, mockStage.release(), NULL, coll));
+
+        std::vector<RecordId> results;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        PlanStage::StageState state;
+        while ((state = fetchStage->work(&id)) != PlanStage::IS_EOF) {
+            if (PlanStage::ADVANCED == state) {
+                WorkingSetMember* member = ws.get(id);
+                ASSERT_TRUE(member->hasObj());
+                results.push_back(member->recordId);
+            } else {
+                ASSERT_EQUALS(PlanStage::NEED_TIME, state);
+            }
+        }
+        ASSERT(expected == results);
+        ASSERT_TRUE(fetchStage->isEOF());
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_fetch") {}
@@ -224,6 +286,7 @@ public:
     void setupTests() {
         add<FetchStageAlreadyFetched>();
         add<FetchStageFilter>();
+        add<FetchStageLookAhead>();
     }
 };
 
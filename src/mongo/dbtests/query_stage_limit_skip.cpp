@@ -87,6 +87,32 @@ int countResults(PlanStage* stage) {
     return count;
 }
 
+/**
+ * Like countResults(), but gets the results through workBatch() and checks that they come in the
+ * order they were queued in by getMS().
+ */
+int countBatchResults(PlanStage* stage, WorkingSet* ws, size_t batchSize) {
+    int count = 0;
+    int lastX = -1;
+    std::vector<WorkingSetID> batch;
+    while (!stage->isEOF()) {
+        batch.clear();
+        PlanStage::StageState status = stage->workBatch(batchSize, &batch);
+        if (PlanStage::ADVANCED != status) {
+            ASSERT(batch.empty());
+            continue;
+        }
+        ASSERT_LTE(batch.size(), batchSize);
+        for (auto&& id : batch) {
+            const int x = ws->get(id)->obj.value()["x"].numberInt();
+            ASSERT_GT(x, lastX);
+            lastX = x;
+            ++count;
+        }
+    }
+    return count;
+}
+
 //
 // Insert 50 objects.  Filter/skip 0, 1, 2, ..., 100 objects and expect the right # of results.
 //
@@ -110,12 +136,68 @@ protected:
     OperationContext* const _opCtx = _uniqOpCtx.get();
 };
 
+//
+// Same as above, but working in batches.
+//
+class QueryStageLimitSkipBatchTest : public QueryStageLimitSkipBasicTest {
+public:
+    void run() {
+        for (size_t batchSize : {1, 7, 1000}) {
+            for (int i = 0; i < 2 * N; ++i) {
+                WorkingSet ws;
+
+                unique_ptr<PlanStage> skip =
+                    make_unique<SkipStage>(_opCtx, i, &ws, getMS(_opCtx, &ws));
+                ASSERT_EQUALS(max(0, N - i), countBatchResults(skip.get(), &ws, batchSize));
+
+                unique_ptr<PlanStage> limit =
+                    make_unique<LimitStage>(_opCtx, i, &ws, getMS(_opCtx, &ws));
+                ASSERT_EQUALS(min(N, i), countBatchResults(limit.get(), &ws, batchSize));
+                ASSERT_EQUALS(static_cast<size_t>(min(N, i)),
+                              limit->getCommonStats()->advanced);
+            }
+        }
+    }
+};
+
+//
+// A state other than ADVANCED that comes up during a batch is returned by the next call.
+//
+class QueryStageBatchHoldsBackStateTest : public QueryStageLimitSkipBasicTest {
+public:
+    void run() {
+        WorkingSet ws;
+        auto ms = make_unique<QueuedDataStage>(_opCtx, &ws);
+        for (int i = 0; i < 2; ++i) {
+            WorkingSetID id = ws.allocate();
+            WorkingSetMember* wsm = ws.get(id);
+            wsm->obj = Snapshotted<BSONObj>(SnapshotId(), BSON("x" << i));
+            wsm->transitionToOwnedObj();
+            ms->pushBack(id);
+        }
+        ms->pushBack(PlanStage::NEED_YIELD);
+
+        std::vector<WorkingSetID> batch;
+        ASSERT_EQUALS(PlanStage::ADVANCED, ms->workBatch(10, &batch));
+        ASSERT_EQUALS(2U, batch.size());
+
+        batch.clear();
+        ASSERT_EQUALS(PlanStage::NEED_YIELD, ms->workBatch(10, &batch));
+        ASSERT(batch.empty());
+
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        ASSERT_EQUALS(PlanStage::IS_EOF, ms->work(&id));
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_limit_skip") {}
 
     void setupTests() {
         add<QueryStageLimitSkipBasicTest>();
+        add<QueryStageLimitSkipBatchTest>();
+        add<QueryStageBatchHoldsBackStateTest>();
     }
 };
 
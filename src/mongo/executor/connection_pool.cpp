@@ -138,6 +138,12 @@ private:
 
     OwnedConnection takeFromProcessingPool(ConnectionInterface* connection);
 
+    /**
+     * The number of connections this pool keeps open even without requests: minConnections, or
+     * the recent peak demand for the host if adaptiveMinConnections is set.
+     */
+    size_t minConnections(const stdx::unique_lock<stdx::mutex>& lk);
+
     void updateStateInLock();
 
 private:
@@ -192,6 +198,7 @@ size_t const ConnectionPool::kDefaultMinConns = 1;
 size_t const ConnectionPool::kDefaultMaxConnecting = std::numeric_limits<size_t>::max();
 constexpr Milliseconds ConnectionPool::kDefaultRefreshRequirement;
 constexpr Milliseconds ConnectionPool::kDefaultRefreshTimeout;
+constexpr Milliseconds ConnectionPool::kDefaultDemandHistoryWindow;
 
 const Status ConnectionPool::kConnectionStateUnknown =
     Status(ErrorCodes::InternalError, "Connection is in an unknown state");
@@ -262,6 +269,40 @@ size_t ConnectionPool::getNumConnectionsPerHost(const HostAndPort& hostAndPort)
     return 0;
 }
 
+void ConnectionPool::recordDemand(const stdx::unique_lock<stdx::mutex>& lk,
+                                  const HostAndPort& hostAndPort,
+                                  size_t demand) {
+    if (!_options.adaptiveMinConnections) {
+        return;
+    }
+
+    // Make sure the current window is up to date before raising its peak
+    recentDemand(lk, hostAndPort);
+
+    auto& history = _demandHistory[hostAndPort];
+    history.peak = std::max(history.peak, demand);
+}
+
+size_t ConnectionPool::recentDemand(const stdx::unique_lock<stdx::mutex>& lk,
+                                    const HostAndPort& hostAndPort) {
+    if (!_options.adaptiveMinConnections) {
+        return 0;
+    }
+
+    auto now = _factory->now();
+    auto& history = _demandHistory[hostAndPort];
+
+    if (now - history.windowStart >= _options.demandHistoryWindow) {
+        // Roll over to a new window, forgetting everything if a whole window went by unused
+        history.previousPeak =
+            (now - history.windowStart >= _options.demandHistoryWindow * 2) ? 0 : history.peak;
+        history.peak = 0;
+        history.windowStart = now;
+    }
+
+    return std::max(history.peak, history.previousPeak);
+}
+
 void ConnectionPool::returnConnection(ConnectionInterface* conn) {
     stdx::unique_lock<stdx::mutex> lk(_mutex);
 
@@ -309,6 +350,12 @@ size_t ConnectionPool::SpecificPool::openConnections(const stdx::unique_lock<std
     return _checkedOutPool.size() + _readyPool.size() + _processingPool.size();
 }
 
+size_t ConnectionPool::SpecificPool::minConnections(const stdx::unique_lock<stdx::mutex>& lk) {
+    return std::max(_parent->_options.minConnections,
+                    std::min(_parent->recentDemand(lk, _hostAndPort),
+                             _parent->_options.maxConnections));
+}
+
 void ConnectionPool::SpecificPool::getConnection(const HostAndPort& hostAndPort,
                                                  Milliseconds timeout,
                                                  stdx::unique_lock<stdx::mutex> lk,
@@ -320,6 +367,7 @@ void ConnectionPool::SpecificPool::getConnection(const HostAndPort& hostAndPort,
     const auto expiration = _parent->_factory->now() + timeout;
 
     _requests.push(make_pair(expiration, std::move(cb)));
+    _parent->recordDemand(lk, _hostAndPort, _requests.size() + _checkedOutPool.size());
 
     updateStateInLock();
 
@@ -356,7 +404,7 @@ void ConnectionPool::SpecificPool::returnConnection(ConnectionInterface* connPtr
         // If we need to refresh this connection
 
         if (_readyPool.size() + _processingPool.size() + _checkedOutPool.size() >=
-            _parent->_options.minConnections) {
+            minConnections(lk)) {
             // If we already have minConnections, just let the connection lapse
             log() << "Ending idle connection to host " << _hostAndPort
                   << " because the pool meets constraints; " << openConnections(lk)
@@ -565,9 +613,10 @@ void ConnectionPool::SpecificPool::spawnConnections(stdx::unique_lock<stdx::mute
     auto guard = MakeGuard([&] { _inSpawnConnections = false; });
 
     // We want minConnections <= outstanding requests <= maxConnections
+    const auto minimum = minConnections(lk);
     auto target = [&] {
         return std::max(
-            _parent->_options.minConnections,
+            minimum,
             std::min(_requests.size() + _checkedOutPool.size(), _parent->_options.maxConnections));
     };
 
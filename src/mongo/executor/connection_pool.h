@@ -74,6 +74,7 @@ public:
     static const size_t kDefaultMaxConnecting;
     static constexpr Milliseconds kDefaultRefreshRequirement = Milliseconds(60000);  // 1min
     static constexpr Milliseconds kDefaultRefreshTimeout = Milliseconds(20000);      // 20secs
+    static constexpr Milliseconds kDefaultDemandHistoryWindow = Milliseconds(600000);  // 10mins
 
     static const Status kConnectionStateUnknown;
 
@@ -117,6 +118,21 @@ public:
          * out connections or new requests
          */
         Milliseconds hostTimeout = kDefaultHostTimeout;
+
+        /**
+         * If set, the pool remembers the peak number of connections concurrently requested from
+         * each host and treats it as an additional minimum (capped by maxConnections). Pools
+         * which are recreated, or which drop their connections after a failure, then spawn
+         * enough connections for the expected load on the first request, rather than one per
+         * request as they arrive. The history outlives the per-host pool itself.
+         */
+        bool adaptiveMinConnections = false;
+
+        /**
+         * How long an observed peak in demand is remembered by adaptiveMinConnections. A peak
+         * is forgotten between one and two windows after it was last reached.
+         */
+        Milliseconds demandHistoryWindow = kDefaultDemandHistoryWindow;
     };
 
     explicit ConnectionPool(std::unique_ptr<DependentTypeFactoryInterface> impl,
@@ -134,8 +150,23 @@ public:
     size_t getNumConnectionsPerHost(const HostAndPort& hostAndPort) const;
 
 private:
+    /**
+     * Peak number of connections concurrently requested from a host in the current and in the
+     * previous demandHistoryWindow.
+     */
+    struct DemandHistory {
+        Date_t windowStart;
+        size_t peak = 0;
+        size_t previousPeak = 0;
+    };
+
     void returnConnection(ConnectionInterface* connection);
 
+    void recordDemand(const stdx::unique_lock<stdx::mutex>& lk,
+                      const HostAndPort& hostAndPort,
+                      size_t demand);
+    size_t recentDemand(const stdx::unique_lock<stdx::mutex>& lk, const HostAndPort& hostAndPort);
+
     std::string _name;
 
     // Options are set at startup and never changed at run time, so these are
@@ -147,6 +178,7 @@ private:
     // The global mutex for specific pool access and the generation counter
     mutable stdx::mutex _mutex;
     stdx::unordered_map<HostAndPort, std::unique_ptr<SpecificPool>> _pools;
+    stdx::unordered_map<HostAndPort, DemandHistory> _demandHistory;
 };
 
 class ConnectionPool::ConnectionHandleDeleter {
@@ -916,6 +916,77 @@ TEST_F(ConnectionPoolTest, minPoolRespected) {
 }
 
 
+/**
+ * Verify that with adaptiveMinConnections a pool which dropped its connections spawns enough
+ * connections for its recent peak demand on the first new request.
+ */
+TEST_F(ConnectionPoolTest, adaptiveMinPoolRespected) {
+    ConnectionPool::Options options;
+    options.minConnections = 1;
+    options.maxConnections = 10;
+    options.adaptiveMinConnections = true;
+    options.demandHistoryWindow = Milliseconds(1000);
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test pool", options);
+
+    auto now = Date_t::now();
+    PoolImpl::setNow(now);
+
+    // Check out four connections at once
+    constexpr size_t kPeak = 4;
+    std::vector<ConnectionPool::ConnectionHandle> connections;
+    for (size_t i = 0; i != kPeak; ++i) {
+        ConnectionImpl::pushSetup(Status::OK());
+        pool.get(HostAndPort(),
+                 Milliseconds(5000),
+                 [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                     ASSERT(swConn.isOK());
+                     connections.push_back(std::move(swConn.getValue()));
+                 });
+    }
+    ASSERT_EQ(connections.size(), kPeak);
+
+    for (auto&& conn : connections) {
+        doneWith(conn);
+    }
+    connections.clear();
+
+    // Drop everything, as after a failover. The next request warms the pool up to the peak.
+    pool.dropConnections(HostAndPort());
+    ASSERT_EQ(pool.getNumConnectionsPerHost(HostAndPort()), 0U);
+
+    ConnectionPool::ConnectionHandle conn;
+    pool.get(HostAndPort(),
+             Milliseconds(5000),
+             [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                 ASSERT(swConn.isOK());
+                 conn = std::move(swConn.getValue());
+             });
+    ASSERT_EQ(ConnectionImpl::setupQueueDepth(), kPeak);
+
+    for (size_t i = 0; i != kPeak; ++i) {
+        ConnectionImpl::pushSetup(Status::OK());
+    }
+    ASSERT(conn);
+    doneWith(conn);
+    conn.reset();
+
+    // Once the peak has aged out, a dropped pool only spawns what is requested again
+    PoolImpl::setNow(now + Milliseconds(2500));
+    pool.dropConnections(HostAndPort());
+
+    pool.get(HostAndPort(),
+             Milliseconds(5000),
+             [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                 ASSERT(swConn.isOK());
+                 conn = std::move(swConn.getValue());
+             });
+    ASSERT_EQ(ConnectionImpl::setupQueueDepth(), 1U);
+
+    ConnectionImpl::pushSetup(Status::OK());
+    ASSERT(conn);
+    doneWith(conn);
+}
+
 /**
  * Verify that the hostTimeout is respected. This implies that an idle
  * hostAndPort drops it's connections.
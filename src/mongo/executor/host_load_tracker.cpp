@@ -0,0 +1,101 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/executor/host_load_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/executor/remote_command_response.h"
+
+namespace mongo {
+namespace executor {
+namespace {
+
+// Weight of a new latency sample in the moving average.
+const double kLatencySampleWeight = 0.2;
+
+// Latency samples older than this count less and less towards the cost of a host, so that a host
+// which was avoided while it was slow gets traffic again once it has had time to recover.
+const double kLatencyDecayMillis = 10 * 1000;
+
+}  // namespace
+
+HostLoadTracker& HostLoadTracker::get() {
+    static HostLoadTracker tracker;
+    return tracker;
+}
+
+void HostLoadTracker::onCommandStarted(const HostAndPort& host) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    ++_loads[host].inFlight;
+}
+
+void HostLoadTracker::onCommandFinished(const HostAndPort& host,
+                                        const RemoteCommandResponse& response) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto& load = _loads[host];
+    if (load.inFlight > 0) {
+        --load.inFlight;
+    }
+
+    if (!response.isOK() || !response.elapsedMillis) {
+        return;
+    }
+
+    const double sample = durationCount<Microseconds>(*response.elapsedMillis);
+    load.latencyMicros = (load.lastSample == Date_t())
+        ? sample
+        : load.latencyMicros + kLatencySampleWeight * (sample - load.latencyMicros);
+    load.lastSample = Date_t::now();
+}
+
+double HostLoadTracker::cost(const HostAndPort& host, int64_t pingLatencyMicros) const {
+    double latencyMicros = pingLatencyMicros;
+    int64_t inFlight = 0;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto it = _loads.find(host);
+        if (it != _loads.end()) {
+            const auto& load = it->second;
+            inFlight = load.inFlight;
+            if (load.lastSample != Date_t()) {
+                const double age = durationCount<Milliseconds>(Date_t::now() - load.lastSample);
+                const double weight = std::exp(-age / kLatencyDecayMillis);
+                latencyMicros = weight * load.latencyMicros + (1 - weight) * pingLatencyMicros;
+            }
+        }
+    }
+
+    return std::max(latencyMicros, 1.0) * (inFlight + 1);
+}
+
+}  // namespace executor
+}  // namespace mongo
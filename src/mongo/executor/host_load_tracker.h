@@ -0,0 +1,84 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace executor {
+
+struct RemoteCommandResponse;
+
+/**
+ * Process-wide record of the load this process puts on each remote host, as observed by the
+ * network interfaces which run commands against them: the number of commands currently in flight
+ * and an exponentially weighted moving average of their latency.
+ *
+ * It is used to prefer lightly loaded members of a replica set when the read preference leaves a
+ * choice, see ReplicaSetMonitor.
+ */
+class HostLoadTracker {
+    MONGO_DISALLOW_COPYING(HostLoadTracker);
+
+public:
+    HostLoadTracker() = default;
+
+    static HostLoadTracker& get();
+
+    /**
+     * Must be called once when a command is sent to 'host', and then onCommandFinished once when
+     * its response or error is delivered.
+     */
+    void onCommandStarted(const HostAndPort& host);
+    void onCommandFinished(const HostAndPort& host, const RemoteCommandResponse& response);
+
+    /**
+     * Returns the expected cost of sending another command to 'host': its average latency times
+     * the number of commands which would then be in flight to it. Hosts without samples, or whose
+     * samples are old, are assumed to respond in 'pingLatencyMicros'.
+     */
+    double cost(const HostAndPort& host, int64_t pingLatencyMicros) const;
+
+private:
+    struct Load {
+        int64_t inFlight = 0;
+        double latencyMicros = 0;
+        Date_t lastSample;
+    };
+
+    mutable stdx::mutex _mutex;
+    stdx::unordered_map<HostAndPort, Load> _loads;
+};
+
+}  // namespace executor
+}  // namespace mongo
@@ -0,0 +1,81 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/executor/host_load_tracker.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/executor/remote_command_response.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace executor {
+namespace {
+
+const HostAndPort kHost("host1", 27017);
+const HostAndPort kOtherHost("host2", 27017);
+
+RemoteCommandResponse makeResponse(Milliseconds elapsed) {
+    return RemoteCommandResponse(BSON("ok" << 1), BSONObj(), elapsed);
+}
+
+TEST(HostLoadTrackerTest, UnknownHostCostsItsPingLatency) {
+    HostLoadTracker tracker;
+    ASSERT_EQ(100.0, tracker.cost(kHost, 100));
+}
+
+TEST(HostLoadTrackerTest, InFlightCommandsIncreaseCost) {
+    HostLoadTracker tracker;
+    tracker.onCommandStarted(kHost);
+    tracker.onCommandStarted(kHost);
+    ASSERT_EQ(300.0, tracker.cost(kHost, 100));
+    ASSERT_EQ(100.0, tracker.cost(kOtherHost, 100));
+
+    tracker.onCommandFinished(kHost, RemoteCommandResponse(ErrorCodes::HostUnreachable, "down"));
+    ASSERT_EQ(200.0, tracker.cost(kHost, 100));
+}
+
+TEST(HostLoadTrackerTest, ObservedLatencyReplacesPingLatency) {
+    HostLoadTracker tracker;
+    tracker.onCommandStarted(kHost);
+    tracker.onCommandFinished(kHost, makeResponse(Milliseconds(10)));
+
+    // The sample is fresh, so it dominates the 100 microsecond ping latency.
+    ASSERT_GT(tracker.cost(kHost, 100), 9000.0);
+    ASSERT_LT(tracker.cost(kHost, 100), 10001.0);
+
+    tracker.onCommandStarted(kHost);
+    tracker.onCommandFinished(kHost, makeResponse(Milliseconds(20)));
+    ASSERT_GT(tracker.cost(kHost, 100), 11000.0);
+    ASSERT_LT(tracker.cost(kHost, 100), 12001.0);
+}
+
+}  // namespace
+}  // namespace executor
+}  // namespace mongo
@@ -43,6 +43,7 @@
 #include "mongo/executor/async_timer_mock.h"
 #include "mongo/executor/connection_pool_asio.h"
 #include "mongo/executor/connection_pool_stats.h"
+#include "mongo/executor/host_load_tracker.h"
 #include "mongo/rpc/metadata/metadata_hook.h"
 #include "mongo/stdx/chrono.h"
 #include "mongo/stdx/memory.h"
@@ -272,7 +273,15 @@ Status NetworkInterfaceASIO::startCommand(const TaskExecutor::CallbackHandle& cb
         return statusMetadata;
     }
 
-    auto nextStep = [this, getConnectionStartTime, cbHandle, request, onFinish](
+    // Account for the command in the load of its target until its completion is delivered.
+    HostLoadTracker::get().onCommandStarted(request.target);
+    RemoteCommandCompletionFn trackedOnFinish = [ target = request.target,
+                                                  onFinish ](const ResponseStatus& response) {
+        HostLoadTracker::get().onCommandFinished(target, response);
+        onFinish(response);
+    };
+
+    auto nextStep = [ this, getConnectionStartTime, cbHandle, request, onFinish = trackedOnFinish ](
         StatusWith<ConnectionPool::ConnectionHandle> swConn) {
 
         if (!swConn.isOK()) {
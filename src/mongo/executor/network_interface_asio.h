@@ -108,6 +108,9 @@ public:
         std::unique_ptr<NetworkConnectionHook> networkConnectionHook;
         std::unique_ptr<AsyncStreamFactoryInterface> streamFactory;
         std::unique_ptr<rpc::EgressMetadataHook> metadataHook;
+        // Compressors to offer ahead of the globally configured order when negotiating
+        // compression on new connections.
+        std::vector<std::string> preferredCompressors;
     };
 
     NetworkInterfaceASIO(Options = Options());
@@ -72,7 +72,7 @@ void NetworkInterfaceASIO::_runIsMaster(AsyncOp* op) {
         bob.append("hostInfo", sb.str());
     }
 
-    op->connection().getCompressorManager().clientBegin(&bob);
+    op->connection().getCompressorManager().clientBegin(&bob, _options.preferredCompressors);
 
     if (WireSpec::instance().isInternalClient) {
         WireSpec::appendInternalClientWireVersion(WireSpec::instance().outgoing, &bob);
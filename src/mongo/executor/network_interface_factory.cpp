@@ -56,13 +56,15 @@ std::unique_ptr<NetworkInterface> makeNetworkInterface(
     std::string instanceName,
     std::unique_ptr<NetworkConnectionHook> hook,
     std::unique_ptr<rpc::EgressMetadataHook> metadataHook,
-    ConnectionPool::Options connPoolOptions) {
+    ConnectionPool::Options connPoolOptions,
+    std::vector<std::string> preferredCompressors) {
     NetworkInterfaceASIO::Options options{};
     options.instanceName = std::move(instanceName);
     options.networkConnectionHook = std::move(hook);
     options.metadataHook = std::move(metadataHook);
     options.timerFactory = stdx::make_unique<AsyncTimerFactoryASIO>();
     options.connectionPoolOptions = connPoolOptions;
+    options.preferredCompressors = std::move(preferredCompressors);
 
 #ifdef MONGO_CONFIG_SSL
     if (SSLManagerInterface* manager = getSSLManager()) {
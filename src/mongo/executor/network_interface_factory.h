@@ -30,6 +30,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "mongo/executor/connection_pool.h"
 #include "mongo/executor/network_interface.h"
@@ -51,12 +52,16 @@ std::unique_ptr<NetworkInterface> makeNetworkInterface(std::string instanceName)
 
 /**
  * Returns a new NetworkInterface with the given connection hook set.
+ *
+ * Connections made by the NetworkInterface offer 'preferredCompressors' ahead of the other
+ * configured network message compressors.
  */
 std::unique_ptr<NetworkInterface> makeNetworkInterface(
     std::string instanceName,
     std::unique_ptr<NetworkConnectionHook> hook,
     std::unique_ptr<rpc::EgressMetadataHook> metadataHook,
-    ConnectionPool::Options options = ConnectionPool::Options());
+    ConnectionPool::Options options = ConnectionPool::Options(),
+    std::vector<std::string> preferredCompressors = {});
 
 }  // namespace executor
 }  // namespace mongo
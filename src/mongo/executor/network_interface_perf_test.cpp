@@ -30,6 +30,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <exception>
 
 #include "mongo/base/status_with.h"
@@ -40,7 +41,9 @@
 #include "mongo/executor/async_timer_asio.h"
 #include "mongo/executor/network_interface_asio.h"
 #include "mongo/executor/network_interface_asio_test_utils.h"
+#include "mongo/executor/network_interface_thread_pool.h"
 #include "mongo/executor/task_executor.h"
+#include "mongo/executor/thread_pool_task_executor.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/integration_test.h"
 #include "mongo/unittest/unittest.h"
@@ -56,6 +59,10 @@ namespace {
 
 const std::size_t numOperations = 16384;
 
+// How many pings the scatter-gather test keeps in flight at once, like a mongos fanning a query
+// out to every shard.
+const std::size_t fanOut = 64;
+
 
 int timeNetworkTestMillis(std::size_t operations, NetworkInterface* net) {
     net->startup();
@@ -109,6 +116,72 @@ TEST(NetworkInterfaceASIO, SerialPerf) {
     log() << "THROUGHPUT asio ping ops/s: " << result;
 }
 
+// Runs 'operations' pings through a ThreadPoolTaskExecutor, 'fanOut' at a time, with every
+// response callback also scheduling a unit of local work. This exercises the executor's queues
+// and mutex the way scatter-gather on mongos does, rather than the raw network interface.
+int timeExecutorScatterGatherMillis(std::size_t operations, TaskExecutor* executor) {
+    auto fixture = unittest::getFixtureConnectionString();
+    auto server = fixture.getServers()[0];
+
+    std::atomic<int> remainingOps(operations);   // NOLINT
+    std::atomic<int> remainingWork(operations);  // NOLINT
+    stdx::mutex mtx;
+    stdx::condition_variable cv;
+    Timer t;
+
+    const auto bsonObjPing = BSON("ping" << 1);
+
+    const auto onWorkDone = [&](const TaskExecutor::CallbackArgs&) {
+        if (--remainingWork == 0) {
+            stdx::unique_lock<stdx::mutex> lk(mtx);
+            cv.notify_one();
+        }
+    };
+
+    stdx::function<void()> func;
+    const auto callback = [&](const TaskExecutor::RemoteCommandCallbackArgs& args) {
+        uassertStatusOK(args.response.status);
+        uassertStatusOK(executor->scheduleWork(onWorkDone).getStatus());
+        if (--remainingOps >= static_cast<int>(fanOut)) {
+            func();
+        }
+    };
+
+    func = [&]() {
+        RemoteCommandRequest request{
+            server, "admin", bsonObjPing, BSONObj(), nullptr, Milliseconds(-1)};
+        uassertStatusOK(executor->scheduleRemoteCommand(request, callback).getStatus());
+    };
+
+    for (std::size_t i = 0; i < std::min(fanOut, operations); ++i) {
+        func();
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(mtx);
+    cv.wait(lk, [&] { return remainingWork.load() == 0; });
+
+    return t.millis();
+}
+
+TEST(ThreadPoolTaskExecutor, ScatterGatherPerf) {
+    NetworkInterfaceASIO::Options options{};
+    options.streamFactory = stdx::make_unique<AsyncStreamFactory>();
+    options.timerFactory = stdx::make_unique<AsyncTimerFactoryASIO>();
+    auto net = stdx::make_unique<NetworkInterfaceASIO>(std::move(options));
+    auto netPtr = net.get();
+    ThreadPoolTaskExecutor executor(stdx::make_unique<NetworkInterfaceThreadPool>(netPtr),
+                                    std::move(net));
+    executor.startup();
+    auto guard = MakeGuard([&] {
+        executor.shutdown();
+        executor.join();
+    });
+
+    int duration = std::max(timeExecutorScatterGatherMillis(numOperations, &executor), 1);
+    int result = numOperations * 1000 / duration;
+    log() << "THROUGHPUT executor scatter-gather ping ops/s: " << result;
+}
+
 }  // namespace
 }  // namespace executor
 }  // namespace mongo
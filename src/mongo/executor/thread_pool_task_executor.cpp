@@ -92,6 +92,8 @@ public:
     WorkQueue::iterator iter;
     Date_t readyDate;
     bool isNetworkOperation = false;
+    // True while the callback sits in _sleepersQueue waiting for its alarm.
+    bool isSleeping = false;
     AtomicWord<bool> isFinished{false};
     boost::optional<stdx::condition_variable> finishedCondition;
 };
@@ -337,6 +339,7 @@ StatusWith<TaskExecutor::CallbackHandle> ThreadPoolTaskExecutor::scheduleWorkAt(
     if (!cbHandle.isOK()) {
         return cbHandle;
     }
+    _sleepersQueue.back()->isSleeping = true;
     lk.unlock();
     _net->setAlarm(when,
                    [this, when, cbHandle] {
@@ -414,13 +417,13 @@ StatusWith<TaskExecutor::CallbackHandle> ThreadPoolTaskExecutor::scheduleRemoteC
                 CallbackFn newCb = [cb, scheduledRequest, response](const CallbackArgs& cbData) {
                     remoteCommandFinished(cbData, cb, scheduledRequest, response);
                 };
+                LOG(3) << "Received remote response: "
+                       << redact(response.isOK() ? response.toString()
+                                                 : response.status.toString());
                 stdx::unique_lock<stdx::mutex> lk(_mutex);
                 if (_inShutdown_inlock()) {
                     return;
                 }
-                LOG(3) << "Received remote response: "
-                       << redact(response.isOK() ? response.toString()
-                                                 : response.status.toString());
                 swap(cbState->callback, newCb);
                 scheduleIntoPool_inlock(&_networkInProgressQueue, cbState->iter, std::move(lk));
             })
@@ -441,18 +444,10 @@ void ThreadPoolTaskExecutor::cancel(const CallbackHandle& cbHandle) {
         _net->cancelCommand(cbHandle);
         return;
     }
-    if (cbState->readyDate != Date_t{}) {
-        // This callback might still be in the sleeper queue; if it is, schedule it now
-        // rather than when the alarm fires.
-        auto iter = std::find_if(_sleepersQueue.begin(),
-                                 _sleepersQueue.end(),
-                                 [cbState](const std::shared_ptr<CallbackState>& other) {
-                                     return cbState == other.get();
-                                 });
-        if (iter != _sleepersQueue.end()) {
-            invariant(iter == cbState->iter);
-            scheduleIntoPool_inlock(&_sleepersQueue, cbState->iter, std::move(lk));
-        }
+    if (cbState->isSleeping) {
+        // This callback is still in the sleeper queue, so schedule it now rather than when the
+        // alarm fires.
+        scheduleIntoPool_inlock(&_sleepersQueue, cbState->iter, std::move(lk));
     }
 }
 
@@ -522,7 +517,16 @@ void ThreadPoolTaskExecutor::scheduleIntoPool_inlock(WorkQueue* fromQueue,
 void ThreadPoolTaskExecutor::scheduleIntoPool_inlock(WorkQueue* fromQueue,
                                                      const WorkQueue::iterator& iter,
                                                      stdx::unique_lock<stdx::mutex> lk) {
-    scheduleIntoPool_inlock(fromQueue, iter, std::next(iter), std::move(lk));
+    // Every scheduleWork, alarm and network response lands here, so avoid the vector the range
+    // overload needs.
+    dassert(fromQueue != &_poolInProgressQueue);
+    const auto cbState = *iter;
+    cbState->isSleeping = false;
+    _poolInProgressQueue.splice(_poolInProgressQueue.end(), *fromQueue, iter);
+
+    lk.unlock();
+
+    _dispatchToPool(&cbState, &cbState + 1);
 }
 
 void ThreadPoolTaskExecutor::scheduleIntoPool_inlock(WorkQueue* fromQueue,
@@ -531,10 +535,18 @@ void ThreadPoolTaskExecutor::scheduleIntoPool_inlock(WorkQueue* fromQueue,
                                                      stdx::unique_lock<stdx::mutex> lk) {
     dassert(fromQueue != &_poolInProgressQueue);
     std::vector<std::shared_ptr<CallbackState>> todo(begin, end);
+    for (const auto& cbState : todo) {
+        cbState->isSleeping = false;
+    }
     _poolInProgressQueue.splice(_poolInProgressQueue.end(), *fromQueue, begin, end);
 
     lk.unlock();
 
+    _dispatchToPool(todo.data(), todo.data() + todo.size());
+}
+
+void ThreadPoolTaskExecutor::_dispatchToPool(const std::shared_ptr<CallbackState>* begin,
+                                             const std::shared_ptr<CallbackState>* end) {
     if (MONGO_FAIL_POINT(scheduleIntoPoolSpinsUntilThreadPoolShutsDown)) {
         scheduleIntoPoolSpinsUntilThreadPoolShutsDown.setMode(FailPoint::off);
         while (_pool->schedule([] {}) != ErrorCodes::ShutdownInProgress) {
@@ -542,7 +554,8 @@ void ThreadPoolTaskExecutor::scheduleIntoPool_inlock(WorkQueue* fromQueue,
         }
     }
 
-    for (const auto& cbState : todo) {
+    for (auto it = begin; it != end; ++it) {
+        const auto& cbState = *it;
         const auto status = _pool->schedule([this, cbState] { runCallback(std::move(cbState)); });
         if (status == ErrorCodes::ShutdownInProgress)
             break;
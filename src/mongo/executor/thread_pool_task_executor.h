@@ -162,6 +162,13 @@ private:
                                  const WorkQueue::iterator& end,
                                  stdx::unique_lock<stdx::mutex> lk);
 
+    /**
+     * Hands the callbacks in ["begin", "end") to the thread pool. Must be called without _mutex
+     * held, after the callbacks have been moved into _poolInProgressQueue.
+     */
+    void _dispatchToPool(const std::shared_ptr<CallbackState>* begin,
+                         const std::shared_ptr<CallbackState>* end);
+
     /**
      * Executes the callback specified by "cbState".
      */
@@ -32,22 +32,87 @@
 
 #include "mongo/s/async_requests_sender.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "mongo/client/remote_command_targeter.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
+
+MONGO_EXPORT_SERVER_PARAMETER(enableHedgedReads, bool, false);
+MONGO_EXPORT_SERVER_PARAMETER(hedgedReadsMinDelayMillis, int, 5);
+MONGO_EXPORT_SERVER_PARAMETER(hedgedReadsMaxDelayMillis, int, 1000);
+
 namespace {
 
 // Maximum number of retries for network and replication notMaster errors (per host).
 const int kMaxNumFailedHostRetryAttempts = 3;
 
+// Host selection for nearest and secondary reads is randomized among the eligible members, so a
+// hedged request asks the targeter a few times for a host other than the one already in use.
+const int kMaxHedgeHostSelectionAttempts = 4;
+
+/**
+ * Tracks a smoothed mean and mean deviation of the response latency of each host, the same way
+ * TCP estimates round trip times. The mean plus twice the mean deviation approximates the 95th
+ * percentile latency, which is how long a request is given before it is hedged.
+ */
+class HostLatencyEstimates {
+public:
+    void record(const HostAndPort& host, Milliseconds latency) {
+        const double sample = durationCount<Milliseconds>(latency);
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto it = _estimates.find(host);
+        if (it == _estimates.end()) {
+            _estimates.emplace(host, Estimate{sample, sample / 2});
+            return;
+        }
+
+        auto& estimate = it->second;
+        const double error = sample - estimate.mean;
+        estimate.mean += error / 8;
+        estimate.deviation += (std::abs(error) - estimate.deviation) / 4;
+    }
+
+    Milliseconds hedgeDelay(const HostAndPort& host) {
+        const auto minDelay = Milliseconds(hedgedReadsMinDelayMillis.load());
+        const auto maxDelay = std::max(minDelay, Milliseconds(hedgedReadsMaxDelayMillis.load()));
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto it = _estimates.find(host);
+        if (it == _estimates.end()) {
+            return maxDelay;
+        }
+
+        const auto& estimate = it->second;
+        const auto delay =
+            Milliseconds(static_cast<long long>(estimate.mean + 2 * estimate.deviation));
+        return std::max(minDelay, std::min(maxDelay, delay));
+    }
+
+private:
+    struct Estimate {
+        double mean;
+        double deviation;
+    };
+
+    stdx::mutex _mutex;
+    stdx::unordered_map<HostAndPort, Estimate> _estimates;
+};
+
+HostLatencyEstimates hostLatencyEstimates;
+
 }  // namespace
 
 AsyncRequestsSender::AsyncRequestsSender(OperationContext* opCtx,
@@ -86,6 +151,21 @@ AsyncRequestsSender::~AsyncRequestsSender() {
     while (!done()) {
         next();
     }
+
+    // Requests which lost to their hedged counterpart do not affect done(), but their callbacks
+    // still refer to this object.
+    std::vector<executor::TaskExecutor::CallbackHandle> abandonedCbHandles;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        for (const auto& remote : _remotes) {
+            abandonedCbHandles.insert(abandonedCbHandles.end(),
+                                      remote.abandonedCbHandles.begin(),
+                                      remote.abandonedCbHandles.end());
+        }
+    }
+    for (const auto& cbHandle : abandonedCbHandles) {
+        _executor->wait(cbHandle);
+    }
 }
 
 AsyncRequestsSender::Response AsyncRequestsSender::next() {
@@ -98,7 +178,13 @@ AsyncRequestsSender::Response AsyncRequestsSender::next() {
         // Otherwise, wait for some response to be received.
         if (_interruptStatus.isOK()) {
             try {
-                _notification->get(_opCtx);
+                if (_nextHedgeAt == Date_t::max()) {
+                    _notification->get(_opCtx);
+                } else {
+                    // Wake up in time to send the next hedged request.
+                    _notification->waitFor(
+                        _opCtx, std::max(Milliseconds(0), _nextHedgeAt - _executor->now()));
+                }
             } catch (const AssertionException& ex) {
                 // If the operation is interrupted, we cancel outstanding requests and switch to
                 // waiting for the (canceled) callbacks to finish without checking for interrupts.
@@ -113,6 +199,31 @@ AsyncRequestsSender::Response AsyncRequestsSender::next() {
     return *readyResponse;
 }
 
+void AsyncRequestsSender::addRequest(const Request& request) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    _remotes.emplace_back(request.shardId, request.cmdObj);
+    auto& remote = _remotes.back();
+
+    Status scheduleStatus = Status::OK();
+    if (_stopRetrying) {
+        scheduleStatus = _interruptStatus.isOK()
+            ? Status(ErrorCodes::CallbackCanceled, "Not sending request after retries stopped")
+            : _interruptStatus;
+    } else {
+        scheduleStatus = _scheduleRequest(lk, _remotes.size() - 1);
+    }
+
+    if (!scheduleStatus.isOK()) {
+        remote.swResponse = std::move(scheduleStatus);
+        // Signal the notification indicating the remote had an error, since no callback for this
+        // remote will run and signal it.
+        if (!*_notification) {
+            _notification->set();
+        }
+    }
+}
+
 void AsyncRequestsSender::stopRetrying() {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     _stopRetrying = true;
@@ -133,6 +244,9 @@ void AsyncRequestsSender::_cancelPendingRequests() {
         if (remote.cbHandle.isValid()) {
             _executor->cancel(remote.cbHandle);
         }
+        if (remote.hedgeCbHandle.isValid()) {
+            _executor->cancel(remote.hedgeCbHandle);
+        }
     }
 }
 
@@ -141,8 +255,10 @@ boost::optional<AsyncRequestsSender::Response> AsyncRequestsSender::_ready() {
 
     _notification.emplace();
 
+    _nextHedgeAt = Date_t::max();
     if (!_stopRetrying) {
         _scheduleRequests(lk);
+        _nextHedgeAt = _scheduleHedgedRequests(lk);
     }
 
     // Check if any remote is ready.
@@ -226,7 +342,7 @@ void AsyncRequestsSender::_scheduleRequests(WithLock lk) {
     }
 }
 
-Status AsyncRequestsSender::_scheduleRequest(WithLock, size_t remoteIndex) {
+Status AsyncRequestsSender::_scheduleRequest(WithLock lk, size_t remoteIndex) {
     auto& remote = _remotes[remoteIndex];
 
     invariant(!remote.cbHandle.isValid());
@@ -249,19 +365,135 @@ Status AsyncRequestsSender::_scheduleRequest(WithLock, size_t remoteIndex) {
     }
 
     remote.cbHandle = callbackStatus.getValue();
+    remote.hedgeAt = _isHedgeable(lk, remote)
+        ? _executor->now() + hostLatencyEstimates.hedgeDelay(*remote.shardHostAndPort)
+        : Date_t::max();
     return Status::OK();
 }
 
+bool AsyncRequestsSender::_isHedgeable(WithLock, const RemoteData& remote) const {
+    if (!enableHedgedReads.load() || _readPreference.pref == ReadPreference::PrimaryOnly) {
+        return false;
+    }
+
+    // Only hedge reads which leave no server-side state behind, since the losing request is
+    // canceled without looking at its response.
+    const auto commandName = remote.cmdObj.firstElementFieldName();
+    if (str::equals(commandName, "count") || str::equals(commandName, "distinct")) {
+        return true;
+    }
+    return str::equals(commandName, "find") && remote.cmdObj["singleBatch"].trueValue();
+}
+
+Date_t AsyncRequestsSender::_scheduleHedgedRequests(WithLock) {
+    const auto now = _executor->now();
+    auto nextHedgeAt = Date_t::max();
+
+    for (size_t i = 0; i < _remotes.size(); ++i) {
+        auto& remote = _remotes[i];
+
+        if (!remote.cbHandle.isValid() || remote.swResponse || remote.hedgeCbHandle.isValid() ||
+            remote.hedgeAt == Date_t::max()) {
+            continue;
+        }
+
+        if (remote.hedgeAt > now) {
+            nextHedgeAt = std::min(nextHedgeAt, remote.hedgeAt);
+            continue;
+        }
+
+        // Whatever happens below, only try to hedge each request once.
+        remote.hedgeAt = Date_t::max();
+
+        auto shard = remote.getShard();
+        if (!shard) {
+            continue;
+        }
+
+        boost::optional<HostAndPort> hedgeHost;
+        for (int attempt = 0; attempt < kMaxHedgeHostSelectionAttempts && !hedgeHost; ++attempt) {
+            auto swHost = shard->getTargeter()->findHostNoWait(_readPreference);
+            if (!swHost.isOK()) {
+                break;
+            }
+            if (swHost.getValue() != *remote.shardHostAndPort) {
+                hedgeHost = std::move(swHost.getValue());
+            }
+        }
+        if (!hedgeHost) {
+            continue;
+        }
+
+        executor::RemoteCommandRequest request(
+            *hedgeHost, _db, remote.cmdObj, _metadataObj, _opCtx);
+
+        auto callbackStatus = _executor->scheduleRemoteCommand(
+            request,
+            stdx::bind(&AsyncRequestsSender::_handleResponse, this, stdx::placeholders::_1, i));
+        if (!callbackStatus.isOK()) {
+            continue;
+        }
+
+        LOG(1) << "Command to remote " << remote.shardId << " at host " << *remote.shardHostAndPort
+               << " is taking long, also sending it to " << *hedgeHost;
+
+        remote.hedgeCbHandle = callbackStatus.getValue();
+        remote.hedgeHostAndPort = std::move(hedgeHost);
+    }
+
+    return nextHedgeAt;
+}
+
 void AsyncRequestsSender::_handleResponse(
     const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData, size_t remoteIndex) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
 
     auto& remote = _remotes[remoteIndex];
+
+    const bool isHedge = remote.hedgeCbHandle.isValid() && cbData.myHandle == remote.hedgeCbHandle;
+    if (!isHedge && !(remote.cbHandle.isValid() && cbData.myHandle == remote.cbHandle)) {
+        // This request lost to its hedged counterpart and was canceled.
+        auto& abandoned = remote.abandonedCbHandles;
+        abandoned.erase(std::remove(abandoned.begin(), abandoned.end(), cbData.myHandle),
+                        abandoned.end());
+        return;
+    }
+
     invariant(!remote.swResponse);
 
     // Clear the callback handle. This indicates that we are no longer waiting on a response from
-    // 'remote'.
-    remote.cbHandle = executor::TaskExecutor::CallbackHandle();
+    // 'remote' on this host.
+    auto& otherCbHandle = isHedge ? remote.cbHandle : remote.hedgeCbHandle;
+    (isHedge ? remote.hedgeCbHandle : remote.cbHandle) = executor::TaskExecutor::CallbackHandle();
+
+    if (otherCbHandle.isValid()) {
+        if (!cbData.response.status.isOK()) {
+            // The other request may still succeed, so keep waiting for it alone.
+            if (!isHedge) {
+                remote.cbHandle = remote.hedgeCbHandle;
+                remote.shardHostAndPort = remote.hedgeHostAndPort;
+            }
+            remote.hedgeCbHandle = executor::TaskExecutor::CallbackHandle();
+            remote.hedgeHostAndPort.reset();
+            return;
+        }
+
+        // First response wins, cancel the other request.
+        _executor->cancel(otherCbHandle);
+        remote.abandonedCbHandles.push_back(otherCbHandle);
+        otherCbHandle = executor::TaskExecutor::CallbackHandle();
+    }
+
+    if (isHedge) {
+        remote.shardHostAndPort = remote.hedgeHostAndPort;
+    }
+    remote.hedgeHostAndPort.reset();
+    remote.hedgeAt = Date_t::max();
+
+    if (enableHedgedReads.load() && cbData.response.status.isOK() &&
+        cbData.response.elapsedMillis) {
+        hostLatencyEstimates.record(cbData.request.target, *cbData.response.elapsedMillis);
+    }
 
     // Store the response or error.
     if (cbData.response.status.isOK()) {
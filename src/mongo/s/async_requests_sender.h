@@ -37,6 +37,7 @@
 #include "mongo/client/read_preference.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/executor/task_executor.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/client/shard.h"
 #include "mongo/s/shard_id.h"
 #include "mongo/stdx/mutex.h"
@@ -47,6 +48,11 @@
 
 namespace mongo {
 
+// Server parameters controlling hedged reads, see AsyncRequestsSender.
+extern AtomicBool enableHedgedReads;
+extern AtomicInt32 hedgedReadsMinDelayMillis;
+extern AtomicInt32 hedgedReadsMaxDelayMillis;
+
 /**
  * The AsyncRequestsSender allows for sending requests to a set of remote shards in parallel.
  * Work on remote nodes is accomplished by scheduling remote work in a TaskExecutor's event loop.
@@ -78,6 +84,13 @@ namespace mongo {
  *     }
  * }
  *
+ * If enableHedgedReads is set and the read preference allows reading from more than the
+ * primary, reads which do not leave a cursor open (count, distinct and single batch finds) are
+ * hedged: if a remote has not responded after a delay derived from the recent latency of the
+ * host it was sent to, the same command is sent to a second eligible member of the shard. The
+ * first successful response is used and the other request is canceled. Hedged requests are
+ * sent from within next(), on the thread which owns the OperationContext.
+ *
  * Does not throw exceptions.
  */
 class AsyncRequestsSender {
@@ -152,6 +165,17 @@ public:
      */
     Response next();
 
+    /**
+     * Schedules one more request. Its response is returned by next() like those of the requests
+     * the ARS was constructed with, so done() is false again until it has been returned.
+     *
+     * If the ARS has stopped retrying, because of stopRetrying() or an interrupt, the request is
+     * not sent and next() returns an error for it instead.
+     *
+     * Note: Must only be called from the thread calling next().
+     */
+    void addRequest(const Request& request);
+
     /**
      * Stops the ARS from retrying requests.
      *
@@ -200,6 +224,19 @@ private:
         // The callback handle to an outstanding request for this remote.
         executor::TaskExecutor::CallbackHandle cbHandle;
 
+        // When to send a hedged request if the outstanding request has not completed by then.
+        // Date_t::max() if the request should not be hedged or has already been hedged.
+        Date_t hedgeAt = Date_t::max();
+
+        // The host to which the hedged request was sent and its callback handle, if one is
+        // outstanding.
+        boost::optional<HostAndPort> hedgeHostAndPort;
+        executor::TaskExecutor::CallbackHandle hedgeCbHandle;
+
+        // Requests which lost to their hedged counterpart and were canceled, but whose callbacks
+        // have not run yet.
+        std::vector<executor::TaskExecutor::CallbackHandle> abandonedCbHandles;
+
         // Whether this remote's result has been returned.
         bool done = false;
     };
@@ -240,13 +277,27 @@ private:
      */
     Status _scheduleRequest(WithLock, size_t remoteIndex);
 
+    /**
+     * Sends a hedged request for each remote whose outstanding request has been pending past its
+     * hedgeAt time, to a different host of the same shard if one matches the read preference.
+     *
+     * Returns the earliest time at which another hedged request will be due, or Date_t::max().
+     */
+    Date_t _scheduleHedgedRequests(WithLock);
+
+    /**
+     * Returns true if the command to 'remote' may be hedged.
+     */
+    bool _isHedgeable(WithLock, const RemoteData& remote) const;
+
     /**
      * The callback for a remote command.
      *
      * 'remoteIndex' is the position of the relevant remote node in '_remotes', and therefore
      * indicates which node the response came from and where the response should be buffered.
      *
-     * Stores the response or error in the remote and signals the notification.
+     * Stores the response or error in the remote and signals the notification. If the request
+     * was hedged, the first successful response wins and the other request is canceled.
      */
     void _handleResponse(const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData,
                          size_t remoteIndex);
@@ -289,6 +340,9 @@ private:
     // Used to determine if the ARS should attempt to retry any requests. Is set to true when
     // stopRetrying() or cancelPendingRequests() is called.
     bool _stopRetrying = false;
+
+    // The earliest time a hedged request is due, as of the last call to _ready().
+    Date_t _nextHedgeAt = Date_t::max();
 };
 
 }  // namespace mongo
@@ -49,14 +49,6 @@ namespace {
 // Used to generate sequence numbers to assign to each newly created ChunkManager
 AtomicUInt32 nextCMSequenceNumber(0);
 
-void checkAllElementsAreOfType(BSONType type, const BSONObj& o) {
-    for (const auto&& element : o) {
-        uassert(ErrorCodes::ConflictingOperationInProgress,
-                str::stream() << "Not all elements of " << o << " are of type " << typeName(type),
-                element.type() == type);
-    }
-}
-
 }  // namespace
 
 ChunkManager::ChunkManager(NamespaceString nss,
@@ -71,7 +63,7 @@ ChunkManager::ChunkManager(NamespaceString nss,
       _defaultCollator(std::move(defaultCollator)),
       _unique(unique),
       _chunkMap(std::move(chunkMap)),
-      _chunkMapViews(_constructChunkMapViews(collectionVersion.epoch(), _chunkMap)),
+      _shardVersions(_chunkMap.getShardVersions(collectionVersion.epoch())),
       _collectionVersion(collectionVersion) {}
 
 std::shared_ptr<Chunk> ChunkManager::findIntersectingChunk(const BSONObj& shardKey,
@@ -87,12 +79,12 @@ std::shared_ptr<Chunk> ChunkManager::findIntersectingChunk(const BSONObj& shardK
         }
     }
 
-    const auto it = _chunkMap.upper_bound(shardKey);
+    const auto it = _chunkMap.upperBound(shardKey);
     uassert(ErrorCodes::ShardKeyNotFound,
             str::stream() << "Cannot target single shard using key " << shardKey,
-            it != _chunkMap.end() && it->second->containsKey(shardKey));
+            it != _chunkMap.end() && (*it)->containsKey(shardKey));
 
-    return it->second;
+    return *it;
 }
 
 std::shared_ptr<Chunk> ChunkManager::findIntersectingChunkWithSimpleCollation(
@@ -100,6 +92,11 @@ std::shared_ptr<Chunk> ChunkManager::findIntersectingChunkWithSimpleCollation(
     return findIntersectingChunk(shardKey, CollationSpec::kSimpleSpec);
 }
 
+std::vector<std::shared_ptr<Chunk>> ChunkManager::findIntersectingChunksWithSimpleCollation(
+    const std::vector<BSONObj>& shardKeys) const {
+    return _chunkMap.findChunks(shardKeys);
+}
+
 void ChunkManager::getShardIdsForQuery(OperationContext* opCtx,
                                        const BSONObj& query,
                                        const BSONObj& collation,
@@ -160,7 +157,7 @@ void ChunkManager::getShardIdsForQuery(OperationContext* opCtx,
         getShardIdsForRange(it->first /*min*/, it->second /*max*/, shardIds);
 
         // once we know we need to visit all shards no need to keep looping
-        if (shardIds->size() == _chunkMapViews.shardVersions.size()) {
+        if (shardIds->size() == _shardVersions.size()) {
             break;
         }
     }
@@ -169,38 +166,19 @@ void ChunkManager::getShardIdsForQuery(OperationContext* opCtx,
     // For now, we satisfy that assumption by adding a shard with no matches rather than returning
     // an empty set of shards.
     if (shardIds->empty()) {
-        shardIds->insert(_chunkMapViews.chunkRangeMap.begin()->second.shardId);
+        shardIds->insert((*_chunkMap.begin())->getShardId());
     }
 }
 
 void ChunkManager::getShardIdsForRange(const BSONObj& min,
                                        const BSONObj& max,
                                        std::set<ShardId>* shardIds) const {
-    auto it = _chunkMapViews.chunkRangeMap.upper_bound(min);
-    auto end = _chunkMapViews.chunkRangeMap.upper_bound(max);
-
-    // The chunk range map must always cover the entire key space
-    invariant(it != _chunkMapViews.chunkRangeMap.end());
-
-    // We need to include the last chunk
-    if (end != _chunkMapViews.chunkRangeMap.cend()) {
-        ++end;
-    }
-
-    for (; it != end; ++it) {
-        shardIds->insert(it->second.shardId);
-
-        // No need to iterate through the rest of the ranges, because we already know we need to use
-        // all shards.
-        if (shardIds->size() == _chunkMapViews.shardVersions.size()) {
-            break;
-        }
-    }
+    _chunkMap.getShardIdsForRange(min, max, _shardVersions.size(), shardIds);
 }
 
 void ChunkManager::getAllShardIds(std::set<ShardId>* all) const {
-    std::transform(_chunkMapViews.shardVersions.begin(),
-                   _chunkMapViews.shardVersions.end(),
+    std::transform(_shardVersions.begin(),
+                   _shardVersions.end(),
                    std::inserter(*all, all->begin()),
                    [](const ShardVersionMap::value_type& pair) { return pair.first; });
 }
@@ -324,8 +302,8 @@ bool ChunkManager::compatibleWith(const ChunkManager& other, const ShardId& shar
 }
 
 ChunkVersion ChunkManager::getVersion(const ShardId& shardName) const {
-    auto it = _chunkMapViews.shardVersions.find(shardName);
-    if (it == _chunkMapViews.shardVersions.end()) {
+    auto it = _shardVersions.find(shardName);
+    if (it == _shardVersions.end()) {
         // Shards without explicitly tracked shard versions (meaning they have no chunks) always
         // have a version of (0, 0, epoch)
         return ChunkVersion(0, 0, _collectionVersion.epoch());
@@ -338,95 +316,13 @@ std::string ChunkManager::toString() const {
     StringBuilder sb;
     sb << "ChunkManager: " << _nss.ns() << " key:" << _shardKeyPattern.toString() << '\n';
 
-    for (const auto& entry : _chunkMap) {
-        sb << "\t" << entry.second->toString() << '\n';
+    for (const auto& chunk : _chunkMap) {
+        sb << "\t" << chunk->toString() << '\n';
     }
 
     return sb.str();
 }
 
-ChunkManager::ChunkMapViews ChunkManager::_constructChunkMapViews(const OID& epoch,
-                                                                  const ChunkMap& chunkMap) {
-
-    ChunkRangeMap chunkRangeMap =
-        SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ShardAndChunkRange>();
-
-    ShardVersionMap shardVersions;
-
-    ChunkMap::const_iterator current = chunkMap.cbegin();
-
-    while (current != chunkMap.cend()) {
-        const auto& firstChunkInRange = current->second;
-
-        // Tracks the max shard version for the shard on which the current range will reside
-        auto shardVersionIt = shardVersions.find(firstChunkInRange->getShardId());
-        if (shardVersionIt == shardVersions.end()) {
-            shardVersionIt =
-                shardVersions.emplace(firstChunkInRange->getShardId(), ChunkVersion(0, 0, epoch))
-                    .first;
-        }
-
-        auto& maxShardVersion = shardVersionIt->second;
-
-        current = std::find_if(
-            current,
-            chunkMap.cend(),
-            [&firstChunkInRange, &maxShardVersion](const ChunkMap::value_type& chunkMapEntry) {
-                const auto& currentChunk = chunkMapEntry.second;
-
-                if (currentChunk->getShardId() != firstChunkInRange->getShardId())
-                    return true;
-
-                if (currentChunk->getLastmod() > maxShardVersion)
-                    maxShardVersion = currentChunk->getLastmod();
-
-                return false;
-            });
-
-        const auto rangeLast = std::prev(current);
-
-        const BSONObj rangeMin = firstChunkInRange->getMin();
-        const BSONObj rangeMax = rangeLast->second->getMax();
-
-        const auto oldSize = chunkRangeMap.size();
-        const auto insertIterator = chunkRangeMap.insert(
-            chunkRangeMap.end(),
-            std::make_pair(
-                rangeMax,
-                ShardAndChunkRange{{rangeMin, rangeMax}, firstChunkInRange->getShardId()}));
-        uassert(ErrorCodes::ConflictingOperationInProgress,
-                str::stream() << "Metadata contains two chunks with the same max value "
-                              << rangeMax,
-                oldSize + 1 == chunkRangeMap.size());
-
-
-        if (insertIterator != chunkRangeMap.begin()) {
-            // Make sure there are no gaps in the ranges
-            uassert(ErrorCodes::ConflictingOperationInProgress,
-                    str::stream() << "Gap or an overlap between ranges "
-                                  << insertIterator->second.range.toString()
-                                  << " and "
-                                  << std::prev(insertIterator)->second.range.toString(),
-                    SimpleBSONObjComparator::kInstance.evaluate(std::prev(insertIterator)->first ==
-                                                                rangeMin));
-        }
-
-        // If a shard has chunks it must have a shard version, otherwise we have an invalid chunk
-        // somewhere, which should have been caught at chunk load time
-        invariant(maxShardVersion.isSet());
-    }
-
-    if (!chunkMap.empty()) {
-        invariant(!chunkRangeMap.empty());
-        invariant(!shardVersions.empty());
-
-        checkAllElementsAreOfType(MinKey, chunkRangeMap.begin()->second.min());
-        checkAllElementsAreOfType(MaxKey, chunkRangeMap.rbegin()->first);
-    }
-
-    return {std::move(chunkRangeMap), std::move(shardVersions)};
-}
-
 std::shared_ptr<ChunkManager> ChunkManager::makeNew(
     NamespaceString nss,
     KeyPattern shardKeyPattern,
@@ -440,7 +336,7 @@ std::shared_ptr<ChunkManager> ChunkManager::makeNew(
                std::move(shardKeyPattern),
                std::move(defaultCollator),
                std::move(unique),
-               SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<std::shared_ptr<Chunk>>(),
+               ChunkMap(),
                {0, 0, epoch})
         .makeUpdated(chunks);
 }
@@ -448,7 +344,9 @@ std::shared_ptr<ChunkManager> ChunkManager::makeNew(
 std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
     const std::vector<ChunkType>& changedChunks) {
     const auto startingCollectionVersion = getVersion();
-    auto chunkMap = _chunkMap;
+
+    std::vector<ChunkMap::ChunkPtr> updatedChunks;
+    updatedChunks.reserve(changedChunks.size());
 
     ChunkVersion collectionVersion = startingCollectionVersion;
     for (const auto& chunk : changedChunks) {
@@ -464,19 +362,7 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
         invariant(chunkVersion >= collectionVersion);
         collectionVersion = chunkVersion;
 
-        // Returns the first chunk with a max key that is > min - implies that the chunk overlaps
-        // min
-        const auto low = chunkMap.upper_bound(chunk.getMin());
-
-        // Returns the first chunk with a max key that is > max - implies that the next chunk cannot
-        // not overlap max
-        const auto high = chunkMap.upper_bound(chunk.getMax());
-
-        // Erase all chunks from the map, which overlap the chunk we got from the persistent store
-        chunkMap.erase(low, high);
-
-        // Insert only the chunk itself
-        chunkMap.insert(std::make_pair(chunk.getMax(), std::make_shared<Chunk>(chunk)));
+        updatedChunks.push_back(std::make_shared<Chunk>(chunk));
     }
 
     // If at least one diff was applied, the metadata is correct, but it might not have changed so
@@ -490,6 +376,11 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
         return shared_from_this();
     }
 
+    // The copy shares all of the chunks of this routing table, and only the parts of it which the
+    // changed chunks fall into are rebuilt.
+    auto chunkMap = _chunkMap;
+    chunkMap.applyChanges(updatedChunks);
+
     return std::shared_ptr<ChunkManager>(
         new ChunkManager(_nss,
                          KeyPattern(getShardKeyPattern().getKeyPattern()),
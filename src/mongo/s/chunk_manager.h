@@ -31,11 +31,13 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/s/chunk.h"
+#include "mongo/s/chunk_map.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/client/shard.h"
 #include "mongo/s/shard_key_pattern.h"
@@ -47,12 +49,6 @@ class CanonicalQuery;
 struct QuerySolutionNode;
 class OperationContext;
 
-// Ordered map from the max for each chunk to an entry describing the chunk
-using ChunkMap = BSONObjIndexedMap<std::shared_ptr<Chunk>>;
-
-// Map from a shard is to the max chunk version on that shard
-using ShardVersionMap = std::map<ShardId, ChunkVersion>;
-
 /**
  * In-memory representation of the routing table for a single sharded collection.
  */
@@ -78,8 +74,8 @@ public:
         bool operator!=(const ConstChunkIterator& other) const {
             return !(*this == other);
         }
-        const ChunkMap::mapped_type& operator*() const {
-            return _iter->second;
+        const ChunkMap::ChunkPtr& operator*() const {
+            return *_iter;
         }
 
     private:
@@ -160,7 +156,7 @@ public:
     ChunkVersion getVersion(const ShardId& shardId) const;
 
     ConstRangeOfChunks chunks() const {
-        return {ConstChunkIterator{_chunkMap.cbegin()}, ConstChunkIterator{_chunkMap.cend()}};
+        return {ConstChunkIterator{_chunkMap.begin()}, ConstChunkIterator{_chunkMap.end()}};
     }
 
     int numChunks() const {
@@ -187,6 +183,14 @@ public:
      */
     std::shared_ptr<Chunk> findIntersectingChunkWithSimpleCollation(const BSONObj& shardKey) const;
 
+    /**
+     * Same as findIntersectingChunkWithSimpleCollation for each of 'shardKeys', but looks them all
+     * up in one pass over the chunks. Keys which cannot be targeted get a nullptr chunk instead of
+     * an exception, so that a batch can report them one by one.
+     */
+    std::vector<std::shared_ptr<Chunk>> findIntersectingChunksWithSimpleCollation(
+        const std::vector<BSONObj>& shardKeys) const;
+
     /**
      * Finds the shard IDs for a given filter and collation. If collation is empty, we use the
      * collection default collation for targeting.
@@ -236,44 +240,6 @@ public:
     std::string toString() const;
 
 private:
-    /**
-     * Represents a range of chunk keys [getMin(), getMax()) and the id of the shard on which they
-     * reside according to the metadata.
-     */
-    struct ShardAndChunkRange {
-        const BSONObj& min() const {
-            return range.getMin();
-        }
-
-        const BSONObj& max() const {
-            return range.getMax();
-        }
-
-        ChunkRange range;
-        ShardId shardId;
-    };
-
-    using ChunkRangeMap = BSONObjIndexedMap<ShardAndChunkRange>;
-
-    /**
-     * Contains different transformations of the chunk map for efficient querying
-     */
-    struct ChunkMapViews {
-        // Transformation of the chunk map containing what range of keys reside on which shard. The
-        // index is the max key of the respective range and the union of all ranges in a such
-        // constructed map must cover the complete space from [MinKey, MaxKey).
-        const ChunkRangeMap chunkRangeMap;
-
-        // Map from shard id to the maximum chunk version for that shard. If a shard contains no
-        // chunks, it won't be present in this map.
-        const ShardVersionMap shardVersions;
-    };
-
-    /**
-     * Does a single pass over the chunkMap and constructs the ChunkMapViews object.
-     */
-    static ChunkMapViews _constructChunkMapViews(const OID& epoch, const ChunkMap& chunkMap);
-
     ChunkManager(NamespaceString nss,
                  KeyPattern shardKeyPattern,
                  std::unique_ptr<CollatorInterface> defaultCollator,
@@ -298,11 +264,13 @@ private:
     const bool _unique;
 
     // Map from the max for each chunk to an entry describing the chunk. The union of all chunks'
-    // ranges must cover the complete space from [MinKey, MaxKey).
+    // ranges must cover the complete space from [MinKey, MaxKey). Shares its unchanged chunks with
+    // the chunk manager it was updated from.
     const ChunkMap _chunkMap;
 
-    // Different transformations of the chunk map for efficient querying
-    const ChunkMapViews _chunkMapViews;
+    // Map from shard id to the maximum chunk version for that shard. If a shard contains no
+    // chunks, it won't be present in this map.
+    const ShardVersionMap _shardVersions;
 
     // Max version across all chunks
     const ChunkVersion _collectionVersion;
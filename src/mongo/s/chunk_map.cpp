@@ -0,0 +1,399 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/chunk_map.h"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+#include "mongo/bson/ordering.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+// A segment left with fewer chunks than this, as chunks are merged, absorbs one of its neighbors.
+const size_t kMinSegmentSize = ChunkMap::kMaxSegmentSize / 4;
+
+// Shard key bounds are encoded with every field ascending, so that the encodings sort the same way
+// as the simple BSON comparator sorts the bounds.
+const Ordering kAllAscending = Ordering::make(BSONObj());
+
+bool lessThan(const BSONObj& lhs, const BSONObj& rhs) {
+    return SimpleBSONObjComparator::kInstance.evaluate(lhs < rhs);
+}
+
+void checkAllElementsAreOfType(BSONType type, const BSONObj& o) {
+    for (const auto&& element : o) {
+        uassert(ErrorCodes::ConflictingOperationInProgress,
+                str::stream() << "Not all elements of " << o << " are of type " << typeName(type),
+                element.type() == type);
+    }
+}
+
+}  // namespace
+
+const size_t ChunkMap::kMaxSegmentSize;
+
+void ChunkMap::Segment::summarize() {
+    shardVersions.clear();
+    maxKeys.clear();
+    maxKeyEnds.clear();
+    maxKeyEnds.reserve(chunks.size());
+
+    KeyString encoded(KeyString::kLatestVersion);
+    for (const auto& chunk : chunks) {
+        encoded.resetToKey(chunk->getMax(), kAllAscending);
+        maxKeys.append(encoded.getBuffer(), encoded.getSize());
+        maxKeyEnds.push_back(maxKeys.size());
+
+        auto it = std::find_if(shardVersions.begin(),
+                               shardVersions.end(),
+                               [&chunk](const std::pair<ShardId, ChunkVersion>& entry) {
+                                   return entry.first == chunk->getShardId();
+                               });
+        if (it == shardVersions.end()) {
+            shardVersions.emplace_back(chunk->getShardId(), chunk->getLastmod());
+        } else if (chunk->getLastmod() > it->second) {
+            it->second = chunk->getLastmod();
+        }
+    }
+}
+
+ChunkMap::const_iterator ChunkMap::upperBound(const BSONObj& key) const {
+    if (_segments.empty()) {
+        return end();
+    }
+
+    const Position pos = _upperBound(key);
+    if (pos.chunk == _segments[pos.segment]->chunks.size()) {
+        return end();
+    }
+    return {&_segments, pos.segment, pos.chunk};
+}
+
+std::vector<ChunkMap::ChunkPtr> ChunkMap::findChunks(const std::vector<BSONObj>& keys) const {
+    std::vector<ChunkPtr> chunks(keys.size());
+    if (keys.empty() || _segments.empty()) {
+        return chunks;
+    }
+
+    std::string encodedKeys;
+    std::vector<uint32_t> encodedKeyEnds;
+    encodedKeyEnds.reserve(keys.size());
+
+    KeyString encoded(KeyString::kLatestVersion);
+    for (const auto& key : keys) {
+        encoded.resetToKey(key, kAllAscending);
+        encodedKeys.append(encoded.getBuffer(), encoded.getSize());
+        encodedKeyEnds.push_back(encodedKeys.size());
+    }
+
+    const auto encodedKey = [&](size_t i) {
+        const size_t begin = i == 0 ? 0 : encodedKeyEnds[i - 1];
+        return StringData(encodedKeys.data() + begin, encodedKeyEnds[i] - begin);
+    };
+
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        return encodedKey(lhs).compare(encodedKey(rhs)) < 0;
+    });
+
+    // Whether 'pos' is the first chunk ending past 'key', given that the keys are visited in order
+    // and so 'key' is not below the max of the chunk before 'pos'.
+    const auto endsPast = [this](Position pos, StringData key) {
+        const Segment& segment = *_segments[pos.segment];
+        return pos.chunk < segment.chunks.size() && key.compare(segment.maxKey(pos.chunk)) < 0;
+    };
+
+    Position pos = _upperBound(encodedKey(order.front()));
+    for (const size_t i : order) {
+        const StringData key = encodedKey(i);
+        if (!endsPast(pos, key)) {
+            Position next = pos;
+            if (++next.chunk == _segments[next.segment]->chunks.size() &&
+                next.segment + 1 < _segments.size()) {
+                ++next.segment;
+                next.chunk = 0;
+            }
+            pos = endsPast(next, key) ? next : _upperBound(key);
+        }
+
+        if (pos.chunk < _segments[pos.segment]->chunks.size()) {
+            chunks[i] = _at(pos);
+        }
+    }
+
+    return chunks;
+}
+
+ChunkMap::Position ChunkMap::_upperBound(const BSONObj& key) const {
+    const KeyString encoded(KeyString::kLatestVersion, key, kAllAscending);
+    return _upperBound(StringData(encoded.getBuffer(), encoded.getSize()));
+}
+
+ChunkMap::Position ChunkMap::_upperBound(StringData encodedKey) const {
+    invariant(!_segments.empty());
+
+    // The first segment whose last chunk ends past 'key' holds the chunk we are looking for.
+    const auto segmentIt =
+        std::upper_bound(_segments.begin(),
+                         _segments.end(),
+                         encodedKey,
+                         [](StringData key, const std::shared_ptr<const Segment>& segment) {
+                             return key.compare(segment->maxKey(segment->chunks.size() - 1)) < 0;
+                         });
+    if (segmentIt == _segments.end()) {
+        return {_segments.size() - 1, _segments.back()->chunks.size()};
+    }
+
+    const Segment& segment = **segmentIt;
+    size_t low = 0;
+    size_t high = segment.chunks.size();
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (encodedKey.compare(segment.maxKey(mid)) < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return {static_cast<size_t>(segmentIt - _segments.begin()), low};
+}
+
+void ChunkMap::applyChanges(const std::vector<ChunkPtr>& changedChunks) {
+    if (changedChunks.empty()) {
+        return;
+    }
+
+    if (empty()) {
+        // Loading a whole routing table. Unless some of the chunks overlap, in which case the later
+        // versions have to replace the earlier ones, the chunks can be laid out in key order.
+        std::vector<ChunkPtr> sorted(changedChunks);
+        std::sort(sorted.begin(), sorted.end(), [](const ChunkPtr& lhs, const ChunkPtr& rhs) {
+            return lessThan(lhs->getMax(), rhs->getMax());
+        });
+
+        const bool disjoint = std::adjacent_find(sorted.begin(),
+                                                 sorted.end(),
+                                                 [](const ChunkPtr& prev, const ChunkPtr& next) {
+                                                     return lessThan(next->getMin(),
+                                                                     prev->getMax());
+                                                 }) == sorted.end();
+        if (disjoint) {
+            _segments.clear();
+            _size = 0;
+            _replaceSegments(0, 0, std::move(sorted));
+
+            for (size_t segment = 0; segment < _segments.size(); ++segment) {
+                for (size_t chunk = 0; chunk < _segments[segment]->chunks.size(); ++chunk) {
+                    _checkNeighbors({segment, chunk});
+                }
+            }
+            return;
+        }
+    }
+
+    for (const auto& chunk : changedChunks) {
+        if (_segments.empty()) {
+            _replaceSegments(0, 0, {chunk});
+            continue;
+        }
+
+        // Replace every chunk which overlaps the changed one.
+        const Position begin = _upperBound(chunk->getMin());
+        Position end = _upperBound(chunk->getMax());
+        if (end.segment < begin.segment ||
+            (end.segment == begin.segment && end.chunk < begin.chunk)) {
+            end = begin;
+        }
+        _replace(begin, end, chunk);
+    }
+
+    // A chunk is only ever removed by a changed chunk that takes its place, so any gap or overlap
+    // the changes left behind borders one of the changed chunks still in the map.
+    for (const auto& chunk : changedChunks) {
+        Position pos = _upperBound(chunk->getMax());
+        if (pos.chunk > 0) {
+            --pos.chunk;
+        } else if (pos.segment > 0) {
+            --pos.segment;
+            pos.chunk = _segments[pos.segment]->chunks.size() - 1;
+        } else {
+            continue;
+        }
+
+        if (_at(pos) == chunk) {
+            _checkNeighbors(pos);
+        }
+    }
+}
+
+void ChunkMap::_replace(Position begin, Position end, ChunkPtr chunk) {
+    const auto& first = _segments[begin.segment]->chunks;
+    const auto& last = _segments[end.segment]->chunks;
+
+    std::vector<ChunkPtr> chunks;
+    chunks.reserve(begin.chunk + 1 + (last.size() - end.chunk));
+    chunks.insert(chunks.end(), first.begin(), first.begin() + begin.chunk);
+    chunks.push_back(std::move(chunk));
+    chunks.insert(chunks.end(), last.begin() + end.chunk, last.end());
+
+    _replaceSegments(begin.segment, end.segment, std::move(chunks));
+}
+
+void ChunkMap::_replaceSegments(size_t first, size_t last, std::vector<ChunkPtr> chunks) {
+    // An empty map has no segment to replace.
+    const size_t numReplaced = _segments.empty() ? 0 : last - first + 1;
+
+    if (chunks.size() < kMinSegmentSize && numReplaced && _segments.size() > numReplaced) {
+        if (last + 1 < _segments.size()) {
+            ++last;
+            const auto& next = _segments[last]->chunks;
+            chunks.insert(chunks.end(), next.begin(), next.end());
+        } else {
+            --first;
+            const auto& prev = _segments[first]->chunks;
+            chunks.insert(chunks.begin(), prev.begin(), prev.end());
+        }
+    }
+
+    size_t numRemoved = 0;
+    for (size_t i = first; numReplaced && i <= last; ++i) {
+        numRemoved += _segments[i]->chunks.size();
+    }
+    _size = _size - numRemoved + chunks.size();
+
+    // Split the chunks evenly into as few segments as will hold them.
+    const size_t numSegments = (chunks.size() + kMaxSegmentSize - 1) / kMaxSegmentSize;
+    Segments replacement;
+    replacement.reserve(numSegments);
+    for (size_t i = 0; i < numSegments; ++i) {
+        auto segment = std::make_shared<Segment>();
+        segment->chunks.assign(
+            std::make_move_iterator(chunks.begin() + chunks.size() * i / numSegments),
+            std::make_move_iterator(chunks.begin() + chunks.size() * (i + 1) / numSegments));
+        segment->summarize();
+        replacement.push_back(std::move(segment));
+    }
+
+    if (numReplaced) {
+        _segments.erase(_segments.begin() + first, _segments.begin() + last + 1);
+    }
+    _segments.insert(_segments.begin() + first, replacement.begin(), replacement.end());
+}
+
+void ChunkMap::_checkNeighbors(Position pos) const {
+    const auto& chunk = _at(pos);
+    const auto& chunks = _segments[pos.segment]->chunks;
+
+    if (pos.chunk > 0 || pos.segment > 0) {
+        const auto& prev = pos.chunk > 0 ? chunks[pos.chunk - 1]
+                                         : _segments[pos.segment - 1]->chunks.back();
+        uassert(ErrorCodes::ConflictingOperationInProgress,
+                str::stream() << "Gap or an overlap between ranges " << prev->toString() << " and "
+                              << chunk->toString(),
+                SimpleBSONObjComparator::kInstance.evaluate(prev->getMax() == chunk->getMin()));
+    } else {
+        checkAllElementsAreOfType(MinKey, chunk->getMin());
+    }
+
+    if (pos.chunk + 1 < chunks.size() || pos.segment + 1 < _segments.size()) {
+        const auto& next = pos.chunk + 1 < chunks.size()
+            ? chunks[pos.chunk + 1]
+            : _segments[pos.segment + 1]->chunks.front();
+        uassert(ErrorCodes::ConflictingOperationInProgress,
+                str::stream() << "Gap or an overlap between ranges " << chunk->toString() << " and "
+                              << next->toString(),
+                SimpleBSONObjComparator::kInstance.evaluate(chunk->getMax() == next->getMin()));
+    } else {
+        checkAllElementsAreOfType(MaxKey, chunk->getMax());
+    }
+}
+
+ShardVersionMap ChunkMap::getShardVersions(const OID& epoch) const {
+    ShardVersionMap shardVersions;
+    for (const auto& segment : _segments) {
+        for (const auto& entry : segment->shardVersions) {
+            auto it = shardVersions.emplace(entry.first, ChunkVersion(0, 0, epoch)).first;
+            if (entry.second > it->second) {
+                it->second = entry.second;
+            }
+        }
+    }
+    return shardVersions;
+}
+
+void ChunkMap::getShardIdsForRange(const BSONObj& min,
+                                   const BSONObj& max,
+                                   size_t numShards,
+                                   std::set<ShardId>* shardIds) const {
+    // The map must always cover the entire key space.
+    invariant(!_segments.empty());
+
+    Position pos = _upperBound(min);
+    invariant(pos.chunk < _segments[pos.segment]->chunks.size());
+
+    // The chunk containing 'max' is included, which is the last chunk if 'max' is MaxKey.
+    Position last = _upperBound(max);
+    if (last.chunk == _segments[last.segment]->chunks.size()) {
+        --last.chunk;
+    }
+
+    while (true) {
+        const auto& segment = *_segments[pos.segment];
+        if (pos.chunk == 0 && pos.segment < last.segment) {
+            // The whole segment is in the range.
+            for (const auto& entry : segment.shardVersions) {
+                shardIds->insert(entry.first);
+            }
+        } else {
+            const size_t end =
+                pos.segment == last.segment ? last.chunk + 1 : segment.chunks.size();
+            for (; pos.chunk < end && shardIds->size() < numShards; ++pos.chunk) {
+                shardIds->insert(segment.chunks[pos.chunk]->getShardId());
+            }
+        }
+
+        // No need to look at the rest of the range once we know we need to use all shards.
+        if (pos.segment == last.segment || shardIds->size() >= numShards) {
+            return;
+        }
+        ++pos.segment;
+        pos.chunk = 0;
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,226 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/s/chunk.h"
+#include "mongo/s/chunk_version.h"
+#include "mongo/s/shard_id.h"
+
+namespace mongo {
+
+// Map from a shard is to the max chunk version on that shard
+using ShardVersionMap = std::map<ShardId, ChunkVersion>;
+
+/**
+ * Ordered map from the max of each chunk of a sharded collection to the chunk.
+ *
+ * The chunks are held in segments of up to kMaxSegmentSize chunks, which are never modified once
+ * built. Copying a map copies only the pointers to its segments, and changing a chunk in a copy
+ * rebuilds just the segment it falls into, so successive versions of a routing table share all of
+ * their unchanged chunks. Each segment also records the shards owning its chunks with the highest
+ * chunk version on each, which lets shard versions and range targeting skip over whole segments.
+ *
+ * Lookups do not compare BSON. Each segment packs the KeyString encodings of its chunks' max keys
+ * into one contiguous buffer, and a key is encoded once and then binary searched with memcmp,
+ * first against the last max of every segment and then within the segment it falls into.
+ */
+class ChunkMap {
+public:
+    using ChunkPtr = std::shared_ptr<Chunk>;
+
+    static const size_t kMaxSegmentSize = 256;
+
+private:
+    struct Segment {
+        /**
+         * Fills in 'shardVersions' and the encoded max keys from 'chunks'.
+         */
+        void summarize();
+
+        /**
+         * Returns the KeyString encoding of the max of chunks[i].
+         */
+        StringData maxKey(size_t i) const {
+            const size_t begin = i == 0 ? 0 : maxKeyEnds[i - 1];
+            return StringData(maxKeys.data() + begin, maxKeyEnds[i] - begin);
+        }
+
+        // Ordered by max key, without gaps or overlaps between consecutive chunks.
+        std::vector<ChunkPtr> chunks;
+
+        // The highest chunk version of each shard which owns any of 'chunks'.
+        std::vector<std::pair<ShardId, ChunkVersion>> shardVersions;
+
+        // The KeyString encodings of the max of each of 'chunks', back to back, and the offset
+        // just past the end of each of them.
+        std::string maxKeys;
+        std::vector<uint32_t> maxKeyEnds;
+    };
+
+    using Segments = std::vector<std::shared_ptr<const Segment>>;
+
+    struct Position {
+        size_t segment;
+        size_t chunk;
+    };
+
+public:
+    class const_iterator {
+    public:
+        const_iterator() = default;
+
+        const ChunkPtr& operator*() const {
+            return (*_segments)[_segment]->chunks[_chunk];
+        }
+        const ChunkPtr* operator->() const {
+            return &**this;
+        }
+
+        const_iterator& operator++() {
+            if (++_chunk == (*_segments)[_segment]->chunks.size()) {
+                ++_segment;
+                _chunk = 0;
+            }
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return _segment == other._segment && _chunk == other._chunk;
+        }
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        friend class ChunkMap;
+
+        const_iterator(const Segments* segments, size_t segment, size_t chunk)
+            : _segments(segments), _segment(segment), _chunk(chunk) {}
+
+        const Segments* _segments = nullptr;
+        size_t _segment = 0;
+        size_t _chunk = 0;
+    };
+
+    const_iterator begin() const {
+        return {&_segments, 0, 0};
+    }
+    const_iterator end() const {
+        return {&_segments, _segments.size(), 0};
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return 0 == _size;
+    }
+
+    /**
+     * Returns the first chunk whose max is greater than 'key', which is the chunk containing 'key'
+     * if the map covers it, or end().
+     */
+    const_iterator upperBound(const BSONObj& key) const;
+
+    /**
+     * Returns, for each of 'keys', the chunk containing it, or nullptr if the map does not cover
+     * it. The keys are encoded and sorted once and then matched to chunks in a single sweep, so a
+     * key which lands in the same chunk as the previous key, or in the next one, costs one memcmp
+     * rather than a binary search.
+     */
+    std::vector<ChunkPtr> findChunks(const std::vector<BSONObj>& keys) const;
+
+    /**
+     * Applies 'changedChunks' in order. Each changed chunk replaces every chunk whose max lies in
+     * (min, max] of the changed chunk. An empty map is built from chunks that do not overlap in
+     * one pass.
+     *
+     * Throws ConflictingOperationInProgress if the map then has a gap or an overlap next to any of
+     * the changed chunks, or does not span [MinKey, MaxKey).
+     */
+    void applyChanges(const std::vector<ChunkPtr>& changedChunks);
+
+    /**
+     * Returns the highest chunk version of every shard owning a chunk, with all versions having
+     * 'epoch'.
+     */
+    ShardVersionMap getShardVersions(const OID& epoch) const;
+
+    /**
+     * Adds to 'shardIds' the shards owning the chunks which overlap [min, max], stopping once
+     * 'shardIds' holds 'numShards' shards.
+     */
+    void getShardIdsForRange(const BSONObj& min,
+                             const BSONObj& max,
+                             size_t numShards,
+                             std::set<ShardId>* shardIds) const;
+
+private:
+    Position _upperBound(const BSONObj& key) const;
+    Position _upperBound(StringData encodedKey) const;
+
+    /**
+     * Replaces every chunk in [begin, end) with 'chunk', where both positions have been clamped to
+     * existing segments.
+     */
+    void _replace(Position begin, Position end, ChunkPtr chunk);
+
+    /**
+     * Replaces the segments [first, last] with segments holding 'chunks'.
+     */
+    void _replaceSegments(size_t first, size_t last, std::vector<ChunkPtr> chunks);
+
+    /**
+     * Checks that the chunk at 'pos' starts where its predecessor ends, or at MinKey if it is the
+     * first chunk, and ends where its successor starts, or at MaxKey if it is the last chunk.
+     */
+    void _checkNeighbors(Position pos) const;
+
+    const ChunkPtr& _at(Position pos) const {
+        return _segments[pos.segment]->chunks[pos.chunk];
+    }
+
+    Segments _segments;
+    size_t _size = 0;
+};
+
+}  // namespace mongo
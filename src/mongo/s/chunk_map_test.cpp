@@ -0,0 +1,233 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/s/chunk_map.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("TestDB", "TestColl");
+const OID kEpoch = OID::gen();
+
+BSONObj keyAt(int i, int numChunks) {
+    if (i == 0) {
+        return BSON("a" << MINKEY);
+    }
+    if (i == numChunks) {
+        return BSON("a" << MAXKEY);
+    }
+    return BSON("a" << i * 10);
+}
+
+ChunkMap::ChunkPtr makeChunk(const BSONObj& min,
+                             const BSONObj& max,
+                             const ShardId& shardId,
+                             int majorVersion) {
+    return std::make_shared<Chunk>(
+        ChunkType(kNss, {min, max}, ChunkVersion(majorVersion, 0, kEpoch), shardId));
+}
+
+/**
+ * Returns 'numChunks' chunks covering the key space, in descending key order. The chunks are
+ * spread over 'numShards' shards in contiguous runs.
+ */
+std::vector<ChunkMap::ChunkPtr> makeChunks(int numChunks, int numShards) {
+    std::vector<ChunkMap::ChunkPtr> chunks;
+    for (int i = numChunks - 1; i >= 0; --i) {
+        chunks.push_back(makeChunk(keyAt(i, numChunks),
+                                   keyAt(i + 1, numChunks),
+                                   ShardId(str::stream() << (i * numShards / numChunks)),
+                                   i + 1));
+    }
+    return chunks;
+}
+
+TEST(ChunkMapTest, BuildsInKeyOrder) {
+    const int numChunks = 10 * ChunkMap::kMaxSegmentSize;
+    ChunkMap chunkMap;
+    chunkMap.applyChanges(makeChunks(numChunks, 4));
+    ASSERT_EQ(size_t(numChunks), chunkMap.size());
+
+    int i = 0;
+    for (const auto& chunk : chunkMap) {
+        ASSERT_BSONOBJ_EQ(keyAt(i, numChunks), chunk->getMin());
+        ++i;
+    }
+    ASSERT_EQ(numChunks, i);
+
+    auto it = chunkMap.upperBound(BSON("a" << 55));
+    ASSERT(it != chunkMap.end());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 50), (*it)->getMin());
+
+    it = chunkMap.upperBound(BSON("a" << 60));
+    ASSERT_BSONOBJ_EQ(BSON("a" << 60), (*it)->getMin());
+
+    ASSERT(chunkMap.upperBound(BSON("a" << MAXKEY)) == chunkMap.end());
+}
+
+TEST(ChunkMapTest, ChangesToCopyLeaveOriginalIntact) {
+    const int numChunks = 4 * ChunkMap::kMaxSegmentSize;
+    ChunkMap original;
+    original.applyChanges(makeChunks(numChunks, 2));
+
+    // Split [50, 60) in two.
+    ChunkMap updated = original;
+    updated.applyChanges(
+        {makeChunk(BSON("a" << 50), BSON("a" << 55), ShardId("0"), numChunks + 1),
+         makeChunk(BSON("a" << 55), BSON("a" << 60), ShardId("0"), numChunks + 1)});
+
+    ASSERT_EQ(size_t(numChunks), original.size());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 60), (*original.upperBound(BSON("a" << 52)))->getMax());
+
+    ASSERT_EQ(size_t(numChunks + 1), updated.size());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 55), (*updated.upperBound(BSON("a" << 52)))->getMax());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 60), (*updated.upperBound(BSON("a" << 57)))->getMax());
+
+    // Merge everything below 1000 back into one chunk.
+    updated.applyChanges(
+        {makeChunk(BSON("a" << MINKEY), BSON("a" << 1000), ShardId("0"), numChunks + 2)});
+    ASSERT_EQ(size_t(numChunks - 99), updated.size());
+    ASSERT_BSONOBJ_EQ(BSON("a" << MINKEY), (*updated.begin())->getMin());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 1000), (*updated.begin())->getMax());
+}
+
+TEST(ChunkMapTest, ShardVersionsAndRangeTargeting) {
+    const int numChunks = 8 * ChunkMap::kMaxSegmentSize;
+    ChunkMap chunkMap;
+    chunkMap.applyChanges(makeChunks(numChunks, 4));
+
+    auto shardVersions = chunkMap.getShardVersions(kEpoch);
+    ASSERT_EQ(size_t(4), shardVersions.size());
+    ASSERT_EQ(ChunkVersion(numChunks / 4, 0, kEpoch), shardVersions[ShardId("0")]);
+    ASSERT_EQ(ChunkVersion(numChunks, 0, kEpoch), shardVersions[ShardId("3")]);
+
+    std::set<ShardId> shardIds;
+    chunkMap.getShardIdsForRange(BSON("a" << 10), BSON("a" << 100), 4, &shardIds);
+    ASSERT_EQ(size_t(1), shardIds.size());
+    ASSERT_EQ(1U, shardIds.count(ShardId("0")));
+
+    // The upper bound is inclusive, so the chunk starting at the third shard counts.
+    shardIds.clear();
+    chunkMap.getShardIdsForRange(BSON("a" << 10), keyAt(numChunks / 2, numChunks), 4, &shardIds);
+    ASSERT_EQ(size_t(3), shardIds.size());
+
+    shardIds.clear();
+    chunkMap.getShardIdsForRange(BSON("a" << MINKEY), BSON("a" << MAXKEY), 4, &shardIds);
+    ASSERT_EQ(size_t(4), shardIds.size());
+
+    // Moving a chunk raises the version of both shards.
+    chunkMap.applyChanges(
+        {makeChunk(BSON("a" << 10), BSON("a" << 20), ShardId("3"), numChunks + 1),
+         makeChunk(BSON("a" << 20), BSON("a" << 30), ShardId("0"), numChunks + 1)});
+    shardVersions = chunkMap.getShardVersions(kEpoch);
+    ASSERT_EQ(ChunkVersion(numChunks + 1, 0, kEpoch), shardVersions[ShardId("0")]);
+    ASSERT_EQ(ChunkVersion(numChunks + 1, 0, kEpoch), shardVersions[ShardId("3")]);
+
+    shardIds.clear();
+    chunkMap.getShardIdsForRange(BSON("a" << 10), BSON("a" << 15), 4, &shardIds);
+    ASSERT_EQ(size_t(1), shardIds.size());
+    ASSERT_EQ(1U, shardIds.count(ShardId("3")));
+}
+
+TEST(ChunkMapTest, LookupsOrderKeysLikeBSON) {
+    const std::vector<BSONObj> bounds{BSON("a" << MINKEY),
+                                      BSON("a" << 10),
+                                      BSON("a" << 20.5),
+                                      BSON("a" << "abc"),
+                                      BSON("a" << "abd"),
+                                      BSON("a" << MAXKEY)};
+    std::vector<ChunkMap::ChunkPtr> chunks;
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+        chunks.push_back(makeChunk(bounds[i], bounds[i + 1], ShardId("0"), i + 1));
+    }
+    ChunkMap chunkMap;
+    chunkMap.applyChanges(chunks);
+
+    // Numbers of different types compare by value, and every number sorts before every string.
+    ASSERT_BSONOBJ_EQ(bounds[0], (*chunkMap.upperBound(BSON("a" << 9.99)))->getMin());
+    ASSERT_BSONOBJ_EQ(bounds[1], (*chunkMap.upperBound(BSON("a" << 10LL)))->getMin());
+    ASSERT_BSONOBJ_EQ(bounds[1], (*chunkMap.upperBound(BSON("a" << 20)))->getMin());
+    ASSERT_BSONOBJ_EQ(bounds[2], (*chunkMap.upperBound(BSON("a" << 1e300)))->getMin());
+    ASSERT_BSONOBJ_EQ(bounds[2], (*chunkMap.upperBound(BSON("a" << "")))->getMin());
+    ASSERT_BSONOBJ_EQ(bounds[3], (*chunkMap.upperBound(BSON("a" << "abcd")))->getMin());
+    ASSERT_BSONOBJ_EQ(bounds[4], (*chunkMap.upperBound(BSON("a" << "abd")))->getMin());
+    ASSERT_BSONOBJ_EQ(bounds[4], (*chunkMap.upperBound(BSON("a" << OID())))->getMin());
+}
+
+TEST(ChunkMapTest, FindChunksMatchesUpperBound) {
+    const int numChunks = 3 * ChunkMap::kMaxSegmentSize;
+    ChunkMap chunkMap;
+    chunkMap.applyChanges(makeChunks(numChunks, 3));
+
+    // Unsorted keys with duplicates, runs within one chunk, jumps across segments and MaxKey.
+    std::vector<BSONObj> keys;
+    for (int i = 0; i < 1000; ++i) {
+        keys.push_back(BSON("a" << (i * 7919) % (numChunks * 10)));
+    }
+    keys.push_back(BSON("a" << 55));
+    keys.push_back(BSON("a" << 55));
+    keys.push_back(BSON("a" << MINKEY));
+    keys.push_back(BSON("a" << MAXKEY));
+
+    const auto chunks = chunkMap.findChunks(keys);
+    ASSERT_EQ(keys.size(), chunks.size());
+    for (size_t i = 0; i + 1 < keys.size(); ++i) {
+        ASSERT(chunks[i]);
+        ASSERT_EQ(chunks[i].get(), chunkMap.upperBound(keys[i])->get());
+        ASSERT(chunks[i]->containsKey(keys[i]));
+    }
+    ASSERT(!chunks.back());
+}
+
+TEST(ChunkMapTest, GapsAreRejected) {
+    ChunkMap chunkMap;
+    chunkMap.applyChanges(makeChunks(100, 2));
+
+    ChunkMap withGap = chunkMap;
+    ASSERT_THROWS_CODE(
+        withGap.applyChanges({makeChunk(BSON("a" << 50), BSON("a" << 55), ShardId("0"), 101)}),
+        AssertionException,
+        ErrorCodes::ConflictingOperationInProgress);
+
+    ChunkMap missingMaxKey;
+    auto chunks = makeChunks(100, 2);
+    chunks.erase(chunks.begin());
+    ASSERT_THROWS_CODE(missingMaxKey.applyChanges(chunks),
+                       AssertionException,
+                       ErrorCodes::ConflictingOperationInProgress);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -246,6 +246,35 @@ bool wasMetadataRefreshed(const std::shared_ptr<ChunkManager>& managerA,
     return false;
 }
 
+/**
+ * Returns the shard key of 'doc', which is being inserted into a collection sharded by
+ * 'shardKeyPattern', or the reason it does not have a usable one.
+ */
+StatusWith<BSONObj> extractInsertShardKey(const ShardKeyPattern& shardKeyPattern,
+                                          const BSONObj& doc) {
+    //
+    // Sharded collections have the following requirements for targeting:
+    //
+    // Inserts must contain the exact shard key.
+    //
+
+    BSONObj shardKey = shardKeyPattern.extractShardKeyFromDoc(doc);
+
+    // Check shard key exists
+    if (shardKey.isEmpty()) {
+        return {ErrorCodes::ShardKeyNotFound,
+                str::stream() << "document " << doc << " does not contain shard key for pattern "
+                              << shardKeyPattern.toString()};
+    }
+
+    // Check shard key size on insert
+    Status status = ShardKeyPattern::checkShardKeySize(shardKey);
+    if (!status.isOK())
+        return status;
+
+    return shardKey;
+}
+
 }  // namespace
 
 ChunkManagerTargeter::ChunkManagerTargeter(const NamespaceString& nss, TargeterStats* stats)
@@ -279,26 +308,11 @@ Status ChunkManagerTargeter::targetInsert(OperationContext* opCtx,
     BSONObj shardKey;
 
     if (_routingInfo->cm()) {
-        //
-        // Sharded collections have the following requirements for targeting:
-        //
-        // Inserts must contain the exact shard key.
-        //
-
-        shardKey = _routingInfo->cm()->getShardKeyPattern().extractShardKeyFromDoc(doc);
-
-        // Check shard key exists
-        if (shardKey.isEmpty()) {
-            return {ErrorCodes::ShardKeyNotFound,
-                    str::stream() << "document " << doc
-                                  << " does not contain shard key for pattern "
-                                  << _routingInfo->cm()->getShardKeyPattern().toString()};
-        }
+        auto swShardKey = extractInsertShardKey(_routingInfo->cm()->getShardKeyPattern(), doc);
+        if (!swShardKey.isOK())
+            return swShardKey.getStatus();
 
-        // Check shard key size on insert
-        Status status = ShardKeyPattern::checkShardKeySize(shardKey);
-        if (!status.isOK())
-            return status;
+        shardKey = std::move(swShardKey.getValue());
     }
 
     // Target the shard key or database primary
@@ -317,6 +331,55 @@ Status ChunkManagerTargeter::targetInsert(OperationContext* opCtx,
     return Status::OK();
 }
 
+void ChunkManagerTargeter::targetInserts(
+    OperationContext* opCtx,
+    const std::vector<BSONObj>& docs,
+    std::vector<StatusWith<ShardEndpoint>>* endpoints) const {
+    const auto cm = _routingInfo->cm();
+    if (!cm) {
+        NSTargeter::targetInserts(opCtx, docs, endpoints);
+        return;
+    }
+
+    // Extract the shard keys of the whole batch first, so that they can be looked up together
+    std::vector<StatusWith<BSONObj>> shardKeys;
+    shardKeys.reserve(docs.size());
+
+    std::vector<BSONObj> validShardKeys;
+    validShardKeys.reserve(docs.size());
+
+    for (const auto& doc : docs) {
+        shardKeys.push_back(extractInsertShardKey(cm->getShardKeyPattern(), doc));
+        if (shardKeys.back().isOK()) {
+            validShardKeys.push_back(shardKeys.back().getValue());
+        }
+    }
+
+    const auto chunks = cm->findIntersectingChunksWithSimpleCollation(validShardKeys);
+
+    auto chunkIt = chunks.begin();
+    for (size_t i = 0; i < docs.size(); ++i) {
+        if (!shardKeys[i].isOK()) {
+            endpoints->emplace_back(shardKeys[i].getStatus());
+            continue;
+        }
+
+        const auto& chunk = *chunkIt++;
+        if (!chunk) {
+            endpoints->emplace_back(ErrorCodes::ShardKeyNotFound,
+                                    str::stream() << "Cannot target single shard using key "
+                                                  << shardKeys[i].getValue());
+            continue;
+        }
+
+        // Track autosplit stats for sharded collections, as targetShardKey does
+        _stats->chunkSizeDelta[chunk->getMin()] += docs[i].objsize();
+
+        endpoints->emplace_back(
+            ShardEndpoint(chunk->getShardId(), cm->getVersion(chunk->getShardId())));
+    }
+}
+
 Status ChunkManagerTargeter::targetUpdate(
     OperationContext* opCtx,
     const write_ops::UpdateOpEntry& updateDoc,
@@ -80,6 +80,11 @@ public:
                         const BSONObj& doc,
                         ShardEndpoint** endpoint) const;
 
+    // Looks up the shard keys of all of 'docs' in a single pass over the chunks.
+    void targetInserts(OperationContext* opCtx,
+                       const std::vector<BSONObj>& docs,
+                       std::vector<StatusWith<ShardEndpoint>>* endpoints) const override;
+
     // Returns ShardKeyNotFound if the update can't be targeted without a shard key.
     Status targetUpdate(OperationContext* opCtx,
                         const write_ops::UpdateOpEntry& updateDoc,
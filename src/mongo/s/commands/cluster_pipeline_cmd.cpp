@@ -30,14 +30,100 @@
 
 #include "mongo/platform/basic.h"
 
+#include <set>
+
 #include "mongo/base/status.h"
+#include "mongo/client/read_preference.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/pipeline/lite_parsed_pipeline.h"
+#include "mongo/db/query/find_common.h"
+#include "mongo/db/repl/read_concern_args.h"
+#include "mongo/db/service_context.h"
+#include "mongo/s/catalog_cache.h"
 #include "mongo/s/commands/cluster_aggregate.h"
+#include "mongo/s/grid.h"
+#include "mongo/s/query/cluster_query_result_cache.h"
 
 namespace mongo {
 namespace {
 
+// Stages which write, whose output can differ between runs over the same data, or which report on
+// the state of the servers rather than on documents. Pipelines using them are never cached.
+const std::set<StringData> kUncacheableStages = {"$changeStream",
+                                                 "$collStats",
+                                                 "$currentOp",
+                                                 "$indexStats",
+                                                 "$listLocalSessions",
+                                                 "$listSessions",
+                                                 "$out",
+                                                 "$sample"};
+
+bool containsUncacheableStage(const BSONObj& obj) {
+    for (auto&& elem : obj) {
+        if (kUncacheableStages.count(elem.fieldNameStringData()) ||
+            (elem.isABSONObj() && containsUncacheableStage(elem.Obj()))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Returns the key under which the reply to the aggregation 'request' may be cached, along with the
+ * routing table version of its namespace, or boost::none if the reply must not be cached. Only
+ * majority reads are cached, since what they return cannot be rolled back.
+ */
+boost::optional<std::pair<std::string, ChunkVersion>> makeResultCacheKey(
+    OperationContext* opCtx, const AggregationRequest& request, const BSONObj& cmdObj) {
+    const auto& nss = request.getNamespaceString();
+    if (!ClusterQueryResultCache::isEnabled() || request.getExplain() ||
+        nss.isCollectionlessAggregateNS()) {
+        return boost::none;
+    }
+
+    repl::ReadConcernArgs readConcernArgs;
+    if (!readConcernArgs.initialize(cmdObj).isOK() ||
+        readConcernArgs.getLevel() != repl::ReadConcernLevel::kMajorityReadConcern ||
+        readConcernArgs.getArgsOpTime() || readConcernArgs.getArgsClusterTime()) {
+        return boost::none;
+    }
+
+    for (auto&& stage : request.getPipeline()) {
+        if (containsUncacheableStage(stage)) {
+            return boost::none;
+        }
+    }
+
+    // Changes to other collections would not invalidate the entry.
+    if (!LiteParsedPipeline(request).getInvolvedNamespaces().empty()) {
+        return boost::none;
+    }
+
+    auto swRoutingInfo = Grid::get(opCtx)->catalogCache()->getCollectionRoutingInfo(opCtx, nss);
+    if (!swRoutingInfo.isOK()) {
+        return boost::none;
+    }
+    const auto& routingInfo = swRoutingInfo.getValue();
+
+    BSONObjBuilder keyBuilder;
+    keyBuilder.append("ns", nss.ns());
+    keyBuilder.append("pipeline", request.getPipeline());
+    keyBuilder.append("collation", request.getCollation());
+    keyBuilder.append("batchSize", request.getBatchSize());
+    keyBuilder.append("readConcern", readConcernArgs.toBSON());
+    keyBuilder.append("readPreference", ReadPreferenceSetting::get(opCtx).toInnerBSON());
+    if (!routingInfo.cm()) {
+        // An unsharded collection has no version of its own, so tie the entry to its shard.
+        keyBuilder.append("primary", routingInfo.primaryId().toString());
+    }
+    const BSONObj key = keyBuilder.obj();
+
+    return std::make_pair(std::string(key.objdata(), key.objsize()),
+                          routingInfo.cm() ? routingInfo.cm()->getVersion()
+                                           : ChunkVersion::UNSHARDED());
+}
+
 class ClusterPipelineCommand : public BasicCommand {
 public:
     ClusterPipelineCommand() : BasicCommand("aggregate") {}
@@ -55,6 +141,10 @@ public:
         return false;
     }
 
+    std::size_t reserveBytesForReply() const override {
+        return FindCommon::kInitReplyBufferSize;
+    }
+
     bool supportsWriteConcern(const BSONObj& cmd) const override {
         return Pipeline::aggSupportsWriteConcern(cmd);
     }
@@ -93,8 +183,32 @@ private:
 
         const auto& nss = aggregationRequest.getNamespaceString();
 
-        return ClusterAggregate::runAggregate(
+        auto resultCache = ClusterQueryResultCache::get(opCtx);
+        const auto cacheKey = makeResultCacheKey(opCtx, aggregationRequest, cmdObj);
+        const auto now = opCtx->getServiceContext()->getFastClockSource()->now();
+        if (cacheKey) {
+            if (auto reply = resultCache->lookup(cacheKey->first, cacheKey->second, now)) {
+                result->appendElements(*reply);
+                return Status::OK();
+            }
+        }
+
+        auto status = ClusterAggregate::runAggregate(
             opCtx, ClusterAggregate::Namespaces{nss, nss}, aggregationRequest, cmdObj, result);
+
+        // Only a reply which holds all of the results can be reused, since the cursor behind any
+        // other reply belongs to this client.
+        if (cacheKey && status.isOK()) {
+            const BSONObj reply = result->asTempObj();
+            const auto cursor = reply["cursor"];
+            if (cursor.type() == BSONType::Object && cursor.Obj()["id"].safeNumberLong() == 0 &&
+                !reply.hasField("writeConcernError")) {
+                resultCache->insert(
+                    cacheKey->first, cacheKey->second, BSON("cursor" << cursor.Obj()), now);
+            }
+        }
+
+        return status;
     }
 
 } clusterPipelineCmd;
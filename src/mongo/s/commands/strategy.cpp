@@ -423,7 +423,10 @@ DbResponse Strategy::clientCommand(OperationContext* opCtx, const Message& m) {
 
         try {  // Execute.
             LOG(3) << "Command begin db: " << db << " msg id: " << m.header().getId();
-            runCommand(opCtx, request, reply->getInPlaceReplyBuilder(0));
+            // Let commands which return large results size the reply up front, as on mongod.
+            auto const command = Command::findCommand(request.getCommandName());
+            const std::size_t reserveBytes = command ? command->reserveBytesForReply() : 0;
+            runCommand(opCtx, request, reply->getInPlaceReplyBuilder(reserveBytes));
             LOG(3) << "Command end db: " << db << " msg id: " << m.header().getId();
         } catch (const DBException& ex) {
             LOG(1) << "Exception thrown while processing command on " << db
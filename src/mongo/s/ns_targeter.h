@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/namespace_string.h"
@@ -88,6 +89,17 @@ public:
                                 const BSONObj& doc,
                                 ShardEndpoint** endpoint) const = 0;
 
+    /**
+     * Targets each of 'docs' as targetInsert would, appending to 'endpoints' either the endpoint
+     * of each document or the reason it could not be targeted.
+     *
+     * Targeters which can look up a whole batch of documents faster than one at a time should
+     * override this. By default it calls targetInsert for each document.
+     */
+    virtual void targetInserts(OperationContext* opCtx,
+                               const std::vector<BSONObj>& docs,
+                               std::vector<StatusWith<ShardEndpoint>>* endpoints) const;
+
     /**
      * Returns a vector of ShardEndpoints for a potentially multi-shard update.
      *
@@ -168,4 +180,18 @@ struct ShardEndpoint {
     ChunkVersion shardVersion;
 };
 
+inline void NSTargeter::targetInserts(OperationContext* opCtx,
+                                      const std::vector<BSONObj>& docs,
+                                      std::vector<StatusWith<ShardEndpoint>>* endpoints) const {
+    for (const auto& doc : docs) {
+        ShardEndpoint* endpoint = nullptr;
+        Status status = targetInsert(opCtx, doc, &endpoint);
+        if (status.isOK()) {
+            endpoints->emplace_back(*std::unique_ptr<ShardEndpoint>(endpoint));
+        } else {
+            endpoints->emplace_back(std::move(status));
+        }
+    }
+}
+
 }  // namespace mongo
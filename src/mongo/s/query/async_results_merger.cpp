@@ -37,10 +37,12 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/query/cluster_query_knobs.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 
@@ -71,6 +73,9 @@ int compareSortKeys(BSONObj leftSortKey, BSONObj rightSortKey, BSONObj sortKeyPa
     return leftSortKey.woCompare(rightSortKey, sortKeyPattern, considerFieldName);
 }
 
+// The most fields an Ordering, and so a KeyString-encoded sort key, can describe.
+const int kMaxEncodedSortKeyFields = 32;
+
 const BSONObj kChangeStreamSortSpec =
     BSON("_id.clusterTime.ts" << 1 << "_id.uuid" << 1 << "_id.documentKey" << 1);
 
@@ -82,7 +87,7 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
     : _opCtx(opCtx),
       _executor(executor),
       _params(params),
-      _mergeQueue(MergingComparator(_remotes, _params->sort)) {
+      _mergeTree(_remotes, _params->sort, _params->remotes.size()) {
     size_t remoteIndex = 0;
     for (const auto& remote : _params->remotes) {
         _remotes.emplace_back(remote.hostAndPort,
@@ -194,11 +199,11 @@ bool AsyncResultsMerger::_readySorted(WithLock lk) {
 }
 
 bool AsyncResultsMerger::_readySortedTailable(WithLock) {
-    if (_mergeQueue.empty()) {
+    if (_mergeTree.empty()) {
         return false;
     }
 
-    auto smallestRemote = _mergeQueue.top();
+    auto smallestRemote = _mergeTree.top();
     auto smallestResult = _remotes[smallestRemote].docBuffer.front();
     auto keyWeWantToReturn = extractSortKey(*smallestResult.getResult());
     for (const auto& remote : _remotes) {
@@ -250,41 +255,30 @@ StatusWith<ClusterQueryResult> AsyncResultsMerger::nextReady() {
     return hasSort ? _nextReadySorted(lk) : _nextReadyUnsorted(lk);
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock lk) {
     // Tailable non-awaitData cursors cannot have a sort.
     invariant(_params->tailableMode != TailableMode::kTailable);
 
-    if (_mergeQueue.empty()) {
+    if (_mergeTree.empty()) {
         return {};
     }
 
-    size_t smallestRemote = _mergeQueue.top();
-    _mergeQueue.pop();
+    size_t smallestRemote = _mergeTree.top();
 
     invariant(!_remotes[smallestRemote].docBuffer.empty());
     invariant(_remotes[smallestRemote].status.isOK());
 
-    ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
-
-    // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
-    // next result.
-    if (!_remotes[smallestRemote].docBuffer.empty()) {
-        _mergeQueue.push(smallestRemote);
-    }
-
-    return front;
+    return _popNextResult(lk, smallestRemote);
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock lk) {
     size_t remotesAttempted = 0;
     while (remotesAttempted < _remotes.size()) {
         // It is illegal to call this method if there is an error received from any shard.
         invariant(_remotes[_gettingFromRemote].status.isOK());
 
         if (_remotes[_gettingFromRemote].hasNext()) {
-            ClusterQueryResult front = _remotes[_gettingFromRemote].docBuffer.front();
-            _remotes[_gettingFromRemote].docBuffer.pop();
+            ClusterQueryResult front = _popNextResult(lk, _gettingFromRemote);
 
             if (_params->tailableMode == TailableMode::kTailable &&
                 !_remotes[_gettingFromRemote].hasNext()) {
@@ -307,7 +301,91 @@ ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
     return {};
 }
 
-Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
+ClusterQueryResult AsyncResultsMerger::_popNextResult(WithLock lk, size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+
+    ClusterQueryResult front = remote.docBuffer.front();
+    remote.docBuffer.pop();
+
+    // Let the remote's next result, if any, take its place in the merge.
+    if (!_params->sort.isEmpty()) {
+        if (!remote.sortKeyBuffer.empty()) {
+            remote.sortKeyBuffer.pop();
+        }
+        _mergeTree.update(remoteIndex);
+    }
+
+    if (front.getResult()) {
+        ++remote.numReturned;
+        ++_numReturned;
+    }
+
+    const long long size = front.getResult() ? front.getResult()->objsize() : 0;
+    remote.bufferedBytes -= size;
+    _bufferedBytes -= size;
+    if (_bufferedBytes == 0 || _bufferedBytesCharge.bytes() - _bufferedBytes >= 64 * 1024) {
+        _bufferedBytesCharge.set(_bufferedBytes);
+    }
+
+    _prefetchIfBufferLow(lk, remoteIndex);
+    return front;
+}
+
+void AsyncResultsMerger::_prefetchIfBufferLow(WithLock lk, size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+
+    const int lowWaterMark = _params->prefetchLowWaterMark
+        ? *_params->prefetchLowWaterMark
+        : internalQueryMongosPrefetchLowWaterMark.load();
+    if (lowWaterMark <= 0 || _params->tailableMode != TailableMode::kNormal ||
+        _lifecycleState != kAlive || !remote.status.isOK() || remote.exhausted() ||
+        remote.cbHandle.isValid()) {
+        return;
+    }
+
+    // A remote with an empty buffer is asked for its next batch when it is needed, whatever the
+    // byte limit, so prefetching only has to look at remotes which still have results.
+    if (!remote.hasNext() || remote.docBuffer.size() > static_cast<size_t>(lowWaterMark) ||
+        _bufferedBytes >= internalQueryMongosPrefetchMaxBufferedBytes.load()) {
+        return;
+    }
+
+    remote.status = _askForNextBatch(lk, remoteIndex);
+    if (remote.status.isOK()) {
+        remote.requestIsPrefetch = true;
+    }
+}
+
+long long AsyncResultsMerger::_nextAdaptiveBatchSize(WithLock, size_t remoteIndex) {
+    invariant(_params->limit);
+    auto& remote = _remotes[remoteIndex];
+    const long long minBatchSize = _params->minAdaptiveBatchSize;
+
+    // The first getMore starts from the size of the batch the remote returned to the find.
+    if (remote.adaptiveBatchSize == 0) {
+        remote.adaptiveBatchSize = std::max(remote.fetchedCount, minBatchSize);
+    }
+
+    // A remote whose results keep winning the merge is asked for more of them at once, while one
+    // whose results mostly sort behind the others' is asked for less.
+    const long long numRemotes = _remotes.size();
+    if (remote.numReturned * numRemotes >= _numReturned) {
+        remote.adaptiveBatchSize *= 2;
+    } else {
+        remote.adaptiveBatchSize = std::max(remote.adaptiveBatchSize / 2, minBatchSize);
+    }
+
+    // No remote ever needs to supply more than the results still missing from the limit.
+    long long maxBatchSize = *_params->limit + _params->skip.value_or(0) - _numReturned;
+    if (_params->batchSize) {
+        maxBatchSize = std::min(maxBatchSize, *_params->batchSize);
+    }
+    remote.adaptiveBatchSize = std::max(std::min(remote.adaptiveBatchSize, maxBatchSize), 1LL);
+
+    return remote.adaptiveBatchSize;
+}
+
+Status AsyncResultsMerger::_askForNextBatch(WithLock lk, size_t remoteIndex) {
     auto& remote = _remotes[remoteIndex];
 
     invariant(!remote.cbHandle.isValid());
@@ -320,6 +398,9 @@ Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     if (_params->batchSize && *_params->batchSize > remote.fetchedCount) {
         adjustedBatchSize = *_params->batchSize - remote.fetchedCount;
     }
+    if (_params->minAdaptiveBatchSize > 0) {
+        adjustedBatchSize = _nextAdaptiveBatchSize(lk, remoteIndex);
+    }
 
     BSONObj cmdObj = GetMoreRequest(remote.cursorNss,
                                     remote.cursorId,
@@ -343,6 +424,8 @@ Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     }
 
     remote.cbHandle = callbackStatus.getValue();
+    remote.requestScheduledAt = _executor->now();
+    remote.requestIsPrefetch = false;
     return Status::OK();
 }
 
@@ -459,8 +542,16 @@ void AsyncResultsMerger::updateRemoteMetadata(RemoteCursorData* remote,
 void AsyncResultsMerger::_handleBatchResponse(WithLock lk,
                                               CbData const& cbData,
                                               size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+
     // Got a response from remote, so indicate we are no longer waiting for one.
-    _remotes[remoteIndex].cbHandle = executor::TaskExecutor::CallbackHandle();
+    remote.cbHandle = executor::TaskExecutor::CallbackHandle();
+
+    const Milliseconds latency = _executor->now() - remote.requestScheduledAt;
+    ++remote.numGetMores;
+    remote.numPrefetches += remote.requestIsPrefetch ? 1 : 0;
+    remote.totalGetMoreLatency += latency;
+    remote.maxGetMoreLatency = std::max(remote.maxGetMoreLatency, latency);
 
     //  On shutdown, there is no need to process the response.
     if (_lifecycleState != kAlive) {
@@ -471,7 +562,7 @@ void AsyncResultsMerger::_handleBatchResponse(WithLock lk,
     try {
         _processBatchResults(lk, cbData.response, remoteIndex);
     } catch (DBException const& e) {
-        _remotes[remoteIndex].status = e.toStatus();
+        remote.status = e.toStatus();
     }
     _signalCurrentEventIfReady(lk);  // Wake up anyone waiting on '_currentEvent'.
 }
@@ -503,9 +594,8 @@ void AsyncResultsMerger::_cleanUpFailedBatch(WithLock lk, Status status, size_t
     if (_params->isAllowPartialResults) {
         remote.status = Status::OK();
 
-        // Clear the results buffer and cursor id.
-        std::queue<ClusterQueryResult> emptyBuffer;
-        std::swap(remote.docBuffer, emptyBuffer);
+        // Clear the cursor id. Results which were buffered before a failed prefetch are still
+        // returned.
         remote.cursorId = 0;
     }
 }
@@ -529,6 +619,13 @@ void AsyncResultsMerger::_processBatchResults(WithLock lk,
     // Update the cursorId; it is sent as '0' when the cursor has been exhausted on the shard.
     remote.cursorId = cursorResponse.getCursorId();
 
+    if (remote.exhausted()) {
+        LOG(3) << "Remote cursor on " << remote.getTargetHost() << " exhausted after "
+               << remote.numGetMores << " getMores (" << remote.numPrefetches
+               << " prefetched), total latency " << remote.totalGetMoreLatency << ", max latency "
+               << remote.maxGetMoreLatency;
+    }
+
     // Save the batch in the remote's buffer.
     if (!_addBatchToBuffer(lk, remoteIndex, cursorResponse)) {
         return;
@@ -547,6 +644,9 @@ void AsyncResultsMerger::_processBatchResults(WithLock lk,
         // If this is normal or tailable-awaitData cursor and we still don't have anything buffered
         // after receiving this batch, we can schedule work to retrieve the next batch right away.
         remote.status = _askForNextBatch(lk, remoteIndex);
+    } else {
+        // A batch smaller than the low-water mark can be followed by the next one straight away.
+        _prefetchIfBufferLow(lk, remoteIndex);
     }
 }
 
@@ -567,15 +667,26 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
             return false;
         }
 
+        if (!_params->sort.isEmpty()) {
+            if (auto sortKey = _mergeTree.encodeSortKey(obj)) {
+                remote.sortKeyBuffer.push(std::move(*sortKey));
+            }
+        }
+
         ClusterQueryResult result(obj);
         remote.docBuffer.push(result);
         ++remote.fetchedCount;
+
+        remote.bufferedBytes += obj.objsize();
+        _bufferedBytes += obj.objsize();
     }
 
-    // If we're doing a sorted merge, then we have to make sure to put this remote onto the
-    // merge queue.
+    _bufferedBytesCharge.set(_bufferedBytes);
+
+    // If we're doing a sorted merge and the remote had run dry, its first new result now takes
+    // part in the merge. A remote that still had buffered results keeps its place.
     if (!_params->sort.isEmpty() && !response.getBatch().empty()) {
-        _mergeQueue.push(remoteIndex);
+        _mergeTree.update(remoteIndex);
     }
     return true;
 }
@@ -687,16 +798,83 @@ std::shared_ptr<Shard> AsyncResultsMerger::RemoteCursorData::getShard() {
 }
 
 //
-// AsyncResultsMerger::MergingComparator
+// AsyncResultsMerger::MergeTree
 //
 
-bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
-    const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
-    const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
+AsyncResultsMerger::MergeTree::MergeTree(const std::vector<RemoteCursorData>& remotes,
+                                         const BSONObj& sort,
+                                         size_t numRemotes)
+    : _remotes(remotes), _sort(sort), _numLeaves(1) {
+    if (!_sort.isEmpty() && _sort.nFields() <= kMaxEncodedSortKeyFields) {
+        _ordering = Ordering::make(_sort);
+    }
+
+    while (_numLeaves < numRemotes) {
+        _numLeaves *= 2;
+    }
+
+    // No remote has results yet, so every match is won by the left-most leaf of its subtree.
+    _nodes.resize(2 * _numLeaves);
+    for (size_t i = 0; i < _numLeaves; ++i) {
+        _nodes[_numLeaves + i] = i;
+    }
+    for (size_t node = _numLeaves - 1; node > 0; --node) {
+        _nodes[node] = _nodes[2 * node];
+    }
+}
+
+boost::optional<std::string> AsyncResultsMerger::MergeTree::encodeSortKey(
+    const BSONObj& obj) const {
+    if (!_ordering) {
+        return boost::none;
+    }
+
+    const KeyString sortKey(KeyString::kLatestVersion, extractSortKey(obj), *_ordering);
+    return std::string(sortKey.getBuffer(), sortKey.getSize());
+}
+
+void AsyncResultsMerger::MergeTree::update(size_t remoteIndex) {
+    for (size_t node = (_numLeaves + remoteIndex) / 2; node > 0; node /= 2) {
+        _nodes[node] = _winner(_nodes[2 * node], _nodes[2 * node + 1]);
+    }
+}
+
+bool AsyncResultsMerger::MergeTree::empty() const {
+    return !_hasNext(_nodes[1]);
+}
+
+size_t AsyncResultsMerger::MergeTree::top() const {
+    invariant(!empty());
+    return _nodes[1];
+}
+
+bool AsyncResultsMerger::MergeTree::_hasNext(size_t remoteIndex) const {
+    return remoteIndex < _remotes.size() && !_remotes[remoteIndex].docBuffer.empty();
+}
+
+size_t AsyncResultsMerger::MergeTree::_winner(size_t lhs, size_t rhs) const {
+    if (!_hasNext(rhs)) {
+        return lhs;
+    }
+    if (!_hasNext(lhs)) {
+        return rhs;
+    }
+
+    const auto& left = _remotes[lhs];
+    const auto& right = _remotes[rhs];
+
+    int cmp;
+    if (_ordering) {
+        // KeyStrings order the same way as the BSON sort keys under the sort pattern.
+        cmp = left.sortKeyBuffer.front().compare(right.sortKeyBuffer.front());
+    } else {
+        cmp = compareSortKeys(extractSortKey(*left.docBuffer.front().getResult()),
+                              extractSortKey(*right.docBuffer.front().getResult()),
+                              _sort);
+    }
 
-    return compareSortKeys(extractSortKey(*leftDoc.getResult()),
-                           extractSortKey(*rightDoc.getResult()),
-                           _sort) > 0;
+    // On ties the left subtree, which holds the lower remote indexes, wins.
+    return cmp <= 0 ? lhs : rhs;
 }
 
 }  // namespace mongo
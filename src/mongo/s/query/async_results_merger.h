@@ -30,17 +30,20 @@
 
 #include <boost/optional.hpp>
 #include <queue>
+#include <string>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
 #include "mongo/db/cursor_id.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/s/query/cluster_client_cursor_params.h"
 #include "mongo/s/query/cluster_query_result.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/memory_accounting.h"
 #include "mongo/util/net/hostandport.h"
 #include "mongo/util/time_support.h"
 
@@ -80,8 +83,8 @@ public:
      * the hosts on which they exist in _remotes.
      *
      * Additionally copies each remote's first batch of results, if one exists, into that remote's
-     * docBuffer. If a sort is specified in the ClusterClientCursorParams, places the remotes with
-     * buffered results onto _mergeQueue.
+     * docBuffer. If a sort is specified in the ClusterClientCursorParams, also encodes the sort keys
+     * and updates the remote's position in _mergeTree.
      *
      * The TaskExecutor* must remain valid for the lifetime of the ARM.
      *
@@ -249,6 +252,10 @@ private:
         // The buffer of results that have been retrieved but not yet returned to the caller.
         std::queue<ClusterQueryResult> docBuffer;
 
+        // The KeyString-encoded sort keys of the results in 'docBuffer', in the same order. Only
+        // populated when merging in sorted order and the sort keys can be encoded.
+        std::queue<std::string> sortKeyBuffer;
+
         // Is valid if there is currently a pending request to this remote.
         executor::TaskExecutor::CallbackHandle cbHandle;
 
@@ -259,19 +266,85 @@ private:
         // Count of fetched docs during ARM processing of the current batch. Used to reduce the
         // batchSize in getMore when mongod returned less docs than the requested batchSize.
         long long fetchedCount = 0;
+
+        // The total size of the results in 'docBuffer'.
+        long long bufferedBytes = 0;
+
+        // When the pending request to this remote was scheduled, and whether it was scheduled
+        // before 'docBuffer' ran dry.
+        Date_t requestScheduledAt;
+        bool requestIsPrefetch = false;
+
+        // How many getMores this remote has answered, how many of them were prefetches, and how
+        // long it took to answer them.
+        long long numGetMores = 0;
+        long long numPrefetches = 0;
+        Milliseconds totalGetMoreLatency{0};
+        Milliseconds maxGetMoreLatency{0};
+
+        // How many results from this remote have been returned, and the batch size of the last
+        // getMore sent to it. Used only with an adaptive batch size.
+        long long numReturned = 0;
+        long long adaptiveBatchSize = 0;
     };
 
-    class MergingComparator {
+    /**
+     * Tournament tree over the remotes, used to merge their results in sort order. Each remote is a
+     * leaf, and each internal node holds the index of the remote in its subtree whose next buffered
+     * result sorts first, so the root holds the remote with the next result overall. When the front
+     * of a remote's buffer changes only the matches on its path to the root are replayed, which
+     * takes log2(number of remotes) comparisons.
+     *
+     * Sort keys are compared as KeyStrings, encoded once per document as it is buffered, unless the
+     * sort pattern has more fields than an Ordering can describe.
+     */
+    class MergeTree {
     public:
-        MergingComparator(const std::vector<RemoteCursorData>& remotes, const BSONObj& sort)
-            : _remotes(remotes), _sort(sort) {}
+        MergeTree(const std::vector<RemoteCursorData>& remotes,
+                  const BSONObj& sort,
+                  size_t numRemotes);
 
-        bool operator()(const size_t& lhs, const size_t& rhs);
+        /**
+         * Returns the KeyString encoding of the $sortKey of 'obj', or boost::none if this tree
+         * compares the sort keys as BSON.
+         */
+        boost::optional<std::string> encodeSortKey(const BSONObj& obj) const;
+
+        /**
+         * Replays the matches between the leaf for 'remoteIndex' and the root. Must be called
+         * whenever the front of that remote's buffer changes.
+         */
+        void update(size_t remoteIndex);
+
+        /**
+         * Returns true if none of the remotes has a buffered result.
+         */
+        bool empty() const;
+
+        /**
+         * Returns the index of the remote whose next buffered result sorts first. Ties go to the
+         * lower index. Must not be called if empty() is true.
+         */
+        size_t top() const;
 
     private:
+        bool _hasNext(size_t remoteIndex) const;
+
+        size_t _winner(size_t lhs, size_t rhs) const;
+
         const std::vector<RemoteCursorData>& _remotes;
 
         const BSONObj& _sort;
+
+        boost::optional<Ordering> _ordering;
+
+        // Number of leaves, rounded up to a power of two so that every internal node has two
+        // children. Leaves past the last remote never have results.
+        size_t _numLeaves;
+
+        // The tree in heap order: the root is at index 1, the children of node 'i' are at '2 * i'
+        // and '2 * i + 1', and the leaf for remote 'r' is at '_numLeaves + r'.
+        std::vector<size_t> _nodes;
     };
 
     enum LifecycleState { kAlive, kKillStarted, kKillComplete };
@@ -294,6 +367,27 @@ private:
      */
     Status _askForNextBatch(WithLock, size_t remoteIndex);
 
+    /**
+     * Asks the remote at 'remoteIndex' for its next batch ahead of time, if its buffer has fallen
+     * to the cursor's low-water mark (ClusterClientCursorParams::prefetchLowWaterMark, else
+     * internalQueryMongosPrefetchLowWaterMark) results and the cursor does not already buffer
+     * internalQueryMongosPrefetchMaxBufferedBytes. Only applies to non-tailable cursors.
+     */
+    void _prefetchIfBufferLow(WithLock, size_t remoteIndex);
+
+    /**
+     * Removes and returns the next buffered result of the remote at 'remoteIndex', then prefetches
+     * its next batch if that left its buffer low.
+     */
+    ClusterQueryResult _popNextResult(WithLock, size_t remoteIndex);
+
+    /**
+     * Returns the batch size for the next getMore to the given remote when the batch size adapts
+     * to each remote: double the last one if the remote has contributed at least its even share of
+     * the results returned so far, half of it otherwise.
+     */
+    long long _nextAdaptiveBatchSize(WithLock, size_t remoteIndex);
+
     /**
      * Checks whether or not the remote cursors are all exhausted.
      */
@@ -386,14 +480,24 @@ private:
     // Data tracking the state of our communication with each of the remote nodes.
     std::vector<RemoteCursorData> _remotes;
 
-    // The top of this priority queue is the index into '_remotes' for the remote host that has the
-    // next document to return, according to the sort order. Used only if there is a sort.
-    std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
+    // The top of this tree is the index into '_remotes' for the remote host that has the next
+    // document to return, according to the sort order. Used only if there is a sort.
+    MergeTree _mergeTree;
 
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
     size_t _gettingFromRemote = 0;
 
+    // The total size of the results buffered across all of '_remotes'.
+    long long _bufferedBytes = 0;
+
+    // '_bufferedBytes' as last reported to the cursor buffer memory account. It is brought up to
+    // date after each batch and whenever the buffers drain noticeably, not after every result.
+    MemoryCharge _bufferedBytesCharge{MemoryAccountTag::kCursorBuffers};
+
+    // The number of results returned from all of '_remotes'.
+    long long _numReturned = 0;
+
     Status _status = Status::OK();
 
     executor::TaskExecutor::EventHandle _currentEvent;
@@ -30,6 +30,8 @@
 
 #include "mongo/s/query/async_results_merger.h"
 
+#include <limits>
+
 #include "mongo/client/remote_command_targeter_factory_mock.h"
 #include "mongo/client/remote_command_targeter_mock.h"
 #include "mongo/db/json.h"
@@ -41,9 +43,11 @@
 #include "mongo/executor/thread_pool_task_executor_test_fixture.h"
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/client/shard_registry.h"
+#include "mongo/s/query/cluster_query_knobs.h"
 #include "mongo/s/sharding_test_fixture.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -596,6 +600,46 @@ TEST_F(AsyncResultsMergerTest, CompoundSortKey) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, SortKeysOfMixedTypesMergeInBSONOrder) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: 1}}");
+    std::vector<BSONObj> batch1 = {fromjson("{$sortKey: {'': 1}}"),
+                                   fromjson("{$sortKey: {'': 'abc'}}")};
+    std::vector<BSONObj> batch2 = {fromjson("{$sortKey: {'': 1.5}}"),
+                                   fromjson("{$sortKey: {'': 2}}"),
+                                   fromjson("{$sortKey: {'': {x: 1}}}")};
+    std::vector<BSONObj> batch3 = {fromjson("{$sortKey: {'': null}}"),
+                                   fromjson("{$sortKey: {'': 2.0}}"),
+                                   fromjson("{$sortKey: {'': 'abd'}}")};
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 0, std::move(batch1)));
+    cursors.emplace_back(
+        kTestShardIds[1], kTestShardHosts[1], CursorResponse(_nss, 0, std::move(batch2)));
+    cursors.emplace_back(
+        kTestShardIds[2], kTestShardHosts[2], CursorResponse(_nss, 0, std::move(batch3)));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd);
+
+    // Results come back in BSON order across types, with equal numbers from the lower-numbered
+    // remote first.
+    std::vector<BSONObj> expected = {fromjson("{$sortKey: {'': null}}"),
+                                     fromjson("{$sortKey: {'': 1}}"),
+                                     fromjson("{$sortKey: {'': 1.5}}"),
+                                     fromjson("{$sortKey: {'': 2}}"),
+                                     fromjson("{$sortKey: {'': 2.0}}"),
+                                     fromjson("{$sortKey: {'': 'abc'}}"),
+                                     fromjson("{$sortKey: {'': 'abd'}}"),
+                                     fromjson("{$sortKey: {'': {x: 1}}}")};
+    for (const auto& obj : expected) {
+        ASSERT_TRUE(arm->ready());
+        auto next = unittest::assertGet(arm->nextReady());
+        ASSERT_BSONOBJ_EQ(obj, *next.getResult());
+        ASSERT_EQ(obj.firstElement().Obj().firstElement().type(),
+                  next.getResult()->firstElement().Obj().firstElement().type());
+    }
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, SortedButNoSortKey) {
     BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: -1, b: 1}}");
     std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
@@ -682,6 +726,108 @@ TEST_F(AsyncResultsMergerTest, HasFirstBatch) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, PrefetchesNextBatchAtLowWaterMark) {
+    const int oldLowWaterMark = internalQueryMongosPrefetchLowWaterMark.load();
+    internalQueryMongosPrefetchLowWaterMark.store(1);
+    ON_BLOCK_EXIT([&] { internalQueryMongosPrefetchLowWaterMark.store(oldLowWaterMark); });
+
+    std::vector<BSONObj> firstBatch = {
+        fromjson("{_id: 1}"), fromjson("{_id: 2}"), fromjson("{_id: 3}")};
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 5, std::move(firstBatch)));
+    makeCursorFromExistingCursors(std::move(cursors));
+
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+
+    // Taking the second result leaves one buffered, which is the low-water mark, so the getMore
+    // goes out before the buffer runs dry.
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_EQ(std::string("getMore"), getFirstPendingRequest().cmdObj.firstElementFieldName());
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch = {fromjson("{_id: 4}"), fromjson("{_id: 5}")};
+    responses.emplace_back(_nss, CursorId(0), batch);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    ASSERT_TRUE(arm->remotesExhausted());
+
+    // The results keep coming without the caller ever having to wait for an event.
+    for (int i = 3; i <= 5; ++i) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(BSON("_id" << i), *unittest::assertGet(arm->nextReady()).getResult());
+    }
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, PerCursorLowWaterMarkKeepsNextBatchInFlight) {
+    std::vector<BSONObj> firstBatch = {fromjson("{_id: 1}"), fromjson("{_id: 2}")};
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 5, std::move(firstBatch)));
+    _params = stdx::make_unique<ClusterClientCursorParams>(_nss, UserNameIterator());
+    _params->remotes = std::move(cursors);
+    _params->prefetchLowWaterMark = std::numeric_limits<int>::max();
+    arm = stdx::make_unique<AsyncResultsMerger>(operationContext(), executor(), _params.get());
+
+    // The server-wide low-water mark is off, but this cursor asks for its next batch as soon as
+    // it starts consuming the current one.
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_EQ(std::string("getMore"), getFirstPendingRequest().cmdObj.firstElementFieldName());
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch = {fromjson("{_id: 3}")};
+    responses.emplace_back(_nss, CursorId(0), batch);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+
+    for (int i = 2; i <= 3; ++i) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(BSON("_id" << i), *unittest::assertGet(arm->nextReady()).getResult());
+    }
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, NoPrefetchOverBufferedBytesLimit) {
+    const int oldLowWaterMark = internalQueryMongosPrefetchLowWaterMark.load();
+    const int oldMaxBytes = internalQueryMongosPrefetchMaxBufferedBytes.load();
+    internalQueryMongosPrefetchLowWaterMark.store(1);
+    internalQueryMongosPrefetchMaxBufferedBytes.store(1);
+    ON_BLOCK_EXIT([&] {
+        internalQueryMongosPrefetchLowWaterMark.store(oldLowWaterMark);
+        internalQueryMongosPrefetchMaxBufferedBytes.store(oldMaxBytes);
+    });
+
+    std::vector<BSONObj> firstBatch = {fromjson("{_id: 1}"), fromjson("{_id: 2}")};
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 5, std::move(firstBatch)));
+    makeCursorFromExistingCursors(std::move(cursors));
+
+    // The one result still buffered is already over the byte limit, so nothing is prefetched.
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+    executor::NetworkInterfaceMock* net = network();
+    net->enterNetwork();
+    ASSERT_FALSE(net->hasReadyRequests());
+    net->exitNetwork();
+
+    // Once the buffer is empty the next batch is requested as usual.
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch = {fromjson("{_id: 3}")};
+    responses.emplace_back(_nss, CursorId(0), batch);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+
+    executor()->waitForEvent(readyEvent);
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 3}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, OneShardHasInitialBatchOtherShardExhausted) {
     std::vector<BSONObj> firstBatch = {
         fromjson("{_id: 1}"), fromjson("{_id: 2}"), fromjson("{_id: 3}")};
@@ -1211,6 +1357,75 @@ TEST_F(AsyncResultsMergerTest, GetMoreBatchSizes) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, AdaptiveGetMoreBatchSizes) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}, limit: 100}");
+    std::vector<BSONObj> firstBatch1 = {fromjson("{$sortKey: {'': 1}}"),
+                                        fromjson("{$sortKey: {'': 2}}")};
+    std::vector<BSONObj> firstBatch2 = {fromjson("{$sortKey: {'': 10}}"),
+                                        fromjson("{$sortKey: {'': 11}}")};
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 5, std::move(firstBatch1)));
+    cursors.emplace_back(
+        kTestShardIds[1], kTestShardHosts[1], CursorResponse(_nss, 6, std::move(firstBatch2)));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd);
+    _params->minAdaptiveBatchSize = 2;
+
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 1}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 2}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(arm->ready());
+
+    // The first shard supplied every result so far, so it is asked for twice its first batch.
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    auto firstRequest =
+        GetMoreRequest::parseFromBSON("anydbname", getFirstPendingRequest().cmdObj);
+    ASSERT_OK(firstRequest.getStatus());
+    ASSERT_EQ(firstRequest.getValue().cursorid, 5LL);
+    ASSERT_EQ(*firstRequest.getValue().batchSize, 4LL);
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{$sortKey: {'': 3}}"),
+                                   fromjson("{$sortKey: {'': 4}}"),
+                                   fromjson("{$sortKey: {'': 5}}"),
+                                   fromjson("{$sortKey: {'': 20}}")};
+    responses.emplace_back(_nss, CursorId(0), batch1);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    for (int i : {3, 4, 5, 10, 11}) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(BSON("$sortKey" << BSON("" << i)),
+                          *unittest::assertGet(arm->nextReady()).getResult());
+    }
+    ASSERT_FALSE(arm->ready());
+
+    // The second shard supplied less than its share, so its batch shrinks to the minimum.
+    readyEvent = unittest::assertGet(arm->nextEvent());
+    auto secondRequest =
+        GetMoreRequest::parseFromBSON("anydbname", getFirstPendingRequest().cmdObj);
+    ASSERT_OK(secondRequest.getStatus());
+    ASSERT_EQ(secondRequest.getValue().cursorid, 6LL);
+    ASSERT_EQ(*secondRequest.getValue().batchSize, 2LL);
+
+    responses.clear();
+    std::vector<BSONObj> batch2 = {fromjson("{$sortKey: {'': 21}}")};
+    responses.emplace_back(_nss, CursorId(0), batch2);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    for (int i : {20, 21}) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(BSON("$sortKey" << BSON("" << i)),
+                          *unittest::assertGet(arm->nextReady()).getResult());
+    }
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, SendsSecondaryOkAsMetadata) {
     std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
     cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 1, {}));
@@ -112,6 +112,16 @@ struct ClusterClientCursorParams {
     // Should be forwarded to the remote hosts in 'cmdObj'.
     boost::optional<long long> limit;
 
+    // If positive, each getMore asks its remote for a batch sized by how much that remote has
+    // contributed to the results so far, never smaller than this and never larger than 'batchSize'
+    // or what remains of 'limit'. Requires 'limit'.
+    long long minAdaptiveBatchSize = 0;
+
+    // Overrides internalQueryMongosPrefetchLowWaterMark for this cursor if set. Internal cursors
+    // which consume their results as fast as they arrive use this to keep the next batch in flight
+    // while the current one is processed.
+    boost::optional<int> prefetchLowWaterMark;
+
     // If set, we use this pipeline to merge the output of aggregations on each remote.
     std::unique_ptr<Pipeline, Pipeline::Deleter> mergePipeline;
 
@@ -32,6 +32,7 @@
 
 #include "mongo/s/query/cluster_find.h"
 
+#include <algorithm>
 #include <set>
 #include <vector>
 
@@ -51,6 +52,7 @@
 #include "mongo/s/grid.h"
 #include "mongo/s/query/cluster_client_cursor_impl.h"
 #include "mongo/s/query/cluster_cursor_manager.h"
+#include "mongo/s/query/cluster_query_knobs.h"
 #include "mongo/s/query/establish_cursors.h"
 #include "mongo/s/query/store_possible_cursor.h"
 #include "mongo/s/stale_exception.h"
@@ -215,6 +217,25 @@ StatusWith<CursorId> runQueryWithoutRetrying(OperationContext* opCtx,
         return qrToForward.getStatus();
     }
 
+    // A find with a limit that targets several shards usually needs only a share of the first batch
+    // from each of them. Ask each shard for that share up front and let the AsyncResultsMerger
+    // grow the getMores of the shards whose results win the merge.
+    const long long minAdaptiveBatchSize = internalQueryMongosMinAdaptiveBatchSize.load();
+    auto& shardQR = *qrToForward.getValue();
+    if (minAdaptiveBatchSize > 0 && shards.size() > 1 && shardQR.getLimit() &&
+        !shardQR.getNToReturn() && !query.getQueryRequest().isTailable() &&
+        shardQR.getBatchSize().value_or(1) > 0) {
+        params.minAdaptiveBatchSize = minAdaptiveBatchSize;
+
+        const long long firstBatchSize =
+            std::min(*shardQR.getLimit(), shardQR.getBatchSize().value_or(*shardQR.getLimit()));
+        const long long numShards = shards.size();
+        const long long shareOfFirstBatch = (firstBatchSize + numShards - 1) / numShards;
+        if (shareOfFirstBatch < firstBatchSize) {
+            shardQR.setBatchSize(std::max(shareOfFirstBatch, minAdaptiveBatchSize));
+        }
+    }
+
     // Construct the find command that we will use to establish cursors, attaching the shardVersion.
 
     std::vector<std::pair<ShardId, BSONObj>> requests;
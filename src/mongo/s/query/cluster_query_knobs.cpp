@@ -37,4 +37,14 @@ namespace mongo {
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryAlwaysMergeOnPrimaryShard, bool, false);
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryProhibitMergingOnMongoS, bool, false);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryMongosPrefetchLowWaterMark, int, 0);
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryMongosPrefetchMaxBufferedBytes,
+                              int,
+                              32 * 1024 * 1024);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryMongosMinAdaptiveBatchSize, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryMongosResultCacheMaxBytes, int, 0);
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryMongosResultCacheTTLSecs, int, 60);
+
 }  // namespace mongo
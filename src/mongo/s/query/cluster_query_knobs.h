@@ -45,4 +45,26 @@ extern AtomicBool internalQueryAlwaysMergeOnPrimaryShard;
 // of merging on mongoS will always do so.
 extern AtomicBool internalQueryProhibitMergingOnMongoS;
 
+// Once the results mongos has buffered from a remote cursor fall to this many documents, mongos
+// asks that remote for its next batch instead of waiting for the buffer to run dry. Zero, the
+// default, only asks for the next batch once the buffer is empty.
+extern AtomicInt32 internalQueryMongosPrefetchLowWaterMark;
+
+// Mongos does not ask a remote for a batch ahead of time while the cursor already buffers this
+// many bytes of results across all of its remotes.
+extern AtomicInt32 internalQueryMongosPrefetchMaxBufferedBytes;
+
+// If positive, a find with a limit that targets several shards asks each shard for only its share
+// of the first batch, but never fewer than this many documents, and then sizes each getMore by how
+// much that shard has contributed to the merged results. Zero, the default, sends every shard the
+// client's batch size.
+extern AtomicInt32 internalQueryMongosMinAdaptiveBatchSize;
+
+// The memory mongos may spend caching the replies of read-only aggregations for reuse by identical
+// aggregations. Zero, the default, disables the cache.
+extern AtomicInt32 internalQueryMongosResultCacheMaxBytes;
+
+// How long a cached aggregation reply may be reused for, in seconds.
+extern AtomicInt32 internalQueryMongosResultCacheTTLSecs;
+
 }  // namespace mongo
@@ -0,0 +1,141 @@
+/**
+ * Copyright (C) 2017 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/query/cluster_query_result_cache.h"
+
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+#include "mongo/s/query/cluster_query_knobs.h"
+
+namespace mongo {
+
+namespace {
+
+const auto getClusterQueryResultCache =
+    ServiceContext::declareDecoration<ClusterQueryResultCache>();
+
+Counter64 resultCacheHits;
+Counter64 resultCacheMisses;
+
+ServerStatusMetricField<Counter64> displayResultCacheHits("query.mongosResultCache.hits",
+                                                          &resultCacheHits);
+ServerStatusMetricField<Counter64> displayResultCacheMisses("query.mongosResultCache.misses",
+                                                            &resultCacheMisses);
+
+}  // namespace
+
+ClusterQueryResultCache* ClusterQueryResultCache::get(ServiceContext* serviceContext) {
+    return &getClusterQueryResultCache(serviceContext);
+}
+
+ClusterQueryResultCache* ClusterQueryResultCache::get(OperationContext* opCtx) {
+    return get(opCtx->getServiceContext());
+}
+
+bool ClusterQueryResultCache::isEnabled() {
+    return internalQueryMongosResultCacheMaxBytes.load() > 0;
+}
+
+boost::optional<BSONObj> ClusterQueryResultCache::lookup(const std::string& key,
+                                                         const ChunkVersion& version,
+                                                         Date_t now) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    auto it = _entriesByKey.find(key);
+    if (it == _entriesByKey.end()) {
+        resultCacheMisses.increment();
+        return boost::none;
+    }
+
+    auto entryIt = it->second;
+    const Seconds ttl(internalQueryMongosResultCacheTTLSecs.load());
+    if (!entryIt->version.isStrictlyEqualTo(version) || now - entryIt->cachedAt >= ttl) {
+        _erase(lk, entryIt);
+        resultCacheMisses.increment();
+        return boost::none;
+    }
+
+    _entries.splice(_entries.begin(), _entries, entryIt);
+    resultCacheHits.increment();
+    return entryIt->reply;
+}
+
+void ClusterQueryResultCache::insert(const std::string& key,
+                                     const ChunkVersion& version,
+                                     BSONObj reply,
+                                     Date_t now) {
+    const long long maxBytes = internalQueryMongosResultCacheMaxBytes.load();
+    const size_t entryBytes = key.size() + reply.objsize();
+    if (maxBytes <= 0 || entryBytes > static_cast<size_t>(maxBytes)) {
+        return;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    auto it = _entriesByKey.find(key);
+    if (it != _entriesByKey.end()) {
+        _erase(lk, it->second);
+    }
+
+    _entries.push_front({key, version, reply.getOwned(), now});
+    _entriesByKey.emplace(key, _entries.begin());
+    _bytesUsed += entryBytes;
+
+    while (_bytesUsed > static_cast<size_t>(maxBytes)) {
+        _erase(lk, std::prev(_entries.end()));
+    }
+}
+
+void ClusterQueryResultCache::clear() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _entries.clear();
+    _entriesByKey.clear();
+    _bytesUsed = 0;
+}
+
+size_t ClusterQueryResultCache::size() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _entries.size();
+}
+
+size_t ClusterQueryResultCache::bytesUsed() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _bytesUsed;
+}
+
+void ClusterQueryResultCache::_erase(WithLock, EntryList::iterator it) {
+    _bytesUsed -= it->key.size() + it->reply.objsize();
+    _entriesByKey.erase(it->key);
+    _entries.erase(it);
+}
+
+}  // namespace mongo
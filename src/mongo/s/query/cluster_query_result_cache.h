@@ -0,0 +1,121 @@
+/**
+ * Copyright (C) 2017 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <list>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/s/chunk_version.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class OperationContext;
+class ServiceContext;
+
+/**
+ * Caches the replies of read-only queries which mongos answered completely in their first batch,
+ * so that repeats of the same query can be answered without contacting the shards.
+ *
+ * Each entry remembers the version of the routing table it was computed against and is dropped
+ * when looked up with any other version, or once it is older than
+ * internalQueryMongosResultCacheTTLSecs. The entries are bounded in total to
+ * internalQueryMongosResultCacheMaxBytes, evicting the least recently used first. The cache is
+ * disabled while that budget is zero, which is the default.
+ */
+class ClusterQueryResultCache {
+    MONGO_DISALLOW_COPYING(ClusterQueryResultCache);
+
+public:
+    ClusterQueryResultCache() = default;
+
+    static ClusterQueryResultCache* get(ServiceContext* serviceContext);
+    static ClusterQueryResultCache* get(OperationContext* opCtx);
+
+    /**
+     * Returns whether the cache has a memory budget to store replies in.
+     */
+    static bool isEnabled();
+
+    /**
+     * Returns the reply cached under 'key' if it was cached against the routing table 'version'
+     * and has not outlived its time-to-live as of 'now'. Counts a hit or a miss in serverStatus.
+     */
+    boost::optional<BSONObj> lookup(const std::string& key,
+                                     const ChunkVersion& version,
+                                     Date_t now);
+
+    /**
+     * Caches 'reply' under 'key' as computed against the routing table 'version' at 'now',
+     * replacing any entry already under 'key'. Evicts the least recently used entries as needed to
+     * stay within the memory budget. Replies which alone exceed the budget are not cached.
+     */
+    void insert(const std::string& key, const ChunkVersion& version, BSONObj reply, Date_t now);
+
+    /**
+     * Drops every entry.
+     */
+    void clear();
+
+    /**
+     * Returns the number of cached replies and the memory they take up.
+     */
+    size_t size() const;
+    size_t bytesUsed() const;
+
+private:
+    struct Entry {
+        std::string key;
+        ChunkVersion version;
+        BSONObj reply;
+        Date_t cachedAt;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    void _erase(WithLock, EntryList::iterator it);
+
+    mutable stdx::mutex _mutex;
+
+    // Most recently used first.
+    EntryList _entries;
+
+    stdx::unordered_map<std::string, EntryList::iterator> _entriesByKey;
+
+    // The total size of the keys and replies in '_entries'.
+    size_t _bytesUsed = 0;
+};
+
+}  // namespace mongo
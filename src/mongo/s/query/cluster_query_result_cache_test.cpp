@@ -0,0 +1,145 @@
+/**
+ * Copyright (C) 2017 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/query/cluster_query_result_cache.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/s/query/cluster_query_knobs.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+class ClusterQueryResultCacheTest : public unittest::Test {
+protected:
+    void setUp() override {
+        _oldMaxBytes = internalQueryMongosResultCacheMaxBytes.load();
+        _oldTTLSecs = internalQueryMongosResultCacheTTLSecs.load();
+        internalQueryMongosResultCacheMaxBytes.store(1024 * 1024);
+        internalQueryMongosResultCacheTTLSecs.store(60);
+    }
+
+    void tearDown() override {
+        internalQueryMongosResultCacheMaxBytes.store(_oldMaxBytes);
+        internalQueryMongosResultCacheTTLSecs.store(_oldTTLSecs);
+    }
+
+    static BSONObj makeReply(int numDocs) {
+        BSONArrayBuilder batch;
+        for (int i = 0; i < numDocs; ++i) {
+            batch.append(BSON("_id" << i));
+        }
+        return BSON("cursor" << BSON("id" << 0LL << "ns"
+                                          << "test.coll"
+                                          << "firstBatch"
+                                          << batch.arr()));
+    }
+
+    ClusterQueryResultCache _cache;
+    const ChunkVersion _version{1, 0, OID::gen()};
+    const Date_t _now = Date_t::fromMillisSinceEpoch(1000000);
+
+private:
+    int _oldMaxBytes;
+    int _oldTTLSecs;
+};
+
+TEST_F(ClusterQueryResultCacheTest, LookupReturnsInsertedReply) {
+    ASSERT_FALSE(_cache.lookup("key", _version, _now));
+
+    _cache.insert("key", _version, makeReply(3), _now);
+    auto reply = _cache.lookup("key", _version, _now + Seconds(1));
+    ASSERT(reply);
+    ASSERT_BSONOBJ_EQ(makeReply(3), *reply);
+    ASSERT_FALSE(_cache.lookup("otherKey", _version, _now));
+}
+
+TEST_F(ClusterQueryResultCacheTest, VersionChangeInvalidatesEntry) {
+    _cache.insert("key", _version, makeReply(3), _now);
+
+    ChunkVersion bumped(_version.majorVersion() + 1, 0, _version.epoch());
+    ASSERT_FALSE(_cache.lookup("key", bumped, _now));
+    ASSERT_EQ(0U, _cache.size());
+
+    // The entry is gone for the old version too.
+    ASSERT_FALSE(_cache.lookup("key", _version, _now));
+}
+
+TEST_F(ClusterQueryResultCacheTest, EntryExpiresAfterTTL) {
+    internalQueryMongosResultCacheTTLSecs.store(10);
+    _cache.insert("key", _version, makeReply(3), _now);
+
+    ASSERT(_cache.lookup("key", _version, _now + Seconds(9)));
+    ASSERT_FALSE(_cache.lookup("key", _version, _now + Seconds(10)));
+    ASSERT_EQ(0U, _cache.size());
+}
+
+TEST_F(ClusterQueryResultCacheTest, EvictsLeastRecentlyUsedOverBudget) {
+    const size_t entryBytes = std::string("key1").size() + makeReply(10).objsize();
+    internalQueryMongosResultCacheMaxBytes.store(2 * entryBytes);
+
+    _cache.insert("key1", _version, makeReply(10), _now);
+    _cache.insert("key2", _version, makeReply(10), _now);
+    ASSERT_EQ(2U, _cache.size());
+    ASSERT_EQ(2 * entryBytes, _cache.bytesUsed());
+
+    // Using 'key1' makes 'key2' the least recently used, so it goes to make room for 'key3'.
+    ASSERT(_cache.lookup("key1", _version, _now));
+    _cache.insert("key3", _version, makeReply(10), _now);
+    ASSERT_EQ(2U, _cache.size());
+    ASSERT(_cache.lookup("key1", _version, _now));
+    ASSERT_FALSE(_cache.lookup("key2", _version, _now));
+    ASSERT(_cache.lookup("key3", _version, _now));
+}
+
+TEST_F(ClusterQueryResultCacheTest, ReplyLargerThanBudgetIsNotCached) {
+    internalQueryMongosResultCacheMaxBytes.store(makeReply(10).objsize());
+    _cache.insert("key", _version, makeReply(10), _now);
+    ASSERT_EQ(0U, _cache.size());
+    ASSERT_EQ(0U, _cache.bytesUsed());
+}
+
+TEST_F(ClusterQueryResultCacheTest, InsertReplacesEntryUnderSameKey) {
+    _cache.insert("key", _version, makeReply(3), _now);
+    _cache.insert("key", _version, makeReply(5), _now);
+    ASSERT_EQ(1U, _cache.size());
+    ASSERT_EQ(std::string("key").size() + makeReply(5).objsize(), _cache.bytesUsed());
+    ASSERT_BSONOBJ_EQ(makeReply(5), *_cache.lookup("key", _version, _now));
+}
+
+TEST_F(ClusterQueryResultCacheTest, NothingIsCachedWhenDisabled) {
+    internalQueryMongosResultCacheMaxBytes.store(0);
+    ASSERT_FALSE(ClusterQueryResultCache::isEnabled());
+    _cache.insert("key", _version, makeReply(3), _now);
+    ASSERT_EQ(0U, _cache.size());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -100,6 +100,13 @@ MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorPoolRefreshTimeoutMS,
                                       int,
                                       ConnectionPool::kDefaultRefreshTimeout.count());
 
+// When enabled, each pool keeps as many connections to a host as it recently needed at peak, so
+// that pools which are recreated or dropped after a failover warm up in one go.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorPoolAdaptiveMinSize, bool, false);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorPoolDemandHistoryMS,
+                                      int,
+                                      ConnectionPool::kDefaultDemandHistoryWindow.count());
+
 namespace {
 
 using executor::NetworkInterface;
@@ -191,6 +198,8 @@ Status initializeGlobalShardingState(OperationContext* opCtx,
     connPoolOptions.minConnections = ShardingTaskExecutorPoolMinSize;
     connPoolOptions.refreshRequirement = Milliseconds(ShardingTaskExecutorPoolRefreshRequirementMS);
     connPoolOptions.refreshTimeout = Milliseconds(ShardingTaskExecutorPoolRefreshTimeoutMS);
+    connPoolOptions.adaptiveMinConnections = ShardingTaskExecutorPoolAdaptiveMinSize;
+    connPoolOptions.demandHistoryWindow = Milliseconds(ShardingTaskExecutorPoolDemandHistoryMS);
 
     auto network =
         executor::makeNetworkInterface("NetworkInterfaceASIO-ShardRegistry",
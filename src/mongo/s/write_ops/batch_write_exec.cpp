@@ -32,6 +32,9 @@
 
 #include "mongo/s/write_ops/batch_write_exec.h"
 
+#include <memory>
+#include <set>
+
 #include "mongo/base/error_codes.h"
 #include "mongo/base/owned_pointer_map.h"
 #include "mongo/base/status.h"
@@ -140,69 +143,52 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
         //
         // Send all child batches
         //
+        // In an unordered batch, a shard which responds without stale errors is sent the writes
+        // still _Ready for it straight away, so that one slow shard does not hold back the others.
+        // Each shard has at most one batch in flight, which is also how a response is matched to
+        // its batch. Ordered batches wait for the whole round, so that no write is sent before the
+        // ones ahead of it have succeeded.
+        //
 
-        size_t numSent = 0;
-        size_t numToSend = childBatches.size();
-        while (numSent != numToSend) {
-            // Collect batches out on the network, mapped by endpoint
-            OwnedShardBatchMap ownedPendingBatches;
-            OwnedShardBatchMap::MapType& pendingBatches = ownedPendingBatches.mutableMap();
-
-            //
-            // Construct the requests.
-            //
-
-            std::vector<AsyncRequestsSender::Request> requests;
-
-            // Get as many batches as we can at once
-            for (auto& childBatch : childBatches) {
-                TargetedWriteBatch* const nextBatch = childBatch.second;
-
-                // If the batch is nullptr, we sent it previously, so skip
-                if (!nextBatch)
-                    continue;
-
-                // If we already have a batch for this shard, wait until the next time
-                ShardId targetShardId = nextBatch->getEndpoint().shardName;
-
-                OwnedShardBatchMap::MapType::iterator pendingIt =
-                    pendingBatches.find(targetShardId);
-                if (pendingIt != pendingBatches.end())
-                    continue;
+        // Batches out on the network, mapped by shard
+        OwnedShardBatchMap ownedPendingBatches;
+        OwnedShardBatchMap::MapType& pendingBatches = ownedPendingBatches.mutableMap();
 
-                const auto request = [&] {
-                    const auto shardBatchRequest(batchOp.buildBatchRequest(*nextBatch));
+        const auto buildRequest = [&](const TargetedWriteBatch& batch) {
+            const auto shardBatchRequest(batchOp.buildBatchRequest(batch));
 
-                    BSONObjBuilder requestBuilder;
-                    shardBatchRequest.serialize(&requestBuilder);
+            BSONObjBuilder requestBuilder;
+            shardBatchRequest.serialize(&requestBuilder);
 
-                    {
-                        OperationSessionInfo sessionInfo;
+            {
+                OperationSessionInfo sessionInfo;
 
-                        if (opCtx->getLogicalSessionId()) {
-                            sessionInfo.setSessionId(*opCtx->getLogicalSessionId());
-                        }
+                if (opCtx->getLogicalSessionId()) {
+                    sessionInfo.setSessionId(*opCtx->getLogicalSessionId());
+                }
 
-                        sessionInfo.setTxnNumber(opCtx->getTxnNumber());
-                        sessionInfo.serialize(&requestBuilder);
-                    }
+                sessionInfo.setTxnNumber(opCtx->getTxnNumber());
+                sessionInfo.serialize(&requestBuilder);
+            }
 
-                    return requestBuilder.obj();
-                }();
+            const auto request = requestBuilder.obj();
+            const ShardId& targetShardId = batch.getEndpoint().shardName;
 
-                LOG(4) << "Sending write batch to " << targetShardId << ": " << redact(request);
+            LOG(4) << "Sending write batch to " << targetShardId << ": " << redact(request);
 
-                requests.emplace_back(targetShardId, request);
+            return AsyncRequestsSender::Request(targetShardId, request);
+        };
 
-                // Indicate we're done by setting the batch to nullptr. We'll only get duplicate
-                // hostEndpoints if we have broadcast and non-broadcast endpoints for the same host,
-                // so this should be pretty efficient without moving stuff around.
-                childBatch.second = nullptr;
+        std::vector<AsyncRequestsSender::Request> requests;
+        for (auto& childBatch : childBatches) {
+            requests.push_back(buildRequest(*childBatch.second));
 
-                // Recv-side is responsible for cleaning up the nextBatch when used
-                pendingBatches.insert(std::make_pair(targetShardId, nextBatch));
-            }
+            // Recv-side is responsible for cleaning up the batch when used
+            pendingBatches.insert(std::make_pair(childBatch.first, childBatch.second));
+            childBatch.second = nullptr;
+        }
 
+        if (!requests.empty()) {
             //
             // Send the requests.
             //
@@ -214,7 +200,11 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
                                     requests,
                                     readPref,
                                     Shard::RetryPolicy::kNoRetry);
-            numSent += pendingBatches.size();
+
+            // Whether more writes are targeted and sent as shards respond. Stops at the first
+            // response which is not a clean write result, leaving the rest of the batch to the
+            // targeter refresh below.
+            bool keepSending = !clientRequest.getWriteCommandBase().getOrdered();
 
             //
             // Receive the responses.
@@ -225,8 +215,10 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
                 auto response = ars.next();
 
                 // Get the TargetedWriteBatch to find where to put the response
-                dassert(pendingBatches.find(response.shardId) != pendingBatches.end());
-                TargetedWriteBatch* batch = pendingBatches.find(response.shardId)->second;
+                auto pendingIt = pendingBatches.find(response.shardId);
+                invariant(pendingIt != pendingBatches.end());
+                const std::unique_ptr<TargetedWriteBatch> batch(pendingIt->second);
+                pendingBatches.erase(pendingIt);
 
                 // First check if we were able to target a shard host.
                 if (!response.shardHostAndPort) {
@@ -241,11 +233,7 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
                     LOG(4) << "Unable to send write batch to " << batch->getEndpoint().shardName
                            << causedBy(response.swResponse.getStatus());
 
-                    // We're done with this batch. Clean up when we can't resolve a host.
-                    auto it = childBatches.find(batch->getEndpoint().shardName);
-                    invariant(it != childBatches.end());
-                    delete it->second;
-                    it->second = nullptr;
+                    keepSending = false;
                     continue;
                 }
 
@@ -279,6 +267,7 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
                     if (staleErrors.size() > 0) {
                         noteStaleResponses(staleErrors, &targeter);
                         ++stats->numStaleBatches;
+                        keepSending = false;
                     }
 
                     // Remember that we successfully wrote to this shard
@@ -303,6 +292,39 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
 
                     LOG(4) << "Unable to receive write results from " << shardHost
                            << causedBy(redact(status));
+                    keepSending = false;
+                }
+
+                if (!keepSending)
+                    continue;
+
+                //
+                // Target more writes for the shards which have no batch in flight
+                //
+
+                std::set<ShardId> busyShards;
+                for (const auto& pendingBatch : pendingBatches) {
+                    busyShards.insert(pendingBatch.first);
+                }
+
+                OwnedPointerMap<ShardId, TargetedWriteBatch> nextBatchesOwned;
+                std::map<ShardId, TargetedWriteBatch*>& nextBatches = nextBatchesOwned.mutableMap();
+
+                Status nextTargetStatus =
+                    batchOp.targetBatch(targeter, recordTargetErrors, &nextBatches, busyShards);
+                if (!nextTargetStatus.isOK()) {
+                    targeter.noteCouldNotTarget();
+                    refreshedTargeter = true;
+                    ++stats->numTargetErrors;
+                    keepSending = false;
+                    continue;
+                }
+
+                for (auto& nextBatch : nextBatches) {
+                    ars.addRequest(buildRequest(*nextBatch.second));
+
+                    pendingBatches.insert(std::make_pair(nextBatch.first, nextBatch.second));
+                    nextBatch.second = nullptr;
                 }
             }
         }
@@ -356,5 +356,71 @@ TEST_F(BatchWriteExecTest, TooManyStaleOp) {
     future.timed_get(kFutureTimeout);
 }
 
+TEST_F(BatchWriteExecTest, UnorderedSubBatchesSentInOneRound) {
+    // Two documents which do not fit in one batch. The second sub-batch goes out as soon as the
+    // first one is acknowledged, without waiting for the end of the round.
+    const std::string bigString(10 * 1024 * 1024, 'x');
+    const std::vector<BSONObj> docs{BSON("x" << 1 << "s" << bigString),
+                                    BSON("x" << 2 << "s" << bigString)};
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase writeCommandBase;
+            writeCommandBase.setOrdered(false);
+            return writeCommandBase;
+        }());
+        insertOp.setDocuments(docs);
+        return insertOp;
+    }());
+    request.setWriteConcern(BSONObj());
+
+    auto future = launchAsync([&] {
+        BatchedCommandResponse response;
+        BatchWriteExecStats stats;
+        BatchWriteExec::executeBatch(operationContext(), nsTargeter, request, &response, &stats);
+        ASSERT(response.getOk());
+
+        ASSERT_EQUALS(1, stats.numRounds);
+    });
+
+    expectInsertsReturnSuccess({docs[0]});
+    expectInsertsReturnSuccess({docs[1]});
+
+    future.timed_get(kFutureTimeout);
+}
+
+TEST_F(BatchWriteExecTest, OrderedSubBatchesSentInSeparateRounds) {
+    const std::string bigString(10 * 1024 * 1024, 'x');
+    const std::vector<BSONObj> docs{BSON("x" << 1 << "s" << bigString),
+                                    BSON("x" << 2 << "s" << bigString)};
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase writeCommandBase;
+            writeCommandBase.setOrdered(true);
+            return writeCommandBase;
+        }());
+        insertOp.setDocuments(docs);
+        return insertOp;
+    }());
+    request.setWriteConcern(BSONObj());
+
+    auto future = launchAsync([&] {
+        BatchedCommandResponse response;
+        BatchWriteExecStats stats;
+        BatchWriteExec::executeBatch(operationContext(), nsTargeter, request, &response, &stats);
+        ASSERT(response.getOk());
+
+        ASSERT_EQUALS(2, stats.numRounds);
+    });
+
+    expectInsertsReturnSuccess({docs[0]});
+    expectInsertsReturnSuccess({docs[1]});
+
+    future.timed_get(kFutureTimeout);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -30,6 +30,7 @@
 
 #include "mongo/s/write_ops/batch_write_op.h"
 
+#include <algorithm>
 #include <numeric>
 
 #include "mongo/base/error_codes.h"
@@ -68,6 +69,12 @@ struct WriteErrorDetailComp {
 const int kEstUpdateOverheadBytes = (BSONObjMaxInternalSize - BSONObjMaxUserSize) / 100;
 const int kEstDeleteOverheadBytes = (BSONObjMaxInternalSize - BSONObjMaxUserSize) / 100;
 
+// Inserts are targeted a window of documents at a time, through NSTargeter::targetInserts. The
+// window starts small, since an ordered batch may stop at the first document which goes to another
+// shard, and doubles every time it is used up.
+const size_t kMinInsertTargetingWindow = 16;
+const size_t kMaxInsertTargetingWindow = 1024;
+
 /**
  * Returns a new write concern that has the copy of every field from the original
  * document but with a w set to 1. This is intended for upgrading { w: 0 } write
@@ -229,7 +236,8 @@ BatchWriteOp::~BatchWriteOp() {
 
 Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
                                  bool recordTargetErrors,
-                                 std::map<ShardId, TargetedWriteBatch*>* targetedBatches) {
+                                 std::map<ShardId, TargetedWriteBatch*>* targetedBatches,
+                                 const std::set<ShardId>& busyShards) {
     //
     // Targeting of unordered batches is fairly simple - each remaining write op is targeted,
     // and each of those targeted writes are grouped into a batch for a particular shard
@@ -264,6 +272,7 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
     //
 
     const bool ordered = _clientRequest.getWriteCommandBase().getOrdered();
+    invariant(!ordered || busyShards.empty());
 
     TargetedBatchMap batchMap;
     TargetedBatchSizeMap batchSizes;
@@ -272,6 +281,15 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
 
     const size_t numWriteOps = _clientRequest.sizeWriteOps();
 
+    const bool targetInsertsTogether =
+        _clientRequest.getBatchType() == BatchedCommandRequest::BatchType_Insert &&
+        !_clientRequest.isInsertIndexRequest();
+
+    // The endpoints of the current window of _Ready inserts, in op order
+    vector<StatusWith<ShardEndpoint>> insertEndpoints;
+    size_t nextInsertEndpoint = 0;
+    size_t insertTargetingWindow = kMinInsertTargetingWindow;
+
     for (size_t i = 0; i < numWriteOps; ++i) {
         WriteOp& writeOp = _writeOps[i];
 
@@ -287,7 +305,30 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
         OwnedPointerVector<TargetedWrite> writesOwned;
         vector<TargetedWrite*>& writes = writesOwned.mutableVector();
 
-        Status targetStatus = writeOp.targetWrites(_opCtx, targeter, &writes);
+        Status targetStatus = Status::OK();
+        if (targetInsertsTogether) {
+            if (nextInsertEndpoint == insertEndpoints.size()) {
+                vector<BSONObj> docs;
+                for (size_t j = i; j < numWriteOps && docs.size() < insertTargetingWindow; ++j) {
+                    if (_writeOps[j].getWriteState() == WriteOpState_Ready) {
+                        docs.push_back(_writeOps[j].getWriteItem().getDocument());
+                    }
+                }
+
+                insertEndpoints.clear();
+                targeter.targetInserts(_opCtx, docs, &insertEndpoints);
+                invariant(insertEndpoints.size() == docs.size());
+
+                nextInsertEndpoint = 0;
+                insertTargetingWindow =
+                    std::min(insertTargetingWindow * 2, kMaxInsertTargetingWindow);
+            }
+
+            targetStatus =
+                writeOp.targetInsertWrite(insertEndpoints[nextInsertEndpoint++], &writes);
+        } else {
+            targetStatus = writeOp.targetWrites(_opCtx, targeter, &writes);
+        }
 
         if (!targetStatus.isOK()) {
             WriteErrorDetail targetError;
@@ -317,6 +358,18 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
             }
         }
 
+        //
+        // Leave writes for shards which are still busy with an earlier batch to a later call
+        //
+
+        if (!busyShards.empty() &&
+            std::any_of(writes.begin(), writes.end(), [&busyShards](const TargetedWrite* write) {
+                return busyShards.count(write->endpoint.shardName) > 0;
+            })) {
+            writeOp.cancelWrites(NULL);
+            continue;
+        }
+
         //
         // If ordered and we have a previous endpoint, make sure we don't need to send these
         // targeted writes to any other endpoints.
@@ -133,11 +133,16 @@ public:
      * (The idea here is that if we are sure our NSTargeter is up-to-date we should record
      * targeting errors, but if not we should refresh once first.)
      *
+     * Write ops which would be sent to any of 'busyShards' are left _Ready for a later call, so
+     * that an unordered batch op can keep feeding the shards which have already responded while
+     * others are still busy with an earlier batch. Ordered batch ops must not skip any shards.
+     *
      * Returned TargetedWriteBatches are owned by the caller.
      */
     Status targetBatch(const NSTargeter& targeter,
                        bool recordTargetErrors,
-                       std::map<ShardId, TargetedWriteBatch*>* targetedBatches);
+                       std::map<ShardId, TargetedWriteBatch*>* targetedBatches,
+                       const std::set<ShardId>& busyShards = std::set<ShardId>());
 
     /**
      * Fills a BatchCommandRequest from a TargetedWriteBatch for this BatchWriteOp.
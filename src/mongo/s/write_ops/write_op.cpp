@@ -30,6 +30,7 @@
 
 #include "mongo/s/write_ops/write_op.h"
 
+#include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
 
 namespace mongo {
@@ -100,6 +101,27 @@ Status WriteOp::targetWrites(OperationContext* opCtx,
     if (!targetStatus.isOK())
         return targetStatus;
 
+    _addChildWrites(endpoints, targetedWrites);
+    return Status::OK();
+}
+
+Status WriteOp::targetInsertWrite(const StatusWith<ShardEndpoint>& endpoint,
+                                  std::vector<TargetedWrite*>* targetedWrites) {
+    dassert(_itemRef.getOpType() == BatchedCommandRequest::BatchType_Insert);
+    dassert(!_itemRef.getRequest()->isInsertIndexRequest());
+
+    if (!endpoint.isOK())
+        return endpoint.getStatus();
+
+    std::vector<std::unique_ptr<ShardEndpoint>> endpoints;
+    endpoints.push_back(stdx::make_unique<ShardEndpoint>(endpoint.getValue()));
+
+    _addChildWrites(endpoints, targetedWrites);
+    return Status::OK();
+}
+
+void WriteOp::_addChildWrites(const std::vector<std::unique_ptr<ShardEndpoint>>& endpoints,
+                              std::vector<TargetedWrite*>* targetedWrites) {
     for (auto it = endpoints.begin(); it != endpoints.end(); ++it) {
         ShardEndpoint* endpoint = it->get();
 
@@ -120,7 +142,6 @@ Status WriteOp::targetWrites(OperationContext* opCtx,
     }
 
     _state = WriteOpState_Pending;
-    return Status::OK();
 }
 
 size_t WriteOp::getNumTargeted() {
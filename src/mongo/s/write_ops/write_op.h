@@ -121,6 +121,13 @@ public:
                         const NSTargeter& targeter,
                         std::vector<TargetedWrite*>* targetedWrites);
 
+    /**
+     * Same as targetWrites, for an insert whose endpoint was already looked up together with the
+     * rest of its batch by NSTargeter::targetInserts.
+     */
+    Status targetInsertWrite(const StatusWith<ShardEndpoint>& endpoint,
+                             std::vector<TargetedWrite*>* targetedWrites);
+
     /**
      * Returns the number of child writes that were last targeted.
      */
@@ -159,6 +166,12 @@ public:
     void setOpError(const WriteErrorDetail& error);
 
 private:
+    /**
+     * Adds a pending child write for each of 'endpoints' and moves this op to _Pending.
+     */
+    void _addChildWrites(const std::vector<std::unique_ptr<ShardEndpoint>>& endpoints,
+                         std::vector<TargetedWrite*>* targetedWrites);
+
     /**
      * Updates the op state after new information is received.
      */
@@ -32,6 +32,7 @@
 
 #include "mongo/shell/bench.h"
 
+#include <cmath>
 #include <pcrecpp.h>
 
 #include "mongo/client/dbclientcursor.h"
@@ -39,6 +40,7 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/query_request.h"
+#include "mongo/platform/bits.h"
 #include "mongo/scripting/bson_template_evaluator.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/stdx/thread.h"
@@ -231,13 +233,175 @@ int runQueryWithReadCommands(DBClientBase* conn,
 
 void doNothing(const BSONObj&) {}
 
+/**
+ * Tracks which phase of a phased bench run a worker is in, and when its next operation is due.
+ */
+class BenchRunPhaseScheduler {
+    MONGO_DISALLOW_COPYING(BenchRunPhaseScheduler);
+
+public:
+    explicit BenchRunPhaseScheduler(const BenchRunConfig& config) : _config(config) {}
+
+    /**
+     * Waits until the next operation is due, and returns the index of the phase it belongs to,
+     * setting "startLagMicros" to how far behind schedule it is. Returns boost::none once every
+     * phase has ended. The phases start on the first call.
+     */
+    boost::optional<size_t> waitForNextOp(long long* startLagMicros) {
+        if (!_timer) {
+            _timer.emplace();
+        }
+
+        while (_phase < _config.phases.size()) {
+            const auto& phase = _config.phases[_phase];
+            const double phaseEndMicros = _phaseStartMicros + phase.seconds * 1000 * 1000;
+            const long long nowMicros = _timer->micros();
+            if (nowMicros >= phaseEndMicros) {
+                _nextPhase();
+                continue;
+            }
+
+            *startLagMicros = 0;
+            if (phase.opsPerSecond <= 0) {
+                return _phase;
+            }
+
+            if (_nextOpMicros >= phaseEndMicros) {
+                sleepmicros(phaseEndMicros - nowMicros);
+                _nextPhase();
+                continue;
+            }
+
+            if (_nextOpMicros > nowMicros) {
+                sleepmicros(_nextOpMicros - nowMicros);
+            }
+
+            // Operations keep to the schedule even when running behind it, so that a slow
+            // operation shows up in the latencies of those queued behind it.
+            *startLagMicros =
+                std::max(0LL, _timer->micros() - static_cast<long long>(_nextOpMicros));
+            _nextOpMicros += 1000 * 1000 * _config.parallel / phase.opsPerSecond;
+            return _phase;
+        }
+
+        return boost::none;
+    }
+
+private:
+    void _nextPhase() {
+        _phaseStartMicros += _config.phases[_phase].seconds * 1000 * 1000;
+        _nextOpMicros = _phaseStartMicros;
+        ++_phase;
+    }
+
+    const BenchRunConfig& _config;
+    boost::optional<Timer> _timer;
+    size_t _phase{0};
+    double _phaseStartMicros{0};
+    double _nextOpMicros{0};
+};
+
+void appendAllLatencies(BSONObjBuilder* builder, const BenchRunStats& stats) {
+    stats.findOneCounter.appendLatencies(builder, "findOneLatencyMicros");
+    stats.insertCounter.appendLatencies(builder, "insertLatencyMicros");
+    stats.deleteCounter.appendLatencies(builder, "deleteLatencyMicros");
+    stats.updateCounter.appendLatencies(builder, "updateLatencyMicros");
+    stats.queryCounter.appendLatencies(builder, "queryLatencyMicros");
+    stats.commandCounter.appendLatencies(builder, "commandsLatencyMicros");
+}
+
 }  // namespace
 
+size_t BenchRunLatencyHistogram::_bucketFor(unsigned long long value) {
+    if (value < kSubBucketCount) {
+        return value;
+    }
+
+    // The kSubBucketBits bits below the most significant one select the sub-bucket.
+    const int magnitude = 63 - countLeadingZeros64(value);
+    const int shift = magnitude - kSubBucketBits;
+    return (shift + 1) * kSubBucketCount + ((value >> shift) & (kSubBucketCount - 1));
+}
+
+unsigned long long BenchRunLatencyHistogram::_highestValueInBucket(size_t bucket) {
+    if (bucket < kSubBucketCount) {
+        return bucket;
+    }
+
+    const int shift = bucket / kSubBucketCount - 1;
+    const unsigned long long lowest = (kSubBucketCount + bucket % kSubBucketCount) << shift;
+    return lowest + ((1ULL << shift) - 1);
+}
+
+void BenchRunLatencyHistogram::record(long long micros) {
+    if (micros < 0) {
+        micros = 0;
+    }
+
+    if (_counts.empty()) {
+        _counts.resize(kNumBuckets);
+    }
+
+    ++_counts[_bucketFor(micros)];
+    ++_count;
+    _max = std::max(_max, micros);
+}
+
+void BenchRunLatencyHistogram::updateFrom(const BenchRunLatencyHistogram& other) {
+    if (other._counts.empty()) {
+        return;
+    }
+
+    if (_counts.empty()) {
+        _counts.resize(kNumBuckets);
+    }
+
+    for (size_t i = 0; i < _counts.size(); ++i) {
+        _counts[i] += other._counts[i];
+    }
+    _count += other._count;
+    _max = std::max(_max, other._max);
+}
+
+long long BenchRunLatencyHistogram::getPercentile(double percentile) const {
+    if (_count == 0) {
+        return 0;
+    }
+
+    const auto target = std::max(
+        1ULL,
+        static_cast<unsigned long long>(std::ceil(std::min(percentile, 100.0) / 100 * _count)));
+    unsigned long long seen = 0;
+    for (size_t i = 0; i < _counts.size(); ++i) {
+        seen += _counts[i];
+        if (seen >= target) {
+            return std::min(static_cast<long long>(_highestValueInBucket(i)), _max);
+        }
+    }
+    return _max;
+}
+
 BenchRunEventCounter::BenchRunEventCounter() = default;
 
 void BenchRunEventCounter::updateFrom(const BenchRunEventCounter& other) {
     _numEvents += other._numEvents;
     _totalTimeMicros += other._totalTimeMicros;
+    _latencies.updateFrom(other._latencies);
+}
+
+void BenchRunEventCounter::appendLatencies(BSONObjBuilder* builder, StringData name) const {
+    if (_numEvents == 0) {
+        return;
+    }
+
+    BSONObjBuilder subObj(builder->subobjStart(name));
+    subObj.append("count", static_cast<long long>(_numEvents));
+    subObj.append("averageMicros", static_cast<double>(_totalTimeMicros) / _numEvents);
+    subObj.append("p50", _latencies.getPercentile(50));
+    subObj.append("p90", _latencies.getPercentile(90));
+    subObj.append("p99", _latencies.getPercentile(99));
+    subObj.append("p999", _latencies.getPercentile(99.9));
+    subObj.append("max", _latencies.getMax());
 }
 
 void BenchRunStats::updateFrom(const BenchRunStats& other) {
@@ -511,9 +675,39 @@ BenchRunOp opFromBson(const BSONObj& op) {
     return myOp;
 }
 
+BenchRunPhase phaseFromBson(const BSONObj& phaseObj) {
+    BenchRunPhase phase;
+    for (auto arg : phaseObj) {
+        auto name = arg.fieldNameStringData();
+        if (name == "name") {
+            uassert(40646,
+                    str::stream() << "Field '" << name << "' should be a string. . Type is "
+                                  << typeName(arg.type()),
+                    arg.type() == String);
+            phase.name = arg.String();
+        } else if (name == "seconds" || name == "opsPerSecond") {
+            uassert(40647,
+                    str::stream() << "Field '" << name << "' should be a number. . Type is "
+                                  << typeName(arg.type()),
+                    arg.isNumber());
+            (name == "seconds" ? phase.seconds : phase.opsPerSecond) = arg.number();
+        } else if (name == "recordStats") {
+            phase.recordStats = arg.trueValue();
+        } else {
+            uasserted(40648, str::stream() << "Benchrun phase has unsupported field: " << name);
+        }
+    }
+
+    uassert(40649, "Benchrun phase must last a positive number of seconds", phase.seconds > 0);
+    uassert(40650, "Benchrun phase can't have a negative opsPerSecond", phase.opsPerSecond >= 0);
+    return phase;
+}
+
 void BenchRunConfig::initializeFromBson(const BSONObj& args) {
     initializeToDefaults();
 
+    double opsPerSecond = 0;
+
     for (auto arg : args) {
         auto name = arg.fieldNameStringData();
         if (name == "host") {
@@ -558,6 +752,17 @@ void BenchRunConfig::initializeFromBson(const BSONObj& args) {
                                   << typeName(arg.type()),
                     arg.isNumber());
             seconds = arg.number();
+        } else if (name == "opsPerSecond") {
+            uassert(40651,
+                    str::stream() << "Field '" << name << "' should be a non-negative number. . "
+                                  << "Type is "
+                                  << typeName(arg.type()),
+                    arg.isNumber() && arg.number() >= 0);
+            opsPerSecond = arg.number();
+        } else if (name == "phases") {
+            for (auto phase : arg.Obj()) {
+                phases.push_back(phaseFromBson(phase.Obj()));
+            }
         } else if (name == "useSessions") {
             uassert(40641,
                     str::stream() << "Field '" << name << "' should be a boolean. . Type is "
@@ -613,6 +818,22 @@ void BenchRunConfig::initializeFromBson(const BSONObj& args) {
             uassert(34376, "benchRun passed an unsupported configuration field", false);
         }
     }
+
+    if (!phases.empty()) {
+        uassert(40652,
+                "benchRun 'opsPerSecond' must be given per phase when 'phases' is specified",
+                opsPerSecond == 0);
+        seconds = 0;
+        for (const auto& phase : phases) {
+            seconds += phase.seconds;
+        }
+    } else if (opsPerSecond > 0) {
+        BenchRunPhase phase;
+        phase.name = "steady";
+        phase.seconds = seconds;
+        phase.opsPerSecond = opsPerSecond;
+        phases.push_back(phase);
+    }
 }
 
 std::unique_ptr<DBClientBase> BenchRunConfig::createConnection() const {
@@ -751,11 +972,32 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
     std::unique_ptr<Scope> scope{getGlobalScriptEngine()->newScopeForCurrentThread()};
     verify(scope.get());
 
+    BenchRunPhaseScheduler phaseScheduler(*_config);
+    _phaseStats.resize(_config->phases.size());
+
     while (!shouldStop()) {
         for (const auto& op : _config->ops) {
             if (shouldStop())
                 break;
-            auto& stats = shouldCollectStats() ? _stats : _statsBlackHole;
+
+            long long startLagMicros = 0;
+            BenchRunStats* statsTarget = &_statsBlackHole;
+            if (shouldCollectStats()) {
+                statsTarget = &_stats;
+                if (!_config->phases.empty()) {
+                    auto phase = phaseScheduler.waitForNextOp(&startLagMicros);
+                    if (!phase) {
+                        // Every phase is over, so there is nothing left to do but wait to be told
+                        // to stop.
+                        while (!shouldStop()) {
+                            sleepmillis(10);
+                        }
+                        break;
+                    }
+                    statsTarget = &_phaseStats[*phase];
+                }
+            }
+            auto& stats = *statsTarget;
 
             ScriptingFunction scopeFunc = 0;
             BSONObj scopeObj;
@@ -802,10 +1044,10 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
                             qr->setWantMore(false);
                             invariantOK(qr->validate());
 
-                            BenchRunEventTrace _bret(&stats.findOneCounter);
+                            BenchRunEventTrace _bret(&stats.findOneCounter, startLagMicros);
                             runQueryWithReadCommands(conn, lsid, std::move(qr), &result);
                         } else {
-                            BenchRunEventTrace _bret(&stats.findOneCounter);
+                            BenchRunEventTrace _bret(&stats.findOneCounter, startLagMicros);
                             result = conn->findOne(op.ns,
                                                    fixedQuery,
                                                    nullptr,
@@ -831,7 +1073,7 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
                         bool ok;
                         BSONObj result;
                         {
-                            BenchRunEventTrace _bret(&stats.commandCounter);
+                            BenchRunEventTrace _bret(&stats.commandCounter, startLagMicros);
                             ok = runCommandWithSession(conn,
                                                        op.ns,
                                                        fixQuery(op.command, bsonTemplateEvaluator),
@@ -918,12 +1160,12 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
                             }
                             invariantOK(qr->validate());
 
-                            BenchRunEventTrace _bret(&stats.queryCounter);
+                            BenchRunEventTrace _bret(&stats.queryCounter, startLagMicros);
                             count = runQueryWithReadCommands(conn, lsid, std::move(qr), nullptr);
                         } else {
                             // Use special query function for exhaust query option.
                             if (op.options & QueryOption_Exhaust) {
-                                BenchRunEventTrace _bret(&stats.queryCounter);
+                                BenchRunEventTrace _bret(&stats.queryCounter, startLagMicros);
                                 stdx::function<void(const BSONObj&)> castedDoNothing(doNothing);
                                 count = conn->query(
                                     castedDoNothing,
@@ -932,7 +1174,7 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
                                     &op.projection,
                                     op.options | DBClientCursor::QueryOptionLocal_forceOpQuery);
                             } else {
-                                BenchRunEventTrace _bret(&stats.queryCounter);
+                                BenchRunEventTrace _bret(&stats.queryCounter, startLagMicros);
                                 std::unique_ptr<DBClientCursor> cursor(conn->query(
                                     op.ns,
                                     fixedQuery,
@@ -970,7 +1212,7 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
                     case OpType::UPDATE: {
                         BSONObj result;
                         {
-                            BenchRunEventTrace _bret(&stats.updateCounter);
+                            BenchRunEventTrace _bret(&stats.updateCounter, startLagMicros);
                             BSONObj query = fixQuery(op.query, bsonTemplateEvaluator);
                             BSONObj update = fixQuery(op.update, bsonTemplateEvaluator);
 
@@ -1032,7 +1274,7 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
                     case OpType::INSERT: {
                         BSONObj result;
                         {
-                            BenchRunEventTrace _bret(&stats.insertCounter);
+                            BenchRunEventTrace _bret(&stats.insertCounter, startLagMicros);
 
                             BSONObj insertDoc;
                             if (op.useWriteCmd) {
@@ -1106,7 +1348,7 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
                     case OpType::REMOVE: {
                         BSONObj result;
                         {
-                            BenchRunEventTrace _bret(&stats.deleteCounter);
+                            BenchRunEventTrace _bret(&stats.deleteCounter, startLagMicros);
                             BSONObj predicate = fixQuery(op.query, bsonTemplateEvaluator);
                             if (op.useWriteCmd) {
                                 BSONObjBuilder builder;
@@ -1343,15 +1585,38 @@ BenchRunStats BenchRunner::gatherStats() const {
 
     for (size_t i = 0; i < _workers.size(); ++i) {
         stats.updateFrom(_workers[i]->stats());
+
+        const auto& workerPhaseStats = _workers[i]->phaseStats();
+        for (size_t phase = 0; phase < workerPhaseStats.size(); ++phase) {
+            if (_config->phases[phase].recordStats) {
+                stats.updateFrom(workerPhaseStats[phase]);
+            }
+        }
     }
 
     return stats;
 }
 
+std::vector<BenchRunStats> BenchRunner::gatherPhaseStats() const {
+    _brState.assertFinished();
+
+    std::vector<BenchRunStats> phaseStats(_config->phases.size());
+
+    for (size_t i = 0; i < _workers.size(); ++i) {
+        const auto& workerPhaseStats = _workers[i]->phaseStats();
+        for (size_t phase = 0; phase < workerPhaseStats.size(); ++phase) {
+            phaseStats[phase].updateFrom(workerPhaseStats[phase]);
+        }
+    }
+
+    return phaseStats;
+}
+
 BSONObj BenchRunner::finish(BenchRunner* runner) {
     runner->stop();
 
     const auto stats(runner->gatherStats());
+    const auto phaseStats(runner->gatherPhaseStats());
 
     const bool error = stats.error;
     if (error) {
@@ -1377,11 +1642,22 @@ BSONObj BenchRunner::finish(BenchRunner* runner) {
     appendAverageMicrosIfAvailable("updateLatencyAverageMicros", stats.updateCounter);
     appendAverageMicrosIfAvailable("queryLatencyAverageMicros", stats.queryCounter);
     appendAverageMicrosIfAvailable("commandsLatencyAverageMicros", stats.commandCounter);
+    appendAllLatencies(&buf, stats);
 
     buf.append("totalOps", static_cast<long long>(stats.opCount));
 
-    const auto appendPerSec = [&buf, runner](StringData name, double total) {
-        buf.append(name, total / (runner->_microsElapsed / 1000000.0));
+    // Phases left out of the overall results are left out of the time they are spread over, too.
+    double secondsElapsed = runner->_microsElapsed / 1000000.0;
+    const auto& phases = runner->config().phases;
+    if (!phases.empty()) {
+        secondsElapsed = 0;
+        for (const auto& phase : phases) {
+            secondsElapsed += phase.recordStats ? phase.seconds : 0;
+        }
+    }
+
+    const auto appendPerSec = [&buf, secondsElapsed](StringData name, double total) {
+        buf.append(name, total / secondsElapsed);
     };
 
     appendPerSec("totalOps/s", stats.opCount);
@@ -1392,6 +1668,21 @@ BSONObj BenchRunner::finish(BenchRunner* runner) {
     appendPerSec("query", stats.queryCounter.getNumEvents());
     appendPerSec("command", stats.commandCounter.getNumEvents());
 
+    if (!phases.empty()) {
+        BSONArrayBuilder phasesBuilder(buf.subarrayStart("phases"));
+        for (size_t i = 0; i < phases.size(); ++i) {
+            BSONObjBuilder phaseBuilder(phasesBuilder.subobjStart());
+            phaseBuilder.append("name", phases[i].name);
+            phaseBuilder.append("seconds", phases[i].seconds);
+            phaseBuilder.append("opsPerSecond", phases[i].opsPerSecond);
+            phaseBuilder.append("recordStats", phases[i].recordStats);
+            phaseBuilder.append("errCount", static_cast<long long>(phaseStats[i].errCount));
+            phaseBuilder.append("totalOps", static_cast<long long>(phaseStats[i].opCount));
+            phaseBuilder.append("totalOps/s", phaseStats[i].opCount / phases[i].seconds);
+            appendAllLatencies(&phaseBuilder, phaseStats[i]);
+        }
+    }
+
     BSONObj zoo = buf.obj();
 
     delete runner;
@@ -100,6 +100,32 @@ public:
     BSONObj myBsonOp;
 };
 
+/**
+ * One stage of a phased bench run, such as a warmup, a steady state or a load spike.
+ */
+struct BenchRunPhase {
+    std::string name;
+
+    /**
+     * Duration of the phase, in seconds.
+     */
+    double seconds = 0;
+
+    /**
+     * Target arrival rate across all threads. When positive, each thread issues its operations on
+     * a fixed schedule of opsPerSecond / parallel per second, independent of how long earlier
+     * operations took, and latencies are measured from each operation's scheduled start. When zero,
+     * threads issue their next operation as soon as the previous one returns.
+     */
+    double opsPerSecond = 0;
+
+    /**
+     * Whether operations performed during this phase count towards the overall results. Phases
+     * always report their own results.
+     */
+    bool recordStats = true;
+};
+
 /**
  * Configuration object describing a bench run activity.
  */
@@ -190,6 +216,13 @@ public:
      */
     std::vector<BenchRunOp> ops;
 
+    /**
+     * Optional sequence of phases, run one after the other from the moment statistics collection
+     * starts. A top-level 'opsPerSecond' is shorthand for a single phase lasting 'seconds'. When
+     * there are phases, 'seconds' is the sum of their durations.
+     */
+    std::vector<BenchRunPhase> phases;
+
     bool throwGLE;
     bool breakOnTrap;
 
@@ -198,6 +231,50 @@ private:
     void initializeToDefaults();
 };
 
+/**
+ * A latency histogram in the style of HdrHistogram: buckets grow by powers of two and each is
+ * split into kSubBucketCount linear sub-buckets, so that every recorded value is reported back
+ * within a relative error of 1/kSubBucketCount, whatever its magnitude.
+ *
+ * Not thread safe.
+ */
+class BenchRunLatencyHistogram {
+public:
+    void record(long long micros);
+
+    /**
+     * Conceptually the equivalent of "+=". Adds "other" into this.
+     */
+    void updateFrom(const BenchRunLatencyHistogram& other);
+
+    /**
+     * Returns the value at or below which "percentile" percent of the recorded values fall, or 0
+     * if nothing has been recorded.
+     */
+    long long getPercentile(double percentile) const;
+
+    long long getMax() const {
+        return _max;
+    }
+
+    unsigned long long getCount() const {
+        return _count;
+    }
+
+private:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr int kSubBucketCount = 1 << kSubBucketBits;
+    static constexpr int kNumBuckets = (64 - kSubBucketBits + 1) * kSubBucketCount;
+
+    static size_t _bucketFor(unsigned long long value);
+    static unsigned long long _highestValueInBucket(size_t bucket);
+
+    // Sized to kNumBuckets on first use, so that counters which never see an event stay small.
+    std::vector<unsigned long long> _counts;
+    unsigned long long _count{0};
+    long long _max{0};
+};
+
 /**
  * An event counter for events that have an associated duration.
  *
@@ -218,6 +295,7 @@ public:
     void countOne(long long timeMicros) {
         ++_numEvents;
         _totalTimeMicros += timeMicros;
+        _latencies.record(timeMicros);
     }
 
     /**
@@ -234,9 +312,20 @@ public:
         return _numEvents;
     }
 
+    const BenchRunLatencyHistogram& getLatencies() const {
+        return _latencies;
+    }
+
+    /**
+     * Appends the count, mean and percentiles of the observed durations as a subobject called
+     * "name", unless no event was observed.
+     */
+    void appendLatencies(BSONObjBuilder* builder, StringData name) const;
+
 private:
     long long _totalTimeMicros{0};
     unsigned long long _numEvents{0};
+    BenchRunLatencyHistogram _latencies;
 };
 
 /**
@@ -251,12 +340,17 @@ private:
  * event, and otherwise, the succes counter will.
  *
  * In all cases, the counter objects must outlive the trace object.
+ *
+ * In open-loop runs, "startLagMicros" is how far behind schedule the operation started. It is added
+ * to the measured time so that latencies are relative to the intended start, rather than hiding
+ * the time the operation spent waiting behind slower ones.
  */
 class BenchRunEventTrace {
     MONGO_DISALLOW_COPYING(BenchRunEventTrace);
 
 public:
-    explicit BenchRunEventTrace(BenchRunEventCounter* eventCounter) {
+    explicit BenchRunEventTrace(BenchRunEventCounter* eventCounter, long long startLagMicros = 0)
+        : _startLagMicros(startLagMicros) {
         initialize(eventCounter, eventCounter, false);
     }
 
@@ -267,7 +361,7 @@ public:
     }
 
     ~BenchRunEventTrace() {
-        (_succeeded ? _successCounter : _failCounter)->countOne(_timer.micros());
+        (_succeeded ? _successCounter : _failCounter)->countOne(_timer.micros() + _startLagMicros);
     }
 
     void succeed() {
@@ -287,6 +381,7 @@ private:
     }
 
     Timer _timer;
+    long long _startLagMicros{0};
     BenchRunEventCounter* _successCounter;
     BenchRunEventCounter* _failCounter;
     bool _succeeded;
@@ -432,6 +527,14 @@ public:
         return _stats;
     }
 
+    /**
+     * Get the run statistics for each of the configured phases, with the same restrictions as
+     * stats().
+     */
+    const std::vector<BenchRunStats>& phaseStats() const {
+        return _phaseStats;
+    }
+
 private:
     /// The main method of the worker, executed inside the thread launched by start().
     void run();
@@ -457,6 +560,9 @@ private:
 
     // Actual stats collected during the run
     BenchRunStats _stats;
+
+    // Stats collected during each phase, when the run is divided into phases.
+    std::vector<BenchRunStats> _phaseStats;
 };
 
 /**
@@ -515,6 +621,11 @@ public:
      */
     BenchRunStats gatherStats() const;
 
+    /**
+     * Like gatherStats(), but for each of the configured phases.
+     */
+    std::vector<BenchRunStats> gatherPhaseStats() const;
+
     OID oid() const {
         return _oid;
     }
@@ -41,6 +41,7 @@
 #include "mongo/shell/shell_options.h"
 #include "mongo/shell/shell_utils_extended.h"
 #include "mongo/shell/shell_utils_launcher.h"
+#include "mongo/shell/traffic_replay.h"
 #include "mongo/util/log.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/quick_exit.h"
@@ -252,6 +253,7 @@ void initScope(Scope& scope) {
     scope.injectNative("benchRunSync", BenchRunner::benchRunSync);
     scope.injectNative("benchStart", BenchRunner::benchStart);
     scope.injectNative("benchFinish", BenchRunner::benchFinish);
+    scope.injectNative("replayRecordedTraffic", replayRecordedTraffic);
 
     if (!_dbConnect.empty()) {
         uassert(12513, "connect failed", scope.exec(_dbConnect, "(connect)", false, true, false));
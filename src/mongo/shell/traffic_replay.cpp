@@ -0,0 +1,243 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/shell/traffic_replay.h"
+
+#include <fstream>
+#include <map>
+#include <set>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/client/dbclientinterface.h"
+#include "mongo/db/dbmessage.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/traffic_recording_format.h"
+#include "mongo/rpc/factory.h"
+#include "mongo/shell/bench.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/log.h"
+#include "mongo/util/net/op_msg.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace {
+
+// Authentication conversations cannot be replayed, since they depend on nonces chosen by the
+// original server. Replay connections authenticate with the credentials given to the replay.
+const std::set<std::string> kSkippedCommands{
+    "authenticate", "getnonce", "logout", "saslContinue", "saslStart"};
+
+struct ReplayOptions {
+    std::string host;
+    std::string username;
+    std::string password;
+    double speed = 1;
+};
+
+struct ReplayedSession {
+    std::vector<const TrafficRecordingPacket*> packets;
+    std::vector<std::string> commandNames;
+
+    BenchRunEventCounter counter;
+    BenchRunEventCounter failedCounter;
+    std::map<std::string, BenchRunEventCounter> counterByCommand;
+    long long maxBehindScheduleMicros = 0;
+    std::string error;
+};
+
+std::string getCommandName(const Message& message) {
+    try {
+        if (message.operation() == dbQuery) {
+            DbMessage dbMessage(message);
+            if (!NamespaceString(dbMessage.getns()).isCommand()) {
+                return "query";
+            }
+        }
+        return rpc::opMsgRequestFromAnyProtocol(message).getCommandName().toString();
+    } catch (const DBException&) {
+        return "unknown";
+    }
+}
+
+void replaySession(const ReplayOptions& options, const Timer& clock, ReplayedSession* session) {
+    try {
+        const auto connectionString = uassertStatusOK(ConnectionString::parse(options.host));
+        std::string errmsg;
+        std::unique_ptr<DBClientBase> conn(connectionString.connect("TrafficReplay", errmsg));
+        uassert(40654, errmsg, conn);
+        if (!options.username.empty()) {
+            uassert(40655,
+                    errmsg,
+                    conn->auth("admin", options.username, options.password, errmsg));
+        }
+
+        for (size_t i = 0; i < session->packets.size(); ++i) {
+            const auto& packet = *session->packets[i];
+            const auto scheduledMicros = packet.offsetMicros / options.speed;
+            const auto behindMicros = clock.micros() - static_cast<long long>(scheduledMicros);
+            if (behindMicros < 0) {
+                sleepmicros(-behindMicros);
+            } else {
+                session->maxBehindScheduleMicros =
+                    std::max(session->maxBehindScheduleMicros, behindMicros);
+            }
+
+            // The client assigns its own request id, so send a copy of the recorded request.
+            const auto& recorded = packet.message;
+            auto buffer = SharedBuffer::allocate(recorded.size());
+            std::copy(recorded.buf(), recorded.buf() + recorded.size(), buffer.get());
+            Message toSend(std::move(buffer));
+
+            const bool expectsReply = toSend.operation() != dbMsg ||
+                !OpMsg::isFlagSet(toSend, OpMsg::kMoreToCome);
+
+            BenchRunEventCounter commandCounter;
+            {
+                BenchRunEventTrace trace(&commandCounter, &session->failedCounter, true);
+                if (expectsReply) {
+                    Message response;
+                    conn->call(toSend, response);
+                } else {
+                    conn->say(toSend);
+                }
+                trace.succeed();
+            }
+            session->counter.updateFrom(commandCounter);
+            session->counterByCommand[session->commandNames[i]].updateFrom(commandCounter);
+        }
+    } catch (const DBException& ex) {
+        session->error = ex.toString();
+    }
+}
+
+}  // namespace
+
+BSONObj replayRecordedTraffic(const BSONObj& args, void* data) {
+    uassert(40656,
+            "replayRecordedTraffic takes a file name and an options object",
+            args.nFields() == 2 && args.firstElement().type() == String &&
+                args[1].type() == Object);
+
+    const std::string filename = args.firstElement().String();
+    const BSONObj optionsObj = args[1].Obj();
+
+    ReplayOptions options;
+    for (const auto& elem : optionsObj) {
+        const auto name = elem.fieldNameStringData();
+        if (name == "host") {
+            options.host = elem.String();
+        } else if (name == "username") {
+            options.username = elem.String();
+        } else if (name == "password") {
+            options.password = elem.String();
+        } else if (name == "speed") {
+            options.speed = elem.numberDouble();
+            uassert(40657, "replay speed must be positive", options.speed > 0);
+        } else {
+            uasserted(40658, str::stream() << "Unknown replay option " << name);
+        }
+    }
+    uassert(40659, "replayRecordedTraffic requires a host", !options.host.empty());
+
+    std::ifstream in(filename, std::ios_base::in | std::ios_base::binary);
+    uassert(40660, str::stream() << "Failed to open traffic recording " << filename, in);
+    const auto recording = uassertStatusOK(readTrafficRecording(in));
+
+    long long skipped = 0;
+    std::map<transport::SessionId, ReplayedSession> sessions;
+    for (const auto& packet : recording.packets) {
+        auto commandName = getCommandName(packet.message);
+        if (kSkippedCommands.count(commandName)) {
+            ++skipped;
+            continue;
+        }
+
+        auto& session = sessions[packet.sessionId];
+        session.packets.push_back(&packet);
+        session.commandNames.push_back(std::move(commandName));
+    }
+
+    log() << "Replaying " << recording.packets.size() - skipped << " requests from "
+          << sessions.size() << " sessions recorded at " << recording.started;
+
+    Timer clock;
+    std::vector<stdx::thread> threads;
+    for (auto& session : sessions) {
+        threads.emplace_back(replaySession, std::cref(options), std::cref(clock), &session.second);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const auto replayMillis = clock.millis();
+
+    BenchRunEventCounter counter;
+    BenchRunEventCounter failedCounter;
+    std::map<std::string, BenchRunEventCounter> counterByCommand;
+    long long maxBehindScheduleMicros = 0;
+    BSONArrayBuilder errors;
+    for (const auto& session : sessions) {
+        counter.updateFrom(session.second.counter);
+        failedCounter.updateFrom(session.second.failedCounter);
+        for (const auto& command : session.second.counterByCommand) {
+            counterByCommand[command.first].updateFrom(command.second);
+        }
+        maxBehindScheduleMicros =
+            std::max(maxBehindScheduleMicros, session.second.maxBehindScheduleMicros);
+        if (!session.second.error.empty()) {
+            errors.append(session.second.error);
+        }
+    }
+
+    BSONObjBuilder result;
+    result.append("sessions", static_cast<long long>(sessions.size()));
+    result.append("requests", static_cast<long long>(counter.getNumEvents()));
+    result.append("skipped", skipped);
+    result.append("failed", static_cast<long long>(failedCounter.getNumEvents()));
+    result.append("recordedMillis",
+                  recording.packets.empty() ? 0LL
+                                            : recording.packets.back().offsetMicros / 1000);
+    result.append("replayMillis", replayMillis);
+    result.append("maxBehindScheduleMicros", maxBehindScheduleMicros);
+    counter.appendLatencies(&result, "latencyMicros");
+    {
+        BSONObjBuilder byCommand(result.subobjStart("commands"));
+        for (const auto& command : counterByCommand) {
+            command.second.appendLatencies(&byCommand, command.first);
+        }
+    }
+    result.append("errors", errors.arr());
+
+    return BSON("" << result.obj());
+}
+
+}  // namespace mongo
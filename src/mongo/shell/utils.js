@@ -1041,6 +1041,36 @@ function timestampCmp(ts1, ts2) {
     }
 }
 
+/**
+ * Compares two results of replayRecordedTraffic(), typically of the same recording replayed
+ * against two builds. Returns, overall and for each command present in both, the candidate's
+ * latency percentiles alongside their ratio to the baseline's.
+ */
+function compareTrafficReplays(baseline, candidate) {
+    var fields = ["averageMicros", "p50", "p90", "p99", "p999", "max"];
+
+    function compareLatencies(before, after) {
+        var comparison = {count: after.count};
+        fields.forEach(function(field) {
+            comparison[field] = after[field];
+            comparison[field + "Ratio"] = before[field] > 0 ? after[field] / before[field] : null;
+        });
+        return comparison;
+    }
+
+    var result = {commands: {}};
+    if (baseline.latencyMicros && candidate.latencyMicros) {
+        result.latencyMicros = compareLatencies(baseline.latencyMicros, candidate.latencyMicros);
+    }
+    Object.keys(candidate.commands).forEach(function(command) {
+        if (baseline.commands.hasOwnProperty(command)) {
+            result.commands[command] =
+                compareLatencies(baseline.commands[command], candidate.commands[command]);
+        }
+    });
+    return result;
+}
+
 Geo = {};
 Geo.distance = function(a, b) {
     var ax = null;
@@ -40,6 +40,7 @@ enum class MessageCompressor : uint8_t {
     kNoop = 0,
     kSnappy = 1,
     kZlib = 2,
+    kZlibDictionary = 3,
     kExtended = 255,
 };
 
@@ -53,7 +54,7 @@ public:
     virtual ~MessageCompressorBase() = default;
 
     /*
-     * Returns the name for subclass compressors (e.g. "snappy", "zlib", or "noop")
+     * Returns the name for subclass compressors (e.g. "snappy", "zlib", "zlibdict" or "noop")
      */
     const std::string& getName() const {
         return _name;
@@ -114,6 +115,31 @@ public:
         return _decompressBytesOut.loadRelaxed();
     }
 
+    /*
+     * This returns the total time spent in compressData, in microseconds
+     */
+    int64_t getCompressTimeMicros() const {
+        return _compressMicros.loadRelaxed();
+    }
+
+    /*
+     * This returns the total time spent in decompressData, in microseconds
+     */
+    int64_t getDecompressTimeMicros() const {
+        return _decompressMicros.loadRelaxed();
+    }
+
+    /*
+     * Called by the MessageCompressorManager to account the time spent in compressData and
+     * decompressData
+     */
+    void counterHitCompressTime(int64_t micros) {
+        _compressMicros.addAndFetch(micros);
+    }
+
+    void counterHitDecompressTime(int64_t micros) {
+        _decompressMicros.addAndFetch(micros);
+    }
 
 protected:
     /*
@@ -148,5 +174,8 @@ private:
 
     AtomicInt64 _decompressBytesIn;
     AtomicInt64 _decompressBytesOut;
+
+    AtomicInt64 _compressMicros;
+    AtomicInt64 _decompressMicros;
 };
 }  // namespace mongo
@@ -32,6 +32,8 @@
 
 #include "mongo/transport/message_compressor_manager.h"
 
+#include <algorithm>
+
 #include "mongo/base/data_range_cursor.h"
 #include "mongo/base/data_type_endian.h"
 #include "mongo/bson/bsonobj.h"
@@ -40,6 +42,7 @@
 #include "mongo/transport/session.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace {
@@ -121,7 +124,9 @@ StatusWith<Message> MessageCompressorManager::compressMessage(
     compressionHeader.serialize(&output);
     ConstDataRange input(inputHeader.data(), inputHeader.data() + inputHeader.dataLen());
 
+    Timer timer;
     auto sws = compressor->compressData(input, output);
+    compressor->counterHitCompressTime(timer.micros());
 
     if (!sws.isOK())
         return sws.getStatus();
@@ -151,7 +156,7 @@ StatusWith<Message> MessageCompressorManager::decompressMessage(const Message& m
     LOG(3) << "Decompressing message with " << compressor->getName();
 
     auto bufferSize = compressionHeader.uncompressedSize + MsgData::MsgDataHeaderSize;
-    auto outputMessageBuffer = SharedBuffer::allocate(bufferSize);
+    auto outputMessageBuffer = SharedBuffer::allocatePooled(bufferSize);
     MsgData::View outMessage(outputMessageBuffer.get());
     outMessage.setId(inputHeader.getId());
     outMessage.setResponseToMsgId(inputHeader.getResponseToMsgId());
@@ -160,7 +165,9 @@ StatusWith<Message> MessageCompressorManager::decompressMessage(const Message& m
 
     DataRangeCursor output(outMessage.data(), outMessage.data() + outMessage.dataLen());
 
+    Timer timer;
     auto sws = compressor->decompressData(input, output);
+    compressor->counterHitDecompressTime(timer.micros());
 
     if (!sws.isOK())
         return sws.getStatus();
@@ -175,6 +182,11 @@ StatusWith<Message> MessageCompressorManager::decompressMessage(const Message& m
 }
 
 void MessageCompressorManager::clientBegin(BSONObjBuilder* output) {
+    clientBegin(output, {});
+}
+
+void MessageCompressorManager::clientBegin(BSONObjBuilder* output,
+                                           const std::vector<std::string>& preferredCompressors) {
     LOG(3) << "Starting client-side compression negotiation";
 
     // We're about to update the compressor list with the negotiation result from the server.
@@ -184,8 +196,21 @@ void MessageCompressorManager::clientBegin(BSONObjBuilder* output) {
     if (compressorList.size() == 0)
         return;
 
+    std::vector<std::string> offered;
+    for (const auto& e : preferredCompressors) {
+        if (std::find(compressorList.begin(), compressorList.end(), e) != compressorList.end() &&
+            std::find(offered.begin(), offered.end(), e) == offered.end()) {
+            offered.push_back(e);
+        }
+    }
+    for (const auto& e : compressorList) {
+        if (std::find(offered.begin(), offered.end(), e) == offered.end()) {
+            offered.push_back(e);
+        }
+    }
+
     BSONArrayBuilder sub(output->subarrayStart("compression"));
-    for (const auto e : _registry->getCompressorNames()) {
+    for (const auto& e : offered) {
         LOG(3) << "Offering " << e << " compressor to server";
         sub.append(e);
     }
@@ -67,6 +67,14 @@ public:
      */
     void clientBegin(BSONObjBuilder* output);
 
+    /*
+     * Same as above, but offers the compressors named in 'preferredCompressors' ahead of the rest.
+     * Names that are not in _registry->getCompressorNames() are ignored. Because the server keeps
+     * the client's order and the first negotiated compressor is used for requests, this selects
+     * which of the configured compressors the connection uses.
+     */
+    void clientBegin(BSONObjBuilder* output, const std::vector<std::string>& preferredCompressors);
+
     /*
      * Called by a client that has received an isMaster response (received after calling
      * clientBegin) and wants to finish negotiating compression.
@@ -180,6 +180,35 @@ TEST(MessageCompressorManager, FullNormalCompression) {
     clientManager.clientFinish(serverObj);
 }
 
+TEST(MessageCompressorManager, PreferredCompressorsAreOfferedFirst) {
+    MessageCompressorRegistry registry;
+    registry.setSupportedCompressors({"snappy", "zlib"});
+    registry.registerImplementation(stdx::make_unique<SnappyMessageCompressor>());
+    registry.registerImplementation(stdx::make_unique<ZlibMessageCompressor>());
+    registry.finalizeSupportedCompressors().transitional_ignore();
+
+    MessageCompressorManager clientManager(&registry);
+    MessageCompressorManager serverManager(&registry);
+
+    // Compressors that are not configured in the registry are not offered.
+    BSONObjBuilder clientOutput;
+    clientManager.clientBegin(&clientOutput, {"fakecompressor", "zlib", "zlib"});
+    auto clientObj = clientOutput.done();
+    checkNegotiationResult(clientObj, {"zlib", "snappy"});
+
+    BSONObjBuilder serverOutput;
+    serverManager.serverNegotiate(clientObj, &serverOutput);
+    auto serverObj = serverOutput.done();
+    checkNegotiationResult(serverObj, {"zlib", "snappy"});
+
+    clientManager.clientFinish(serverObj);
+
+    auto compressedMsg = assertOk(clientManager.compressMessage(buildMessage()));
+    MessageCompressorId compressorId;
+    assertOk(serverManager.decompressMessage(compressedMsg, &compressorId));
+    ASSERT_EQ(compressorId, registry.getCompressor("zlib")->getId());
+}
+
 TEST(NoopMessageCompressor, Fidelity) {
     auto testMessage = buildMessage();
     checkFidelity(testMessage, stdx::make_unique<NoopMessageCompressor>());
@@ -195,6 +224,37 @@ TEST(ZlibMessageCompressor, Fidelity) {
     checkFidelity(testMessage, stdx::make_unique<ZlibMessageCompressor>());
 }
 
+TEST(ZlibMessageCompressor, DictionaryFidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, stdx::make_unique<ZlibMessageCompressor>("Hello, dictionary!"));
+}
+
+TEST(ZlibMessageCompressor, DictionaryMismatchFailsDecompression) {
+    auto message = buildMessage();
+    auto input = message.singleData();
+    ConstDataRange inputRange(input.data(), input.data() + input.dataLen());
+
+    ZlibMessageCompressor compressor("Hello, dictionary!");
+    std::vector<char> compressed(compressor.getMaxCompressedSize(input.dataLen()));
+    auto compressedSize = assertOk(
+        compressor.compressData(inputRange, DataRange(compressed.data(), compressed.size())));
+    ConstDataRange compressedRange(compressed.data(), compressed.data() + compressedSize);
+
+    std::vector<char> output(input.dataLen());
+    ZlibMessageCompressor other("Goodbye, dictionary!");
+    ASSERT_NOT_OK(
+        other.decompressData(compressedRange, DataRange(output.data(), output.size())));
+
+    ZlibMessageCompressor plain;
+    ASSERT_NOT_OK(
+        plain.decompressData(compressedRange, DataRange(output.data(), output.size())));
+
+    ASSERT_EQ(input.dataLen(),
+              assertOk(compressor.decompressData(compressedRange,
+                                                 DataRange(output.data(), output.size()))));
+    ASSERT_EQ(0, memcmp(output.data(), input.data(), input.dataLen()));
+}
+
 TEST(MessageCompressorManager, SERVER_28008) {
 
     // Create a client and server that will negotiate the same compressors,
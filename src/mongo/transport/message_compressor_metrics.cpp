@@ -35,6 +35,8 @@ namespace mongo {
 namespace {
 const auto kBytesIn = "bytesIn"_sd;
 const auto kBytesOut = "bytesOut"_sd;
+const auto kTimeMicros = "timeMicros"_sd;
+const auto kRatio = "ratio"_sd;
 }  // namespace
 
 void appendMessageCompressionStats(BSONObjBuilder* b) {
@@ -50,13 +52,20 @@ void appendMessageCompressionStats(BSONObjBuilder* b) {
         BSONObjBuilder base(compressionSection.subobjStart(name));
 
         BSONObjBuilder compressed(base.subobjStart("compressed"));
-        compressed << kBytesIn << compressor->getCompressedBytesIn() << kBytesOut
-                   << compressor->getCompressedBytesOut();
+        const auto compressedBytesIn = compressor->getCompressedBytesIn();
+        const auto compressedBytesOut = compressor->getCompressedBytesOut();
+        compressed << kBytesIn << compressedBytesIn << kBytesOut << compressedBytesOut
+                   << kTimeMicros << compressor->getCompressTimeMicros();
+        if (compressedBytesOut > 0) {
+            compressed << kRatio
+                       << static_cast<double>(compressedBytesIn) / compressedBytesOut;
+        }
         compressed.doneFast();
 
         BSONObjBuilder decompressed(base.subobjStart("decompressed"));
         decompressed << kBytesIn << compressor->getDecompressedBytesIn() << kBytesOut
-                     << compressor->getDecompressedBytesOut();
+                     << compressor->getDecompressedBytesOut() << kTimeMicros
+                     << compressor->getDecompressTimeMicros();
         decompressed.doneFast();
         base.doneFast();
     }
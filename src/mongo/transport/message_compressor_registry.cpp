@@ -35,15 +35,48 @@
 #include "mongo/transport/message_compressor_noop.h"
 #include "mongo/transport/message_compressor_snappy.h"
 #include "mongo/transport/message_compressor_zlib.h"
+#include "mongo/util/mongoutils/str.h"
 #include "mongo/util/options_parser/option_section.h"
 
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <fstream>
+#include <sstream>
 
 namespace mongo {
 namespace {
 const auto kDisabledConfigValue = "disabled"_sd;
 const auto kDefaultConfigValue = "snappy"_sd;
+
+// zlib only ever uses the last 32KB of a preset dictionary, so anything much larger is almost
+// certainly a misconfiguration.
+const std::streamoff kMaxDictionaryFileSize = 1024 * 1024;
+
+StatusWith<std::string> readDictionaryFile(const std::string& path) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file) {
+        return {ErrorCodes::FileNotOpen,
+                str::stream() << "Unable to open compression dictionary file " << path};
+    }
+
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    if (!file.good() && !file.eof()) {
+        return {ErrorCodes::FileStreamFailed,
+                str::stream() << "Error reading compression dictionary file " << path};
+    }
+
+    auto dictionary = contents.str();
+    if (dictionary.empty() ||
+        static_cast<std::streamoff>(dictionary.size()) > kMaxDictionaryFileSize) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "Compression dictionary file " << path
+                              << " must be between 1 byte and "
+                              << kMaxDictionaryFileSize
+                              << " bytes"};
+    }
+    return {std::move(dictionary)};
+}
 }  // namespace
 
 StringData getMessageCompressorName(MessageCompressor id) {
@@ -54,6 +87,8 @@ StringData getMessageCompressorName(MessageCompressor id) {
             return "snappy"_sd;
         case MessageCompressor::kZlib:
             return "zlib"_sd;
+        case MessageCompressor::kZlibDictionary:
+            return "zlibdict"_sd;
         default:
             fassert(40269, "Invalid message compressor ID");
     }
@@ -111,6 +146,14 @@ void MessageCompressorRegistry::setSupportedCompressors(std::vector<std::string>
     _compressorNames = std::move(names);
 }
 
+void MessageCompressorRegistry::setCompressionDictionary(std::string dictionary) {
+    _dictionary = std::move(dictionary);
+}
+
+const std::string& MessageCompressorRegistry::getCompressionDictionary() const {
+    return _dictionary;
+}
+
 Status addMessageCompressionOptions(moe::OptionSection* options, bool forShell) {
     auto ret =
         options
@@ -123,6 +166,15 @@ Status addMessageCompressionOptions(moe::OptionSection* options, bool forShell)
     if (forShell)
         ret.hidden();
 
+    auto dictionary = options->addOptionChaining(
+        "net.compression.zlibDictionaryFile",
+        "networkMessageCompressorDictionaryFile",
+        moe::String,
+        "Preset dictionary for the zlibdict network message compressor. Every member of the "
+        "cluster and every client that negotiates zlibdict must use the same file");
+    if (forShell)
+        dictionary.hidden();
+
     return Status::OK();
 }
 
@@ -138,6 +190,15 @@ Status storeMessageCompressionOptions(const moe::Environment& params) {
     auto& compressorFactory = MessageCompressorRegistry::get();
     compressorFactory.setSupportedCompressors(std::move(restrict));
 
+    if (params.count("net.compression.zlibDictionaryFile")) {
+        auto swDictionary =
+            readDictionaryFile(params["net.compression.zlibDictionaryFile"].as<std::string>());
+        if (!swDictionary.isOK()) {
+            return swDictionary.getStatus();
+        }
+        compressorFactory.setCompressionDictionary(std::move(swDictionary.getValue()));
+    }
+
     return Status::OK();
 }
 
@@ -109,12 +109,21 @@ public:
      */
     Status finalizeSupportedCompressors();
 
+    /*
+     * Sets/returns the preset dictionary shared by the dictionary-based compressors. It is loaded
+     * from net.compression.zlibDictionaryFile during option storage and is empty if none was
+     * configured.
+     */
+    void setCompressionDictionary(std::string dictionary);
+    const std::string& getCompressionDictionary() const;
+
 private:
     StringMap<MessageCompressorBase*> _compressorsByName;
     std::array<std::unique_ptr<MessageCompressorBase>,
                std::numeric_limits<MessageCompressorId>::max() + 1>
         _compressorsByIds;
     std::vector<std::string> _compressorNames;
+    std::string _dictionary;
 };
 
 Status addMessageCompressionOptions(moe::OptionSection* options, bool forShell);
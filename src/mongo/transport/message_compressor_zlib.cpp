@@ -31,22 +31,40 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/base/init.h"
+#include "mongo/base/status_with.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/message_compressor_zlib.h"
 
+#include <algorithm>
 #include <zlib.h>
 
 namespace mongo {
 
+namespace {
+const auto kZlibDictionaryName = "zlibdict"_sd;
+}  // namespace
+
 ZlibMessageCompressor::ZlibMessageCompressor() : MessageCompressorBase(MessageCompressor::kZlib) {}
 
+ZlibMessageCompressor::ZlibMessageCompressor(std::string dictionary)
+    : MessageCompressorBase(MessageCompressor::kZlibDictionary),
+      _dictionary(std::move(dictionary)) {
+    invariant(!_dictionary.empty());
+}
+
 std::size_t ZlibMessageCompressor::getMaxCompressedSize(size_t inputSize) {
-    return ::compressBound(inputSize);
+    // A preset dictionary adds a four byte checksum to the stream header.
+    return ::compressBound(inputSize) + (_dictionary.empty() ? 0 : 4);
 }
 
 StatusWith<std::size_t> ZlibMessageCompressor::compressData(ConstDataRange input,
                                                             DataRange output) {
+    if (!_dictionary.empty()) {
+        return _compressWithDictionary(input, output);
+    }
+
     size_t outLength = output.length();
     int ret = ::compress2(const_cast<Bytef*>(reinterpret_cast<const Bytef*>(output.data())),
                           reinterpret_cast<uLongf*>(&outLength),
@@ -63,6 +81,10 @@ StatusWith<std::size_t> ZlibMessageCompressor::compressData(ConstDataRange input
 
 StatusWith<std::size_t> ZlibMessageCompressor::decompressData(ConstDataRange input,
                                                               DataRange output) {
+    if (!_dictionary.empty()) {
+        return _decompressWithDictionary(input, output);
+    }
+
     uLongf length = output.length();
     int ret = ::uncompress(const_cast<Bytef*>(reinterpret_cast<const Bytef*>(output.data())),
                            &length,
@@ -77,6 +99,66 @@ StatusWith<std::size_t> ZlibMessageCompressor::decompressData(ConstDataRange inp
     return {output.length()};
 }
 
+StatusWith<std::size_t> ZlibMessageCompressor::_compressWithDictionary(ConstDataRange input,
+                                                                       DataRange output) {
+    z_stream stream{};
+    if (::deflateInit(&stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+        return Status{ErrorCodes::InternalError, "Could not initialize zlib stream"};
+    }
+    ON_BLOCK_EXIT([&] { ::deflateEnd(&stream); });
+
+    if (::deflateSetDictionary(&stream,
+                               reinterpret_cast<const Bytef*>(_dictionary.data()),
+                               _dictionary.size()) != Z_OK) {
+        return Status{ErrorCodes::InternalError, "Could not set zlib compression dictionary"};
+    }
+
+    stream.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(input.data()));
+    stream.avail_in = input.length();
+    stream.next_out = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(output.data()));
+    stream.avail_out = output.length();
+
+    if (::deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+        return Status{ErrorCodes::BadValue, "Could not compress input"};
+    }
+
+    counterHitCompress(input.length(), stream.total_out);
+    return {static_cast<std::size_t>(stream.total_out)};
+}
+
+StatusWith<std::size_t> ZlibMessageCompressor::_decompressWithDictionary(ConstDataRange input,
+                                                                         DataRange output) {
+    z_stream stream{};
+    if (::inflateInit(&stream) != Z_OK) {
+        return Status{ErrorCodes::InternalError, "Could not initialize zlib stream"};
+    }
+    ON_BLOCK_EXIT([&] { ::inflateEnd(&stream); });
+
+    stream.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(input.data()));
+    stream.avail_in = input.length();
+    stream.next_out = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(output.data()));
+    stream.avail_out = output.length();
+
+    int ret = ::inflate(&stream, Z_FINISH);
+    if (ret == Z_NEED_DICT) {
+        // inflateSetDictionary verifies the stream's dictionary checksum against ours.
+        if (::inflateSetDictionary(&stream,
+                                   reinterpret_cast<const Bytef*>(_dictionary.data()),
+                                   _dictionary.size()) != Z_OK) {
+            return Status{ErrorCodes::BadValue,
+                          "Compressed message was produced with a different dictionary"};
+        }
+        ret = ::inflate(&stream, Z_FINISH);
+    }
+
+    if (ret != Z_STREAM_END) {
+        return Status{ErrorCodes::BadValue, "Compressed message was invalid or corrupted"};
+    }
+
+    counterHitDecompress(input.length(), stream.total_out);
+    return {static_cast<std::size_t>(stream.total_out)};
+}
+
 
 MONGO_INITIALIZER_GENERAL(ZlibMessageCompressorInit,
                           ("EndStartupOptionHandling"),
@@ -84,6 +166,20 @@ MONGO_INITIALIZER_GENERAL(ZlibMessageCompressorInit,
 (InitializerContext* context) {
     auto& compressorRegistry = MessageCompressorRegistry::get();
     compressorRegistry.registerImplementation(stdx::make_unique<ZlibMessageCompressor>());
+
+    const auto& names = compressorRegistry.getCompressorNames();
+    if (std::find(names.begin(), names.end(), kZlibDictionaryName) == names.end()) {
+        return Status::OK();
+    }
+
+    const auto& dictionary = compressorRegistry.getCompressionDictionary();
+    if (dictionary.empty()) {
+        return {ErrorCodes::BadValue,
+                "The zlibdict network message compressor requires "
+                "net.compression.zlibDictionaryFile"};
+    }
+    compressorRegistry.registerImplementation(
+        stdx::make_unique<ZlibMessageCompressor>(dictionary));
     return Status::OK();
 }
 }  // namespace mongo
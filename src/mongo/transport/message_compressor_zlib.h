@@ -28,16 +28,33 @@
 
 #include "mongo/transport/message_compressor_base.h"
 
+#include <string>
+
 namespace mongo {
 class ZlibMessageCompressor final : public MessageCompressorBase {
 public:
     ZlibMessageCompressor();
 
+    /*
+     * Constructs the "zlibdict" compressor, which primes every stream with the given preset
+     * dictionary. Small messages share most of their field names and values with the dictionary,
+     * so they compress far better than they do on their own. Both ends of a connection must use
+     * the same dictionary; a mismatch is detected from the dictionary checksum zlib stores in
+     * each stream and fails decompression.
+     */
+    explicit ZlibMessageCompressor(std::string dictionary);
+
     std::size_t getMaxCompressedSize(size_t inputSize) override;
 
     StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) override;
 
     StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) override;
+
+private:
+    StatusWith<std::size_t> _compressWithDictionary(ConstDataRange input, DataRange output);
+    StatusWith<std::size_t> _decompressWithDictionary(ConstDataRange input, DataRange output);
+
+    const std::string _dictionary;
 };
 
 
@@ -0,0 +1,312 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor;
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/service_executor_thread_per_core.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/transport/service_entry_point_utils.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
+
+#include <asio.hpp>
+
+namespace mongo {
+namespace transport {
+namespace {
+// The number of worker threads, and io_contexts, to run. If the value is -1 (the default) then it
+// will be set to the number of available cores.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(threadPerCoreServiceExecutorThreads, int, -1);
+
+// Whether each worker thread is bound to its own core. This is only supported on Linux.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(threadPerCoreServiceExecutorPinThreads, bool, true);
+
+// How long an idle worker thread waits for work on its own io_context before it tries to steal
+// work from the other worker threads again.
+MONGO_EXPORT_SERVER_PARAMETER(threadPerCoreServiceExecutorStealIntervalMillis, int, 5);
+
+// Tasks scheduled with MayRecurse may be called recursively if the recursion depth is below this
+// value.
+MONGO_EXPORT_SERVER_PARAMETER(threadPerCoreServiceExecutorRecursionLimit, int, 8);
+
+constexpr auto kTotalQueued = "totalQueued"_sd;
+constexpr auto kTotalExecuted = "totalExecuted"_sd;
+constexpr auto kTotalStolen = "totalStolen"_sd;
+constexpr auto kTasksQueued = "tasksQueued"_sd;
+constexpr auto kTotalTimeQueuedUs = "totalTimeQueuedMicros"_sd;
+constexpr auto kTasksExecuting = "tasksExecuting"_sd;
+constexpr auto kThreadsRunning = "threadsRunning"_sd;
+constexpr auto kExecutorLabel = "executor"_sd;
+constexpr auto kExecutorName = "threadPerCore"_sd;
+
+int64_t ticksToMicros(TickSource::Tick ticks, TickSource* tickSource) {
+    invariant(tickSource->getTicksPerSecond() >= 1000000);
+    static const auto ticksPerMicro = tickSource->getTicksPerSecond() / 1000000;
+    return ticks / ticksPerMicro;
+}
+
+int numAvailableCores() {
+    ProcessInfo pi;
+    return std::max(static_cast<int>(pi.getNumAvailableCores().value_or(pi.getNumCores())), 1);
+}
+
+void pinCurrentThreadToCore(size_t index) {
+#if defined(__linux__)
+    const auto core = index % numAvailableCores();
+
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(core, &cpuSet);
+    int failed = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+    if (failed) {
+        warning() << "Failed to bind worker thread " << index << " to core " << core << ": "
+                  << errnoWithDescription(failed);
+    }
+#endif
+}
+
+struct ServerParameterOptions : public ServiceExecutorThreadPerCore::Options {
+    Milliseconds stealInterval() const final {
+        return Milliseconds{threadPerCoreServiceExecutorStealIntervalMillis.load()};
+    }
+
+    bool pinThreads() const final {
+        return threadPerCoreServiceExecutorPinThreads;
+    }
+
+    int recursionLimit() const final {
+        return threadPerCoreServiceExecutorRecursionLimit.load();
+    }
+};
+
+}  // namespace
+
+thread_local const ServiceExecutorThreadPerCore* ServiceExecutorThreadPerCore::_localExecutor =
+    nullptr;
+thread_local int ServiceExecutorThreadPerCore::_localContextIndex = -1;
+thread_local int ServiceExecutorThreadPerCore::_localRecursionDepth = 0;
+
+size_t ServiceExecutorThreadPerCore::configuredThreadCount() {
+    int value = threadPerCoreServiceExecutorThreads;
+    if (value <= 0) {
+        value = numAvailableCores();
+        log() << "No thread count configured for executor. Using number of cores: " << value;
+    }
+    return value;
+}
+
+ServiceExecutorThreadPerCore::ServiceExecutorThreadPerCore(
+    ServiceContext* ctx, std::vector<std::shared_ptr<asio::io_context>> ioContexts)
+    : ServiceExecutorThreadPerCore(
+          ctx, std::move(ioContexts), stdx::make_unique<ServerParameterOptions>()) {}
+
+ServiceExecutorThreadPerCore::ServiceExecutorThreadPerCore(
+    ServiceContext* ctx,
+    std::vector<std::shared_ptr<asio::io_context>> ioContexts,
+    std::unique_ptr<Options> config)
+    : _ioContexts(std::move(ioContexts)),
+      _config(std::move(config)),
+      _tickSource(ctx->getTickSource()) {
+    invariant(!_ioContexts.empty());
+}
+
+ServiceExecutorThreadPerCore::~ServiceExecutorThreadPerCore() {
+    invariant(!_isRunning.load());
+}
+
+Status ServiceExecutorThreadPerCore::start() {
+    invariant(!_isRunning.load());
+    _isRunning.store(true);
+
+    for (size_t i = 0; i < _ioContexts.size(); i++) {
+        _threadsRunning.addAndFetch(1);
+        auto status = launchServiceWorkerThread([this, i] { _workerThreadRoutine(i); });
+        if (!status.isOK()) {
+            _threadsRunning.subtractAndFetch(1);
+            shutdown(Milliseconds{0}).transitional_ignore();
+            return status;
+        }
+    }
+
+    return Status::OK();
+}
+
+Status ServiceExecutorThreadPerCore::shutdown(Milliseconds timeout) {
+    if (!_isRunning.load())
+        return Status::OK();
+
+    _isRunning.store(false);
+
+    stdx::unique_lock<stdx::mutex> lk(_threadsMutex);
+    for (auto& ioContext : _ioContexts) {
+        ioContext->stop();
+    }
+    bool result = _deathCondition.wait_for(
+        lk, timeout.toSystemDuration(), [&] { return _threadsRunning.load() == 0; });
+
+    return result
+        ? Status::OK()
+        : Status(ErrorCodes::Error::ExceededTimeLimit,
+                 "thread per core executor couldn't shutdown all worker threads within time "
+                 "limit.");
+}
+
+asio::io_context& ServiceExecutorThreadPerCore::_contextForSchedule() {
+    // Tasks scheduled by a worker stay on the io_context that the worker is currently running
+    // handlers for. This is the io_context of the session's socket, even when the worker stole the
+    // handler from another core.
+    if (_localExecutor == this && _localContextIndex >= 0) {
+        return *_ioContexts[_localContextIndex];
+    }
+
+    return *_ioContexts[_nextContext.fetchAndAdd(1) % _ioContexts.size()];
+}
+
+Status ServiceExecutorThreadPerCore::schedule(Task task, ScheduleFlags flags) {
+    auto scheduleTime = _tickSource->getTicks();
+    _tasksQueued.addAndFetch(1);
+
+    auto wrappedTask = [ this, task = std::move(task), scheduleTime ] {
+        _tasksQueued.subtractAndFetch(1);
+        _totalSpentQueued.addAndFetch(_tickSource->getTicks() - scheduleTime);
+        _tasksExecuting.addAndFetch(1);
+        _localRecursionDepth++;
+
+        const auto guard = MakeGuard([this] {
+            _localRecursionDepth--;
+            _tasksExecuting.subtractAndFetch(1);
+            _totalExecuted.addAndFetch(1);
+        });
+
+        task();
+    };
+
+    auto& ioContext = _contextForSchedule();
+
+    // Dispatching a task on the io_context will run the task immediately if the current thread is
+    // running that io_context, so only do it when the task is allowed to recurse and we are not
+    // over the depth limit. Otherwise post it, which runs the task without recursion.
+    if ((flags & kMayRecurse) && (_localRecursionDepth + 1 < _config->recursionLimit())) {
+        ioContext.dispatch(std::move(wrappedTask));
+    } else {
+        ioContext.post(std::move(wrappedTask));
+    }
+
+    _totalQueued.addAndFetch(1);
+
+    return Status::OK();
+}
+
+bool ServiceExecutorThreadPerCore::_stealOne(size_t index) {
+    for (size_t i = 1; i < _ioContexts.size(); i++) {
+        const auto victim = (index + i) % _ioContexts.size();
+        _localContextIndex = victim;
+        if (_ioContexts[victim]->poll_one() > 0) {
+            _totalStolen.addAndFetch(1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ServiceExecutorThreadPerCore::_workerThreadRoutine(size_t index) {
+    {
+        std::string threadName = str::stream() << "worker-" << index;
+        setThreadName(threadName);
+    }
+
+    if (_config->pinThreads()) {
+        pinCurrentThreadToCore(index);
+    }
+
+    log() << "Started new database worker thread " << index;
+
+    _localExecutor = this;
+    const auto guard = MakeGuard([this] {
+        _localExecutor = nullptr;
+        _localContextIndex = -1;
+
+        stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+        _threadsRunning.subtractAndFetch(1);
+        _deathCondition.notify_one();
+    });
+
+    auto& ioContext = *_ioContexts[index];
+    asio::io_context::work work(ioContext);
+
+    while (_isRunning.load()) {
+        try {
+            // Always drain everything that is ready on our own io_context before looking at the
+            // other cores, so that sessions keep running on the core their socket belongs to.
+            _localContextIndex = index;
+            if (ioContext.poll() > 0) {
+                continue;
+            }
+
+            if (_stealOne(index)) {
+                continue;
+            }
+
+            _localContextIndex = index;
+            ioContext.run_one_for(_config->stealInterval().toSystemDuration());
+        } catch (const std::exception& e) {
+            log() << "Exception escaped worker thread " << index << ": " << e.what();
+        } catch (...) {
+            log() << "Unknown exception escaped worker thread " << index;
+        }
+    }
+}
+
+void ServiceExecutorThreadPerCore::appendStats(BSONObjBuilder* bob) const {
+    BSONObjBuilder section(bob->subobjStart("serviceExecutorTaskStats"));
+    section << kExecutorLabel << kExecutorName                                             //
+            << kTotalQueued << _totalQueued.load()                                         //
+            << kTotalExecuted << _totalExecuted.load()                                     //
+            << kTotalStolen << _totalStolen.load()                                         //
+            << kTasksQueued << _tasksQueued.load()                                         //
+            << kTasksExecuting << _tasksExecuting.load()                                   //
+            << kTotalTimeQueuedUs << ticksToMicros(_totalSpentQueued.load(), _tickSource)  //
+            << kThreadsRunning << _threadsRunning.load();
+    section.doneFast();
+}
+
+}  // namespace transport
+}  // namespace mongo
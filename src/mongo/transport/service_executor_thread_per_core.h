@@ -0,0 +1,139 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/transport/service_executor.h"
+#include "mongo/util/tick_source.h"
+
+#include <asio.hpp>
+
+namespace mongo {
+namespace transport {
+
+/**
+ * This is an ASIO-based ServiceExecutor which runs exactly one worker thread per io_context,
+ * optionally pinning each thread to its own core. The TransportLayerASIO spreads accepted sockets
+ * across the io_contexts, and tasks scheduled from a worker thread are queued on that thread's
+ * io_context, so every session stays on the core its socket was assigned to.
+ *
+ * A worker which has nothing ready on its own io_context runs ready handlers from the other
+ * io_contexts, so that a core which is busy with a long running operation does not hold up the
+ * other sessions assigned to it.
+ */
+class ServiceExecutorThreadPerCore : public ServiceExecutor {
+public:
+    struct Options {
+        virtual ~Options() = default;
+
+        // How long an idle worker thread waits for work on its own io_context before trying to
+        // steal work from the other io_contexts again.
+        virtual Milliseconds stealInterval() const = 0;
+
+        // Whether each worker thread should be bound to a single core.
+        virtual bool pinThreads() const = 0;
+
+        // The maximum allowable depth of recursion for tasks scheduled with the MayRecurse flag
+        // before stack unwinding is forced.
+        virtual int recursionLimit() const = 0;
+    };
+
+    /**
+     * Returns the number of worker threads (and therefore io_contexts) configured through the
+     * server parameters. This defaults to the number of available cores.
+     */
+    static size_t configuredThreadCount();
+
+    ServiceExecutorThreadPerCore(ServiceContext* ctx,
+                                 std::vector<std::shared_ptr<asio::io_context>> ioContexts);
+    ServiceExecutorThreadPerCore(ServiceContext* ctx,
+                                 std::vector<std::shared_ptr<asio::io_context>> ioContexts,
+                                 std::unique_ptr<Options> config);
+
+    virtual ~ServiceExecutorThreadPerCore();
+
+    Status start() final;
+    Status shutdown(Milliseconds timeout) final;
+    Status schedule(Task task, ScheduleFlags flags) final;
+
+    Mode transportMode() const final {
+        return Mode::kAsynchronous;
+    }
+
+    void appendStats(BSONObjBuilder* bob) const final;
+
+    int threadsRunning() const {
+        return _threadsRunning.load();
+    }
+
+private:
+    void _workerThreadRoutine(size_t index);
+    bool _stealOne(size_t index);
+    asio::io_context& _contextForSchedule();
+
+    const std::vector<std::shared_ptr<asio::io_context>> _ioContexts;
+
+    std::unique_ptr<Options> _config;
+
+    TickSource* const _tickSource;
+    AtomicWord<bool> _isRunning{false};
+
+    // Used to spread tasks scheduled from outside of the worker threads across the io_contexts.
+    AtomicWord<unsigned> _nextContext{0};
+
+    // The executor the current thread is a worker of, and the index of the io_context it is
+    // currently running handlers for. These are null and -1 on other threads.
+    static thread_local const ServiceExecutorThreadPerCore* _localExecutor;
+    static thread_local int _localContextIndex;
+    static thread_local int _localRecursionDepth;
+
+    AtomicWord<int> _threadsRunning{0};
+    AtomicWord<int> _tasksExecuting{0};
+    AtomicWord<int> _tasksQueued{0};
+
+    // These counters are only used for reporting in serverStatus.
+    AtomicWord<int64_t> _totalQueued{0};
+    AtomicWord<int64_t> _totalExecuted{0};
+    AtomicWord<int64_t> _totalStolen{0};
+    AtomicWord<TickSource::Tick> _totalSpentQueued{0};
+
+    // Threads signal this condition variable when they exit so we can gracefully shutdown
+    // the executor.
+    stdx::mutex _threadsMutex;
+    stdx::condition_variable _deathCondition;
+};
+
+}  // namespace transport
+}  // namespace mongo
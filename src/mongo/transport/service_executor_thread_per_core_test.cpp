@@ -0,0 +1,149 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault;
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/service_context_noop.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/service_executor_thread_per_core.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
+
+#include <asio.hpp>
+
+namespace mongo {
+namespace {
+using namespace transport;
+
+struct TestOptions : public ServiceExecutorThreadPerCore::Options {
+    Milliseconds stealInterval() const final {
+        return Milliseconds{1};
+    }
+
+    bool pinThreads() const final {
+        return false;
+    }
+
+    int recursionLimit() const final {
+        return 8;
+    }
+};
+
+class ServiceExecutorThreadPerCoreFixture : public unittest::Test {
+protected:
+    void setUp() override {
+        setGlobalServiceContext(stdx::make_unique<ServiceContextNoop>());
+        for (int i = 0; i < 2; i++) {
+            ioContexts.emplace_back(std::make_shared<asio::io_context>());
+        }
+    }
+
+    std::unique_ptr<ServiceExecutorThreadPerCore> makeAndStartExecutor() {
+        auto exec = stdx::make_unique<ServiceExecutorThreadPerCore>(
+            getGlobalServiceContext(), ioContexts, stdx::make_unique<TestOptions>());
+        ASSERT_OK(exec->start());
+        return exec;
+    }
+
+    std::vector<std::shared_ptr<asio::io_context>> ioContexts;
+
+    stdx::mutex mutex;
+    stdx::condition_variable cond;
+};
+
+TEST_F(ServiceExecutorThreadPerCoreFixture, RunsScheduledTasks) {
+    auto exec = makeAndStartExecutor();
+    auto guard = MakeGuard([&] { ASSERT_OK(exec->shutdown(Milliseconds{5000})); });
+    ASSERT_EQ(2, exec->threadsRunning());
+
+    int tasksRun = 0;
+    for (int i = 0; i < 10; i++) {
+        ASSERT_OK(exec->schedule(
+            [&] {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                tasksRun++;
+                cond.notify_one();
+            },
+            ServiceExecutor::kEmptyFlags));
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    ASSERT_TRUE(cond.wait_for(lk, Seconds{10}.toSystemDuration(), [&] { return tasksRun == 10; }));
+}
+
+/*
+ * This tests that work queued on the io_context of a worker thread which is blocked in a long
+ * running task gets picked up by the other worker thread.
+ */
+TEST_F(ServiceExecutorThreadPerCoreFixture, IdleWorkerStealsFromBlockedWorker) {
+    auto exec = makeAndStartExecutor();
+
+    bool blocked = true;
+    auto guard = MakeGuard([&] {
+        {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            blocked = false;
+            cond.notify_all();
+        }
+        ASSERT_OK(exec->shutdown(Milliseconds{5000}));
+    });
+
+    boost::optional<stdx::thread::id> blockedThread;
+    ioContexts[0]->post([&] {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        blockedThread = stdx::this_thread::get_id();
+        cond.notify_all();
+        cond.wait(lk, [&] { return !blocked; });
+    });
+
+    {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        ASSERT_TRUE(
+            cond.wait_for(lk, Seconds{10}.toSystemDuration(), [&] { return bool(blockedThread); }));
+    }
+
+    boost::optional<stdx::thread::id> stealingThread;
+    ioContexts[0]->post([&] {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        stealingThread = stdx::this_thread::get_id();
+        cond.notify_all();
+    });
+
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    ASSERT_TRUE(
+        cond.wait_for(lk, Seconds{10}.toSystemDuration(), [&] { return bool(stealingThread); }));
+    ASSERT_NOT_EQUALS(*blockedThread, *stealingThread);
+}
+
+}  // namespace
+}  // namespace mongo
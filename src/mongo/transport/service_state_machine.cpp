@@ -273,6 +273,13 @@ void ServiceStateMachine::_sinkCallback(Status status) {
         _state.store(State::Process);
     } else {
         _state.store(State::Source);
+
+        // If the client pipelined its next request behind this one, it is already waiting in the
+        // socket buffer and the opportunistic read in sourceMessage() will complete immediately,
+        // so go straight to it on this thread instead of yielding first.
+        if (_session()->hasPendingInput()) {
+            return scheduleNext(ServiceExecutor::kMayRecurse);
+        }
     }
 
     return scheduleNext(ServiceExecutor::kDeferredTask | ServiceExecutor::kMayYieldBeforeSchedule);
@@ -116,6 +116,15 @@ public:
      */
     virtual const HostAndPort& local() const = 0;
 
+    /**
+     * Returns true if the peer has already sent bytes which have not been sourced yet, i.e. it
+     * pipelined its next request behind the one being processed. This is only a scheduling hint
+     * and transport layers which cannot tell cheaply return false.
+     */
+    virtual bool hasPendingInput() {
+        return false;
+    }
+
     /**
      * Set this session's tags. This Session will register
      * its new tags with its TransportLayer.
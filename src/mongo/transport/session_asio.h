@@ -87,6 +87,11 @@ public:
         return _local;
     }
 
+    bool hasPendingInput() override {
+        std::error_code ec;
+        return getSocket().available(ec) > 0 && !ec;
+    }
+
     GenericSocket& getSocket() {
 #ifdef MONGO_CONFIG_SSL
         if (_sslSocket) {
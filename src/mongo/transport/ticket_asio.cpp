@@ -110,7 +110,13 @@ void TransportLayerASIO::ASIOSourceTicket::_headerCallback(const std::error_code
         return;
     }
 
-    _buffer.realloc(msgLen);
+    // Most messages fit in the buffer the header was read into. Otherwise move the header into a
+    // buffer which is large enough for the whole message.
+    if (msgLen > _buffer.capacity()) {
+        auto buffer = SharedBuffer::allocatePooled(msgLen);
+        memcpy(buffer.get(), _buffer.get(), kHeaderSize);
+        _buffer = std::move(buffer);
+    }
     MsgData::View msgView(_buffer.get());
 
     session->read(isSync(),
@@ -123,8 +129,10 @@ void TransportLayerASIO::ASIOSourceTicket::fillImpl() {
     if (!session)
         return;
 
+    // Incoming messages come from a pool of buffers which is recycled as each request completes, so
+    // that a busy session does not need a fresh allocation per message.
     const auto initBufSize = kHeaderSize;
-    _buffer = SharedBuffer::allocate(initBufSize);
+    _buffer = SharedBuffer::allocatePooled(initBufSize);
 
     session->read(isSync(),
                   asio::buffer(_buffer.get(), initBufSize),
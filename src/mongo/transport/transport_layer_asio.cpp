@@ -32,6 +32,8 @@
 
 #include "mongo/transport/transport_layer_asio.h"
 
+#include <algorithm>
+
 #include "boost/algorithm/string.hpp"
 
 #include "asio.hpp"
@@ -75,13 +77,16 @@ TransportLayerASIO::Options::Options(const ServerGlobalParams* params)
 
 TransportLayerASIO::TransportLayerASIO(const TransportLayerASIO::Options& opts,
                                        ServiceEntryPoint* sep)
-    : _workerIOContext(std::make_shared<asio::io_context>()),
-      _acceptorIOContext(stdx::make_unique<asio::io_context>()),
+    : _acceptorIOContext(stdx::make_unique<asio::io_context>()),
 #ifdef MONGO_CONFIG_SSL
       _sslContext(nullptr),
 #endif
       _sep(sep),
       _listenerOptions(opts) {
+    const auto numWorkerIOContexts = std::max(opts.workerIOContexts, size_t(1));
+    for (size_t i = 0; i < numWorkerIOContexts; i++) {
+        _workerIOContexts.emplace_back(std::make_shared<asio::io_context>());
+    }
 }
 
 TransportLayerASIO::~TransportLayerASIO() = default;
@@ -282,7 +287,11 @@ void TransportLayerASIO::shutdown() {
 }
 
 const std::shared_ptr<asio::io_context>& TransportLayerASIO::getIOContext() {
-    return _workerIOContext;
+    return _workerIOContexts.front();
+}
+
+const std::vector<std::shared_ptr<asio::io_context>>& TransportLayerASIO::getIOContexts() {
+    return _workerIOContexts;
 }
 
 void TransportLayerASIO::_acceptConnection(GenericAcceptor& acceptor) {
@@ -303,7 +312,9 @@ void TransportLayerASIO::_acceptConnection(GenericAcceptor& acceptor) {
         _acceptConnection(acceptor);
     };
 
-    acceptor.async_accept(*_workerIOContext, std::move(acceptCb));
+    auto& workerIOContext =
+        *_workerIOContexts[_nextWorkerIOContext.fetchAndAdd(1) % _workerIOContexts.size()];
+    acceptor.async_accept(workerIOContext, std::move(acceptCb));
 }
 
 }  // namespace transport
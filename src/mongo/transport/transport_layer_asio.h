@@ -30,9 +30,11 @@
 
 #include <functional>
 #include <string>
+#include <vector>
 
 #include "mongo/config.h"
 #include "mongo/db/server_options.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
@@ -85,6 +87,8 @@ public:
         Mode transportMode = Mode::kSynchronous;  // whether accepted sockets should be put into
                                                   // non-blocking mode after they're accepted
         size_t maxConns = DEFAULT_MAX_CONN;       // maximum number of active connections
+        size_t workerIOContexts = 1;              // number of io_contexts to spread accepted
+                                                  // sockets across
     };
 
     TransportLayerASIO(const Options& opts, ServiceEntryPoint* sep);
@@ -112,6 +116,12 @@ public:
 
     const std::shared_ptr<asio::io_context>& getIOContext();
 
+    /**
+     * Returns all of the io_contexts accepted sockets are assigned to. The first one is the same
+     * as returned by getIOContext().
+     */
+    const std::vector<std::shared_ptr<asio::io_context>>& getIOContexts();
+
 private:
     class ASIOSession;
     class ASIOTicket;
@@ -126,11 +136,13 @@ private:
 
     stdx::mutex _mutex;
 
-    // There are two IO contexts that are used by TransportLayerASIO. The _workerIOContext
-    // contains all the accepted sockets and all normal networking activity. The
-    // _acceptorIOContext contains all the sockets in _acceptors.
+    // There are two kinds of IO contexts that are used by TransportLayerASIO. The
+    // _workerIOContexts contain all the accepted sockets and all normal networking activity. There
+    // is normally a single one, but a ServiceExecutor may ask for several so that each of its
+    // threads services its own set of sockets. The _acceptorIOContext contains all the sockets in
+    // _acceptors.
     //
-    // TransportLayerASIO should never call run() on the _workerIOContext.
+    // TransportLayerASIO should never call run() on the _workerIOContexts.
     // In synchronous mode, this will cause a massive performance degradation due to
     // unnecessary wakeups on the asio thread for sockets we don't intend to interact
     // with asynchronously. The additional IO context avoids registering those sockets
@@ -149,9 +161,12 @@ private:
     // the io_context), so that we destroy any existing acceptors or
     // other io_service associated state before we drop the refcount
     // on the io_context, which may destroy it.
-    std::shared_ptr<asio::io_context> _workerIOContext;
+    std::vector<std::shared_ptr<asio::io_context>> _workerIOContexts;
     std::unique_ptr<asio::io_context> _acceptorIOContext;
 
+    // The worker io_context the next accepted socket will be assigned to.
+    AtomicWord<size_t> _nextWorkerIOContext{0};
+
 #ifdef MONGO_CONFIG_SSL
     std::unique_ptr<asio::ssl::context> _sslContext;
     SSLParams::SSLModes _sslMode;
@@ -36,6 +36,7 @@
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/service_executor_adaptive.h"
 #include "mongo/transport/service_executor_synchronous.h"
+#include "mongo/transport/service_executor_thread_per_core.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/transport_layer_asio.h"
 #include "mongo/transport/transport_layer_legacy.h"
@@ -132,6 +133,9 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
         transport::TransportLayerASIO::Options opts(config);
         if (config->serviceExecutor == "adaptive") {
             opts.transportMode = transport::Mode::kAsynchronous;
+        } else if (config->serviceExecutor == "threadPerCore") {
+            opts.transportMode = transport::Mode::kAsynchronous;
+            opts.workerIOContexts = ServiceExecutorThreadPerCore::configuredThreadCount();
         } else if (config->serviceExecutor == "synchronous") {
             opts.transportMode = transport::Mode::kSynchronous;
         } else {
@@ -143,6 +147,9 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
         if (config->serviceExecutor == "adaptive") {
             ctx->setServiceExecutor(stdx::make_unique<ServiceExecutorAdaptive>(
                 ctx, transportLayerASIO->getIOContext()));
+        } else if (config->serviceExecutor == "threadPerCore") {
+            ctx->setServiceExecutor(stdx::make_unique<ServiceExecutorThreadPerCore>(
+                ctx, transportLayerASIO->getIOContexts()));
         } else if (config->serviceExecutor == "synchronous") {
             ctx->setServiceExecutor(stdx::make_unique<ServiceExecutorSynchronous>(ctx));
         }
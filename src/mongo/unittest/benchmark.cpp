@@ -0,0 +1,219 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/unittest/benchmark.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace benchmark {
+namespace {
+
+// Upper bound on the iterations of a single run, however fast the loop body.
+const uint64_t kMaxIterations = 1000 * 1000 * 1000;
+
+std::vector<std::unique_ptr<Benchmark>>& registeredBenchmarks() {
+    static auto benchmarks = new std::vector<std::unique_ptr<Benchmark>>();
+    return *benchmarks;
+}
+
+std::string runName(const Benchmark& benchmark, int64_t arg) {
+    if (benchmark.args().empty()) {
+        return benchmark.name();
+    }
+    return benchmark.name() + "/" + std::to_string(arg);
+}
+
+Result aggregateResults(const std::vector<Result>& repetitions, const std::string& aggregate) {
+    Result result;
+    result.name = repetitions.front().name + "_" + aggregate;
+    result.aggregate = aggregate;
+
+    const auto aggregateField = [&](double Result::*field) {
+        std::vector<double> values;
+        for (const auto& repetition : repetitions) {
+            values.push_back(repetition.*field);
+        }
+        if (aggregate == "mean") {
+            double sum = 0;
+            for (auto value : values) {
+                sum += value;
+            }
+            result.*field = sum / values.size();
+        } else {
+            std::sort(values.begin(), values.end());
+            const size_t middle = values.size() / 2;
+            result.*field = values.size() % 2 ? values[middle]
+                                              : (values[middle - 1] + values[middle]) / 2;
+        }
+    };
+
+    for (const auto& repetition : repetitions) {
+        result.iterations += repetition.iterations;
+    }
+    result.iterations /= repetitions.size();
+    aggregateField(&Result::realNanosPerIteration);
+    aggregateField(&Result::cpuNanosPerIteration);
+    aggregateField(&Result::itemsPerSecond);
+    aggregateField(&Result::bytesPerSecond);
+    return result;
+}
+
+}  // namespace
+
+State::Iterator State::begin() {
+    invariant(!_started);
+    _started = true;
+    resumeTiming();
+    return Iterator(this, _iterations);
+}
+
+void State::pauseTiming() {
+    invariant(_timing);
+    _realElapsed += stdx::chrono::steady_clock::now() - _realStart;
+    _cpuElapsedSeconds += static_cast<double>(std::clock() - _cpuStart) / CLOCKS_PER_SEC;
+    _timing = false;
+}
+
+void State::resumeTiming() {
+    invariant(!_timing);
+    _timing = true;
+    _cpuStart = std::clock();
+    _realStart = stdx::chrono::steady_clock::now();
+}
+
+void State::_finish() {
+    pauseTiming();
+    _finished = true;
+}
+
+Benchmark* Benchmark::range(int64_t start, int64_t limit) {
+    invariant(0 <= start && start <= limit);
+    arg(start);
+    for (int64_t value = 8; value < limit; value *= 8) {
+        if (value > start) {
+            arg(value);
+        }
+    }
+    if (limit != start) {
+        arg(limit);
+    }
+    return this;
+}
+
+Benchmark* registerBenchmark(std::string name, Benchmark::Function function) {
+    registeredBenchmarks().push_back(stdx::make_unique<Benchmark>(std::move(name), function));
+    return registeredBenchmarks().back().get();
+}
+
+std::vector<std::string> Runner::listNames() {
+    std::vector<std::string> names;
+    for (const auto& benchmark : registeredBenchmarks()) {
+        if (benchmark->args().empty()) {
+            names.push_back(runName(*benchmark, 0));
+        }
+        for (auto arg : benchmark->args()) {
+            names.push_back(runName(*benchmark, arg));
+        }
+    }
+    return names;
+}
+
+std::vector<Result> Runner::run(void (*onResult)(const Result&)) const {
+    std::vector<Result> results;
+    for (const auto& benchmark : registeredBenchmarks()) {
+        auto args = benchmark->args();
+        if (args.empty()) {
+            args.push_back(0);
+        }
+
+        for (auto arg : args) {
+            const auto name = runName(*benchmark, arg);
+            if (name.find(_options.filter) == std::string::npos) {
+                continue;
+            }
+
+            std::vector<Result> repetitions;
+            for (int i = 0; i < std::max(1, _options.repetitions); ++i) {
+                repetitions.push_back(_runOnce(*benchmark, name, arg));
+                onResult(repetitions.back());
+            }
+            results.insert(results.end(), repetitions.begin(), repetitions.end());
+
+            if (repetitions.size() > 1) {
+                for (auto aggregate : {"mean", "median"}) {
+                    results.push_back(aggregateResults(repetitions, aggregate));
+                    onResult(results.back());
+                }
+            }
+        }
+    }
+    return results;
+}
+
+Result Runner::_runOnce(const Benchmark& benchmark, const std::string& name, int64_t arg) const {
+    uint64_t iterations = 1;
+    while (true) {
+        State state(iterations, arg);
+        benchmark.function()(state);
+        invariant(state._finished);
+
+        const double realSeconds =
+            stdx::chrono::duration<double>(state._realElapsed).count();
+        if (realSeconds >= _options.minSeconds || iterations >= kMaxIterations) {
+            Result result;
+            result.name = name;
+            result.iterations = iterations;
+            result.realNanosPerIteration = realSeconds * 1e9 / iterations;
+            result.cpuNanosPerIteration = state._cpuElapsedSeconds * 1e9 / iterations;
+            if (realSeconds > 0) {
+                result.itemsPerSecond = state._itemsProcessed / realSeconds;
+                result.bytesPerSecond = state._bytesProcessed / realSeconds;
+            }
+            return result;
+        }
+
+        // Aim a little past the minimum time, but don't trust short runs to predict long ones.
+        double multiplier = _options.minSeconds * 1.4 / std::max(realSeconds, 1e-9);
+        if (realSeconds < _options.minSeconds / 10) {
+            multiplier = 10;
+        }
+        iterations = std::min(kMaxIterations,
+                              std::max(iterations + 1,
+                                       static_cast<uint64_t>(iterations * multiplier)));
+    }
+}
+
+}  // namespace benchmark
+}  // namespace mongo
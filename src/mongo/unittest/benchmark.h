@@ -0,0 +1,280 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * A small harness for microbenchmarks of hot code paths, shaped after Google Benchmark.
+ *
+ * A benchmark is a function taking a benchmark::State, which runs the code to measure once per
+ * iteration of a range-based for loop over the state:
+ *
+ *     void BM_validateBSON(benchmark::State& state) {
+ *         BSONObj doc = makeFixedDocument(state.arg());
+ *         for (auto _ : state) {
+ *             benchmark::doNotOptimizeAway(validateBSON(doc.objdata(), doc.objsize(), ...));
+ *         }
+ *         state.setBytesProcessed(state.iterations() * doc.objsize());
+ *     }
+ *     BENCHMARK(BM_validateBSON)->arg(10)->arg(1000);
+ *
+ * The harness picks the number of iterations so that each run lasts long enough to time
+ * reliably. Benchmarks should work on fixed datasets, so that results from different builds can
+ * be compared against each other.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/compiler.h"
+#include "mongo/stdx/chrono.h"
+
+/**
+ * Registers "fn", a function taking a benchmark::State&, as a benchmark named after it. Returns a
+ * benchmark::Benchmark* which can be used to add arguments.
+ */
+#define BENCHMARK(fn)                                                                   \
+    static ::mongo::benchmark::Benchmark* const MONGO_BENCHMARK_CONCAT_(_mongoBenchmark_, \
+                                                                        __LINE__) =       \
+        ::mongo::benchmark::registerBenchmark(#fn, fn)
+
+#define MONGO_BENCHMARK_CONCAT_(a, b) MONGO_BENCHMARK_CONCAT2_(a, b)
+#define MONGO_BENCHMARK_CONCAT2_(a, b) a##b
+
+namespace mongo {
+namespace benchmark {
+
+/**
+ * Prevents the compiler from optimizing away the computation of "value".
+ */
+template <typename T>
+inline void doNotOptimizeAway(const T& value) {
+#if defined(_MSC_VER)
+    static volatile const void* sink;
+    sink = &value;
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+/**
+ * The state of one run of a benchmark. Iterating over it times the loop body.
+ */
+class State {
+    MONGO_DISALLOW_COPYING(State);
+
+public:
+    struct MONGO_COMPILER_VARIABLE_UNUSED Value {};
+
+    class Iterator {
+    public:
+        Iterator(State* state, uint64_t remaining) : _state(state), _remaining(remaining) {}
+
+        Value operator*() const {
+            return {};
+        }
+
+        Iterator& operator++() {
+            --_remaining;
+            return *this;
+        }
+
+        bool operator!=(const Iterator&) const {
+            if (MONGO_likely(_remaining != 0)) {
+                return true;
+            }
+            _state->_finish();
+            return false;
+        }
+
+    private:
+        State* _state;
+        uint64_t _remaining;
+    };
+
+    State(uint64_t iterations, int64_t arg) : _iterations(iterations), _arg(arg) {}
+
+    /**
+     * Starts the clock. A State may only be iterated over once.
+     */
+    Iterator begin();
+
+    Iterator end() {
+        return Iterator(nullptr, 0);
+    }
+
+    /**
+     * Stops and restarts the clock around work that should not count towards the results, such as
+     * resetting the dataset between iterations. Both are expensive compared to a fast loop body.
+     */
+    void pauseTiming();
+    void resumeTiming();
+
+    /**
+     * Number of iterations in this run.
+     */
+    uint64_t iterations() const {
+        return _iterations;
+    }
+
+    /**
+     * The argument this run was registered with, or 0 if the benchmark takes none.
+     */
+    int64_t arg() const {
+        return _arg;
+    }
+
+    /**
+     * Report a throughput alongside the time per iteration. Both are totals across every
+     * iteration of the run.
+     */
+    void setItemsProcessed(int64_t items) {
+        _itemsProcessed = items;
+    }
+    void setBytesProcessed(int64_t bytes) {
+        _bytesProcessed = bytes;
+    }
+
+private:
+    friend class Runner;
+
+    void _finish();
+
+    const uint64_t _iterations;
+    const int64_t _arg;
+
+    bool _started = false;
+    bool _finished = false;
+    bool _timing = false;
+
+    stdx::chrono::steady_clock::time_point _realStart;
+    std::clock_t _cpuStart = 0;
+    stdx::chrono::nanoseconds _realElapsed{0};
+    double _cpuElapsedSeconds = 0;
+
+    int64_t _itemsProcessed = 0;
+    int64_t _bytesProcessed = 0;
+};
+
+/**
+ * A registered benchmark, and the arguments to run it with.
+ */
+class Benchmark {
+    MONGO_DISALLOW_COPYING(Benchmark);
+
+public:
+    using Function = void (*)(State&);
+
+    Benchmark(std::string name, Function function)
+        : _name(std::move(name)), _function(function) {}
+
+    /**
+     * Adds a run with "value" as its State::arg(). Without any, the benchmark runs once with 0.
+     */
+    Benchmark* arg(int64_t value) {
+        _args.push_back(value);
+        return this;
+    }
+
+    /**
+     * Adds runs with "start", "limit", and the powers of 8 between them as their arguments.
+     */
+    Benchmark* range(int64_t start, int64_t limit);
+
+    const std::string& name() const {
+        return _name;
+    }
+
+    Function function() const {
+        return _function;
+    }
+
+    const std::vector<int64_t>& args() const {
+        return _args;
+    }
+
+private:
+    const std::string _name;
+    const Function _function;
+    std::vector<int64_t> _args;
+};
+
+Benchmark* registerBenchmark(std::string name, Benchmark::Function function);
+
+/**
+ * The measurements from one run of a benchmark.
+ */
+struct Result {
+    // The benchmark name, followed by "/<arg>" if it was registered with arguments.
+    std::string name;
+
+    // Set for the mean and median across repetitions, in which case "name" ends with
+    // "_<aggregate>".
+    std::string aggregate;
+
+    uint64_t iterations = 0;
+    double realNanosPerIteration = 0;
+    double cpuNanosPerIteration = 0;
+    double itemsPerSecond = 0;
+    double bytesPerSecond = 0;
+};
+
+struct RunOptions {
+    // Only benchmarks whose names contain this substring run.
+    std::string filter;
+
+    // Each run is repeated with more iterations until it lasts at least this long.
+    double minSeconds = 0.5;
+
+    // With more than one repetition, the mean and median of the repetitions are reported too.
+    int repetitions = 1;
+};
+
+/**
+ * Runs every registered benchmark selected by "options", reporting each result to "onResult" as
+ * it becomes available.
+ */
+class Runner {
+public:
+    explicit Runner(RunOptions options) : _options(std::move(options)) {}
+
+    std::vector<Result> run(void (*onResult)(const Result&)) const;
+
+    static std::vector<std::string> listNames();
+
+private:
+    Result _runOnce(const Benchmark& benchmark, const std::string& name, int64_t arg) const;
+
+    const RunOptions _options;
+};
+
+}  // namespace benchmark
+}  // namespace mongo
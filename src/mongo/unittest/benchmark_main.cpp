@@ -0,0 +1,200 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "mongo/base/initializer.h"
+#include "mongo/base/status.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/benchmark.h"
+#include "mongo/util/debug_util.h"
+#include "mongo/util/options_parser/environment.h"
+#include "mongo/util/options_parser/option_section.h"
+#include "mongo/util/options_parser/options_parser.h"
+#include "mongo/util/signal_handlers_synchronous.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/version.h"
+
+using mongo::Status;
+
+namespace {
+
+void printResult(const mongo::benchmark::Result& result) {
+    std::printf("%-60s %14.1f ns %14.1f ns %12llu",
+                result.name.c_str(),
+                result.realNanosPerIteration,
+                result.cpuNanosPerIteration,
+                static_cast<unsigned long long>(result.iterations));
+    if (result.itemsPerSecond > 0) {
+        std::printf(" %12.4g items/s", result.itemsPerSecond);
+    }
+    if (result.bytesPerSecond > 0) {
+        std::printf(" %12.4g bytes/s", result.bytesPerSecond);
+    }
+    std::printf("\n");
+    std::fflush(stdout);
+}
+
+void ignoreResult(const mongo::benchmark::Result&) {}
+
+/**
+ * Reports results in the same layout as Google Benchmark's JSON output, along with the version and
+ * build type of the server code under test, so that runs from different builds can be compared.
+ */
+std::string resultsToJson(const char* executable,
+                          const std::vector<mongo::benchmark::Result>& results) {
+    using namespace mongo;
+
+    const auto& versionInfo = VersionInfoInterface::instance();
+
+    BSONObjBuilder builder;
+    {
+        BSONObjBuilder context(builder.subobjStart("context"));
+        context.append("date", dateToISOStringUTC(Date_t::now()));
+        context.append("executable", executable);
+        context.append("num_cpus", static_cast<int>(stdx::thread::hardware_concurrency()));
+        context.append("library_build_type", kDebugBuild ? "debug" : "release");
+        context.append("mongodb_version", versionInfo.version());
+        context.append("mongodb_git_version", versionInfo.gitVersion());
+    }
+    {
+        BSONArrayBuilder benchmarks(builder.subarrayStart("benchmarks"));
+        for (const auto& result : results) {
+            BSONObjBuilder entry(benchmarks.subobjStart());
+            entry.append("name", result.name);
+            if (!result.aggregate.empty()) {
+                entry.append("aggregate_name", result.aggregate);
+            }
+            entry.append("iterations", static_cast<long long>(result.iterations));
+            entry.append("real_time", result.realNanosPerIteration);
+            entry.append("cpu_time", result.cpuNanosPerIteration);
+            entry.append("time_unit", "ns");
+            if (result.itemsPerSecond > 0) {
+                entry.append("items_per_second", result.itemsPerSecond);
+            }
+            if (result.bytesPerSecond > 0) {
+                entry.append("bytes_per_second", result.bytesPerSecond);
+            }
+        }
+    }
+    return builder.obj().jsonString(Strict, 1);
+}
+
+}  // namespace
+
+int main(int argc, char** argv, char** envp) {
+    ::mongo::clearSignalMask();
+    ::mongo::setupSynchronousSignalHandlers();
+    ::mongo::runGlobalInitializersOrDie(argc, argv, envp);
+
+    namespace moe = ::mongo::optionenvironment;
+    moe::OptionsParser parser;
+    moe::Environment environment;
+    moe::OptionSection options;
+    std::map<std::string, std::string> env;
+
+    // Register our allowed options with our OptionSection
+    auto listDesc = "List all benchmarks in this executable.";
+    options.addOptionChaining("list", "list", moe::Switch, listDesc).setDefault(moe::Value(false));
+
+    auto filterDesc = "Benchmark name filter. Specify a substring of the benchmark names.";
+    options.addOptionChaining("filter", "filter", moe::String, filterDesc);
+
+    auto minTimeDesc = "Minimum number of seconds each benchmark run should last.";
+    options.addOptionChaining("minTime", "minTime", moe::Double, minTimeDesc)
+        .setDefault(moe::Value(0.5));
+
+    auto repetitionsDesc = "Number of times to run each benchmark.";
+    options.addOptionChaining("repetitions", "repetitions", moe::Int, repetitionsDesc)
+        .setDefault(moe::Value(1));
+
+    auto jsonDesc = "Print results as JSON instead of as a table.";
+    options.addOptionChaining("json", "json", moe::Switch, jsonDesc).setDefault(moe::Value(false));
+
+    auto outDesc = "File to also write the results to, as JSON.";
+    options.addOptionChaining("out", "out", moe::String, outDesc);
+
+    std::vector<std::string> argVector(argv, argv + argc);
+    Status ret = parser.run(options, argVector, env, &environment);
+    if (!ret.isOK()) {
+        std::cerr << options.helpString();
+        return EXIT_FAILURE;
+    }
+
+    bool list = false;
+    bool json = false;
+    std::string out;
+    ::mongo::benchmark::RunOptions runOptions;
+    // "list", "json", "minTime" and "repetitions" will be assigned with default values, if not
+    // present.
+    invariantOK(environment.get("list", &list));
+    invariantOK(environment.get("json", &json));
+    invariantOK(environment.get("minTime", &runOptions.minSeconds));
+    invariantOK(environment.get("repetitions", &runOptions.repetitions));
+    // The default values of "filter" and "out" are empty.
+    environment.get("filter", &runOptions.filter).ignore();
+    environment.get("out", &out).ignore();
+
+    if (list) {
+        for (const auto& name : ::mongo::benchmark::Runner::listNames()) {
+            std::cout << name << std::endl;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (!json) {
+        std::printf("%-60s %17s %17s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+    }
+
+    const auto results =
+        ::mongo::benchmark::Runner(runOptions).run(json ? ignoreResult : printResult);
+
+    if (json || !out.empty()) {
+        const auto report = resultsToJson(argv[0], results);
+        if (json) {
+            std::cout << report << std::endl;
+        }
+        if (!out.empty()) {
+            std::ofstream file(out.c_str());
+            file << report << std::endl;
+            if (!file) {
+                std::cerr << "Failed to write benchmark results to " << out << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
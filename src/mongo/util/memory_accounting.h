@@ -0,0 +1,103 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+/**
+ * Subsystems whose memory is tallied separately and reported in the "memoryAccounts" section of
+ * serverStatus, and through it FTDC. Each tally is what its subsystem currently holds, not what
+ * it has ever allocated. To add one, insert it before kNumTags and name it in
+ * memory_accounting.cpp.
+ */
+enum class MemoryAccountTag {
+    kPlanCache,        // Estimated size of plan cache entries.
+    kSorter,           // Data buffered in memory by Sorter, before it spills or is returned.
+    kCursorBuffers,    // Results mongos has received from shards but not yet returned.
+    kNetworkBuffers,   // Pooled SharedBuffers, which carry incoming and decompressed messages.
+    kDocumentBuffers,  // Freed Document buffers kept in per-thread caches for reuse.
+    kNumTags,
+};
+
+/**
+ * Adds 'delta' bytes, which may be negative, to the tally for 'tag'.
+ */
+void chargeMemoryAccount(MemoryAccountTag tag, long long delta);
+
+/**
+ * Returns the bytes currently charged to 'tag'.
+ */
+long long getMemoryAccountBytes(MemoryAccountTag tag);
+
+/**
+ * Appends the bytes charged to each account, by name.
+ */
+void appendMemoryAccounts(BSONObjBuilder* builder);
+
+/**
+ * Tracks the bytes one owner holds against an account, and refunds them when destroyed.
+ */
+class MemoryCharge {
+    MONGO_DISALLOW_COPYING(MemoryCharge);
+
+public:
+    explicit MemoryCharge(MemoryAccountTag tag) : _tag(tag) {}
+
+    ~MemoryCharge() {
+        set(0);
+    }
+
+    /**
+     * Records that the owner now holds 'bytes', charging or refunding the difference.
+     */
+    void set(long long bytes) {
+        if (bytes != _bytes) {
+            chargeMemoryAccount(_tag, bytes - _bytes);
+            _bytes = bytes;
+        }
+    }
+
+    void add(long long delta) {
+        set(_bytes + delta);
+    }
+
+    long long bytes() const {
+        return _bytes;
+    }
+
+private:
+    const MemoryAccountTag _tag;
+    long long _bytes = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,143 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/shared_buffer.h"
+
+#include <array>
+#include <cstdlib>
+#include <vector>
+
+#include "mongo/util/memory_accounting.h"
+
+namespace mongo {
+namespace {
+
+constexpr size_t kNumSizeClasses = 7;  // 1KB to 64KB
+
+// Limits on how much memory each thread keeps cached. These are deliberately small since the
+// synchronous service executor runs a thread per connection, and a single session only ever has a
+// couple of incoming buffers alive at once.
+constexpr size_t kMaxBuffersPerSizeClass = 2;
+constexpr size_t kMaxCachedBytesPerThread = 64 * 1024;
+
+size_t sizeClassIndex(size_t bytes) {
+    size_t index = 0;
+    for (size_t classSize = SharedBuffer::kMinPooledSize; classSize < bytes; classSize <<= 1) {
+        ++index;
+    }
+    return index;
+}
+
+size_t sizeClassCapacity(size_t index) {
+    return SharedBuffer::kMinPooledSize << index;
+}
+
+class ThreadBufferCache {
+public:
+    ~ThreadBufferCache();
+
+    void* take(size_t index) {
+        auto& freeList = _freeLists[index];
+        if (freeList.empty()) {
+            return nullptr;
+        }
+
+        void* memory = freeList.back();
+        freeList.pop_back();
+        _cachedBytes -= sizeClassCapacity(index);
+        return memory;
+    }
+
+    bool give(size_t index, void* memory) {
+        auto& freeList = _freeLists[index];
+        const auto capacity = sizeClassCapacity(index);
+        if (freeList.size() >= kMaxBuffersPerSizeClass ||
+            _cachedBytes + capacity > kMaxCachedBytesPerThread) {
+            return false;
+        }
+
+        freeList.push_back(memory);
+        _cachedBytes += capacity;
+        return true;
+    }
+
+private:
+    std::array<std::vector<void*>, kNumSizeClasses> _freeLists;
+    size_t _cachedBytes = 0;
+};
+
+// Buffers may be released by thread-local destructors running after the cache itself has been
+// destroyed, in which case they are simply freed.
+thread_local bool threadBufferCacheDestroyed = false;
+thread_local ThreadBufferCache threadBufferCache;
+
+ThreadBufferCache::~ThreadBufferCache() {
+    threadBufferCacheDestroyed = true;
+    for (auto& freeList : _freeLists) {
+        for (void* memory : freeList) {
+            free(memory);
+        }
+    }
+}
+
+}  // namespace
+
+constexpr size_t SharedBuffer::kMinPooledSize;
+constexpr size_t SharedBuffer::kMaxPooledSize;
+
+SharedBuffer SharedBuffer::allocatePooled(size_t bytes) {
+    // Buffers too large to cache are still flagged as pooled, so that they are counted against
+    // the network buffer account until released.
+    if (bytes > kMaxPooledSize) {
+        chargeMemoryAccount(MemoryAccountTag::kNetworkBuffers, bytes);
+        return takeOwnership(mongoMalloc(sizeof(Holder) + bytes), bytes, true);
+    }
+
+    const auto index = sizeClassIndex(bytes);
+    const auto capacity = sizeClassCapacity(index);
+    chargeMemoryAccount(MemoryAccountTag::kNetworkBuffers, capacity);
+
+    void* memory = threadBufferCacheDestroyed ? nullptr : threadBufferCache.take(index);
+    if (!memory) {
+        memory = mongoMalloc(sizeof(Holder) + capacity);
+    }
+
+    return takeOwnership(memory, capacity, true);
+}
+
+void SharedBuffer::Holder::releaseToPool(void* holderPrefixedData, size_t capacity) {
+    chargeMemoryAccount(MemoryAccountTag::kNetworkBuffers, -static_cast<long long>(capacity));
+    if (capacity > kMaxPooledSize || threadBufferCacheDestroyed ||
+        !threadBufferCache.give(sizeClassIndex(capacity), holderPrefixedData)) {
+        free(holderPrefixedData);
+    }
+}
+
+}  // namespace mongo
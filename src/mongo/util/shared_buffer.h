@@ -33,6 +33,7 @@
 #include "mongo/platform/atomic_word.h"
 #include "mongo/util/allocator.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/memory_accounting.h"
 
 namespace mongo {
 
@@ -51,6 +52,22 @@ public:
         return takeOwnership(mongoMalloc(sizeof(Holder) + bytes), bytes);
     }
 
+    /**
+     * Like allocate(), but rounds the capacity up to a power of two between kMinPooledSize and
+     * kMaxPooledSize and reuses memory from a small per-thread freelist of buffers of that size.
+     * When the last reference to a pooled buffer is dropped, its memory goes back to the freelist
+     * of the releasing thread rather than being freed. Larger sizes are allocated normally.
+     * Pooled buffers of any size are counted against MemoryAccountTag::kNetworkBuffers while
+     * alive.
+     *
+     * This is meant for short lived buffers of similar sizes which are allocated and released at
+     * a high rate on the same threads, such as incoming network messages.
+     */
+    static SharedBuffer allocatePooled(size_t bytes);
+
+    static constexpr size_t kMinPooledSize = 1024;
+    static constexpr size_t kMaxPooledSize = 64 * 1024;
+
     /**
      * Resizes the buffer, copying the current contents.
      *
@@ -62,6 +79,12 @@ public:
     void realloc(size_t size) {
         invariant(!_holder || !_holder->isShared());
 
+        // The resized memory is freed normally rather than returned to the pool.
+        if (_holder && _holder->_pooled) {
+            chargeMemoryAccount(MemoryAccountTag::kNetworkBuffers,
+                                -static_cast<long long>(_holder->_capacity));
+        }
+
         const size_t realSize = size + sizeof(Holder);
         void* newPtr = mongoRealloc(_holder.get(), realSize);
 
@@ -99,8 +122,8 @@ public:
 private:
     class Holder {
     public:
-        explicit Holder(AtomicUInt32::WordType initial, size_t capacity)
-            : _refCount(initial), _capacity(capacity) {
+        explicit Holder(AtomicUInt32::WordType initial, size_t capacity, bool pooled)
+            : _refCount(initial), _capacity(capacity), _pooled(pooled) {
             invariant(capacity == _capacity);
         }
 
@@ -111,13 +134,24 @@ private:
 
         friend void intrusive_ptr_release(Holder* h) {
             if (h->_refCount.subtractAndFetch(1) == 0) {
+                const bool pooled = h->_pooled;
+                const size_t capacity = h->_capacity;
+
                 // We placement new'ed a Holder in takeOwnership above,
                 // so we must destroy the object here.
                 h->~Holder();
-                free(h);
+                if (pooled) {
+                    releaseToPool(h, capacity);
+                } else {
+                    free(h);
+                }
             }
         }
 
+        // Returns the memory of a buffer created by allocatePooled() to the current thread's
+        // freelist, or frees it if that freelist is full.
+        static void releaseToPool(void* holderPrefixedData, size_t capacity);
+
         char* data() {
             return reinterpret_cast<char*>(this + 1);
         }
@@ -131,7 +165,10 @@ private:
         }
 
         AtomicUInt32 _refCount;
-        uint32_t _capacity;
+
+        // These share a word so that the data following the Holder stays 8-byte aligned.
+        uint32_t _capacity : 31;
+        uint32_t _pooled : 1;
     };
 
     explicit SharedBuffer(Holder* holder) : _holder(holder, /*add_ref=*/false) {
@@ -146,12 +183,14 @@ private:
      * This class will call free(holderPrefixedData), so it must have been allocated in a way
      * that makes that valid.
      */
-    static SharedBuffer takeOwnership(void* holderPrefixedData, size_t capacity) {
+    static SharedBuffer takeOwnership(void* holderPrefixedData,
+                                      size_t capacity,
+                                      bool pooled = false) {
         // Initialize the refcount to 1 so we don't need to increment it in the constructor
         // (see private Holder* constructor above).
         //
         // TODO: Should dassert alignment of holderPrefixedData here if possible.
-        return SharedBuffer(new (holderPrefixedData) Holder(1U, capacity));
+        return SharedBuffer(new (holderPrefixedData) Holder(1U, capacity, pooled));
     }
 
     boost::intrusive_ptr<Holder> _holder;
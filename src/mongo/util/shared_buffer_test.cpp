@@ -0,0 +1,103 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/shared_buffer.h"
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(SharedBufferTest, PooledCapacityIsRoundedUpToSizeClass) {
+    ASSERT_EQ(SharedBuffer::kMinPooledSize, SharedBuffer::allocatePooled(16).capacity());
+    ASSERT_EQ(SharedBuffer::kMinPooledSize,
+              SharedBuffer::allocatePooled(SharedBuffer::kMinPooledSize).capacity());
+    ASSERT_EQ(2 * SharedBuffer::kMinPooledSize,
+              SharedBuffer::allocatePooled(SharedBuffer::kMinPooledSize + 1).capacity());
+    ASSERT_EQ(SharedBuffer::kMaxPooledSize,
+              SharedBuffer::allocatePooled(SharedBuffer::kMaxPooledSize).capacity());
+}
+
+TEST(SharedBufferTest, OversizedPooledAllocationIsExact) {
+    const size_t size = SharedBuffer::kMaxPooledSize + 1;
+    ASSERT_EQ(size, SharedBuffer::allocatePooled(size).capacity());
+}
+
+TEST(SharedBufferTest, ReleasedPooledBufferIsReusedOnSameThread) {
+    auto buffer = SharedBuffer::allocatePooled(100);
+    const char* const data = buffer.get();
+    buffer = SharedBuffer();
+
+    auto reused = SharedBuffer::allocatePooled(200);
+    ASSERT_EQ(static_cast<const void*>(data), static_cast<const void*>(reused.get()));
+
+    // A buffer of a different size class does not come from the same freelist.
+    auto other = SharedBuffer::allocatePooled(4096);
+    ASSERT_NOT_EQUALS(static_cast<const void*>(data), static_cast<const void*>(other.get()));
+}
+
+TEST(SharedBufferTest, PooledBufferIsNotReleasedWhileShared) {
+    auto buffer = SharedBuffer::allocatePooled(100);
+    memset(buffer.get(), 'x', buffer.capacity());
+    ConstSharedBuffer shared(buffer);
+    buffer = SharedBuffer();
+
+    // The memory is still referenced, so a new allocation must not hand it out again.
+    auto next = SharedBuffer::allocatePooled(100);
+    ASSERT_NOT_EQUALS(static_cast<const void*>(shared.get()), static_cast<const void*>(next.get()));
+    ASSERT_EQ('x', shared.get()[SharedBuffer::kMinPooledSize - 1]);
+}
+
+TEST(SharedBufferTest, ReallocOfPooledBufferKeepsContents) {
+    auto buffer = SharedBuffer::allocatePooled(16);
+    memcpy(buffer.get(), "0123456789", 10);
+    buffer.realloc(3 * SharedBuffer::kMaxPooledSize);
+    ASSERT_EQ(3 * SharedBuffer::kMaxPooledSize, buffer.capacity());
+    ASSERT_EQ(0, memcmp(buffer.get(), "0123456789", 10));
+}
+
+TEST(SharedBufferTest, PooledBuffersAreChargedToNetworkAccountWhileAlive) {
+    const auto before = getMemoryAccountBytes(MemoryAccountTag::kNetworkBuffers);
+    {
+        auto small = SharedBuffer::allocatePooled(100);
+        auto large = SharedBuffer::allocatePooled(SharedBuffer::kMaxPooledSize + 1);
+        ASSERT_EQ(before + static_cast<long long>(small.capacity() + large.capacity()),
+                  getMemoryAccountBytes(MemoryAccountTag::kNetworkBuffers));
+
+        // Once resized, a buffer no longer belongs to the pool.
+        small.realloc(2 * SharedBuffer::kMaxPooledSize);
+        ASSERT_EQ(before + static_cast<long long>(large.capacity()),
+                  getMemoryAccountBytes(MemoryAccountTag::kNetworkBuffers));
+    }
+    ASSERT_EQ(before, getMemoryAccountBytes(MemoryAccountTag::kNetworkBuffers));
+}
+
+}  // namespace
+}  // namespace mongo
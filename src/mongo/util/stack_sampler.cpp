@@ -0,0 +1,338 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kControl
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/stack_sampler.h"
+
+#if defined(__linux__)
+#include <cxxabi.h>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace {
+
+#if defined(__linux__)
+
+// Frames belonging to the signal handler and the kernel's signal trampoline.
+constexpr int kHandlerFrames = 2;
+
+constexpr size_t kRingSize = 1024;
+
+enum SlotState : int { kFree, kWriting, kReady };
+
+struct Sample {
+    AtomicWord<int> state{kFree};
+    char threadName[16];
+    int depth;
+    void* frames[StackSampler::kMaxFrames];
+};
+
+Sample ring[kRingSize];
+AtomicUInt64 nextSlot;
+AtomicInt64 droppedSamples;
+
+// gperftools' profiler, used by the cpuprofile command, owns SIGPROF so use a real time signal.
+int samplerSignal() {
+    return SIGRTMIN + 3;
+}
+
+/**
+ * Records the interrupted thread's stack. Must only do async-signal-safe work: claiming a ring
+ * slot is a single CAS, prctl() is a plain system call and backtrace() has been called once
+ * outside of the handler so it does not need to load libgcc_s here.
+ */
+void sampleHandler(int, siginfo_t*, void*) {
+    const int savedErrno = errno;
+
+    auto& slot = ring[nextSlot.fetchAndAdd(1) % kRingSize];
+    if (slot.state.compareAndSwap(kFree, kWriting) != kFree) {
+        // The sampling thread has fallen behind.
+        droppedSamples.fetchAndAdd(1);
+        errno = savedErrno;
+        return;
+    }
+
+    if (prctl(PR_GET_NAME, slot.threadName) != 0) {
+        slot.threadName[0] = '\0';
+    }
+    slot.threadName[sizeof(slot.threadName) - 1] = '\0';
+    slot.depth = backtrace(slot.frames, StackSampler::kMaxFrames);
+    slot.state.store(kReady);
+
+    errno = savedErrno;
+}
+
+/**
+ * Removes the argument list and qualifiers from a demangled function name, keeping everything
+ * up to the parenthesis that matches the last closing one.
+ */
+std::string stripArguments(std::string name) {
+    const StringData kConst = " const";
+    if (StringData(name).endsWith(kConst)) {
+        name.resize(name.size() - kConst.size());
+    }
+
+    if (name.empty() || name.back() != ')') {
+        return name;
+    }
+
+    int depth = 0;
+    for (size_t i = name.size(); i-- > 0;) {
+        if (name[i] == ')') {
+            ++depth;
+        } else if (name[i] == '(' && --depth == 0) {
+            if (i > 0) {
+                name.resize(i);
+            }
+            break;
+        }
+    }
+    return name;
+}
+
+#endif
+
+}  // namespace
+
+StackSampler& StackSampler::get() {
+    // Intentionally leaked so the sampling thread never outlives its sampler at shutdown.
+    static StackSampler* sampler = new StackSampler();
+    return *sampler;
+}
+
+bool StackSampler::isSupported() {
+#if defined(__linux__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::string StackSampler::threadGroup(StringData threadName) {
+    size_t end = threadName.size();
+    while (end > 0 && std::isdigit(static_cast<unsigned char>(threadName[end - 1]))) {
+        --end;
+    }
+    while (end > 0 && (threadName[end - 1] == ' ' || threadName[end - 1] == '-' ||
+                       threadName[end - 1] == '_' || threadName[end - 1] == '.')) {
+        --end;
+    }
+
+    if (end == 0) {
+        return threadName.empty() ? "thread" : threadName.toString();
+    }
+    return threadName.substr(0, end).toString();
+}
+
+void StackSampler::start(int samplesPerSecond, size_t maxStacks) {
+    invariant(samplesPerSecond > 0);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_started) {
+        return;
+    }
+
+    if (!isSupported()) {
+        log() << "Stack sampling is not supported on this platform";
+        return;
+    }
+
+#if defined(__linux__)
+    // The first call to backtrace() loads libgcc_s, which is not safe to do in a signal handler.
+    void* warmUp[1];
+    backtrace(warmUp, 1);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = &sampleHandler;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(samplerSignal(), &action, nullptr) != 0) {
+        const auto err = errno;
+        warning() << "Failed to install the stack sampler signal handler: "
+                  << errnoWithDescription(err);
+        return;
+    }
+
+    _maxStacks = maxStacks;
+    _started = true;
+
+    const Milliseconds period(std::max(1, 1000 / samplesPerSecond));
+    _thread = stdx::thread([this, period] { _run(period); });
+
+    log() << "Started stack sampling every " << period;
+#endif
+}
+
+void StackSampler::stop() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (!_started) {
+            return;
+        }
+        _started = false;
+    }
+
+    _stop.store(true);
+    _thread.join();
+    _stop.store(false);
+}
+
+void StackSampler::report(BSONObjBuilder* builder) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    builder->append("samples", _samples);
+#if defined(__linux__)
+    builder->append("dropped", droppedSamples.load());
+#endif
+
+    BSONObjBuilder stacksBuilder(builder->subobjStart("stacks"));
+    for (const auto& stack : _stacks) {
+        stacksBuilder.append(stack.first, stack.second);
+    }
+}
+
+void StackSampler::_run(Milliseconds period) {
+    setThreadName("stackSampler");
+
+    while (!_stop.load()) {
+        _signalAllThreads();
+
+        // Give the handlers a full period to run before collecting what they recorded.
+        sleepFor(period);
+
+        _drain();
+    }
+}
+
+void StackSampler::_signalAllThreads() {
+#if defined(__linux__)
+    DIR* dir = opendir("/proc/self/task");
+    if (!dir) {
+        return;
+    }
+
+    const pid_t pid = getpid();
+    const pid_t self = syscall(SYS_gettid);
+    while (auto entry = readdir(dir)) {
+        const pid_t tid = atoi(entry->d_name);
+        if (tid <= 0 || tid == self) {
+            continue;
+        }
+
+        // The thread may have exited since the directory was read, which is harmless.
+        syscall(SYS_tgkill, pid, tid, samplerSignal());
+    }
+
+    closedir(dir);
+#endif
+}
+
+void StackSampler::_drain() {
+#if defined(__linux__)
+    std::vector<std::string> folded;
+
+    for (auto& slot : ring) {
+        if (slot.state.load() != kReady) {
+            continue;
+        }
+
+        str::stream stack;
+        stack << threadGroup(slot.threadName);
+        for (int i = slot.depth - 1; i >= kHandlerFrames; --i) {
+            stack << ';' << _symbolize(slot.frames[i]);
+        }
+        slot.state.store(kFree);
+
+        folded.push_back(stack);
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    for (auto& stack : folded) {
+        ++_samples;
+
+        auto it = _stacks.find(stack);
+        if (it != _stacks.end()) {
+            ++it->second;
+        } else if (_stacks.size() < _maxStacks) {
+            _stacks.emplace(std::move(stack), 1);
+        } else {
+            ++_stacks[stack.substr(0, stack.find(';')) + ";[other]"];
+        }
+    }
+#endif
+}
+
+const std::string& StackSampler::_symbolize(void* address) {
+    auto it = _symbols.find(address);
+    if (it != _symbols.end()) {
+        return it->second;
+    }
+
+    std::string symbol = "[unknown]";
+#if defined(__linux__)
+    Dl_info info;
+    const bool found = dladdr(address, &info) != 0;
+    if (found && info.dli_sname) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        symbol = stripArguments(status == 0 && demangled ? demangled : info.dli_sname);
+        free(demangled);
+    } else if (found && info.dli_fname) {
+        StringData module(info.dli_fname);
+        symbol = str::stream() << '[' << module.substr(module.rfind('/') + 1) << ']';
+    }
+#endif
+
+    return _symbols.emplace(address, std::move(symbol)).first->second;
+}
+
+}  // namespace mongo
@@ -0,0 +1,127 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+/**
+ * Low rate, always-on stack sampler.
+ *
+ * A background thread periodically signals every thread in the process. The signal handler
+ * records the interrupted thread's name and return addresses into a fixed size ring buffer
+ * without allocating or locking. The background thread drains the ring, symbolizes the
+ * addresses and aggregates the samples as cumulative counts of folded stacks, i.e.
+ * "threadGroup;outermostFrame;...;innermostFrame", where the thread group is the thread name
+ * with any trailing number removed ("conn", "WTCheckpoint", "repl writer worker", ...).
+ *
+ * Because idle threads are sampled as well, the counts describe where wall-clock time went for
+ * each group of threads, not only where CPU was spent.
+ *
+ * Only Linux is supported; elsewhere start() logs a message and does nothing.
+ */
+class StackSampler {
+    MONGO_DISALLOW_COPYING(StackSampler);
+
+public:
+    /**
+     * Maximum number of frames recorded per sample.
+     */
+    static constexpr int kMaxFrames = 32;
+
+    /**
+     * Returns the process-wide sampler. There can only be one since it owns a signal handler.
+     */
+    static StackSampler& get();
+
+    static bool isSupported();
+
+    /**
+     * Starts sampling every thread 'samplesPerSecond' times a second, keeping at most
+     * 'maxStacks' distinct folded stacks. Samples of stacks beyond that limit are counted
+     * against "<threadGroup>;[other]". Does nothing if already started.
+     */
+    void start(int samplesPerSecond, size_t maxStacks);
+
+    /**
+     * Stops the sampling thread. Aggregated counts are kept.
+     */
+    void stop();
+
+    /**
+     * Appends the sample counters and the cumulative count of every folded stack seen so far.
+     */
+    void report(BSONObjBuilder* builder);
+
+    /**
+     * Reduces a thread name to its group, e.g. "conn12" -> "conn".
+     */
+    static std::string threadGroup(StringData threadName);
+
+private:
+    StackSampler() = default;
+
+    void _run(Milliseconds period);
+
+    void _signalAllThreads();
+
+    void _drain();
+
+    const std::string& _symbolize(void* address);
+
+    stdx::mutex _mutex;
+
+    stdx::thread _thread;
+
+    bool _started = false;
+    AtomicWord<bool> _stop{false};
+
+    size_t _maxStacks = 0;
+
+    // Guarded by _mutex.
+    std::map<std::string, long long> _stacks;
+    long long _samples = 0;
+
+    // Only used by the sampling thread.
+    std::unordered_map<void*, std::string> _symbols;
+};
+
+}  // namespace mongo
@@ -0,0 +1,89 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/stack_sampler.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+TEST(StackSamplerTest, ThreadGroup) {
+    ASSERT_EQ("conn", StackSampler::threadGroup("conn123"));
+    ASSERT_EQ("WTCheckpoint", StackSampler::threadGroup("WTCheckpoint"));
+    ASSERT_EQ("repl writer worker", StackSampler::threadGroup("repl writer worker 12"));
+    ASSERT_EQ("worker", StackSampler::threadGroup("worker-3"));
+    ASSERT_EQ("42", StackSampler::threadGroup("42"));
+    ASSERT_EQ("thread", StackSampler::threadGroup(""));
+}
+
+TEST(StackSamplerTest, SamplesNamedThreads) {
+    if (!StackSampler::isSupported()) {
+        return;
+    }
+
+    AtomicWord<bool> done{false};
+    stdx::thread worker([&] {
+        setThreadName("samplerTestWorker7");
+        while (!done.load()) {
+        }
+    });
+
+    auto& sampler = StackSampler::get();
+    sampler.start(100, 1000);
+
+    bool found = false;
+    for (int attempt = 0; attempt < 100 && !found; ++attempt) {
+        sleepmillis(100);
+
+        BSONObjBuilder builder;
+        sampler.report(&builder);
+        for (auto&& stack : builder.obj()["stacks"].Obj()) {
+            if (StringData(stack.fieldName()).startsWith("samplerTestWorker;")) {
+                ASSERT_GT(stack.numberLong(), 0);
+                found = true;
+            }
+        }
+    }
+
+    sampler.stop();
+    done.store(true);
+    worker.join();
+
+    ASSERT(found);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -215,4 +215,68 @@ TEST(StringMapTest, InitWithInitializerList) {
     ASSERT_EQ(2, smap["coollog"]);
     ASSERT_EQ(3, smap["mango"]);
 }
+
+TEST(StringMapTest, EraseAndReinsertAcrossGrowth) {
+    // Exercises deleted slots and probe sequences that wrap around the end of the table.
+    StringMap<int> m;
+    for (int i = 0; i < 2000; i++) {
+        m[std::to_string(i)] = i;
+        if (i % 3 == 0) {
+            ASSERT_EQUALS(1U, m.erase(std::to_string(i / 2)));
+            m[std::to_string(i / 2)] = i / 2;
+        }
+    }
+    ASSERT_EQUALS(2000U, m.size());
+    for (int i = 0; i < 2000; i++) {
+        ASSERT_EQUALS(i, m[std::to_string(i)]);
+    }
+
+    size_t seen = 0;
+    for (auto&& elem : m) {
+        ASSERT_EQUALS(std::to_string(elem.second), elem.first);
+        seen++;
+    }
+    ASSERT_EQUALS(2000U, seen);
+
+    for (int i = 0; i < 2000; i += 2) {
+        ASSERT_EQUALS(1U, m.erase(std::to_string(i)));
+    }
+    for (int i = 0; i < 2000; i++) {
+        ASSERT_EQUALS(i % 2 == 1, m.find(std::to_string(i)) != m.end());
+    }
+}
+
+TEST(StringMapTest, LookupPerf) {
+    const int kKeys = 10000;
+    const int kLookups = 1000000;
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < kKeys; i++) {
+        keys.push_back("field" + std::to_string(i));
+    }
+
+    StringMap<int> smap;
+    stdx::unordered_map<std::string, int> umap;
+    for (int i = 0; i < kKeys; i++) {
+        smap[keys[i]] = i;
+        umap[keys[i]] = i;
+    }
+
+    long long sum = 0;
+    Timer t;
+    for (int i = 0; i < kLookups; i++) {
+        sum += smap.find(keys[i % kKeys])->second;
+    }
+    const long long smapMicros = t.micros();
+
+    t.reset();
+    for (int i = 0; i < kLookups; i++) {
+        sum += umap.find(keys[i % kKeys])->second;
+    }
+    const long long umapMicros = t.micros();
+
+    log() << "StringMap lookup: " << (smapMicros * 1000.0 / kLookups)
+          << " ns/op, std::unordered_map lookup: " << (umapMicros * 1000.0 / kLookups)
+          << " ns/op, checksum " << sum;
+}
 }
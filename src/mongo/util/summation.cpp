@@ -30,8 +30,14 @@
 
 #include "summation.h"
 
+#include <algorithm>
 #include <cmath>
 
+#if defined(_M_AMD64) || defined(__amd64__)
+#include <emmintrin.h>
+#endif
+
+#include "mongo/platform/overflow_arithmetic.h"
 #include "mongo/util/assert_util.h"
 
 namespace mongo {
@@ -44,6 +50,93 @@ void DoubleDoubleSummation::addLong(long long x) {
     addDouble(high);
 }
 
+void DoubleDoubleSummation::addDoubles(const double* values, size_t count) {
+    // The values are spread over four independent compensated sums, each updated exactly as
+    // addDouble() updates this one, and the four are added in at the end. On x86-64 each SSE2
+    // register holds two of them.
+    const size_t kLanes = 4;
+    if (count < 2 * kLanes) {
+        for (size_t i = 0; i < count; ++i)
+            addDouble(values[i]);
+        return;
+    }
+
+    double sums[kLanes];
+    double addends[kLanes];
+    double specials[kLanes];
+    size_t i = 0;
+#if defined(_M_AMD64) || defined(__amd64__)
+    __m128d sum[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+    __m128d addend[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+    __m128d special[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+    for (; i + kLanes <= count; i += kLanes) {
+        for (int half = 0; half < 2; ++half) {
+            __m128d x = _mm_loadu_pd(values + i + 2 * half);
+            special[half] = _mm_add_pd(special[half], x);
+
+            // _fast2Sum(x, addend)
+            __m128d s = _mm_add_pd(x, addend[half]);
+            addend[half] = _mm_sub_pd(addend[half], _mm_sub_pd(s, x));
+            x = s;
+
+            // _2Sum(sum, x)
+            s = _mm_add_pd(sum[half], x);
+            const __m128d aPrime = _mm_sub_pd(s, x);
+            const __m128d bPrime = _mm_sub_pd(s, aPrime);
+            x = _mm_add_pd(_mm_sub_pd(sum[half], aPrime), _mm_sub_pd(x, bPrime));
+            sum[half] = s;
+
+            addend[half] = _mm_add_pd(addend[half], x);
+        }
+    }
+    for (int half = 0; half < 2; ++half) {
+        _mm_storeu_pd(sums + 2 * half, sum[half]);
+        _mm_storeu_pd(addends + 2 * half, addend[half]);
+        _mm_storeu_pd(specials + 2 * half, special[half]);
+    }
+#else
+    std::fill(sums, sums + kLanes, 0.0);
+    std::fill(addends, addends + kLanes, 0.0);
+    std::fill(specials, specials + kLanes, 0.0);
+    for (; i + kLanes <= count; i += kLanes) {
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            double x = values[i + lane];
+            specials[lane] += x;
+            std::tie(x, addends[lane]) = _fast2Sum(x, addends[lane]);
+            std::tie(sums[lane], x) = _2Sum(sums[lane], x);
+            addends[lane] += x;
+        }
+    }
+#endif
+
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+        _special += specials[lane];
+        _addCompensated(sums[lane]);
+        _addCompensated(addends[lane]);
+    }
+    for (; i < count; ++i)
+        addDouble(values[i]);
+}
+
+void DoubleDoubleSummation::addLongs(const long long* values, size_t count) {
+    // Split each integer as addLong() does, then add the halves in bulk.
+    const size_t kChunk = 64;
+    double halves[2 * kChunk];
+    while (count) {
+        const size_t n = std::min(count, kChunk);
+        size_t numHalves = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const int64_t high = values[i] / (1ll << 32) * (1ll << 32);
+            halves[numHalves++] = values[i] - high;
+            if (high)
+                halves[numHalves++] = high;
+        }
+        addDoubles(halves, numHalves);
+        values += n;
+        count -= n;
+    }
+}
+
 /**
  * Returns whether the sum is in range of the 64-bit signed integer long long type.
  */
@@ -86,4 +179,69 @@ long long DoubleDoubleSummation::getLong() const {
     sum += llround((_sum - sum) + _addend);
     return sum;
 }
+
+namespace {
+const int64_t kPowersOfTen[] = {1LL,
+                                10LL,
+                                100LL,
+                                1000LL,
+                                10000LL,
+                                100000LL,
+                                1000000LL,
+                                10000000LL,
+                                100000000LL,
+                                1000000000LL,
+                                10000000000LL,
+                                100000000000LL,
+                                1000000000000LL,
+                                10000000000000LL,
+                                100000000000000LL,
+                                1000000000000000LL,
+                                10000000000000000LL,
+                                100000000000000000LL,
+                                1000000000000000000LL};
+const uint32_t kNumPowersOfTen = sizeof(kPowersOfTen) / sizeof(kPowersOfTen[0]);
+const uint64_t kMaxScaledCoefficient = kPowersOfTen[kNumPowersOfTen - 1];
+}  // namespace
+
+void DecimalSummation::add(const Decimal128& x) {
+    // NaN and infinity report an exponent past kMaxBiasedExponent. Non-canonical encodings report
+    // a zero coefficient, which is the value they stand for.
+    const uint32_t exponent = x.getBiasedExponent();
+    const uint64_t coefficient = x.getCoefficientLow();
+    if (exponent <= Decimal128::kMaxBiasedExponent && x.getCoefficientHigh() == 0 &&
+        coefficient < kMaxScaledCoefficient) {
+        if (!_hasScaled) {
+            _hasScaled = true;
+            _scaledExponent = exponent;
+        }
+
+        // An addend with a larger exponent is rescaled to the shared unit, if that fits.
+        int64_t scaled;
+        if (exponent >= _scaledExponent && exponent - _scaledExponent < kNumPowersOfTen &&
+            !mongoSignedMultiplyOverflow64(static_cast<int64_t>(coefficient),
+                                           kPowersOfTen[exponent - _scaledExponent],
+                                           &scaled)) {
+            if (x.getValue().high64 >> 63)
+                scaled = -scaled;
+
+            int64_t sum;
+            if (!mongoSignedAddOverflow64(_scaledTotal, scaled, &sum)) {
+                _scaledTotal = sum;
+            } else {
+                _total = _total.add(_scaledTotalAsDecimal());
+                _scaledTotal = scaled;
+            }
+            return;
+        }
+    }
+    _total = _total.add(x);
+}
+
+Decimal128 DecimalSummation::_scaledTotalAsDecimal() const {
+    const uint64_t sign = _scaledTotal < 0;
+    const uint64_t magnitude =
+        sign ? 0 - static_cast<uint64_t>(_scaledTotal) : static_cast<uint64_t>(_scaledTotal);
+    return Decimal128(sign, _scaledExponent, 0, magnitude);
+}
 }  // namespace mongo
@@ -30,6 +30,7 @@
 
 #include <cmath>
 #include <limits>
+#include <string>
 #include <vector>
 
 #include "mongo/unittest/unittest.h"
@@ -198,4 +199,93 @@ TEST(Summation, AddDoubles) {
     ASSERT_EQUALS(sum.getDouble(), doubleValuesSum);
     ASSERT(straightSum != sum.getDouble());
 }
+
+TEST(Summation, AddDoublesInBulk) {
+    DoubleDoubleSummation sum;
+    sum.addDoubles(doubleValues.data(), doubleValues.size());
+    ASSERT_EQUALS(sum.getDouble(), doubleValuesSum);
+
+    // Split across calls, including runs too short for the bulk path.
+    DoubleDoubleSummation split;
+    split.addDoubles(doubleValues.data(), 3);
+    split.addDoubles(doubleValues.data() + 3, doubleValues.size() - 3);
+    ASSERT_EQUALS(split.getDouble(), doubleValuesSum);
+}
+
+TEST(Summation, AddLongsInBulk) {
+    DoubleDoubleSummation sum;
+    DoubleDoubleSummation straightSum;
+    for (int i = 0; i < 10; i++) {
+        sum.addLongs(longValues.data(), longValues.size());
+        for (auto x : longValues) {
+            straightSum.addLong(x);
+        }
+    }
+    // Both sums are exact, though well out of the range of a long long.
+    ASSERT(sum.getDecimal().isEqual(straightSum.getDecimal()));
+    ASSERT_EQUALS(sum.getDouble(), straightSum.getDouble());
+}
+
+TEST(Summation, AddSpecialInBulk) {
+    for (auto x : specialValues) {
+        std::vector<double> values(doubleValues);
+        values[17] = x;
+        DoubleDoubleSummation sum;
+        sum.addDoubles(values.data(), values.size());
+        if (std::isnan(x)) {
+            ASSERT(std::isnan(sum.getDouble()));
+        } else {
+            ASSERT_EQUALS(sum.getDouble(), x);
+        }
+    }
+
+    std::vector<double> values(doubleValues);
+    values[5] = std::numeric_limits<double>::infinity();
+    values[30] = -std::numeric_limits<double>::infinity();
+    DoubleDoubleSummation sum;
+    sum.addDoubles(values.data(), values.size());
+    ASSERT(std::isnan(sum.getDouble()));
+}
+
+namespace {
+void assertDecimalSumMatchesAdd(const std::vector<std::string>& addends) {
+    DecimalSummation sum;
+    Decimal128 straightSum;
+    for (auto&& x : addends) {
+        sum.add(Decimal128(x));
+        straightSum = straightSum.add(Decimal128(x));
+    }
+    // Compare the strings too, so that the exponent of the result must match as well.
+    ASSERT_EQUALS(sum.getDecimal().toString(), straightSum.toString());
+}
+}  // namespace
+
+TEST(Summation, AddDecimals) {
+    assertDecimalSumMatchesAdd({});
+    assertDecimalSumMatchesAdd({"1.25", "-3.50", "100.00", "0.01"});
+    assertDecimalSumMatchesAdd({"-0.00", "-0"});
+    assertDecimalSumMatchesAdd({"1E2", "3E5", "7E1"});
+}
+
+TEST(Summation, AddDecimalsWithMixedExponents) {
+    // A smaller exponent than the first addend's, and one too large to rescale.
+    assertDecimalSumMatchesAdd({"12.5", "0.125", "3.25", "1E30", "-7"});
+    assertDecimalSumMatchesAdd({"5E-10", "1E10", "-1E10", "2.5"});
+}
+
+TEST(Summation, AddDecimalsBeyondInt64) {
+    // Coefficients too wide for the integer sum, and an integer sum that overflows repeatedly.
+    assertDecimalSumMatchesAdd({"123456789012345678901234567890", "1", "-99999999999999999999"});
+    std::vector<std::string> addends;
+    for (int i = 0; i < 100; i++) {
+        addends.push_back(i % 3 ? "999999999999999999" : "-999999999999999999.9");
+    }
+    assertDecimalSumMatchesAdd(addends);
+}
+
+TEST(Summation, AddDecimalSpecialValues) {
+    assertDecimalSumMatchesAdd({"1.5", "Infinity", "2"});
+    assertDecimalSumMatchesAdd({"1.5", "-Infinity", "Infinity"});
+    assertDecimalSumMatchesAdd({"NaN", "1.5"});
+}
 }  // namespace mongo
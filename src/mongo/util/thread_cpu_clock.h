@@ -0,0 +1,75 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+#include "mongo/util/duration.h"
+
+namespace mongo {
+
+/**
+ * Measures the CPU time consumed by one thread. Unlike CLOCK_THREAD_CPUTIME_ID, it can be read from
+ * any thread, which lets currentOp report the CPU time of operations running on other threads. It
+ * must only be read while the measured thread is still alive.
+ *
+ * Only supported on Linux. Elsewhere, clocks are never valid.
+ */
+class ThreadCpuClock {
+public:
+    /**
+     * Returns a clock measuring the calling thread.
+     */
+    static ThreadCpuClock forCurrentThread();
+
+    /**
+     * Constructs a clock that doesn't measure any thread.
+     */
+    ThreadCpuClock() = default;
+
+    bool isValid() const {
+        return _valid;
+    }
+
+    /**
+     * Returns the CPU time the thread has consumed since it started, or zero if this clock is not
+     * valid.
+     */
+    Nanoseconds now() const;
+
+private:
+#if defined(__linux__)
+    clockid_t _clockId{};
+#endif
+    bool _valid = false;
+};
+
+}  // namespace mongo
@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include <iterator>
 #include <memory>
 #include <type_traits>
@@ -156,18 +158,39 @@ private:
     };
 
     struct Area {
+        // Probing looks at the control bytes of this many consecutive slots at once.
+        static constexpr unsigned kGroupSize = 16;
+
+        // Control byte values. A slot in use holds the top 7 bits of its entry's hash, so its
+        // control byte never has the high bit set.
+        static constexpr uint8_t kCtrlEmpty = 0x80;    // never used, ends a probe sequence
+        static constexpr uint8_t kCtrlDeleted = 0xFE;  // used before, probing continues past it
+
+        static uint8_t ctrlTag(uint32_t hash) {
+            return hash >> 25;
+        }
+
         Area() = default;  // TODO constexpr
 
         Area(unsigned capacity, unsigned maxProbe)
             : _hashMask(capacity - 1),
               _maxProbe(maxProbe),
-              _entries(capacity ? new Entry[capacity] : nullptr) {
+              _entries(capacity ? new Entry[capacity] : nullptr),
+              _ctrl(capacity ? new uint8_t[capacity + kGroupSize - 1] : nullptr) {
             // Capacity must be a power of two or zero. See the comment on _hashMask for why.
             dassert((capacity & (capacity - 1)) == 0);
+            // A group read starting at the last slot must not wrap past the mirrored bytes.
+            dassert(capacity == 0 || capacity >= kGroupSize);
+            if (capacity) {
+                memset(_ctrl.get(), kCtrlEmpty, capacity + kGroupSize - 1);
+            }
         }
 
         Area(const Area& other) : Area(other.capacity(), other._maxProbe) {
             std::copy(other.begin(), other.end(), begin());
+            if (other._ctrl) {
+                memcpy(_ctrl.get(), other._ctrl.get(), capacity() + kGroupSize - 1);
+            }
         }
 
         Area& operator=(const Area& other) {
@@ -179,11 +202,28 @@ private:
 
         bool transfer(Area* newArea) const;
 
+        bool isUsed(unsigned pos) const {
+            return !(_ctrl[pos] & 0x80);
+        }
+
+        /**
+         * Records the state of slot 'pos', which must be kept in step with its Entry. The first
+         * kGroupSize - 1 control bytes are mirrored after the last one, so that a group read
+         * starting near the end of the table sees the slots it wraps around to.
+         */
+        void setCtrl(unsigned pos, uint8_t ctrl) {
+            _ctrl[pos] = ctrl;
+            if (pos < kGroupSize - 1) {
+                _ctrl[capacity() + pos] = ctrl;
+            }
+        }
+
         void swap(Area* other) {
             using std::swap;
             swap(_hashMask, other->_hashMask);
             swap(_maxProbe, other->_maxProbe);
             swap(_entries, other->_entries);
+            swap(_ctrl, other->_ctrl);
         }
 
         unsigned capacity() const {
@@ -211,6 +251,10 @@ private:
         unsigned _hashMask = -1;
         unsigned _maxProbe = 0;
         std::unique_ptr<Entry[]> _entries = {};
+
+        // One control byte per slot, plus the mirrored bytes described at setCtrl(). Probing scans
+        // these, kGroupSize at a time, and only reads an Entry whose hash tag matches.
+        std::unique_ptr<uint8_t[]> _ctrl = {};
     };
 
 public:
@@ -326,7 +370,7 @@ public:
                     _position = -1;
                     break;
                 }
-                if (_area->_entries[_position].isUsed())
+                if (_area->isUsed(_position))
                     break;
                 ++_position;
             }
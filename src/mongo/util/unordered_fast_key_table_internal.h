@@ -30,6 +30,11 @@
 
 #pragma once
 
+#if defined(_M_AMD64) || defined(__amd64__)
+#include <emmintrin.h>
+#endif
+
+#include "mongo/platform/bits.h"
 #include "mongo/util/unordered_fast_key_table.h"
 
 namespace mongo {
@@ -40,34 +45,58 @@ inline int UnorderedFastKeyTable<K_L, K_S, V, Traits>::Area::find(const HashedKe
     dassert(capacity());                        // Caller must special-case empty tables.
     dassert(!firstEmpty || *firstEmpty == -1);  // Caller must initialize *firstEmpty.
 
-    unsigned probe = 0;
-    do {
-        unsigned pos = (key.hash() + probe) & _hashMask;
-
-        if (!_entries[pos].isUsed()) {
-            // space is empty
-            if (firstEmpty && *firstEmpty == -1)
-                *firstEmpty = pos;
-            if (!_entries[pos].wasEverUsed())
-                return -1;
-            continue;
+    const uint8_t tag = ctrlTag(key.hash());
+    for (unsigned probe = 0; probe < _maxProbe; probe += kGroupSize) {
+        const unsigned pos = (key.hash() + probe) & _hashMask;
+        const uint8_t* group = &_ctrl[pos];
+
+        // Bit i of each mask describes slot pos + i: whether its tag matches, whether it is free
+        // (empty or deleted) and whether it was never used.
+        uint32_t matches;
+        uint32_t free;
+        uint32_t empty;
+#if defined(_M_AMD64) || defined(__amd64__)
+        const __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        matches = _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag)));
+        free = _mm_movemask_epi8(ctrl);
+        empty = _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(kCtrlEmpty)));
+#else
+        matches = free = empty = 0;
+        for (unsigned i = 0; i < kGroupSize; ++i) {
+            matches |= uint32_t(group[i] == tag) << i;
+            free |= uint32_t((group[i] & 0x80) != 0) << i;
+            empty |= uint32_t(group[i] == kCtrlEmpty) << i;
         }
-
-        if (_entries[pos].getCurHash() != key.hash()) {
-            // space has something else
-            continue;
+#endif
+
+        // Only the first _maxProbe slots of the sequence may hold the key, and none after the
+        // first one that was never used.
+        const unsigned window = _maxProbe - probe < kGroupSize ? _maxProbe - probe : kGroupSize;
+        const uint32_t windowMask = (uint32_t(1) << window) - 1;
+        matches &= windowMask;
+        free &= windowMask;
+        empty &= windowMask;
+        if (empty) {
+            matches &= (uint32_t(1) << countTrailingZeros64(empty)) - 1;
         }
 
-        if (!Traits::equals(key.key(), Traits::toLookup(_entries[pos].getData().first))) {
-            // hashes match
-            // strings are not equals
-            continue;
+        while (matches) {
+            const unsigned slot = (pos + countTrailingZeros64(matches)) & _hashMask;
+            const Entry& entry = _entries[slot];
+            if (entry.getCurHash() == key.hash() &&
+                Traits::equals(key.key(), Traits::toLookup(entry.getData().first))) {
+                return slot;
+            }
+            matches &= matches - 1;
         }
 
-        // hashes and strings are equal
-        // yay!
-        return pos;
-    } while (++probe < _maxProbe);
+        if (firstEmpty && *firstEmpty == -1 && free) {
+            *firstEmpty = (pos + countTrailingZeros64(free)) & _hashMask;
+        }
+        if (empty) {
+            return -1;
+        }
+    }
     return -1;
 }
 
@@ -87,6 +116,7 @@ inline bool UnorderedFastKeyTable<K_L, K_S, V, Traits>::Area::transfer(Area* new
         }
 
         newArea->_entries[firstEmpty] = entry;
+        newArea->setCtrl(firstEmpty, ctrlTag(entry.getCurHash()));
     }
     return true;
 }
@@ -122,6 +152,7 @@ inline size_t UnorderedFastKeyTable<K_L, K_S, V, Traits>::erase(const HashedKey&
 
     --_size;
     _area._entries[pos].unUse();
+    _area.setCtrl(pos, Area::kCtrlDeleted);
     return 1;
 }
 
@@ -132,6 +163,7 @@ void UnorderedFastKeyTable<K_L, K_S, V, Traits>::erase(const_iterator it) {
 
     --_size;
     _area._entries[it._position].unUse();
+    _area.setCtrl(it._position, Area::kCtrlDeleted);
 }
 
 template <typename K_L, typename K_S, typename V, typename Traits>
@@ -160,6 +192,7 @@ inline auto UnorderedFastKeyTable<K_L, K_S, V, Traits>::try_emplace(const Hashed
         if (firstEmpty >= 0) {
             _size++;
             _area._entries[firstEmpty].emplaceData(key, std::forward<Args>(args)...);
+            _area.setCtrl(firstEmpty, Area::ctrlTag(key.hash()));
             return {iterator(&_area, firstEmpty), true};
         }
 